@@ -87,6 +87,7 @@ struct Arguments {
   double dpi{96};
   size_t drawRepeat{1};
   size_t loadRepeat{1};
+  size_t preprocessingThreads{1};
   bool flushCache{false};
   bool flushDiskCache{false};
 
@@ -507,6 +508,12 @@ int main(int argc, char* argv[])
                       "load-repeat",
                       "Repeat every load call, default: " + std::to_string(args.loadRepeat),
                       false);
+  argParser.AddOption(osmscout::CmdLineUIntOption([&args](const unsigned int& value) {
+                        args.preprocessingThreads = value;
+                      }),
+                      "preprocessing-threads",
+                      "Number of threads for preprocessing of map data, default: " + std::to_string(args.preprocessingThreads),
+                      false);
   argParser.AddOption(osmscout::CmdLineFlag([&args](const bool& value) {
                         args.flushCache=value;
                       }),
@@ -618,6 +625,7 @@ int main(int argc, char* argv[])
 
   // TODO: Use some way to find a valid font on the system (Agg display a ton of messages otherwise)
   drawParameter.SetFontName("/usr/share/fonts/TTF/DejaVuSans.ttf");
+  drawParameter.SetPreprocessingThreads(args.preprocessingThreads);
   searchParameter.SetUseMultithreading(true);
 
   for (osmscout::MagnificationLevel level=osmscout::MagnificationLevel(std::min(args.startZoom,args.endZoom));
@@ -17,19 +17,30 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cstdlib>
 #include <cstring>
 #include <cstdio>
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <locale>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <osmscout/util/CmdLineParsing.h>
 #include <osmscout/util/File.h>
+#include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/import/Import.h>
+#include <osmscout/import/ImportShard.h>
 
 static std::string VehcileMaskToString(osmscout::VehicleMask vehicleMask)
 {
@@ -71,6 +82,12 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --destinationDirectory <path>        destination for generated map files (default: " << parameter.GetDestinationDirectory() << ")" << std::endl;
   std::cout << std::endl;
   std::cout << " --bounding-polygon <*.poly>          optional polygon file containing the bounding polygon of the import area" << std::endl;
+  std::cout << " --clip-box <lat,lon,lat,lon>         only import objects touching the given bounding box" << std::endl;
+  std::cout << std::endl;
+  std::cout << " --shard-box <lat,lon,lat,lon>        import the given area as shards, each into a sub directory of the destination directory" << std::endl;
+  std::cout << " --shard-level <number>               magnification level of the shard tile grid (default: 8)" << std::endl;
+  std::cout << " --shard-overlap <degrees>            overlap of neighbouring shards (default: 0.1)" << std::endl;
+  std::cout << " --shard-processes <number>           number of shards imported in parallel (default: number of cores)" << std::endl;
   std::cout << std::endl;
 
   std::cout << " --router <router description>        definition of a router (default: car,bicycle,foot:router)" << std::endl;
@@ -79,6 +96,8 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --strictAreas true|false             assure that areas are simple (default: " << osmscout::BoolToString(parameter.GetStrictAreas()) << ")" << std::endl;
 
   std::cout << " --processingQueueSize <number>       size of of the processing worker queues (default: " << parameter.GetProcessingQueueSize() << ")" << std::endl;
+  std::cout << " --parallelOSMParsing true|false      parse *.osm files in parallel chunks (default: " << osmscout::BoolToString(parameter.GetParallelOSMParsing()) << ")" << std::endl;
+  std::cout << " --parallelOSMChunkSize <number>      size of one chunk in bytes for parallel parsing (default: " << parameter.GetParallelOSMChunkSize() << ")" << std::endl;
   std::cout << std::endl;
 
   std::cout << " --numericIndexPageSize <number>      size of an numeric index page in bytes (default: " << parameter.GetNumericIndexPageSize() << ")" << std::endl;
@@ -94,6 +113,7 @@ void DumpHelp(osmscout::ImportParameter& parameter)
 
   std::cout << " --noSort                             do not sort objects" << std::endl;
   std::cout << " --sortBlockSize <number>             size of one data block during sorting (default: " << parameter.GetSortBlockSize() << ")" << std::endl;
+  std::cout << " --sortHilbertOrder true|false        order data files along a Hilbert curve (default: " << osmscout::BoolToString(parameter.GetSortHilbertOrder()) << ")" << std::endl;
 
   std::cout << " --coordDataMemoryMaped true|false    memory maped coord data file access (default: " << osmscout::BoolToString(parameter.GetCoordDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --coordIndexCacheSize <number>       coord index cache size (default: " << parameter.GetCoordIndexCacheSize() << ")" << std::endl;
@@ -110,6 +130,11 @@ void DumpHelp(osmscout::ImportParameter& parameter)
 
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << parameter.GetRouteNodeBlockSize() << ")" << std::endl;
   std::cout << std::endl;
+  std::cout << " --geometryBands true|false           generate simplified geometry of ways and areas (default: " << osmscout::BoolToString(parameter.GetGeometryBands()) << ")" << std::endl;
+  std::cout << " --geometryBandMinMag <number>        magnification of the coarsest geometry band (default: " << parameter.GetGeometryBandMinMag().Get() << ")" << std::endl;
+  std::cout << " --geometryBandMaxMag <number>        magnification of the most detailed geometry band (default: " << parameter.GetGeometryBandMaxMag().Get() << ")" << std::endl;
+  std::cout << " --geometryBandTolerance <number>     allowed deviation of simplified geometry in pixel (default: " << parameter.GetGeometryBandTolerance() << ")" << std::endl;
+  std::cout << std::endl;
   std::cout << " --langOrder <#|lang1[,#|lang2]..>    language order when parsing lang[:language] and place_name[:language] tags" << std::endl
             << "                                      # is the default language (no :language) (default: #)" << std::endl;
   std::cout << " --altLangOrder <#|lang1[,#|lang2]..> same as --langOrder for a second alternate language (default: none)" << std::endl;
@@ -121,6 +146,8 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --delete-debugging-files true|false  deletes all debugging files after execution of the importer" << std::endl;
   std::cout << " --delete-analysis-files true|false   deletes all analysis files after execution of the importer" << std::endl;
   std::cout << " --delete-report-files true|false     deletes all report files after execution of the importer" << std::endl;
+  std::cout << std::endl;
+  std::cout << " --trace <file>                       writes a trace of the import steps in Chrome trace format to the given file" << std::endl;
 }
 
 osmscout::ImportParameter::RouterRef ParseRouterArgument(int argc,
@@ -254,6 +281,9 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
                 " - "+
                 std::to_string(parameter.GetEndStep()));
 
+  if (parameter.GetClipBox().IsValid()) {
+    progress.Info(std::string("Clip box: ")+parameter.GetClipBox().GetDisplayText());
+  }
 
 
   for (const auto& router : parameter.GetRouter()) {
@@ -265,6 +295,10 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
 
   progress.Info(std::string("ProcessingQueueSize: ")+
                 std::to_string(parameter.GetProcessingQueueSize()));
+  progress.Info(std::string("ParallelOSMParsing: ")+
+                (parameter.GetParallelOSMParsing() ? "true" : "false"));
+  progress.Info(std::string("ParallelOSMChunkSize: ")+
+                std::to_string(parameter.GetParallelOSMChunkSize()));
 
   progress.Info(std::string("NumericIndexPageSize: ")+
                 std::to_string(parameter.GetNumericIndexPageSize()));
@@ -289,6 +323,8 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
                 (parameter.GetSortObjects() ? "true" : "false"));
   progress.Info(std::string("SortBlockSize: ")+
                 std::to_string(parameter.GetSortBlockSize()));
+  progress.Info(std::string("SortHilbertOrder: ")+
+                (parameter.GetSortHilbertOrder() ? "true" : "false"));
 
   progress.Info(std::string("CoordDataMemoryMaped: ")+
                 (parameter.GetCoordDataMemoryMaped() ? "true" : "false"));
@@ -323,6 +359,17 @@ static void DumpParameter(const osmscout::ImportParameter& parameter,
   progress.Info(std::string("RouteNodeBlockSize: ")+
                 std::to_string(parameter.GetRouteNodeBlockSize()));
 
+  progress.Info(std::string("GeometryBands: ")+
+                (parameter.GetGeometryBands() ? "true" : "false"));
+  if (parameter.GetGeometryBands()) {
+    progress.Info("GeometryBandMinMag: "+
+                  std::to_string(parameter.GetGeometryBandMinMag().Get()));
+    progress.Info("GeometryBandMaxMag: "+
+                  std::to_string(parameter.GetGeometryBandMaxMag().Get()));
+    progress.Info("GeometryBandTolerance: "+
+                  std::to_string(parameter.GetGeometryBandTolerance()));
+  }
+
 
   progress.Info(std::string("MaxAdminLevel: ")+
                 std::to_string(parameter.GetMaxAdminLevel()));
@@ -396,6 +443,197 @@ static void DeleteFilesIgnoreError(const osmscout::ImportParameter& parameter,
   }
 }
 
+static bool ParseDoubleArgument(int argc,
+                                char* argv[],
+                                int& currentIndex,
+                                double& value)
+{
+  std::string argument;
+
+  if (!osmscout::ParseStringArgument(argc,
+                                     argv,
+                                     currentIndex,
+                                     argument)) {
+    return false;
+  }
+
+  if (!osmscout::StringToNumber(argument.c_str(),
+                                value)) {
+    std::cerr << "Cannot parse number '" << argument << "'" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Parses a bounding box in the format "minLat,minLon,maxLat,maxLon"
+ */
+static bool ParseGeoBoxArgument(int argc,
+                                char* argv[],
+                                int& currentIndex,
+                                osmscout::GeoBox& box)
+{
+  std::string argument;
+
+  if (!osmscout::ParseStringArgument(argc,
+                                     argv,
+                                     currentIndex,
+                                     argument)) {
+    return false;
+  }
+
+  std::list<std::string> values=osmscout::SplitString(argument,",");
+  std::vector<double>    numbers;
+
+  for (const auto& value : values) {
+    double number;
+
+    if (!osmscout::StringToNumber(value.c_str(),
+                                  number)) {
+      break;
+    }
+
+    numbers.push_back(number);
+  }
+
+  if (numbers.size()!=4 ||
+      numbers[0]<-90.0 || numbers[0]>90.0 ||
+      numbers[2]<-90.0 || numbers[2]>90.0 ||
+      numbers[1]<-180.0 || numbers[1]>180.0 ||
+      numbers[3]<-180.0 || numbers[3]>180.0) {
+    std::cerr << "Cannot parse bounding box '" << argument << "'" << std::endl;
+    return false;
+  }
+
+  box=osmscout::GeoBox(osmscout::GeoCoord(numbers[0],numbers[1]),
+                       osmscout::GeoCoord(numbers[2],numbers[3]));
+
+  return true;
+}
+
+static std::string GeoBoxToArgument(const osmscout::GeoBox& box)
+{
+  std::ostringstream stream;
+
+  stream.imbue(std::locale::classic());
+  stream << std::fixed << std::setprecision(7);
+  stream << box.GetMinLat() << "," << box.GetMinLon() << "," << box.GetMaxLat() << "," << box.GetMaxLon();
+
+  return stream.str();
+}
+
+static std::string QuoteArgument(const std::string& argument)
+{
+#if defined(_WIN32)
+  return "\""+argument+"\"";
+#else
+  std::string result="'";
+
+  for (char c : argument) {
+    if (c=='\'') {
+      result+="'\\''";
+    }
+    else {
+      result+=c;
+    }
+  }
+
+  return result+"'";
+#endif
+}
+
+/**
+ * Import every shard into its own sub directory of the destination directory
+ * by calling the importer executable itself for every shard. At most
+ * processCount imports run in parallel.
+ *
+ * The command line of the shard import is the given command line without
+ * the sharding options, extended by the destination directory, bounding polygon
+ * and clip box of the shard. The output of each shard import is written to
+ * the file "<shard name>.log" in the destination directory.
+ */
+static bool ImportShards(const std::string& executable,
+                         const std::vector<std::string>& arguments,
+                         const osmscout::ImportParameter& parameter,
+                         const std::vector<osmscout::ImportShard>& shards,
+                         size_t processCount,
+                         osmscout::Progress& progress)
+{
+  std::vector<std::string> commands;
+
+  for (const auto& shard : shards) {
+    std::string directory=osmscout::AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                    shard.GetName());
+    std::string polygonFile=directory+".poly";
+    std::string logFile=directory+".log";
+
+    std::error_code error;
+
+    std::filesystem::create_directories(directory,
+                                        error);
+
+    if (error) {
+      progress.Error("Cannot create shard directory '"+directory+"': "+error.message());
+      return false;
+    }
+
+    if (!shard.WritePolygonFile(polygonFile)) {
+      progress.Error("Cannot write shard polygon file '"+polygonFile+"'");
+      return false;
+    }
+
+    std::string command=QuoteArgument(executable);
+
+    for (const auto& argument : arguments) {
+      command+=" "+QuoteArgument(argument);
+    }
+
+    command+=" --destinationDirectory "+QuoteArgument(directory);
+    command+=" --bounding-polygon "+QuoteArgument(polygonFile);
+    command+=" --clip-box "+QuoteArgument(GeoBoxToArgument(shard.GetBoundingBox()));
+    command+=" > "+QuoteArgument(logFile)+" 2>&1";
+
+    commands.push_back(command);
+  }
+
+  std::atomic<size_t> nextCommand(0);
+  std::atomic<size_t> errorCount(0);
+  std::mutex          progressMutex;
+  auto                worker=[&]() {
+    size_t index;
+
+    while ((index=nextCommand++)<commands.size()) {
+      {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress.Info("Importing shard "+shards[index].GetName()+" ("+std::to_string(index+1)+"/"+std::to_string(shards.size())+")");
+      }
+
+      int result=std::system(commands[index].c_str());
+
+      if (result!=0) {
+        errorCount++;
+
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progress.Error("Import of shard "+shards[index].GetName()+" failed, see '"+
+                       osmscout::AppendFileToDir(parameter.GetDestinationDirectory(),shards[index].GetName())+".log'");
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+
+  for (size_t t=0; t<std::max(std::min(processCount,commands.size()),(size_t)1); t++) {
+    workers.emplace_back(worker);
+  }
+
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  return errorCount==0;
+}
+
 int main(int argc, char* argv[])
 {
   osmscout::ImportParameter parameter;
@@ -410,6 +648,13 @@ int main(int argc, char* argv[])
   bool                      deleteDebugging=false;
   bool                      deleteAnalysis=false;
   bool                      deleteReport=false;
+  std::string               traceFile;
+
+  osmscout::GeoBox          shardBox;
+  size_t                    shardLevel=8;
+  double                    shardOverlap=0.1;
+  size_t                    shardProcesses=std::max(std::thread::hardware_concurrency(),1u);
+  std::vector<std::string>  shardArguments;
 
   InitializeLocale(progress);
 
@@ -516,6 +761,52 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--clip-box")==0) {
+      osmscout::GeoBox clipBox;
+
+      if (ParseGeoBoxArgument(argc,
+                              argv,
+                              i,
+                              clipBox)) {
+        parameter.SetClipBox(clipBox);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--shard-box")==0) {
+      if (!ParseGeoBoxArgument(argc,
+                               argv,
+                               i,
+                               shardBox)) {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--shard-level")==0) {
+      if (!osmscout::ParseSizeTArgument(argc,
+                                        argv,
+                                        i,
+                                        shardLevel)) {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--shard-overlap")==0) {
+      if (!ParseDoubleArgument(argc,
+                               argv,
+                               i,
+                               shardOverlap) ||
+          shardOverlap<0.0) {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--shard-processes")==0) {
+      if (!osmscout::ParseSizeTArgument(argc,
+                                        argv,
+                                        i,
+                                        shardProcesses)) {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--router")==0) {
       if (firstRouterOption) {
         parameter.ClearRouter();
@@ -559,6 +850,32 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--parallelOSMParsing")==0) {
+      bool parallelOSMParsing;
+
+      if (osmscout::ParseBoolArgument(argc,
+                                      argv,
+                                      i,
+                                      parallelOSMParsing)) {
+        parameter.SetParallelOSMParsing(parallelOSMParsing);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--parallelOSMChunkSize")==0) {
+      size_t parallelOSMChunkSize;
+
+      if (osmscout::ParseSizeTArgument(argc,
+                                       argv,
+                                       i,
+                                       parallelOSMChunkSize)) {
+        parameter.SetParallelOSMChunkSize(parallelOSMChunkSize);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--numericIndexPageSize")==0) {
       size_t numericIndexPageSize;
 
@@ -668,6 +985,19 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--sortHilbertOrder")==0) {
+      bool sortHilbertOrder;
+
+      if (osmscout::ParseBoolArgument(argc,
+                                      argv,
+                                      i,
+                                      sortHilbertOrder)) {
+        parameter.SetSortHilbertOrder(sortHilbertOrder);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--coordDataMemoryMaped")==0) {
       bool coordDataMemoryMaped;
 
@@ -798,6 +1128,59 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--geometryBands")==0) {
+      bool geometryBands;
+
+      if (osmscout::ParseBoolArgument(argc,
+                                      argv,
+                                      i,
+                                      geometryBands)) {
+        parameter.SetGeometryBands(geometryBands);
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--geometryBandMinMag")==0) {
+      uint32_t geometryBandMinMag;
+
+      if (osmscout::ParseUInt32Argument(argc,
+                                        argv,
+                                        i,
+                                        geometryBandMinMag)) {
+        parameter.SetGeometryBandMinMag(osmscout::MagnificationLevel(geometryBandMinMag));
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--geometryBandMaxMag")==0) {
+      uint32_t geometryBandMaxMag;
+
+      if (osmscout::ParseUInt32Argument(argc,
+                                        argv,
+                                        i,
+                                        geometryBandMaxMag)) {
+        parameter.SetGeometryBandMaxMag(osmscout::MagnificationLevel(geometryBandMaxMag));
+      }
+      else {
+        parameterError=true;
+      }
+    }
+    else if (strcmp(argv[i],"--geometryBandTolerance")==0) {
+      double geometryBandTolerance;
+
+      if (ParseDoubleArgument(argc,
+                              argv,
+                              i,
+                              geometryBandTolerance) &&
+          geometryBandTolerance>0.0) {
+        parameter.SetGeometryBandTolerance(geometryBandTolerance);
+      }
+      else {
+        parameterError=true;
+      }
+    }
     else if (strcmp(argv[i],"--langOrder")==0) {
         std::vector<std::string> langOrder;
 
@@ -869,6 +1252,14 @@ int main(int argc, char* argv[])
         parameterError=true;
       }
     }
+    else if (strcmp(argv[i],"--trace")==0) {
+      if (!osmscout::ParseStringArgument(argc,
+                                         argv,
+                                         i,
+                                         traceFile)) {
+        parameterError=true;
+      }
+    }
     else if (strncmp(argv[i],"--",2)==0) {
       progress.Error("Unknown option: "+std::string(argv[i]));
 
@@ -887,6 +1278,21 @@ int main(int argc, char* argv[])
     parameterError=true;
   }
 
+  if (shardBox.IsValid()) {
+    // The shard imports get all arguments, except the sharding options
+    for (int arg=1; arg<argc; arg++) {
+      if (strcmp(argv[arg],"--shard-box")==0 ||
+          strcmp(argv[arg],"--shard-level")==0 ||
+          strcmp(argv[arg],"--shard-overlap")==0 ||
+          strcmp(argv[arg],"--shard-processes")==0) {
+        arg++;
+      }
+      else {
+        shardArguments.emplace_back(argv[arg]);
+      }
+    }
+  }
+
   if (parameterError) {
     DumpHelp(parameter);
     return 1;
@@ -932,18 +1338,49 @@ int main(int argc, char* argv[])
     // we ignore this exception, since it is likely a "not implemented" exception
   }
 
+  if (shardBox.IsValid()) {
+    std::vector<osmscout::ImportShard> shards=osmscout::ImportShard::GetShards(shardBox,
+                                                                               osmscout::MagnificationLevel((uint32_t)shardLevel),
+                                                                               shardOverlap);
+
+    progress.SetStep("Import shards");
+    progress.Info("Importing "+std::to_string(shards.size())+" shards with "+std::to_string(shardProcesses)+" processes");
+
+    if (!ImportShards(argv[0],
+                      shardArguments,
+                      parameter,
+                      shards,
+                      shardProcesses,
+                      progress)) {
+      progress.Error("Import failed!");
+      return 1;
+    }
+
+    progress.Info("Import OK!");
+    return 0;
+  }
+
   parameter.SetMapfiles(mapfiles);
   parameter.SetOptimizationWayMethod(osmscout::TransPolygon::quality);
 
   DumpParameter(parameter,
                 progress);
 
+  if (!traceFile.empty()) {
+    osmscout::tracer.Enable(true);
+  }
+
   int exitCode=0;
   try {
     osmscout::Importer importer(parameter);
 
     bool result=importer.Import(progress);
 
+    if (!traceFile.empty() &&
+        !osmscout::tracer.WriteChromeTrace(traceFile)) {
+      progress.Error("Cannot write trace file '"+traceFile+"'");
+    }
+
     progress.SetStep("Summary");
 
     if (result) {
@@ -0,0 +1,1059 @@
+/*
+  Benchmark - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/LocationService.h>
+
+#include <osmscout/routing/SimpleRoutingService.h>
+
+#include <osmscout/LabelLayouter.h>
+#include <osmscout/MapPainterNoOp.h>
+#include <osmscout/MapService.h>
+#include <osmscout/StyleConfig.h>
+
+#include <osmscout/util/CmdLineParsing.h>
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/StopClock.h>
+
+/**
+  Micro- and macro-benchmarks of the library against a given database
+  (by default the testregion database of the tests).
+
+  Each benchmark is executed a configurable number of times after some
+  untimed warm up runs. The result is written as JSON document with
+  min, max, mean and percentiles (in milliseconds) of each benchmark, so
+  that results of different releases can be compared automatically.
+
+  Examples (to be executed in the Tests top level directory):
+
+  Benchmark data/testregion ../stylesheets/standard.oss
+  Benchmark --iterations 100 --output benchmark.json data/testregion ../stylesheets/standard.oss
+*/
+
+struct Arguments
+{
+  bool                     help=false;
+  bool                     debug=false;
+  size_t                   iterations=50;
+  size_t                   warmup=1;
+  std::string              output="benchmark.json";
+  std::string              filter;
+  std::string              databaseDirectory;
+  std::string              style;
+  osmscout::GeoCoord       routeStart{50.412,14.534};
+  osmscout::GeoCoord       routeTarget{50.424,14.6013};
+  std::vector<std::string> searchStrings{"Janova Ves","Hradsko","Sedlec"};
+};
+
+/**
+ * Timing result of one benchmark
+ */
+struct BenchmarkResult
+{
+  std::string         name;
+  std::string         kind;    //!< "micro" or "macro"
+  std::vector<double> samples; //!< Execution time of each iteration in milliseconds
+  bool                success=true;
+
+  /**
+   * Percentile using the nearest rank method, samples must be sorted
+   */
+  double GetPercentile(double percentile) const
+  {
+    auto rank=(size_t)std::ceil(percentile/100.0*samples.size());
+
+    return samples[std::max((size_t)1,rank)-1];
+  }
+
+  double GetMean() const
+  {
+    double sum=0.0;
+
+    for (auto sample : samples) {
+      sum+=sample;
+    }
+
+    return sum/samples.size();
+  }
+};
+
+class BenchmarkSuite
+{
+public:
+  using Prepare       = std::function<void()>;
+  using Body          = std::function<bool()>;
+  using MeasuringBody = std::function<bool(double& time)>; //!< Body measuring its execution time (in ms) itself
+
+private:
+  const Arguments&             args;
+  std::vector<BenchmarkResult> results;
+
+public:
+  explicit BenchmarkSuite(const Arguments& args)
+  : args(args)
+  {
+    // no code
+  }
+
+  /**
+   * Executes the body the configured number of times and records the
+   * execution time returned by each call. The optional prepare function
+   * is called before each call of the body.
+   */
+  void RunMeasuring(const std::string& name,
+                    const std::string& kind,
+                    const Prepare& prepare,
+                    const MeasuringBody& body)
+  {
+    if (!args.filter.empty() &&
+        name.find(args.filter)==std::string::npos) {
+      return;
+    }
+
+    BenchmarkResult result;
+
+    result.name=name;
+    result.kind=kind;
+    result.samples.reserve(args.iterations);
+
+    for (size_t i=0; i<args.warmup+args.iterations; i++) {
+      if (prepare) {
+        prepare();
+      }
+
+      double time=0.0;
+      bool   success=body(time);
+
+      if (!success) {
+        std::cerr << "Benchmark '" << name << "' failed" << std::endl;
+        result.success=false;
+        break;
+      }
+
+      if (i>=args.warmup) {
+        result.samples.push_back(time);
+      }
+    }
+
+    std::sort(result.samples.begin(),result.samples.end());
+
+    if (result.success) {
+      std::cout << std::left << std::setw(44) << name << std::right << std::fixed << std::setprecision(3);
+      std::cout << " p50 " << std::setw(10) << result.GetPercentile(50.0) << " ms";
+      std::cout << " p90 " << std::setw(10) << result.GetPercentile(90.0) << " ms";
+      std::cout << " max " << std::setw(10) << result.samples.back() << " ms" << std::endl;
+    }
+
+    results.push_back(result);
+  }
+
+  /**
+   * Executes the body the configured number of times and records the
+   * execution time of each call. The optional prepare function is called
+   * before each call of the body, its execution time is not measured.
+   */
+  void Run(const std::string& name,
+           const std::string& kind,
+           const Prepare& prepare,
+           const Body& body)
+  {
+    RunMeasuring(name,kind,prepare,[&body](double& time) {
+      osmscout::StopClockNano timer;
+
+      bool success=body();
+
+      timer.Stop();
+
+      time=timer.GetNanoseconds()/1000000.0;
+
+      return success;
+    });
+  }
+
+  void Run(const std::string& name,
+           const std::string& kind,
+           const Body& body)
+  {
+    Run(name,kind,Prepare(),body);
+  }
+
+  bool Success() const
+  {
+    return std::all_of(results.begin(),
+                       results.end(),
+                       [](const BenchmarkResult& result) {
+                         return result.success;
+                       });
+  }
+
+  void WriteJson(std::ostream& stream) const;
+};
+
+static std::string EscapeJson(const std::string& value)
+{
+  std::string result;
+
+  for (char c : value) {
+    if (c=='"' || c=='\\') {
+      result+='\\';
+      result+=c;
+    }
+    else if ((unsigned char)c<0x20) {
+      std::ostringstream buffer;
+
+      buffer << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c;
+      result+=buffer.str();
+    }
+    else {
+      result+=c;
+    }
+  }
+
+  return result;
+}
+
+void BenchmarkSuite::WriteJson(std::ostream& stream) const
+{
+  stream << std::fixed << std::setprecision(6);
+  stream << "{" << std::endl;
+  stream << "  \"database\": \"" << EscapeJson(args.databaseDirectory) << "\"," << std::endl;
+  stream << "  \"style\": \"" << EscapeJson(args.style) << "\"," << std::endl;
+  stream << "  \"iterations\": " << args.iterations << "," << std::endl;
+  stream << "  \"warmup\": " << args.warmup << "," << std::endl;
+  stream << "  \"unit\": \"ms\"," << std::endl;
+  stream << "  \"benchmarks\": [";
+
+  for (size_t r=0; r<results.size(); r++) {
+    const BenchmarkResult& result=results[r];
+
+    stream << (r>0 ? "," : "") << std::endl;
+    stream << "    {" << std::endl;
+    stream << "      \"name\": \"" << EscapeJson(result.name) << "\"," << std::endl;
+    stream << "      \"kind\": \"" << EscapeJson(result.kind) << "\"," << std::endl;
+    stream << "      \"success\": " << (result.success ? "true" : "false");
+
+    if (result.success && !result.samples.empty()) {
+      stream << "," << std::endl;
+      stream << "      \"iterations\": " << result.samples.size() << "," << std::endl;
+      stream << "      \"min\": " << result.samples.front() << "," << std::endl;
+      stream << "      \"mean\": " << result.GetMean() << "," << std::endl;
+      stream << "      \"p50\": " << result.GetPercentile(50.0) << "," << std::endl;
+      stream << "      \"p90\": " << result.GetPercentile(90.0) << "," << std::endl;
+      stream << "      \"p95\": " << result.GetPercentile(95.0) << "," << std::endl;
+      stream << "      \"p99\": " << result.GetPercentile(99.0) << "," << std::endl;
+      stream << "      \"max\": " << result.samples.back();
+    }
+
+    stream << std::endl;
+    stream << "    }";
+  }
+
+  stream << std::endl;
+  stream << "  ]" << std::endl;
+  stream << "}" << std::endl;
+}
+
+//
+// Label layouting
+//
+
+class BenchmarkTextLayouter;
+
+using BenchmarkLabel = osmscout::Label<int, std::string>;
+using BenchmarkLabelLayouter = osmscout::LabelLayouter<int, std::string, BenchmarkTextLayouter>;
+
+namespace osmscout {
+  template<>
+  std::vector<Glyph<int>> BenchmarkLabel::ToGlyphs() const
+  {
+    std::vector<Glyph<int>> glyphs(text.length());
+
+    for (size_t i=0; i<glyphs.size(); i++) {
+      glyphs[i].glyph=(int)fontSize;
+      glyphs[i].position=Vertex2D(i*0.5*height,0.0);
+    }
+
+    return glyphs;
+  }
+}
+
+/**
+ * Text layouter with fixed glyph metrics, so label layouting can be
+ * measured without a font backend
+ */
+class BenchmarkTextLayouter
+{
+public:
+  osmscout::DoubleRectangle GlyphBoundingBox(const int& fontHeight) const
+  {
+    return osmscout::DoubleRectangle(0.0,-fontHeight,0.5*fontHeight,fontHeight);
+  }
+
+  std::shared_ptr<BenchmarkLabel> Layout(const osmscout::Projection& projection,
+                                         const osmscout::MapParameter& parameter,
+                                         const std::string& text,
+                                         double fontSize,
+                                         double /*objectWidth*/,
+                                         bool /*enableWrapping*/,
+                                         bool /*contourLabel*/)
+  {
+    auto label=std::make_shared<BenchmarkLabel>(text);
+
+    label->text=text;
+    label->fontSize=fontSize;
+    label->height=projection.ConvertWidthToPixel(fontSize*parameter.GetFontSize());
+    label->width=0.5*label->height*text.length();
+
+    return label;
+  }
+};
+
+/**
+ * MapPainterNoOp passing all labels to a LabelLayouter and measuring
+ * the layouting of the labels of the last DrawMap() call
+ */
+class LabelLayoutPainter : public osmscout::MapPainterNoOp
+{
+private:
+  BenchmarkTextLayouter  textLayouter;
+  BenchmarkLabelLayouter labelLayouter;
+  double                 layoutTime=0.0;
+
+protected:
+  void BeforeDrawing(const osmscout::StyleConfig& /*styleConfig*/,
+                     const osmscout::Projection& projection,
+                     const osmscout::MapParameter& parameter,
+                     const osmscout::MapData& /*data*/) override
+  {
+    labelLayouter.SetViewport(osmscout::DoubleRectangle(0,0,projection.GetWidth(),projection.GetHeight()));
+    labelLayouter.SetLayoutOverlap(parameter.GetDropNotVisiblePointLabels() ? 0 : 1);
+  }
+
+  void RegisterRegularLabel(const osmscout::Projection& projection,
+                            const osmscout::MapParameter& parameter,
+                            const std::vector<osmscout::LabelData>& labels,
+                            const osmscout::Vertex2D& position,
+                            double objectWidth) override
+  {
+    labelLayouter.RegisterLabel(projection,parameter,position,labels,objectWidth);
+  }
+
+  void RegisterContourLabel(const osmscout::Projection& projection,
+                            const osmscout::MapParameter& parameter,
+                            const osmscout::PathLabelData& label,
+                            const osmscout::LabelPath& labelPath) override
+  {
+    labelLayouter.RegisterContourLabel(projection,parameter,label,labelPath);
+  }
+
+  void DrawLabels(const osmscout::Projection& projection,
+                  const osmscout::MapParameter& parameter,
+                  const osmscout::MapData& /*data*/) override
+  {
+    osmscout::StopClockNano timer;
+
+    labelLayouter.Layout(projection,parameter);
+
+    timer.Stop();
+
+    layoutTime=timer.GetNanoseconds()/1000000.0;
+
+    labelLayouter.Reset();
+  }
+
+public:
+  explicit LabelLayoutPainter(const osmscout::StyleConfigRef& styleConfig)
+  : osmscout::MapPainterNoOp(styleConfig),
+    labelLayouter(&textLayouter)
+  {
+    // no code
+  }
+
+  double GetLayoutTime() const
+  {
+    return layoutTime;
+  }
+};
+
+//
+// Micro benchmarks
+//
+
+static const size_t FILESCANNER_VALUE_COUNT=100000;
+
+static bool BenchmarkFileScanner(BenchmarkSuite& suite)
+{
+  std::string                  filename="Benchmark.dat";
+  std::mt19937                 gen(4711);
+  std::uniform_int_distribution<uint32_t> number;
+  std::uniform_real_distribution<double>  lat(-90.0,90.0);
+  std::uniform_real_distribution<double>  lon(-180.0,180.0);
+  std::vector<uint32_t>        numbers;
+  std::vector<osmscout::GeoCoord> coords;
+
+  numbers.reserve(FILESCANNER_VALUE_COUNT);
+  coords.reserve(FILESCANNER_VALUE_COUNT);
+
+  for (size_t i=0; i<FILESCANNER_VALUE_COUNT; i++) {
+    // Mix of small and big numbers for the variable length encoding
+    numbers.push_back(number(gen) >> (i%32));
+    coords.emplace_back(lat(gen),lon(gen));
+  }
+
+  try {
+    osmscout::FileWriter writer;
+
+    writer.Open(filename);
+
+    for (auto value : numbers) {
+      writer.WriteNumber(value);
+    }
+
+    for (const auto& coord : coords) {
+      writer.WriteCoord(coord);
+    }
+
+    for (size_t i=0; i<numbers.size(); i++) {
+      writer.WriteFileOffset(numbers[i],4);
+    }
+
+    writer.Close();
+  }
+  catch (osmscout::IOException& e) {
+    std::cerr << e.GetDescription() << std::endl;
+    return false;
+  }
+
+  for (bool mmap : {false, true}) {
+    osmscout::FileScanner scanner;
+    std::string           suffix=mmap ? ".mmap" : "";
+
+    try {
+      scanner.Open(filename,osmscout::FileScanner::Sequential,mmap);
+
+      osmscout::FileOffset coordsOffset;
+      osmscout::FileOffset offsetsOffset;
+      uint32_t             value;
+      osmscout::GeoCoord   coord;
+      osmscout::FileOffset offset;
+
+      for (size_t i=0; i<numbers.size(); i++) {
+        scanner.ReadNumber(value);
+      }
+
+      coordsOffset=scanner.GetPos();
+
+      for (size_t i=0; i<coords.size(); i++) {
+        scanner.ReadCoord(coord);
+      }
+
+      offsetsOffset=scanner.GetPos();
+
+      suite.Run("FileScanner.ReadNumber"+suffix,"micro",[&]() {
+        scanner.SetPos(0);
+
+        for (size_t i=0; i<numbers.size(); i++) {
+          scanner.ReadNumber(value);
+        }
+
+        return value==numbers.back();
+      });
+
+      suite.Run("FileScanner.ReadCoord"+suffix,"micro",[&]() {
+        scanner.SetPos(coordsOffset);
+
+        for (size_t i=0; i<coords.size(); i++) {
+          scanner.ReadCoord(coord);
+        }
+
+        return std::abs(coord.GetLat()-coords.back().GetLat())<0.0001;
+      });
+
+      suite.Run("FileScanner.ReadFileOffset"+suffix,"micro",[&]() {
+        scanner.SetPos(offsetsOffset);
+
+        for (size_t i=0; i<numbers.size(); i++) {
+          scanner.ReadFileOffset(offset,4);
+        }
+
+        return offset==numbers.back();
+      });
+
+      scanner.Close();
+    }
+    catch (osmscout::IOException& e) {
+      std::cerr << e.GetDescription() << std::endl;
+      scanner.CloseFailsafe();
+      osmscout::RemoveFile(filename);
+      return false;
+    }
+  }
+
+  osmscout::RemoveFile(filename);
+
+  return true;
+}
+
+/**
+ * Query parameter of the index benchmarks for one magnification
+ */
+struct IndexQuery
+{
+  osmscout::Magnification magnification;
+  osmscout::GeoBox        boundingBox;
+  osmscout::TypeInfoSet   nodeTypes;
+  osmscout::TypeInfoSet   wayTypes;
+  osmscout::TypeInfoSet   areaTypes;
+};
+
+static osmscout::MercatorProjection GetProjection(const osmscout::GeoBox& databaseBox,
+                                                  const osmscout::MagnificationLevel& level)
+{
+  osmscout::MercatorProjection projection;
+
+  projection.Set(databaseBox.GetCenter(),
+                 osmscout::Magnification(level),
+                 96.0,
+                 1024,
+                 768);
+
+  return projection;
+}
+
+static void BenchmarkIndexes(BenchmarkSuite& suite,
+                             const osmscout::DatabaseRef& database,
+                             const osmscout::StyleConfig& styleConfig,
+                             const osmscout::GeoBox& databaseBox,
+                             const osmscout::MagnificationLevel& level)
+{
+  osmscout::MercatorProjection projection=GetProjection(databaseBox,level);
+  osmscout::TypeConfigRef      typeConfig=database->GetTypeConfig();
+  std::string                  suffix=".L"+std::to_string(level.Get());
+  IndexQuery                   query;
+
+  query.magnification=projection.GetMagnification();
+  projection.GetDimensions(query.boundingBox);
+
+  styleConfig.GetNodeTypesWithMaxMag(query.magnification,query.nodeTypes);
+  styleConfig.GetWayTypesWithMaxMag(query.magnification,query.wayTypes);
+  styleConfig.GetAreaTypesWithMaxMag(query.magnification,query.areaTypes);
+
+  std::vector<osmscout::FileOffset>    nodeOffsets;
+  std::vector<osmscout::FileOffset>    wayOffsets;
+  std::vector<osmscout::DataBlockSpan> areaSpans;
+  osmscout::TypeInfoSet                loadedTypes;
+
+  suite.Run("AreaNodeIndex.GetOffsets"+suffix,"micro",[&]() {
+    nodeOffsets.clear();
+
+    return database->GetAreaNodeIndex()->GetOffsets(query.boundingBox,
+                                                    query.nodeTypes,
+                                                    nodeOffsets,
+                                                    loadedTypes);
+  });
+
+  suite.Run("AreaWayIndex.GetOffsets"+suffix,"micro",[&]() {
+    wayOffsets.clear();
+
+    return database->GetAreaWayIndex()->GetOffsets(query.boundingBox,
+                                                   query.wayTypes,
+                                                   wayOffsets,
+                                                   loadedTypes);
+  });
+
+  suite.Run("AreaAreaIndex.GetAreasInArea"+suffix,"micro",[&]() {
+    areaSpans.clear();
+
+    return database->GetAreaAreaIndex()->GetAreasInArea(*typeConfig,
+                                                        query.boundingBox,
+                                                        level.Get()+4,
+                                                        query.areaTypes,
+                                                        areaSpans,
+                                                        loadedTypes);
+  });
+
+  suite.Run("OptimizeWaysLowZoom.GetWays"+suffix,"micro",[&]() {
+    std::vector<osmscout::WayRef> ways;
+
+    return database->GetOptimizeWaysLowZoom()->GetWays(query.boundingBox,
+                                                       query.magnification,
+                                                       query.wayTypes,
+                                                       ways,
+                                                       loadedTypes);
+  });
+
+  suite.Run("OptimizeAreasLowZoom.GetAreas"+suffix,"micro",[&]() {
+    std::vector<osmscout::AreaRef> areas;
+
+    return database->GetOptimizeAreasLowZoom()->GetAreas(query.boundingBox,
+                                                         query.magnification,
+                                                         query.areaTypes,
+                                                         areas,
+                                                         loadedTypes);
+  });
+
+  suite.Run("WaterIndex.GetRegions"+suffix,"micro",[&]() {
+    std::list<osmscout::GroundTile> tiles;
+
+    return database->GetWaterIndex()->GetRegions(query.boundingBox,
+                                                 query.magnification,
+                                                 tiles);
+  });
+
+  // Data files, caches are flushed before each load to measure decoding
+
+  auto flushCache=[&database]() {
+    database->FlushCache();
+  };
+
+  suite.Run("NodeDataFile.GetByOffset"+suffix,"micro",flushCache,[&]() {
+    std::vector<osmscout::NodeRef> nodes;
+
+    return database->GetNodeDataFile()->GetByOffset(nodeOffsets.begin(),
+                                                    nodeOffsets.end(),
+                                                    nodeOffsets.size(),
+                                                    nodes);
+  });
+
+  suite.Run("WayDataFile.GetByOffset"+suffix,"micro",flushCache,[&]() {
+    std::vector<osmscout::WayRef> ways;
+
+    return database->GetWayDataFile()->GetByOffset(wayOffsets.begin(),
+                                                   wayOffsets.end(),
+                                                   wayOffsets.size(),
+                                                   ways);
+  });
+
+  suite.Run("AreaDataFile.GetByBlockSpans"+suffix,"micro",flushCache,[&]() {
+    std::vector<osmscout::AreaRef> areas;
+
+    return database->GetAreaDataFile()->GetByBlockSpans(areaSpans.begin(),
+                                                        areaSpans.end(),
+                                                        areas);
+  });
+}
+
+static void BenchmarkLabelLayout(BenchmarkSuite& suite)
+{
+  std::mt19937                       gen(4711);
+  std::uniform_real_distribution<double> x(0.0,1920.0);
+  std::uniform_real_distribution<double> y(0.0,1080.0);
+  std::uniform_int_distribution<size_t>  length(3,20);
+  BenchmarkTextLayouter              textLayouter;
+  BenchmarkLabelLayouter             layouter(&textLayouter);
+  osmscout::MercatorProjection       projection;
+  osmscout::MapParameter             parameter;
+
+  projection.Set(osmscout::GeoCoord(50.0,14.0),
+                 osmscout::Magnification(osmscout::MagnificationLevel(15)),
+                 96.0,
+                 1920,
+                 1080);
+
+  layouter.SetViewport(osmscout::DoubleRectangle(0,0,projection.GetWidth(),projection.GetHeight()));
+
+  std::vector<std::pair<osmscout::Vertex2D,osmscout::LabelData>> labels(2000);
+
+  for (auto& label : labels) {
+    label.first=osmscout::Vertex2D(x(gen),y(gen));
+    label.second.type=osmscout::LabelData::Type::Text;
+    label.second.text=std::string(length(gen),'x');
+    label.second.fontSize=1.0;
+    label.second.priority=length(gen);
+  }
+
+  suite.Run("LabelLayouter.Layout.2000","micro",[&]() {
+    for (const auto& label : labels) {
+      layouter.RegisterLabel(projection,
+                             parameter,
+                             label.first,
+                             {label.second});
+    }
+
+    layouter.Layout(projection,parameter);
+
+    bool success=!layouter.Labels().empty();
+
+    layouter.Reset();
+
+    return success;
+  });
+}
+
+//
+// Macro benchmarks
+//
+
+static void BenchmarkRendering(BenchmarkSuite& suite,
+                               const osmscout::DatabaseRef& database,
+                               const osmscout::StyleConfigRef& styleConfig,
+                               const osmscout::GeoBox& databaseBox,
+                               const osmscout::MagnificationLevel& level)
+{
+  osmscout::MercatorProjection  projection=GetProjection(databaseBox,level);
+  osmscout::MapServiceRef       mapService=std::make_shared<osmscout::MapService>(database);
+  osmscout::MapParameter        drawParameter;
+  osmscout::AreaSearchParameter searchParameter;
+  osmscout::MapData             data;
+  osmscout::MapPainterNoOp      painter(styleConfig);
+  LabelLayoutPainter            labelPainter(styleConfig);
+  std::string                   suffix=".L"+std::to_string(level.Get());
+
+  suite.Run("MapService.LoadData"+suffix,
+            "macro",
+            [&]() {
+              mapService->FlushTileCache();
+              database->FlushCache();
+            },
+            [&]() {
+              std::list<osmscout::TileRef> tiles;
+
+              data.ClearDBData();
+
+              mapService->LookupTiles(projection,tiles);
+
+              if (!mapService->LoadMissingTileData(searchParameter,*styleConfig,tiles)) {
+                return false;
+              }
+
+              mapService->AddTileDataToMapData(tiles,data);
+
+              return true;
+            });
+
+  suite.Run("MapPainterNoOp.DrawMap"+suffix,"macro",[&]() {
+    return painter.DrawMap(projection,drawParameter,data);
+  });
+
+  // Only the layouting itself is measured, not the preceding rendering steps
+  suite.RunMeasuring("MapPainter.LabelLayout"+suffix,
+                     "macro",
+                     BenchmarkSuite::Prepare(),
+                     [&](double& time) {
+                       if (!labelPainter.DrawMap(projection,drawParameter,data)) {
+                         return false;
+                       }
+
+                       time=labelPainter.GetLayoutTime();
+
+                       return true;
+                     });
+}
+
+static void BenchmarkRouting(BenchmarkSuite& suite,
+                             const osmscout::DatabaseRef& database,
+                             const Arguments& args)
+{
+  osmscout::RouterParameter         routerParameter;
+  osmscout::SimpleRoutingServiceRef router=std::make_shared<osmscout::SimpleRoutingService>(database,
+                                                                                          routerParameter,
+                                                                                          osmscout::RoutingService::DEFAULT_FILENAME_BASE);
+
+  if (!router->Open()) {
+    suite.Run("Routing.Open","macro",[]() {
+      return false;
+    });
+    return;
+  }
+
+  osmscout::TypeConfigRef typeConfig=database->GetTypeConfig();
+
+  for (auto vehicle : {osmscout::vehicleCar, osmscout::vehicleBicycle, osmscout::vehicleFoot}) {
+    osmscout::FastestPathRoutingProfile profile(typeConfig);
+    std::string                         name;
+
+    switch (vehicle) {
+    case osmscout::vehicleFoot:
+      profile.ParametrizeForFoot(*typeConfig,5.0);
+      name="Foot";
+      break;
+    case osmscout::vehicleBicycle:
+      profile.ParametrizeForBicycle(*typeConfig,20.0);
+      name="Bicycle";
+      break;
+    case osmscout::vehicleCar:
+      std::map<std::string,double> carSpeedTable{{"highway_motorway",110.0},
+                                                 {"highway_motorway_trunk",100.0},
+                                                 {"highway_motorway_primary",70.0},
+                                                 {"highway_motorway_link",60.0},
+                                                 {"highway_motorway_junction",60.0},
+                                                 {"highway_trunk",100.0},
+                                                 {"highway_trunk_link",60.0},
+                                                 {"highway_primary",70.0},
+                                                 {"highway_primary_link",60.0},
+                                                 {"highway_secondary",60.0},
+                                                 {"highway_secondary_link",50.0},
+                                                 {"highway_tertiary",55.0},
+                                                 {"highway_tertiary_link",55.0},
+                                                 {"highway_unclassified",50.0},
+                                                 {"highway_road",50.0},
+                                                 {"highway_residential",40.0},
+                                                 {"highway_roundabout",40.0},
+                                                 {"highway_living_street",10.0},
+                                                 {"highway_service",30.0}};
+
+      profile.ParametrizeForCar(*typeConfig,carSpeedTable,160.0);
+      name="Car";
+      break;
+    }
+
+    suite.Run("SimpleRoutingService.CalculateRoute."+name,
+              "macro",
+              [&database]() {
+                database->FlushCache();
+              },
+              [&]() {
+                osmscout::RoutingParameter parameter;
+                auto                       start=router->GetClosestRoutableNode(args.routeStart,
+                                                                                profile,
+                                                                                osmscout::Kilometers(1));
+                auto                       target=router->GetClosestRoutableNode(args.routeTarget,
+                                                                                 profile,
+                                                                                 osmscout::Kilometers(1));
+
+                if (!start.IsValid() ||
+                    !target.IsValid()) {
+                  return false;
+                }
+
+                osmscout::RoutingResult result=router->CalculateRoute(profile,
+                                                                      start.GetRoutePosition(),
+                                                                      target.GetRoutePosition(),
+                                                                      parameter);
+
+                if (!result.Success()) {
+                  return false;
+                }
+
+                return router->TransformRouteDataToRouteDescription(result.GetRoute()).Success();
+              });
+  }
+
+  router->Close();
+}
+
+static void BenchmarkLocationSearch(BenchmarkSuite& suite,
+                                    const osmscout::DatabaseRef& database,
+                                    const osmscout::GeoBox& databaseBox,
+                                    const Arguments& args)
+{
+  osmscout::LocationServiceRef locationService=std::make_shared<osmscout::LocationService>(database);
+
+  suite.Run("LocationService.SearchForLocationByString","macro",[&]() {
+    for (const auto& searchString : args.searchStrings) {
+      osmscout::LocationStringSearchParameter parameter(searchString);
+      osmscout::LocationSearchResult          result;
+
+      if (!locationService->SearchForLocationByString(parameter,result)) {
+        return false;
+      }
+    }
+
+    return true;
+  });
+
+  suite.Run("LocationService.ReverseLookupRegion","macro",[&]() {
+    const size_t gridSize=10;
+
+    for (size_t y=0; y<=gridSize; y++) {
+      for (size_t x=0; x<=gridSize; x++) {
+        osmscout::GeoCoord                  coord(databaseBox.GetMinLat()+databaseBox.GetHeight()*y/gridSize,
+                                                  databaseBox.GetMinLon()+databaseBox.GetWidth()*x/gridSize);
+        std::list<osmscout::AdminRegionRef> regions;
+
+        if (!locationService->ReverseLookupRegion(coord,regions)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  });
+}
+
+int main(int argc, char* argv[])
+{
+  osmscout::CmdLineParser argParser("Benchmark",
+                                    argc,argv);
+  std::vector<std::string> helpArgs{"h","help"};
+  Arguments                args;
+
+  argParser.AddOption(osmscout::CmdLineFlag([&args](const bool& value) {
+                        args.help=value;
+                      }),
+                      helpArgs,
+                      "Return argument help",
+                      true);
+
+  argParser.AddOption(osmscout::CmdLineFlag([&args](const bool& value) {
+                        args.debug=value;
+                      }),
+                      "debug",
+                      "Enable debug output",
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineSizeTOption([&args](const size_t& value) {
+                        args.iterations=std::max((size_t)1,value);
+                      }),
+                      "iterations",
+                      "Number of measured iterations of each benchmark, default: "+std::to_string(args.iterations),
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineSizeTOption([&args](const size_t& value) {
+                        args.warmup=value;
+                      }),
+                      "warmup",
+                      "Number of not measured iterations before each benchmark, default: "+std::to_string(args.warmup),
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineStringOption([&args](const std::string& value) {
+                        args.output=value;
+                      }),
+                      "output",
+                      "File to write the JSON result to, default: "+args.output,
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineStringOption([&args](const std::string& value) {
+                        args.filter=value;
+                      }),
+                      "filter",
+                      "Only run benchmarks with the given string in their name",
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineStringListOption([&args](const std::string& value) {
+                        args.searchStrings.push_back(value);
+                      }),
+                      "search",
+                      "Additional search string for the location search benchmark",
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
+                        args.routeStart=value;
+                      }),
+                      "route-start",
+                      "Start of the routing benchmarks",
+                      false);
+
+  argParser.AddOption(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
+                        args.routeTarget=value;
+                      }),
+                      "route-target",
+                      "Target of the routing benchmarks",
+                      false);
+
+  argParser.AddPositional(osmscout::CmdLineStringOption([&args](const std::string& value) {
+                            args.databaseDirectory=value;
+                          }),
+                          "DATABASE",
+                          "Directory of the database to use");
+
+  argParser.AddPositional(osmscout::CmdLineStringOption([&args](const std::string& value) {
+                            args.style=value;
+                          }),
+                          "STYLESHEET",
+                          "Map stylesheet");
+
+  osmscout::CmdLineParseResult result=argParser.Parse();
+
+  if (result.HasError()) {
+    std::cerr << "ERROR: " << result.GetErrorDescription() << std::endl;
+    std::cout << argParser.GetHelp() << std::endl;
+    return 1;
+  }
+
+  if (args.help) {
+    std::cout << argParser.GetHelp() << std::endl;
+    return 0;
+  }
+
+  osmscout::log.Debug(args.debug);
+  osmscout::log.Info(args.debug);
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(databaseParameter);
+
+  if (!database->Open(args.databaseDirectory)) {
+    std::cerr << "Cannot open database '" << args.databaseDirectory << "'" << std::endl;
+    return 1;
+  }
+
+  osmscout::StyleConfigRef styleConfig=std::make_shared<osmscout::StyleConfig>(database->GetTypeConfig());
+
+  if (!styleConfig->Load(args.style)) {
+    std::cerr << "Cannot open style '" << args.style << "'" << std::endl;
+    return 1;
+  }
+
+  osmscout::GeoBox databaseBox;
+
+  if (!database->GetBoundingBox(databaseBox)) {
+    std::cerr << "Cannot read bounding box of database" << std::endl;
+    return 1;
+  }
+
+  BenchmarkSuite suite(args);
+
+  if (!BenchmarkFileScanner(suite)) {
+    return 1;
+  }
+
+  for (auto level : {osmscout::MagnificationLevel(10),
+                     osmscout::MagnificationLevel(14),
+                     osmscout::MagnificationLevel(17)}) {
+    BenchmarkIndexes(suite,database,*styleConfig,databaseBox,level);
+  }
+
+  BenchmarkLabelLayout(suite);
+
+  for (auto level : {osmscout::MagnificationLevel(10),
+                     osmscout::MagnificationLevel(14),
+                     osmscout::MagnificationLevel(17)}) {
+    BenchmarkRendering(suite,database,styleConfig,databaseBox,level);
+  }
+
+  BenchmarkRouting(suite,database,args);
+  BenchmarkLocationSearch(suite,database,databaseBox,args);
+
+  database->Close();
+
+  std::ofstream stream(args.output,std::ios::trunc);
+
+  if (!stream) {
+    std::cerr << "Cannot open output file '" << args.output << "'" << std::endl;
+    return 1;
+  }
+
+  suite.WriteJson(stream);
+
+  return suite.Success() ? 0 : 1;
+}
@@ -0,0 +1,292 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/CoordDataFile.h>
+#include <osmscout/NodeDataFile.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/import/DatabaseUpdate.h>
+#include <osmscout/import/ImportFeatures.h>
+
+#if defined(OSMSCOUT_IMPORT_HAVE_XML_SUPPORT)
+#include <osmscout/import/OSMChangeReader.h>
+#endif
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+static std::string GetDatabaseDirectory()
+{
+  char* testsTopDirEnv=getenv("TESTS_TOP_DIR");
+
+  if (testsTopDirEnv==nullptr) {
+    return "data/testregion";
+  }
+
+  return osmscout::AppendFileToDir(testsTopDirEnv,"data/testregion");
+}
+
+static void WriteIdMap(const std::string& filename,
+                       osmscout::OSMRefType type,
+                       const std::vector<osmscout::FileOffset>& offsets)
+{
+  osmscout::FileWriter writer;
+
+  writer.Open(filename);
+  writer.Write((uint32_t)offsets.size());
+
+  for (size_t i=0; i<offsets.size(); i++) {
+    writer.Write((osmscout::Id)(i+1));
+    writer.Write((uint8_t)type);
+    writer.WriteFileOffset(offsets[i]);
+  }
+
+  writer.Close();
+}
+
+/**
+ * Copy the data files of the test region to a separate directory and write
+ * id mapping files for it. The test region does not contain the debugging
+ * files written by the importer, so ways get the synthetic OSM ids 1..n in
+ * file order.
+ */
+static std::string CreateDatabaseWithIdMaps(std::vector<osmscout::WayRef>& ways)
+{
+  std::string directory="DatabaseUpdateTestData";
+
+  std::filesystem::create_directories(directory);
+
+  for (const auto& file : {osmscout::TypeConfig::FILE_TYPES_DAT,
+                           osmscout::NodeDataFile::NODES_DAT,
+                           osmscout::WayDataFile::WAYS_DAT,
+                           osmscout::AreaDataFile::AREAS_DAT}) {
+    std::filesystem::copy_file(osmscout::AppendFileToDir(GetDatabaseDirectory(),file),
+                               osmscout::AppendFileToDir(directory,file),
+                               std::filesystem::copy_options::overwrite_existing);
+  }
+
+  osmscout::TypeConfig                 typeConfig;
+  osmscout::FileScanner                scanner;
+  uint32_t                             wayCount;
+  std::vector<osmscout::FileOffset>    wayOffsets;
+
+  REQUIRE(typeConfig.LoadFromDataFile(directory));
+
+  scanner.Open(osmscout::AppendFileToDir(directory,osmscout::WayDataFile::WAYS_DAT),
+               osmscout::FileScanner::Sequential,
+               false);
+  scanner.Read(wayCount);
+
+  for (uint32_t i=0; i<wayCount; i++) {
+    osmscout::WayRef way=std::make_shared<osmscout::Way>();
+
+    wayOffsets.push_back(scanner.GetPos());
+    way->Read(typeConfig,scanner);
+    ways.push_back(way);
+  }
+
+  scanner.Close();
+
+  WriteIdMap(osmscout::AppendFileToDir(directory,osmscout::NodeDataFile::NODES_IDMAP),
+             osmscout::osmRefNode,
+             {});
+  WriteIdMap(osmscout::AppendFileToDir(directory,osmscout::WayDataFile::WAYS_IDMAP),
+             osmscout::osmRefWay,
+             wayOffsets);
+  WriteIdMap(osmscout::AppendFileToDir(directory,osmscout::AreaDataFile::AREAS_IDMAP),
+             osmscout::osmRefWay,
+             {});
+
+  return directory;
+}
+
+static osmscout::OSMChange::WayChange ModifyWay(osmscout::OSMId id)
+{
+  osmscout::OSMChange::WayChange way;
+
+  way.action=osmscout::OSMChange::actionModify;
+  way.id=id;
+
+  return way;
+}
+
+#if defined(OSMSCOUT_IMPORT_HAVE_XML_SUPPORT)
+TEST_CASE("Read OSM change file")
+{
+  std::string filename="DatabaseUpdateTest.osc";
+
+  {
+    std::ofstream file(filename);
+
+    file << "<?xml version='1.0' encoding='UTF-8'?>" << std::endl;
+    file << "<osmChange version=\"0.6\" generator=\"test\">" << std::endl;
+    file << "  <create>" << std::endl;
+    file << "    <node id=\"10\" version=\"1\" lat=\"50.5\" lon=\"7.25\">" << std::endl;
+    file << "      <tag k=\"amenity\" v=\"bench\"/>" << std::endl;
+    file << "    </node>" << std::endl;
+    file << "  </create>" << std::endl;
+    file << "  <modify>" << std::endl;
+    file << "    <way id=\"20\" version=\"2\">" << std::endl;
+    file << "      <nd ref=\"10\"/>" << std::endl;
+    file << "      <nd ref=\"11\"/>" << std::endl;
+    file << "      <tag k=\"highway\" v=\"residential\"/>" << std::endl;
+    file << "    </way>" << std::endl;
+    file << "  </modify>" << std::endl;
+    file << "  <delete>" << std::endl;
+    file << "    <node id=\"12\" version=\"3\"/>" << std::endl;
+    file << "    <relation id=\"30\" version=\"4\">" << std::endl;
+    file << "      <member type=\"way\" ref=\"20\" role=\"outer\"/>" << std::endl;
+    file << "    </relation>" << std::endl;
+    file << "  </delete>" << std::endl;
+    file << "</osmChange>" << std::endl;
+  }
+
+  osmscout::ConsoleProgress progress;
+  osmscout::OSMChangeReader reader;
+  osmscout::OSMChange       change;
+
+  REQUIRE(reader.Read(progress,filename,change));
+
+  REQUIRE(change.GetChangeCount()==4);
+
+  REQUIRE(change.nodes.size()==2);
+  REQUIRE(change.nodes[0].action==osmscout::OSMChange::actionCreate);
+  REQUIRE(change.nodes[0].id==10);
+  REQUIRE(change.nodes[0].coord.GetLat()==50.5);
+  REQUIRE(change.nodes[0].coord.GetLon()==7.25);
+  REQUIRE(change.nodes[1].action==osmscout::OSMChange::actionDelete);
+  REQUIRE(change.nodes[1].id==12);
+
+  REQUIRE(change.ways.size()==1);
+  REQUIRE(change.ways[0].action==osmscout::OSMChange::actionModify);
+  REQUIRE(change.ways[0].id==20);
+  REQUIRE(change.ways[0].nodes==std::vector<osmscout::OSMId>{10,11});
+
+  REQUIRE(change.relations.size()==1);
+  REQUIRE(change.relations[0].action==osmscout::OSMChange::actionDelete);
+  REQUIRE(change.relations[0].id==30);
+  REQUIRE(change.relations[0].members.size()==1);
+  REQUIRE(change.relations[0].members[0].type==osmscout::RawRelation::memberWay);
+  REQUIRE(change.relations[0].members[0].id==20);
+  REQUIRE(change.relations[0].members[0].role=="outer");
+
+  std::filesystem::remove(filename);
+}
+#endif
+
+TEST_CASE("Database without id mapping requires full rebuild")
+{
+  osmscout::ImportParameter       parameter;
+  osmscout::ConsoleProgress       progress;
+  osmscout::OSMChange             change;
+  osmscout::DatabaseUpdatePlanner planner;
+  osmscout::DatabaseUpdatePlan    plan;
+
+  parameter.SetDestinationDirectory(GetDatabaseDirectory());
+  change.ways.push_back(ModifyWay(1));
+
+  REQUIRE(planner.Plan(parameter,progress,change,plan));
+  REQUIRE(plan.fullRebuild);
+  REQUIRE(!plan.reason.empty());
+}
+
+TEST_CASE("Changed way is mapped to the index cells of its geometry")
+{
+  std::vector<osmscout::WayRef> ways;
+  std::string                   directory=CreateDatabaseWithIdMaps(ways);
+
+  REQUIRE(ways.size()>=3);
+
+  osmscout::ImportParameter       parameter;
+  osmscout::ConsoleProgress       progress;
+  osmscout::OSMChange             change;
+  osmscout::DatabaseUpdatePlanner planner;
+  osmscout::DatabaseUpdatePlan    plan;
+
+  parameter.SetDestinationDirectory(directory);
+
+  change.ways.push_back(ModifyWay(1));
+  change.ways.push_back(ModifyWay(3));
+
+  SECTION("Incremental update") {
+    REQUIRE(planner.Plan(parameter,progress,change,plan));
+
+    REQUIRE(!plan.fullRebuild);
+    REQUIRE(plan.databaseObjectCount==ways.size());
+    REQUIRE(plan.changedObjects.size()==2);
+    REQUIRE(plan.createdObjects.empty());
+    REQUIRE(plan.affectedObjects.size()==2);
+    REQUIRE(plan.affectedObjects.begin()->second.GetType()==osmscout::refWay);
+    REQUIRE(!plan.affectedCells.empty());
+
+    for (size_t i : {0,2}) {
+      osmscout::GeoBox             boundingBox=ways[i]->GetBoundingBox();
+      osmscout::MagnificationLevel level=parameter.GetAreaNodeGridMag();
+
+      REQUIRE(plan.affectedBoundingBox.Includes(boundingBox.GetMinCoord(),false));
+      REQUIRE(plan.affectedBoundingBox.Includes(boundingBox.GetMaxCoord(),false));
+      REQUIRE(plan.affectedCells.count(osmscout::TileId::GetTile(level,boundingBox.GetMinCoord()))==1);
+      REQUIRE(plan.affectedCells.count(osmscout::TileId::GetTile(level,boundingBox.GetMaxCoord()))==1);
+    }
+  }
+
+  SECTION("Too many affected cells") {
+    parameter.SetUpdateMaxAffectedCells(0);
+
+    REQUIRE(planner.Plan(parameter,progress,change,plan));
+    REQUIRE(plan.fullRebuild);
+  }
+
+  SECTION("Too many changed objects") {
+    parameter.SetUpdateMaxChangeRatio(1.0/(double)ways.size());
+
+    REQUIRE(planner.Plan(parameter,progress,change,plan));
+    REQUIRE(plan.fullRebuild);
+  }
+
+  SECTION("Moved node without coordinate file") {
+    osmscout::OSMChange::NodeChange node;
+
+    node.action=osmscout::OSMChange::actionModify;
+    node.id=1;
+    node.coord=ways[0]->GetBoundingBox().GetCenter();
+
+    change.nodes.push_back(node);
+
+    REQUIRE(planner.Plan(parameter,progress,change,plan));
+    REQUIRE(plan.fullRebuild);
+  }
+
+  SECTION("Created way") {
+    osmscout::OSMChange             createChange;
+    osmscout::OSMChange::WayChange  way=ModifyWay((osmscout::OSMId)ways.size()+1);
+    osmscout::OSMChange::NodeChange node;
+
+    node.action=osmscout::OSMChange::actionCreate;
+    node.id=1;
+    node.coord=ways[0]->GetBoundingBox().GetCenter();
+
+    way.action=osmscout::OSMChange::actionCreate;
+    way.nodes.push_back(node.id);
+
+    createChange.nodes.push_back(node);
+    createChange.ways.push_back(way);
+
+    REQUIRE(planner.Plan(parameter,progress,createChange,plan));
+    REQUIRE(!plan.fullRebuild);
+    REQUIRE(plan.createdObjects.size()==2);
+    REQUIRE(plan.affectedObjects.empty());
+    REQUIRE(plan.affectedCells.size()==1);
+  }
+
+  std::filesystem::remove_all(directory);
+}
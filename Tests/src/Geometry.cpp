@@ -248,3 +248,101 @@ TEST_CASE("Angle diff")
     }
   }
 }
+
+TEST_CASE("Simplify straight line")
+{
+  std::vector<osmscout::Point> nodes;
+
+  for (size_t i=0; i<=10; i++) {
+    nodes.emplace_back(0,osmscout::GeoCoord(50.0,14.0+i*0.01));
+  }
+
+  std::vector<osmscout::Point> simplified;
+
+  osmscout::SimplifyPolyline(nodes,0.0001,false,simplified);
+
+  REQUIRE(simplified.size()==2);
+  REQUIRE(simplified.front().GetCoord()==nodes.front().GetCoord());
+  REQUIRE(simplified.back().GetCoord()==nodes.back().GetCoord());
+}
+
+TEST_CASE("Simplify keeps points outside of tolerance")
+{
+  std::vector<osmscout::Point> nodes;
+
+  nodes.emplace_back(0,osmscout::GeoCoord(50.0,14.0));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.05,14.05));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.1,14.1));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.05,14.15));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.0,14.2));
+
+  std::vector<osmscout::Point> simplified;
+
+  osmscout::SimplifyPolyline(nodes,0.001,false,simplified);
+
+  REQUIRE(simplified.size()==3);
+  REQUIRE(simplified[1].GetCoord()==nodes[2].GetCoord());
+
+  osmscout::SimplifyPolyline(nodes,0.5,false,simplified);
+
+  REQUIRE(simplified.size()==2);
+}
+
+TEST_CASE("Simplify ring")
+{
+  std::vector<osmscout::Point> nodes;
+
+  // Square with additional points on its edges
+  nodes.emplace_back(0,osmscout::GeoCoord(50.0,14.0));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.0,14.05));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.0,14.1));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.05,14.1));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.1,14.1));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.1,14.05));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.1,14.0));
+  nodes.emplace_back(0,osmscout::GeoCoord(50.05,14.0));
+
+  std::vector<osmscout::Point> simplified;
+
+  osmscout::SimplifyPolyline(nodes,0.001,true,simplified);
+
+  REQUIRE(simplified.size()==4);
+
+  // Rings never collapse below three points
+  osmscout::SimplifyPolyline(nodes,1.0,true,simplified);
+
+  REQUIRE(simplified.size()==3);
+}
+
+TEST_CASE("Hilbert index of first level")
+{
+  REQUIRE(osmscout::GetHilbertIndex(0,0,1)==0);
+  REQUIRE(osmscout::GetHilbertIndex(0,1,1)==1);
+  REQUIRE(osmscout::GetHilbertIndex(1,1,1)==2);
+  REQUIRE(osmscout::GetHilbertIndex(1,0,1)==3);
+}
+
+TEST_CASE("Hilbert curve visits neighbouring cells")
+{
+  const uint32_t                            level=4;
+  const uint32_t                            size=1 << level;
+  std::vector<std::pair<uint32_t,uint32_t>> cells(size*size,std::make_pair(size,size));
+
+  for (uint32_t x=0; x<size; x++) {
+    for (uint32_t y=0; y<size; y++) {
+      uint64_t index=osmscout::GetHilbertIndex(x,y,level);
+
+      REQUIRE(index<cells.size());
+      REQUIRE(cells[index].first==size);
+
+      cells[index]=std::make_pair(x,y);
+    }
+  }
+
+  for (size_t i=1; i<cells.size(); i++) {
+    uint32_t dx=std::max(cells[i].first,cells[i-1].first)-std::min(cells[i].first,cells[i-1].first);
+    uint32_t dy=std::max(cells[i].second,cells[i-1].second)-std::min(cells[i].second,cells[i-1].second);
+
+    REQUIRE(dx+dy==1);
+  }
+}
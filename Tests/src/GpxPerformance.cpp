@@ -0,0 +1,171 @@
+/*
+  GpxPerformance - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdio>
+#include <iostream>
+
+#include <osmscout/gpx/Export.h>
+#include <osmscout/gpx/Import.h>
+#include <osmscout/gpx/TrackPointReader.h>
+#include <osmscout/gpx/TrackPointWriter.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
+
+/**
+  Compare throughput of the streaming TrackPointWriter/TrackPointReader with
+  the libxml based ExportGpx/ImportGpx for a generated track.
+
+  Usage: GpxPerformance [point count]
+*/
+
+static void PrintThroughput(const std::string &label,
+                            const osmscout::StopClock &timer,
+                            size_t pointCount,
+                            osmscout::FileOffset fileSize)
+{
+  double seconds=timer.GetMilliseconds()/1000.0;
+
+  std::cout << label << ": " << timer;
+
+  if (seconds>0) {
+    std::cout << ", " << (size_t)(pointCount/seconds) << " points/s";
+    std::cout << ", " << (fileSize/seconds/(1024*1024)) << " MiB/s";
+  }
+
+  std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t pointCount=1000000;
+
+  if (argc>1 &&
+      !osmscout::StringToNumber(argv[1],pointCount)) {
+    std::cerr << "Cannot parse point count '" << argv[1] << "'" << std::endl;
+    return 1;
+  }
+
+  std::string streamFile="GpxPerformanceStream.gpx";
+  std::string xmlFile="GpxPerformanceXml.gpx";
+
+  osmscout::gpx::GpxFile  gpxFile;
+  osmscout::gpx::Track    track;
+  osmscout::gpx::TrackSegment segment;
+  osmscout::Timestamp     start=osmscout::Timestamp::clock::now();
+
+  segment.points.reserve(pointCount);
+
+  for (size_t i=0; i<pointCount; i++) {
+    osmscout::gpx::TrackPoint point(osmscout::GeoCoord(50.0+i*0.00001,14.0+i*0.00002));
+
+    point.elevation=200.0+(i%100);
+    point.time=start+std::chrono::seconds(i);
+    point.hdop=1.5;
+
+    segment.points.push_back(point);
+  }
+
+  track.segments.push_back(std::move(segment));
+  gpxFile.tracks.push_back(std::move(track));
+
+  const auto &points=gpxFile.tracks.front().segments.front().points;
+
+  std::cout << "Writing and reading " << pointCount << " track points..." << std::endl;
+
+  {
+    osmscout::StopClock             timer;
+    osmscout::gpx::TrackPointWriter writer(streamFile);
+
+    writer.StartTrack();
+
+    for (const auto &point : points) {
+      writer.WritePoint(point);
+    }
+
+    if (!writer.Close()) {
+      std::cerr << "Cannot write " << streamFile << std::endl;
+      return 1;
+    }
+
+    timer.Stop();
+
+    PrintThroughput("TrackPointWriter",timer,pointCount,osmscout::GetFileSize(streamFile));
+  }
+
+  {
+    osmscout::StopClock timer;
+
+    if (!osmscout::gpx::ExportGpx(gpxFile,xmlFile)) {
+      std::cerr << "Cannot write " << xmlFile << std::endl;
+      return 1;
+    }
+
+    timer.Stop();
+
+    PrintThroughput("ExportGpx",timer,pointCount,osmscout::GetFileSize(xmlFile));
+  }
+
+  {
+    osmscout::StopClock             timer;
+    osmscout::gpx::TrackPointReader reader(streamFile);
+    osmscout::gpx::TrackPoint       point(osmscout::GeoCoord(0,0));
+    size_t                          count=0;
+
+    while (reader.Next(point)) {
+      count++;
+    }
+
+    timer.Stop();
+
+    if (reader.HasError() || count!=pointCount) {
+      std::cerr << "Cannot read " << streamFile << std::endl;
+      return 1;
+    }
+
+    PrintThroughput("TrackPointReader",timer,pointCount,osmscout::GetFileSize(streamFile));
+  }
+
+  {
+    osmscout::StopClock    timer;
+    osmscout::gpx::GpxFile imported;
+
+    if (!osmscout::gpx::ImportGpx(xmlFile,imported)) {
+      std::cerr << "Cannot read " << xmlFile << std::endl;
+      return 1;
+    }
+
+    timer.Stop();
+
+    if (imported.tracks.empty() ||
+        imported.tracks.front().segments.empty() ||
+        imported.tracks.front().segments.front().points.size()!=pointCount) {
+      std::cerr << "ImportGpx did not return all points of " << xmlFile << std::endl;
+      return 1;
+    }
+
+    PrintThroughput("ImportGpx",timer,pointCount,osmscout::GetFileSize(xmlFile));
+  }
+
+  std::remove(streamFile.c_str());
+  std::remove(xmlFile.c_str());
+
+  return 0;
+}
@@ -0,0 +1,270 @@
+/*
+  GpxStreamTest - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <osmscout/gpx/TrackPointReader.h>
+#include <osmscout/gpx/TrackPointWriter.h>
+
+#include <osmscout/util/String.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+using namespace osmscout::gpx;
+
+static const char *TestFile="GpxStreamTest.gpx";
+
+static void WriteFile(const std::string &content)
+{
+  std::ofstream stream(TestFile, std::ios::binary);
+
+  stream << content;
+}
+
+static std::vector<TrackPoint> ReadAll(TrackPointReader &reader)
+{
+  std::vector<TrackPoint> points;
+  TrackPoint              point(GeoCoord(0,0));
+
+  while (reader.Next(point)) {
+    points.push_back(point);
+  }
+
+  return points;
+}
+
+TEST_CASE("Written points are read back")
+{
+  Timestamp time;
+
+  REQUIRE(ParseISO8601TimeString("2017-03-12T14:31:56.0Z",time));
+
+  {
+    TrackPointWriter writer(TestFile);
+
+    REQUIRE(writer.IsOpen());
+    REQUIRE(writer.StartTrack(std::string("Track <1> & more")));
+    REQUIRE(writer.StartSegment());
+
+    TrackPoint full(GeoCoord(50.0755381, 14.4378005));
+
+    full.elevation=250.5;
+    full.time=time;
+    full.course=-12.25;
+    full.hdop=1.5;
+    full.vdop=2.0;
+    full.pdop=2.5;
+
+    REQUIRE(writer.WritePoint(full));
+    REQUIRE(writer.WritePoint(TrackPoint(GeoCoord(-0.000001, -179.999999))));
+    REQUIRE(writer.StartSegment());
+    REQUIRE(writer.WritePoint(TrackPoint(GeoCoord(1, 2))));
+    REQUIRE(writer.StartTrack());
+    REQUIRE(writer.WritePoint(TrackPoint(GeoCoord(3, 4))));
+    REQUIRE(writer.Close());
+  }
+
+  TrackPointReader reader(TestFile);
+  TrackPoint       point(GeoCoord(0,0));
+
+  REQUIRE(reader.IsOpen());
+
+  REQUIRE(reader.Next(point));
+  REQUIRE(reader.GetTrackIndex()==0);
+  REQUIRE(reader.GetSegmentIndex()==0);
+  REQUIRE(reader.GetTrackName()==std::string("Track <1> & more"));
+  REQUIRE(point.coord.GetLat()==Approx(50.075538));
+  REQUIRE(point.coord.GetLon()==Approx(14.437801));
+  REQUIRE(point.elevation==250.5);
+  REQUIRE(point.time==time);
+  REQUIRE(point.course==-12.25);
+  REQUIRE(point.hdop==1.5);
+  REQUIRE(point.vdop==2.0);
+  REQUIRE(point.pdop==2.5);
+
+  REQUIRE(reader.Next(point));
+  REQUIRE(point.coord.GetLat()==-0.000001);
+  REQUIRE(point.coord.GetLon()==-179.999999);
+  REQUIRE_FALSE(point.elevation);
+  REQUIRE_FALSE(point.time);
+
+  REQUIRE(reader.Next(point));
+  REQUIRE(reader.GetTrackIndex()==0);
+  REQUIRE(reader.GetSegmentIndex()==1);
+  REQUIRE(point.coord==GeoCoord(1, 2));
+
+  REQUIRE(reader.Next(point));
+  REQUIRE(reader.GetTrackIndex()==1);
+  REQUIRE(reader.GetSegmentIndex()==2);
+  REQUIRE_FALSE(reader.GetTrackName());
+  REQUIRE(point.coord==GeoCoord(3, 4));
+
+  REQUIRE_FALSE(reader.Next(point));
+  REQUIRE_FALSE(reader.HasError());
+
+  std::remove(TestFile);
+}
+
+TEST_CASE("Many points cross buffer boundaries")
+{
+  const size_t pointCount=20000;
+
+  {
+    TrackPointWriter writer(TestFile);
+
+    for (size_t i=0; i<pointCount; i++) {
+      TrackPoint point(GeoCoord(i/1000.0, -(double)i/1000.0));
+
+      point.elevation=(double)i;
+      REQUIRE(writer.WritePoint(point));
+    }
+  }
+
+  TrackPointReader reader(TestFile);
+  auto             points=ReadAll(reader);
+
+  REQUIRE_FALSE(reader.HasError());
+  REQUIRE(points.size()==pointCount);
+
+  for (size_t i=0; i<pointCount; i++) {
+    REQUIRE(points[i].coord.GetLat()==i/1000.0);
+    REQUIRE(points[i].elevation==(double)i);
+  }
+
+  std::remove(TestFile);
+}
+
+TEST_CASE("Tokenizer handles XML constructs used in the wild")
+{
+  WriteFile("\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<!DOCTYPE gpx>\n"
+            "<g:gpx xmlns:g=\"http://www.topografix.com/GPX/1/1\" creator='a > b'>\n"
+            "<!-- <trk><trkseg><trkpt lat=\"9\" lon=\"9\"/></trkseg></trk> -->\n"
+            "<g:wpt lat=\"5\" lon=\"5\"><g:ele>1</g:ele></g:wpt>\n"
+            "<g:rte><g:rtept lat=\"6\" lon=\"6\"/></g:rte>\n"
+            "<g:trk>\n"
+            "  <g:name><![CDATA[A<B]]> &amp; &#67;&#x44;</g:name>\n"
+            "  <g:trkseg>\n"
+            "    <g:trkpt lon = '2.5' lat=\"1.25\" ><g:ele> 10 </g:ele><g:extensions><g:ele>99</g:ele></g:extensions></g:trkpt>\n"
+            "    <g:trkpt lat=\"3\" lon=\"4\"/>\n"
+            "  </g:trkseg>\n"
+            "</g:trk>\n"
+            "</g:gpx>\n");
+
+  TrackPointReader reader(TestFile);
+  auto             points=ReadAll(reader);
+
+  REQUIRE_FALSE(reader.HasError());
+  REQUIRE(points.size()==2);
+  REQUIRE(reader.GetTrackName()==std::string("A<B & CD"));
+  REQUIRE(points[0].coord==GeoCoord(1.25, 2.5));
+  REQUIRE(points[0].elevation==10.0);
+  REQUIRE(points[1].coord==GeoCoord(3, 4));
+  REQUIRE_FALSE(points[1].elevation);
+
+  std::remove(TestFile);
+}
+
+TEST_CASE("Point time is parsed as UTC")
+{
+  WriteFile("<gpx><trk><trkseg>"
+            "<trkpt lat=\"1\" lon=\"2\"><time>2017-03-12T14:31:56Z</time></trkpt>"
+            "<trkpt lat=\"1\" lon=\"2\"><time>2017-03-12T14:31:56.250Z</time></trkpt>"
+            "<trkpt lat=\"1\" lon=\"2\"><time>1969-12-31T23:59:59.000Z</time></trkpt>"
+            "</trkseg></trk></gpx>");
+
+  TrackPointReader reader(TestFile);
+  auto             points=ReadAll(reader);
+
+  REQUIRE(points.size()==3);
+
+  std::vector<int64_t> millis;
+
+  for (const auto &point : points) {
+    REQUIRE(point.time);
+    millis.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(point.time->time_since_epoch()).count());
+  }
+
+  REQUIRE(millis[0]==1489329116000);
+  REQUIRE(millis[1]==1489329116250);
+  REQUIRE(millis[2]==-1000);
+
+  std::remove(TestFile);
+}
+
+TEST_CASE("Malformed files are reported")
+{
+  SECTION("Mismatched end element") {
+    WriteFile("<gpx><trk><trkseg><trkpt lat=\"1\" lon=\"2\"></trkseg></trk></gpx>");
+  }
+
+  SECTION("Missing coordinate") {
+    WriteFile("<gpx><trk><trkseg><trkpt lat=\"1\"/></trkseg></trk></gpx>");
+  }
+
+  SECTION("Truncated file") {
+    WriteFile("<gpx><trk><trkseg><trkpt lat=\"1\" lon=\"2\"/><trkpt lat=\"1\"");
+  }
+
+  TrackPointReader reader(TestFile);
+
+  ReadAll(reader);
+
+  REQUIRE(reader.HasError());
+
+  std::remove(TestFile);
+}
+
+TEST_CASE("Point filters match vector filters")
+{
+  std::vector<TrackPoint> points;
+
+  for (size_t i=0; i<100; i++) {
+    TrackPoint point(GeoCoord(50+(i%7)*0.00001, 14+i*0.000005));
+
+    point.hdop=(double)(i%40);
+    points.push_back(point);
+  }
+
+  std::vector<TrackPoint> expected=points;
+
+  FilterInaccuratePoints(expected, 20);
+  FilterNearPoints(expected, Meters(2));
+
+  InaccuratePointFilter   inaccurateFilter(20);
+  NearPointFilter         nearFilter(Meters(2));
+  std::vector<TrackPoint> filtered;
+
+  for (const auto &point : points) {
+    if (inaccurateFilter.Accept(point) &&
+        nearFilter.Accept(point)) {
+      filtered.push_back(point);
+    }
+  }
+
+  REQUIRE(filtered.size()==expected.size());
+
+  for (size_t i=0; i<filtered.size(); i++) {
+    REQUIRE(filtered[i].coord==expected[i].coord);
+  }
+}
@@ -0,0 +1,114 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <osmscout/import/ImportShard.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+TEST_CASE("Shards cover the import area")
+{
+  osmscout::GeoBox                   area(osmscout::GeoCoord(50.1,7.1),
+                                          osmscout::GeoCoord(51.9,9.9));
+  osmscout::MagnificationLevel       level(6);
+  osmscout::Magnification            magnification(level);
+  std::vector<osmscout::ImportShard> shards=osmscout::ImportShard::GetShards(area,
+                                                                             level,
+                                                                             0.1);
+
+  osmscout::TileIdBox tiles(magnification,area);
+
+  REQUIRE(!shards.empty());
+  REQUIRE(shards.size()==tiles.GetCount());
+
+  for (const auto& coord : {area.GetMinCoord(),
+                            area.GetMaxCoord(),
+                            area.GetCenter()}) {
+    size_t count=0;
+
+    for (const auto& shard : shards) {
+      if (shard.GetBoundingBox().Includes(coord,false)) {
+        count++;
+      }
+    }
+
+    REQUIRE(count>=1);
+  }
+
+  for (const auto& shard : shards) {
+    osmscout::GeoBox tileBox=shard.GetTile().GetBoundingBox(magnification);
+
+    REQUIRE(shard.GetLevel()==level);
+    REQUIRE(shard.GetBoundingBox().GetMinLat()==Approx(tileBox.GetMinLat()-0.1));
+    REQUIRE(shard.GetBoundingBox().GetMinLon()==Approx(tileBox.GetMinLon()-0.1));
+    REQUIRE(shard.GetBoundingBox().GetMaxLat()==Approx(tileBox.GetMaxLat()+0.1));
+    REQUIRE(shard.GetBoundingBox().GetMaxLon()==Approx(tileBox.GetMaxLon()+0.1));
+  }
+
+  // Shard names are unique
+  for (size_t i=0; i<shards.size(); i++) {
+    for (size_t j=i+1; j<shards.size(); j++) {
+      REQUIRE(shards[i].GetName()!=shards[j].GetName());
+    }
+  }
+}
+
+TEST_CASE("Shards are limited to the world")
+{
+  osmscout::GeoBox                   area(osmscout::GeoCoord(-90.0,-180.0),
+                                          osmscout::GeoCoord(90.0,180.0));
+  std::vector<osmscout::ImportShard> shards=osmscout::ImportShard::GetShards(area,
+                                                                             osmscout::MagnificationLevel(1),
+                                                                             1.0);
+
+  REQUIRE(!shards.empty());
+
+  for (const auto& shard : shards) {
+    REQUIRE(shard.GetBoundingBox().GetMinLat()>=-90.0);
+    REQUIRE(shard.GetBoundingBox().GetMinLon()>=-180.0);
+    REQUIRE(shard.GetBoundingBox().GetMaxLat()<=90.0);
+    REQUIRE(shard.GetBoundingBox().GetMaxLon()<=180.0);
+  }
+}
+
+TEST_CASE("Invalid area results in no shards")
+{
+  REQUIRE(osmscout::ImportShard::GetShards(osmscout::GeoBox(),
+                                           osmscout::MagnificationLevel(6),
+                                           0.1).empty());
+}
+
+TEST_CASE("Write shard polygon file")
+{
+  osmscout::ImportShard shard(osmscout::MagnificationLevel(6),
+                              osmscout::TileId(33,21),
+                              osmscout::GeoBox(osmscout::GeoCoord(50.5,7.25),
+                                               osmscout::GeoCoord(51.0,8.0)));
+  std::string           filename="ImportShardTest.poly";
+
+  REQUIRE(shard.GetName()=="shard_6_33_21");
+  REQUIRE(shard.WritePolygonFile(filename));
+
+  std::ifstream            file(filename);
+  std::vector<std::string> lines;
+  std::string              line;
+
+  while (std::getline(file,line)) {
+    lines.push_back(line);
+  }
+
+  file.close();
+
+  REQUIRE(lines==std::vector<std::string>{"shard_6_33_21",
+                                          "1",
+                                          "7.2500000 50.5000000",
+                                          "8.0000000 50.5000000",
+                                          "8.0000000 51.0000000",
+                                          "7.2500000 51.0000000",
+                                          "END",
+                                          "END"});
+
+  std::filesystem::remove(filename);
+}
@@ -0,0 +1,150 @@
+/*
+  LabelCanvasTest - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <random>
+
+#include <osmscout/LabelLayouter.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static bool CheckFlatCollision(const std::vector<uint64_t>& canvas,
+                               const Mask& mask,
+                               int height)
+{
+  for (int r=std::max(0,mask.rowFrom); r<=std::min(height-1, mask.rowTo); r++) {
+    for (int c=std::max(0,mask.cellFrom); c<=std::min((int)mask.size()-1,mask.cellTo); c++) {
+      if ((mask.d[c] & canvas[r*mask.size() + c])!=0) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+static void MarkFlat(std::vector<uint64_t>& canvas,
+                     const Mask& mask,
+                     int height)
+{
+  for (int r=std::max(0,mask.rowFrom); r<=std::min(height-1, mask.rowTo); r++) {
+    for (int c=std::max(0,mask.cellFrom); c<=std::min((int)mask.size()-1, mask.cellTo); c++) {
+      canvas[r*mask.size() + c]|=mask.d[c];
+    }
+  }
+}
+
+TEST_CASE("Overlapping rectangles collide")
+{
+  LabelCanvas canvas;
+  Mask        mask(11);
+
+  canvas.Reset(11, 400);
+
+  mask.prepare(IntRectangle(100, 100, 50, 20));
+  REQUIRE_FALSE(canvas.CheckCollision(mask));
+  canvas.Mark(mask);
+
+  mask.prepare(IntRectangle(140, 110, 50, 20));
+  REQUIRE(canvas.CheckCollision(mask));
+
+  mask.prepare(IntRectangle(151, 100, 50, 20));
+  REQUIRE_FALSE(canvas.CheckCollision(mask));
+
+  mask.prepare(IntRectangle(100, 200, 50, 20));
+  REQUIRE_FALSE(canvas.CheckCollision(mask));
+}
+
+TEST_CASE("Rectangles outside of the canvas are ignored")
+{
+  LabelCanvas canvas;
+  Mask        mask(2);
+
+  canvas.Reset(2, 64);
+
+  mask.prepare(IntRectangle(-100, -100, 50, 20));
+  canvas.Mark(mask);
+  REQUIRE_FALSE(canvas.CheckCollision(mask));
+
+  mask.prepare(IntRectangle(10, 60, 50, 20));
+  canvas.Mark(mask);
+  REQUIRE(canvas.CheckCollision(mask));
+}
+
+TEST_CASE("Reset clears the canvas")
+{
+  LabelCanvas canvas;
+  Mask        mask(11);
+
+  canvas.Reset(11, 400);
+
+  mask.prepare(IntRectangle(0, 0, 700, 400));
+  canvas.Mark(mask);
+  REQUIRE(canvas.CheckCollision(mask));
+
+  canvas.Reset(11, 400);
+  REQUIRE_FALSE(canvas.CheckCollision(mask));
+
+  canvas.Mark(mask);
+  canvas.Reset(20, 300);
+  REQUIRE(canvas.GetRowSize()==20);
+  REQUIRE(canvas.GetHeight()==300);
+
+  Mask otherMask(20);
+
+  otherMask.prepare(IntRectangle(0, 0, 1280, 300));
+  REQUIRE_FALSE(canvas.CheckCollision(otherMask));
+}
+
+TEST_CASE("Canvas matches flat bitmap")
+{
+  const int   width=1000;
+  const int   height=700;
+  const int   rowSize=width/64+1;
+
+  std::mt19937                       gen(4711);
+  std::uniform_int_distribution<int> x(-50, width);
+  std::uniform_int_distribution<int> y(-50, height);
+  std::uniform_int_distribution<int> w(1, 120);
+  std::uniform_int_distribution<int> h(1, 30);
+
+  LabelCanvas           canvas;
+  std::vector<uint64_t> flat((size_t)(rowSize*height));
+  Mask                  mask(rowSize);
+
+  for (int round=0; round<3; round++) {
+    canvas.Reset(rowSize, height);
+    std::fill(flat.begin(), flat.end(), 0);
+
+    for (size_t i=0; i<2000; i++) {
+      mask.prepare(IntRectangle(x(gen), y(gen), w(gen), h(gen)));
+
+      bool collision=CheckFlatCollision(flat, mask, height);
+
+      REQUIRE(canvas.CheckCollision(mask)==collision);
+
+      if (!collision) {
+        MarkFlat(flat, mask, height);
+        canvas.Mark(mask);
+      }
+    }
+  }
+}
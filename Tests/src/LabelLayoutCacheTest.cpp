@@ -0,0 +1,188 @@
+/*
+  LabelLayoutCacheTest - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <osmscout/LabelLayouter.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+class CountingTextLayouter;
+
+using TestLabel = Label<int, std::string>;
+using TestLabelLayouter = LabelLayouter<int, std::string, CountingTextLayouter>;
+
+class CountingTextLayouter
+{
+public:
+  size_t layoutCount=0;
+
+  DoubleRectangle GlyphBoundingBox(const int&) const
+  {
+    return DoubleRectangle(0, 0, 1, 1);
+  }
+
+  std::shared_ptr<TestLabel> Layout(const Projection& /*projection*/,
+                                    const MapParameter& /*parameter*/,
+                                    const std::string& text,
+                                    double fontSize,
+                                    double /*objectWidth*/,
+                                    bool /*enableWrapping*/,
+                                    bool /*contourLabel*/)
+  {
+    layoutCount++;
+
+    auto label=std::make_shared<TestLabel>(text);
+
+    label->text=text;
+    label->fontSize=fontSize;
+    label->width=10.0*text.length();
+    label->height=12.0;
+
+    return label;
+  }
+};
+
+static void RegisterLabel(TestLabelLayouter& layouter,
+                          const Projection& projection,
+                          const MapParameter& parameter,
+                          const std::string& text,
+                          double fontSize,
+                          double objectWidth)
+{
+  LabelData data;
+
+  data.type=LabelData::Type::Text;
+  data.text=text;
+  data.fontSize=fontSize;
+
+  layouter.RegisterLabel(projection,
+                         parameter,
+                         Vertex2D(100, 100),
+                         {data},
+                         objectWidth);
+}
+
+static MercatorProjection GetProjection()
+{
+  MercatorProjection projection;
+
+  projection.Set(GeoCoord(50.0, 14.0),
+                 Magnification(MagnificationLevel(15)),
+                 96.0,
+                 800, 600);
+
+  return projection;
+}
+
+TEST_CASE("Labels are layouted every time without cache")
+{
+  CountingTextLayouter textLayouter;
+  TestLabelLayouter    layouter(&textLayouter);
+  MercatorProjection   projection=GetProjection();
+  MapParameter         parameter;
+
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 10.0);
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 10.0);
+
+  REQUIRE(textLayouter.layoutCount==2);
+  REQUIRE(layouter.GetLayoutCache()->GetHits()==0);
+}
+
+TEST_CASE("Same label is layouted only once")
+{
+  CountingTextLayouter textLayouter;
+  TestLabelLayouter    layouter(&textLayouter);
+  MercatorProjection   projection=GetProjection();
+  MapParameter         parameter;
+
+  parameter.SetLabelLayoutCacheSize(100);
+
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 10.0);
+  layouter.Reset();
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 10.0);
+
+  REQUIRE(textLayouter.layoutCount==1);
+  REQUIRE(layouter.Labels().size()==1);
+  REQUIRE(layouter.Labels().front().elements.front().label->text=="Main Street");
+  REQUIRE(layouter.GetLayoutCache()->GetHits()==1);
+  REQUIRE(layouter.GetLayoutCache()->GetMisses()==1);
+  REQUIRE(layouter.GetLayoutCache()->GetHitRate()==Approx(0.5));
+}
+
+TEST_CASE("Font size and object width are part of the key")
+{
+  CountingTextLayouter textLayouter;
+  TestLabelLayouter    layouter(&textLayouter);
+  MercatorProjection   projection=GetProjection();
+  MapParameter         parameter;
+
+  parameter.SetLabelLayoutCacheSize(100);
+
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 10.0);
+  RegisterLabel(layouter, projection, parameter, "Main Street", 2.0, 10.0);
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 50.0);
+  // rounded to the same pixel width as the first label
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 9.5);
+
+  parameter.SetFontName("serif");
+  RegisterLabel(layouter, projection, parameter, "Main Street", 1.0, 10.0);
+
+  REQUIRE(textLayouter.layoutCount==4);
+  REQUIRE(layouter.GetLayoutCache()->GetHits()==1);
+}
+
+TEST_CASE("Cache is bounded")
+{
+  CountingTextLayouter textLayouter;
+  TestLabelLayouter    layouter(&textLayouter);
+  MercatorProjection   projection=GetProjection();
+  MapParameter         parameter;
+
+  parameter.SetLabelLayoutCacheSize(2);
+
+  RegisterLabel(layouter, projection, parameter, "A", 1.0, 10.0);
+  RegisterLabel(layouter, projection, parameter, "B", 1.0, 10.0);
+  RegisterLabel(layouter, projection, parameter, "C", 1.0, 10.0);
+
+  REQUIRE(layouter.GetLayoutCache()->GetSize()==2);
+
+  // "A" was evicted
+  RegisterLabel(layouter, projection, parameter, "A", 1.0, 10.0);
+
+  REQUIRE(textLayouter.layoutCount==4);
+}
+
+TEST_CASE("Cache is shared between layouters")
+{
+  CountingTextLayouter textLayouter;
+  TestLabelLayouter    layouter1(&textLayouter);
+  TestLabelLayouter    layouter2(&textLayouter);
+  MercatorProjection   projection=GetProjection();
+  MapParameter         parameter;
+
+  parameter.SetLabelLayoutCacheSize(100);
+  layouter2.SetLayoutCache(layouter1.GetLayoutCache());
+
+  RegisterLabel(layouter1, projection, parameter, "Main Street", 1.0, 10.0);
+  RegisterLabel(layouter2, projection, parameter, "Main Street", 1.0, 10.0);
+
+  REQUIRE(textLayouter.layoutCount==1);
+}
@@ -0,0 +1,247 @@
+/*
+  LabelLayouterPerformance - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <osmscout/LabelLayouter.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Measure the number of labels placed per second by LabelLayouter for big
+  render targets (full HD up to 8K) and compare the collision detection of
+  LabelCanvas against a flat bitmap that is allocated for each layout.
+*/
+
+size_t LABEL_COUNT=2000; // Number of candidate labels per layout, may be overwritten by the first argument
+size_t ITERATIONS=50;    // Number of layouts per canvas size
+
+struct Size
+{
+  int width;
+  int height;
+};
+
+class BenchmarkTextLayouter;
+
+using BenchmarkLabel = osmscout::Label<int, std::string>;
+using BenchmarkLabelLayouter = osmscout::LabelLayouter<int, std::string, BenchmarkTextLayouter>;
+
+class BenchmarkTextLayouter
+{
+public:
+  osmscout::DoubleRectangle GlyphBoundingBox(const int&) const
+  {
+    return osmscout::DoubleRectangle(0, 0, 1, 1);
+  }
+
+  std::shared_ptr<BenchmarkLabel> Layout(const osmscout::Projection& /*projection*/,
+                                         const osmscout::MapParameter& /*parameter*/,
+                                         const std::string& text,
+                                         double fontSize,
+                                         double /*objectWidth*/,
+                                         bool /*enableWrapping*/,
+                                         bool /*contourLabel*/)
+  {
+    auto label=std::make_shared<BenchmarkLabel>(text);
+
+    label->text=text;
+    label->fontSize=fontSize;
+    label->width=7.0*text.length();
+    label->height=14.0;
+
+    return label;
+  }
+};
+
+static std::vector<osmscout::IntRectangle> GenerateRectangles(const Size& size)
+{
+  std::mt19937                       gen(4711);
+  std::uniform_int_distribution<int> x(0, size.width);
+  std::uniform_int_distribution<int> y(0, size.height);
+  std::uniform_int_distribution<int> w(20, 160);
+  std::uniform_int_distribution<int> h(10, 24);
+
+  std::vector<osmscout::IntRectangle> rectangles;
+
+  rectangles.reserve(LABEL_COUNT);
+
+  for (size_t i=0; i<LABEL_COUNT; i++) {
+    rectangles.emplace_back(x(gen), y(gen), w(gen), h(gen));
+  }
+
+  return rectangles;
+}
+
+static size_t PlaceFlat(const Size& size,
+                        const std::vector<osmscout::IntRectangle>& rectangles)
+{
+  int64_t               rowSize=size.width/64+1;
+  std::vector<uint64_t> canvas((size_t)(rowSize*size.height));
+  osmscout::Mask        mask(rowSize);
+  size_t                placed=0;
+
+  for (const auto& rectangle : rectangles) {
+    mask.prepare(rectangle);
+
+    bool collision=false;
+
+    for (int r=std::max(0,mask.rowFrom); !collision && r<=std::min(size.height-1, mask.rowTo); r++) {
+      for (int c=std::max(0,mask.cellFrom); !collision && c<=std::min((int)mask.size()-1,mask.cellTo); c++) {
+        collision|=(mask.d[c] & canvas[r*mask.size() + c])!=0;
+      }
+    }
+
+    if (!collision) {
+      for (int r=std::max(0,mask.rowFrom); r<=std::min(size.height-1, mask.rowTo); r++) {
+        for (int c=std::max(0,mask.cellFrom); c<=std::min((int)mask.size()-1, mask.cellTo); c++) {
+          canvas[r*mask.size() + c]|=mask.d[c];
+        }
+      }
+
+      placed++;
+    }
+  }
+
+  return placed;
+}
+
+static size_t PlaceHierarchical(osmscout::LabelCanvas& canvas,
+                                const Size& size,
+                                const std::vector<osmscout::IntRectangle>& rectangles)
+{
+  int64_t        rowSize=size.width/64+1;
+  osmscout::Mask mask(rowSize);
+  size_t         placed=0;
+
+  canvas.Reset(rowSize, size.height);
+
+  for (const auto& rectangle : rectangles) {
+    mask.prepare(rectangle);
+
+    if (!canvas.CheckCollision(mask)) {
+      canvas.Mark(mask);
+      placed++;
+    }
+  }
+
+  return placed;
+}
+
+static size_t LayoutLabels(BenchmarkLabelLayouter& layouter,
+                           const osmscout::Projection& projection,
+                           const osmscout::MapParameter& parameter,
+                           const std::vector<osmscout::IntRectangle>& rectangles)
+{
+  for (const auto& rectangle : rectangles) {
+    osmscout::LabelData data;
+
+    data.type=osmscout::LabelData::Type::Text;
+    data.text=std::string((size_t)rectangle.width/7,'x');
+    data.fontSize=1.0;
+
+    layouter.RegisterLabel(projection,
+                           parameter,
+                           osmscout::Vertex2D(rectangle.x, rectangle.y),
+                           {data});
+  }
+
+  layouter.Layout(projection, parameter);
+
+  size_t placed=layouter.Labels().size();
+
+  layouter.Reset();
+
+  return placed;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc>1) {
+    LABEL_COUNT=std::stoul(argv[1]);
+  }
+
+  std::vector<Size> sizes={{1920, 1080},
+                           {3840, 2160},
+                           {7680, 4320}};
+
+  for (const auto& size : sizes) {
+    std::vector<osmscout::IntRectangle> rectangles=GenerateRectangles(size);
+    osmscout::LabelCanvas               canvas;
+    BenchmarkTextLayouter               textLayouter;
+    BenchmarkLabelLayouter              layouter(&textLayouter);
+    osmscout::MercatorProjection        projection;
+    osmscout::MapParameter              parameter;
+    size_t                              flatPlaced=0;
+    size_t                              hierarchicalPlaced=0;
+    size_t                              layoutPlaced=0;
+
+    projection.Set(osmscout::GeoCoord(50.0, 14.0),
+                   osmscout::Magnification(osmscout::MagnificationLevel(15)),
+                   96.0,
+                   size.width,
+                   size.height);
+
+    layouter.SetViewport(osmscout::DoubleRectangle(0, 0, size.width, size.height));
+    layouter.SetLayoutOverlap(0);
+
+    osmscout::StopClock flatTimer;
+
+    for (size_t i=0; i<ITERATIONS; i++) {
+      flatPlaced+=PlaceFlat(size, rectangles);
+    }
+
+    flatTimer.Stop();
+
+    osmscout::StopClock hierarchicalTimer;
+
+    for (size_t i=0; i<ITERATIONS; i++) {
+      hierarchicalPlaced+=PlaceHierarchical(canvas, size, rectangles);
+    }
+
+    hierarchicalTimer.Stop();
+
+    osmscout::StopClock layoutTimer;
+
+    for (size_t i=0; i<ITERATIONS; i++) {
+      layoutPlaced+=LayoutLabels(layouter, projection, parameter, rectangles);
+    }
+
+    layoutTimer.Stop();
+
+    if (flatPlaced!=hierarchicalPlaced) {
+      std::cerr << "Flat and hierarchical canvas placed a different number of labels!" << std::endl;
+      return 1;
+    }
+
+    std::cout << size.width << "x" << size.height << ", " << LABEL_COUNT << " candidates, "
+              << flatPlaced/ITERATIONS << " placed" << std::endl;
+    std::cout << "  Flat bitmap:     " << flatTimer << " "
+              << (size_t)(flatPlaced*1000.0/flatTimer.GetMilliseconds()) << " labels/s" << std::endl;
+    std::cout << "  LabelCanvas:     " << hierarchicalTimer << " "
+              << (size_t)(hierarchicalPlaced*1000.0/hierarchicalTimer.GetMilliseconds()) << " labels/s" << std::endl;
+    std::cout << "  LabelLayouter:   " << layoutTimer << " "
+              << (size_t)(layoutPlaced*1000.0/layoutTimer.GetMilliseconds()) << " labels/s" << std::endl;
+  }
+
+  return 0;
+}
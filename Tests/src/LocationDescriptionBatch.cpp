@@ -0,0 +1,248 @@
+/*
+  LocationDescriptionBatch - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/LocationDescriptionService.h>
+
+#include <osmscout/util/CmdLineParsing.h>
+#include <osmscout/util/StopClock.h>
+
+/**
+ * Describes a grid of locations in the given database one by one and as a
+ * batch and checks that both return the same descriptions.
+ */
+
+struct Arguments
+{
+  bool               help=false;
+  std::string        databaseDirectory;
+  osmscout::GeoCoord min;
+  osmscout::GeoCoord max;
+  size_t             gridSize=10;
+};
+
+static void DumpPlace(std::ostream& stream,
+                      const osmscout::Place& place)
+{
+  stream << place.GetObject().GetName();
+
+  if (place.GetAdminRegion()) {
+    stream << " region: " << place.GetAdminRegion()->name;
+  }
+
+  if (place.GetPOI()) {
+    stream << " poi: " << place.GetPOI()->name;
+  }
+
+  if (place.GetLocation()) {
+    stream << " location: " << place.GetLocation()->name;
+  }
+
+  if (place.GetAddress()) {
+    stream << " address: " << place.GetAddress()->name;
+  }
+}
+
+static void DumpAtPlace(std::ostream& stream,
+                        const std::string& label,
+                        const osmscout::LocationAtPlaceDescriptionRef& description)
+{
+  if (!description) {
+    return;
+  }
+
+  stream << label << ": ";
+  DumpPlace(stream,description->GetPlace());
+  stream << " " << description->IsAtPlace() << " " << description->GetDistance().AsMeter() << std::endl;
+}
+
+static std::string DescriptionToString(const osmscout::LocationDescription& description)
+{
+  std::ostringstream stream;
+
+  if (description.GetCoordDescription()) {
+    stream << "Coord: " << description.GetCoordDescription()->GetLocation().GetDisplayText() << std::endl;
+  }
+
+  DumpAtPlace(stream,"Name",description.GetAtNameDescription());
+  DumpAtPlace(stream,"Address",description.GetAtAddressDescription());
+  DumpAtPlace(stream,"POI",description.GetAtPOIDescription());
+
+  if (description.GetWayDescription()) {
+    stream << "Way: ";
+    DumpPlace(stream,description.GetWayDescription()->GetWay());
+    stream << " " << description.GetWayDescription()->GetDistance().AsMeter() << std::endl;
+  }
+
+  if (description.GetCrossingDescription()) {
+    stream << "Crossing: " << description.GetCrossingDescription()->GetCrossing().GetDisplayText();
+
+    for (const auto& way : description.GetCrossingDescription()->GetWays()) {
+      stream << " ";
+      DumpPlace(stream,way);
+    }
+
+    stream << std::endl;
+  }
+
+  return stream.str();
+}
+
+int main(int argc, char* argv[])
+{
+  osmscout::CmdLineParser argParser("LocationDescriptionBatch",
+                                    argc,argv);
+  std::vector<std::string> helpArgs{"h","help"};
+  Arguments                args;
+
+  argParser.AddOption(osmscout::CmdLineFlag([&args](const bool& value) {
+                        args.help=value;
+                      }),
+                      helpArgs,
+                      "Return argument help",
+                      true);
+
+  argParser.AddOption(osmscout::CmdLineSizeTOption([&args](const size_t& value) {
+                        args.gridSize=value;
+                      }),
+                      "grid",
+                      "Number of locations in each direction");
+
+  argParser.AddPositional(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
+                            args.min=value;
+                          }),
+                          "MIN",
+                          "minimum coordinate of the grid");
+
+  argParser.AddPositional(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
+                            args.max=value;
+                          }),
+                          "MAX",
+                          "maximum coordinate of the grid");
+
+  argParser.AddPositional(osmscout::CmdLineStringOption([&args](const std::string& value) {
+                            args.databaseDirectory=value;
+                          }),
+                          "DATABASE",
+                          "Directory of the database to use");
+
+  osmscout::CmdLineParseResult result=argParser.Parse();
+
+  if (result.HasError()) {
+    std::cerr << "ERROR: " << result.GetErrorDescription() << std::endl;
+    std::cout << argParser.GetHelp() << std::endl;
+    return 1;
+  }
+
+  if (args.help) {
+    std::cout << argParser.GetHelp() << std::endl;
+    return 0;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(databaseParameter);
+
+  if (!database->Open(args.databaseDirectory)) {
+    std::cerr << "Cannot open database " << args.databaseDirectory << std::endl;
+    return 1;
+  }
+
+  osmscout::LocationDescriptionService service(database);
+  std::vector<osmscout::GeoCoord>      locations;
+
+  for (size_t y=0; y<args.gridSize; y++) {
+    for (size_t x=0; x<args.gridSize; x++) {
+      double latRatio=args.gridSize>1 ? (double)y/(args.gridSize-1) : 0.0;
+      double lonRatio=args.gridSize>1 ? (double)x/(args.gridSize-1) : 0.0;
+
+      locations.emplace_back(args.min.GetLat()+latRatio*(args.max.GetLat()-args.min.GetLat()),
+                             args.min.GetLon()+lonRatio*(args.max.GetLon()-args.min.GetLon()));
+    }
+  }
+
+  // Reverse order, so that the batch has to restore the order of the input
+  std::reverse(locations.begin(),locations.end());
+
+  std::vector<std::string> expected;
+  std::vector<bool>        expectedSuccess;
+  osmscout::StopClock      singleTime;
+
+  for (const auto& location : locations) {
+    osmscout::LocationDescription description;
+
+    expectedSuccess.push_back(service.DescribeLocation(location,description));
+    expected.push_back(DescriptionToString(description));
+  }
+
+  singleTime.Stop();
+
+  std::vector<osmscout::LocationDescription> descriptions;
+  osmscout::StopClock                        batchTime;
+  bool                                       batchSuccess=service.DescribeLocations(locations,descriptions);
+
+  batchTime.Stop();
+
+  std::cout << "Described " << locations.size() << " locations one by one in " << singleTime.ResultString() << " s, as batch in " << batchTime.ResultString() << " s" << std::endl;
+
+  int    errors=0;
+  size_t describedCount=0;
+
+  if (descriptions.size()!=locations.size()) {
+    std::cerr << "Expected " << locations.size() << " descriptions, got " << descriptions.size() << std::endl;
+    return 1;
+  }
+
+  for (size_t i=0; i<locations.size(); i++) {
+    std::string description=DescriptionToString(descriptions[i]);
+
+    if (descriptions[i].GetWayDescription() ||
+        descriptions[i].GetAtAddressDescription()) {
+      describedCount++;
+    }
+
+    if (expectedSuccess[i] && description!=expected[i]) {
+      std::cerr << "Batch description differs from single description:" << std::endl;
+      std::cerr << expected[i] << "---" << std::endl << description << std::endl;
+      errors++;
+    }
+  }
+
+  bool allSucceeded=std::find(expectedSuccess.begin(),expectedSuccess.end(),false)==expectedSuccess.end();
+
+  if (batchSuccess!=allSucceeded) {
+    std::cerr << "Batch result " << batchSuccess << " differs from single results " << allSucceeded << std::endl;
+    errors++;
+  }
+
+  if (describedCount==0) {
+    std::cerr << "No location got a description" << std::endl;
+    errors++;
+  }
+
+  std::cout << describedCount << " locations described by way or address, " << errors << " error(s)" << std::endl;
+
+  database->Close();
+
+  return errors==0 ? 0 : 1;
+}
@@ -0,0 +1,322 @@
+/*
+  MapMatching - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/routing/MapMatchingService.h>
+#include <osmscout/routing/SimpleRoutingService.h>
+
+#include <osmscout/util/CmdLineParsing.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/StopClock.h>
+
+/**
+ * Calculates a route in the given database, derives a noisy trace from it
+ * and checks that the trace is matched back to the ways of the route.
+ */
+
+struct Arguments
+{
+  bool               help=false;
+  std::string        databaseDirectory;
+  osmscout::GeoCoord start;
+  osmscout::GeoCoord target;
+};
+
+void GetCarSpeedTable(std::map<std::string,double>& map)
+{
+  map["highway_motorway"]=110.0;
+  map["highway_motorway_trunk"]=100.0;
+  map["highway_motorway_primary"]=70.0;
+  map["highway_motorway_link"]=60.0;
+  map["highway_motorway_junction"]=60.0;
+  map["highway_trunk"]=100.0;
+  map["highway_trunk_link"]=60.0;
+  map["highway_primary"]=70.0;
+  map["highway_primary_link"]=60.0;
+  map["highway_secondary"]=60.0;
+  map["highway_secondary_link"]=50.0;
+  map["highway_tertiary"]=55.0;
+  map["highway_tertiary_link"]=55.0;
+  map["highway_unclassified"]=50.0;
+  map["highway_road"]=50.0;
+  map["highway_residential"]=40.0;
+  map["highway_roundabout"]=40.0;
+  map["highway_living_street"]=10.0;
+  map["highway_service"]=30.0;
+}
+
+static osmscout::Distance GetLength(const std::vector<osmscout::Point>& points)
+{
+  osmscout::Distance length;
+
+  for (size_t i=1; i<points.size(); i++) {
+    length+=osmscout::GetSphericalDistance(points[i-1].GetCoord(),
+                                           points[i].GetCoord());
+  }
+
+  return length;
+}
+
+/**
+ * One observation every 20 meters along the route, displaced by up to 8 meters
+ */
+static std::vector<osmscout::GeoCoord> CreateTrace(const std::vector<osmscout::Point>& points)
+{
+  const double                    metersPerDegree=111195.0;
+  const double                    step=20.0;
+  std::vector<osmscout::GeoCoord> trace;
+  double                          position=0.0;
+
+  for (size_t i=1; i<points.size(); i++) {
+    osmscout::GeoCoord a=points[i-1].GetCoord();
+    osmscout::GeoCoord b=points[i].GetCoord();
+    double             length=osmscout::GetSphericalDistance(a,b).AsMeter();
+
+    while (position<=length) {
+      double   r=length>0.0 ? position/length : 0.0;
+      size_t   index=trace.size();
+      double   latNoise=(double)((int)(index%5)-2)*4.0/metersPerDegree;
+      double   lonNoise=(double)((int)((index*3)%5)-2)*4.0/metersPerDegree/std::cos(osmscout::DegToRad(a.GetLat()));
+
+      trace.emplace_back(a.GetLat()+r*(b.GetLat()-a.GetLat())+latNoise,
+                         a.GetLon()+r*(b.GetLon()-a.GetLon())+lonNoise);
+
+      position+=step;
+    }
+
+    position-=length;
+  }
+
+  return trace;
+}
+
+int main(int argc, char* argv[])
+{
+  osmscout::CmdLineParser argParser("MapMatching",
+                                    argc,argv);
+  std::vector<std::string> helpArgs{"h","help"};
+  Arguments                args;
+
+  argParser.AddOption(osmscout::CmdLineFlag([&args](const bool& value) {
+                        args.help=value;
+                      }),
+                      helpArgs,
+                      "Return argument help",
+                      true);
+
+  argParser.AddPositional(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
+                            args.start=value;
+                          }),
+                          "START",
+                          "start coordinate");
+
+  argParser.AddPositional(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
+                            args.target=value;
+                          }),
+                          "TARGET",
+                          "target coordinate");
+
+  argParser.AddPositional(osmscout::CmdLineStringOption([&args](const std::string& value) {
+                            args.databaseDirectory=value;
+                          }),
+                          "DATABASE",
+                          "Directory of the database to use");
+
+  osmscout::CmdLineParseResult result=argParser.Parse();
+
+  if (result.HasError()) {
+    std::cerr << "ERROR: " << result.GetErrorDescription() << std::endl;
+    std::cout << argParser.GetHelp() << std::endl;
+    return 1;
+  }
+
+  if (args.help) {
+    std::cout << argParser.GetHelp() << std::endl;
+    return 0;
+  }
+
+  osmscout::DatabaseParameter dbParameter;
+  osmscout::DatabaseRef       database=std::make_shared<osmscout::Database>(dbParameter);
+
+  if (!database->Open(args.databaseDirectory)) {
+    std::cerr << "Cannot open database " << args.databaseDirectory << std::endl;
+    return 1;
+  }
+
+  osmscout::RouterParameter         routerParameter;
+  osmscout::SimpleRoutingServiceRef router=std::make_shared<osmscout::SimpleRoutingService>(database,
+                                                                                            routerParameter,
+                                                                                            osmscout::RoutingService::DEFAULT_FILENAME_BASE);
+
+  if (!router->Open()) {
+    std::cerr << "Cannot open router" << std::endl;
+    return 1;
+  }
+
+  osmscout::FastestPathRoutingProfile profile(database->GetTypeConfig());
+  std::map<std::string,double>        speedMap;
+
+  GetCarSpeedTable(speedMap);
+  profile.ParametrizeForCar(*database->GetTypeConfig(),speedMap,160.0);
+
+  // Route to derive the trace from
+
+  auto startResult=router->GetClosestRoutableNode(args.start,profile,osmscout::Kilometers(1));
+  auto targetResult=router->GetClosestRoutableNode(args.target,profile,osmscout::Kilometers(1));
+
+  if (!startResult.IsValid() || !targetResult.IsValid()) {
+    std::cerr << "Cannot find route nodes near start or target" << std::endl;
+    return 1;
+  }
+
+  osmscout::RoutingParameter routingParameter;
+  osmscout::RoutingResult    routingResult=router->CalculateRoute(profile,
+                                                                  startResult.GetRoutePosition(),
+                                                                  targetResult.GetRoutePosition(),
+                                                                  routingParameter);
+
+  if (!routingResult.Success()) {
+    std::cerr << "Route failed" << std::endl;
+    return 1;
+  }
+
+  auto routePoints=router->TransformRouteDataToPoints(routingResult.GetRoute());
+
+  if (!routePoints.Success()) {
+    std::cerr << "Cannot transform route to points" << std::endl;
+    return 1;
+  }
+
+  std::set<osmscout::ObjectFileRef> routeObjects;
+
+  for (const auto& entry : routingResult.GetRoute().Entries()) {
+    if (entry.GetPathObject().Valid()) {
+      routeObjects.insert(entry.GetPathObject());
+    }
+  }
+
+  std::vector<osmscout::GeoCoord> trace=CreateTrace(routePoints.GetPoints()->points);
+  osmscout::Distance              routeLength=GetLength(routePoints.GetPoints()->points);
+
+  std::cout << "Route: " << routeLength.AsMeter() << " m, " << routeObjects.size() << " objects, trace: " << trace.size() << " points" << std::endl;
+
+  // Matching
+
+  osmscout::MapMatchingParameter matchingParameter;
+
+  matchingParameter.SetThreadCount(4);
+
+  osmscout::MapMatchingService matcher(database,matchingParameter);
+
+  if (!matcher.Open()) {
+    std::cerr << "Cannot open map matching service" << std::endl;
+    return 1;
+  }
+
+  osmscout::StopClock         matchTime;
+  osmscout::MapMatchingResult matchResult=matcher.Match(profile,trace);
+
+  matchTime.Stop();
+
+  size_t matchedCount=matchResult.GetMatchedPointCount();
+  size_t onRouteCount=0;
+
+  for (const auto& point : matchResult.points) {
+    if (point.matched &&
+        routeObjects.find(point.position.GetObjectFileRef())!=routeObjects.end()) {
+      onRouteCount++;
+    }
+  }
+
+  std::cout << "Matched " << matchedCount << " points, " << onRouteCount << " on the route, " << matchResult.routes.size() << " route(s) in " << matchTime.ResultString() << " s" << std::endl;
+
+  int errors=0;
+
+  if (matchResult.points.size()!=trace.size() ||
+      matchedCount!=trace.size()) {
+    std::cerr << "Not all points were matched" << std::endl;
+    errors++;
+  }
+
+  if (onRouteCount<trace.size()*95/100) {
+    std::cerr << "Too many points matched to ways not on the route" << std::endl;
+    errors++;
+  }
+
+  if (matchResult.routes.size()!=1 ||
+      matchResult.routes.front().IsEmpty()) {
+    std::cerr << "Expected one continuous matched route" << std::endl;
+    errors++;
+  }
+  else {
+    auto matchedPoints=router->TransformRouteDataToPoints(matchResult.routes.front());
+
+    if (!matchedPoints.Success()) {
+      std::cerr << "Cannot transform matched route to points" << std::endl;
+      errors++;
+    }
+    else {
+      osmscout::Distance matchedLength=GetLength(matchedPoints.GetPoints()->points);
+
+      std::cout << "Matched route: " << matchedLength.AsMeter() << " m" << std::endl;
+
+      if (std::fabs(matchedLength.AsMeter()-routeLength.AsMeter())>routeLength.AsMeter()*0.05) {
+        std::cerr << "Length of matched route differs from the original route" << std::endl;
+        errors++;
+      }
+    }
+  }
+
+  // Batch matching must return the same result for each trace
+
+  std::vector<std::vector<osmscout::GeoCoord>> traces(8,trace);
+  osmscout::StopClock                          batchTime;
+  std::vector<osmscout::MapMatchingResult>     batchResults=matcher.Match(profile,traces);
+
+  batchTime.Stop();
+
+  std::cout << "Matched batch of " << traces.size() << " traces in " << batchTime.ResultString() << " s" << std::endl;
+
+  for (const auto& batchResult : batchResults) {
+    bool equal=batchResult.points.size()==matchResult.points.size();
+
+    for (size_t i=0; equal && i<batchResult.points.size(); i++) {
+      equal=batchResult.points[i].matched==matchResult.points[i].matched &&
+            batchResult.points[i].position.GetObjectFileRef()==matchResult.points[i].position.GetObjectFileRef() &&
+            batchResult.points[i].position.GetNodeIndex()==matchResult.points[i].position.GetNodeIndex();
+    }
+
+    if (!equal) {
+      std::cerr << "Batch result differs from single result" << std::endl;
+      errors++;
+      break;
+    }
+  }
+
+  matcher.Close();
+  router->Close();
+  database->Close();
+
+  return errors==0 ? 0 : 1;
+}
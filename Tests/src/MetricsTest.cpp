@@ -0,0 +1,123 @@
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <osmscout/util/Cache.h>
+#include <osmscout/util/Metrics.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+TEST_CASE("Counters are registered once and count concurrently")
+{
+  osmscout::MetricsRegistry registry;
+  osmscout::MetricCounter&  counter=registry.GetCounter("test_total","Test counter",{{"name","a"}});
+
+  REQUIRE(&counter==&registry.GetCounter("test_total","Test counter",{{"name","a"}}));
+  REQUIRE(&counter!=&registry.GetCounter("test_total","Test counter",{{"name","b"}}));
+
+  std::vector<std::thread> threads;
+
+  for (size_t t=0; t<4; t++) {
+    threads.emplace_back([&counter]() {
+      for (size_t i=0; i<10000; i++) {
+        counter.Increment();
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  osmscout::MetricsSnapshot snapshot=registry.GetSnapshot();
+
+  REQUIRE(snapshot.counters.size()==2);
+  REQUIRE(snapshot.GetCounter("test_total",{{"name","a"}})!=nullptr);
+  REQUIRE(snapshot.GetCounter("test_total",{{"name","a"}})->value==40000);
+  REQUIRE(snapshot.GetCounter("test_total",{{"name","b"}})->value==0);
+  REQUIRE(snapshot.GetCounter("unknown_total")==nullptr);
+
+  registry.Reset();
+
+  REQUIRE(counter.GetValue()==0);
+}
+
+TEST_CASE("Histogram buckets are cumulative in the snapshot")
+{
+  osmscout::MetricsRegistry registry;
+  osmscout::MetricHistogram& histogram=registry.GetHistogram("test_seconds","Test histogram",{1.0,2.0,5.0});
+
+  histogram.Observe(0.5);
+  histogram.Observe(1.0);
+  histogram.Observe(1.5);
+  histogram.Observe(10.0);
+
+  REQUIRE(histogram.GetBucketCounts()==std::vector<uint64_t>{2,1,0,1});
+
+  osmscout::MetricsSnapshot                  snapshot=registry.GetSnapshot();
+  const osmscout::MetricsSnapshot::Histogram* entry=snapshot.GetHistogram("test_seconds");
+
+  REQUIRE(entry!=nullptr);
+  REQUIRE(entry->bucketCounts==std::vector<uint64_t>{2,3,3,4});
+  REQUIRE(entry->count==4);
+  REQUIRE(entry->sum==Approx(13.0));
+}
+
+TEST_CASE("Snapshot is formatted as Prometheus text")
+{
+  osmscout::MetricsRegistry registry;
+
+  registry.GetCounter("test_total","Test counter",{{"file","b.dat"}}).Increment(2);
+  registry.GetCounter("test_total","Test counter",{{"file","a \"quoted\".dat"}}).Increment(1);
+  registry.GetHistogram("test_seconds","Test histogram",{0.5,1.0}).Observe(0.75);
+
+  std::ostringstream stream;
+
+  osmscout::WritePrometheusText(stream,registry.GetSnapshot());
+
+  REQUIRE(stream.str()==
+          "# HELP test_total Test counter\n"
+          "# TYPE test_total counter\n"
+          "test_total{file=\"a \\\"quoted\\\".dat\"} 1\n"
+          "test_total{file=\"b.dat\"} 2\n"
+          "# HELP test_seconds Test histogram\n"
+          "# TYPE test_seconds histogram\n"
+          "test_seconds_bucket{le=\"0.5\"} 0\n"
+          "test_seconds_bucket{le=\"1\"} 1\n"
+          "test_seconds_bucket{le=\"+Inf\"} 1\n"
+          "test_seconds_sum 0.75\n"
+          "test_seconds_count 1\n");
+}
+
+TEST_CASE("Cache counts hits, misses and evictions")
+{
+  typedef osmscout::Cache<size_t,size_t> TestCache;
+
+  TestCache cache(2);
+
+  cache.SetMetrics("MetricsTest");
+
+  osmscout::MetricCounter& hits=osmscout::metrics.GetCounter("osmscout_cache_hits_total","",{{"cache","MetricsTest"}});
+  osmscout::MetricCounter& misses=osmscout::metrics.GetCounter("osmscout_cache_misses_total","",{{"cache","MetricsTest"}});
+  osmscout::MetricCounter& evictions=osmscout::metrics.GetCounter("osmscout_cache_evictions_total","",{{"cache","MetricsTest"}});
+
+  TestCache::CacheRef ref;
+
+  REQUIRE(!cache.GetEntry(1,ref));
+
+  cache.SetEntry(TestCache::CacheEntry(1,10));
+  cache.SetEntry(TestCache::CacheEntry(2,20));
+
+  REQUIRE(cache.GetEntry(1,ref));
+  REQUIRE(ref->value==10);
+
+  cache.SetEntry(TestCache::CacheEntry(3,30));
+
+  REQUIRE(!cache.Contains(2));
+  REQUIRE(cache.Contains(3));
+
+  REQUIRE(hits.GetValue()==1);
+  REQUIRE(misses.GetValue()==1);
+  REQUIRE(evictions.GetValue()==1);
+}
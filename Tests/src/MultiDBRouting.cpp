@@ -17,6 +17,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <thread>
@@ -29,10 +30,12 @@
 
 #include <osmscout/util/CmdLineParsing.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/StopClock.h>
 
 struct Arguments
 {
   bool                     help=false;
+  size_t                   iterations=1;
   std::vector<std::string> databaseDirectories;
   osmscout::GeoCoord       start;
   osmscout::GeoCoord       target;
@@ -75,6 +78,13 @@ int main(int argc, char* argv[])
                       "Return argument help",
                       true);
 
+  argParser.AddOption(osmscout::CmdLineSizeTOption([&args](const size_t& value) {
+                        args.iterations=std::max(value,(size_t)1);
+                      }),
+                      "iterations",
+                      "Number of times, the route is calculated (for timing)",
+                      false);
+
   argParser.AddPositional(osmscout::CmdLineGeoCoordOption([&args](const osmscout::GeoCoord& value) {
                             args.start=value;
                           }),
@@ -154,35 +164,64 @@ int main(int argc, char* argv[])
   }
   std::cout << "Done." << std::endl;
 
-  std::cout << "Retrieve routing node next to start..." << std::endl;
-  auto startResult=router->GetClosestRoutableNode(args.start);
+  double closestNodeTime=0.0;
+  double routeTime=0.0;
+  double descriptionTime=0.0;
 
-  if (!startResult.IsValid()){
-    std::cerr << "Can't found route node near start coord " << args.start.GetDisplayText() << std::endl;
-    return 1;
-  }
-  osmscout::RoutePosition startNode=startResult.GetRoutePosition();
+  for (size_t iteration=1; iteration<=args.iterations; iteration++) {
+    if (args.iterations>1) {
+      std::cout << "Iteration " << iteration << "/" << args.iterations << "..." << std::endl;
+    }
 
-  std::cout << "Retrieve routing node next to target..." << std::endl;
-  auto targetResult=router->GetClosestRoutableNode(args.target);
+    osmscout::StopClock closestNodeTimer;
 
-  if (!targetResult.IsValid()){
-    std::cerr << "Can't found route node near target coord " << args.target.GetDisplayText() << std::endl;
-    return 1;
-  }
-  osmscout::RoutePosition targetNode=targetResult.GetRoutePosition();
+    std::cout << "Retrieve routing node next to start..." << std::endl;
+    auto startResult=router->GetClosestRoutableNode(args.start);
 
-  std::cout << "Calculate route..." << std::endl;
+    if (!startResult.IsValid()){
+      std::cerr << "Can't found route node near start coord " << args.start.GetDisplayText() << std::endl;
+      return 1;
+    }
+    osmscout::RoutePosition startNode=startResult.GetRoutePosition();
 
-  osmscout::RoutingParameter parameter;
-  auto                       routingResult=router->CalculateRoute(startNode,targetNode,parameter);
+    std::cout << "Retrieve routing node next to target..." << std::endl;
+    auto targetResult=router->GetClosestRoutableNode(args.target);
 
-  if (!routingResult.Success()){
-    std::cerr << "Route failed" << std::endl;
-    return 1;
+    if (!targetResult.IsValid()){
+      std::cerr << "Can't found route node near target coord " << args.target.GetDisplayText() << std::endl;
+      return 1;
+    }
+    osmscout::RoutePosition targetNode=targetResult.GetRoutePosition();
+
+    closestNodeTimer.Stop();
+    closestNodeTime+=closestNodeTimer.GetMilliseconds();
+
+    std::cout << "Calculate route..." << std::endl;
+
+    osmscout::StopClock        routeTimer;
+    osmscout::RoutingParameter parameter;
+    auto                       routingResult=router->CalculateRoute(startNode,targetNode,parameter);
+
+    routeTimer.Stop();
+    routeTime+=routeTimer.GetMilliseconds();
+
+    if (!routingResult.Success()){
+      std::cerr << "Route failed" << std::endl;
+      return 1;
+    }
+
+    osmscout::StopClock descriptionTimer;
+
+    auto routeDescriptionResult=router->TransformRouteDataToRouteDescription(routingResult.GetRoute());
+
+    descriptionTimer.Stop();
+    descriptionTime+=descriptionTimer.GetMilliseconds();
   }
 
-  auto routeDescriptionResult=router->TransformRouteDataToRouteDescription(routingResult.GetRoute());
+  std::cout << "Timing (average of " << args.iterations << " iteration(s), " << databases.size() << " database(s)):" << std::endl;
+  std::cout << "  Closest routable nodes: " << closestNodeTime/args.iterations << " ms" << std::endl;
+  std::cout << "  Route calculation:      " << routeTime/args.iterations << " ms" << std::endl;
+  std::cout << "  Route description:      " << descriptionTime/args.iterations << " ms" << std::endl;
 
   std::cout << "Closing RoutingServices and databases..." << std::endl;
 
@@ -0,0 +1,158 @@
+/*
+  ObjectArena - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdint>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+#include <osmscout/TypeFeatures.h>
+
+#include <osmscout/util/ObjectArena.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+struct TestObject
+{
+  uint64_t value=42;
+  double   other=0.5;
+};
+
+TEST_CASE("Allocations respect alignment")
+{
+  osmscout::ObjectArena arena(1024);
+
+  void* a=arena.Allocate(1,1);
+  void* b=arena.Allocate(sizeof(uint64_t),alignof(uint64_t));
+
+  REQUIRE(a!=nullptr);
+  REQUIRE(b!=nullptr);
+  REQUIRE(reinterpret_cast<uintptr_t>(b)%alignof(uint64_t)==0);
+  REQUIRE(arena.GetAllocationCount()==2);
+  REQUIRE(arena.GetBlockCount()==1);
+}
+
+TEST_CASE("Allocations larger than the block size get their own block")
+{
+  osmscout::ObjectArena arena(64);
+
+  arena.Allocate(16,8);
+  arena.Allocate(256,8);
+  arena.Allocate(16,8);
+
+  REQUIRE(arena.GetAllocationCount()==3);
+  REQUIRE(arena.GetAllocatedBytes()==288);
+  REQUIRE(arena.GetBlockCount()>=2);
+}
+
+TEST_CASE("Objects are created in the arena")
+{
+  osmscout::ObjectArenaRef arena=std::make_shared<osmscout::ObjectArena>();
+
+  std::shared_ptr<TestObject> object=osmscout::MakeShared<TestObject>(arena);
+
+  REQUIRE(object->value==42);
+  REQUIRE(arena->GetAllocationCount()==1);
+}
+
+TEST_CASE("Objects are created on the heap without arena")
+{
+  std::shared_ptr<TestObject> object=osmscout::MakeShared<TestObject>(nullptr);
+
+  REQUIRE(object);
+  REQUIRE(object->value==42);
+}
+
+TEST_CASE("Arena lives as long as its objects")
+{
+  std::vector<std::shared_ptr<TestObject>> objects;
+  std::weak_ptr<osmscout::ObjectArena>     weakArena;
+
+  {
+    osmscout::ObjectArenaRef arena=std::make_shared<osmscout::ObjectArena>();
+
+    weakArena=arena;
+
+    for (size_t i=0; i<1000; i++) {
+      objects.push_back(osmscout::MakeShared<TestObject>(arena));
+    }
+  }
+
+  REQUIRE(!weakArena.expired());
+
+  objects.resize(1);
+
+  REQUIRE(!weakArena.expired());
+  REQUIRE(objects.front()->value==42);
+
+  objects.clear();
+
+  REQUIRE(weakArena.expired());
+}
+
+TEST_CASE("Feature values are allocated from the current arena")
+{
+  osmscout::TypeConfig  typeConfig;
+  osmscout::TypeInfoRef testType=std::make_shared<osmscout::TypeInfo>("TestType");
+  size_t                featureIndex;
+
+  testType->AddFeature(typeConfig.GetFeature(osmscout::NameFeature::NAME));
+  typeConfig.RegisterType(testType);
+
+  REQUIRE(testType->GetFeature(osmscout::NameFeature::NAME,
+                               featureIndex));
+
+  osmscout::ObjectArenaRef     arena=std::make_shared<osmscout::ObjectArena>();
+  osmscout::FeatureValueBuffer heapBuffer;
+
+  {
+    osmscout::ObjectArenaScope   scope(arena.get());
+    osmscout::FeatureValueBuffer arenaBuffer;
+
+    REQUIRE(osmscout::ObjectArenaScope::GetCurrentArena()==arena.get());
+
+    arenaBuffer.SetType(testType);
+
+    REQUIRE(arena->GetAllocationCount()==1);
+
+    auto* value=dynamic_cast<osmscout::NameFeatureValue*>(arenaBuffer.AllocateValue(featureIndex));
+
+    REQUIRE(value!=nullptr);
+    REQUIRE(arena->GetAllocationCount()==2);
+
+    value->SetName("A rather long name, that does not fit into the small string buffer");
+
+    {
+      // Copies outside of an arena scope end up on the heap
+      osmscout::ObjectArenaScope noArenaScope(nullptr);
+
+      heapBuffer=arenaBuffer;
+    }
+
+    REQUIRE(arena->GetAllocationCount()==2);
+  }
+
+  REQUIRE(osmscout::ObjectArenaScope::GetCurrentArena()==nullptr);
+  REQUIRE(heapBuffer.HasFeature(featureIndex));
+
+  auto* copiedValue=dynamic_cast<osmscout::NameFeatureValue*>(heapBuffer.GetValue(featureIndex));
+
+  REQUIRE(copiedValue!=nullptr);
+  REQUIRE(copiedValue->GetName()=="A rather long name, that does not fit into the small string buffer");
+}
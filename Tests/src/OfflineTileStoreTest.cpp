@@ -0,0 +1,178 @@
+/*
+  OfflineTileStoreTest - a test program for libosmscout
+  Copyright (C) 2020  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+
+#include <osmscout/OfflineTileStore.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+using namespace osmscout;
+
+static QImage CreateTile(QColor color)
+{
+  QImage image(256, 256, QImage::Format_ARGB32);
+
+  image.fill(color);
+
+  return image;
+}
+
+TEST_CASE("Stored tile is returned")
+{
+  QTemporaryDir    dir;
+  OfflineTileStore store;
+
+  REQUIRE(dir.isValid());
+  REQUIRE(store.Open(dir.filePath("tiles.dat"), 0));
+
+  OfflineTileKey key={10, 554, 346, 1, 2};
+  QImage         image;
+
+  REQUIRE_FALSE(store.Get(key, image));
+  REQUIRE(store.Put(key, CreateTile(Qt::red)));
+  REQUIRE(store.Get(key, image));
+  REQUIRE(image.pixelColor(10, 10)==QColor(Qt::red));
+
+  // different style or database epoch is not returned
+  REQUIRE_FALSE(store.Contains({10, 554, 346, 3, 2}));
+  REQUIRE_FALSE(store.Contains({10, 554, 346, 1, 3}));
+}
+
+TEST_CASE("Tiles survive reopening")
+{
+  QTemporaryDir dir;
+  QString       fileName=dir.filePath("tiles.dat");
+
+  {
+    OfflineTileStore store;
+
+    REQUIRE(store.Open(fileName, 0));
+    REQUIRE(store.Put({10, 1, 1, 1, 1}, CreateTile(Qt::red)));
+    REQUIRE(store.Put({10, 1, 2, 1, 1}, CreateTile(Qt::green)));
+    REQUIRE(store.Put({10, 1, 1, 1, 1}, CreateTile(Qt::blue)));
+  }
+
+  OfflineTileStore store;
+  QImage           image;
+
+  REQUIRE(store.Open(fileName, 0));
+  REQUIRE(store.GetTileCount()==2);
+  REQUIRE(store.Get({10, 1, 1, 1, 1}, image));
+  REQUIRE(image.pixelColor(0, 0)==QColor(Qt::blue));
+  REQUIRE(store.Get({10, 1, 2, 1, 1}, image));
+  REQUIRE(image.pixelColor(0, 0)==QColor(Qt::green));
+}
+
+TEST_CASE("Incomplete record is dropped")
+{
+  QTemporaryDir dir;
+  QString       fileName=dir.filePath("tiles.dat");
+  qint64        completeSize;
+
+  {
+    OfflineTileStore store;
+
+    REQUIRE(store.Open(fileName, 0));
+    REQUIRE(store.Put({10, 1, 1, 1, 1}, CreateTile(Qt::red)));
+    completeSize=(qint64)store.GetFileSize();
+    REQUIRE(store.Put({10, 1, 2, 1, 1}, CreateTile(Qt::green)));
+  }
+
+  {
+    QFile file(fileName);
+
+    REQUIRE(file.resize(file.size()-10));
+  }
+
+  OfflineTileStore store;
+  QImage           image;
+
+  REQUIRE(store.Open(fileName, 0));
+  REQUIRE(store.GetTileCount()==1);
+  REQUIRE((qint64)store.GetFileSize()==completeSize);
+  REQUIRE(store.Get({10, 1, 1, 1, 1}, image));
+  REQUIRE_FALSE(store.Contains({10, 1, 2, 1, 1}));
+}
+
+TEST_CASE("Oldest tiles are evicted when the store reaches maximum size")
+{
+  QTemporaryDir    dir;
+  QString          fileName=dir.filePath("tiles.dat");
+  OfflineTileStore store;
+  bool             evicted=false;
+
+  REQUIRE(store.Open(fileName, 4096));
+
+  for (uint32_t i=0; i<100; i++) {
+    size_t countBefore=store.GetTileCount();
+
+    REQUIRE(store.Put({10, i, 1, 1, 1}, CreateTile(QColor(i, 0, 0))));
+    REQUIRE(store.GetFileSize()<=4096);
+
+    if (store.GetTileCount()<=countBefore) {
+      // the store is not cleared, the newest tiles are kept
+      evicted=true;
+      REQUIRE(store.GetTileCount()>1);
+      REQUIRE(store.Contains({10, i-1, 1, 1, 1}));
+    }
+  }
+
+  REQUIRE(evicted);
+  REQUIRE(store.GetTileCount()<100);
+  REQUIRE_FALSE(store.Contains({10, 0, 1, 1, 1}));
+
+  QImage image;
+
+  REQUIRE(store.Get({10, 99, 1, 1, 1}, image));
+  REQUIRE(image.pixelColor(0, 0)==QColor(99, 0, 0));
+  REQUIRE(store.Get({10, 98, 1, 1, 1}, image));
+  REQUIRE(image.pixelColor(0, 0)==QColor(98, 0, 0));
+
+  size_t count=store.GetTileCount();
+
+  store.Close();
+
+  REQUIRE(store.Open(fileName, 4096));
+  REQUIRE(store.GetTileCount()==count);
+}
+
+TEST_CASE("Invalid file is replaced")
+{
+  QTemporaryDir dir;
+  QString       fileName=dir.filePath("tiles.dat");
+
+  {
+    QFile file(fileName);
+
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write("this is not a tile store");
+  }
+
+  OfflineTileStore store;
+
+  REQUIRE(store.Open(fileName, 0));
+  REQUIRE(store.GetTileCount()==0);
+  REQUIRE(store.Put({10, 1, 1, 1, 1}, CreateTile(Qt::red)));
+}
@@ -0,0 +1,195 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/Progress.h>
+
+#include <osmscout/import/Import.h>
+#include <osmscout/import/PreprocessOSM.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+/**
+ * Collects all objects passed by the preprocessor, independent of the
+ * block structure.
+ */
+class CollectingCallback : public osmscout::PreprocessorCallback
+{
+public:
+  std::vector<RawNodeData>     nodes;
+  std::vector<RawWayData>      ways;
+  std::vector<RawRelationData> relations;
+
+public:
+  void ProcessBlock(RawBlockDataRef data) override
+  {
+    nodes.insert(nodes.end(),data->nodeData.begin(),data->nodeData.end());
+    ways.insert(ways.end(),data->wayData.begin(),data->wayData.end());
+    relations.insert(relations.end(),data->relationData.begin(),data->relationData.end());
+  }
+};
+
+static std::string GetTestFilename()
+{
+  return (std::filesystem::temp_directory_path()/"PreprocessOSMChunkTest.osm").string();
+}
+
+/**
+ * Write an *.osm file using the XML constructs the chunked parser has to
+ * handle. Line endings of the file are "\r\n". Comments and CDATA sections
+ * contain element markup and are long enough to be split by small chunks.
+ */
+static void WriteTestFile(const std::string& filename)
+{
+  std::ofstream file(filename,
+                     std::ios::out|std::ios::trunc|std::ios::binary);
+  std::string   padding(300,'x');
+
+  file << "<?xml version='1.0' encoding='UTF-8'?>\r\n";
+  file << "<osm version=\"0.6\" generator=\"test\">\r\n";
+  file << "<!-- <node id=\"999\" lat=\"1.0\" lon=\"1.0\"/> " << padding << " -->\r\n";
+
+  for (size_t i=1; i<=200; i++) {
+    file << " <node id=\"" << i << "\" lat=\"" << 50.0+i*0.001 << "\" lon=\"" << 7.0+i*0.001 << "\"";
+
+    if (i%3==0) {
+      file << ">\r\n";
+      file << "  <tag k=\"name\" v=\"Caf&#xE9; &amp; B&#228;r &lt;" << i << "&gt; &quot;q&quot; &apos;a&apos;\"/>\r\n";
+      file << "  <tag k='note' v='first line\r\nsecond line\rthird\nfourth\tfifth&#13;sixth'/>\r\n";
+      file << " </node>\r\n";
+    }
+    else {
+      file << "/>\r\n";
+    }
+
+    if (i%50==0) {
+      file << " <!-- <way id=\"998\"><nd ref=\"1\"/></way> " << padding << " -->\r\n";
+      file << " <![CDATA[ <relation id=\"997\"> " << padding << " ]]>\r\n";
+      file << " <?test <node id=\"996\" lat=\"1.0\" lon=\"1.0\"/> " << padding << " ?>\r\n";
+    }
+  }
+
+  for (size_t i=1; i<=40; i++) {
+    file << " <way id=\"" << i << "\">\r\n";
+
+    for (size_t n=0; n<5; n++) {
+      file << "  <nd ref=\"" << i+n << "\"/>\r\n";
+    }
+
+    file << "  <tag k=\"name\" v=\"Way\r\n" << i << "\"/>\r\n";
+    file << " </way>\r\n";
+  }
+
+  for (size_t i=1; i<=10; i++) {
+    file << " <relation id=\"" << i << "\">\r\n";
+    file << "  <member type=\"way\" ref=\"" << i << "\" role=\"outer\"/>\r\n";
+    file << "  <member type=\"node\" ref=\"" << i << "\" role=\"\"/>\r\n";
+    file << "  <member type=\"relation\" ref=\"" << i+1 << "\" role=\"sub &amp; more\"/>\r\n";
+    file << "  <tag k=\"name\" v=\"Relation " << i << "\"/>\r\n";
+    file << " </relation>\r\n";
+  }
+
+  file << "</osm>\r\n";
+}
+
+static CollectingCallback Parse(const std::string& filename,
+                                bool parallel,
+                                size_t chunkSize)
+{
+  osmscout::TypeConfigRef   typeConfig=std::make_shared<osmscout::TypeConfig>();
+  osmscout::ImportParameter parameter;
+  osmscout::SilentProgress  progress;
+  CollectingCallback        callback;
+  osmscout::PreprocessOSM   preprocess(callback);
+
+  typeConfig->GetTagRegistry().RegisterTag("name");
+  typeConfig->GetTagRegistry().RegisterTag("note");
+
+  parameter.SetParallelOSMParsing(parallel);
+  parameter.SetParallelOSMChunkSize(chunkSize);
+
+  REQUIRE(preprocess.Import(typeConfig,
+                            parameter,
+                            progress,
+                            filename));
+
+  return callback;
+}
+
+static void RequireEqual(const CollectingCallback& expected,
+                         const CollectingCallback& actual)
+{
+  REQUIRE(actual.nodes.size()==expected.nodes.size());
+  REQUIRE(actual.ways.size()==expected.ways.size());
+  REQUIRE(actual.relations.size()==expected.relations.size());
+
+  for (size_t i=0; i<expected.nodes.size(); i++) {
+    REQUIRE(actual.nodes[i].id==expected.nodes[i].id);
+    REQUIRE(actual.nodes[i].coord==expected.nodes[i].coord);
+    REQUIRE(actual.nodes[i].tags==expected.nodes[i].tags);
+  }
+
+  for (size_t i=0; i<expected.ways.size(); i++) {
+    REQUIRE(actual.ways[i].id==expected.ways[i].id);
+    REQUIRE(actual.ways[i].nodes==expected.ways[i].nodes);
+    REQUIRE(actual.ways[i].tags==expected.ways[i].tags);
+  }
+
+  for (size_t i=0; i<expected.relations.size(); i++) {
+    REQUIRE(actual.relations[i].id==expected.relations[i].id);
+    REQUIRE(actual.relations[i].tags==expected.relations[i].tags);
+    REQUIRE(actual.relations[i].members.size()==expected.relations[i].members.size());
+
+    for (size_t m=0; m<expected.relations[i].members.size(); m++) {
+      REQUIRE(actual.relations[i].members[m].type==expected.relations[i].members[m].type);
+      REQUIRE(actual.relations[i].members[m].id==expected.relations[i].members[m].id);
+      REQUIRE(actual.relations[i].members[m].role==expected.relations[i].members[m].role);
+    }
+  }
+}
+
+TEST_CASE("Chunked parsing matches libxml2")
+{
+  std::string filename=GetTestFilename();
+
+  WriteTestFile(filename);
+
+  CollectingCallback expected=Parse(filename,false,0);
+
+  REQUIRE(expected.nodes.size()==200);
+  REQUIRE(expected.ways.size()==40);
+  REQUIRE(expected.relations.size()==10);
+
+  for (size_t chunkSize : {17,64,256,1000,4*1024*1024}) {
+    INFO("Chunk size " << chunkSize);
+
+    RequireEqual(expected,
+                 Parse(filename,true,chunkSize));
+  }
+
+  std::filesystem::remove(filename);
+}
+
+TEST_CASE("Attribute values are normalized like libxml2")
+{
+  std::string filename=GetTestFilename();
+
+  WriteTestFile(filename);
+
+  CollectingCallback result=Parse(filename,true,64);
+
+  std::filesystem::remove(filename);
+
+  osmscout::TypeConfig typeConfig;
+  osmscout::TagId      nameTag=typeConfig.GetTagRegistry().RegisterTag("name");
+  osmscout::TagId      noteTag=typeConfig.GetTagRegistry().RegisterTag("note");
+
+  REQUIRE(result.nodes[2].tags.at(nameTag)=="Caf\xC3\xA9 & B\xC3\xA4r <3> \"q\" 'a'");
+  REQUIRE(result.nodes[2].tags.at(noteTag)=="first line second line third fourth fifth\rsixth");
+  REQUIRE(result.ways[0].tags.at(nameTag)=="Way 1");
+  REQUIRE(result.relations[0].members[2].role=="sub & more");
+}
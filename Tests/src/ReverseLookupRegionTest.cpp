@@ -0,0 +1,94 @@
+#include "catch.hpp"
+
+#include <algorithm>
+
+#include <osmscout/LocationService.h>
+
+#include <osmscout/util/Geometry.h>
+
+extern osmscout::DatabaseRef        database;
+extern osmscout::LocationServiceRef locationService;
+
+/**
+ * Reference implementation, checks the area of every region of the region tree
+ */
+class ContainingRegionsVisitor : public osmscout::AdminRegionVisitor
+{
+public:
+  osmscout::GeoCoord                coord;
+  std::vector<osmscout::FileOffset> offsets;
+
+public:
+  explicit ContainingRegionsVisitor(const osmscout::GeoCoord& coord)
+  : coord(coord)
+  {
+  }
+
+  Action Visit(const osmscout::AdminRegion& region) override
+  {
+    osmscout::AreaRef area;
+
+    if (!database->GetAreaByOffset(region.object.GetFileOffset(),
+                                   area)) {
+      return error;
+    }
+
+    for (const auto& ring : area->rings) {
+      if (ring.IsTopOuter() &&
+          osmscout::IsCoordInArea(coord,ring.nodes)) {
+        offsets.push_back(region.regionOffset);
+        return visitChildren;
+      }
+    }
+
+    return skipChildren;
+  }
+};
+
+TEST_CASE("Reverse region lookup")
+{
+  SECTION("Database has a region raster")
+  {
+    REQUIRE(database->GetLocationIndex());
+    REQUIRE(database->GetLocationIndex()->GetRegionRaster());
+  }
+
+  SECTION("Raster lookup matches region tree traversal")
+  {
+    osmscout::GeoBox boundingBox;
+
+    REQUIRE(database->GetBoundingBox(boundingBox));
+
+    const size_t gridSize=50;
+    size_t       containedCount=0;
+
+    for (size_t y=0; y<=gridSize; y++) {
+      for (size_t x=0; x<=gridSize; x++) {
+        osmscout::GeoCoord coord(boundingBox.GetMinLat()+boundingBox.GetHeight()*y/gridSize,
+                                 boundingBox.GetMinLon()+boundingBox.GetWidth()*x/gridSize);
+        ContainingRegionsVisitor            visitor(coord);
+        std::list<osmscout::AdminRegionRef> regions;
+        std::vector<osmscout::FileOffset>   offsets;
+
+        REQUIRE(locationService->VisitAdminRegions(visitor));
+        REQUIRE(locationService->ReverseLookupRegion(coord,
+                                                     regions));
+
+        for (const auto& region : regions) {
+          offsets.push_back(region->regionOffset);
+        }
+
+        std::sort(visitor.offsets.begin(),visitor.offsets.end());
+
+        INFO("Location " << coord.GetDisplayText());
+        REQUIRE(offsets==visitor.offsets);
+
+        if (!offsets.empty()) {
+          containedCount++;
+        }
+      }
+    }
+
+    REQUIRE(containedCount>0);
+  }
+}
@@ -0,0 +1,235 @@
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <osmscout/Database.h>
+
+#include <osmscout/routing/RoutePostprocessor.h>
+#include <osmscout/routing/SimpleRoutingService.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Geometry.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+static std::string GetDatabaseDirectory()
+{
+  char* testsTopDirEnv=getenv("TESTS_TOP_DIR");
+
+  if (testsTopDirEnv==nullptr) {
+    return "data/testregion";
+  }
+
+  return osmscout::AppendFileToDir(testsTopDirEnv,"data/testregion");
+}
+
+struct RouteFixture
+{
+  osmscout::DatabaseRef                    database;
+  osmscout::SimpleRoutingServiceRef        router;
+  osmscout::FastestPathRoutingProfileRef   profile;
+  osmscout::RouteDescriptionRef            description;
+};
+
+/**
+ * Calculate a walking route between the given coordinates and postprocess it
+ * with the junction and POI postprocessors. Since the test region does not contain
+ * any motorway junctions, the caller passes the type of named nodes on the path
+ * as junction type.
+ */
+static void CalculateRoute(RouteFixture& fixture,
+                           const osmscout::GeoCoord& from,
+                           const osmscout::GeoCoord& to,
+                           const std::set<std::string>& junctionTypeNames)
+{
+  osmscout::DatabaseParameter databaseParameter;
+
+  fixture.database=std::make_shared<osmscout::Database>(databaseParameter);
+
+  REQUIRE(fixture.database->Open(GetDatabaseDirectory()));
+
+  fixture.router=std::make_shared<osmscout::SimpleRoutingService>(fixture.database,
+                                                                  osmscout::RouterParameter(),
+                                                                  osmscout::RoutingService::DEFAULT_FILENAME_BASE);
+
+  REQUIRE(fixture.router->Open());
+
+  fixture.profile=std::make_shared<osmscout::FastestPathRoutingProfile>(fixture.database->GetTypeConfig());
+  fixture.profile->ParametrizeForFoot(*fixture.database->GetTypeConfig(),
+                                      5.0);
+
+  auto start=fixture.router->GetClosestRoutableNode(from,
+                                                    *fixture.profile,
+                                                    osmscout::Kilometers(1));
+  auto target=fixture.router->GetClosestRoutableNode(to,
+                                                     *fixture.profile,
+                                                     osmscout::Kilometers(1));
+
+  REQUIRE(start.IsValid());
+  REQUIRE(target.IsValid());
+
+  osmscout::RoutingParameter parameter;
+  osmscout::RoutingResult    result=fixture.router->CalculateRoute(*fixture.profile,
+                                                                   start.GetRoutePosition(),
+                                                                   target.GetRoutePosition(),
+                                                                   parameter);
+
+  REQUIRE(result.Success());
+
+  auto descriptionResult=fixture.router->TransformRouteDataToRouteDescription(result.GetRoute());
+
+  REQUIRE(descriptionResult.Success());
+
+  fixture.description=descriptionResult.GetDescription();
+
+  std::list<osmscout::RoutePostprocessor::PostprocessorRef> postprocessors{
+    std::make_shared<osmscout::RoutePostprocessor::DistanceAndTimePostprocessor>(),
+    std::make_shared<osmscout::RoutePostprocessor::MotorwayJunctionPostprocessor>(),
+    std::make_shared<osmscout::RoutePostprocessor::POIsPostprocessor>()
+  };
+
+  osmscout::RoutePostprocessor             postprocessor;
+  std::vector<osmscout::RoutingProfileRef> profiles{fixture.profile};
+  std::vector<osmscout::DatabaseRef>       databases{fixture.database};
+
+  REQUIRE(postprocessor.PostprocessRouteDescription(*fixture.description,
+                                                    profiles,
+                                                    databases,
+                                                    postprocessors,
+                                                    {"highway_motorway"},
+                                                    {"highway_motorway_link"},
+                                                    junctionTypeNames));
+}
+
+TEST_CASE("Junction description is attached to the route")
+{
+  RouteFixture fixture;
+
+  // The cave entrance "Klemperka" is the last node of a path, the route starts there
+  CalculateRoute(fixture,
+                 osmscout::GeoCoord(50.43800,14.55430),
+                 osmscout::GeoCoord(50.43020,14.56650),
+                 {"natural_cave_entrance"});
+
+  const auto& firstNode=fixture.description->Nodes().front();
+
+  REQUIRE(firstNode.HasDescription(osmscout::RouteDescription::MOTORWAY_JUNCTION_DESC));
+
+  auto junction=std::dynamic_pointer_cast<osmscout::RouteDescription::MotorwayJunctionDescription>(firstNode.GetDescription(osmscout::RouteDescription::MOTORWAY_JUNCTION_DESC));
+
+  REQUIRE(junction);
+  REQUIRE(junction->GetJunctionDescription()->GetName()=="Klemperka");
+
+  size_t junctionCount=0;
+
+  for (const auto& node : fixture.description->Nodes()) {
+    if (node.HasDescription(osmscout::RouteDescription::MOTORWAY_JUNCTION_DESC)) {
+      junctionCount++;
+    }
+  }
+
+  REQUIRE(junctionCount==1);
+}
+
+TEST_CASE("POIs within 30 m of the route are attached")
+{
+  RouteFixture fixture;
+
+  // Route through the center of Kokořín
+  CalculateRoute(fixture,
+                 osmscout::GeoCoord(50.42990,14.56300),
+                 osmscout::GeoCoord(50.43300,14.57200),
+                 {});
+
+  osmscout::Distance                maxDistance=osmscout::Meters(30);
+  std::set<osmscout::ObjectFileRef> reportedNodes;
+
+  for (const auto& node : fixture.description->Nodes()) {
+    for (const auto& description : node.GetDescriptions()) {
+      auto poi=std::dynamic_pointer_cast<osmscout::RouteDescription::POIAtRouteDescription>(description);
+
+      if (poi) {
+        REQUIRE(poi->GetDistance()<maxDistance);
+
+        if (poi->GetObject().GetType()==osmscout::refNode) {
+          reportedNodes.insert(poi->GetObject());
+        }
+      }
+    }
+  }
+
+  // Independently compute the routing POI nodes within 30 m of a route segment
+  osmscout::TypeConfigRef typeConfig=fixture.database->GetTypeConfig();
+  osmscout::TypeInfoSet   poiTypes(*typeConfig);
+  osmscout::GeoBox        routeBox;
+
+  for (const auto& type : typeConfig->GetTypes()) {
+    if (type->IsInGroup("routingPOI") &&
+        type->CanBeNode()) {
+      poiTypes.Set(type);
+    }
+  }
+
+  for (const auto& node : fixture.description->Nodes()) {
+    routeBox.Include(osmscout::GeoBox(node.GetLocation(),node.GetLocation()));
+  }
+
+  routeBox.Include(osmscout::GeoBox::BoxAroundCircle(routeBox.GetMinCoord(),osmscout::Meters(100)));
+  routeBox.Include(osmscout::GeoBox::BoxAroundCircle(routeBox.GetMaxCoord(),osmscout::Meters(100)));
+
+  std::vector<osmscout::FileOffset> offsets;
+  std::vector<osmscout::NodeRef>    poiNodes;
+  osmscout::TypeInfoSet             loadedTypes;
+
+  REQUIRE(fixture.database->GetAreaNodeIndex()->GetOffsets(routeBox,
+                                                           poiTypes,
+                                                           offsets,
+                                                           loadedTypes));
+  REQUIRE(fixture.database->GetNodesByOffset(offsets,
+                                             poiNodes));
+
+  std::set<osmscout::ObjectFileRef> expected;
+  size_t                            outsideCount=0;
+
+  for (const auto& poi : poiNodes) {
+    osmscout::Distance minDistance=osmscout::Kilometers(1000);
+
+    for (auto node=fixture.description->Nodes().begin(); node!=fixture.description->Nodes().end(); ++node) {
+      auto nextNode=node;
+
+      ++nextNode;
+
+      if (nextNode==fixture.description->Nodes().end() ||
+          !node->HasPathObject()) {
+        continue;
+      }
+
+      osmscout::GeoCoord intersection;
+      double             r;
+
+      osmscout::DistanceToSegment(poi->GetCoords(),
+                                  node->GetLocation(),
+                                  nextNode->GetLocation(),
+                                  r,
+                                  intersection);
+
+      minDistance=std::min(minDistance,
+                           osmscout::GetEllipsoidalDistance(poi->GetCoords(),
+                                                            intersection));
+    }
+
+    if (minDistance<maxDistance) {
+      expected.insert(poi->GetObjectFileRef());
+    }
+    else {
+      outsideCount++;
+    }
+  }
+
+  // The route passes POIs near the route and some further away
+  REQUIRE(!expected.empty());
+  REQUIRE(outsideCount>0);
+
+  REQUIRE(reportedNodes==expected);
+}
@@ -0,0 +1,236 @@
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include <osmscout/BoundingBoxDataFile.h>
+#include <osmscout/Database.h>
+
+#include <osmscout/routing/RouteNodeDataFile.h>
+#include <osmscout/routing/RoutingGraph.h>
+#include <osmscout/routing/SimpleRoutingService.h>
+
+#include <osmscout/util/File.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+static std::string GetDatabaseDirectory()
+{
+  char* testsTopDirEnv=getenv("TESTS_TOP_DIR");
+
+  if (testsTopDirEnv==nullptr) {
+    return "data/testregion";
+  }
+
+  return osmscout::AppendFileToDir(testsTopDirEnv,"data/testregion");
+}
+
+static osmscout::SimpleRoutingServiceRef OpenRouter(bool routerDataInMemory)
+{
+  osmscout::DatabaseParameter databaseParameter;
+
+  databaseParameter.SetRouterDataInMemory(routerDataInMemory);
+
+  osmscout::DatabaseRef database=std::make_shared<osmscout::Database>(databaseParameter);
+
+  if (!database->Open(GetDatabaseDirectory())) {
+    return nullptr;
+  }
+
+  osmscout::SimpleRoutingServiceRef router=std::make_shared<osmscout::SimpleRoutingService>(database,
+                                                                                            osmscout::RouterParameter(),
+                                                                                            osmscout::RoutingService::DEFAULT_FILENAME_BASE);
+
+  if (!router->Open()) {
+    return nullptr;
+  }
+
+  return router;
+}
+
+TEST_CASE("Routing graph contains all route nodes of the data file")
+{
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::Database          database(databaseParameter);
+  osmscout::RouteNodeDataFile dataFile(osmscout::RoutingService::GetDataFilename(osmscout::RoutingService::DEFAULT_FILENAME_BASE),
+                                       1000);
+
+  REQUIRE(database.Open(GetDatabaseDirectory()));
+  REQUIRE(dataFile.Open(database.GetTypeConfig(),GetDatabaseDirectory(),false));
+
+  std::vector<osmscout::RouteNode> routeNodes;
+
+  REQUIRE(dataFile.GetAll(routeNodes));
+  REQUIRE(!routeNodes.empty());
+
+  std::vector<osmscout::RouteNode> expectedNodes(routeNodes);
+  osmscout::RoutingGraph           graph;
+
+  graph.Build(routeNodes);
+
+  REQUIRE(graph.GetNodeCount()==expectedNodes.size());
+  REQUIRE(graph.GetMemoryUsage()>0);
+
+  for (const auto& expected : expectedNodes) {
+    uint32_t node=graph.FindNode(expected.GetId());
+
+    REQUIRE(node!=osmscout::RoutingGraph::InvalidIndex);
+    REQUIRE(graph.GetNodeId(node)==expected.GetId());
+    REQUIRE(graph.GetNodeCoord(node).GetLat()==expected.GetCoord().GetLat());
+    REQUIRE(graph.GetNodeCoord(node).GetLon()==expected.GetCoord().GetLon());
+
+    REQUIRE(graph.GetObjectEnd(node)-graph.GetObjectBegin(node)==expected.objects.size());
+
+    for (size_t i=0; i<expected.objects.size(); i++) {
+      REQUIRE(graph.GetObject(graph.GetObjectBegin(node)+(uint32_t)i)==expected.objects[i].object);
+      REQUIRE(graph.GetObjectVariantIndex(graph.GetObjectBegin(node)+(uint32_t)i)==expected.objects[i].objectVariantIndex);
+    }
+
+    REQUIRE(graph.GetPathEnd(node)-graph.GetPathBegin(node)==expected.paths.size());
+
+    for (size_t i=0; i<expected.paths.size(); i++) {
+      uint32_t path=graph.GetPathBegin(node)+(uint32_t)i;
+
+      REQUIRE(graph.GetPathTarget(path)!=osmscout::RoutingGraph::InvalidIndex);
+      REQUIRE(graph.GetNodeId(graph.GetPathTarget(path))==expected.paths[i].id);
+      REQUIRE(graph.GetPathDistance(path)==expected.paths[i].distance);
+      REQUIRE(graph.GetPathFlags(path)==expected.paths[i].flags);
+      REQUIRE(graph.GetPathObject(path)==expected.objects[expected.paths[i].objectIndex].object);
+    }
+
+    REQUIRE(graph.GetExcludeEnd(node)-graph.GetExcludeBegin(node)==expected.excludes.size());
+
+    for (size_t i=0; i<expected.excludes.size(); i++) {
+      uint32_t exclude=graph.GetExcludeBegin(node)+(uint32_t)i;
+
+      REQUIRE(graph.GetExcludeSource(exclude)==expected.excludes[i].source);
+      REQUIRE(graph.GetExcludeTarget(exclude)==expected.objects[expected.excludes[i].targetIndex].object);
+    }
+  }
+
+  REQUIRE(graph.FindNode(0)==osmscout::RoutingGraph::InvalidIndex);
+}
+
+TEST_CASE("Routing on the in-memory graph returns the same routes as routing on the data file")
+{
+  osmscout::SimpleRoutingServiceRef fileRouter=OpenRouter(false);
+  osmscout::SimpleRoutingServiceRef memoryRouter=OpenRouter(true);
+
+  REQUIRE(fileRouter);
+  REQUIRE(memoryRouter);
+
+  osmscout::BoundingBoxDataFile boundingBoxDataFile;
+
+  REQUIRE(boundingBoxDataFile.Load(GetDatabaseDirectory()));
+
+  osmscout::GeoBox                    boundingBox=boundingBoxDataFile.GetBoundingBox();
+  osmscout::FastestPathRoutingProfile carProfile(fileRouter->GetTypeConfig());
+  osmscout::ShortestPathRoutingProfile footProfile(fileRouter->GetTypeConfig());
+  std::map<std::string,double>        carSpeedTable;
+
+  // Prefer major roads, so that the fastest route differs from the shortest route
+  for (const auto& type : fileRouter->GetTypeConfig()->GetTypes()) {
+    if (type->CanRouteCar()) {
+      carSpeedTable[type->GetName()]=type->GetName().find("motorway")!=std::string::npos ? 110.0 :
+                                     type->GetName().find("primary")!=std::string::npos ? 70.0 : 40.0;
+    }
+  }
+
+  REQUIRE(carProfile.ParametrizeForCar(*fileRouter->GetTypeConfig(),carSpeedTable,160.0));
+  footProfile.ParametrizeForFoot(*fileRouter->GetTypeConfig(),5.0);
+
+  std::vector<std::pair<double,double>> fractions{{0.2,0.2},{0.8,0.8},{0.2,0.8},{0.8,0.2},{0.5,0.5}};
+  size_t                                routeCount=0;
+
+  for (osmscout::RoutingProfile* profile : std::vector<osmscout::RoutingProfile*>{&carProfile,&footProfile}) {
+    for (size_t s=0; s<fractions.size(); s++) {
+      for (size_t t=0; t<fractions.size(); t++) {
+        if (s==t) {
+          continue;
+        }
+
+        osmscout::GeoCoord startCoord(boundingBox.GetMinLat()+boundingBox.GetHeight()*fractions[s].first,
+                                      boundingBox.GetMinLon()+boundingBox.GetWidth()*fractions[s].second);
+        osmscout::GeoCoord targetCoord(boundingBox.GetMinLat()+boundingBox.GetHeight()*fractions[t].first,
+                                       boundingBox.GetMinLon()+boundingBox.GetWidth()*fractions[t].second);
+
+        osmscout::RoutePositionResult start=fileRouter->GetClosestRoutableNode(startCoord,*profile,osmscout::Kilometers(1));
+        osmscout::RoutePositionResult target=fileRouter->GetClosestRoutableNode(targetCoord,*profile,osmscout::Kilometers(1));
+
+        if (!start.IsValid() ||
+            !target.IsValid()) {
+          continue;
+        }
+
+        osmscout::RoutingParameter parameter;
+        osmscout::RoutingResult    fileResult=fileRouter->CalculateRoute(*profile,
+                                                                         start.GetRoutePosition(),
+                                                                         target.GetRoutePosition(),
+                                                                         parameter);
+        osmscout::RoutingResult    memoryResult=memoryRouter->CalculateRoute(*profile,
+                                                                           start.GetRoutePosition(),
+                                                                           target.GetRoutePosition(),
+                                                                           parameter);
+
+        INFO("Route from " << startCoord.GetDisplayText() << " to " << targetCoord.GetDisplayText());
+
+        REQUIRE(fileResult.Success()==memoryResult.Success());
+
+        const auto& fileEntries=fileResult.GetRoute().Entries();
+        const auto& memoryEntries=memoryResult.GetRoute().Entries();
+
+        REQUIRE(fileEntries.size()==memoryEntries.size());
+
+        auto memoryEntry=memoryEntries.begin();
+
+        for (const auto& fileEntry : fileEntries) {
+          REQUIRE(fileEntry.GetCurrentNodeId()==memoryEntry->GetCurrentNodeId());
+          REQUIRE(fileEntry.GetCurrentNodeIndex()==memoryEntry->GetCurrentNodeIndex());
+          REQUIRE(fileEntry.GetPathObject()==memoryEntry->GetPathObject());
+          REQUIRE(fileEntry.GetTargetNodeIndex()==memoryEntry->GetTargetNodeIndex());
+
+          ++memoryEntry;
+        }
+
+        if (fileResult.Success()) {
+          routeCount++;
+        }
+      }
+    }
+  }
+
+  REQUIRE(routeCount>0);
+}
+
+TEST_CASE("Search index entries are unset after reset")
+{
+  osmscout::RoutingGraphSearchIndex index;
+
+  index.Reset(10);
+
+  for (uint32_t node=0; node<10; node++) {
+    REQUIRE(index.Get(node)==osmscout::RoutingGraph::InvalidIndex);
+  }
+
+  index.Set(3,0);
+  index.Set(7,1);
+
+  REQUIRE(index.Get(3)==0);
+  REQUIRE(index.Get(7)==1);
+  REQUIRE(index.Get(5)==osmscout::RoutingGraph::InvalidIndex);
+
+  index.Reset(10);
+
+  REQUIRE(index.Get(3)==osmscout::RoutingGraph::InvalidIndex);
+  REQUIRE(index.Get(7)==osmscout::RoutingGraph::InvalidIndex);
+
+  index.Set(7,0);
+
+  REQUIRE(index.Get(7)==0);
+
+  // A graph of different size starts from scratch
+  index.Reset(20);
+
+  REQUIRE(index.Get(7)==osmscout::RoutingGraph::InvalidIndex);
+  REQUIRE(index.Get(19)==osmscout::RoutingGraph::InvalidIndex);
+}
@@ -0,0 +1,448 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <osmscout/TypeConfig.h>
+#include <osmscout/StyleConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Projection.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+static std::string GetStylesheetDirectory()
+{
+  char* testsTopDirEnv=getenv("TESTS_TOP_DIR");
+
+  if (testsTopDirEnv==nullptr) {
+    return "../stylesheets";
+  }
+
+  return osmscout::AppendFileToDir(testsTopDirEnv,"../stylesheets");
+}
+
+/**
+ * Empty cache directory in the temporary directory, removed again at the end of the test
+ */
+struct CacheDirectory
+{
+  std::filesystem::path path;
+
+  CacheDirectory()
+  : path(std::filesystem::temp_directory_path()/"StyleConfigCacheTest")
+  {
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+  }
+
+  ~CacheDirectory()
+  {
+    std::filesystem::remove_all(path);
+  }
+
+  size_t GetCacheFileCount() const
+  {
+    size_t count=0;
+
+    for (const auto& entry : std::filesystem::directory_iterator(path)) {
+      if (entry.path().extension()==".ossc") {
+        count++;
+      }
+    }
+
+    return count;
+  }
+};
+
+static osmscout::TypeConfigRef LoadTypeConfig()
+{
+  osmscout::TypeConfigRef typeConfig=std::make_shared<osmscout::TypeConfig>();
+
+  REQUIRE(typeConfig->LoadFromOSTFile(osmscout::AppendFileToDir(GetStylesheetDirectory(),"map.ost")));
+
+  return typeConfig;
+}
+
+static osmscout::StyleConfigRef LoadStyleConfig(const osmscout::TypeConfigRef& typeConfig,
+                                                bool daylight,
+                                                const std::string& cacheDirectory)
+{
+  osmscout::StyleConfigRef styleConfig=std::make_shared<osmscout::StyleConfig>(typeConfig);
+  std::string              styleFile=osmscout::AppendFileToDir(GetStylesheetDirectory(),"standard.oss");
+
+  styleConfig->AddFlag("daylight",daylight);
+
+  if (!cacheDirectory.empty()) {
+    REQUIRE(styleConfig->LoadCached(styleFile,cacheDirectory));
+  }
+  else {
+    REQUIRE(styleConfig->Load(styleFile));
+  }
+
+  return styleConfig;
+}
+
+/**
+ * Returns feature value buffers for the given type: one without any features, one
+ * for each feature of the type and one with all features set.
+ */
+static std::vector<std::shared_ptr<osmscout::FeatureValueBuffer>> GetBuffers(const osmscout::TypeInfoRef& type)
+{
+  std::vector<std::shared_ptr<osmscout::FeatureValueBuffer>> buffers;
+
+  buffers.push_back(std::make_shared<osmscout::FeatureValueBuffer>());
+  buffers.back()->SetType(type);
+
+  for (size_t idx=0; idx<type->GetFeatureCount(); idx++) {
+    buffers.push_back(std::make_shared<osmscout::FeatureValueBuffer>());
+    buffers.back()->SetType(type);
+    buffers.back()->AllocateValue(idx);
+  }
+
+  if (type->GetFeatureCount()>1) {
+    buffers.push_back(std::make_shared<osmscout::FeatureValueBuffer>());
+    buffers.back()->SetType(type);
+
+    for (size_t idx=0; idx<type->GetFeatureCount(); idx++) {
+      buffers.back()->AllocateValue(idx);
+    }
+  }
+
+  return buffers;
+}
+
+/**
+ * Statistics over the styles returned, to make sure the tested style sheet actually
+ * exercises the various parts of the cache
+ */
+struct StyleStatistics
+{
+  size_t iconStyles=0;
+  size_t iconSymbols=0;
+  size_t shieldStyles=0;
+  size_t pathSymbolStyles=0;
+  size_t borderSymbolStyles=0;
+  size_t featureDependentStyles=0;
+};
+
+static void Dump(std::ostream& out,
+                 const osmscout::LabelProviderRef& label)
+{
+  out << "label=" << (label ? label->GetName() : "-") << ";";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::FillStyle& style)
+{
+  out << "fill(" << style.GetFillColor().ToHexString() << ";" << style.GetPatternName() << ";" << style.GetPatternId() << ";" << style.GetPatternMinMag().GetMagnification() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::BorderStyle& style)
+{
+  out << "border(" << style.GetSlot() << ";" << style.GetColor().ToHexString() << ";" << style.GetGapColor().ToHexString() << ";" << style.GetWidth() << ";";
+
+  for (const auto dash : style.GetDash()) {
+    out << dash << ",";
+  }
+
+  out << ";" << style.GetDisplayOffset() << ";" << style.GetOffset() << ";" << style.GetPriority() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::SymbolRef& symbol,
+                 const osmscout::Projection& projection)
+{
+  if (!symbol) {
+    out << "symbol=-;";
+    return;
+  }
+
+  out << "symbol(" << symbol->GetName() << ";" << symbol->GetWidth(projection) << ";" << symbol->GetHeight(projection) << ";";
+
+  for (const auto& primitive : symbol->GetPrimitives()) {
+    out << (int)primitive->GetProjectionMode() << ";";
+
+    if (primitive->GetFillStyle()) {
+      Dump(out,*primitive->GetFillStyle());
+    }
+
+    if (primitive->GetBorderStyle()) {
+      Dump(out,*primitive->GetBorderStyle());
+    }
+  }
+
+  out << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::LineStyle& style)
+{
+  out << "line(" << style.GetSlot() << ";" << style.GetLineColor().ToHexString() << ";" << style.GetGapColor().ToHexString() << ";"
+      << style.GetDisplayWidth() << ";" << style.GetWidth() << ";" << style.GetDisplayOffset() << ";" << style.GetOffset() << ";"
+      << (int)style.GetJoinCap() << ";" << (int)style.GetEndCap() << ";";
+
+  for (const auto dash : style.GetDash()) {
+    out << dash << ",";
+  }
+
+  out << ";" << style.GetPriority() << ";" << style.GetZIndex() << ";" << (int)style.GetOffsetRel() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::TextStyle& style)
+{
+  out << "text(" << style.GetSlot() << ";" << style.GetPriority() << ";" << style.GetSize() << ";";
+  Dump(out,style.GetLabel());
+  out << style.GetPosition() << ";" << style.GetTextColor().ToHexString() << ";" << (int)style.GetStyle() << ";"
+      << style.GetScaleAndFadeMag().GetMagnification() << ";" << style.GetAutoSize() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::PathTextStyle& style)
+{
+  out << "pathText(";
+  Dump(out,style.GetLabel());
+  out << style.GetSize() << ";" << style.GetTextColor().ToHexString() << ";" << style.GetDisplayOffset() << ";" << style.GetOffset() << ";" << style.GetPriority() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::PathShieldStyle& style)
+{
+  out << "shield(" << style.GetPriority() << ";" << style.GetSize() << ";";
+  Dump(out,style.GetLabel());
+  out << style.GetTextColor().ToHexString() << ";" << style.GetBgColor().ToHexString() << ";" << style.GetBorderColor().ToHexString() << ";" << style.GetShieldSpace() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::IconStyle& style,
+                 const osmscout::Projection& projection)
+{
+  out << "icon(";
+  Dump(out,style.GetSymbol(),projection);
+  out << style.GetIconName() << ";" << style.GetIconId() << ";" << style.GetWidth() << ";" << style.GetHeight() << ";"
+      << style.GetPosition() << ";" << style.GetPriority() << ";" << style.IsOverlay() << ")";
+}
+
+static void Dump(std::ostream& out,
+                 const osmscout::PathSymbolStyle& style,
+                 const osmscout::Projection& projection)
+{
+  out << "pathSymbol(" << style.GetSlot() << ";";
+  Dump(out,style.GetSymbol(),projection);
+  out << style.GetSymbolSpace() << ";" << style.GetDisplayOffset() << ";" << style.GetOffset() << ";" << (int)style.GetOffsetRel() << ")";
+}
+
+/**
+ * Returns a textual description of all styles the style config returns for the given
+ * object at the given projection
+ */
+static std::string DumpStyles(const osmscout::StyleConfig& styleConfig,
+                              const osmscout::TypeInfoRef& type,
+                              const osmscout::FeatureValueBuffer& buffer,
+                              const osmscout::Projection& projection,
+                              StyleStatistics& statistics)
+{
+  std::ostringstream out;
+
+  out << "prio=" << styleConfig.GetWayPrio(type) << ";";
+
+  std::vector<osmscout::TextStyleRef> textStyles;
+
+  styleConfig.GetNodeTextStyles(buffer,projection,textStyles);
+
+  for (const auto& style : textStyles) {
+    Dump(out,*style);
+  }
+
+  if (auto iconStyle=styleConfig.GetNodeIconStyle(buffer,projection); iconStyle) {
+    Dump(out,*iconStyle,projection);
+    statistics.iconStyles++;
+
+    if (iconStyle->GetSymbol()) {
+      statistics.iconSymbols++;
+    }
+  }
+
+  std::vector<osmscout::LineStyleRef> lineStyles;
+
+  styleConfig.GetWayLineStyles(buffer,projection,lineStyles);
+
+  for (const auto& style : lineStyles) {
+    Dump(out,*style);
+  }
+
+  std::vector<osmscout::PathSymbolStyleRef> pathSymbolStyles;
+
+  styleConfig.GetWayPathSymbolStyle(buffer,projection,pathSymbolStyles);
+
+  for (const auto& style : pathSymbolStyles) {
+    Dump(out,*style,projection);
+    statistics.pathSymbolStyles++;
+  }
+
+  if (auto pathTextStyle=styleConfig.GetWayPathTextStyle(buffer,projection); pathTextStyle) {
+    Dump(out,*pathTextStyle);
+  }
+
+  if (auto shieldStyle=styleConfig.GetWayPathShieldStyle(buffer,projection); shieldStyle) {
+    Dump(out,*shieldStyle);
+    statistics.shieldStyles++;
+  }
+
+  if (auto fillStyle=styleConfig.GetAreaFillStyle(type,buffer,projection); fillStyle) {
+    Dump(out,*fillStyle);
+  }
+
+  std::vector<osmscout::BorderStyleRef> borderStyles;
+
+  styleConfig.GetAreaBorderStyles(type,buffer,projection,borderStyles);
+
+  for (const auto& style : borderStyles) {
+    Dump(out,*style);
+  }
+
+  textStyles.clear();
+  styleConfig.GetAreaTextStyles(type,buffer,projection,textStyles);
+
+  for (const auto& style : textStyles) {
+    Dump(out,*style);
+  }
+
+  if (auto iconStyle=styleConfig.GetAreaIconStyle(type,buffer,projection); iconStyle) {
+    Dump(out,*iconStyle,projection);
+    statistics.iconStyles++;
+
+    if (iconStyle->GetSymbol()) {
+      statistics.iconSymbols++;
+    }
+  }
+
+  if (auto borderTextStyle=styleConfig.GetAreaBorderTextStyle(type,buffer,projection); borderTextStyle) {
+    Dump(out,*borderTextStyle);
+  }
+
+  if (auto borderSymbolStyle=styleConfig.GetAreaBorderSymbolStyle(type,buffer,projection); borderSymbolStyle) {
+    Dump(out,*borderSymbolStyle,projection);
+    statistics.borderSymbolStyles++;
+  }
+
+  return out.str();
+}
+
+/**
+ * Compares the styles both style configs return for objects of all types with
+ * various features set at all magnification levels
+ */
+static void CompareStyleConfigs(const osmscout::TypeConfig& typeConfig,
+                                const osmscout::StyleConfig& expected,
+                                const osmscout::StyleConfig& actual)
+{
+  StyleStatistics statistics;
+  StyleStatistics ignored;
+
+  REQUIRE(expected.GetFlags()==actual.GetFlags());
+
+  for (uint32_t level=0; level<=20; level++) {
+    osmscout::Magnification      magnification{osmscout::MagnificationLevel(level)};
+    osmscout::MercatorProjection projection;
+    osmscout::TypeInfoSet        expectedTypes;
+    osmscout::TypeInfoSet        actualTypes;
+
+    projection.Set(osmscout::GeoCoord(51.0,7.0),
+                   magnification,
+                   96.0,
+                   800,
+                   600);
+
+    expected.GetNodeTypesWithMaxMag(magnification,expectedTypes);
+    actual.GetNodeTypesWithMaxMag(magnification,actualTypes);
+    REQUIRE(expectedTypes==actualTypes);
+
+    expected.GetWayTypesWithMaxMag(magnification,expectedTypes);
+    actual.GetWayTypesWithMaxMag(magnification,actualTypes);
+    REQUIRE(expectedTypes==actualTypes);
+
+    expected.GetAreaTypesWithMaxMag(magnification,expectedTypes);
+    actual.GetAreaTypesWithMaxMag(magnification,actualTypes);
+    REQUIRE(expectedTypes==actualTypes);
+
+    for (const auto& type : typeConfig.GetTypes()) {
+      std::string featureLessStyles;
+
+      for (const auto& buffer : GetBuffers(type)) {
+        std::string expectedStyles=DumpStyles(expected,type,*buffer,projection,statistics);
+        std::string actualStyles=DumpStyles(actual,type,*buffer,projection,ignored);
+
+        INFO("Type " << type->GetName() << " level " << level);
+        REQUIRE(expectedStyles==actualStyles);
+
+        if (featureLessStyles.empty()) {
+          featureLessStyles=expectedStyles;
+        }
+        else if (expectedStyles!=featureLessStyles) {
+          statistics.featureDependentStyles++;
+        }
+      }
+    }
+  }
+
+  REQUIRE(statistics.iconStyles>0);
+  REQUIRE(statistics.iconSymbols>0);
+  REQUIRE(statistics.shieldStyles>0);
+  REQUIRE(statistics.pathSymbolStyles>0);
+  REQUIRE(statistics.featureDependentStyles>0);
+}
+
+TEST_CASE("Style sheet loaded from cache equals parsed style sheet")
+{
+  CacheDirectory          cacheDirectory;
+  osmscout::TypeConfigRef typeConfig=LoadTypeConfig();
+  size_t                  cacheFileCount=0;
+
+  for (bool daylight : {true, false}) {
+    INFO("daylight " << daylight);
+
+    osmscout::StyleConfigRef parsed=LoadStyleConfig(typeConfig,daylight,"");
+
+    // First call parses and writes the cache, second call reads it
+    osmscout::StyleConfigRef written=LoadStyleConfig(typeConfig,daylight,cacheDirectory.path.string());
+
+    cacheFileCount++;
+    REQUIRE(cacheDirectory.GetCacheFileCount()==cacheFileCount);
+
+    osmscout::StyleConfigRef cached=LoadStyleConfig(typeConfig,daylight,cacheDirectory.path.string());
+
+    REQUIRE(cacheDirectory.GetCacheFileCount()==cacheFileCount);
+
+    CompareStyleConfigs(*typeConfig,*parsed,*written);
+    CompareStyleConfigs(*typeConfig,*parsed,*cached);
+  }
+}
+
+TEST_CASE("Stale style sheet cache is rejected")
+{
+  CacheDirectory          cacheDirectory;
+  osmscout::TypeConfigRef typeConfig=LoadTypeConfig();
+  std::string             styleFile=(cacheDirectory.path/"StyleConfigCacheTest.oss").string();
+
+  for (bool value : {true, false}) {
+    INFO("value " << value);
+
+    std::ofstream stream(styleFile,std::ios::trunc);
+
+    stream << "OSS" << std::endl;
+    stream << "FLAG" << std::endl;
+    stream << "  test = " << (value ? "true" : "false") << ";" << std::endl;
+    stream << "END" << std::endl;
+    stream.close();
+
+    osmscout::StyleConfig styleConfig(typeConfig);
+
+    REQUIRE(styleConfig.LoadCached(styleFile,cacheDirectory.path.string()));
+    REQUIRE(styleConfig.GetFlagByName("test")==value);
+    REQUIRE(cacheDirectory.GetCacheFileCount()==1);
+  }
+}
@@ -0,0 +1,137 @@
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <osmscout/util/Tracing.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+static void RecordNestedScopes(size_t count)
+{
+  for (size_t i=0; i<count; i++) {
+    osmscout::TraceScope outer("Test","Outer");
+    {
+      osmscout::TraceScope inner("Test","Inner");
+    }
+  }
+}
+
+TEST_CASE("Nothing is recorded while tracing is disabled")
+{
+  osmscout::tracer.Enable(false);
+  osmscout::tracer.Clear();
+
+  RecordNestedScopes(10);
+
+  REQUIRE(osmscout::tracer.GetEvents().empty());
+}
+
+TEST_CASE("Nested scopes of multiple threads are recorded")
+{
+  osmscout::tracer.Clear();
+  osmscout::tracer.Enable(true);
+
+  std::thread thread(RecordNestedScopes,5);
+
+  RecordNestedScopes(5);
+
+  thread.join();
+
+  osmscout::tracer.Enable(false);
+
+  std::vector<osmscout::TraceEvent> events=osmscout::tracer.GetEvents();
+
+  REQUIRE(events.size()==20);
+
+  std::set<uint32_t> threadIds;
+
+  for (size_t i=0; i<events.size(); i+=2) {
+    const osmscout::TraceEvent& outer=events[i];
+    const osmscout::TraceEvent& inner=events[i+1];
+
+    threadIds.insert(outer.threadId);
+
+    // Events are sorted by start time, the outer scope starts first and encloses the inner scope
+    REQUIRE(std::string(outer.name)=="Outer");
+    REQUIRE(std::string(inner.name)=="Inner");
+    REQUIRE(outer.threadId==inner.threadId);
+    REQUIRE(outer.start<=inner.start);
+    REQUIRE(outer.start+outer.duration>=inner.start+inner.duration);
+  }
+
+  REQUIRE(threadIds.size()==2);
+}
+
+TEST_CASE("Buffers of exited threads are reused")
+{
+  osmscout::tracer.SetBufferSize(8);
+  osmscout::tracer.Enable(true);
+
+  for (size_t i=0; i<100; i++) {
+    std::thread thread(RecordNestedScopes,1);
+
+    thread.join();
+  }
+
+  osmscout::tracer.Enable(false);
+
+  std::vector<osmscout::TraceEvent> events=osmscout::tracer.GetEvents();
+  std::set<uint32_t>                threadIds;
+
+  for (const auto& event : events) {
+    threadIds.insert(event.threadId);
+  }
+
+  // Each thread continued the ring buffer of its predecessor, so only
+  // the events of the last four threads are held
+  REQUIRE(events.size()==8);
+  REQUIRE(threadIds.size()==4);
+
+  osmscout::tracer.SetBufferSize(osmscout::Tracer::DEFAULT_BUFFER_SIZE);
+}
+
+TEST_CASE("Ring buffer holds the latest events")
+{
+  osmscout::tracer.SetBufferSize(8);
+  osmscout::tracer.Enable(true);
+
+  for (size_t i=0; i<20; i++) {
+    osmscout::TraceScope scope("Test",std::to_string(i));
+  }
+
+  osmscout::tracer.Enable(false);
+
+  std::vector<osmscout::TraceEvent> events=osmscout::tracer.GetEvents();
+
+  REQUIRE(events.size()==8);
+
+  for (size_t i=0; i<events.size(); i++) {
+    REQUIRE(std::string(events[i].name)==std::to_string(i+12));
+  }
+
+  osmscout::tracer.SetBufferSize(osmscout::Tracer::DEFAULT_BUFFER_SIZE);
+}
+
+TEST_CASE("Events are exported in Chrome trace format")
+{
+  osmscout::tracer.Clear();
+  osmscout::tracer.Enable(true);
+
+  {
+    osmscout::TraceScope scope("Test","Quoted \"name\"");
+  }
+
+  osmscout::tracer.Enable(false);
+
+  std::ostringstream stream;
+
+  osmscout::tracer.WriteChromeTrace(stream);
+
+  std::string trace=stream.str();
+
+  REQUIRE(trace.find("\"traceEvents\":[")!=std::string::npos);
+  REQUIRE(trace.find("\"ph\":\"M\"")!=std::string::npos);
+  REQUIRE(trace.find("\"name\":\"Quoted \\\"name\\\"\",\"cat\":\"Test\",\"ph\":\"X\"")!=std::string::npos);
+  REQUIRE(trace.substr(trace.size()-3)=="]}\n");
+}
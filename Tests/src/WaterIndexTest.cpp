@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+
+#include <osmscout/BoundingBoxDataFile.h>
+#include <osmscout/WaterIndex.h>
+
+#include <osmscout/util/File.h>
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+static std::string GetDatabaseDirectory()
+{
+  char* testsTopDirEnv=getenv("TESTS_TOP_DIR");
+
+  if (testsTopDirEnv==nullptr) {
+    return "data/testregion";
+  }
+
+  return osmscout::AppendFileToDir(testsTopDirEnv,"data/testregion");
+}
+
+static bool IsSameTile(const osmscout::GroundTile& a,
+                       const osmscout::GroundTile& b)
+{
+  return a.type==b.type &&
+         a.xAbs==b.xAbs &&
+         a.yAbs==b.yAbs &&
+         a.xRel==b.xRel &&
+         a.yRel==b.yRel &&
+         a.cellWidth==b.cellWidth &&
+         a.cellHeight==b.cellHeight &&
+         a.coords==b.coords;
+}
+
+TEST_CASE("In-memory water index returns the same ground tiles as the file")
+{
+  osmscout::BoundingBoxDataFile boundingBoxDataFile;
+  osmscout::WaterIndex          fileIndex;
+  osmscout::WaterIndex          memoryIndex;
+
+  REQUIRE(boundingBoxDataFile.Load(GetDatabaseDirectory()));
+  REQUIRE(fileIndex.Open(GetDatabaseDirectory(),false));
+  REQUIRE(memoryIndex.Open(GetDatabaseDirectory(),false,true));
+
+  REQUIRE(!fileIndex.IsInMemory());
+  REQUIRE(memoryIndex.IsInMemory());
+  REQUIRE(memoryIndex.GetMemoryUsage()>0);
+
+  osmscout::GeoBox boundingBox=boundingBoxDataFile.GetBoundingBox();
+
+  // Include some border around the imported region
+  boundingBox=osmscout::GeoBox(osmscout::GeoCoord(boundingBox.GetMinLat()-0.1,
+                                                  boundingBox.GetMinLon()-0.1),
+                               osmscout::GeoCoord(boundingBox.GetMaxLat()+0.1,
+                                                  boundingBox.GetMaxLon()+0.1));
+
+  size_t tileCount=0;
+
+  for (uint32_t level=0; level<=18; level++) {
+    osmscout::Magnification         magnification{osmscout::MagnificationLevel(level)};
+    std::list<osmscout::GroundTile> fileTiles;
+    std::list<osmscout::GroundTile> memoryTiles;
+
+    INFO("Level " << level);
+
+    REQUIRE(fileIndex.GetRegions(boundingBox,magnification,fileTiles));
+    REQUIRE(memoryIndex.GetRegions(boundingBox,magnification,memoryTiles));
+
+    REQUIRE(fileTiles.size()==memoryTiles.size());
+    REQUIRE(std::equal(fileTiles.begin(),fileTiles.end(),memoryTiles.begin(),IsSameTile));
+
+    tileCount+=fileTiles.size();
+  }
+
+  REQUIRE(tileCount>0);
+}
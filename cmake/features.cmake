@@ -181,6 +181,7 @@ set(HAVE_LIB_QT5_WIDGETS ${Qt5Widgets_FOUND})
 set(OSMSCOUT_HAVE_LIB_MARISA ${HAVE_LIB_MARISA})
 set(OSMSCOUT_HAVE_LONG_LONG ${HAVE_LONG_LONG})
 set(OSMSCOUT_HAVE_SSE2 ${HAVE_SSE2})
+set(OSMSCOUT_HAVE_TRACING ${OSMSCOUT_ENABLE_TRACING})
 set(OSMSCOUT_HAVE_STDINT_H ${HAVE_STDINT_H})
 set(OSMSCOUT_HAVE_STD_WSTRING ${HAVE_STD__WSTRING})
 set(OSMSCOUT_HAVE_UINT16_T ${HAVE_UINT16_T})
@@ -189,6 +190,7 @@ set(OSMSCOUT_HAVE_UINT64_T ${HAVE_UINT64_T})
 set(OSMSCOUT_HAVE_UINT8_T ${HAVE_UINT8_T})
 set(OSMSCOUT_HAVE_ULONG_LONG ${HAVE_UNSIGNED_LONG_LONG})
 set(OSMSCOUT_IMPORT_HAVE_LIB_MARISA ${MARISA_FOUND})
+set(OSMSCOUT_IMPORT_HAVE_XML_SUPPORT ${LIBXML2_FOUND})
 set(OSMSCOUT_GPX_HAVE_LIB_XML ${LIBXML2_FOUND})
 set(OSMSCOUT_MAP_CAIRO_HAVE_LIB_PANGO ${PANGOCAIRO_FOUND})
 set(OSMSCOUT_MAP_OPENGL_HAVE_GL_GLUT_H ${HAVE_LIB_GLUT})
@@ -200,8 +200,17 @@ public:
 
   bool LoadStyle(QString stylesheetFilename,
                  std::unordered_map<std::string,bool> stylesheetFlags,
+                 const QString &styleCacheDirectory,
                  QList<StyleError> &errors);
 
+  /**
+   * Load the style sheet into the given style config. If a cache directory is given,
+   * the precompiled style sheet from the cache is used if it is up to date.
+   */
+  static bool LoadStyleConfig(osmscout::StyleConfig &styleConfig,
+                              const QString &stylesheetFilename,
+                              const QString &styleCacheDirectory);
+
   /**
    * Get or create thread local MapPainter instance for this map
    * \note To make sure that painter will not be destroyed during usage,
@@ -150,6 +150,7 @@ protected:
 
   QString                            stylesheetFilename;
   QString                            iconDirectory;
+  QString                            styleCacheDirectory; //!< Directory for precompiled style sheets, empty if disabled
   std::unordered_map<std::string,bool>
                                      stylesheetFlags;
   bool                               daylight;
@@ -167,6 +168,7 @@ public:
   DBThread(QThread *backgroundThread,
            QString basemapLookupDirectory,
            QString iconDirectory,
+           QString styleCacheDirectory,
            SettingsRef settings,
            MapManagerRef mapManager,
            const std::vector<std::string> &customPoiTypes);
@@ -26,6 +26,7 @@
 #include <osmscout/DBThread.h>
 #include <osmscout/LookupModule.h>
 #include <osmscout/MapRenderer.h>
+#include <osmscout/OfflineTileStore.h>
 #include <osmscout/Router.h>
 #include <osmscout/SearchModule.h>
 #include <osmscout/StyleModule.h>
@@ -59,6 +60,8 @@ private:
 
   size_t onlineTileCacheSize{100};
   size_t offlineTileCacheSize{200};
+  size_t offlineTileStoreSize{64*1024*1024};
+  size_t offlineTileRenderingThreads{1};
 
   QString voiceLookupDirectory;
 
@@ -169,6 +172,25 @@ public:
     return *this;
   }
 
+  /**
+   * Maximum size (in bytes) of the persistent store of rendered offline tiles
+   * in the cache location. Zero disables the store.
+   */
+  inline OSMScoutQtBuilder& WithOfflineTileStoreSize(size_t offlineTileStoreSize){
+    this->offlineTileStoreSize=offlineTileStoreSize;
+    return *this;
+  }
+
+  /**
+   * Number of threads used by tiled renderer for rendering of offline tiles.
+   * Block of loaded tiles is split between these threads.
+   * Zero means QThread::idealThreadCount().
+   */
+  inline OSMScoutQtBuilder& WithOfflineTileRenderingThreads(size_t offlineTileRenderingThreads){
+    this->offlineTileRenderingThreads=offlineTileRenderingThreads;
+    return *this;
+  }
+
   inline OSMScoutQtBuilder& WithUserAgent(QString appName,
                                           QString appVersion){
     this->appName=appName;
@@ -237,9 +259,12 @@ private:
   QString         cacheLocation;
   size_t          onlineTileCacheSize;
   size_t          offlineTileCacheSize;
+  size_t          offlineTileStoreSize;
+  size_t          offlineTileRenderingThreads;
   QString         userAgent;
   std::atomic_int liveBackgroundThreads;
   VoiceManagerRef voiceManager; // created lazy
+  OfflineTileStoreRef offlineTileStore; // created lazy
 
 private:
   OSMScoutQt(SettingsRef settings,
@@ -249,6 +274,8 @@ private:
              QString cacheLocation,
              size_t onlineTileCacheSize,
              size_t offlineTileCacheSize,
+             size_t offlineTileStoreSize,
+             size_t offlineTileRenderingThreads,
              QString userAgent,
              QStringList customPoiTypes);
 
@@ -296,6 +323,7 @@ public:
   SettingsRef GetSettings() const;
   MapManagerRef GetMapManager() const;
   VoiceManagerRef GetVoiceManager();
+  OfflineTileStoreRef GetOfflineTileStore();
 
   LookupModule* MakeLookupModule();
   MapRenderer* MakeMapRenderer(RenderingType type);
@@ -0,0 +1,135 @@
+#ifndef OSMSCOUT_CLIENT_QT_OFFLINETILESTORE_H
+#define OSMSCOUT_CLIENT_QT_OFFLINETILESTORE_H
+
+/*
+ OSMScout - a Qt backend for libosmscout and libosmscout-map
+ Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ */
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include <osmscout/ClientQtImportExport.h>
+
+namespace osmscout {
+
+/**
+ * \ingroup QtAPI
+ *
+ * Key of a tile in OfflineTileStore. Besides the tile coordinates it contains
+ * a hash of all parameters that influence the rendered image (stylesheet,
+ * flags, dpi, fonts...) and an epoch of the rendered databases, so tiles
+ * rendered with different setup are never returned.
+ */
+struct OfflineTileKey
+{
+  uint32_t zoomLevel;
+  uint32_t xtile;
+  uint32_t ytile;
+  uint64_t styleHash;
+  uint64_t databaseEpoch;
+};
+
+bool operator==(const OfflineTileKey &a, const OfflineTileKey &b);
+
+uint qHash(const OfflineTileKey &key);
+
+/**
+ * \ingroup QtAPI
+ *
+ * Second level, persistent store of rendered offline tiles.
+ *
+ * All tiles are stored as PNG images in one container file that is memory
+ * mapped for reading. The container is append-only: records consist of a small
+ * header with the OfflineTileKey followed by the image data. The index
+ * (key to file offset) is rebuilt by scanning the record headers when the
+ * store is opened, a trailing record that was not completely written
+ * (application crash) is dropped. When the container reaches its maximum size,
+ * the oldest tiles are evicted: the container is rewritten with the newest
+ * quarter of its capacity dropped from the front, superseded records are
+ * dropped, too.
+ *
+ * The store is thread safe, one instance is shared by all tiled map renderers
+ * of the application (see OSMScoutQt::GetOfflineTileStore).
+ */
+class OSMSCOUT_CLIENT_QT_API OfflineTileStore
+{
+private:
+  struct Entry
+  {
+    qint64   offset;   //!< Offset of the image data in the container
+    uint32_t size;     //!< Size of the image data
+  };
+
+  struct Record
+  {
+    OfflineTileKey key;
+    Entry          entry;
+  };
+
+private:
+  mutable QMutex                 mutex;
+  QFile                          file;
+  qint64                         maxSize{0};
+  uchar                          *mapped{nullptr};
+  qint64                         mappedSize{0};
+  QHash<OfflineTileKey,Entry>    index;
+
+private:
+  bool Map();
+  void Unmap();
+  bool WriteHeader();
+  bool ReadIndex();
+  void CloseFile();
+  QVector<Record> GetRecordsInFileOrder() const;
+  bool Evict(qint64 requiredSize);
+
+public:
+  OfflineTileStore() = default;
+  OfflineTileStore(const OfflineTileStore&) = delete;
+  virtual ~OfflineTileStore();
+
+  OfflineTileStore& operator=(const OfflineTileStore&) = delete;
+
+  bool Open(const QString &fileName,
+            size_t maxSize);
+  void Close();
+
+  bool IsOpen() const;
+  size_t GetTileCount() const;
+  size_t GetFileSize() const;
+
+  bool Contains(const OfflineTileKey &key) const;
+  bool Get(const OfflineTileKey &key,
+           QImage &image);
+  bool Put(const OfflineTileKey &key,
+           const QImage &image);
+
+  void Clear();
+};
+
+using OfflineTileStoreRef = std::shared_ptr<OfflineTileStore>;
+
+}
+
+#endif /* OSMSCOUT_CLIENT_QT_OFFLINETILESTORE_H */
@@ -23,20 +23,54 @@
 
 #include <QObject>
 #include <QSettings>
+#include <QThreadPool>
 
 #include <osmscout/DataTileCache.h>
 #include <osmscout/DBThread.h>
 #include <osmscout/MapRenderer.h>
+#include <osmscout/OfflineTileStore.h>
 
 #include <osmscout/ClientQtImportExport.h>
 
 #include <atomic>
+#include <functional>
 
 namespace osmscout {
 
 class OSMSCOUT_CLIENT_QT_API TiledMapRenderer : public MapRenderer {
   Q_OBJECT
 
+private:
+  /**
+   * Rectangular block of tiles rendered to one canvas
+   */
+  struct TileBlock
+  {
+    uint32_t xFrom;
+    uint32_t xTo;
+    uint32_t yFrom;
+    uint32_t yTo;
+    QImage   canvas;
+    bool     success;
+  };
+
+  class TileBlockRenderTask : public QRunnable
+  {
+  private:
+    std::function<void()> task;
+
+  public:
+    explicit TileBlockRenderTask(std::function<void()> task):
+      task(std::move(task))
+    {
+    }
+
+    void run() override
+    {
+      task();
+    }
+  };
+
 private:
   QString                       tileCacheDirectory;
 
@@ -56,6 +90,13 @@ private:
   TileCache                     onlineTileCache;
   TileCache                     offlineTileCache;
 
+  // Persistent second level of offlineTileCache, shared by all renderers,
+  // it may be null. Tiles are looked up before rendering them.
+  // Keys of the store are guarded by tileCacheMutex.
+  OfflineTileStoreRef           offlineTileStore;
+  uint64_t                      tileStoreStyleHash{0};
+  uint64_t                      tileStoreDatabaseEpoch{0};
+
   OsmTileDownloader             *tileDownloader;
 
   std::atomic_bool              onlineTilesEnabled;
@@ -75,6 +116,10 @@ private:
 
   QColor                        unknownColor;
 
+  // threads used for rendering of loaded blocks,
+  // with single thread, tiles are rendered by renderer thread directly
+  QThreadPool                   renderingPool;
+
 public slots:
   virtual void Initialize();
   virtual void InvalidateVisualCache();
@@ -96,6 +141,15 @@ private:
 
   DatabaseCoverage databaseCoverageOfTile(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile);
 
+  void updateTileStoreKeys();
+  OfflineTileKey offlineTileKey(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile) const;
+  bool isTileStorable(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile) const;
+  bool loadTileFromStore(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile);
+
+  bool renderTileBlock(const QMap<QString,QMap<osmscout::TileKey,osmscout::TileRef>> &tiles,
+                       const osmscout::MapParameter &parameter,
+                       TileBlock &block);
+
 public:
   TiledMapRenderer(QThread *thread,
                    SettingsRef settings,
@@ -103,7 +157,9 @@ public:
                    QString iconDirectory,
                    QString tileCacheDirectory,
                    size_t onlineTileCacheSize,
-                   size_t offlineTileCacheSize);
+                   size_t offlineTileCacheSize,
+                   OfflineTileStoreRef offlineTileStore=nullptr,
+                   size_t renderingThreads=1);
 
   virtual ~TiledMapRenderer();
 
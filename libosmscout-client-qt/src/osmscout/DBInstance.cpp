@@ -88,8 +88,21 @@ QString StyleError::GetTypeName() const
     }
 }
 
+bool DBInstance::LoadStyleConfig(osmscout::StyleConfig &styleConfig,
+                                 const QString &stylesheetFilename,
+                                 const QString &styleCacheDirectory)
+{
+  if (styleCacheDirectory.isEmpty()) {
+    return styleConfig.Load(stylesheetFilename.toLocal8Bit().data());
+  }
+
+  return styleConfig.LoadCached(stylesheetFilename.toLocal8Bit().data(),
+                                styleCacheDirectory.toLocal8Bit().data());
+}
+
 bool DBInstance::LoadStyle(QString stylesheetFilename,
                            std::unordered_map<std::string,bool> stylesheetFlags,
+                           const QString &styleCacheDirectory,
                            QList<StyleError> &errors)
 {
   QMutexLocker locker(&mutex);
@@ -114,7 +127,9 @@ bool DBInstance::LoadStyle(QString stylesheetFilename,
     newStyleConfig->AddFlag(flag.first,flag.second);
   }
 
-  if (newStyleConfig->Load(stylesheetFilename.toLocal8Bit().data())) {
+  if (LoadStyleConfig(*newStyleConfig,
+                      stylesheetFilename,
+                      styleCacheDirectory)) {
     // Tear down
     qDeleteAll(painterHolder);
     painterHolder.clear();
@@ -18,6 +18,8 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <QDir>
+
 #include <osmscout/MapService.h>
 
 #include <osmscout/DBThread.h>
@@ -35,6 +37,7 @@ namespace osmscout {
 DBThread::DBThread(QThread *backgroundThread,
                    QString basemapLookupDirectory,
                    QString iconDirectory,
+                   QString styleCacheDirectory,
                    SettingsRef settings,
                    MapManagerRef mapManager,
                    const std::vector<std::string> &customPoiTypes)
@@ -46,6 +49,7 @@ DBThread::DBThread(QThread *backgroundThread,
     physicalDpi(-1),
     lock(QReadWriteLock::Recursive),
     iconDirectory(iconDirectory),
+    styleCacheDirectory(styleCacheDirectory),
     daylight(true),
     customPoiTypes(customPoiTypes)
 {
@@ -60,6 +64,12 @@ DBThread::DBThread(QThread *backgroundThread,
   stylesheetFlags=settings->GetStyleSheetFlags();
   osmscout::log.Debug() << "Using stylesheet: " << stylesheetFilename.toStdString();
 
+  if (!styleCacheDirectory.isEmpty() &&
+      !QDir().mkpath(styleCacheDirectory)) {
+    osmscout::log.Warn() << "Cannot create style sheet cache directory " << styleCacheDirectory.toStdString();
+    this->styleCacheDirectory.clear();
+  }
+
   connect(settings.get(), &Settings::MapDPIChange,
           this, &DBThread::onMapDPIChange,
           Qt::QueuedConnection);
@@ -300,7 +310,9 @@ void DBThread::onDatabaseListChanged(QList<QDir> databaseDirectories)
             styleConfig->AddFlag(flag.first,flag.second);
         }
 
-        if (!styleConfig->Load(stylesheetFilename.toLocal8Bit().data())) {
+        if (!DBInstance::LoadStyleConfig(*styleConfig,
+                                         stylesheetFilename,
+                                         styleCacheDirectory)) {
           qWarning() << "Cannot load style sheet '" << stylesheetFilename << "'!";
           styleConfig=nullptr;
         }
@@ -391,7 +403,7 @@ void DBThread::LoadStyle(QString stylesheetFilename,
   bool prevErrs = !styleErrors.isEmpty();
   styleErrors.clear();
   for (auto db: databases){
-    db->LoadStyle(stylesheetFilename+suffix, stylesheetFlags, styleErrors);
+    db->LoadStyle(stylesheetFilename+suffix, stylesheetFlags, styleCacheDirectory, styleErrors);
   }
   if (prevErrs || (!styleErrors.isEmpty())){
     qWarning()<<"Failed to load stylesheet"<<(stylesheetFilename+suffix);
@@ -118,6 +118,8 @@ bool OSMScoutQtBuilder::Init()
                                   cacheLocation,
                                   onlineTileCacheSize,
                                   offlineTileCacheSize,
+                                  offlineTileStoreSize,
+                                  offlineTileRenderingThreads,
                                   userAgent,
                                   customPoiTypes);
                                   
@@ -216,6 +218,8 @@ OSMScoutQt::OSMScoutQt(SettingsRef settings,
                        QString cacheLocation,
                        size_t onlineTileCacheSize,
                        size_t offlineTileCacheSize,
+                       size_t offlineTileStoreSize,
+                       size_t offlineTileRenderingThreads,
                        QString userAgent,
                        QStringList customPoiTypes):
         settings(settings),
@@ -224,6 +228,8 @@ OSMScoutQt::OSMScoutQt(SettingsRef settings,
         cacheLocation(cacheLocation),
         onlineTileCacheSize(onlineTileCacheSize),
         offlineTileCacheSize(offlineTileCacheSize),
+        offlineTileStoreSize(offlineTileStoreSize),
+        offlineTileRenderingThreads(offlineTileRenderingThreads),
         userAgent(userAgent),
         liveBackgroundThreads(0)
 {
@@ -237,6 +243,7 @@ OSMScoutQt::OSMScoutQt(SettingsRef settings,
   dbThread=std::make_shared<DBThread>(thread,
                                       basemapLookupDirectory,
                                       iconDirectory,
+                                      cacheLocation.isEmpty() ? QString() : QDir(cacheLocation).filePath("styles"),
                                       settings,
                                       mapManager,
                                       customPoiTypeVector);
@@ -293,6 +300,20 @@ VoiceManagerRef OSMScoutQt::GetVoiceManager()
   return voiceManager;
 }
 
+OfflineTileStoreRef OSMScoutQt::GetOfflineTileStore()
+{
+  if (!offlineTileStore &&
+      offlineTileStoreSize>0 &&
+      !cacheLocation.isEmpty()){
+    offlineTileStore=std::make_shared<OfflineTileStore>();
+    if (!QDir().mkpath(cacheLocation) ||
+        !offlineTileStore->Open(QDir(cacheLocation).filePath("OfflineTiles.dat"), offlineTileStoreSize)){
+      osmscout::log.Warn() << "Cannot open offline tile store in " << cacheLocation.toStdString();
+    }
+  }
+  return offlineTileStore;
+}
+
 QThread *OSMScoutQt::makeThread(QString name)
 {
   QThread *thread=new QThread();
@@ -358,7 +379,11 @@ MapRenderer* OSMScoutQt::MakeMapRenderer(RenderingType type)
                                      iconDirectory,
                                      cacheLocation,
                                      onlineTileCacheSize,
-                                     offlineTileCacheSize);
+                                     offlineTileCacheSize,
+                                     GetOfflineTileStore(),
+                                     offlineTileRenderingThreads > 0 ?
+                                       offlineTileRenderingThreads :
+                                       (size_t)std::max(1, QThread::idealThreadCount()));
   }else{
     mapRenderer=new PlaneMapRenderer(thread,settings,dbThread,iconDirectory);
   }
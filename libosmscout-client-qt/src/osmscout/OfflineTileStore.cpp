@@ -0,0 +1,437 @@
+/*
+  OSMScout - a Qt backend for libosmscout and libosmscout-map
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+ */
+
+#include <osmscout/OfflineTileStore.h>
+
+#include <QBuffer>
+#include <QDebug>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace osmscout {
+
+static const uint32_t FileMagic=0x4354534f; // "OSTC"
+static const uint32_t FileVersion=1;
+
+struct FileHeader
+{
+  uint32_t magic;
+  uint32_t version;
+};
+
+struct RecordHeader
+{
+  uint32_t zoomLevel;
+  uint32_t xtile;
+  uint32_t ytile;
+  uint32_t size;
+  uint64_t styleHash;
+  uint64_t databaseEpoch;
+};
+
+static_assert(sizeof(FileHeader)==8, "Unexpected padding in FileHeader");
+static_assert(sizeof(RecordHeader)==32, "Unexpected padding in RecordHeader");
+
+bool operator==(const OfflineTileKey &a, const OfflineTileKey &b)
+{
+  return a.zoomLevel==b.zoomLevel &&
+         a.xtile==b.xtile &&
+         a.ytile==b.ytile &&
+         a.styleHash==b.styleHash &&
+         a.databaseEpoch==b.databaseEpoch;
+}
+
+uint qHash(const OfflineTileKey &key)
+{
+  return (key.zoomLevel << 24) ^ (key.xtile << 12) ^ key.ytile ^
+         ::qHash((quint64)key.styleHash) ^ ::qHash((quint64)key.databaseEpoch);
+}
+
+OfflineTileStore::~OfflineTileStore()
+{
+  CloseFile();
+}
+
+bool OfflineTileStore::Map()
+{
+  qint64 size=file.size();
+
+  if (mapped!=nullptr && mappedSize==size) {
+    return true;
+  }
+
+  Unmap();
+
+  if (size==0) {
+    return false;
+  }
+
+  mapped=file.map(0,size);
+
+  if (mapped==nullptr) {
+    qWarning() << "Cannot map tile store" << file.fileName() << ":" << file.errorString();
+    return false;
+  }
+
+  mappedSize=size;
+
+  return true;
+}
+
+void OfflineTileStore::Unmap()
+{
+  if (mapped!=nullptr) {
+    file.unmap(mapped);
+    mapped=nullptr;
+    mappedSize=0;
+  }
+}
+
+bool OfflineTileStore::WriteHeader()
+{
+  FileHeader header={FileMagic, FileVersion};
+
+  Unmap();
+  index.clear();
+
+  if (!file.resize(0) ||
+      !file.seek(0) ||
+      file.write(reinterpret_cast<const char*>(&header),sizeof(header))!=(qint64)sizeof(header) ||
+      !file.flush()) {
+    qWarning() << "Cannot initialize tile store" << file.fileName() << ":" << file.errorString();
+    return false;
+  }
+
+  return true;
+}
+
+bool OfflineTileStore::ReadIndex()
+{
+  index.clear();
+
+  if (!Map()) {
+    return false;
+  }
+
+  FileHeader header;
+
+  if (mappedSize<(qint64)sizeof(header)) {
+    return false;
+  }
+
+  std::memcpy(&header,mapped,sizeof(header));
+
+  if (header.magic!=FileMagic ||
+      header.version!=FileVersion) {
+    return false;
+  }
+
+  qint64 offset=sizeof(FileHeader);
+
+  while (offset+(qint64)sizeof(RecordHeader)<=mappedSize) {
+    RecordHeader record;
+
+    std::memcpy(&record,mapped+offset,sizeof(record));
+
+    qint64 dataOffset=offset+sizeof(RecordHeader);
+
+    if (dataOffset+record.size>mappedSize) {
+      break;
+    }
+
+    // Later records overwrite earlier records with the same key
+    index.insert({record.zoomLevel,
+                  record.xtile,
+                  record.ytile,
+                  record.styleHash,
+                  record.databaseEpoch},
+                 {dataOffset,record.size});
+
+    offset=dataOffset+record.size;
+  }
+
+  if (offset<mappedSize) {
+    qWarning() << "Dropping incomplete record at the end of tile store" << file.fileName();
+    Unmap();
+
+    if (!file.resize(offset)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+QVector<OfflineTileStore::Record> OfflineTileStore::GetRecordsInFileOrder() const
+{
+  QVector<Record> records;
+
+  records.reserve(index.size());
+
+  for (auto it=index.constBegin(); it!=index.constEnd(); ++it) {
+    records.push_back({it.key(),it.value()});
+  }
+
+  std::sort(records.begin(),records.end(),[](const Record &a, const Record &b) {
+    return a.entry.offset<b.entry.offset;
+  });
+
+  return records;
+}
+
+/**
+ * Rewrite the container without the oldest records, so that requiredSize bytes
+ * can be appended and there is some room left for following tiles.
+ * The container is written to a temporary file that replaces the old one,
+ * so a crash while evicting does not leave a broken container.
+ */
+bool OfflineTileStore::Evict(qint64 requiredSize)
+{
+  if (!Map()) {
+    return WriteHeader();
+  }
+
+  QVector<Record> records=GetRecordsInFileOrder();
+  qint64          targetSize=std::max(maxSize/4*3-requiredSize,(qint64)sizeof(FileHeader));
+  qint64          liveSize=sizeof(FileHeader);
+  int             first=0;
+
+  for (const auto &record : records) {
+    liveSize+=sizeof(RecordHeader)+record.entry.size;
+  }
+
+  while (first<records.size() &&
+         liveSize>targetSize) {
+    liveSize-=sizeof(RecordHeader)+records[first].entry.size;
+    first++;
+  }
+
+  QSaveFile  compacted(file.fileName());
+  FileHeader fileHeader={FileMagic, FileVersion};
+
+  if (!compacted.open(QIODevice::WriteOnly) ||
+      compacted.write(reinterpret_cast<const char*>(&fileHeader),sizeof(fileHeader))!=(qint64)sizeof(fileHeader)) {
+    qWarning() << "Cannot evict tiles from store" << file.fileName() << ":" << compacted.errorString();
+    return WriteHeader();
+  }
+
+  for (int i=first; i<records.size(); i++) {
+    const Record &record=records[i];
+    RecordHeader header={record.key.zoomLevel,
+                         record.key.xtile,
+                         record.key.ytile,
+                         record.entry.size,
+                         record.key.styleHash,
+                         record.key.databaseEpoch};
+
+    if (compacted.write(reinterpret_cast<const char*>(&header),sizeof(header))!=(qint64)sizeof(header) ||
+        compacted.write(reinterpret_cast<const char*>(mapped+record.entry.offset),record.entry.size)!=(qint64)record.entry.size) {
+      qWarning() << "Cannot evict tiles from store" << file.fileName() << ":" << compacted.errorString();
+      compacted.cancelWriting();
+      return WriteHeader();
+    }
+  }
+
+  // The old file must not be open (or mapped) while it is replaced
+  QString fileName=file.fileName();
+
+  CloseFile();
+
+  bool committed=compacted.commit();
+
+  file.setFileName(fileName);
+
+  if (!file.open(QIODevice::ReadWrite)) {
+    qWarning() << "Cannot open tile store" << fileName << ":" << file.errorString();
+    return false;
+  }
+
+  if (!committed) {
+    qWarning() << "Cannot evict tiles from store" << fileName << ":" << compacted.errorString();
+    return WriteHeader();
+  }
+
+  return ReadIndex() || WriteHeader();
+}
+
+void OfflineTileStore::CloseFile()
+{
+  Unmap();
+  index.clear();
+
+  if (file.isOpen()) {
+    file.close();
+  }
+}
+
+bool OfflineTileStore::Open(const QString &fileName,
+                            size_t maxSize)
+{
+  QMutexLocker locker(&mutex);
+
+  CloseFile();
+
+  this->maxSize=(qint64)maxSize;
+
+  file.setFileName(fileName);
+
+  if (!file.open(QIODevice::ReadWrite)) {
+    qWarning() << "Cannot open tile store" << fileName << ":" << file.errorString();
+    return false;
+  }
+
+  if (!ReadIndex() &&
+      !WriteHeader()) {
+    CloseFile();
+    return false;
+  }
+
+  return true;
+}
+
+void OfflineTileStore::Close()
+{
+  QMutexLocker locker(&mutex);
+
+  CloseFile();
+}
+
+bool OfflineTileStore::IsOpen() const
+{
+  QMutexLocker locker(&mutex);
+
+  return file.isOpen();
+}
+
+size_t OfflineTileStore::GetTileCount() const
+{
+  QMutexLocker locker(&mutex);
+
+  return (size_t)index.size();
+}
+
+size_t OfflineTileStore::GetFileSize() const
+{
+  QMutexLocker locker(&mutex);
+
+  return file.isOpen() ? (size_t)file.size() : 0;
+}
+
+bool OfflineTileStore::Contains(const OfflineTileKey &key) const
+{
+  QMutexLocker locker(&mutex);
+
+  return index.contains(key);
+}
+
+bool OfflineTileStore::Get(const OfflineTileKey &key,
+                           QImage &image)
+{
+  QMutexLocker locker(&mutex);
+
+  auto entry=index.constFind(key);
+
+  if (entry==index.constEnd()) {
+    return false;
+  }
+
+  // Tiles stored after the last mapping are not visible yet
+  if (entry->offset+entry->size>mappedSize &&
+      !Map()) {
+    return false;
+  }
+
+  if (!image.loadFromData(mapped+entry->offset,(int)entry->size,"PNG")) {
+    qWarning() << "Cannot decode tile from store" << file.fileName();
+    index.remove(key);
+    return false;
+  }
+
+  return true;
+}
+
+bool OfflineTileStore::Put(const OfflineTileKey &key,
+                           const QImage &image)
+{
+  // Encode the image before locking, it is the most expensive part
+  QByteArray record(sizeof(RecordHeader),0);
+  QBuffer    buffer(&record);
+
+  buffer.open(QIODevice::WriteOnly|QIODevice::Append);
+
+  if (!image.save(&buffer,"PNG")) {
+    qWarning() << "Cannot encode tile for store" << file.fileName();
+    return false;
+  }
+
+  buffer.close();
+
+  RecordHeader header={key.zoomLevel,
+                       key.xtile,
+                       key.ytile,
+                       (uint32_t)(record.size()-sizeof(RecordHeader)),
+                       key.styleHash,
+                       key.databaseEpoch};
+
+  std::memcpy(record.data(),&header,sizeof(header));
+
+  QMutexLocker locker(&mutex);
+
+  if (!file.isOpen()) {
+    return false;
+  }
+
+  if (maxSize>0 &&
+      (qint64)(sizeof(FileHeader)+record.size())>maxSize) {
+    return false;
+  }
+
+  if (maxSize>0 &&
+      file.size()+record.size()>maxSize &&
+      !Evict(record.size())) {
+    return false;
+  }
+
+  qint64 offset=file.size();
+
+  // The whole record is written at once, so that a crash leaves at most one
+  // incomplete record at the end of the file
+  if (!file.seek(offset) ||
+      file.write(record)!=record.size() ||
+      !file.flush()) {
+    qWarning() << "Cannot write tile to store" << file.fileName() << ":" << file.errorString();
+    return false;
+  }
+
+  index.insert(key,{offset+(qint64)sizeof(RecordHeader),header.size});
+
+  return true;
+}
+
+void OfflineTileStore::Clear()
+{
+  QMutexLocker locker(&mutex);
+
+  if (file.isOpen()) {
+    WriteHeader();
+  }
+}
+}
@@ -347,6 +347,10 @@ void PlaneMapRenderer::DrawMap()
     drawParameter.SetOptimizeWayNodes(osmscout::TransPolygon::none);
     drawParameter.SetOptimizeAreaNodes(osmscout::TransPolygon::none);
 
+    // keep styled geometry of objects between render calls, panning the map reuses it
+    drawParameter.SetGeometryCacheSize(10000);
+    drawParameter.SetLabelLayoutCacheSize(5000);
+
     drawParameter.SetRenderBackground(false); // we draw background before MapPainter
     drawParameter.SetRenderUnknowns(false); // it is necessary to disable it with multiple databases
     drawParameter.SetRenderSeaLand(renderSea);
@@ -20,6 +20,11 @@
 
 #include <osmscout/TiledMapRenderer.h>
 
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
 #include <osmscout/OSMTile.h>
 #include <osmscout/TiledRenderingHelper.h>
 
@@ -27,17 +32,33 @@
 #include <osmscout/util/Logger.h>
 
 namespace osmscout {
+
+static uint64_t HashToKey(const QCryptographicHash &hash)
+{
+  QByteArray result=hash.result();
+  uint64_t   key=0;
+
+  for (int i=0; i<8 && i<result.size(); i++) {
+    key=(key << 8) | (uint8_t)result[i];
+  }
+
+  return key;
+}
+
 TiledMapRenderer::TiledMapRenderer(QThread *thread,
                                    SettingsRef settings,
                                    DBThreadRef dbThread,
                                    QString iconDirectory,
                                    QString tileCacheDirectory,
                                    size_t onlineTileCacheSize,
-                                   size_t offlineTileCacheSize):
+                                   size_t offlineTileCacheSize,
+                                   OfflineTileStoreRef offlineTileStore,
+                                   size_t renderingThreads):
   MapRenderer(thread,settings,dbThread,iconDirectory),
   tileCacheDirectory(tileCacheDirectory),
   onlineTileCache(onlineTileCacheSize), // online tiles can be loaded from disk cache easily
   offlineTileCache(offlineTileCacheSize), // render offline tile is expensive
+  offlineTileStore(offlineTileStore),
   tileDownloader(nullptr), // it will be created in different thread
   loadJob(nullptr),
   unknownColor(QColor::fromRgbF(1.0,1.0,1.0)) // white
@@ -46,6 +67,10 @@ TiledMapRenderer::TiledMapRenderer(QThread *thread,
   screenWidth=srn->availableSize().width();
   screenHeight=srn->availableSize().height();
 
+  // painters are cached per thread, keep rendering threads alive
+  renderingPool.setMaxThreadCount(std::max(1, (int)renderingThreads));
+  renderingPool.setExpiryTimeout(-1);
+
 
   onlineTilesEnabled = settings->GetOnlineTilesEnabled();
   offlineTilesEnabled = settings->GetOfflineMap();
@@ -151,6 +176,9 @@ void TiledMapRenderer::onStylesheetFilenameChanged()
 
 void TiledMapRenderer::InvalidateVisualCache()
 {
+  // style, render parameters or overlays may be changed
+  updateTileStoreKeys();
+
   // invalidate tile cache and emit Redraw
   {
     QMutexLocker locker(&tileCacheMutex);
@@ -206,8 +234,106 @@ DatabaseCoverage TiledMapRenderer::databaseCoverageOfTile(uint32_t zoomLevel, ui
   return state;
 }
 
+void TiledMapRenderer::updateTileStoreKeys()
+{
+  if (!offlineTileStore){
+    return;
+  }
+
+  // all parameters that affect rendered tile image
+  QCryptographicHash styleHash(QCryptographicHash::Md5);
+  {
+    QMutexLocker locker(&lock);
+    // the stylesheet is identified by its content, a touched or copied
+    // stylesheet does not invalidate the stored tiles
+    QFile stylesheet(dbThread->GetStylesheetFilename());
+    if (stylesheet.open(QIODevice::ReadOnly)){
+      styleHash.addData(&stylesheet);
+    }
+    else {
+      styleHash.addData(stylesheet.fileName().toUtf8());
+    }
+
+    const QMap<QString,bool> flags=dbThread->GetStyleFlags();
+    for (auto it=flags.constBegin(); it!=flags.constEnd(); ++it){
+      styleHash.addData(it.key().toUtf8());
+      styleHash.addData(it.value() ? "1" : "0");
+    }
+
+    styleHash.addData(QByteArray::number(mapDpi));
+    styleHash.addData(renderSea ? "1" : "0");
+    styleHash.addData(fontName.toUtf8());
+    styleHash.addData(QByteArray::number(fontSize));
+    styleHash.addData(showAltLanguage ? "1" : "0");
+    styleHash.addData(units.toUtf8());
+    styleHash.addData(QByteArray::number(std::min(screenWidth, screenHeight)));
+    styleHash.addData(onlineTilesEnabled ? "1" : "0"); // basemap is rendered when online tiles are disabled
+  }
+
+  // databases are identified by its path and modification time
+  QStringList databaseIds;
+  dbThread->RunSynchronousJob(
+    [&databaseIds](const std::list<DBInstanceRef>& databases) {
+      for (auto &db:databases){
+        QFileInfo typesFile(QDir(db->path).filePath("types.dat"));
+        databaseIds << db->path + ":" + QString::number(typesFile.lastModified().toMSecsSinceEpoch());
+      }
+    }
+  );
+  databaseIds.sort();
+
+  QCryptographicHash databaseHash(QCryptographicHash::Md5);
+  for (const auto &id:databaseIds){
+    databaseHash.addData(id.toUtf8());
+  }
+
+  QMutexLocker locker(&tileCacheMutex);
+  tileStoreStyleHash=HashToKey(styleHash);
+  tileStoreDatabaseEpoch=HashToKey(databaseHash);
+}
+
+OfflineTileKey TiledMapRenderer::offlineTileKey(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile) const
+{
+  return {zoomLevel, xtile, ytile, tileStoreStyleHash, tileStoreDatabaseEpoch};
+}
+
+bool TiledMapRenderer::isTileStorable(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile) const
+{
+  // overlay objects are not persistent, tiles with them (including neighbours,
+  // because of labels and line width) are not stored
+  GeoBox tileBox=OSMTile::tileBoundingBox(zoomLevel, xtile, ytile);
+  if (xtile>0 && ytile>0){
+    tileBox.Include(OSMTile::tileBoundingBox(zoomLevel, xtile-1, ytile-1));
+  }
+  tileBox.Include(OSMTile::tileBoundingBox(zoomLevel, xtile+1, ytile+1));
+
+  return !overlayObjectsBox().Intersects(tileBox);
+}
+
+bool TiledMapRenderer::loadTileFromStore(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile)
+{
+  if (!offlineTileStore || !isTileStorable(zoomLevel, xtile, ytile)){
+    return false;
+  }
+
+  QMutexLocker locker(&tileCacheMutex);
+  if (!offlineTileCache.containsRequest(zoomLevel, xtile, ytile)){ // request was canceled
+    return false;
+  }
+
+  QImage image;
+  if (!offlineTileStore->Get(offlineTileKey(zoomLevel, xtile, ytile), image)){
+    return false;
+  }
+
+  offlineTileCache.put(zoomLevel, xtile, ytile, image, offlineTileCache.getEpoch());
+  return true;
+}
+
 void TiledMapRenderer::onDatabaseLoaded(osmscout::GeoBox boundingBox)
 {
+  updateTileStoreKeys();
+
   {
     QMutexLocker locker(&tileCacheMutex);
     onlineTileCache.invalidate(boundingBox);
@@ -249,6 +375,13 @@ void TiledMapRenderer::onlineTileRequest(uint32_t zoomLevel, uint32_t xtile, uin
 
 void TiledMapRenderer::offlineTileRequest(uint32_t zoomLevel, uint32_t xtile, uint32_t ytile)
 {
+    // tile may be rendered already, in previous run of application
+    // or it was evicted from offlineTileCache
+    if (loadTileFromStore(zoomLevel, xtile, ytile)){
+        emit Redraw();
+        return;
+    }
+
     // just start loading
     QMutexLocker locker(&lock);
     if (loadJob!=nullptr){
@@ -389,6 +522,61 @@ void TiledMapRenderer::onOfflineMapChanged(bool b)
     emit Redraw();
 }
 
+bool TiledMapRenderer::renderTileBlock(const QMap<QString,QMap<osmscout::TileKey,osmscout::TileRef>> &tiles,
+                                       const osmscout::MapParameter &parameter,
+                                       TileBlock &block)
+{
+    uint32_t width = (block.xTo - block.xFrom + 1);
+    uint32_t height = (block.yTo - block.yFrom + 1);
+
+    osmscout::GeoCoord tileVisualCenter = OSMTile::tileRelativeCoord(loadZ.Get(),
+            (double)block.xFrom + (double)width/2.0,
+            (double)block.yFrom + (double)height/2.0);
+
+    double osmTileDimension = (double)OSMTile::osmTileOriginalWidth() * (mapDpi / OSMTile::tileDPI() ); // pixels
+
+    block.canvas = QImage((double)width * osmTileDimension,
+                          (double)height * osmTileDimension,
+                          QImage::Format_ARGB32_Premultiplied); // TODO: verify best format with profiler (callgrind)
+
+    QColor transparent = QColor::fromRgbF(1, 1, 1, 0.0);
+    block.canvas.fill(transparent);
+
+    // every block has own copy of parameters, painter may modify them
+    osmscout::MapParameter drawParameter(parameter);
+
+    QPainter p;
+    p.begin(&block.canvas);
+
+    // setup projection for these tiles
+    osmscout::MercatorProjection projection;
+    osmscout::Magnification magnification(loadZ);
+
+    projection.Set(tileVisualCenter, /* angle */ 0, magnification, mapDpi,
+                   block.canvas.width(), block.canvas.height());
+    projection.SetLinearInterpolationUsage(loadZ.Get() >= 10);
+
+    // overlay ways
+    std::vector<OverlayObjectRef> overlayObjects;
+    osmscout::GeoBox renderBox;
+    projection.GetDimensions(renderBox);
+    getOverlayObjects(overlayObjects, renderBox);
+
+    //DrawMap(p, tileVisualCenter, loadZ, canvas.width(), canvas.height());
+    DBRenderJob job(projection,
+                    tiles,
+                    &drawParameter,
+                    &p,
+                    overlayObjects,
+                    /*drawCanvasBackground*/ false,
+                    /*renderBasemap*/ !onlineTilesEnabled);
+    dbThread->RunJob(&job);
+
+    p.end();
+
+    return job.IsSuccess();
+}
+
 void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osmscout::TileRef>> tiles)
 {
     QMutexLocker locker(&lock);
@@ -400,22 +588,8 @@ void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osm
     uint32_t width = (loadXTo - loadXFrom + 1);
     uint32_t height = (loadYTo - loadYFrom + 1);
 
-    osmscout::GeoCoord tileVisualCenter = OSMTile::tileRelativeCoord(loadZ.Get(),
-            (double)loadXFrom + (double)width/2.0,
-            (double)loadYFrom + (double)height/2.0);
-
     double osmTileDimension = (double)OSMTile::osmTileOriginalWidth() * (mapDpi / OSMTile::tileDPI() ); // pixels
 
-    QImage canvas((double)width * osmTileDimension,
-                  (double)height * osmTileDimension,
-                  QImage::Format_ARGB32_Premultiplied); // TODO: verify best format with profiler (callgrind)
-
-    QColor transparent = QColor::fromRgbF(1, 1, 1, 0.0);
-    canvas.fill(transparent);
-
-    QPainter p;
-    p.begin(&canvas);
-
     osmscout::MapParameter        drawParameter;
     std::list<std::string>        paths;
 
@@ -434,6 +608,9 @@ void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osm
     drawParameter.SetOptimizeWayNodes(osmscout::TransPolygon::none);
     drawParameter.SetOptimizeAreaNodes(osmscout::TransPolygon::none);
 
+    // the same labels are layouted for every tile, keep them between render calls
+    drawParameter.SetLabelLayoutCacheSize(5000);
+
     drawParameter.SetRenderBackground(false);
     drawParameter.SetRenderUnknowns(false); // it is necessary to disable it with multiple sources
     drawParameter.SetRenderSeaLand(renderSea);
@@ -456,65 +633,87 @@ void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osm
 
     drawParameter.GetLocaleRef().SetDistanceUnits(units == "imperial" ? osmscout::Units::Imperial : osmscout::Units::Metrics);
 
-    // setup projection for these tiles
-    osmscout::MercatorProjection projection;
-    osmscout::Magnification magnification(loadZ);
-
-    projection.Set(tileVisualCenter, /* angle */ 0, magnification, mapDpi,
-                   canvas.width(), canvas.height());
-    projection.SetLinearInterpolationUsage(loadZ.Get() >= 10);
-
-    // overlay ways
-    std::vector<OverlayObjectRef> overlayObjects;
-    osmscout::GeoBox renderBox;
-    projection.GetDimensions(renderBox);
-    getOverlayObjects(overlayObjects, renderBox);
+    // Loaded area is split to blocks (strips of tiles along the longer side),
+    // every block is rendered to own canvas by own thread from rendering pool.
+    // Each thread is using own MapPainterQt (see DBInstance::GetPainter),
+    // loaded tiles are shared read-only.
+    std::vector<TileBlock> blocks;
+    uint32_t parts = std::min((uint32_t)renderingPool.maxThreadCount(), std::max(width, height));
+    if (parts <= 1){
+        blocks.push_back({loadXFrom, loadXTo, loadYFrom, loadYTo, QImage(), false});
+    } else if (width >= height){
+        for (uint32_t i = 0; i < parts; ++i){
+            blocks.push_back({loadXFrom + (width * i) / parts,
+                              loadXFrom + (width * (i + 1)) / parts - 1,
+                              loadYFrom, loadYTo, QImage(), false});
+        }
+    } else {
+        for (uint32_t i = 0; i < parts; ++i){
+            blocks.push_back({loadXFrom, loadXTo,
+                              loadYFrom + (height * i) / parts,
+                              loadYFrom + (height * (i + 1)) / parts - 1,
+                              QImage(), false});
+        }
+    }
 
-    //DrawMap(p, tileVisualCenter, loadZ, canvas.width(), canvas.height());
-    bool success;
-    {
-      DBRenderJob job(projection,
-                      tiles,
-                      &drawParameter,
-                      &p,
-                      overlayObjects,
-                      /*drawCanvasBackground*/ false,
-                      /*renderBasemap*/ !onlineTilesEnabled);
-      dbThread->RunJob(&job);
-      success=job.IsSuccess();
+    if (blocks.size() == 1){
+        blocks.front().success = renderTileBlock(tiles, drawParameter, blocks.front());
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+        for (auto &block : blocks){
+            renderingPool.start(new TileBlockRenderTask([this, &tiles, &drawParameter, &block](){
+                block.success = renderTileBlock(tiles, drawParameter, block);
+            }));
+        }
+        renderingPool.waitForDone();
+        osmscout::log.Debug() << "Rendered " << width << "x" << height << " tiles in "
+                              << blocks.size() << " blocks, " << timer.elapsed() << " ms";
     }
 
     // this slot is called from DBLoadJob, we can't delete it now
     loadJob->deleteLater();
     loadJob=nullptr;
 
-    if (!success)  {
-      osmscout::log.Error() << "*** Rendering of data has error or was interrupted";
-      return;
+    for (const auto &block : blocks){
+        if (!block.success)  {
+            osmscout::log.Error() << "*** Rendering of data has error or was interrupted";
+            return;
+        }
     }
 
-    p.end();
-
+    // tiles for persistent store, it is filled after Redraw, encoding takes some time
+    std::vector<std::pair<OfflineTileKey,QImage>> storeTiles;
     {
         QMutexLocker locker(&tileCacheMutex);
 
-        if (loadEpoch != offlineTileCache.getEpoch()){
+        bool outdated = loadEpoch != offlineTileCache.getEpoch();
+        if (outdated){
           qWarning() << "Rendered from outdated data" << loadEpoch << "!=" << offlineTileCache.getEpoch();
         }
 
-        if (width == 1 && height == 1){
-            offlineTileCache.put(loadZ.Get(), loadXFrom, loadYFrom, canvas, loadEpoch);
-        }else{
-            for (uint32_t y = loadYFrom; y <= loadYTo; ++y){
-                for (uint32_t x = loadXFrom; x <= loadXTo; ++x){
+        for (const auto &block : blocks){
+            if (block.xFrom == block.xTo && block.yFrom == block.yTo){
+                offlineTileCache.put(loadZ.Get(), block.xFrom, block.yFrom, block.canvas, loadEpoch);
+                if (offlineTileStore && !outdated){
+                    storeTiles.emplace_back(offlineTileKey(loadZ.Get(), block.xFrom, block.yFrom), block.canvas);
+                }
+                continue;
+            }
+
+            for (uint32_t y = block.yFrom; y <= block.yTo; ++y){
+                for (uint32_t x = block.xFrom; x <= block.xTo; ++x){
 
-                    QImage tile = canvas.copy(
-                            (double)(x - loadXFrom) * osmTileDimension,
-                            (double)(y - loadYFrom) * osmTileDimension,
+                    QImage tile = block.canvas.copy(
+                            (double)(x - block.xFrom) * osmTileDimension,
+                            (double)(y - block.yFrom) * osmTileDimension,
                             osmTileDimension, osmTileDimension
                             );
 
                     offlineTileCache.put(loadZ.Get(), x, y, tile, loadEpoch);
+                    if (offlineTileStore && !outdated){
+                        storeTiles.emplace_back(offlineTileKey(loadZ.Get(), x, y), tile);
+                    }
                 }
             }
         }
@@ -525,6 +724,12 @@ void TiledMapRenderer::onLoadJobFinished(QMap<QString,QMap<osmscout::TileKey,osm
     }
 
     emit Redraw();
+
+    for (const auto &entry:storeTiles){
+        if (isTileStorable(entry.first.zoomLevel, entry.first.xtile, entry.first.ytile)){
+            offlineTileStore->Put(entry.first, entry.second);
+        }
+    }
     //std::cout << "  put offline: " << loadZ << " xtile: " << xtile << " ytile: " << ytile << std::endl;
 }
 }
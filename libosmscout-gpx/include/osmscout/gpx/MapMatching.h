@@ -0,0 +1,61 @@
+#ifndef OSMSCOUT_GPX_MAPMATCHING_H
+#define OSMSCOUT_GPX_MAPMATCHING_H
+
+/*
+  This source is part of the libosmscout-gpx library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <osmscout/gpx/GPXImportExport.h>
+#include <osmscout/gpx/Track.h>
+
+#include <osmscout/routing/MapMatchingService.h>
+
+#include <vector>
+
+namespace osmscout {
+namespace gpx {
+
+/**
+ * Coordinates of all points of the track, segments are concatenated.
+ * The matching splits the result on its own if consecutive points
+ * cannot be connected.
+ */
+extern OSMSCOUT_GPX_API std::vector<GeoCoord> TrackToTrace(const Track &track);
+
+/**
+ * Match the track to the ways routable by the given profile.
+ * MapMatchingResult::points has one entry for each point of the track,
+ * in the order of TrackToTrace.
+ */
+extern OSMSCOUT_GPX_API MapMatchingResult MatchTrack(MapMatchingService &service,
+                                                     const RoutingProfile &profile,
+                                                     const Track &track,
+                                                     const BreakerRef &breaker=nullptr);
+
+/**
+ * Match a batch of tracks in parallel, see MapMatchingService::Match.
+ */
+extern OSMSCOUT_GPX_API std::vector<MapMatchingResult> MatchTracks(MapMatchingService &service,
+                                                                   const RoutingProfile &profile,
+                                                                   const std::vector<Track> &tracks,
+                                                                   const BreakerRef &breaker=nullptr);
+}
+}
+
+#endif //OSMSCOUT_GPX_MAPMATCHING_H
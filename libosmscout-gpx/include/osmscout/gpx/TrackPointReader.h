@@ -0,0 +1,203 @@
+#ifndef OSMSCOUT_GPX_TRACKPOINTREADER_H
+#define OSMSCOUT_GPX_TRACKPOINTREADER_H
+
+/*
+  This source is part of the libosmscout-gpx library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/gpx/TrackPoint.h>
+#include <osmscout/gpx/Utils.h>
+#include <osmscout/gpx/GPXImportExport.h>
+
+#include <osmscout/util/Breaker.h>
+#include <osmscout/util/File.h>
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace osmscout {
+namespace gpx {
+
+/**
+ * Pull based reader of track points (trkpt) of a gpx file.
+ *
+ * In contrast to ImportGpx, the file is not materialized into a GpxFile,
+ * points are returned one by one and memory usage does not depend on file
+ * size. The reader uses its own tokenizer for the subset of XML used by gpx
+ * files (elements, attributes, character data, CDATA, comments, processing
+ * instructions and predefined/numeric entities), DTDs are not supported.
+ * Waypoints and routes are skipped.
+ *
+ * Usage:
+ *
+ * ```
+ * TrackPointReader reader(filePath);
+ * TrackPoint       point(GeoCoord(0,0));
+ *
+ * while (reader.Next(point)) {
+ *   // process point
+ * }
+ *
+ * if (reader.HasError()) {
+ *   // handle error
+ * }
+ * ```
+ */
+class OSMSCOUT_GPX_API TrackPointReader
+{
+private:
+  enum class Token
+  {
+    StartElement,
+    EndElement,
+    Text,
+    End,
+    Error
+  };
+
+  enum class Capture
+  {
+    None,
+    Elevation,
+    Time,
+    Course,
+    HDop,
+    VDop,
+    PDop,
+    TrackName
+  };
+
+  struct Attribute
+  {
+    std::string name;
+    std::string value;
+  };
+
+private:
+  std::FILE                  *file=nullptr;
+  FileOffset                 fileSize=0;
+  FileOffset                 fileOffset=0;  //!< Number of bytes read from file
+  BreakerRef                 breaker;
+  ProcessCallbackRef         callback;
+
+  std::vector<char>          buffer;
+  size_t                     bufferPos=0;
+  size_t                     bufferEnd=0;
+  bool                       eof=false;
+  bool                       error=false;
+
+  // current token
+  std::string                tokenName;
+  std::vector<Attribute>     tokenAttributes;
+  size_t                     tokenAttributeCount=0;
+  bool                       tokenSelfClosing=false;
+  std::string                tokenText;
+  std::string                tagBuffer;
+
+  // document state
+  std::vector<std::string>   elements;      //!< Stack of open elements (local names)
+  size_t                     elementCount=0; //!< Depth of the stack, elements may contain unused entries
+  bool                       inPoint=false;
+  size_t                     pointDepth=0;
+  TrackPoint                 current{GeoCoord()};
+  Capture                    capture=Capture::None;
+  size_t                     captureDepth=0;
+  std::string                captureValue;
+
+  size_t                     trackCount=0;
+  size_t                     segmentCount=0;
+  std::optional<std::string> trackName;
+
+private:
+  bool Fill();
+  bool Ensure(size_t count);
+  bool SkipUntil(const char *terminator);
+  bool ReadText();
+  bool ReadCData();
+  bool ReadTag();
+  bool ParseTag();
+  Token NextToken();
+
+  const std::string* GetAttribute(const char *name) const;
+  void StartElement();
+  bool EndElement(TrackPoint &point);
+  void ApplyCapture();
+
+  void Error(const std::string &message);
+
+public:
+  explicit TrackPointReader(const std::string &filePath,
+                            BreakerRef breaker=nullptr,
+                            ProcessCallbackRef callback=std::make_shared<ProcessCallback>());
+  TrackPointReader(const TrackPointReader&) = delete;
+  virtual ~TrackPointReader();
+
+  TrackPointReader& operator=(const TrackPointReader&) = delete;
+
+  inline bool IsOpen() const
+  {
+    return file!=nullptr;
+  }
+
+  /**
+   * Reads next track point
+   *
+   * @param point
+   *    assigned on success
+   * @return
+   *    false when there are no more points or on error, see HasError
+   */
+  bool Next(TrackPoint &point);
+
+  inline bool HasError() const
+  {
+    return error;
+  }
+
+  /**
+   * @return zero based index of the track (trk) of the last returned point
+   */
+  inline size_t GetTrackIndex() const
+  {
+    return trackCount>0 ? trackCount-1 : 0;
+  }
+
+  /**
+   * @return zero based index of the segment (trkseg) of the last returned point,
+   *   segments are numbered through the whole file, not per track
+   */
+  inline size_t GetSegmentIndex() const
+  {
+    return segmentCount>0 ? segmentCount-1 : 0;
+  }
+
+  /**
+   * @return name of the track of the last returned point, if it precedes its segments
+   */
+  inline const std::optional<std::string>& GetTrackName() const
+  {
+    return trackName;
+  }
+};
+
+}
+}
+
+#endif //OSMSCOUT_GPX_TRACKPOINTREADER_H
@@ -0,0 +1,109 @@
+#ifndef OSMSCOUT_GPX_TRACKPOINTWRITER_H
+#define OSMSCOUT_GPX_TRACKPOINTWRITER_H
+
+/*
+  This source is part of the libosmscout-gpx library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/gpx/TrackPoint.h>
+#include <osmscout/gpx/Utils.h>
+#include <osmscout/gpx/GPXImportExport.h>
+
+#include <osmscout/util/Breaker.h>
+
+#include <cstdio>
+#include <optional>
+#include <string>
+
+namespace osmscout {
+namespace gpx {
+
+/**
+ * Streaming writer of gpx tracks, counterpart of TrackPointReader.
+ *
+ * Points are written as they come, the writer keeps just a small output
+ * buffer. The output has the same layout as the one produced by ExportGpx,
+ * numbers are formatted independently of the current locale.
+ *
+ * StartSegment without open track starts a new (unnamed) track, WritePoint
+ * without open segment starts a new segment.
+ */
+class OSMSCOUT_GPX_API TrackPointWriter
+{
+private:
+  std::FILE          *file=nullptr;
+  BreakerRef         breaker;
+  ProcessCallbackRef callback;
+
+  std::string        buffer;
+  bool               error=false;
+  bool               inTrack=false;
+  bool               inSegment=false;
+
+private:
+  void Write(const char *text);
+  void Write(const std::string &text);
+  void WriteEscaped(const std::string &text);
+  void WriteFixed(double value, int precision);
+  void WriteTextElement(const char *indent,
+                        const char *name,
+                        double value,
+                        int precision);
+  bool Flush();
+
+  void EndSegment();
+  void EndTrack();
+
+  void Error(const std::string &message);
+
+public:
+  explicit TrackPointWriter(const std::string &filePath,
+                            BreakerRef breaker=nullptr,
+                            ProcessCallbackRef callback=std::make_shared<ProcessCallback>());
+  TrackPointWriter(const TrackPointWriter&) = delete;
+  virtual ~TrackPointWriter();
+
+  TrackPointWriter& operator=(const TrackPointWriter&) = delete;
+
+  inline bool IsOpen() const
+  {
+    return file!=nullptr;
+  }
+
+  inline bool HasError() const
+  {
+    return error;
+  }
+
+  bool StartTrack(const std::optional<std::string> &name=std::nullopt);
+  bool StartSegment();
+  bool WritePoint(const TrackPoint &point);
+
+  /**
+   * Closes all open elements and the file. Called by the destructor,
+   * call it explicitly to get the result.
+   *
+   * @return true if the whole file was written successfully
+   */
+  bool Close();
+};
+
+}
+}
+
+#endif //OSMSCOUT_GPX_TRACKPOINTWRITER_H
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace osmscout {
@@ -48,6 +49,47 @@ public:
 
 typedef std::shared_ptr<ProcessCallback> ProcessCallbackRef;
 
+/**
+ * Filter out following points that are not distant more than minDistance
+ * from the last accepted point. Point by point variant of FilterNearPoints,
+ * usable as stage of streaming pipeline (see TrackPointReader and TrackPointWriter).
+ */
+class OSMSCOUT_GPX_API NearPointFilter {
+private:
+  Distance                minDistance;
+  std::optional<GeoCoord> latest;
+
+public:
+  explicit NearPointFilter(const Distance &minDistance=Meters(0));
+
+  /**
+   * @return true if point should be kept
+   */
+  bool Accept(const TrackPoint &point);
+
+  /**
+   * Forget last accepted point, should be called at start of new segment
+   */
+  void Reset();
+};
+
+/**
+ * Filter out points with horizontal dilution (or position dilution if horizontal is not presented)
+ * bigger than maxDilution value. Point by point variant of FilterInaccuratePoints.
+ */
+class OSMSCOUT_GPX_API InaccuratePointFilter {
+private:
+  double maxDilution;
+
+public:
+  explicit InaccuratePointFilter(double maxDilution=30);
+
+  /**
+   * @return true if point should be kept
+   */
+  bool Accept(const TrackPoint &point) const;
+};
+
 /**
  * Filter out following points that are not distant more than minDistance.
  * For minDistance == 0 it just remove points with same coordinates.
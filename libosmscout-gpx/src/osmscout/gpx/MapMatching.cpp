@@ -0,0 +1,62 @@
+/*
+  This source is part of the libosmscout-gpx library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/gpx/MapMatching.h>
+
+using namespace osmscout;
+using namespace osmscout::gpx;
+
+std::vector<GeoCoord> gpx::TrackToTrace(const Track &track)
+{
+  std::vector<GeoCoord> trace;
+
+  trace.reserve(track.GetPointCount());
+
+  for (const auto &segment : track.segments) {
+    for (const auto &point : segment.points) {
+      trace.push_back(point.coord);
+    }
+  }
+
+  return trace;
+}
+
+MapMatchingResult gpx::MatchTrack(MapMatchingService &service,
+                                  const RoutingProfile &profile,
+                                  const Track &track,
+                                  const BreakerRef &breaker)
+{
+  return service.Match(profile,TrackToTrace(track),breaker);
+}
+
+std::vector<MapMatchingResult> gpx::MatchTracks(MapMatchingService &service,
+                                                const RoutingProfile &profile,
+                                                const std::vector<Track> &tracks,
+                                                const BreakerRef &breaker)
+{
+  std::vector<std::vector<GeoCoord>> traces;
+
+  traces.reserve(tracks.size());
+
+  for (const auto &track : tracks) {
+    traces.push_back(TrackToTrace(track));
+  }
+
+  return service.Match(profile,traces,breaker);
+}
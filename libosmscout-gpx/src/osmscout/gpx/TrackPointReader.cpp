@@ -0,0 +1,927 @@
+/*
+  This source is part of the libosmscout-gpx library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/gpx/TrackPointReader.h>
+
+#include <osmscout/util/Exception.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/String.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace osmscout;
+using namespace osmscout::gpx;
+
+static const size_t BlockSize=64*1024;
+
+static inline bool IsSpace(char c)
+{
+  return c==' ' || c=='\t' || c=='\n' || c=='\r';
+}
+
+static inline bool IsDigit(char c)
+{
+  return c>='0' && c<='9';
+}
+
+static void Trim(std::string &value)
+{
+  size_t start=0;
+  while (start<value.length() && IsSpace(value[start])) {
+    start++;
+  }
+
+  size_t end=value.length();
+  while (end>start && IsSpace(value[end-1])) {
+    end--;
+  }
+
+  if (start>0 || end<value.length()) {
+    value=value.substr(start,end-start);
+  }
+}
+
+static void AppendUTF8(std::string &output, uint32_t c)
+{
+  if (c<0x80) {
+    output.push_back((char)c);
+  }
+  else if (c<0x800) {
+    output.push_back((char)(0xc0 | (c >> 6)));
+    output.push_back((char)(0x80 | (c & 0x3f)));
+  }
+  else if (c<0x10000) {
+    output.push_back((char)(0xe0 | (c >> 12)));
+    output.push_back((char)(0x80 | ((c >> 6) & 0x3f)));
+    output.push_back((char)(0x80 | (c & 0x3f)));
+  }
+  else {
+    output.push_back((char)(0xf0 | (c >> 18)));
+    output.push_back((char)(0x80 | ((c >> 12) & 0x3f)));
+    output.push_back((char)(0x80 | ((c >> 6) & 0x3f)));
+    output.push_back((char)(0x80 | (c & 0x3f)));
+  }
+}
+
+/**
+ * Replace predefined and numeric character references, unknown references
+ * are kept as they are.
+ */
+static void DecodeEntities(std::string &value)
+{
+  if (value.find('&')==std::string::npos) {
+    return;
+  }
+
+  std::string result;
+
+  result.reserve(value.length());
+
+  size_t pos=0;
+  while (pos<value.length()) {
+    if (value[pos]!='&') {
+      result.push_back(value[pos]);
+      pos++;
+      continue;
+    }
+
+    size_t end=value.find(';',pos);
+    if (end==std::string::npos) {
+      result.append(value,pos,std::string::npos);
+      break;
+    }
+
+    std::string entity=value.substr(pos+1,end-pos-1);
+
+    if (entity=="lt") {
+      result.push_back('<');
+    }
+    else if (entity=="gt") {
+      result.push_back('>');
+    }
+    else if (entity=="amp") {
+      result.push_back('&');
+    }
+    else if (entity=="quot") {
+      result.push_back('"');
+    }
+    else if (entity=="apos") {
+      result.push_back('\'');
+    }
+    else if (entity.length()>1 && entity[0]=='#') {
+      uint32_t code;
+      bool     valid=entity[1]=='x' ?
+                     StringToNumber(entity.substr(2),code,16) :
+                     StringToNumber(entity.substr(1),code);
+
+      if (valid && code<=0x10ffff) {
+        AppendUTF8(result,code);
+      }
+      else {
+        result.append(value,pos,end-pos+1);
+      }
+    }
+    else {
+      result.append(value,pos,end-pos+1);
+    }
+
+    pos=end+1;
+  }
+
+  value=std::move(result);
+}
+
+/**
+ * Parsing of simple decimal numbers (as used in gpx files) without
+ * exponent and with up to 15 significant digits is exact using just
+ * integer arithmetic and one division. Everything else is delegated
+ * to StringToNumber.
+ */
+static bool ParseDouble(const std::string &value,
+                        double &result)
+{
+  static const double powersOf10[]={1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  const char *c=value.c_str();
+  bool       negative=false;
+  uint64_t   mantissa=0;
+  int        significantDigits=0;
+  int        fractionDigits=0;
+  bool       anyDigit=false;
+
+  if (*c=='-') {
+    negative=true;
+    c++;
+  }
+  else if (*c=='+') {
+    c++;
+  }
+
+  while (IsDigit(*c)) {
+    mantissa=mantissa*10+(*c-'0');
+    if (mantissa>0) {
+      significantDigits++;
+    }
+    anyDigit=true;
+    c++;
+
+    if (significantDigits>15) {
+      return StringToNumber(value,result);
+    }
+  }
+
+  if (*c=='.') {
+    c++;
+
+    while (IsDigit(*c)) {
+      mantissa=mantissa*10+(*c-'0');
+      if (mantissa>0) {
+        significantDigits++;
+      }
+      fractionDigits++;
+      anyDigit=true;
+      c++;
+
+      if (significantDigits>15 ||
+          fractionDigits>22) {
+        return StringToNumber(value,result);
+      }
+    }
+  }
+
+  if (!anyDigit) {
+    return false;
+  }
+
+  if (*c!='\0') {
+    // exponent or garbage
+    return StringToNumber(value,result);
+  }
+
+  result=(double)mantissa/powersOf10[fractionDigits];
+
+  if (negative) {
+    result=-result;
+  }
+
+  return true;
+}
+
+static inline bool ParseDigits(const char *c,
+                               size_t count,
+                               int &value)
+{
+  value=0;
+
+  for (size_t i=0; i<count; i++) {
+    if (!IsDigit(c[i])) {
+      return false;
+    }
+
+    value=value*10+(c[i]-'0');
+  }
+
+  return true;
+}
+
+/**
+ * Fast path for the canonical UTC form "YYYY-MM-DDTHH:MM:SS[.mmm]Z" written
+ * by gpx exporters, that avoids sscanf and mktime (which is several times more
+ * expensive than the rest of the point parsing). Everything else is delegated
+ * to ParseISO8601TimeString.
+ */
+static bool ParseTime(const std::string &value,
+                      Timestamp &timestamp)
+{
+  const char *c=value.c_str();
+  int        year,month,day,hour,minute,second;
+  int        millisecond=0;
+
+  if ((value.length()!=20 && value.length()!=24) ||
+      c[4]!='-' || c[7]!='-' || c[10]!='T' || c[13]!=':' || c[16]!=':' ||
+      c[value.length()-1]!='Z' ||
+      (value.length()==24 && (c[19]!='.' || !ParseDigits(c+20,3,millisecond))) ||
+      !ParseDigits(c,4,year) ||
+      !ParseDigits(c+5,2,month) ||
+      !ParseDigits(c+8,2,day) ||
+      !ParseDigits(c+11,2,hour) ||
+      !ParseDigits(c+14,2,minute) ||
+      !ParseDigits(c+17,2,second) ||
+      month<1 || month>12) {
+    return ParseISO8601TimeString(value,timestamp);
+  }
+
+  // days since epoch of the proleptic gregorian calendar,
+  // see http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+  int      y=month<=2 ? year-1 : year;
+  int      era=(y>=0 ? y : y-399)/400;
+  int      yearOfEra=y-era*400;
+  int      dayOfYear=(153*(month>2 ? month-3 : month+9)+2)/5+day-1;
+  int      dayOfEra=yearOfEra*365+yearOfEra/4-yearOfEra/100+dayOfYear;
+  int64_t  days=(int64_t)era*146097+dayOfEra-719468;
+
+  std::chrono::milliseconds sinceEpoch(((days*24+hour)*60+minute)*60000+
+                                       (int64_t)second*1000+
+                                       millisecond);
+
+  timestamp=Timestamp(std::chrono::duration_cast<Timestamp::duration>(sinceEpoch));
+
+  return true;
+}
+
+TrackPointReader::TrackPointReader(const std::string &filePath,
+                                   BreakerRef breaker,
+                                   ProcessCallbackRef callback):
+  breaker(breaker),
+  callback(callback)
+{
+  try {
+    fileSize=GetFileSize(filePath);
+  }
+  catch (const IOException &e) {
+    if (callback) {
+      callback->Error("Can't get file size: " + e.GetErrorMsg());
+    }
+  }
+
+  file=std::fopen(filePath.c_str(),"rb");
+
+  if (file==nullptr) {
+    Error("Can't open file " + filePath);
+  }
+
+  buffer.resize(BlockSize);
+}
+
+TrackPointReader::~TrackPointReader()
+{
+  if (file!=nullptr) {
+    std::fclose(file);
+  }
+}
+
+void TrackPointReader::Error(const std::string &message)
+{
+  error=true;
+
+  if (callback) {
+    callback->Error(message);
+  }
+}
+
+bool TrackPointReader::Fill()
+{
+  if (eof || error || file==nullptr) {
+    return false;
+  }
+
+  if (bufferPos>0) {
+    std::memmove(buffer.data(),
+                 buffer.data()+bufferPos,
+                 bufferEnd-bufferPos);
+    bufferEnd-=bufferPos;
+    bufferPos=0;
+  }
+
+  if (bufferEnd==buffer.size()) {
+    buffer.resize(buffer.size()*2);
+  }
+
+  size_t res=std::fread(buffer.data()+bufferEnd,
+                        1,
+                        buffer.size()-bufferEnd,
+                        file);
+
+  if (res==0) {
+    eof=true;
+
+    if (std::ferror(file)!=0) {
+      Error("Error while reading file");
+    }
+
+    return false;
+  }
+
+  bufferEnd+=res;
+  fileOffset+=res;
+
+  if (breaker && breaker->IsAborted()) {
+    Error("aborted");
+    return false;
+  }
+
+  if (callback && fileSize>0) {
+    callback->Progress(std::min(1.0, ((double) fileOffset) / ((double) fileSize)));
+  }
+
+  return true;
+}
+
+bool TrackPointReader::Ensure(size_t count)
+{
+  while (bufferEnd-bufferPos<count) {
+    if (!Fill()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool TrackPointReader::SkipUntil(const char *terminator)
+{
+  size_t length=std::strlen(terminator);
+
+  while (true) {
+    const char *begin=buffer.data()+bufferPos;
+    const char *end=buffer.data()+bufferEnd;
+    const char *found=std::search(begin,end,terminator,terminator+length);
+
+    if (found!=end) {
+      bufferPos=(found-buffer.data())+length;
+      return true;
+    }
+
+    // keep possible prefix of the terminator
+    if (bufferEnd-bufferPos>=length) {
+      bufferPos=bufferEnd-(length-1);
+    }
+
+    if (!Fill()) {
+      return false;
+    }
+  }
+}
+
+bool TrackPointReader::ReadText()
+{
+  bool keep=capture!=Capture::None && elementCount==captureDepth;
+
+  tokenText.clear();
+
+  while (true) {
+    const char *begin=buffer.data()+bufferPos;
+    const char *found=static_cast<const char*>(std::memchr(begin,'<',bufferEnd-bufferPos));
+
+    if (found!=nullptr) {
+      if (keep) {
+        tokenText.append(begin,found-begin);
+      }
+      bufferPos=found-buffer.data();
+      break;
+    }
+
+    if (keep) {
+      tokenText.append(begin,bufferEnd-bufferPos);
+    }
+    bufferPos=bufferEnd;
+
+    if (!Fill()) {
+      break;
+    }
+  }
+
+  if (keep) {
+    DecodeEntities(tokenText);
+  }
+
+  return keep;
+}
+
+bool TrackPointReader::ReadCData()
+{
+  bool keep=capture!=Capture::None && elementCount==captureDepth;
+
+  tokenText.clear();
+
+  while (true) {
+    const char *begin=buffer.data()+bufferPos;
+    const char *end=buffer.data()+bufferEnd;
+    const char *found=std::search(begin,end,"]]>",((const char*)"]]>")+3);
+
+    if (found!=end) {
+      if (keep) {
+        tokenText.append(begin,found-begin);
+      }
+      bufferPos=(found-buffer.data())+3;
+      return true;
+    }
+
+    // keep possible prefix of the terminator
+    if (bufferEnd-bufferPos>=3) {
+      if (keep) {
+        tokenText.append(begin,bufferEnd-bufferPos-2);
+      }
+      bufferPos=bufferEnd-2;
+    }
+
+    if (!Fill()) {
+      return false;
+    }
+  }
+}
+
+bool TrackPointReader::ReadTag()
+{
+  char quote=0;
+
+  tagBuffer.clear();
+
+  while (true) {
+    size_t pos=bufferPos;
+
+    while (pos<bufferEnd) {
+      char c=buffer[pos];
+
+      if (quote!=0) {
+        if (c==quote) {
+          quote=0;
+        }
+      }
+      else if (c=='"' || c=='\'') {
+        quote=c;
+      }
+      else if (c=='>') {
+        tagBuffer.append(buffer.data()+bufferPos,pos-bufferPos);
+        bufferPos=pos+1;
+        return true;
+      }
+
+      pos++;
+    }
+
+    tagBuffer.append(buffer.data()+bufferPos,bufferEnd-bufferPos);
+    bufferPos=bufferEnd;
+
+    if (!Fill()) {
+      return false;
+    }
+  }
+}
+
+bool TrackPointReader::ParseTag()
+{
+  size_t pos=0;
+  size_t end=tagBuffer.length();
+  bool   endTag=false;
+
+  tokenAttributeCount=0;
+  tokenSelfClosing=false;
+
+  if (pos<end && tagBuffer[pos]=='/') {
+    endTag=true;
+    pos++;
+  }
+
+  while (end>pos && IsSpace(tagBuffer[end-1])) {
+    end--;
+  }
+
+  if (!endTag && end>pos && tagBuffer[end-1]=='/') {
+    tokenSelfClosing=true;
+    end--;
+  }
+
+  // element name, namespace prefix is ignored
+  size_t nameStart=pos;
+  while (pos<end && !IsSpace(tagBuffer[pos])) {
+    if (tagBuffer[pos]==':') {
+      nameStart=pos+1;
+    }
+    pos++;
+  }
+
+  if (nameStart==pos) {
+    return false;
+  }
+
+  tokenName.assign(tagBuffer,nameStart,pos-nameStart);
+
+  if (endTag) {
+    return true;
+  }
+
+  // attributes
+  while (true) {
+    while (pos<end && IsSpace(tagBuffer[pos])) {
+      pos++;
+    }
+
+    if (pos==end) {
+      return true;
+    }
+
+    size_t attrNameStart=pos;
+    while (pos<end && tagBuffer[pos]!='=' && !IsSpace(tagBuffer[pos])) {
+      pos++;
+    }
+    size_t attrNameEnd=pos;
+
+    while (pos<end && IsSpace(tagBuffer[pos])) {
+      pos++;
+    }
+
+    if (pos==end || tagBuffer[pos]!='=' || attrNameStart==attrNameEnd) {
+      return false;
+    }
+
+    pos++;
+
+    while (pos<end && IsSpace(tagBuffer[pos])) {
+      pos++;
+    }
+
+    if (pos==end || (tagBuffer[pos]!='"' && tagBuffer[pos]!='\'')) {
+      return false;
+    }
+
+    char   quote=tagBuffer[pos];
+    size_t valueStart=pos+1;
+    size_t valueEnd=tagBuffer.find(quote,valueStart);
+
+    if (valueEnd==std::string::npos || valueEnd>=end) {
+      return false;
+    }
+
+    if (tokenAttributeCount==tokenAttributes.size()) {
+      tokenAttributes.emplace_back();
+    }
+
+    Attribute &attribute=tokenAttributes[tokenAttributeCount];
+
+    attribute.name.assign(tagBuffer,attrNameStart,attrNameEnd-attrNameStart);
+    attribute.value.assign(tagBuffer,valueStart,valueEnd-valueStart);
+    DecodeEntities(attribute.value);
+
+    tokenAttributeCount++;
+    pos=valueEnd+1;
+  }
+}
+
+TrackPointReader::Token TrackPointReader::NextToken()
+{
+  while (true) {
+    if (bufferPos==bufferEnd &&
+        !Fill()) {
+      return error ? Token::Error : Token::End;
+    }
+
+    if (buffer[bufferPos]!='<') {
+      if (ReadText()) {
+        return Token::Text;
+      }
+
+      if (error) {
+        return Token::Error;
+      }
+
+      continue;
+    }
+
+    if (!Ensure(2)) {
+      Error("Unexpected end of file");
+      return Token::Error;
+    }
+
+    char next=buffer[bufferPos+1];
+
+    if (next=='?') {
+      bufferPos+=2;
+
+      if (!SkipUntil("?>")) {
+        Error("Unterminated processing instruction");
+        return Token::Error;
+      }
+
+      continue;
+    }
+
+    if (next=='!') {
+      if (Ensure(4) &&
+          std::memcmp(buffer.data()+bufferPos,"<!--",4)==0) {
+        bufferPos+=4;
+
+        if (!SkipUntil("-->")) {
+          Error("Unterminated comment");
+          return Token::Error;
+        }
+
+        continue;
+      }
+
+      if (Ensure(9) &&
+          std::memcmp(buffer.data()+bufferPos,"<![CDATA[",9)==0) {
+        bufferPos+=9;
+
+        if (!ReadCData()) {
+          Error("Unterminated CDATA section");
+          return Token::Error;
+        }
+
+        if (capture!=Capture::None && elementCount==captureDepth) {
+          return Token::Text;
+        }
+
+        continue;
+      }
+
+      // DOCTYPE, internal subset is not supported
+      bufferPos+=2;
+
+      if (!SkipUntil(">")) {
+        Error("Unterminated declaration");
+        return Token::Error;
+      }
+
+      continue;
+    }
+
+    bufferPos++;
+
+    if (!ReadTag()) {
+      Error("Unterminated tag");
+      return Token::Error;
+    }
+
+    if (!ParseTag()) {
+      Error("Malformed tag <" + tagBuffer + ">");
+      return Token::Error;
+    }
+
+    return tagBuffer[0]=='/' ? Token::EndElement : Token::StartElement;
+  }
+}
+
+const std::string* TrackPointReader::GetAttribute(const char *name) const
+{
+  for (size_t i=0; i<tokenAttributeCount; i++) {
+    if (tokenAttributes[i].name==name) {
+      return &tokenAttributes[i].value;
+    }
+  }
+
+  return nullptr;
+}
+
+void TrackPointReader::StartElement()
+{
+  if (elementCount==elements.size()) {
+    elements.emplace_back();
+  }
+
+  elements[elementCount]=tokenName;
+  elementCount++;
+
+  if (capture!=Capture::None) {
+    // unexpected element inside of simple value, ignored
+    return;
+  }
+
+  if (inPoint) {
+    if (elementCount==pointDepth+1) {
+      if (tokenName=="ele") {
+        capture=Capture::Elevation;
+      }
+      else if (tokenName=="time") {
+        capture=Capture::Time;
+      }
+      else if (tokenName=="magvar") {
+        capture=Capture::Course;
+      }
+      else if (tokenName=="hdop") {
+        capture=Capture::HDop;
+      }
+      else if (tokenName=="vdop") {
+        capture=Capture::VDop;
+      }
+      else if (tokenName=="pdop") {
+        capture=Capture::PDop;
+      }
+
+      if (capture!=Capture::None) {
+        captureDepth=elementCount;
+        captureValue.clear();
+      }
+    }
+
+    return;
+  }
+
+  if (elementCount<2) {
+    return;
+  }
+
+  const std::string &parent=elements[elementCount-2];
+
+  if (tokenName=="trk" && parent=="gpx") {
+    trackCount++;
+    trackName.reset();
+  }
+  else if (tokenName=="name" && parent=="trk") {
+    capture=Capture::TrackName;
+    captureDepth=elementCount;
+    captureValue.clear();
+  }
+  else if (tokenName=="trkseg" && parent=="trk") {
+    segmentCount++;
+  }
+  else if (tokenName=="trkpt" && parent=="trkseg") {
+    const std::string *latValue=GetAttribute("lat");
+    const std::string *lonValue=GetAttribute("lon");
+    double            lat;
+    double            lon;
+
+    if (latValue==nullptr ||
+        lonValue==nullptr ||
+        !ParseDouble(*latValue,lat) ||
+        !ParseDouble(*lonValue,lon)) {
+      Error("Can't parse trkpt lan/lon");
+      return;
+    }
+
+    current=TrackPoint(GeoCoord(lat,lon));
+    inPoint=true;
+    pointDepth=elementCount;
+  }
+}
+
+bool TrackPointReader::EndElement(TrackPoint &point)
+{
+  if (elementCount==0 ||
+      elements[elementCount-1]!=tokenName) {
+    Error("Unexpected end element " + tokenName);
+    return false;
+  }
+
+  elementCount--;
+
+  if (capture!=Capture::None &&
+      elementCount+1==captureDepth) {
+    ApplyCapture();
+    capture=Capture::None;
+    return false;
+  }
+
+  if (inPoint &&
+      elementCount+1==pointDepth) {
+    inPoint=false;
+    point=current;
+    return true;
+  }
+
+  return false;
+}
+
+void TrackPointReader::ApplyCapture()
+{
+  if (capture==Capture::TrackName) {
+    trackName=captureValue;
+    return;
+  }
+
+  Trim(captureValue);
+
+  if (capture==Capture::Time) {
+    Timestamp time;
+    if (ParseTime(captureValue, time)) {
+      current.time=std::make_optional<Timestamp>(time);
+    }
+    else {
+      osmscout::log.Warn() << "Can't parse Time value";
+    }
+    return;
+  }
+
+  double value;
+
+  if (!ParseDouble(captureValue,value)) {
+    osmscout::log.Warn() << "Can't parse " << elements[elementCount] << " value";
+    return;
+  }
+
+  switch (capture) {
+  case Capture::Elevation:
+    current.elevation=std::make_optional<double>(value);
+    break;
+  case Capture::Course:
+    current.course=std::make_optional<double>(value);
+    break;
+  case Capture::HDop:
+    current.hdop=std::make_optional<double>(value);
+    break;
+  case Capture::VDop:
+    current.vdop=std::make_optional<double>(value);
+    break;
+  case Capture::PDop:
+    current.pdop=std::make_optional<double>(value);
+    break;
+  default:
+    break;
+  }
+}
+
+bool TrackPointReader::Next(TrackPoint &point)
+{
+  if (file==nullptr || error) {
+    return false;
+  }
+
+  while (true) {
+    switch (NextToken()) {
+    case Token::StartElement:
+      StartElement();
+
+      if (error) {
+        return false;
+      }
+
+      if (tokenSelfClosing &&
+          EndElement(point)) {
+        return true;
+      }
+
+      if (error) {
+        return false;
+      }
+      break;
+    case Token::EndElement:
+      if (EndElement(point)) {
+        return true;
+      }
+
+      if (error) {
+        return false;
+      }
+      break;
+    case Token::Text:
+      captureValue+=tokenText;
+      break;
+    case Token::End:
+      if (elementCount>0) {
+        Error("Unexpected end of file, element " + elements[elementCount-1] + " is not closed");
+      }
+      return false;
+    case Token::Error:
+      return false;
+    }
+  }
+}
@@ -0,0 +1,327 @@
+/*
+  This source is part of the libosmscout-gpx library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/gpx/TrackPointWriter.h>
+
+#include <osmscout/util/String.h>
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <locale>
+#include <sstream>
+
+using namespace osmscout;
+using namespace osmscout::gpx;
+
+static const size_t BufferSize=64*1024;
+
+TrackPointWriter::TrackPointWriter(const std::string &filePath,
+                                   BreakerRef breaker,
+                                   ProcessCallbackRef callback):
+  breaker(breaker),
+  callback(callback)
+{
+  file=std::fopen(filePath.c_str(),"wb");
+
+  if (file==nullptr) {
+    Error("Can't open file " + filePath);
+    return;
+  }
+
+  buffer.reserve(BufferSize+1024);
+
+  Write("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<gpx version=\"1.1\" creator=\"libosmscout\""
+        " xmlns=\"http://www.topografix.com/GPX/1/1\""
+        " xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+        " xsi:schemaLocation=\"http://www.topografix.com/GPX/1/1 http://www.topografix.com/GPX/1/1/gpx.xsd\">\n");
+}
+
+TrackPointWriter::~TrackPointWriter()
+{
+  Close();
+}
+
+void TrackPointWriter::Error(const std::string &message)
+{
+  error=true;
+
+  if (callback) {
+    callback->Error(message);
+  }
+}
+
+void TrackPointWriter::Write(const char *text)
+{
+  buffer.append(text);
+}
+
+void TrackPointWriter::Write(const std::string &text)
+{
+  buffer.append(text);
+}
+
+void TrackPointWriter::WriteEscaped(const std::string &text)
+{
+  for (char c : text) {
+    switch (c) {
+    case '<':
+      buffer.append("&lt;");
+      break;
+    case '>':
+      buffer.append("&gt;");
+      break;
+    case '&':
+      buffer.append("&amp;");
+      break;
+    case '"':
+      buffer.append("&quot;");
+      break;
+    default:
+      buffer.push_back(c);
+    }
+  }
+}
+
+/**
+ * Fixed point formatting like std::ostream with std::ios::fixed and C locale
+ * (ties may be rounded differently), but without the stream overhead.
+ */
+void TrackPointWriter::WriteFixed(double value,
+                                  int precision)
+{
+  static const int64_t powersOf10[]={1, 10, 100, 1000, 10000, 100000, 1000000,
+                                     10000000, 100000000};
+
+  assert(precision>=0 && precision<=8);
+
+  double scaled=value*(double)powersOf10[precision];
+
+  if (!std::isfinite(scaled) ||
+      std::fabs(scaled)>=9.0e15) {
+    std::ostringstream stream;
+
+    stream.imbue(std::locale::classic());
+    stream.setf(std::ios::fixed,std::ios::floatfield);
+    stream.precision(precision);
+    stream << value;
+
+    buffer.append(stream.str());
+    return;
+  }
+
+  int64_t rounded=std::llround(scaled);
+
+  if (rounded<0 || (rounded==0 && std::signbit(value))) {
+    buffer.push_back('-');
+    rounded=-rounded;
+  }
+
+  char    digits[32];
+  size_t  count=0;
+  int64_t remaining=rounded;
+
+  // at least one digit before the decimal point
+  while (remaining>0 || count<=(size_t)precision) {
+    digits[count++]=(char)('0'+remaining%10);
+    remaining/=10;
+  }
+
+  while (count>0) {
+    count--;
+    buffer.push_back(digits[count]);
+
+    if (count==(size_t)precision && precision>0) {
+      buffer.push_back('.');
+    }
+  }
+}
+
+void TrackPointWriter::WriteTextElement(const char *indent,
+                                        const char *name,
+                                        double value,
+                                        int precision)
+{
+  Write(indent);
+  buffer.push_back('<');
+  Write(name);
+  buffer.push_back('>');
+  WriteFixed(value,precision);
+  buffer.append("</");
+  Write(name);
+  buffer.append(">\n");
+}
+
+bool TrackPointWriter::Flush()
+{
+  if (file==nullptr) {
+    return false;
+  }
+
+  if (!buffer.empty() &&
+      std::fwrite(buffer.data(),1,buffer.size(),file)!=buffer.size()) {
+    Error("Error while writing file");
+  }
+
+  buffer.clear();
+
+  return !error;
+}
+
+void TrackPointWriter::EndSegment()
+{
+  if (inSegment) {
+    Write("  </trkseg>\n");
+    inSegment=false;
+  }
+}
+
+void TrackPointWriter::EndTrack()
+{
+  EndSegment();
+
+  if (inTrack) {
+    Write(" </trk>\n");
+    inTrack=false;
+  }
+}
+
+bool TrackPointWriter::StartTrack(const std::optional<std::string> &name)
+{
+  if (file==nullptr || error) {
+    return false;
+  }
+
+  EndTrack();
+
+  Write(" <trk>\n");
+
+  if (name) {
+    Write("  <name>");
+    WriteEscaped(*name);
+    Write("</name>\n");
+  }
+
+  inTrack=true;
+
+  return true;
+}
+
+bool TrackPointWriter::StartSegment()
+{
+  if (file==nullptr || error) {
+    return false;
+  }
+
+  if (!inTrack) {
+    StartTrack();
+  }
+
+  EndSegment();
+
+  Write("  <trkseg>\n");
+  inSegment=true;
+
+  return true;
+}
+
+bool TrackPointWriter::WritePoint(const TrackPoint &point)
+{
+  if (file==nullptr || error) {
+    return false;
+  }
+
+  if (!inSegment) {
+    StartSegment();
+  }
+
+  Write("   <trkpt lat=\"");
+  WriteFixed(point.coord.GetLat(),6);
+  Write("\" lon=\"");
+  WriteFixed(point.coord.GetLon(),6);
+
+  if (!point.elevation &&
+      !point.time &&
+      !point.course &&
+      !point.hdop &&
+      !point.vdop &&
+      !point.pdop) {
+    Write("\"/>\n");
+  }
+  else {
+    Write("\">\n");
+
+    // same element order as ExportGpx, required by gpx xsd
+    if (point.elevation) {
+      WriteTextElement("    ","ele",*point.elevation,2);
+    }
+    if (point.time) {
+      Write("    <time>");
+      Write(TimestampToISO8601TimeString(*point.time));
+      Write("</time>\n");
+    }
+    if (point.course) {
+      WriteTextElement("    ","magvar",*point.course,2);
+    }
+    if (point.hdop) {
+      WriteTextElement("    ","hdop",*point.hdop,2);
+    }
+    if (point.vdop) {
+      WriteTextElement("    ","vdop",*point.vdop,2);
+    }
+    if (point.pdop) {
+      WriteTextElement("    ","pdop",*point.pdop,2);
+    }
+
+    Write("   </trkpt>\n");
+  }
+
+  if (buffer.size()>=BufferSize) {
+    if (breaker && breaker->IsAborted()) {
+      Error("aborted");
+      return false;
+    }
+
+    return Flush();
+  }
+
+  return true;
+}
+
+bool TrackPointWriter::Close()
+{
+  if (file==nullptr) {
+    return !error;
+  }
+
+  if (!error) {
+    EndTrack();
+    Write("</gpx>\n");
+    Flush();
+  }
+
+  if (std::fclose(file)!=0 && !error) {
+    Error("Error while closing file");
+  }
+
+  file=nullptr;
+
+  return !error;
+}
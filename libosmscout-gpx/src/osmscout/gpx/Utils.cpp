@@ -38,20 +38,57 @@ void ProcessCallback::Error(const std::string& error)
 }
 
 
+NearPointFilter::NearPointFilter(const Distance &minDistance):
+  minDistance(minDistance)
+{
+}
+
+bool NearPointFilter::Accept(const TrackPoint &point)
+{
+  if (!latest){
+    latest=point.coord;
+  }
+  Distance distance=GetEllipsoidalDistance(*latest, point.coord);
+  if (distance > minDistance){
+    latest = point.coord;
+    return true;
+  }
+  return false;
+}
+
+void NearPointFilter::Reset()
+{
+  latest.reset();
+}
+
+InaccuratePointFilter::InaccuratePointFilter(double maxDilution):
+  maxDilution(maxDilution)
+{
+}
+
+bool InaccuratePointFilter::Accept(const TrackPoint &point) const
+{
+  if (point.hdop){
+    return !(*point.hdop > maxDilution);
+  }
+  if (point.pdop){
+    return !(*point.pdop > maxDilution);
+  }
+  return true;
+}
+
 void gpx::FilterNearPoints(std::vector<TrackPoint> &points,
                            const Distance &minDistance)
 {
   if (points.empty()){
     return;
   }
-  GeoCoord latest=points[0].coord;
+  NearPointFilter filter(minDistance);
   std::vector<TrackPoint> copy;
   copy.reserve(points.size());
   bool modified = false;
   for (const TrackPoint &current:points){
-    Distance distance=GetEllipsoidalDistance(latest, current.coord);
-    if (distance > minDistance){
-      latest = current.coord;
+    if (filter.Accept(current)){
       copy.push_back(current);
     }else{
       modified = true;
@@ -65,15 +102,10 @@ void gpx::FilterNearPoints(std::vector<TrackPoint> &points,
 void gpx::FilterInaccuratePoints(std::vector<TrackPoint> &points,
                                  double maxDilution)
 {
-  auto filter=[&maxDilution](const TrackPoint &p) {
-    if (p.hdop){
-      return *p.hdop > maxDilution;
-    }
-    if (p.pdop){
-      return *p.pdop > maxDilution;
-    }
-    return false;
-  };
+  InaccuratePointFilter filter(maxDilution);
 
-  points.erase(std::remove_if(points.begin(),points.end(),filter),points.end());
+  points.erase(std::remove_if(points.begin(),points.end(),[&filter](const TrackPoint &p) {
+                 return !filter.Accept(p);
+               }),
+               points.end());
 }
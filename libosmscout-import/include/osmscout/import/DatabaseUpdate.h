@@ -0,0 +1,173 @@
+#ifndef OSMSCOUT_IMPORT_DATABASEUPDATE_H
+#define OSMSCOUT_IMPORT_DATABASEUPDATE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <osmscout/ObjectRef.h>
+
+#include <osmscout/util/GeoBox.h>
+#include <osmscout/util/Progress.h>
+#include <osmscout/util/TileId.h>
+
+#include <osmscout/import/Import.h>
+#include <osmscout/import/ImportImportExport.h>
+#include <osmscout/import/OSMChange.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * State of a database imported with ImportParameter::IsUpdatable() set,
+   * stored in the file update.dat in the database directory.
+   *
+   * The state holds the ids of all ways, that are members of multipolygon
+   * relations (changes to these ways require a full rebuild) and the offsets
+   * of all records in the data files, that were replaced by an incremental
+   * update. Replaced records are not removed from the data files, they are
+   * just not referenced by the area indexes anymore.
+   */
+  class OSMSCOUT_IMPORT_API DatabaseUpdateState CLASS_FINAL
+  {
+  public:
+    static const char* const UPDATE_DAT;
+    static const uint32_t    FILE_FORMAT_VERSION;
+
+  public:
+    std::vector<OSMId>             relationMemberWays;  //!< Sorted ids of all ways that are members of multipolygon relations
+    std::unordered_set<FileOffset> obsoleteNodeOffsets; //!< Offsets of replaced records in nodes.dat
+    std::unordered_set<FileOffset> obsoleteWayOffsets;  //!< Offsets of replaced records in ways.dat
+    std::unordered_set<FileOffset> obsoleteAreaOffsets; //!< Offsets of replaced records in areas.dat
+
+  public:
+    void Clear();
+
+    bool IsRelationMemberWay(OSMId id) const;
+
+    bool Load(const std::string& path);
+    bool Store(const std::string& path) const;
+  };
+
+  /**
+   * Result of the analysis of an OSM change against an existing database.
+   *
+   * The plan lists the database objects that are affected by the change and
+   * the cells of the spatial index grid that contain them (before and after
+   * the change). If the change is too large for an incremental update,
+   * fullRebuild is set and reason contains a human readable explanation.
+   */
+  class OSMSCOUT_IMPORT_API DatabaseUpdatePlan CLASS_FINAL
+  {
+  public:
+    std::set<ObjectOSMRef>                    changedObjects;      //!< All OSM objects changed by the change
+    std::set<ObjectOSMRef>                    createdObjects;      //!< OSM objects created by the change
+    std::multimap<ObjectOSMRef,ObjectFileRef> affectedObjects;     //!< Changed OSM objects and the database objects derived from them
+    std::set<TileId>                          affectedCells;       //!< Index cells containing affected geometry
+    GeoBox                                    affectedBoundingBox; //!< Bounding box of all affected geometry
+    size_t                                    databaseObjectCount; //!< Number of objects in the database
+    bool                                      fullRebuild;         //!< The change requires a full import
+    std::string                               reason;              //!< Reason, why a full import is required
+
+  public:
+    DatabaseUpdatePlan();
+
+    void Clear();
+  };
+
+  /**
+   * Analyses an OSM change against the database in the destination directory
+   * of the given import parameter.
+   *
+   * Changed OSM objects are mapped to database objects using the id mapping
+   * files (nodes.idmap, ways.idmap, areas.idmap) written as debugging files
+   * during import. Since long ways are split during import, one OSM object
+   * might map to multiple database objects. The old geometry of the affected
+   * objects and the new geometry from the change file are mapped to the cells
+   * of the area node index grid (ImportParameter::GetAreaNodeGridMag()).
+   *
+   * A full rebuild is planned, if the change contains relations, if the
+   * database was not imported with ImportParameter::IsUpdatable() set, if the
+   * id mapping files are missing, if a changed way is member of a multipolygon
+   * relation, if the ratio of changed objects exceeds
+   * ImportParameter::GetUpdateMaxChangeRatio() or if the number of affected
+   * cells exceeds ImportParameter::GetUpdateMaxAffectedCells().
+   */
+  class OSMSCOUT_IMPORT_API DatabaseUpdatePlanner CLASS_FINAL
+  {
+  private:
+    bool AddAffectedBoundingBox(const ImportParameter& parameter,
+                                const GeoBox& boundingBox,
+                                DatabaseUpdatePlan& plan) const;
+
+    bool ResolveAffectedObjects(const ImportParameter& parameter,
+                                DatabaseUpdatePlan& plan) const;
+
+    bool AddAffectedObjects(const ImportParameter& parameter,
+                            const TypeConfigRef& typeConfig,
+                            DatabaseUpdatePlan& plan) const;
+
+    bool AddAffectedCoords(const ImportParameter& parameter,
+                           Progress& progress,
+                           const OSMChange& change,
+                           DatabaseUpdatePlan& plan) const;
+
+  public:
+    bool Plan(const ImportParameter& parameter,
+              Progress& progress,
+              const OSMChange& change,
+              DatabaseUpdatePlan& plan) const;
+  };
+
+  /**
+   * Applies an OSM change to the database in the destination directory of the
+   * given import parameter, following a plan of DatabaseUpdatePlanner, that
+   * does not require a full rebuild.
+   *
+   * New versions of changed nodes and ways are appended to nodes.dat, ways.dat
+   * and areas.dat. Ways and areas using a moved node are appended with the new
+   * coordinate, too. The old records stay in the data files, but are marked as
+   * obsolete in update.dat. The id mapping files and coord.dat are updated and
+   * the area indexes (areanode.idx, areaway.idx and areaarea.idx) are rebuilt
+   * from the data files skipping obsolete records. Since areaarea.idx
+   * references the areas of an index cell as one continuous block, areas of
+   * cells that are not continuous anymore are copied to the end of areas.dat.
+   *
+   * All other files (routing, location and text indexes, low zoom
+   * optimizations, water and coverage index) are not updated and still
+   * reference the old records. A full import compacts the data files again.
+   */
+  class OSMSCOUT_IMPORT_API DatabaseUpdater CLASS_FINAL
+  {
+  public:
+    bool Update(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress,
+                const OSMChange& change,
+                const DatabaseUpdatePlan& plan) const;
+  };
+}
+
+#endif
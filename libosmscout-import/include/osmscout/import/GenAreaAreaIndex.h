@@ -20,8 +20,10 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <list>
 #include <map>
 #include <set>
+#include <vector>
 
 #include <osmscout/Area.h>
 #include <osmscout/Pixel.h>
@@ -41,7 +43,6 @@ namespace osmscout {
   public:
     static const char* AREAADDRESS_DAT;
 
-  private:
     struct Entry
     {
       FileOffset offset;
@@ -55,53 +56,66 @@ namespace osmscout {
 
     typedef std::map<Pixel,AreaLeaf> Level;
 
+    /**
+     * Areas of one type in one index cell.
+     */
+    struct CellTypeData
+    {
+      TypeId                type;            //!< Type of the areas
+      std::list<FileOffset> offsets;         //!< Source offsets of the areas
+      FileOffset            dataStartOffset; //!< Offset of the first written area (0, if no area was written)
+      uint32_t              dataCount;       //!< Number of written areas
+    };
+
+    /**
+     * Writes the areas of one index cell to the data file. The index only holds
+     * the offset of the first area and the number of areas for each type, and
+     * AreaAreaIndex reads the data of directly following types of a cell in one
+     * go. So the areas of all types of a cell must be stored without gaps in
+     * the given order of types.
+     */
+    class CellDataWriter
+    {
+    public:
+      virtual ~CellDataWriter() = default;
+
+      /**
+       * Write the areas of the given cell and fill dataStartOffset and dataCount
+       * for each type.
+       */
+      virtual bool WriteCellData(const TypeConfig& typeConfig,
+                                 Progress& progress,
+                                 std::vector<CellTypeData>& cellData) = 0;
+    };
+
   private:
     std::list<SortDataGenerator<Area>::ProcessingFilterRef> filters;
 
   private:
-    size_t CalculateLevel(const ImportParameter& parameter,
-                          const GeoBox& boundingBox) const;
-
-    void EnrichLevels(std::vector<Level>& levels);
-
-    bool CopyData(const TypeConfig& typeConfig,
-                  Progress& progress,
-                  FileScanner& scanner,
-                  FileWriter& dataWriter,
-                  FileWriter& mapWriter,
-                  const std::list<FileOffset>& srcOffsets,
-                  FileOffset& dataStartOffset,
-                  uint32_t& dataWrittenCount);
-
-    bool WriteChildCells(const TypeConfig& typeConfig,
-                         Progress& progress,
-                         const ImportParameter& parameter,
-                         FileScanner& scanner,
-                         FileWriter& indexWriter,
-                         FileWriter& dataWriter,
-                         FileWriter& mapWriter,
-                         const std::vector<Level>& levels,
-                         size_t level,
-                         const Pixel& pixel,
-                         FileOffset& offset,
-                         uint32_t& dataWrittenCount);
-
-    bool WriteCell(const TypeConfig& typeConfig,
-                   Progress& progress,
-                   const ImportParameter& parameter,
-                   FileScanner& scanner,
-                   FileWriter& indexWriter,
-                   FileWriter& dataWriter,
-                   FileWriter& mapWriter,
-                   const std::vector<Level>& levels,
-                   size_t level,
-                   const Pixel& pixel,
-                   const AreaLeaf& leaf,
-                   FileOffset& dataStartOffset,
-                   uint32_t& dataWrittenCount);
+    static bool WriteChildCells(const TypeConfig& typeConfig,
+                                Progress& progress,
+                                bool hilbertOrder,
+                                FileWriter& indexWriter,
+                                CellDataWriter& cellDataWriter,
+                                const std::vector<Level>& levels,
+                                size_t level,
+                                const Pixel& pixel,
+                                FileOffset& offset,
+                                uint32_t& dataWrittenCount);
+
+    static bool WriteCell(const TypeConfig& typeConfig,
+                          Progress& progress,
+                          bool hilbertOrder,
+                          FileWriter& indexWriter,
+                          CellDataWriter& cellDataWriter,
+                          const std::vector<Level>& levels,
+                          size_t level,
+                          const Pixel& pixel,
+                          const AreaLeaf& leaf,
+                          FileOffset& dataStartOffset,
+                          uint32_t& dataWrittenCount);
 
     bool BuildInMemoryIndex(const TypeConfigRef& typeConfig,
-                            const ImportParameter& parameter,
                             Progress& progress,
                             FileScanner& scanner,
                             std::vector<Level>& levels);
@@ -113,6 +127,23 @@ namespace osmscout {
   public:
     AreaAreaIndexGenerator();
 
+    static size_t CalculateLevel(size_t maxLevel,
+                                 const GeoBox& boundingBox);
+
+    static void AddArea(std::vector<Level>& levels,
+                        const Area& area,
+                        FileOffset offset);
+
+    static void EnrichLevels(std::vector<Level>& levels);
+
+    static bool WriteIndex(const TypeConfig& typeConfig,
+                           Progress& progress,
+                           bool hilbertOrder,
+                           FileWriter& indexWriter,
+                           const std::vector<Level>& levels,
+                           CellDataWriter& cellDataWriter,
+                           uint32_t& dataWrittenCount);
+
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const override;
 
@@ -22,6 +22,7 @@
 
 #include <map>
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 #include <osmscout/import/Import.h>
@@ -70,6 +71,15 @@ namespace osmscout {
     };
 
   private:
+    std::unordered_set<FileOffset> obsoleteOffsets; //!< Offsets of nodes replaced by a database update
+
+  private:
+    inline bool IsObsolete(FileOffset offset) const
+    {
+      return !obsoleteOffsets.empty() &&
+             obsoleteOffsets.find(offset)!=obsoleteOffsets.end();
+    }
+
     bool AnalyseDistribution(const TypeConfigRef& typeConfig,
                              const ImportParameter& parameter,
                              Progress& progress,
@@ -113,6 +123,8 @@ namespace osmscout {
                    const std::vector<DistributionData>& data);
 
   public:
+    void SetObsoleteOffsets(const std::unordered_set<FileOffset>& obsoleteOffsets);
+
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const override;
 
@@ -24,6 +24,7 @@
 
 #include <list>
 #include <map>
+#include <unordered_set>
 
 #include <osmscout/Pixel.h>
 
@@ -61,6 +62,15 @@ namespace osmscout {
     };
 
   private:
+    std::unordered_set<FileOffset> obsoleteOffsets; //!< Offsets of ways replaced by a database update
+
+  private:
+    inline bool IsObsolete(FileOffset offset) const
+    {
+      return !obsoleteOffsets.empty() &&
+             obsoleteOffsets.find(offset)!=obsoleteOffsets.end();
+    }
+
     bool FitsIndexCriteria(const ImportParameter& parameter,
                            Progress& progress,
                            const TypeInfo& typeInfo,
@@ -83,6 +93,8 @@ namespace osmscout {
                      const CoordOffsetsMap& typeCellOffsets);
 
   public:
+    void SetObsoleteOffsets(const std::unordered_set<FileOffset>& obsoleteOffsets);
+
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const override;
 
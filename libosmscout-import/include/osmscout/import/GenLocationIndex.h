@@ -477,6 +477,10 @@ namespace osmscout {
     void WriteAddressData(FileWriter& writer,
                           Region& root);
 
+    bool WriteRegionRaster(const ImportParameter& parameter,
+                           Progress& progress,
+                           const Region& rootRegion);
+
   public:
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const override;
@@ -0,0 +1,73 @@
+#ifndef OSMSCOUT_IMPORT_GENMULTIRESOLUTIONGEOMETRY_H
+#define OSMSCOUT_IMPORT_GENMULTIRESOLUTIONGEOMETRY_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/ImportFeatures.h>
+
+#include <string>
+#include <vector>
+
+#include <osmscout/import/Import.h>
+
+#include <osmscout/Area.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * Writes copies of all ways and areas with their geometry simplified for
+   * a number of magnification bands (see MultiResolutionDataFile for the
+   * file format).
+   */
+  class MultiResolutionGeometryGenerator CLASS_FINAL : public ImportModule
+  {
+  private:
+    struct Band
+    {
+      MagnificationLevel level;       //!< Magnification level the geometry is simplified for
+      double             tolerance;   //!< Allowed deviation in degrees of longitude
+      FileOffset         indexOffset; //!< Offset of the index of the band
+      uint32_t           entryCount;  //!< Number of index entries
+    };
+
+  private:
+    std::vector<Band> GetBands(const ImportParameter& parameter) const;
+
+    template<class N>
+    bool WriteBands(const TypeConfig& typeConfig,
+                    const ImportParameter& parameter,
+                    Progress& progress,
+                    const std::string& dataFilename,
+                    const std::string& resolutionFilename) const;
+
+  public:
+    void GetDescription(const ImportParameter& parameter,
+                        ImportModuleDescription& description) const override;
+
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress) override;
+  };
+}
+
+#endif
@@ -86,10 +86,6 @@ namespace osmscout {
                    std::list<RawWayRef>& ways,
                    RestrictionData& restrictions);
 
-    bool SplitLongWays(Progress& progress,
-                       std::list<RawWayRef>& ways,
-                       CoordDataFile::ResultMap& coordsMap);
-
     void WriteWay(Progress& progress,
                   const TypeConfig& typeConfig,
                   FileWriter& writer,
@@ -106,6 +102,10 @@ namespace osmscout {
                                  const CoordDataFile& coordDataFile);
 
   public:
+    static bool SplitLongWays(Progress& progress,
+                              std::list<RawWayRef>& ways,
+                              CoordDataFile::ResultMap& coordsMap);
+
     void GetDescription(const ImportParameter& parameter,
                         ImportModuleDescription& description) const override;
 
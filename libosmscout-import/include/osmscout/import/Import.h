@@ -32,6 +32,7 @@
 
 #include <osmscout/import/ImportErrorReporter.h>
 
+#include <osmscout/util/GeoBox.h>
 #include <osmscout/util/Magnification.h>
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/Transformation.h>
@@ -122,6 +123,7 @@ namespace osmscout {
     size_t                       startStep;                //<! Starting step for import
     size_t                       endStep;                  //<! End step for import
     std::string                  boundingPolygonFile;      //<! Polygon file containing the bounding polygon of the current import
+    GeoBox                       clipBox;                  //<! If valid, only objects touching this area are imported
     bool                         eco;                      //<! Eco modus, deletes temporary files ASAP
     std::list<Router>            router;                   //<! Definition of router
 
@@ -130,8 +132,11 @@ namespace osmscout {
     bool                         sortObjects;              //<! Sort all objects
     size_t                       sortBlockSize;            //<! Number of entries loaded in one sort iteration
     size_t                       sortTileMag;              //<! Zoom level for individual sorting cells
+    bool                         sortHilbertOrder;         //<! Order sorting cells and index cells along a Hilbert curve
 
     size_t                       processingQueueSize;      //!< Size of the processing worker queues
+    bool                         parallelOSMParsing;       //!< Parse *.osm files in parallel chunks instead of using libxml2
+    size_t                       parallelOSMChunkSize;     //!< Size of one chunk in bytes, if *.osm files are parsed in parallel
 
     size_t                       numericIndexPageSize;     //<! Size of an numeric index page in bytes
 
@@ -179,9 +184,18 @@ namespace osmscout {
     size_t                       optimizationCellSizeMax;  //<! Maximum number of entries  per index cell
     TransPolygon::OptimizeMethod optimizationWayMethod;    //<! what method to use to optimize ways
 
+    bool                         geometryBands;            //<! Generate simplified geometry bands for ways and areas
+    MagnificationLevel           geometryBandMinMag;       //<! Magnification of the coarsest simplified geometry band
+    MagnificationLevel           geometryBandMaxMag;       //<! Magnification of the most detailed simplified geometry band
+    double                       geometryBandTolerance;    //<! Allowed deviation of simplified geometry in pixel
+
     size_t                       routeNodeBlockSize;       //<! Number of route nodes loaded during import until ways get resolved
     uint32_t                     routeNodeTileMag;         //<! Size of a routing tile
 
+    bool                         updatable;                //<! Import the database in a way that supports incremental updates
+    double                       updateMaxChangeRatio;     //<! Maximum ratio of changed objects for an incremental update
+    size_t                       updateMaxAffectedCells;   //<! Maximum number of affected index cells for an incremental update
+
     AssumeLandStrategy           assumeLand;               //<! During sea/land detection,we either trust coastlines only or make some
                                                            //<! assumptions which tiles are sea and which are land.
     std::vector<std::string>     langOrder;                //<! languages used when parsing name[:lang] and
@@ -203,6 +217,7 @@ namespace osmscout {
     std::string GetTypefile() const;
     std::string GetDestinationDirectory() const;
     std::string GetBoundingPolygonFile() const;
+    GeoBox GetClipBox() const;
 
     ImportErrorReporterRef GetErrorReporter() const;
 
@@ -217,8 +232,11 @@ namespace osmscout {
     bool GetSortObjects() const;
     size_t GetSortBlockSize() const;
     size_t GetSortTileMag() const;
+    bool GetSortHilbertOrder() const;
 
     size_t GetProcessingQueueSize() const;
+    bool GetParallelOSMParsing() const;
+    size_t GetParallelOSMChunkSize() const;
 
     size_t GetNumericIndexPageSize() const;
 
@@ -267,9 +285,18 @@ namespace osmscout {
     size_t GetOptimizationCellSizeMax() const;
     TransPolygon::OptimizeMethod GetOptimizationWayMethod() const;
 
+    bool GetGeometryBands() const;
+    MagnificationLevel GetGeometryBandMinMag() const;
+    MagnificationLevel GetGeometryBandMaxMag() const;
+    double GetGeometryBandTolerance() const;
+
     size_t GetRouteNodeBlockSize() const;
     uint32_t GetRouteNodeTileMag() const;
 
+    bool IsUpdatable() const;
+    double GetUpdateMaxChangeRatio() const;
+    size_t GetUpdateMaxAffectedCells() const;
+
     AssumeLandStrategy GetAssumeLand() const;
 
     OSMId GetFirstFreeOSMId() const;
@@ -283,6 +310,7 @@ namespace osmscout {
     void SetTypefile(const std::string& typefile);
     void SetDestinationDirectory(const std::string& destinationDirectory);
     void SetBoundingPolygonFile(const std::string& boundingPolygonFile);
+    void SetClipBox(const GeoBox& clipBox);
 
     void SetErrorReporter(const ImportErrorReporterRef& errorReporter);
 
@@ -298,8 +326,11 @@ namespace osmscout {
     void SetSortObjects(bool sortObjects);
     void SetSortBlockSize(size_t sortBlockSize);
     void SetSortTileMag(size_t sortTileMag);
+    void SetSortHilbertOrder(bool sortHilbertOrder);
 
     void SetProcessingQueueSize(size_t processingQueueSize);
+    void SetParallelOSMParsing(bool parallelOSMParsing);
+    void SetParallelOSMChunkSize(size_t parallelOSMChunkSize);
 
     void SetNumericIndexPageSize(size_t numericIndexPageSize);
 
@@ -348,9 +379,18 @@ namespace osmscout {
     void SetOptimizationCellSizeMax(size_t optimizationCellSizeMax);
     void SetOptimizationWayMethod(TransPolygon::OptimizeMethod optimizationWayMethod);
 
+    void SetGeometryBands(bool geometryBands);
+    void SetGeometryBandMinMag(MagnificationLevel geometryBandMinMag);
+    void SetGeometryBandMaxMag(MagnificationLevel geometryBandMaxMag);
+    void SetGeometryBandTolerance(double geometryBandTolerance);
+
     void SetRouteNodeBlockSize(size_t blockSize);
     void SetRouteNodeTileMag(uint32_t routeNodeTileMag);
 
+    void SetUpdatable(bool updatable);
+    void SetUpdateMaxChangeRatio(double updateMaxChangeRatio);
+    void SetUpdateMaxAffectedCells(size_t updateMaxAffectedCells);
+
     void SetAssumeLand(AssumeLandStrategy assumeLand);
 
     void SetLangOrder(const std::vector<std::string>& langOrder);
@@ -482,8 +522,8 @@ namespace osmscout {
     bool ValidateDescription(Progress& progress);
     bool ValidateParameter(Progress& progress);
     void GetModuleList(std::vector<ImportModuleRef>& modules);
-    void DumpTypeConfigData(const TypeConfig& typeConfig,
-                            Progress& progress);
+    static void DumpTypeConfigData(const TypeConfig& typeConfig,
+                                   Progress& progress);
     void DumpModuleDescription(const ImportModuleDescription& description,
                                Progress& progress);
     bool CleanupTemporaries(size_t currentStep,
@@ -495,6 +535,9 @@ namespace osmscout {
     explicit Importer(const ImportParameter& parameter);
     virtual ~Importer();
 
+    static TypeConfigRef LoadTypeConfig(const ImportParameter& parameter,
+                                        Progress& progress);
+
     bool Import(Progress& progress);
 
     std::list<std::string> GetProvidedFiles() const;
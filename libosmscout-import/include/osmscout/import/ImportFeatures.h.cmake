@@ -6,4 +6,9 @@
 #cmakedefine OSMSCOUT_IMPORT_HAVE_LIB_MARISA
 #endif
 
+#ifndef OSMSCOUT_IMPORT_HAVE_XML_SUPPORT
+/* *.osm and *.osc files can be read */
+#cmakedefine OSMSCOUT_IMPORT_HAVE_XML_SUPPORT
+#endif
+
 #endif
\ No newline at end of file
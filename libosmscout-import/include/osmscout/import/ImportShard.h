@@ -0,0 +1,86 @@
+#ifndef OSMSCOUT_IMPORT_IMPORTSHARD_H
+#define OSMSCOUT_IMPORT_IMPORTSHARD_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+#include <vector>
+
+#include <osmscout/util/GeoBox.h>
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/TileId.h>
+
+#include <osmscout/import/ImportImportExport.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * One part of a geographically sharded import.
+   *
+   * The import area is split along the tile grid of a given magnification
+   * level. Every shard covers one tile, enlarged by an overlap on every side,
+   * so that objects crossing the tile border are complete in at least one
+   * shard and routing graphs of neighbouring shards share route nodes.
+   *
+   * Every shard is imported into its own database, using the bounding box
+   * of the shard as ImportParameter::SetClipBox() and the polygon file written
+   * by WritePolygonFile() as ImportParameter::SetBoundingPolygonFile().
+   * The resulting databases can be used together, e.g. by MultiDBRoutingService.
+   */
+  class OSMSCOUT_IMPORT_API ImportShard CLASS_FINAL
+  {
+  private:
+    MagnificationLevel level;       //!< Level of the tile grid
+    TileId             tile;        //!< Tile of the shard
+    GeoBox             boundingBox; //!< Bounding box of the tile including overlap
+
+  public:
+    ImportShard(const MagnificationLevel& level,
+                const TileId& tile,
+                const GeoBox& boundingBox);
+
+    inline MagnificationLevel GetLevel() const
+    {
+      return level;
+    }
+
+    inline TileId GetTile() const
+    {
+      return tile;
+    }
+
+    inline GeoBox GetBoundingBox() const
+    {
+      return boundingBox;
+    }
+
+    std::string GetName() const;
+
+    bool WritePolygonFile(const std::string& filename) const;
+
+    static std::vector<ImportShard> GetShards(const GeoBox& area,
+                                              const MagnificationLevel& level,
+                                              double overlap);
+  };
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef OSMSCOUT_IMPORT_OSMCHANGE_H
+#define OSMSCOUT_IMPORT_OSMCHANGE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/OSMScoutTypes.h>
+#include <osmscout/Tag.h>
+
+#include <osmscout/import/ImportImportExport.h>
+#include <osmscout/import/RawRelation.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * The content of an OSM change file (*.osc): the id of each changed object,
+   * the coordinates of changed nodes, the node references of changed ways, the
+   * members of changed relations and the tags of all created or modified
+   * objects. Only tags known to the TagRegistry of the type configuration
+   * are held.
+   */
+  class OSMSCOUT_IMPORT_API OSMChange CLASS_FINAL
+  {
+  public:
+    enum Action {
+      actionCreate,
+      actionModify,
+      actionDelete
+    };
+
+    struct NodeChange
+    {
+      Action   action;
+      OSMId    id;
+      GeoCoord coord;  //!< New coordinate of the node, not set for deleted nodes
+      TagMap   tags;   //!< New tags of the node, empty for deleted nodes
+    };
+
+    struct WayChange
+    {
+      Action             action;
+      OSMId              id;
+      std::vector<OSMId> nodes;  //!< New node references of the way, empty for deleted ways
+      TagMap             tags;   //!< New tags of the way, empty for deleted ways
+    };
+
+    struct RelationChange
+    {
+      Action                           action;
+      OSMId                            id;
+      std::vector<RawRelation::Member> members; //!< New members of the relation, empty for deleted relations
+      TagMap                           tags;    //!< New tags of the relation, empty for deleted relations
+    };
+
+  public:
+    std::vector<NodeChange>     nodes;
+    std::vector<WayChange>      ways;
+    std::vector<RelationChange> relations;
+
+  public:
+    inline bool IsEmpty() const
+    {
+      return nodes.empty() &&
+             ways.empty() &&
+             relations.empty();
+    }
+
+    inline size_t GetChangeCount() const
+    {
+      return nodes.size()+
+             ways.size()+
+             relations.size();
+    }
+
+    inline void Clear()
+    {
+      nodes.clear();
+      ways.clear();
+      relations.clear();
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef OSMSCOUT_IMPORT_OSMCHANGEREADER_H
+#define OSMSCOUT_IMPORT_OSMCHANGEREADER_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <string>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/Progress.h>
+
+#include <osmscout/import/ImportImportExport.h>
+#include <osmscout/import/OSMChange.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * Reader for OSM change files (*.osc) as distributed as minutely, hourly
+   * or daily diffs of the OSM database.
+   *
+   * Format is described here:
+   * https://wiki.openstreetmap.org/wiki/OsmChange
+   *
+   * Tags are resolved against the TagRegistry of the given type
+   * configuration, unknown tags are dropped like during import.
+   */
+  class OSMSCOUT_IMPORT_API OSMChangeReader CLASS_FINAL
+  {
+  public:
+    bool Read(const TypeConfig& typeConfig,
+              Progress& progress,
+              const std::string& filename,
+              OSMChange& change) const;
+  };
+}
+
+#endif
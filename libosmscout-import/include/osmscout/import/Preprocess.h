@@ -28,6 +28,7 @@
 #include <osmscout/routing/TurnRestriction.h>
 
 #include <osmscout/util/FileWriter.h>
+#include <osmscout/util/NumberSet.h>
 #include <osmscout/util/WorkQueue.h>
 
 #include <osmscout/import/Import.h>
@@ -124,6 +125,9 @@ namespace osmscout {
       std::vector<uint32_t>                    areaStat;
       std::vector<uint32_t>                    wayStat;
 
+      NumberSet                                clipNodeIds;  //!< Nodes within the clip box
+      NumberSet                                clipWayIds;   //!< Ways touching the clip box
+
     private:
       bool IsTurnRestriction(const TagMap& tags,
                              TurnRestriction::Type& type) const;
@@ -135,6 +139,8 @@ namespace osmscout {
       bool DumpDistribution();
       bool DumpBoundingBox();
 
+      void ClipBlock(RawBlockData& data);
+
       void NodeSubTask(const RawNodeData& data,
                        ProcessedData& processed);
       void WaySubTask(const RawWayData& data,
@@ -26,11 +26,17 @@
 
 namespace osmscout {
 
-  class PreprocessOSM CLASS_FINAL : public Preprocessor
+  class OSMSCOUT_IMPORT_API PreprocessOSM CLASS_FINAL : public Preprocessor
   {
   private:
     PreprocessorCallback& callback;
 
+  private:
+    bool ImportParallel(const TypeConfigRef& typeConfig,
+                        const ImportParameter& parameter,
+                        Progress& progress,
+                        const std::string& filename);
+
   public:
     explicit PreprocessOSM(PreprocessorCallback& callback);
 
@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <memory>
@@ -30,6 +31,7 @@
 #include <osmscout/ObjectRef.h>
 
 #include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Geometry.h>
 #include <osmscout/system/Math.h>
 
 namespace osmscout {
@@ -255,7 +257,16 @@ namespace osmscout {
 
             size_t cellY=(size_t)((coord.GetLat()+90.0)/180.0*zoomLevel);
             size_t cellX=(size_t)((coord.GetLon()+180.0)/360.0*zoomLevel);
-            size_t cellIndex=cellY*zoomLevel+cellX;
+            size_t cellIndex;
+
+            if (parameter.GetSortHilbertOrder()) {
+              cellIndex=(size_t)GetHilbertIndex((uint32_t)std::min(cellX,zoomLevel-1),
+                                                (uint32_t)std::min(cellY,zoomLevel-1),
+                                                (uint32_t)parameter.GetSortTileMag());
+            }
+            else {
+              cellIndex=cellY*zoomLevel+cellX;
+            }
 
             if (cellIndex>=minIndex &&
                 cellIndex<=maxIndex) {
@@ -0,0 +1,2007 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/DatabaseUpdate.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/AreaAreaIndex.h>
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/AreaWayIndex.h>
+#include <osmscout/CoordDataFile.h>
+#include <osmscout/FeatureReader.h>
+#include <osmscout/NodeDataFile.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+
+#include <osmscout/import/GenAreaAreaIndex.h>
+#include <osmscout/import/GenAreaNodeIndex.h>
+#include <osmscout/import/GenAreaWayIndex.h>
+#include <osmscout/import/GenWayWayDat.h>
+#include <osmscout/import/RawNode.h>
+#include <osmscout/import/RawWay.h>
+
+namespace osmscout {
+
+  const char* const DatabaseUpdateState::UPDATE_DAT="update.dat";
+  const uint32_t    DatabaseUpdateState::FILE_FORMAT_VERSION=1;
+
+  void DatabaseUpdateState::Clear()
+  {
+    relationMemberWays.clear();
+    obsoleteNodeOffsets.clear();
+    obsoleteWayOffsets.clear();
+    obsoleteAreaOffsets.clear();
+  }
+
+  bool DatabaseUpdateState::IsRelationMemberWay(OSMId id) const
+  {
+    return std::binary_search(relationMemberWays.begin(),
+                              relationMemberWays.end(),
+                              id);
+  }
+
+  /**
+   * @throws IOException
+   */
+  static void ReadOffsets(FileScanner& scanner,
+                          std::unordered_set<FileOffset>& offsets)
+  {
+    uint32_t   count;
+    FileOffset offset=0;
+
+    scanner.Read(count);
+
+    offsets.reserve(count);
+
+    for (uint32_t i=1; i<=count; i++) {
+      FileOffset delta;
+
+      scanner.ReadNumber(delta);
+
+      offset+=delta;
+
+      offsets.insert(offset);
+    }
+  }
+
+  /**
+   * @throws IOException
+   */
+  static void WriteOffsets(FileWriter& writer,
+                           const std::unordered_set<FileOffset>& offsets)
+  {
+    std::vector<FileOffset> sortedOffsets(offsets.begin(),
+                                          offsets.end());
+    FileOffset              lastOffset=0;
+
+    std::sort(sortedOffsets.begin(),
+              sortedOffsets.end());
+
+    writer.Write((uint32_t)sortedOffsets.size());
+
+    for (const auto offset : sortedOffsets) {
+      writer.WriteNumber(offset-lastOffset);
+
+      lastOffset=offset;
+    }
+  }
+
+  bool DatabaseUpdateState::Load(const std::string& path)
+  {
+    FileScanner scanner;
+
+    Clear();
+
+    try {
+      uint32_t fileFormatVersion;
+      uint32_t memberWayCount;
+      OSMId    id=0;
+
+      scanner.Open(AppendFileToDir(path,
+                                   UPDATE_DAT),
+                   FileScanner::Sequential,
+                   false);
+
+      scanner.Read(fileFormatVersion);
+
+      if (fileFormatVersion!=FILE_FORMAT_VERSION) {
+        log.Error() << "File '" << scanner.GetFilename() << "' does not have the expected format version! Actual " << fileFormatVersion << ", expected: " << FILE_FORMAT_VERSION;
+        scanner.Close();
+
+        return false;
+      }
+
+      scanner.Read(memberWayCount);
+
+      relationMemberWays.reserve(memberWayCount);
+
+      for (uint32_t i=1; i<=memberWayCount; i++) {
+        OSMId delta;
+
+        scanner.ReadNumber(delta);
+
+        id+=delta;
+
+        relationMemberWays.push_back(id);
+      }
+
+      ReadOffsets(scanner,
+                  obsoleteNodeOffsets);
+      ReadOffsets(scanner,
+                  obsoleteWayOffsets);
+      ReadOffsets(scanner,
+                  obsoleteAreaOffsets);
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  bool DatabaseUpdateState::Store(const std::string& path) const
+  {
+    FileWriter writer;
+
+    try {
+      OSMId lastId=0;
+
+      writer.Open(AppendFileToDir(path,
+                                  UPDATE_DAT));
+
+      writer.Write(FILE_FORMAT_VERSION);
+
+      writer.Write((uint32_t)relationMemberWays.size());
+
+      for (const auto id : relationMemberWays) {
+        writer.WriteNumber(id-lastId);
+
+        lastId=id;
+      }
+
+      WriteOffsets(writer,
+                   obsoleteNodeOffsets);
+      WriteOffsets(writer,
+                   obsoleteWayOffsets);
+      WriteOffsets(writer,
+                   obsoleteAreaOffsets);
+
+      writer.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  DatabaseUpdatePlan::DatabaseUpdatePlan()
+  : databaseObjectCount(0),
+    fullRebuild(false)
+  {
+    // no code
+  }
+
+  void DatabaseUpdatePlan::Clear()
+  {
+    changedObjects.clear();
+    createdObjects.clear();
+    affectedObjects.clear();
+    affectedCells.clear();
+    affectedBoundingBox.Invalidate();
+    databaseObjectCount=0;
+    fullRebuild=false;
+    reason.clear();
+  }
+
+  static bool ReadIdMapEntryCount(const std::string& filename,
+                                  uint32_t& entryCount)
+  {
+    FileScanner scanner;
+
+    try {
+      scanner.Open(filename,FileScanner::Sequential,false);
+      scanner.Read(entryCount);
+      scanner.Close();
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+  }
+
+  static GeoBox GetObjectBoundingBox(const Node& node)
+  {
+    return GeoBox(node.GetCoords(),
+                  node.GetCoords());
+  }
+
+  static GeoBox GetObjectBoundingBox(const Way& way)
+  {
+    return way.GetBoundingBox();
+  }
+
+  static GeoBox GetObjectBoundingBox(const Area& area)
+  {
+    return area.GetBoundingBox();
+  }
+
+  template<typename DataFileType>
+  static bool GetObjectBoundingBoxes(const TypeConfigRef& typeConfig,
+                                     const std::string& path,
+                                     const std::vector<FileOffset>& offsets,
+                                     std::vector<GeoBox>& boundingBoxes)
+  {
+    if (offsets.empty()) {
+      return true;
+    }
+
+    DataFileType                                   dataFile(offsets.size());
+    std::vector<typename DataFileType::ValueType> objects;
+
+    if (!dataFile.Open(typeConfig,
+                       path,
+                       false)) {
+      return false;
+    }
+
+    if (!dataFile.GetByOffset(offsets.begin(),
+                              offsets.end(),
+                              offsets.size(),
+                              objects)) {
+      dataFile.Close();
+      return false;
+    }
+
+    for (const auto& object : objects) {
+      boundingBoxes.push_back(GetObjectBoundingBox(*object));
+    }
+
+    return dataFile.Close();
+  }
+
+  /**
+   * Add all index cells covered by the given bounding box to the plan.
+   * Returns false, if this would exceed the allowed number of affected cells.
+   * In this case a full rebuild is planned.
+   */
+  bool DatabaseUpdatePlanner::AddAffectedBoundingBox(const ImportParameter& parameter,
+                                                     const GeoBox& boundingBox,
+                                                     DatabaseUpdatePlan& plan) const
+  {
+    if (!boundingBox.IsValid()) {
+      return true;
+    }
+
+    TileIdBox cells(Magnification(parameter.GetAreaNodeGridMag()),
+                    boundingBox);
+
+    if (plan.affectedCells.size()+(size_t)cells.GetWidth()*cells.GetHeight()>parameter.GetUpdateMaxAffectedCells()) {
+      plan.fullRebuild=true;
+      plan.reason="More than "+std::to_string(parameter.GetUpdateMaxAffectedCells())+" index cells affected";
+
+      return false;
+    }
+
+    for (const auto& cell : cells) {
+      plan.affectedCells.insert(cell);
+    }
+
+    plan.affectedBoundingBox.Include(boundingBox);
+
+    return true;
+  }
+
+  /**
+   * Map the changed OSM objects, that existed before the change, to the database
+   * objects derived from them, using the id mapping files.
+   */
+  bool DatabaseUpdatePlanner::ResolveAffectedObjects(const ImportParameter& parameter,
+                                                     DatabaseUpdatePlan& plan) const
+  {
+    std::set<ObjectOSMRef> existingObjects;
+
+    std::set_difference(plan.changedObjects.begin(),
+                        plan.changedObjects.end(),
+                        plan.createdObjects.begin(),
+                        plan.createdObjects.end(),
+                        std::inserter(existingObjects,existingObjects.begin()));
+
+    for (const auto& idMap : {std::make_pair(NodeDataFile::NODES_IDMAP,refNode),
+                              std::make_pair(WayDataFile::WAYS_IDMAP,refWay),
+                              std::make_pair(AreaDataFile::AREAS_IDMAP,refArea)}) {
+      FileScanner scanner;
+
+      try {
+        uint32_t entryCount;
+
+        scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     idMap.first),
+                     FileScanner::Sequential,
+                     false);
+
+        scanner.Read(entryCount);
+
+        for (uint32_t i=1; i<=entryCount; i++) {
+          Id         id;
+          uint8_t    typeByte;
+          FileOffset fileOffset;
+
+          scanner.Read(id);
+          scanner.Read(typeByte);
+          scanner.ReadFileOffset(fileOffset);
+
+          ObjectOSMRef osmRef(id,(OSMRefType)typeByte);
+
+          if (existingObjects.find(osmRef)!=existingObjects.end()) {
+            plan.affectedObjects.insert(std::make_pair(osmRef,
+                                                       ObjectFileRef(fileOffset,
+                                                                     idMap.second)));
+          }
+        }
+
+        scanner.Close();
+      }
+      catch (IOException& e) {
+        log.Error() << e.GetDescription();
+        scanner.CloseFailsafe();
+
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Add the current geometry of all database objects affected by the change.
+   */
+  bool DatabaseUpdatePlanner::AddAffectedObjects(const ImportParameter& parameter,
+                                                 const TypeConfigRef& typeConfig,
+                                                 DatabaseUpdatePlan& plan) const
+  {
+    std::vector<FileOffset> nodeOffsets;
+    std::vector<FileOffset> wayOffsets;
+    std::vector<FileOffset> areaOffsets;
+    std::vector<GeoBox>     boundingBoxes;
+
+    for (const auto& entry : plan.affectedObjects) {
+      switch (entry.second.GetType()) {
+      case refNone:
+        break;
+      case refNode:
+        nodeOffsets.push_back(entry.second.GetFileOffset());
+        break;
+      case refWay:
+        wayOffsets.push_back(entry.second.GetFileOffset());
+        break;
+      case refArea:
+        areaOffsets.push_back(entry.second.GetFileOffset());
+        break;
+      }
+    }
+
+    if (!GetObjectBoundingBoxes<NodeDataFile>(typeConfig,
+                                              parameter.GetDestinationDirectory(),
+                                              nodeOffsets,
+                                              boundingBoxes) ||
+        !GetObjectBoundingBoxes<WayDataFile>(typeConfig,
+                                             parameter.GetDestinationDirectory(),
+                                             wayOffsets,
+                                             boundingBoxes) ||
+        !GetObjectBoundingBoxes<AreaDataFile>(typeConfig,
+                                              parameter.GetDestinationDirectory(),
+                                              areaOffsets,
+                                              boundingBoxes)) {
+      return false;
+    }
+
+    for (const auto& boundingBox : boundingBoxes) {
+      if (!AddAffectedBoundingBox(parameter,
+                                  boundingBox,
+                                  plan)) {
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Add the old and new position of all changed nodes and the new geometry
+   * of all changed ways. Moving a node changes all ways and areas using it,
+   * even if they are not part of the change themselves, so both positions
+   * must be covered.
+   */
+  bool DatabaseUpdatePlanner::AddAffectedCoords(const ImportParameter& parameter,
+                                                Progress& progress,
+                                                const OSMChange& change,
+                                                DatabaseUpdatePlan& plan) const
+  {
+    std::unordered_map<OSMId,GeoCoord> newCoords;
+    std::set<OSMId>                    oldCoordIds;
+
+    for (const auto& node : change.nodes) {
+      if (node.action!=OSMChange::actionDelete) {
+        newCoords[node.id]=node.coord;
+      }
+
+      if (node.action!=OSMChange::actionCreate) {
+        oldCoordIds.insert(node.id);
+      }
+    }
+
+    for (const auto& way : change.ways) {
+      for (const auto& node : way.nodes) {
+        if (newCoords.find(node)==newCoords.end()) {
+          oldCoordIds.insert(node);
+        }
+      }
+    }
+
+    CoordDataFile::ResultMap oldCoords;
+
+    if (!oldCoordIds.empty()) {
+      if (!ExistsInFilesystem(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                              CoordDataFile::COORD_DAT))) {
+        plan.fullRebuild=true;
+        plan.reason=std::string("Coordinate file '")+CoordDataFile::COORD_DAT+"' is missing";
+
+        return true;
+      }
+
+      CoordDataFile coordDataFile;
+
+      if (!coordDataFile.Open(parameter.GetDestinationDirectory(),
+                              false) ||
+          !coordDataFile.Get(oldCoordIds,
+                             oldCoords)) {
+        progress.Error(std::string("Cannot read coordinates from '")+CoordDataFile::COORD_DAT+"'");
+        return false;
+      }
+
+      coordDataFile.Close();
+    }
+
+    for (const auto& node : change.nodes) {
+      auto newCoord=newCoords.find(node.id);
+      auto oldCoord=oldCoords.find(node.id);
+
+      if (newCoord!=newCoords.end() &&
+          !AddAffectedBoundingBox(parameter,
+                                  GeoBox(newCoord->second,
+                                         newCoord->second),
+                                  plan)) {
+        return true;
+      }
+
+      if (oldCoord!=oldCoords.end() &&
+          !AddAffectedBoundingBox(parameter,
+                                  GeoBox(oldCoord->second.GetCoord(),
+                                         oldCoord->second.GetCoord()),
+                                  plan)) {
+        return true;
+      }
+    }
+
+    for (const auto& way : change.ways) {
+      GeoBox boundingBox;
+
+      for (const auto& node : way.nodes) {
+        auto newCoord=newCoords.find(node);
+
+        if (newCoord!=newCoords.end()) {
+          boundingBox.Include(newCoord->second);
+          continue;
+        }
+
+        auto oldCoord=oldCoords.find(node);
+
+        if (oldCoord!=oldCoords.end()) {
+          boundingBox.Include(oldCoord->second.GetCoord());
+        }
+      }
+
+      if (!AddAffectedBoundingBox(parameter,
+                                  boundingBox,
+                                  plan)) {
+        return true;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Analyse the given change against the database in the destination directory
+   * of the parameter. Returns false on error, the decision between an
+   * incremental update and a full rebuild is returned as part of the plan.
+   */
+  bool DatabaseUpdatePlanner::Plan(const ImportParameter& parameter,
+                                   Progress& progress,
+                                   const OSMChange& change,
+                                   DatabaseUpdatePlan& plan) const
+  {
+    plan.Clear();
+
+    progress.SetAction("Planning database update");
+
+    for (const auto& node : change.nodes) {
+      plan.changedObjects.insert(ObjectOSMRef(node.id,osmRefNode));
+
+      if (node.action==OSMChange::actionCreate) {
+        plan.createdObjects.insert(ObjectOSMRef(node.id,osmRefNode));
+      }
+    }
+
+    for (const auto& way : change.ways) {
+      plan.changedObjects.insert(ObjectOSMRef(way.id,osmRefWay));
+
+      if (way.action==OSMChange::actionCreate) {
+        plan.createdObjects.insert(ObjectOSMRef(way.id,osmRefWay));
+      }
+    }
+
+    for (const auto& relation : change.relations) {
+      plan.changedObjects.insert(ObjectOSMRef(relation.id,osmRefRelation));
+
+      if (relation.action==OSMChange::actionCreate) {
+        plan.createdObjects.insert(ObjectOSMRef(relation.id,osmRefRelation));
+      }
+    }
+
+    if (change.IsEmpty()) {
+      return true;
+    }
+
+    if (!change.relations.empty()) {
+      plan.fullRebuild=true;
+      plan.reason="Relations changed";
+
+      return true;
+    }
+
+    for (const auto& idMap : {NodeDataFile::NODES_IDMAP,
+                              WayDataFile::WAYS_IDMAP,
+                              AreaDataFile::AREAS_IDMAP}) {
+      std::string filename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                           idMap);
+      uint32_t    entryCount;
+
+      if (!ExistsInFilesystem(filename)) {
+        plan.fullRebuild=true;
+        plan.reason=std::string("Id mapping file '")+idMap+"' is missing";
+
+        return true;
+      }
+
+      if (!ReadIdMapEntryCount(filename,
+                               entryCount)) {
+        progress.Error("Cannot read id mapping file '"+filename+"'");
+        return false;
+      }
+
+      plan.databaseObjectCount+=entryCount;
+    }
+
+    if (!ExistsInFilesystem(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                            DatabaseUpdateState::UPDATE_DAT))) {
+      plan.fullRebuild=true;
+      plan.reason="Database was not imported as updatable";
+
+      return true;
+    }
+
+    DatabaseUpdateState state;
+
+    if (!state.Load(parameter.GetDestinationDirectory())) {
+      progress.Error(std::string("Cannot read '")+DatabaseUpdateState::UPDATE_DAT+"'");
+      return false;
+    }
+
+    // Changing the geometry of a multipolygon member way changes the geometry
+    // of the multipolygon, which we cannot rebuild without the relation
+    for (const auto& way : change.ways) {
+      if (way.action!=OSMChange::actionCreate &&
+          state.IsRelationMemberWay(way.id)) {
+        plan.fullRebuild=true;
+        plan.reason="Way "+std::to_string(way.id)+" is member of a relation";
+
+        return true;
+      }
+    }
+
+    if ((double)plan.changedObjects.size()>parameter.GetUpdateMaxChangeRatio()*(double)plan.databaseObjectCount) {
+      plan.fullRebuild=true;
+      plan.reason=std::to_string(plan.changedObjects.size())+" of "+std::to_string(plan.databaseObjectCount)+" objects changed";
+
+      return true;
+    }
+
+    if (!ResolveAffectedObjects(parameter,
+                                plan)) {
+      progress.Error("Cannot resolve changed objects");
+      return false;
+    }
+
+    TypeConfigRef typeConfig=std::make_shared<TypeConfig>();
+
+    if (!typeConfig->LoadFromDataFile(parameter.GetDestinationDirectory())) {
+      progress.Error("Cannot load type configuration from '"+parameter.GetDestinationDirectory()+"'");
+      return false;
+    }
+
+    if (!AddAffectedObjects(parameter,
+                            typeConfig,
+                            plan)) {
+      progress.Error("Cannot load affected objects");
+      return false;
+    }
+
+    if (plan.fullRebuild) {
+      return true;
+    }
+
+    if (!AddAffectedCoords(parameter,
+                           progress,
+                           change,
+                           plan)) {
+      return false;
+    }
+
+    if (!plan.fullRebuild) {
+      progress.Info(std::to_string(plan.affectedObjects.size())+" database object(s) in "+
+                    std::to_string(plan.affectedCells.size())+" index cell(s) affected");
+    }
+
+    return true;
+  }
+
+  typedef std::unordered_map<FileOffset,FileOffset> OffsetRemap;
+
+  /**
+   * Return the current offset of the record at the given offset. A record
+   * updated by the change might be copied again while rebuilding the area
+   * index, so we have to follow the chain of copies.
+   */
+  static FileOffset GetCurrentOffset(const OffsetRemap& remap,
+                                     FileOffset offset)
+  {
+    auto entry=remap.find(offset);
+
+    while (entry!=remap.end()) {
+      offset=entry->second;
+      entry=remap.find(offset);
+    }
+
+    return offset;
+  }
+
+  /**
+   * Reports tag errors of changed objects as warnings. Contrary to the
+   * ImportErrorReporter the HTML error reports of the import are left untouched.
+   */
+  class UpdateTagErrorReporter : public TagErrorReporter
+  {
+  private:
+    Progress& progress;
+
+  public:
+    explicit UpdateTagErrorReporter(Progress& progress)
+    : progress(progress)
+    {
+      // no code
+    }
+
+    void ReportTag(const ObjectOSMRef& object,
+                   const TagMap& /*tags*/,
+                   const std::string& error) override
+    {
+      progress.Warning(object.GetName()+" - "+error);
+    }
+  };
+
+  /**
+   * Objects written to the data files by the update.
+   */
+  template<typename T>
+  struct UpdatedObject
+  {
+    T            object;
+    FileOffset   oldOffset; //!< Offset of the replaced record, 0 for objects of changed OSM objects
+    ObjectOSMRef osmRef;    //!< OSM object, the object was created from, if oldOffset is 0
+    FileOffset   newOffset; //!< Offset of the written record
+  };
+
+  /**
+   * Check, if the given type configuration is the one, the database was
+   * imported with. Objects are written using the type and feature indexes of
+   * the type configuration.
+   */
+  static bool IsDatabaseTypeConfig(const TypeConfig& typeConfig,
+                                   const TypeConfig& databaseTypeConfig)
+  {
+    for (const auto& type : typeConfig.GetTypes()) {
+      if (type->IsInternal()) {
+        continue;
+      }
+
+      TypeInfoRef databaseType=databaseTypeConfig.GetTypeInfo(type->GetName());
+
+      if (!databaseType ||
+          databaseType->GetNodeId()!=type->GetNodeId() ||
+          databaseType->GetWayId()!=type->GetWayId() ||
+          databaseType->GetAreaId()!=type->GetAreaId() ||
+          databaseType->GetFeatureCount()!=type->GetFeatureCount()) {
+        return false;
+      }
+
+      for (size_t f=0; f<type->GetFeatureCount(); f++) {
+        if (databaseType->GetFeature(f).GetFeature()->GetName()!=type->GetFeature(f).GetFeature()->GetName()) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Location and postal code features are only used during import to build
+   * the location index and are removed before the objects are written to the
+   * data files.
+   */
+  template<typename T>
+  static void RemoveLocationFeatures(const LocationFeatureValueReader& locationReader,
+                                     const PostalCodeFeatureValueReader& postalCodeReader,
+                                     T& object)
+  {
+    size_t index;
+
+    if (locationReader.GetIndex(object.GetFeatureValueBuffer(),
+                                index) &&
+        object.GetFeatureValueBuffer().HasFeature(index)) {
+      object.UnsetFeature(index);
+    }
+
+    if (postalCodeReader.GetIndex(object.GetFeatureValueBuffer(),
+                                  index) &&
+        object.GetFeatureValueBuffer().HasFeature(index)) {
+      object.UnsetFeature(index);
+    }
+  }
+
+  /**
+   * Append the given objects to the data file and update the object count
+   * in the header of the file.
+   */
+  template<typename T>
+  static bool AppendObjects(const TypeConfig& typeConfig,
+                            const std::string& filename,
+                            std::vector<UpdatedObject<T>>& objects)
+  {
+    FileScanner scanner;
+    FileWriter  writer;
+
+    try {
+      uint32_t objectCount;
+
+      scanner.Open(filename,
+                   FileScanner::Sequential,
+                   false);
+
+      scanner.Read(objectCount);
+
+      scanner.Close();
+
+      writer.OpenExisting(filename);
+      writer.GotoEnd();
+
+      for (auto& object : objects) {
+        object.newOffset=writer.GetPos();
+
+        object.object.Write(typeConfig,
+                            writer);
+      }
+
+      writer.SetPos(0);
+      writer.Write((uint32_t)(objectCount+objects.size()));
+
+      writer.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Replace the given point by its new position. Returns true, if the point was
+   * replaced. Ways and areas store the serial of their points only for some types,
+   * so points without serial only match by coordinate.
+   */
+  static bool MovePoint(Point& point,
+                        const Point& oldPoint,
+                        const Point& newPoint)
+  {
+    if (point.GetCoord().GetId()!=oldPoint.GetCoord().GetId() ||
+        (point.GetSerial()!=0 &&
+         point.GetSerial()!=oldPoint.GetSerial())) {
+      return false;
+    }
+
+    point.Set(point.GetSerial()!=0 ? newPoint.GetSerial() : 0,
+              newPoint.GetCoord());
+
+    return true;
+  }
+
+  /**
+   * Load all ways and areas at the old positions of the moved points, that are
+   * not obsolete.
+   */
+  static bool LoadObjectsAtPoints(const TypeConfigRef& typeConfig,
+                                  const std::string& path,
+                                  const std::vector<std::pair<Point,Point>>& movedPoints,
+                                  const DatabaseUpdateState& state,
+                                  std::map<FileOffset,Way>& ways,
+                                  std::map<FileOffset,Area>& areas)
+  {
+    AreaWayIndex               areaWayIndex;
+    AreaAreaIndex              areaAreaIndex(100);
+    TypeInfoSet                wayTypes(*typeConfig);
+    TypeInfoSet                areaTypes(*typeConfig);
+    std::set<FileOffset>       wayOffsets;
+    std::vector<DataBlockSpan> areaSpans;
+
+    for (const auto& type : typeConfig->GetWayTypes()) {
+      wayTypes.Set(type);
+    }
+
+    for (const auto& type : typeConfig->GetAreaTypes()) {
+      areaTypes.Set(type);
+    }
+
+    if (!areaWayIndex.Open(typeConfig,
+                           path,
+                           false) ||
+        !areaAreaIndex.Open(path,
+                            false)) {
+      return false;
+    }
+
+    for (const auto& movedPoint : movedPoints) {
+      GeoBox                     boundingBox(movedPoint.first.GetCoord(),
+                                             movedPoint.first.GetCoord());
+      std::vector<FileOffset>    offsets;
+      std::vector<DataBlockSpan> spans;
+      TypeInfoSet                loadedTypes;
+
+      if (!areaWayIndex.GetOffsets(boundingBox,
+                                   wayTypes,
+                                   offsets,
+                                   loadedTypes) ||
+          !areaAreaIndex.GetAreasInArea(*typeConfig,
+                                        boundingBox,
+                                        std::numeric_limits<size_t>::max(),
+                                        areaTypes,
+                                        spans,
+                                        loadedTypes)) {
+        return false;
+      }
+
+      wayOffsets.insert(offsets.begin(),
+                        offsets.end());
+      areaSpans.insert(areaSpans.end(),
+                       spans.begin(),
+                       spans.end());
+    }
+
+    FileScanner scanner;
+
+    try {
+      scanner.Open(AppendFileToDir(path,
+                                   WayDataFile::WAYS_DAT),
+                   FileScanner::LowMemRandom,
+                   false);
+
+      for (const auto offset : wayOffsets) {
+        if (state.obsoleteWayOffsets.find(offset)!=state.obsoleteWayOffsets.end()) {
+          continue;
+        }
+
+        scanner.SetPos(offset);
+
+        ways[offset].Read(*typeConfig,
+                          scanner);
+      }
+
+      scanner.Close();
+
+      scanner.Open(AppendFileToDir(path,
+                                   AreaDataFile::AREAS_DAT),
+                   FileScanner::LowMemRandom,
+                   false);
+
+      for (const auto& span : areaSpans) {
+        scanner.SetPos(span.startOffset);
+
+        for (uint32_t i=0; i<span.count; i++) {
+          FileOffset offset=scanner.GetPos();
+          Area       area;
+
+          area.Read(*typeConfig,
+                    scanner);
+
+          if (state.obsoleteAreaOffsets.find(offset)==state.obsoleteAreaOffsets.end()) {
+            areas[offset]=std::move(area);
+          }
+        }
+      }
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Create the way or area for the given changed way, following the rules of
+   * the Preprocess step. Returns an empty reference, if the way is not imported.
+   */
+  static RawWayRef CreateRawWay(const TypeConfig& typeConfig,
+                                TagErrorReporter& errorReporter,
+                                const OSMChange::WayChange& wayChange)
+  {
+    TypeInfoRef areaType;
+    TypeInfoRef wayType;
+    int         isArea=0; // 0==unknown, 1==true, -1==false
+    RawWayRef   way=std::make_shared<RawWay>();
+
+    if (wayChange.nodes.size()<2) {
+      return nullptr;
+    }
+
+    typeConfig.GetWayAreaType(wayChange.tags,
+                              wayType,
+                              areaType);
+
+    auto areaTag=wayChange.tags.find(typeConfig.tagArea);
+
+    if (areaTag!=wayChange.tags.end()) {
+      if (areaTag->second=="0" ||
+          areaTag->second=="no" ||
+          areaTag->second=="false") {
+        isArea=-1;
+      }
+      else {
+        isArea=1;
+      }
+    }
+
+    auto junctionTag=wayChange.tags.find(typeConfig.tagJunction);
+
+    if (junctionTag!=wayChange.tags.end() &&
+        junctionTag->second=="roundabout") {
+      isArea=-1;
+    }
+
+    if (isArea==0) {
+      if (wayType->GetPinWay()) {
+        isArea=-1;
+      }
+      else if (wayChange.nodes.size()>3 &&
+               wayChange.nodes.front()==wayChange.nodes.back()) {
+        isArea=1;
+      }
+      else {
+        isArea=-1;
+      }
+    }
+
+    way->SetId(wayChange.id);
+
+    if (isArea==1) {
+      if (areaType==typeConfig.typeInfoIgnore ||
+          areaType->GetIgnore()) {
+        return nullptr;
+      }
+
+      way->SetType(areaType,true);
+
+      if (wayChange.nodes.size()>3 &&
+          wayChange.nodes.front()==wayChange.nodes.back()) {
+        way->SetNodes(wayChange.nodes.begin(),--wayChange.nodes.end());
+      }
+      else {
+        way->SetNodes(wayChange.nodes.begin(),wayChange.nodes.end());
+      }
+    }
+    else {
+      if (wayType==typeConfig.typeInfoIgnore ||
+          wayType->GetIgnore()) {
+        return nullptr;
+      }
+
+      way->SetType(wayType,false);
+      way->SetNodes(wayChange.nodes.begin(),wayChange.nodes.end());
+    }
+
+    way->Parse(errorReporter,
+               typeConfig.GetTagRegistry(),
+               wayChange.tags);
+
+    return way;
+  }
+
+  /**
+   * Resolve the coordinates of the given nodes. Returns false, if a node
+   * cannot be resolved.
+   */
+  static bool ResolvePoints(Progress& progress,
+                            const CoordDataFile::ResultMap& coords,
+                            const RawWay& rawWay,
+                            std::vector<Point>& points)
+  {
+    points.resize(rawWay.GetNodeCount());
+
+    for (size_t n=0; n<rawWay.GetNodeCount(); n++) {
+      auto coord=coords.find(rawWay.GetNodeId(n));
+
+      if (coord==coords.end()) {
+        progress.Error("Cannot resolve node with id "+
+                       std::to_string(rawWay.GetNodeId(n))+
+                       " for way "+
+                       std::to_string(rawWay.GetId())+
+                       ", skipping");
+        return false;
+      }
+
+      points[n]=coord->second;
+    }
+
+    return true;
+  }
+
+  /**
+   * Rewrite the given id mapping file: entries of changed OSM objects are
+   * removed, offsets of moved records are updated and the entries for the
+   * objects created from the change are appended.
+   */
+  static bool UpdateIdMap(const std::string& filename,
+                          const std::set<ObjectOSMRef>& changedObjects,
+                          const OffsetRemap& remap,
+                          const std::vector<std::pair<ObjectOSMRef,FileOffset>>& newEntries)
+  {
+    std::string tmpFilename=filename+".tmp";
+    FileScanner scanner;
+    FileWriter  writer;
+
+    try {
+      uint32_t entryCount;
+      uint32_t writtenEntryCount=0;
+
+      scanner.Open(filename,
+                   FileScanner::Sequential,
+                   false);
+      writer.Open(tmpFilename);
+
+      scanner.Read(entryCount);
+      writer.Write(writtenEntryCount);
+
+      for (uint32_t i=1; i<=entryCount; i++) {
+        Id         id;
+        uint8_t    typeByte;
+        FileOffset fileOffset;
+
+        scanner.Read(id);
+        scanner.Read(typeByte);
+        scanner.ReadFileOffset(fileOffset);
+
+        if (changedObjects.find(ObjectOSMRef(id,(OSMRefType)typeByte))!=changedObjects.end()) {
+          continue;
+        }
+
+        writer.Write(id);
+        writer.Write(typeByte);
+        writer.WriteFileOffset(GetCurrentOffset(remap,
+                                                fileOffset));
+
+        writtenEntryCount++;
+      }
+
+      for (const auto& entry : newEntries) {
+        writer.Write((Id)entry.first.GetId());
+        writer.Write((uint8_t)entry.first.GetType());
+        writer.WriteFileOffset(GetCurrentOffset(remap,
+                                                entry.second));
+
+        writtenEntryCount++;
+      }
+
+      writer.SetPos(0);
+      writer.Write(writtenEntryCount);
+
+      scanner.Close();
+      writer.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return RemoveFile(filename) &&
+           RenameFile(tmpFilename,
+                      filename);
+  }
+
+  /**
+   * Update the coordinates of the changed nodes in coord.dat. Entries in
+   * existing pages are overwritten in place, new pages are appended to the
+   * file followed by a new page map.
+   */
+  static bool UpdateCoordDataFile(const std::string& path,
+                                  const CoordDataFile::ResultMap& setCoords,
+                                  const std::set<OSMId>& unsetCoords)
+  {
+    std::string                                        filename=AppendFileToDir(path,
+                                                                                CoordDataFile::COORD_DAT);
+    FileScanner                                        scanner;
+    FileWriter                                         writer;
+    std::map<PageId,FileOffset>                        pageOffsets;
+    std::map<PageId,std::map<size_t,const Point*>>     pageChanges;
+    uint32_t                                           pageSize;
+
+    try {
+      FileOffset mapOffset;
+      uint32_t   mapSize;
+
+      scanner.Open(filename,
+                   FileScanner::Sequential,
+                   false);
+
+      scanner.Read(mapOffset);
+      scanner.Read(pageSize);
+
+      scanner.SetPos(mapOffset);
+
+      scanner.Read(mapSize);
+
+      for (uint32_t i=1; i<=mapSize; i++) {
+        PageId     pageId;
+        FileOffset offset;
+
+        scanner.Read(pageId);
+        scanner.Read(offset);
+
+        pageOffsets[pageId]=offset;
+      }
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+
+    for (const auto& entry : setCoords) {
+      PageId relatedId=entry.first+std::numeric_limits<OSMId>::min();
+
+      pageChanges[relatedId/pageSize][relatedId%pageSize]=&entry.second;
+    }
+
+    for (const auto id : unsetCoords) {
+      PageId relatedId=id+std::numeric_limits<OSMId>::min();
+
+      pageChanges[relatedId/pageSize][relatedId%pageSize]=nullptr;
+    }
+
+    try {
+      bool newPages=false;
+
+      writer.OpenExisting(filename);
+
+      for (const auto& pageChange : pageChanges) {
+        auto pageOffset=pageOffsets.find(pageChange.first);
+
+        if (pageOffset==pageOffsets.end()) {
+          bool somethingToStore=std::any_of(pageChange.second.begin(),
+                                            pageChange.second.end(),
+                                            [](const std::pair<const size_t,const Point*>& entry) {
+            return entry.second!=nullptr;
+          });
+
+          if (!somethingToStore) {
+            continue;
+          }
+
+          writer.GotoEnd();
+
+          pageOffsets[pageChange.first]=writer.GetPos();
+          newPages=true;
+
+          for (size_t i=0; i<pageSize; i++) {
+            auto entry=pageChange.second.find(i);
+
+            if (entry!=pageChange.second.end() &&
+                entry->second!=nullptr) {
+              writer.Write(entry->second->GetSerial());
+              writer.WriteCoord(entry->second->GetCoord());
+            }
+            else {
+              writer.Write((uint8_t)0);
+              writer.WriteInvalidCoord();
+            }
+          }
+
+          continue;
+        }
+
+        for (const auto& entry : pageChange.second) {
+          writer.SetPos(pageOffset->second+entry.first*(coordByteSize+1));
+
+          if (entry.second!=nullptr) {
+            writer.Write(entry.second->GetSerial());
+            writer.WriteCoord(entry.second->GetCoord());
+          }
+          else {
+            writer.Write((uint8_t)0);
+            writer.WriteInvalidCoord();
+          }
+        }
+      }
+
+      if (newPages) {
+        writer.GotoEnd();
+
+        FileOffset mapOffset=writer.GetPos();
+
+        writer.Write((uint32_t)pageOffsets.size());
+
+        for (const auto& entry : pageOffsets) {
+          writer.Write(entry.first);
+          writer.Write(entry.second);
+        }
+
+        writer.GotoBegin();
+        writer.WriteFileOffset(mapOffset);
+      }
+
+      writer.Close();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Writes the areas of a cell of the rebuilt area index. If the areas of the
+   * cell are still stored without gaps in areas.dat, the existing records are
+   * referenced. Else the areas are copied to the end of areas.dat and the old
+   * records are marked as obsolete.
+   */
+  class AreaCellUpdater : public AreaAreaIndexGenerator::CellDataWriter
+  {
+  private:
+    FileScanner&                                 scanner;
+    FileWriter&                                  dataWriter;
+    const std::unordered_map<FileOffset,size_t>& recordIndexes; //!< Position of each record in areas.dat
+    std::unordered_set<FileOffset>&              obsoleteOffsets;
+    OffsetRemap&                                 remap;
+    uint32_t&                                    copiedCount;
+
+  public:
+    AreaCellUpdater(FileScanner& scanner,
+                    FileWriter& dataWriter,
+                    const std::unordered_map<FileOffset,size_t>& recordIndexes,
+                    std::unordered_set<FileOffset>& obsoleteOffsets,
+                    OffsetRemap& remap,
+                    uint32_t& copiedCount)
+    : scanner(scanner),
+      dataWriter(dataWriter),
+      recordIndexes(recordIndexes),
+      obsoleteOffsets(obsoleteOffsets),
+      remap(remap),
+      copiedCount(copiedCount)
+    {
+      // no code
+    }
+
+    bool IsContinuous(const std::vector<AreaAreaIndexGenerator::CellTypeData>& cellData) const
+    {
+      size_t nextIndex=0;
+      bool   first=true;
+
+      for (const auto& typeData : cellData) {
+        for (const auto offset : typeData.offsets) {
+          size_t index=recordIndexes.at(offset);
+
+          if (!first &&
+              index!=nextIndex) {
+            return false;
+          }
+
+          nextIndex=index+1;
+          first=false;
+        }
+      }
+
+      return true;
+    }
+
+    bool WriteCellData(const TypeConfig& typeConfig,
+                       Progress& /*progress*/,
+                       std::vector<AreaAreaIndexGenerator::CellTypeData>& cellData) override
+    {
+      if (IsContinuous(cellData)) {
+        for (auto& typeData : cellData) {
+          typeData.dataStartOffset=typeData.offsets.front();
+          typeData.dataCount=(uint32_t)typeData.offsets.size();
+        }
+
+        return true;
+      }
+
+      for (auto& typeData : cellData) {
+        typeData.dataStartOffset=0;
+        typeData.dataCount=0;
+
+        for (const auto srcOffset : typeData.offsets) {
+          Area area;
+
+          scanner.SetPos(srcOffset);
+
+          area.Read(typeConfig,
+                    scanner);
+
+          FileOffset dstOffset=dataWriter.GetPos();
+
+          area.Write(typeConfig,
+                     dataWriter);
+
+          if (typeData.dataStartOffset==0) {
+            typeData.dataStartOffset=dstOffset;
+          }
+
+          typeData.dataCount++;
+
+          obsoleteOffsets.insert(srcOffset);
+          remap[srcOffset]=dstOffset;
+          copiedCount++;
+        }
+      }
+
+      return true;
+    }
+  };
+
+  /**
+   * Rebuild areaarea.idx from areas.dat, skipping obsolete records. The maximum
+   * level of the index is taken from the existing index.
+   */
+  static bool RebuildAreaAreaIndex(const TypeConfig& typeConfig,
+                                   const ImportParameter& parameter,
+                                   Progress& progress,
+                                   DatabaseUpdateState& state,
+                                   OffsetRemap& remap)
+  {
+    std::string                                  dataFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                                              AreaDataFile::AREAS_DAT);
+    std::string                                  indexFilename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                                               AreaAreaIndex::AREA_AREA_IDX);
+    std::string                                  tmpIndexFilename=indexFilename+".tmp";
+    FileScanner                                  scanner;
+    FileWriter                                   dataWriter;
+    FileWriter                                   indexWriter;
+    std::vector<AreaAreaIndexGenerator::Level>   levels;
+    std::unordered_map<FileOffset,size_t>        recordIndexes;
+
+    progress.SetAction("Rebuilding area index");
+
+    try {
+      uint32_t maxLevel;
+      uint32_t areaCount;
+      uint32_t copiedCount=0;
+      uint32_t writtenCount=0;
+
+      scanner.Open(indexFilename,
+                   FileScanner::Sequential,
+                   false);
+
+      scanner.ReadNumber(maxLevel);
+
+      scanner.Close();
+
+      levels.resize(maxLevel+1);
+
+      scanner.Open(dataFilename,
+                   FileScanner::LowMemRandom,
+                   false);
+
+      scanner.Read(areaCount);
+
+      for (uint32_t a=0; a<areaCount; a++) {
+        FileOffset offset=scanner.GetPos();
+        Area       area;
+
+        progress.SetProgress(a,areaCount);
+
+        area.Read(typeConfig,
+                  scanner);
+
+        recordIndexes[offset]=a;
+
+        if (state.obsoleteAreaOffsets.find(offset)==state.obsoleteAreaOffsets.end()) {
+          AreaAreaIndexGenerator::AddArea(levels,
+                                          area,
+                                          offset);
+        }
+      }
+
+      AreaAreaIndexGenerator::EnrichLevels(levels);
+
+      dataWriter.OpenExisting(dataFilename);
+      dataWriter.GotoEnd();
+
+      indexWriter.Open(tmpIndexFilename);
+
+      AreaCellUpdater cellUpdater(scanner,
+                                  dataWriter,
+                                  recordIndexes,
+                                  state.obsoleteAreaOffsets,
+                                  remap,
+                                  copiedCount);
+
+      if (!AreaAreaIndexGenerator::WriteIndex(typeConfig,
+                                              progress,
+                                              parameter.GetSortHilbertOrder(),
+                                              indexWriter,
+                                              levels,
+                                              cellUpdater,
+                                              writtenCount)) {
+        scanner.CloseFailsafe();
+        dataWriter.CloseFailsafe();
+        indexWriter.CloseFailsafe();
+
+        return false;
+      }
+
+      dataWriter.SetPos(0);
+      dataWriter.Write(areaCount+copiedCount);
+
+      progress.Info(std::to_string(copiedCount)+" area(s) of changed index cells copied");
+
+      scanner.Close();
+      dataWriter.Close();
+      indexWriter.Close();
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      scanner.CloseFailsafe();
+      dataWriter.CloseFailsafe();
+      indexWriter.CloseFailsafe();
+
+      return false;
+    }
+
+    return RemoveFile(indexFilename) &&
+           RenameFile(tmpIndexFilename,
+                      indexFilename);
+  }
+
+  /**
+   * Apply the change to the database. Returns false on error. The database
+   * might be left in an inconsistent state in this case and has to be
+   * imported again.
+   */
+  bool DatabaseUpdater::Update(const TypeConfigRef& typeConfig,
+                               const ImportParameter& parameter,
+                               Progress& progress,
+                               const OSMChange& change,
+                               const DatabaseUpdatePlan& plan) const
+  {
+    const std::string&                  directory=parameter.GetDestinationDirectory();
+    DatabaseUpdateState                 state;
+    TypeConfig                          databaseTypeConfig;
+    UpdateTagErrorReporter              errorReporter(progress);
+    LocationFeatureValueReader          locationReader(*typeConfig);
+    PostalCodeFeatureValueReader        postalCodeReader(*typeConfig);
+    std::vector<UpdatedObject<Node>>    nodes;
+    std::vector<UpdatedObject<Way>>     ways;
+    std::vector<UpdatedObject<Area>>    areas;
+    OffsetRemap                         nodeRemap;
+    OffsetRemap                         wayRemap;
+    OffsetRemap                         areaRemap;
+
+    if (plan.fullRebuild) {
+      progress.Error("Change requires a full import: "+plan.reason);
+      return false;
+    }
+
+    if (change.IsEmpty()) {
+      return true;
+    }
+
+    progress.SetAction("Updating database");
+
+    if (!state.Load(directory)) {
+      progress.Error(std::string("Cannot read '")+DatabaseUpdateState::UPDATE_DAT+"'");
+      return false;
+    }
+
+    if (!databaseTypeConfig.LoadFromDataFile(directory)) {
+      progress.Error("Cannot load type configuration from '"+directory+"'");
+      return false;
+    }
+
+    if (!IsDatabaseTypeConfig(*typeConfig,
+                              databaseTypeConfig)) {
+      progress.Error("Type configuration does not match the type configuration of the database");
+      return false;
+    }
+
+    //
+    // Resolve the old and new coordinates of all involved nodes
+    //
+
+    CoordDataFile::ResultMap oldCoords;
+    CoordDataFile::ResultMap newCoords;
+    std::set<OSMId>          deletedNodes;
+    std::set<OSMId>          oldCoordIds;
+
+    for (const auto& node : change.nodes) {
+      if (node.action!=OSMChange::actionCreate) {
+        oldCoordIds.insert(node.id);
+      }
+    }
+
+    for (const auto& way : change.ways) {
+      oldCoordIds.insert(way.nodes.begin(),
+                         way.nodes.end());
+    }
+
+    CoordDataFile coordDataFile;
+
+    if (!coordDataFile.Open(directory,
+                            false) ||
+        !coordDataFile.Get(oldCoordIds,
+                           oldCoords)) {
+      progress.Error(std::string("Cannot read coordinates from '")+CoordDataFile::COORD_DAT+"'");
+      return false;
+    }
+
+    coordDataFile.Close();
+
+    for (const auto& node : change.nodes) {
+      if (node.action==OSMChange::actionDelete) {
+        deletedNodes.insert(node.id);
+        continue;
+      }
+
+      // Keep the serial of nodes that keep their position
+      auto    oldCoord=oldCoords.find(node.id);
+      uint8_t serial=1;
+
+      if (oldCoord!=oldCoords.end() &&
+          oldCoord->second.GetCoord().GetId()==node.coord.GetId()) {
+        serial=oldCoord->second.GetSerial();
+      }
+
+      newCoords[node.id]=Point(serial,
+                               node.coord);
+    }
+
+    CoordDataFile::ResultMap coords(oldCoords);
+
+    for (const auto id : deletedNodes) {
+      coords.erase(id);
+    }
+
+    for (const auto& entry : newCoords) {
+      coords[entry.first]=entry.second;
+    }
+
+    //
+    // The old versions of the changed objects are obsolete
+    //
+
+    for (const auto& entry : plan.affectedObjects) {
+      switch (entry.second.GetType()) {
+      case refNone:
+        break;
+      case refNode:
+        state.obsoleteNodeOffsets.insert(entry.second.GetFileOffset());
+        break;
+      case refWay:
+        state.obsoleteWayOffsets.insert(entry.second.GetFileOffset());
+        break;
+      case refArea:
+        state.obsoleteAreaOffsets.insert(entry.second.GetFileOffset());
+        break;
+      }
+    }
+
+
+    //
+    // Ways and areas using a moved node get the new position, too
+    //
+
+    std::vector<std::pair<Point,Point>> movedPoints;
+
+    for (const auto& node : change.nodes) {
+      auto oldCoord=oldCoords.find(node.id);
+      auto newCoord=newCoords.find(node.id);
+
+      if (node.action==OSMChange::actionModify &&
+          oldCoord!=oldCoords.end() &&
+          newCoord!=newCoords.end() &&
+          oldCoord->second.GetCoord().GetId()!=newCoord->second.GetCoord().GetId()) {
+        movedPoints.emplace_back(oldCoord->second,
+                                 newCoord->second);
+      }
+    }
+
+    if (!movedPoints.empty()) {
+      std::map<FileOffset,Way>  movedWays;
+      std::map<FileOffset,Area> movedAreas;
+
+      if (!LoadObjectsAtPoints(typeConfig,
+                               directory,
+                               movedPoints,
+                               state,
+                               movedWays,
+                               movedAreas)) {
+        progress.Error("Cannot load ways and areas at the positions of moved nodes");
+        return false;
+      }
+
+      for (auto& entry : movedWays) {
+        bool moved=false;
+
+        for (auto& point : entry.second.nodes) {
+          for (const auto& movedPoint : movedPoints) {
+            if (MovePoint(point,
+                          movedPoint.first,
+                          movedPoint.second)) {
+              moved=true;
+              break;
+            }
+          }
+        }
+
+        if (moved) {
+          entry.second.bbox.Invalidate();
+          entry.second.segments.clear();
+
+          ways.push_back(UpdatedObject<Way>{std::move(entry.second),entry.first,ObjectOSMRef(),0});
+        }
+      }
+
+      for (auto& entry : movedAreas) {
+        bool moved=false;
+
+        for (auto& ring : entry.second.rings) {
+          bool ringMoved=false;
+
+          for (auto& point : ring.nodes) {
+            for (const auto& movedPoint : movedPoints) {
+              if (MovePoint(point,
+                            movedPoint.first,
+                            movedPoint.second)) {
+                ringMoved=true;
+                break;
+              }
+            }
+          }
+
+          if (ringMoved) {
+            ring.bbox.Invalidate();
+            ring.segments.clear();
+            moved=true;
+          }
+        }
+
+        if (moved) {
+          areas.push_back(UpdatedObject<Area>{std::move(entry.second),entry.first,ObjectOSMRef(),0});
+        }
+      }
+    }
+
+    //
+    // New versions of the changed nodes and ways
+    //
+
+    for (const auto& nodeChange : change.nodes) {
+      if (nodeChange.action==OSMChange::actionDelete) {
+        continue;
+      }
+
+      TypeInfoRef type=typeConfig->GetNodeType(nodeChange.tags);
+
+      if (type->GetIgnore()) {
+        continue;
+      }
+
+      RawNode rawNode;
+      Node    node;
+
+      rawNode.SetId(nodeChange.id);
+      rawNode.SetType(type);
+      rawNode.SetCoord(nodeChange.coord);
+
+      rawNode.Parse(errorReporter,
+                    typeConfig->GetTagRegistry(),
+                    nodeChange.tags);
+
+      node.SetFeatures(rawNode.GetFeatureValueBuffer());
+      node.SetCoords(rawNode.GetCoords());
+
+      RemoveLocationFeatures(locationReader,
+                             postalCodeReader,
+                             node);
+
+      nodes.push_back(UpdatedObject<Node>{std::move(node),0,ObjectOSMRef(nodeChange.id,osmRefNode),0});
+    }
+
+    std::list<RawWayRef> rawWays;
+
+    for (const auto& wayChange : change.ways) {
+      if (wayChange.action==OSMChange::actionDelete) {
+        continue;
+      }
+
+      RawWayRef rawWay=CreateRawWay(*typeConfig,
+                                    errorReporter,
+                                    wayChange);
+
+      if (!rawWay) {
+        continue;
+      }
+
+      if (!rawWay->IsArea()) {
+        rawWays.push_back(rawWay);
+        continue;
+      }
+
+      Area       area;
+      Area::Ring ring;
+
+      if (rawWay->GetNodeCount()<3 ||
+          !ResolvePoints(progress,
+                         coords,
+                         *rawWay,
+                         ring.nodes)) {
+        continue;
+      }
+
+      if (!IsValidToWrite(ring.nodes)) {
+        progress.Error("Area coordinates are not dense enough to be written for area "+
+                       std::to_string(rawWay->GetId()));
+        return false;
+      }
+
+      if (parameter.GetStrictAreas() &&
+          !AreaIsSimple(ring.nodes)) {
+        progress.Error("Area "+std::to_string(rawWay->GetId())+" of type '"+rawWay->GetType()->GetName()+"' is not simple");
+        continue;
+      }
+
+      ring.SetFeatures(rawWay->GetFeatureValueBuffer());
+      ring.MarkAsOuterRing();
+
+      RemoveLocationFeatures(locationReader,
+                             postalCodeReader,
+                             ring);
+
+      area.rings.push_back(ring);
+
+      areas.push_back(UpdatedObject<Area>{std::move(area),0,ObjectOSMRef(rawWay->GetId(),osmRefWay),0});
+    }
+
+    if (!WayWayDataGenerator::SplitLongWays(progress,
+                                            rawWays,
+                                            coords)) {
+      return false;
+    }
+
+    for (const auto& rawWay : rawWays) {
+      Way way;
+
+      if (!ResolvePoints(progress,
+                         coords,
+                         *rawWay,
+                         way.nodes)) {
+        continue;
+      }
+
+      if (!IsValidToWrite(way.nodes)) {
+        progress.Error("Way coordinates are not dense enough to be written for Way "+
+                       std::to_string(rawWay->GetId())+", skipping");
+        continue;
+      }
+
+      way.SetFeatures(rawWay->GetFeatureValueBuffer());
+
+      ways.push_back(UpdatedObject<Way>{std::move(way),0,ObjectOSMRef(rawWay->GetId(),osmRefWay),0});
+    }
+
+    //
+    // Append the new objects to the data files
+    //
+
+    progress.SetAction("Writing "+std::to_string(nodes.size())+" node(s), "+
+                       std::to_string(ways.size())+" way(s) and "+
+                       std::to_string(areas.size())+" area(s)");
+
+    if (!AppendObjects(*typeConfig,
+                       AppendFileToDir(directory,
+                                       NodeDataFile::NODES_DAT),
+                       nodes) ||
+        !AppendObjects(*typeConfig,
+                       AppendFileToDir(directory,
+                                       WayDataFile::WAYS_DAT),
+                       ways) ||
+        !AppendObjects(*typeConfig,
+                       AppendFileToDir(directory,
+                                       AreaDataFile::AREAS_DAT),
+                       areas)) {
+      progress.Error("Cannot write data files");
+      return false;
+    }
+
+    std::vector<std::pair<ObjectOSMRef,FileOffset>> newNodeEntries;
+    std::vector<std::pair<ObjectOSMRef,FileOffset>> newWayEntries;
+    std::vector<std::pair<ObjectOSMRef,FileOffset>> newAreaEntries;
+
+    for (const auto& node : nodes) {
+      newNodeEntries.emplace_back(node.osmRef,
+                                  node.newOffset);
+    }
+
+    for (const auto& way : ways) {
+      if (way.oldOffset!=0) {
+        state.obsoleteWayOffsets.insert(way.oldOffset);
+        wayRemap[way.oldOffset]=way.newOffset;
+      }
+      else {
+        newWayEntries.emplace_back(way.osmRef,
+                                   way.newOffset);
+      }
+    }
+
+    for (const auto& area : areas) {
+      if (area.oldOffset!=0) {
+        state.obsoleteAreaOffsets.insert(area.oldOffset);
+        areaRemap[area.oldOffset]=area.newOffset;
+      }
+      else {
+        newAreaEntries.emplace_back(area.osmRef,
+                                    area.newOffset);
+      }
+    }
+
+    //
+    // Rebuild the area indexes
+    //
+
+    AreaNodeIndexGenerator areaNodeIndexGenerator;
+    AreaWayIndexGenerator  areaWayIndexGenerator;
+
+    areaNodeIndexGenerator.SetObsoleteOffsets(state.obsoleteNodeOffsets);
+    areaWayIndexGenerator.SetObsoleteOffsets(state.obsoleteWayOffsets);
+
+    if (!areaNodeIndexGenerator.Import(typeConfig,
+                                       parameter,
+                                       progress) ||
+        !areaWayIndexGenerator.Import(typeConfig,
+                                      parameter,
+                                      progress) ||
+        !RebuildAreaAreaIndex(*typeConfig,
+                              parameter,
+                              progress,
+                              state,
+                              areaRemap)) {
+      progress.Error("Cannot rebuild area indexes");
+      return false;
+    }
+
+    //
+    // Id mapping files, coordinates and the update state
+    //
+
+    progress.SetAction("Updating id mapping files and coordinates");
+
+    if (!UpdateIdMap(AppendFileToDir(directory,
+                                     NodeDataFile::NODES_IDMAP),
+                     plan.changedObjects,
+                     nodeRemap,
+                     newNodeEntries) ||
+        !UpdateIdMap(AppendFileToDir(directory,
+                                     WayDataFile::WAYS_IDMAP),
+                     plan.changedObjects,
+                     wayRemap,
+                     newWayEntries) ||
+        !UpdateIdMap(AppendFileToDir(directory,
+                                     AreaDataFile::AREAS_IDMAP),
+                     plan.changedObjects,
+                     areaRemap,
+                     newAreaEntries)) {
+      progress.Error("Cannot update id mapping files");
+      return false;
+    }
+
+    if (!UpdateCoordDataFile(directory,
+                             newCoords,
+                             deletedNodes)) {
+      progress.Error(std::string("Cannot update '")+CoordDataFile::COORD_DAT+"'");
+      return false;
+    }
+
+    if (!state.Store(directory)) {
+      progress.Error(std::string("Cannot write '")+DatabaseUpdateState::UPDATE_DAT+"'");
+      return false;
+    }
+
+    return true;
+  }
+}
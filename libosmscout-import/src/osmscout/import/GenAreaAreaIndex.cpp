@@ -19,6 +19,8 @@
 
 #include <osmscout/import/GenAreaAreaIndex.h>
 
+#include <algorithm>
+#include <array>
 #include <vector>
 
 #include <osmscout/TypeFeatures.h>
@@ -229,6 +231,7 @@ namespace osmscout {
   {
   private:
     std::vector<Point> nodeBuffer;
+    bool               reduceNodes;
     size_t             duplicateCount;
     size_t             redundantCount;
     size_t             overallCount;
@@ -262,10 +265,13 @@ namespace osmscout {
                             const TypeConfig& typeConfig) override;
   };
 
-  bool AreaNodeReductionProcessorFilter::BeforeProcessingStart(const ImportParameter& /*parameter*/,
+  bool AreaNodeReductionProcessorFilter::BeforeProcessingStart(const ImportParameter& parameter,
                                                                Progress& /*progress*/,
                                                                const TypeConfig& /*typeConfig*/)
   {
+    // Updatable databases keep all nodes, since a later update moving a node
+    // must be able to find it in all objects using it
+    reduceNodes=!parameter.IsUpdatable();
     duplicateCount=0;
     redundantCount=0;
     overallCount=0;
@@ -424,6 +430,10 @@ namespace osmscout {
       overallCount+=ring.nodes.size();
     }
 
+    if (!reduceNodes) {
+      return true;
+    }
+
     if (!RemoveDuplicateNodes(progress,
                               offset,
                               area,
@@ -524,10 +534,112 @@ namespace osmscout {
     description.AddProvidedDebuggingFile(AreaDataFile::AREAS_IDMAP);
   }
 
-  size_t AreaAreaIndexGenerator::CalculateLevel(const ImportParameter& parameter,
-                                                const GeoBox& boundingBox) const
+  /**
+   * Copies areas from the areas3.tmp import file to the final data file,
+   * applies the processing filters and writes the id mapping file.
+   */
+  class AreaDataCopier : public AreaAreaIndexGenerator::CellDataWriter
+  {
+  private:
+    const std::list<SortDataGenerator<Area>::ProcessingFilterRef>& filters;
+    FileScanner&                                                   scanner;
+    FileWriter&                                                    dataWriter;
+    FileWriter&                                                    mapWriter;
+
+  public:
+    AreaDataCopier(const std::list<SortDataGenerator<Area>::ProcessingFilterRef>& filters,
+                   FileScanner& scanner,
+                   FileWriter& dataWriter,
+                   FileWriter& mapWriter);
+
+    bool WriteCellData(const TypeConfig& typeConfig,
+                       Progress& progress,
+                       std::vector<AreaAreaIndexGenerator::CellTypeData>& cellData) override;
+  };
+
+  AreaDataCopier::AreaDataCopier(const std::list<SortDataGenerator<Area>::ProcessingFilterRef>& filters,
+                                 FileScanner& scanner,
+                                 FileWriter& dataWriter,
+                                 FileWriter& mapWriter)
+  : filters(filters),
+    scanner(scanner),
+    dataWriter(dataWriter),
+    mapWriter(mapWriter)
+  {
+    // no code
+  }
+
+  bool AreaDataCopier::WriteCellData(const TypeConfig& typeConfig,
+                                     Progress& progress,
+                                     std::vector<AreaAreaIndexGenerator::CellTypeData>& cellData)
   {
-    size_t indexLevel=parameter.GetAreaAreaIndexMaxMag();
+    for (auto& typeData : cellData) {
+      typeData.dataStartOffset=0;
+      typeData.dataCount=0;
+
+      for (FileOffset srcOffset : typeData.offsets) {
+        uint8_t    objectType;
+        Id         id;
+        Area       area;
+        FileOffset dstOffset;
+        bool       save=true;
+
+        scanner.SetPos(srcOffset);
+
+        scanner.Read(objectType);
+        scanner.Read(id);
+
+        area.Read(typeConfig,
+                  scanner);
+
+        dstOffset=dataWriter.GetPos();
+
+        for (const auto& filter : filters) {
+          if (!filter->Process(progress,
+                               dstOffset,
+                               area,
+                               save)) {
+            progress.Error(std::string("Error while processing data entry to file '")+
+                           dataWriter.GetFilename()+"'");
+
+            return false;
+          }
+
+          if (!save) {
+            break;
+          }
+        }
+
+        if (!save) {
+          continue;
+        }
+
+        if (typeData.dataStartOffset==0) {
+          typeData.dataStartOffset=dstOffset;
+        }
+
+        area.Write(typeConfig,
+                   dataWriter);
+
+        mapWriter.Write(id);
+        mapWriter.Write(objectType);
+        mapWriter.WriteFileOffset(dstOffset);
+
+        typeData.dataCount++;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the highest level below or equal to maxLevel, where the given
+   * bounding box completely fits into the cell size.
+   */
+  size_t AreaAreaIndexGenerator::CalculateLevel(size_t maxLevel,
+                                                const GeoBox& boundingBox)
+  {
+    size_t indexLevel=maxLevel;
 
     while (true) {
       if (boundingBox.GetWidth()<=cellDimension[indexLevel].width &&
@@ -545,6 +657,35 @@ namespace osmscout {
     return indexLevel;
   }
 
+  /**
+   * Add the area at the given offset to the in memory index. The maximum level
+   * of the index is given by the size of levels.
+   */
+  void AreaAreaIndexGenerator::AddArea(std::vector<Level>& levels,
+                                       const Area& area,
+                                       FileOffset offset)
+  {
+    GeoBox boundingBox=area.GetBoundingBox();
+
+    GeoCoord center=boundingBox.GetCenter();
+
+    //
+    // Calculate highest level where the bounding box completely
+    // fits in the cell size and assign area to the tiles that
+    // hold the geometric center of the tile.
+    //
+
+    size_t level=CalculateLevel(levels.size()-1,boundingBox);
+
+    // Calculate index of tile that contains the geometric center of the area
+    uint32_t x=(uint32_t)((center.GetLon()+180.0)/cellDimension[level].width);
+    uint32_t y=(uint32_t)((center.GetLat()+90.0)/cellDimension[level].height);
+
+    Entry entry{offset,area.GetType()->GetAreaId()};
+
+    levels[level][Pixel(x,y)].areas.push_back(entry);
+  }
+
   /**
    * Assure that there is a parent cell in the parent level for
    * each cell in a given level.
@@ -564,177 +705,61 @@ namespace osmscout {
     }
   }
 
-  bool AreaAreaIndexGenerator::CopyData(const TypeConfig& typeConfig,
-                                        Progress& progress,
-                                        FileScanner& scanner,
-                                        FileWriter& dataWriter,
-                                        FileWriter& mapWriter,
-                                        const std::list<FileOffset>& srcOffsets,
-                                        FileOffset& dataStartOffset,
-                                        uint32_t& dataWrittenCount)
-  {
-    dataStartOffset=0;
-
-    for (FileOffset srcOffset : srcOffsets) {
-      uint8_t    objectType;
-      Id         id;
-      Area       area;
-      FileOffset dstOffset;
-      bool       save=true;
-
-      scanner.SetPos(srcOffset);
-
-      scanner.Read(objectType);
-      scanner.Read(id);
-
-      area.Read(typeConfig,
-                scanner);
-
-      //  std::cout << (size_t)objectType << " " << id << " " << area.GetType()->GetName() << " " << area.GetType()->GetIndex() << std::endl;
-
-      dstOffset=dataWriter.GetPos();
-
-      for (const auto& filter : filters) {
-        if (!filter->Process(progress,
-                             dstOffset,
-                             area,
-                             save)) {
-          progress.Error(std::string("Error while processing data entry to file '")+
-                         dataWriter.GetFilename()+"'");
-
-          return false;
-        }
-
-        if (!save) {
-          break;
-        }
-      }
-
-      if (!save) {
-        continue;
-      }
-
-      if (dataStartOffset==0) {
-        dataStartOffset=dstOffset;
-      }
-
-      area.Write(typeConfig,
-                 dataWriter);
-
-      mapWriter.Write(id);
-      mapWriter.Write(objectType);
-      mapWriter.WriteFileOffset(dstOffset);
-
-      dataWrittenCount++;
-    }
-
-    return true;
-  }
-
   bool AreaAreaIndexGenerator::WriteChildCells(const TypeConfig& typeConfig,
                                                Progress& progress,
-                                               const ImportParameter& parameter,
-                                               FileScanner& scanner,
+                                               bool hilbertOrder,
                                                FileWriter& indexWriter,
-                                               FileWriter& dataWriter,
-                                               FileWriter& mapWriter,
+                                               CellDataWriter& cellDataWriter,
                                                const std::vector<Level>& levels,
                                                size_t level,
                                                const Pixel& pixel,
                                                FileOffset& offset,
                                                uint32_t& dataWrittenCount)
   {
-    Pixel      topLeftPixel(pixel.x*2,pixel.y*2+1);
-    FileOffset topLeftOffset=0;
-
-    auto topLeftCell=levels[level+1].find(topLeftPixel);
-
-    if (topLeftCell!=levels[level+1].end()) {
-      if (!WriteCell(typeConfig,
-                     progress,
-                     parameter,
-                     scanner,
-                     indexWriter,
-                     dataWriter,
-                     mapWriter,
-                     levels,
-                     level+1,
-                     topLeftPixel,
-                     topLeftCell->second,
-                     topLeftOffset,
-                     dataWrittenCount)) {
-        return false;
-      }
+    // Order of the children in the index: top left, top right, bottom left, bottom right
+    std::array<Pixel,4>      childPixels={Pixel(pixel.x*2,pixel.y*2+1),
+                                          Pixel(pixel.x*2+1,pixel.y*2+1),
+                                          Pixel(pixel.x*2,pixel.y*2),
+                                          Pixel(pixel.x*2+1,pixel.y*2)};
+    std::array<FileOffset,4> childOffsets={0,0,0,0};
+    std::array<size_t,4>     childOrder={0,1,2,3};
+
+    // The index stores explicit offsets for the children, so we are free to
+    // write the data of the children in a different order. Following the Hilbert
+    // curve, the data of neighbouring cells is placed near to each other in the file.
+    if (hilbertOrder) {
+      std::sort(childOrder.begin(),
+                childOrder.end(),
+                [&childPixels,level](size_t a, size_t b) {
+        return GetHilbertIndex(childPixels[a].x,childPixels[a].y,uint32_t(level+1))<
+               GetHilbertIndex(childPixels[b].x,childPixels[b].y,uint32_t(level+1));
+      });
     }
 
-    Pixel      topRightPixel(pixel.x*2+1,pixel.y*2+1);
-    FileOffset topRightOffset=0;
-
-    auto topRightCell=levels[level+1].find(topRightPixel);
-
-    if (topRightCell!=levels[level+1].end()) {
-      if (!WriteCell(typeConfig,
-                     progress,
-                     parameter,
-                     scanner,
-                     indexWriter,
-                     dataWriter,
-                     mapWriter,
-                     levels,
-                     level+1,
-                     topRightPixel,
-                     topRightCell->second,
-                     topRightOffset,
-                     dataWrittenCount)) {
-        return false;
+    for (size_t child : childOrder) {
+      auto childCell=levels[level+1].find(childPixels[child]);
+
+      if (childCell!=levels[level+1].end()) {
+        if (!WriteCell(typeConfig,
+                       progress,
+                       hilbertOrder,
+                       indexWriter,
+                       cellDataWriter,
+                       levels,
+                       level+1,
+                       childPixels[child],
+                       childCell->second,
+                       childOffsets[child],
+                       dataWrittenCount)) {
+          return false;
+        }
       }
     }
 
-    Pixel      bottomLeftPixel(pixel.x*2,pixel.y*2);
-    FileOffset bottomLeftOffset=0;
-
-    auto bottomLeftCell=levels[level+1].find(bottomLeftPixel);
-
-    if (bottomLeftCell!=levels[level+1].end()) {
-      if (!WriteCell(typeConfig,
-                     progress,
-                     parameter,
-                     scanner,
-                     indexWriter,
-                     dataWriter,
-                     mapWriter,
-                     levels,
-                     level+1,
-                     bottomLeftPixel,
-                     bottomLeftCell->second,
-                     bottomLeftOffset,
-                     dataWrittenCount)) {
-        return false;
-      }
-    }
-
-    Pixel      bottomRightPixel(pixel.x*2+1,pixel.y*2);
-    FileOffset bottomRightOffset=0;
-
-    auto bottomRightCell=levels[level+1].find(bottomRightPixel);
-
-    if (bottomRightCell!=levels[level+1].end()) {
-      if (!WriteCell(typeConfig,
-                     progress,
-                     parameter,
-                     scanner,
-                     indexWriter,
-                     dataWriter,
-                     mapWriter,
-                     levels,
-                     level+1,
-                     bottomRightPixel,
-                     bottomRightCell->second,
-                     bottomRightOffset,
-                     dataWrittenCount)) {
-        return false;
-      }
-    }
+    FileOffset topLeftOffset=childOffsets[0];
+    FileOffset topRightOffset=childOffsets[1];
+    FileOffset bottomLeftOffset=childOffsets[2];
+    FileOffset bottomRightOffset=childOffsets[3];
 
     offset=indexWriter.GetPos();
 
@@ -767,11 +792,9 @@ namespace osmscout {
 
   bool AreaAreaIndexGenerator::WriteCell(const TypeConfig& typeConfig,
                                          Progress& progress,
-                                         const ImportParameter& parameter,
-                                         FileScanner& scanner,
+                                         bool hilbertOrder,
                                          FileWriter& indexWriter,
-                                         FileWriter& dataWriter,
-                                         FileWriter& mapWriter,
+                                         CellDataWriter& cellDataWriter,
                                          const std::vector<Level>& levels,
                                          size_t level,
                                          const Pixel& pixel,
@@ -779,14 +802,12 @@ namespace osmscout {
                                          FileOffset& dataStartOffset,
                                          uint32_t& dataWrittenCount)
   {
-    if (level<parameter.GetAreaAreaIndexMaxMag()) {
+    if (level+1<levels.size()) {
       if (!WriteChildCells(typeConfig,
                            progress,
-                           parameter,
-                           scanner,
+                           hilbertOrder,
                            indexWriter,
-                           dataWriter,
-                           mapWriter,
+                           cellDataWriter,
                            levels,
                            level,
                            pixel,
@@ -805,37 +826,94 @@ namespace osmscout {
       offsetsTypeMap[entry.type].push_back(entry.offset);
     }
 
+    std::vector<CellTypeData> cellData;
+
+    cellData.reserve(offsetsTypeMap.size());
+
+    for (auto& entry : offsetsTypeMap) {
+      cellData.push_back(CellTypeData{entry.first,std::move(entry.second),0,0});
+    }
+
+    // Note, that if we optimize everything away, we are left here with dataStartOffset==0
+    // The index reading code has to handle this!
+    if (!cellDataWriter.WriteCellData(typeConfig,
+                                      progress,
+                                      cellData)) {
+      return false;
+    }
+
     // Number of types
-    indexWriter.WriteNumber((uint32_t)offsetsTypeMap.size());
+    indexWriter.WriteNumber((uint32_t)cellData.size());
 
     FileOffset prevObjectStartOffset=0;
 
-    for (const auto& entry : offsetsTypeMap) {
-      FileOffset objectStartOffset=0;
-
-      // Note, that if we optimize everything away, we are left here with objectStartOffset==0
-      // The index reading code has to handle this!
-      CopyData(typeConfig,
-               progress,
-               scanner,
-               dataWriter,
-               mapWriter,
-               entry.second,
-               objectStartOffset,
-               dataWrittenCount);
-
-      indexWriter.WriteTypeId(entry.first,typeConfig.GetAreaTypeIdBytes());
-      indexWriter.WriteNumber((uint32_t)entry.second.size());
-      indexWriter.WriteNumber(objectStartOffset-prevObjectStartOffset);
-
-      prevObjectStartOffset=objectStartOffset;
+    // Filters may drop objects, so we store the number of actually written objects.
+    // Data of all types of a cell is thus stored without gaps in the data file.
+    for (const auto& typeData : cellData) {
+      indexWriter.WriteTypeId(typeData.type,typeConfig.GetAreaTypeIdBytes());
+      indexWriter.WriteNumber(typeData.dataCount);
+      indexWriter.WriteNumber(typeData.dataStartOffset-prevObjectStartOffset);
+
+      prevObjectStartOffset=typeData.dataStartOffset;
+
+      dataWrittenCount+=typeData.dataCount;
     }
 
     return !indexWriter.HasError();
   }
 
+  /**
+   * Write the area index for the given in memory index. The maximum level of
+   * the index is given by the size of levels. The data of the areas of each cell
+   * is written using the given CellDataWriter, the number of written areas is
+   * added to dataWrittenCount.
+   *
+   * @throws IOException
+   */
+  bool AreaAreaIndexGenerator::WriteIndex(const TypeConfig& typeConfig,
+                                          Progress& progress,
+                                          bool hilbertOrder,
+                                          FileWriter& indexWriter,
+                                          const std::vector<Level>& levels,
+                                          CellDataWriter& cellDataWriter,
+                                          uint32_t& dataWrittenCount)
+  {
+    FileOffset topLevelOffset=0;
+    FileOffset topLevelOffsetOffset; // Offset of the top level entry
+
+    indexWriter.WriteNumber((uint32_t)(levels.size()-1)); // MaxMag
+
+    topLevelOffsetOffset=indexWriter.GetPos();
+
+    // This is not the final value, that will be written later on
+    indexWriter.WriteFileOffset(topLevelOffset);
+
+    auto topLevelCell=levels[0].find(Pixel(0,0));
+
+    if (!WriteCell(typeConfig,
+                   progress,
+                   hilbertOrder,
+                   indexWriter,
+                   cellDataWriter,
+                   levels,
+                   0,
+                   Pixel(0,0),
+                   topLevelCell!=levels[0].end() ? topLevelCell->second : AreaLeaf(),
+                   topLevelOffset,
+                   dataWrittenCount)) {
+      return false;
+    }
+
+    FileOffset endOffset=indexWriter.GetPos();
+
+    indexWriter.SetPos(topLevelOffsetOffset);
+    indexWriter.WriteFileOffset(topLevelOffset);
+    indexWriter.SetPos(endOffset);
+
+    return true;
+  }
+
   bool AreaAreaIndexGenerator::BuildInMemoryIndex(const TypeConfigRef& typeConfig,
-                                                  const ImportParameter& parameter,
                                                   Progress& progress,
                                                   FileScanner& scanner,
                                                   std::vector<Level>& levels)
@@ -861,25 +939,9 @@ namespace osmscout {
 
       area.Read(*typeConfig,scanner);
 
-      GeoBox boundingBox=area.GetBoundingBox();
-
-      GeoCoord center=boundingBox.GetCenter();
-
-      //
-      // Calculate highest level where the bounding box completely
-      // fits in the cell size and assign area to the tiles that
-      // hold the geometric center of the tile.
-      //
-
-      size_t level=CalculateLevel(parameter,boundingBox);
-
-      // Calculate index of tile that contains the geometric center of the area
-      uint32_t x=(uint32_t)((center.GetLon()+180.0)/cellDimension[level].width);
-      uint32_t y=(uint32_t)((center.GetLat()+90.0)/cellDimension[level].height);
-
-      Entry entry{offset,area.GetType()->GetAreaId()};
-
-      levels[level][Pixel(x,y)].areas.push_back(entry);
+      AddArea(levels,
+              area,
+              offset);
     }
 
     return true;
@@ -906,7 +968,6 @@ namespace osmscout {
       levels.resize(parameter.GetAreaAreaIndexMaxMag()+1);
 
       if (!BuildInMemoryIndex(typeConfig,
-                              parameter,
                               progress,
                               scanner,
                               levels)) {
@@ -929,21 +990,11 @@ namespace osmscout {
 
       uint32_t    overallDataCount=0;
 
-      FileOffset topLevelOffset=0;
-      FileOffset topLevelOffsetOffset; // Offset of the top level entry
-
       // Index file
 
       indexWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                        AreaAreaIndex::AREA_AREA_IDX));
 
-      indexWriter.WriteNumber((uint32_t)parameter.GetAreaAreaIndexMaxMag()); // MaxMag
-
-      topLevelOffsetOffset=indexWriter.GetPos();
-
-      // This is not the final value, that will be written later on
-      indexWriter.WriteFileOffset(topLevelOffset);
-
       // Data file
 
       dataWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
@@ -961,27 +1012,21 @@ namespace osmscout {
       progress.SetAction("Writing files '"+indexWriter.GetFilename()+"', '"+dataWriter.GetFilename()+"' and '"+
                          mapWriter.GetFilename()+"'");
 
-      if (!WriteCell(*typeConfig,
-                     progress,
-                     parameter,
-                     scanner,
-                     indexWriter,
-                     dataWriter,
-                     mapWriter,
-                     levels,
-                     0,
-                     Pixel(0,0),
-                     levels[0][Pixel(0,0)],
-                     topLevelOffset,
-                     overallDataCount)) {
+      AreaDataCopier areaDataCopier(filters,
+                                    scanner,
+                                    dataWriter,
+                                    mapWriter);
+
+      if (!WriteIndex(*typeConfig,
+                      progress,
+                      parameter.GetSortHilbertOrder(),
+                      indexWriter,
+                      levels,
+                      areaDataCopier,
+                      overallDataCount)) {
         return false;
       }
 
-      // Finishing index file
-
-      indexWriter.SetPos(topLevelOffsetOffset);
-      indexWriter.WriteFileOffset(topLevelOffset);
-
       // Finishing data file
 
       dataWriter.SetPos(0);
@@ -131,6 +131,16 @@ namespace osmscout {
     return magnification;
   }
 
+  /**
+   * Set the offsets of nodes in the data file, that were replaced by a database
+   * update (see DatabaseUpdater). The records are still part of the data file
+   * but are not indexed anymore.
+   */
+  void AreaNodeIndexGenerator::SetObsoleteOffsets(const std::unordered_set<FileOffset>& obsoleteOffsets)
+  {
+    this->obsoleteOffsets=obsoleteOffsets;
+  }
+
   void AreaNodeIndexGenerator::GetDescription(const ImportParameter& /*parameter*/,
                                             ImportModuleDescription& description) const
   {
@@ -175,6 +185,10 @@ namespace osmscout {
         node.Read(*typeConfig,
                   nodeScanner);
 
+        if (IsObsolete(node.GetFileOffset())) {
+          continue;
+        }
+
         TypeId typeId=node.GetType()->GetNodeId();
 
         data[typeId].type=node.GetType();
@@ -584,6 +598,10 @@ namespace osmscout {
         node.Read(*typeConfig,
                   nodeScanner);
 
+        if (IsObsolete(node.GetFileOffset())) {
+          continue;
+        }
+
         auto typeId=node.GetType()->GetNodeId();
 
         if (!data[typeId].IsComplexIndex()) {
@@ -626,6 +644,10 @@ namespace osmscout {
         node.Read(*typeConfig,
                   nodeScanner);
 
+        if (IsObsolete(node.GetFileOffset())) {
+          continue;
+        }
+
         auto typeId=node.GetType()->GetNodeId();
 
         if (!data[typeId].IsComplexIndex()) {
@@ -48,6 +48,16 @@ namespace osmscout {
     // no code
   }
 
+  /**
+   * Set the offsets of ways in the data file, that were replaced by a database
+   * update (see DatabaseUpdater). The records are still part of the data file
+   * but are not indexed anymore.
+   */
+  void AreaWayIndexGenerator::SetObsoleteOffsets(const std::unordered_set<FileOffset>& obsoleteOffsets)
+  {
+    this->obsoleteOffsets=obsoleteOffsets;
+  }
+
   void AreaWayIndexGenerator::GetDescription(const ImportParameter& /*parameter*/,
                                               ImportModuleDescription& description) const
   {
@@ -196,11 +206,14 @@ namespace osmscout {
         for (uint32_t w=1; w<=wayCount; w++) {
           progress.SetProgress(w,wayCount);
 
+          FileOffset offset=wayScanner.GetPos();
+
           way.Read(typeConfig,
                    wayScanner);
 
           // Count number of entries per current type and coordinate
-          if (!currentWayTypes.IsSet(way.GetType())) {
+          if (!currentWayTypes.IsSet(way.GetType()) ||
+              IsObsolete(offset)) {
             continue;
           }
 
@@ -481,7 +494,8 @@ namespace osmscout {
           way.Read(*typeConfig,
                    wayScanner);
 
-          if (!indexTypes.IsSet(way.GetType())) {
+          if (!indexTypes.IsSet(way.GetType()) ||
+              IsObsolete(offset)) {
             continue;
           }
 
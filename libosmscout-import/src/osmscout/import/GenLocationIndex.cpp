@@ -34,6 +34,7 @@
 #include <osmscout/FeatureReader.h>
 
 #include <osmscout/LocationIndex.h>
+#include <osmscout/RegionRasterIndex.h>
 
 #include <osmscout/AreaDataFile.h>
 #include <osmscout/NodeDataFile.h>
@@ -61,6 +62,7 @@
 namespace osmscout {
 
   static const size_t REGION_INDEX_LEVEL=14;
+  static const uint32_t REGION_RASTER_LEVEL=14;
 
   const char* const LocationIndexGenerator::FILENAME_LOCATION_REGION_TXT  = "location_region.txt";
   const char* const LocationIndexGenerator::FILENAME_LOCATION_FULL_TXT    = "location_full.txt";
@@ -2591,6 +2593,327 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Writes a raster of all regions in the region tree. For each cell of the raster
+   * the regions covering the cell completely and the regions whose boundary
+   * crosses the cell are stored.
+   *
+   * Cells touched by a segment of a ring are boundary cells. All other cells are
+   * either completely inside or completely outside of the ring, this is decided
+   * by a scanline fill at the latitude of the center of the cells of a row.
+   */
+  bool LocationIndexGenerator::WriteRegionRaster(const ImportParameter& parameter,
+                                                 Progress& progress,
+                                                 const Region& rootRegion)
+  {
+    /**
+     * Segment of a top outer ring of a region together with the index of its ring
+     */
+    struct RasterSegment
+    {
+      GeoCoord a;
+      GeoCoord b;
+      size_t   ring;
+    };
+
+    /**
+     * A region while it is rasterized. The segments of its rings are distributed
+     * to the raster rows they touch.
+     */
+    struct RasterRegion
+    {
+      const Region*                           region;
+      uint32_t                                minX;
+      uint32_t                                maxX;
+      uint32_t                                minY;
+      uint32_t                                maxY;
+      std::vector<std::vector<RasterSegment>> rowSegments;
+    };
+
+    typedef std::vector<std::pair<FileOffset,bool>> RasterList;
+
+    // Tolerance in degrees, segments closer to a cell than this also touch the cell
+    const double               tolerance=1e-6;
+    const uint32_t             cellCount=1u << REGION_RASTER_LEVEL;
+    const double               cellWidth=360.0/cellCount;
+    const double               cellHeight=180.0/cellCount;
+
+    std::vector<const Region*> regions;
+    std::vector<RasterRegion>  rasterRegions;
+    Pixel                      minCell(cellCount,cellCount);
+    Pixel                      maxCell(0,0);
+
+    auto cellX=[cellWidth,cellCount](double lon) {
+      return (uint32_t)std::max(0.0,std::min((double)cellCount-1,std::floor((lon+180.0)/cellWidth)));
+    };
+
+    auto cellY=[cellHeight,cellCount](double lat) {
+      return (uint32_t)std::max(0.0,std::min((double)cellCount-1,std::floor((lat+90.0)/cellHeight)));
+    };
+
+    std::list<const Region*> regionsToCollect{&rootRegion};
+
+    while (!regionsToCollect.empty()) {
+      for (const auto& childRegion : regionsToCollect.front()->regions) {
+        regions.push_back(childRegion.get());
+        regionsToCollect.push_back(childRegion.get());
+      }
+
+      regionsToCollect.pop_front();
+    }
+
+    for (const auto& region : regions) {
+      if (region->areas.empty()) {
+        continue;
+      }
+
+      GeoBox       boundingBox=region->GetBoundingBox();
+      RasterRegion rasterRegion;
+
+      rasterRegion.region=region;
+      rasterRegion.minX=cellX(boundingBox.GetMinLon()-tolerance);
+      rasterRegion.maxX=cellX(boundingBox.GetMaxLon()+tolerance);
+      rasterRegion.minY=cellY(boundingBox.GetMinLat()-tolerance);
+      rasterRegion.maxY=cellY(boundingBox.GetMaxLat()+tolerance);
+
+      minCell.x=std::min(minCell.x,rasterRegion.minX);
+      minCell.y=std::min(minCell.y,rasterRegion.minY);
+      maxCell.x=std::max(maxCell.x,rasterRegion.maxX);
+      maxCell.y=std::max(maxCell.y,rasterRegion.maxY);
+
+      rasterRegions.push_back(std::move(rasterRegion));
+    }
+
+    if (rasterRegions.empty()) {
+      minCell=Pixel(0,0);
+      maxCell=Pixel(0,0);
+    }
+
+    std::sort(rasterRegions.begin(),
+              rasterRegions.end(),
+              [](const RasterRegion& a, const RasterRegion& b) {
+                return a.minY<b.minY;
+              });
+
+    uint32_t                                               width=maxCell.x-minCell.x+1;
+    uint32_t                                               height=maxCell.y-minCell.y+1;
+    std::map<RasterList,uint32_t>                          listIndex;
+    std::vector<const RasterList*>                         lists;
+    std::vector<std::vector<std::pair<uint32_t,uint32_t>>> rows(height);
+    std::vector<RasterRegion*>                             activeRegions;
+    size_t                                                 nextRegion=0;
+    size_t                                                 runCount=0;
+
+    // List 0 is the empty list
+    lists.push_back(&listIndex.insert(std::make_pair(RasterList(),0)).first->first);
+
+    for (uint32_t y=minCell.y; y<=maxCell.y; y++) {
+      progress.SetProgress(y-minCell.y,height);
+
+      double lat0=y*cellHeight-90.0;
+      double lat1=lat0+cellHeight;
+      double latCenter=lat0+cellHeight/2;
+
+      // Activate the regions starting in this row, distribute their segments to rows
+      while (nextRegion<rasterRegions.size() &&
+             rasterRegions[nextRegion].minY==y) {
+        RasterRegion& rasterRegion=rasterRegions[nextRegion];
+
+        rasterRegion.rowSegments.resize(rasterRegion.maxY-rasterRegion.minY+1);
+
+        for (size_t r=0; r<rasterRegion.region->areas.size(); r++) {
+          const std::vector<GeoCoord>& ring=rasterRegion.region->areas[r];
+
+          for (size_t i=0; i<ring.size(); i++) {
+            RasterSegment segment{ring[i],ring[(i+1)%ring.size()],r};
+            uint32_t      startY=cellY(std::min(segment.a.GetLat(),segment.b.GetLat())-tolerance);
+            uint32_t      endY=cellY(std::max(segment.a.GetLat(),segment.b.GetLat())+tolerance);
+
+            for (uint32_t sy=std::max(startY,rasterRegion.minY);
+                 sy<=std::min(endY,rasterRegion.maxY);
+                 sy++) {
+              rasterRegion.rowSegments[sy-rasterRegion.minY].push_back(segment);
+            }
+          }
+        }
+
+        // Keep active regions sorted by offset, so that the lists of the cells are sorted, too
+        activeRegions.insert(std::upper_bound(activeRegions.begin(),
+                                              activeRegions.end(),
+                                              &rasterRegion,
+                                              [](const RasterRegion* a, const RasterRegion* b) {
+                                                return a->region->indexOffset<b->region->indexOffset;
+                                              }),
+                             &rasterRegion);
+
+        nextRegion++;
+      }
+
+      std::vector<RasterList> cells(width);
+
+      for (const auto& rasterRegion : activeRegions) {
+        const std::vector<RasterSegment>&     segments=rasterRegion->rowSegments[y-rasterRegion->minY];
+        std::vector<uint8_t>                  state(rasterRegion->maxX-rasterRegion->minX+1,0); // 0: outside, 1: inside, 2: boundary
+        std::vector<std::pair<size_t,double>> crossings;
+
+        for (const auto& segment : segments) {
+          double minLat=std::min(segment.a.GetLat(),segment.b.GetLat());
+          double maxLat=std::max(segment.a.GetLat(),segment.b.GetLat());
+          double minLon;
+          double maxLon;
+
+          if (maxLat-minLat>0.0) {
+            // Clip the segment to the latitude range of the row
+            double deltaLon=segment.b.GetLon()-segment.a.GetLon();
+            double deltaLat=segment.b.GetLat()-segment.a.GetLat();
+            double t0=std::max(0.0,std::min(1.0,(lat0-tolerance-segment.a.GetLat())/deltaLat));
+            double t1=std::max(0.0,std::min(1.0,(lat1+tolerance-segment.a.GetLat())/deltaLat));
+
+            minLon=segment.a.GetLon()+std::min(t0,t1)*deltaLon;
+            maxLon=segment.a.GetLon()+std::max(t0,t1)*deltaLon;
+
+            if (minLon>maxLon) {
+              std::swap(minLon,maxLon);
+            }
+          }
+          else {
+            minLon=std::min(segment.a.GetLon(),segment.b.GetLon());
+            maxLon=std::max(segment.a.GetLon(),segment.b.GetLon());
+          }
+
+          for (uint32_t x=std::max(cellX(minLon-tolerance),rasterRegion->minX);
+               x<=std::min(cellX(maxLon+tolerance),rasterRegion->maxX);
+               x++) {
+            state[x-rasterRegion->minX]=2;
+          }
+
+          if ((segment.a.GetLat()>latCenter)!=(segment.b.GetLat()>latCenter)) {
+            double lon=segment.a.GetLon()+(latCenter-segment.a.GetLat())*(segment.b.GetLon()-segment.a.GetLon())/(segment.b.GetLat()-segment.a.GetLat());
+
+            crossings.emplace_back(segment.ring,lon);
+          }
+        }
+
+        std::sort(crossings.begin(),
+                  crossings.end());
+
+        // Cells with their center between two crossings of the same ring are inside
+        for (size_t c=0; c+1<crossings.size(); c+=2) {
+          if (crossings[c].first!=crossings[c+1].first) {
+            // Odd number of crossings for a ring, can only happen for degenerated rings
+            c--;
+            continue;
+          }
+
+          double startX=std::ceil((crossings[c].second+180.0)/cellWidth-0.5);
+          double endX=std::floor((crossings[c+1].second+180.0)/cellWidth-0.5);
+
+          for (double x=std::max(startX,(double)rasterRegion->minX);
+               x<=std::min(endX,(double)rasterRegion->maxX);
+               x++) {
+            uint8_t& cellState=state[(uint32_t)x-rasterRegion->minX];
+
+            if (cellState==0) {
+              cellState=1;
+            }
+          }
+        }
+
+        for (uint32_t x=rasterRegion->minX; x<=rasterRegion->maxX; x++) {
+          uint8_t cellState=state[x-rasterRegion->minX];
+
+          if (cellState!=0) {
+            cells[x-minCell.x].emplace_back(rasterRegion->region->indexOffset,
+                                            cellState==2);
+          }
+        }
+      }
+
+      // Run length encoding of the row
+      std::vector<std::pair<uint32_t,uint32_t>>& row=rows[y-minCell.y];
+
+      for (uint32_t x=0; x<width; x++) {
+        if (x>0 && cells[x]==cells[x-1]) {
+          continue;
+        }
+
+        auto entry=listIndex.find(cells[x]);
+
+        if (entry==listIndex.end()) {
+          entry=listIndex.insert(std::make_pair(cells[x],(uint32_t)lists.size())).first;
+          lists.push_back(&entry->first);
+        }
+
+        row.emplace_back(x,entry->second);
+      }
+
+      runCount+=row.size();
+
+      // Deactivate regions ending in this row
+      activeRegions.erase(std::remove_if(activeRegions.begin(),
+                                         activeRegions.end(),
+                                         [y](RasterRegion* rasterRegion) {
+                                           if (rasterRegion->maxY==y) {
+                                             rasterRegion->rowSegments.clear();
+                                             rasterRegion->rowSegments.shrink_to_fit();
+
+                                             return true;
+                                           }
+
+                                           return false;
+                                         }),
+                          activeRegions.end());
+    }
+
+    progress.Info(std::to_string(width)+"x"+std::to_string(height)+" cells, "+
+                  std::to_string(lists.size())+" region lists, "+
+                  std::to_string(runCount)+" runs");
+
+    FileWriter writer;
+
+    try {
+      writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                  RegionRasterIndex::REGIONRASTER_IDX));
+
+      writer.Write((uint32_t)REGION_RASTER_LEVEL);
+      writer.Write(minCell.x);
+      writer.Write(minCell.y);
+      writer.Write(maxCell.x);
+      writer.Write(maxCell.y);
+
+      writer.WriteNumber((uint32_t)lists.size());
+
+      for (const auto& list : lists) {
+        writer.WriteNumber((uint32_t)list->size());
+
+        for (const auto& entry : *list) {
+          writer.WriteFileOffset(entry.first);
+          writer.Write(entry.second);
+        }
+      }
+
+      for (const auto& row : rows) {
+        writer.WriteNumber((uint32_t)row.size());
+
+        for (const auto& run : row) {
+          writer.WriteNumber(run.first);
+          writer.WriteNumber(run.second);
+        }
+      }
+
+      writer.Close();
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
   void LocationIndexGenerator::GetDescription(const ImportParameter& /*parameter*/,
                                               ImportModuleDescription& description) const
   {
@@ -2606,6 +2929,7 @@ namespace osmscout {
     description.AddRequiredFile(AreaAreaIndexGenerator::AREAADDRESS_DAT);
 
     description.AddProvidedFile(LocationIndex::FILENAME_LOCATION_IDX);
+    description.AddProvidedFile(RegionRasterIndex::REGIONRASTER_IDX);
 
     description.AddProvidedAnalysisFile(FILENAME_LOCATION_REGION_TXT);
     description.AddProvidedAnalysisFile(FILENAME_LOCATION_FULL_TXT);
@@ -2887,6 +3211,14 @@ namespace osmscout {
                        *rootRegion);
 
       writer.Close();
+
+      progress.SetAction(std::string("Write '")+RegionRasterIndex::REGIONRASTER_IDX+"'");
+
+      if (!WriteRegionRaster(parameter,
+                             progress,
+                             *rootRegion)) {
+        return false;
+      }
     }
     catch (IOException& e) {
       progress.Error(e.GetDescription());
@@ -566,9 +566,12 @@ namespace osmscout {
     FileScanner scanner;
     FileWriter  writer;
 
+    // Areas are not merged for updatable databases, an update must be able
+    // to replace a single OSM way without touching its neighbours
     for (const auto& type : typeConfig->GetTypes()) {
       if (type->CanBeArea() &&
-          type->GetMergeAreas()) {
+          type->GetMergeAreas() &&
+          !parameter.IsUpdatable()) {
         mergeTypes.Set(type);
       }
     }
@@ -0,0 +1,285 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenMultiResolutionGeometry.h>
+
+#include <osmscout/AreaDataFile.h>
+#include <osmscout/WayDataFile.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/Geometry.h>
+
+namespace osmscout {
+
+  /**
+   * Distance in magnification levels between two bands
+   */
+  static const uint32_t bandLevelStep=2;
+
+  /**
+   * Simplified geometry is only stored, if the object gets reduced to at most
+   * this ratio of its original nodes. Else the original geometry is used.
+   */
+  static const double maxNodeRatio=0.75;
+
+  static size_t GetNodeCount(const Way& way)
+  {
+    return way.nodes.size();
+  }
+
+  static size_t GetNodeCount(const Area& area)
+  {
+    size_t count=0;
+
+    for (const auto& ring : area.rings) {
+      count+=ring.nodes.size();
+    }
+
+    return count;
+  }
+
+  static void Simplify(Way& way,
+                       double tolerance)
+  {
+    std::vector<Point> nodes;
+
+    SimplifyPolyline(way.nodes,
+                     tolerance,
+                     false,
+                     nodes);
+
+    way.nodes=std::move(nodes);
+    way.segments.clear();
+    way.bbox.Invalidate();
+  }
+
+  static void Simplify(Area& area,
+                       double tolerance)
+  {
+    for (auto& ring : area.rings) {
+      if (ring.nodes.empty()) {
+        // Master ring
+        continue;
+      }
+
+      std::vector<Point> nodes;
+
+      SimplifyPolyline(ring.nodes,
+                       tolerance,
+                       true,
+                       nodes);
+
+      ring.nodes=std::move(nodes);
+      ring.segments.clear();
+      ring.bbox.Invalidate();
+    }
+  }
+
+  void MultiResolutionGeometryGenerator::GetDescription(const ImportParameter& parameter,
+                                                        ImportModuleDescription& description) const
+  {
+    description.SetName("MultiResolutionGeometryGenerator");
+    description.SetDescription("Simplify geometry of ways and areas for different magnifications");
+
+    if (!parameter.GetGeometryBands()) {
+      return;
+    }
+
+    description.AddRequiredFile(WayDataFile::WAYS_DAT);
+    description.AddRequiredFile(AreaDataFile::AREAS_DAT);
+
+    description.AddProvidedOptionalFile(WayResolutionDataFile::WAYS_RES_DAT);
+    description.AddProvidedOptionalFile(AreaResolutionDataFile::AREAS_RES_DAT);
+  }
+
+  std::vector<MultiResolutionGeometryGenerator::Band> MultiResolutionGeometryGenerator::GetBands(const ImportParameter& parameter) const
+  {
+    std::vector<Band> bands;
+
+    for (uint32_t level=parameter.GetGeometryBandMinMag().Get();
+         level<=parameter.GetGeometryBandMaxMag().Get();
+         level+=bandLevelStep) {
+      Band band;
+
+      // Width of a pixel in degrees for 256 pixel tiles
+      band.level=MagnificationLevel(level);
+      band.tolerance=parameter.GetGeometryBandTolerance()*360.0/(256.0*pow(2.0,level));
+      band.indexOffset=0;
+      band.entryCount=0;
+
+      bands.push_back(band);
+    }
+
+    return bands;
+  }
+
+  template<class N>
+  bool MultiResolutionGeometryGenerator::WriteBands(const TypeConfig& typeConfig,
+                                                    const ImportParameter& parameter,
+                                                    Progress& progress,
+                                                    const std::string& dataFilename,
+                                                    const std::string& resolutionFilename) const
+  {
+    FileScanner       scanner;
+    FileWriter        writer;
+    std::vector<Band> bands=GetBands(parameter);
+
+    try {
+      scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                   dataFilename),
+                   FileScanner::Sequential,
+                   parameter.GetWayDataMemoryMaped());
+
+      writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                  resolutionFilename));
+
+      FileOffset bandTableOffset=0;
+
+      writer.WriteFileOffset(bandTableOffset);
+
+      for (auto& band : bands) {
+        std::vector<std::pair<FileOffset,FileOffset>> index;
+        uint32_t                                      dataCount=0;
+        size_t                                        simplifiedCount=0;
+        size_t                                        originalNodeCount=0;
+        size_t                                        bandNodeCount=0;
+
+        progress.SetAction("Simplifying '"+dataFilename+"' for magnification level "+std::to_string(band.level.Get()));
+
+        scanner.GotoBegin();
+        scanner.Read(dataCount);
+
+        index.reserve(dataCount+1);
+
+        for (uint32_t d=1; d<=dataCount; d++) {
+          N data;
+
+          progress.SetProgress(d,
+                               dataCount);
+
+          data.Read(typeConfig,
+                    scanner);
+
+          size_t nodeCount=GetNodeCount(data);
+
+          originalNodeCount+=nodeCount;
+
+          Simplify(data,
+                   band.tolerance);
+
+          size_t simplifiedNodeCount=GetNodeCount(data);
+
+          if (simplifiedNodeCount>nodeCount*maxNodeRatio) {
+            index.emplace_back(data.GetFileOffset(),0);
+            bandNodeCount+=nodeCount;
+            continue;
+          }
+
+          index.emplace_back(data.GetFileOffset(),
+                             writer.GetPos());
+
+          data.Write(typeConfig,
+                     writer);
+
+          bandNodeCount+=simplifiedNodeCount;
+          simplifiedCount++;
+        }
+
+        // Sentinel, holding the end of the last entry
+        index.emplace_back(scanner.GetPos(),0);
+
+        band.indexOffset=writer.GetPos();
+        band.entryCount=dataCount;
+
+        for (const auto& entry : index) {
+          writer.WriteFileOffset(entry.first);
+          writer.WriteFileOffset(entry.second);
+        }
+
+        progress.Info(std::to_string(simplifiedCount)+" of "+std::to_string(dataCount)+" objects simplified, "+
+                      std::to_string(bandNodeCount)+" of "+std::to_string(originalNodeCount)+" nodes left");
+      }
+
+      bandTableOffset=writer.GetPos();
+
+      writer.Write((uint32_t)bands.size());
+
+      for (const auto& band : bands) {
+        writer.Write(band.level);
+        writer.WriteFileOffset(band.indexOffset);
+        writer.Write(band.entryCount);
+      }
+
+      writer.SetPos(0);
+      writer.WriteFileOffset(bandTableOffset);
+
+      scanner.Close();
+      writer.Close();
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+
+      scanner.CloseFailsafe();
+      writer.CloseFailsafe();
+
+      return false;
+    }
+
+    return true;
+  }
+
+  bool MultiResolutionGeometryGenerator::Import(const TypeConfigRef& typeConfig,
+                                                const ImportParameter& parameter,
+                                                Progress& progress)
+  {
+    if (!parameter.GetGeometryBands()) {
+      progress.Info("Geometry bands are not enabled, skipping");
+
+      // Files of a previous import would not match the new data files
+      for (const auto& filename : {WayResolutionDataFile::WAYS_RES_DAT,
+                                   AreaResolutionDataFile::AREAS_RES_DAT}) {
+        std::string path=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         filename);
+
+        if (ExistsInFilesystem(path) &&
+            !RemoveFile(path)) {
+          progress.Error("Cannot delete outdated file '"+path+"'");
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    return WriteBands<Way>(*typeConfig,
+                           parameter,
+                           progress,
+                           WayDataFile::WAYS_DAT,
+                           WayResolutionDataFile::WAYS_RES_DAT) &&
+           WriteBands<Area>(*typeConfig,
+                            parameter,
+                            progress,
+                            AreaDataFile::AREAS_DAT,
+                            AreaResolutionDataFile::AREAS_RES_DAT);
+  }
+}
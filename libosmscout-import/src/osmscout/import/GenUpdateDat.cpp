@@ -0,0 +1,118 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenUpdateDat.h>
+
+#include <algorithm>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+
+#include <osmscout/import/DatabaseUpdate.h>
+#include <osmscout/import/Preprocess.h>
+#include <osmscout/import/RawRelation.h>
+
+namespace osmscout {
+
+  void UpdateDataGenerator::GetDescription(const ImportParameter& parameter,
+                                           ImportModuleDescription& description) const
+  {
+    description.SetName("UpdateDataGenerator");
+    description.SetDescription("Generate state for incremental updates");
+
+    if (parameter.IsUpdatable()) {
+      description.AddRequiredFile(Preprocess::RAWRELS_DAT);
+    }
+
+    description.AddProvidedOptionalFile(DatabaseUpdateState::UPDATE_DAT);
+  }
+
+  bool UpdateDataGenerator::Import(const TypeConfigRef& typeConfig,
+                                   const ImportParameter& parameter,
+                                   Progress& progress)
+  {
+    std::string filename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         DatabaseUpdateState::UPDATE_DAT);
+
+    // A state of a previous import does not match the new data files
+    if (!parameter.IsUpdatable()) {
+      if (ExistsInFilesystem(filename) &&
+          !RemoveFile(filename)) {
+        progress.Error("Cannot remove file '"+filename+"'");
+        return false;
+      }
+
+      return true;
+    }
+
+    progress.SetAction("Generate "+std::string(DatabaseUpdateState::UPDATE_DAT));
+
+    DatabaseUpdateState state;
+    FileScanner         scanner;
+
+    try {
+      uint32_t rawRelationCount=0;
+
+      scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                   Preprocess::RAWRELS_DAT),
+                   FileScanner::Sequential,
+                   true);
+
+      scanner.Read(rawRelationCount);
+
+      for (uint32_t r=1; r<=rawRelationCount; r++) {
+        progress.SetProgress(r,rawRelationCount);
+
+        RawRelation rawRel;
+
+        rawRel.Read(*typeConfig,
+                    scanner);
+
+        for (const auto& member : rawRel.members) {
+          if (member.type==RawRelation::memberWay) {
+            state.relationMemberWays.push_back(member.id);
+          }
+        }
+      }
+
+      scanner.Close();
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+
+    std::sort(state.relationMemberWays.begin(),
+              state.relationMemberWays.end());
+    state.relationMemberWays.erase(std::unique(state.relationMemberWays.begin(),
+                                               state.relationMemberWays.end()),
+                                   state.relationMemberWays.end());
+
+    progress.Info(std::to_string(state.relationMemberWays.size())+" way(s) are members of multipolygon relations");
+
+    if (!state.Store(parameter.GetDestinationDirectory())) {
+      progress.Error("Cannot write file '"+filename+"'");
+      return false;
+    }
+
+    return true;
+  }
+}
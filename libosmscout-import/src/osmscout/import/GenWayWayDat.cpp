@@ -424,9 +424,13 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Split ways with more than 300 nodes or a length of more than 30 km into
+   * shorter segments.
+   */
   bool WayWayDataGenerator::SplitLongWays(Progress& progress,
-                     std::list<RawWayRef>& ways,
-                     CoordDataFile::ResultMap& coordsMap)
+                                          std::list<RawWayRef>& ways,
+                                          CoordDataFile::ResultMap& coordsMap)
   {
     std::list<RawWayRef> newWays;
 
@@ -776,11 +780,14 @@ namespace osmscout {
         // TODO: only print it, if there is something to merge at all
         progress.SetAction("Merging ways");
 
+        // Ways are not merged for updatable databases, an update must be able
+        // to replace a single OSM way without touching its neighbours
 #pragma omp parallel for
         for (int64_t typeIdx = 0; typeIdx<(int64_t)typeConfig->GetTypeCount(); typeIdx++) {
           size_t originalWayCount=waysByType[typeIdx].size();
 
-          if (originalWayCount>0) {
+          if (originalWayCount>0 &&
+              !parameter.IsUpdatable()) {
             MergeWays(progress,
                       waysByType[typeIdx],
                       restrictions);
@@ -67,6 +67,8 @@
 
 #include <osmscout/import/GenOptimizeAreasLowZoom.h>
 #include <osmscout/import/GenOptimizeWaysLowZoom.h>
+#include <osmscout/import/GenMultiResolutionGeometry.h>
+#include <osmscout/import/GenUpdateDat.h>
 
 // Routing
 #include <osmscout/import/GenRouteDat.h>
@@ -77,6 +79,7 @@
 #endif
 
 #include <osmscout/util/MemoryMonitor.h>
+#include <osmscout/util/Tracing.h>
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/StopClock.h>
 
@@ -84,9 +87,9 @@ namespace osmscout {
 
   static const size_t defaultStartStep=1;
 #if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=25;
+  static const size_t defaultEndStep=27;
 #else
-  static const size_t defaultEndStep=24;
+  static const size_t defaultEndStep=26;
 #endif
 
   PreprocessorFactory::~PreprocessorFactory()
@@ -111,7 +114,10 @@ namespace osmscout {
      sortObjects(true),
      sortBlockSize(40000000),
      sortTileMag(14),
+     sortHilbertOrder(false),
      processingQueueSize(std::max((unsigned int)1,std::thread::hardware_concurrency())),
+     parallelOSMParsing(false),
+     parallelOSMChunkSize(4*1024*1024),
      numericIndexPageSize(1024),
      rawCoordBlockSize(60000000),
      rawNodeDataMemoryMaped(false),
@@ -145,8 +151,15 @@ namespace osmscout {
      optimizationCellSizeAverage(64),
      optimizationCellSizeMax(255),
      optimizationWayMethod(TransPolygon::quality),
+     geometryBands(false),
+     geometryBandMinMag(6),
+     geometryBandMaxMag(14),
+     geometryBandTolerance(0.5),
      routeNodeBlockSize(500000),
      routeNodeTileMag(13),
+     updatable(false),
+     updateMaxChangeRatio(0.05),
+     updateMaxAffectedCells(10000),
      assumeLand(AssumeLandStrategy::automatic),
      langOrder({"#"}),
      maxAdminLevel(10),
@@ -181,6 +194,11 @@ namespace osmscout {
     return boundingPolygonFile;
   }
 
+  GeoBox ImportParameter::GetClipBox() const
+  {
+    return clipBox;
+  }
+
   ImportErrorReporterRef ImportParameter::GetErrorReporter() const
   {
     return errorReporter;
@@ -226,11 +244,26 @@ namespace osmscout {
     return sortTileMag;
   }
 
+  bool ImportParameter::GetSortHilbertOrder() const
+  {
+    return sortHilbertOrder;
+  }
+
   size_t ImportParameter::GetProcessingQueueSize() const
   {
     return processingQueueSize;
   }
 
+  bool ImportParameter::GetParallelOSMParsing() const
+  {
+    return parallelOSMParsing;
+  }
+
+  size_t ImportParameter::GetParallelOSMChunkSize() const
+  {
+    return parallelOSMChunkSize;
+  }
+
   size_t ImportParameter::GetNumericIndexPageSize() const
   {
     return numericIndexPageSize;
@@ -396,6 +429,26 @@ namespace osmscout {
     return optimizationWayMethod;
   }
 
+  bool ImportParameter::GetGeometryBands() const
+  {
+    return geometryBands;
+  }
+
+  MagnificationLevel ImportParameter::GetGeometryBandMinMag() const
+  {
+    return geometryBandMinMag;
+  }
+
+  MagnificationLevel ImportParameter::GetGeometryBandMaxMag() const
+  {
+    return geometryBandMaxMag;
+  }
+
+  double ImportParameter::GetGeometryBandTolerance() const
+  {
+    return geometryBandTolerance;
+  }
+
   size_t ImportParameter::GetRouteNodeBlockSize() const
   {
     return routeNodeBlockSize;
@@ -406,6 +459,21 @@ namespace osmscout {
     return routeNodeTileMag;
   }
 
+  bool ImportParameter::IsUpdatable() const
+  {
+    return updatable;
+  }
+
+  double ImportParameter::GetUpdateMaxChangeRatio() const
+  {
+    return updateMaxChangeRatio;
+  }
+
+  size_t ImportParameter::GetUpdateMaxAffectedCells() const
+  {
+    return updateMaxAffectedCells;
+  }
+
   ImportParameter::AssumeLandStrategy ImportParameter::GetAssumeLand() const
   {
     return assumeLand;
@@ -451,6 +519,11 @@ namespace osmscout {
     this->boundingPolygonFile=boundingPolygonFile;
   }
 
+  void ImportParameter::SetClipBox(const GeoBox& clipBox)
+  {
+    this->clipBox=clipBox;
+  }
+
   void ImportParameter::SetErrorReporter(const ImportErrorReporterRef& errorReporter)
   {
     this->errorReporter=errorReporter;
@@ -503,11 +576,26 @@ namespace osmscout {
     this->sortTileMag=sortTileMag;
   }
 
+  void ImportParameter::SetSortHilbertOrder(bool sortHilbertOrder)
+  {
+    this->sortHilbertOrder=sortHilbertOrder;
+  }
+
   void ImportParameter::SetProcessingQueueSize(size_t processingQueueSize)
   {
     this->processingQueueSize=processingQueueSize;
   }
 
+  void ImportParameter::SetParallelOSMParsing(bool parallelOSMParsing)
+  {
+    this->parallelOSMParsing=parallelOSMParsing;
+  }
+
+  void ImportParameter::SetParallelOSMChunkSize(size_t parallelOSMChunkSize)
+  {
+    this->parallelOSMChunkSize=parallelOSMChunkSize;
+  }
+
   void ImportParameter::SetNumericIndexPageSize(size_t numericIndexPageSize)
   {
     this->numericIndexPageSize=numericIndexPageSize;
@@ -680,6 +768,26 @@ namespace osmscout {
     this->optimizationWayMethod=optimizationWayMethod;
   }
 
+  void ImportParameter::SetGeometryBands(bool geometryBands)
+  {
+    this->geometryBands=geometryBands;
+  }
+
+  void ImportParameter::SetGeometryBandMinMag(MagnificationLevel geometryBandMinMag)
+  {
+    this->geometryBandMinMag=geometryBandMinMag;
+  }
+
+  void ImportParameter::SetGeometryBandMaxMag(MagnificationLevel geometryBandMaxMag)
+  {
+    this->geometryBandMaxMag=geometryBandMaxMag;
+  }
+
+  void ImportParameter::SetGeometryBandTolerance(double geometryBandTolerance)
+  {
+    this->geometryBandTolerance=geometryBandTolerance;
+  }
+
   void ImportParameter::SetRouteNodeBlockSize(size_t blockSize)
   {
     this->routeNodeBlockSize=blockSize;
@@ -690,6 +798,21 @@ namespace osmscout {
     this->routeNodeTileMag=routeNodeTileMag;
   }
 
+  void ImportParameter::SetUpdatable(bool updatable)
+  {
+    this->updatable=updatable;
+  }
+
+  void ImportParameter::SetUpdateMaxChangeRatio(double updateMaxChangeRatio)
+  {
+    this->updateMaxChangeRatio=updateMaxChangeRatio;
+  }
+
+  void ImportParameter::SetUpdateMaxAffectedCells(size_t updateMaxAffectedCells)
+  {
+    this->updateMaxAffectedCells=updateMaxAffectedCells;
+  }
+
   void ImportParameter::SetAssumeLand(AssumeLandStrategy assumeLand)
   {
     this->assumeLand=assumeLand;
@@ -931,6 +1054,12 @@ namespace osmscout {
     /* 25 */
     modules.push_back(std::make_shared<TextIndexGenerator>());
 #endif
+
+    /* 25 or 26, only active if ImportParameter::GetGeometryBands() is set */
+    modules.push_back(std::make_shared<MultiResolutionGeometryGenerator>());
+
+    /* 26 or 27, only writes data if ImportParameter::IsUpdatable() is set */
+    modules.push_back(std::make_shared<UpdateDataGenerator>());
   }
 
   void Importer::DumpTypeConfigData(const TypeConfig& typeConfig,
@@ -1046,9 +1175,13 @@ namespace osmscout {
         DumpModuleDescription(moduleDescription,
                               progress);
 
-        success=module->Import(typeConfig,
-                               parameter,
-                               progress);
+        {
+          OSMSCOUT_TRACE_SCOPE("Import",moduleDescription.GetName());
+
+          success=module->Import(typeConfig,
+                                 parameter,
+                                 progress);
+        }
 
         timer.Stop();
 
@@ -1092,23 +1225,21 @@ namespace osmscout {
     return true;
   }
 
-  bool Importer::Import(Progress& progress)
+  /**
+   * Load the type configuration from the *.ost file given by the parameter and
+   * register the name tags for the configured languages. The returned type
+   * configuration is the one all import modules work on. Returns nullptr on error.
+   */
+  TypeConfigRef Importer::LoadTypeConfig(const ImportParameter& parameter,
+                                         Progress& progress)
   {
     TypeConfigRef typeConfig(std::make_shared<TypeConfig>());
 
-    if (!ValidateDescription(progress)) {
-      return false;
-    }
-
-    if (!ValidateParameter(progress)) {
-      return false;
-    }
-
     progress.SetStep("Loading type config");
 
     if (!typeConfig->LoadFromOSTFile(parameter.GetTypefile())) {
       progress.Error("Cannot load type configuration!");
-      return false;
+      return nullptr;
     }
 
     DumpTypeConfigData(*typeConfig,
@@ -1148,6 +1279,26 @@ namespace osmscout {
       langIndex+=3;
     }
 
+    return typeConfig;
+  }
+
+  bool Importer::Import(Progress& progress)
+  {
+    if (!ValidateDescription(progress)) {
+      return false;
+    }
+
+    if (!ValidateParameter(progress)) {
+      return false;
+    }
+
+    TypeConfigRef typeConfig=LoadTypeConfig(parameter,
+                                            progress);
+
+    if (!typeConfig) {
+      return false;
+    }
+
     ImportErrorReporterRef errorReporter=std::make_shared<ImportErrorReporter>(progress,
                                                                                typeConfig,
                                                                                parameter.GetDestinationDirectory());
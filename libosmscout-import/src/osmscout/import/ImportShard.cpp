@@ -0,0 +1,116 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/ImportShard.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <locale>
+
+namespace osmscout {
+
+  ImportShard::ImportShard(const MagnificationLevel& level,
+                           const TileId& tile,
+                           const GeoBox& boundingBox)
+  : level(level),
+    tile(tile),
+    boundingBox(boundingBox)
+  {
+    // no code
+  }
+
+  /**
+   * Return a name for the shard, that is unique within the shards of one import
+   * and can be used as a directory or file name.
+   */
+  std::string ImportShard::GetName() const
+  {
+    return "shard_"+
+           std::to_string(level.Get())+"_"+
+           std::to_string(tile.GetX())+"_"+
+           std::to_string(tile.GetY());
+  }
+
+  /**
+   * Write the bounding box of the shard as polygon file in the format
+   * read by PreprocessPoly.
+   */
+  bool ImportShard::WritePolygonFile(const std::string& filename) const
+  {
+    std::ofstream file(filename,
+                       std::ios::out|std::ios::trunc);
+
+    if (!file) {
+      return false;
+    }
+
+    file.imbue(std::locale::classic());
+    file << std::fixed << std::setprecision(7);
+
+    file << GetName() << std::endl;
+    file << "1" << std::endl;
+    file << boundingBox.GetMinLon() << " " << boundingBox.GetMinLat() << std::endl;
+    file << boundingBox.GetMaxLon() << " " << boundingBox.GetMinLat() << std::endl;
+    file << boundingBox.GetMaxLon() << " " << boundingBox.GetMaxLat() << std::endl;
+    file << boundingBox.GetMinLon() << " " << boundingBox.GetMaxLat() << std::endl;
+    file << "END" << std::endl;
+    file << "END" << std::endl;
+
+    file.close();
+
+    return !file.fail();
+  }
+
+  /**
+   * Split the given area into shards along the tile grid of the given
+   * magnification level. Every shard is enlarged by overlap degrees on
+   * every side.
+   */
+  std::vector<ImportShard> ImportShard::GetShards(const GeoBox& area,
+                                                  const MagnificationLevel& level,
+                                                  double overlap)
+  {
+    std::vector<ImportShard> shards;
+
+    if (!area.IsValid()) {
+      return shards;
+    }
+
+    Magnification magnification(level);
+    TileIdBox     tiles(magnification,
+                        area);
+
+    shards.reserve(tiles.GetCount());
+
+    for (const auto& tile : tiles) {
+      GeoBox tileBox=tile.GetBoundingBox(magnification);
+      GeoBox shardBox(GeoCoord(std::max(tileBox.GetMinLat()-overlap,-90.0),
+                               std::max(tileBox.GetMinLon()-overlap,-180.0)),
+                      GeoCoord(std::min(tileBox.GetMaxLat()+overlap,90.0),
+                               std::min(tileBox.GetMaxLon()+overlap,180.0)));
+
+      shards.emplace_back(level,
+                          tile,
+                          shardBox);
+    }
+
+    return shards;
+  }
+}
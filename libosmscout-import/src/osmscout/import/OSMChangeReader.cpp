@@ -0,0 +1,385 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/OSMChangeReader.h>
+
+#include <cstring>
+#include <iostream>
+
+#include <libxml/parser.h>
+
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  class OSMChangeParser
+  {
+    enum Context {
+      contextUnknown,
+      contextNode,
+      contextWay,
+      contextRelation
+    };
+
+  private:
+    const TagRegistry& tagRegistry;
+    Progress&          progress;
+    OSMChange&         change;
+    bool               inAction;
+    OSMChange::Action  action;
+    Context            context;
+
+  private:
+    static const xmlChar* GetAttribute(const xmlChar **atts,
+                                       const char* name)
+    {
+      if (atts==nullptr) {
+        return nullptr;
+      }
+
+      for (size_t i=0; atts[i]!=nullptr && atts[i+1]!=nullptr; i+=2) {
+        if (strcmp((const char*)atts[i],name)==0) {
+          return atts[i+1];
+        }
+      }
+
+      return nullptr;
+    }
+
+    bool GetId(const xmlChar **atts,
+               OSMId& id)
+    {
+      const xmlChar *idValue=GetAttribute(atts,"id");
+
+      if (idValue==nullptr ||
+          !StringToNumber((const char*)idValue,id)) {
+        progress.Error("Cannot parse id of changed object");
+        return false;
+      }
+
+      return true;
+    }
+
+  public:
+    OSMChangeParser(const TagRegistry& tagRegistry,
+                    Progress& progress,
+                    OSMChange& change)
+    : tagRegistry(tagRegistry),
+      progress(progress),
+      change(change),
+      inAction(false),
+      action(OSMChange::actionModify),
+      context(contextUnknown)
+    {
+      // no code
+    }
+
+    void StartElement(const xmlChar *name, const xmlChar **atts)
+    {
+      if (strcmp((const char*)name,"create")==0) {
+        inAction=true;
+        action=OSMChange::actionCreate;
+      }
+      else if (strcmp((const char*)name,"modify")==0) {
+        inAction=true;
+        action=OSMChange::actionModify;
+      }
+      else if (strcmp((const char*)name,"delete")==0) {
+        inAction=true;
+        action=OSMChange::actionDelete;
+      }
+      else if (!inAction) {
+        return;
+      }
+      else if (strcmp((const char*)name,"node")==0) {
+        OSMChange::NodeChange node;
+
+        context=contextUnknown;
+        node.action=action;
+
+        if (!GetId(atts,node.id)) {
+          return;
+        }
+
+        // Deleted nodes do not need to have a position
+        if (action!=OSMChange::actionDelete) {
+          const xmlChar *latValue=GetAttribute(atts,"lat");
+          const xmlChar *lonValue=GetAttribute(atts,"lon");
+          double        lat,lon;
+
+          if (latValue==nullptr ||
+              lonValue==nullptr ||
+              !StringToNumber((const char*)latValue,lat) ||
+              !StringToNumber((const char*)lonValue,lon)) {
+            progress.Error("Cannot parse coordinate of node "+std::to_string(node.id));
+            return;
+          }
+
+          node.coord.Set(lat,lon);
+        }
+
+        change.nodes.push_back(node);
+        context=contextNode;
+      }
+      else if (strcmp((const char*)name,"way")==0) {
+        OSMChange::WayChange way;
+
+        context=contextUnknown;
+        way.action=action;
+
+        if (!GetId(atts,way.id)) {
+          return;
+        }
+
+        change.ways.push_back(way);
+        context=contextWay;
+      }
+      else if (strcmp((const char*)name,"relation")==0) {
+        OSMChange::RelationChange relation;
+
+        context=contextUnknown;
+        relation.action=action;
+
+        if (!GetId(atts,relation.id)) {
+          return;
+        }
+
+        change.relations.push_back(relation);
+        context=contextRelation;
+      }
+      else if (strcmp((const char*)name,"nd")==0) {
+        if (context!=contextWay) {
+          return;
+        }
+
+        const xmlChar *refValue=GetAttribute(atts,"ref");
+        OSMId         node;
+
+        if (refValue==nullptr ||
+            !StringToNumber((const char*)refValue,node)) {
+          progress.Error("Cannot parse node reference of way "+std::to_string(change.ways.back().id));
+          return;
+        }
+
+        change.ways.back().nodes.push_back(node);
+      }
+      else if (strcmp((const char*)name,"member")==0) {
+        if (context!=contextRelation) {
+          return;
+        }
+
+        const xmlChar       *typeValue=GetAttribute(atts,"type");
+        const xmlChar       *refValue=GetAttribute(atts,"ref");
+        const xmlChar       *roleValue=GetAttribute(atts,"role");
+        RawRelation::Member member;
+
+        if (typeValue==nullptr ||
+            refValue==nullptr ||
+            !StringToNumber((const char*)refValue,member.id)) {
+          progress.Error("Cannot parse member of relation "+std::to_string(change.relations.back().id));
+          return;
+        }
+
+        if (strcmp((const char*)typeValue,"node")==0) {
+          member.type=RawRelation::memberNode;
+        }
+        else if (strcmp((const char*)typeValue,"way")==0) {
+          member.type=RawRelation::memberWay;
+        }
+        else if (strcmp((const char*)typeValue,"relation")==0) {
+          member.type=RawRelation::memberRelation;
+        }
+        else {
+          progress.Error(std::string("Cannot parse member type: '")+(const char*)typeValue+"'");
+          return;
+        }
+
+        if (roleValue!=nullptr) {
+          member.role=(const char*)roleValue;
+        }
+
+        change.relations.back().members.push_back(member);
+      }
+      else if (strcmp((const char*)name,"tag")==0) {
+        if (context==contextUnknown ||
+            action==OSMChange::actionDelete) {
+          return;
+        }
+
+        const xmlChar *keyValue=GetAttribute(atts,"k");
+        const xmlChar *valueValue=GetAttribute(atts,"v");
+
+        if (keyValue==nullptr ||
+            valueValue==nullptr) {
+          progress.Error("Cannot parse tag, skipping");
+          return;
+        }
+
+        TagId id=tagRegistry.GetTagId((const char*)keyValue);
+
+        if (id==tagIgnore) {
+          return;
+        }
+
+        switch (context) {
+        case contextNode:
+          change.nodes.back().tags[id]=(const char*)valueValue;
+          break;
+        case contextWay:
+          change.ways.back().tags[id]=(const char*)valueValue;
+          break;
+        case contextRelation:
+          change.relations.back().tags[id]=(const char*)valueValue;
+          break;
+        case contextUnknown:
+          break;
+        }
+      }
+    }
+
+    void EndElement(const xmlChar *name)
+    {
+      if (strcmp((const char*)name,"create")==0 ||
+          strcmp((const char*)name,"modify")==0 ||
+          strcmp((const char*)name,"delete")==0) {
+        inAction=false;
+        context=contextUnknown;
+      }
+      else if (strcmp((const char*)name,"node")==0 ||
+               strcmp((const char*)name,"way")==0 ||
+               strcmp((const char*)name,"relation")==0) {
+        context=contextUnknown;
+      }
+    }
+  };
+
+  static void StartElement(void *data, const xmlChar *name, const xmlChar **atts)
+  {
+    auto* parser=static_cast<OSMChangeParser*>(data);
+
+    parser->StartElement(name,atts);
+  }
+
+  static void EndElement(void *data, const xmlChar *name)
+  {
+    auto* parser=static_cast<OSMChangeParser*>(data);
+
+    parser->EndElement(name);
+  }
+
+  static xmlEntityPtr GetEntity(void* /*data*/, const xmlChar *name)
+  {
+    return xmlGetPredefinedEntity(name);
+  }
+
+  static void StructuredErrorHandler(void* /*data*/, xmlErrorPtr error)
+  {
+    std::cerr << "XML error, line " << error->line << ": " << error->message << std::endl;
+  }
+
+  static void WarningHandler(void* /*data*/, const char* msg,...)
+  {
+    std::cerr << "XML warning:" << msg << std::endl;
+  }
+
+  static void ErrorHandler(void* /*data*/, const char* msg,...)
+  {
+    std::cerr << "XML error:" << msg << std::endl;
+  }
+
+  /**
+   * Read the given *.osc file and append all changes found to the given change.
+   */
+  bool OSMChangeReader::Read(const TypeConfig& typeConfig,
+                             Progress& progress,
+                             const std::string& filename,
+                             OSMChange& change) const
+  {
+    progress.SetAction(std::string("Parsing *.osc file '")+filename+"'");
+
+    OSMChangeParser  parser(typeConfig.GetTagRegistry(),
+                            progress,
+                            change);
+    FILE             *file;
+    xmlSAXHandler    saxParser;
+    xmlParserCtxtPtr ctxt;
+
+    memset(&saxParser,0,sizeof(xmlSAXHandler));
+    saxParser.initialized=XML_SAX2_MAGIC;
+
+    saxParser.getEntity=GetEntity;
+    saxParser.startElement=StartElement;
+    saxParser.endElement=EndElement;
+    saxParser.warning=WarningHandler;
+    saxParser.error=ErrorHandler;
+    saxParser.fatalError=ErrorHandler;
+    saxParser.serror=StructuredErrorHandler;
+
+    file=fopen(filename.c_str(),"rb");
+
+    if (file==nullptr) {
+      progress.Error("Cannot open file '"+filename+"'");
+      return false;
+    }
+
+    char chars[1024];
+
+    int res=fread(chars,1,4,file);
+    if (res!=4) {
+      fclose(file);
+      return false;
+    }
+
+    ctxt=xmlCreatePushParserCtxt(&saxParser,&parser,chars,res,nullptr);
+
+    // Resolve entities, do not do any network communication. Newer versions
+    // of libxml2 only call the SAX1 element callbacks, if explicitly requested,
+    // older versions replace them with their defaults in this case
+    xmlCtxtUseOptions(ctxt,XML_PARSE_NOENT|XML_PARSE_NONET|XML_PARSE_SAX1);
+    ctxt->sax->startElement=StartElement;
+    ctxt->sax->endElement=EndElement;
+
+    while ((res=fread(chars,1,sizeof(chars),file))>0) {
+      if (xmlParseChunk(ctxt,chars,res,0)!=0) {
+        xmlParserError(ctxt,"xmlParseChunk");
+        xmlFreeParserCtxt(ctxt);
+        fclose(file);
+
+        return false;
+      }
+    }
+
+    if (xmlParseChunk(ctxt,chars,0,1)!=0) {
+      xmlParserError(ctxt,"xmlParseChunk");
+      xmlFreeParserCtxt(ctxt);
+      fclose(file);
+
+      return false;
+    }
+
+    xmlFreeParserCtxt(ctxt);
+    fclose(file);
+
+    progress.Info(std::to_string(change.nodes.size())+" node(s), "+
+                  std::to_string(change.ways.size())+" way(s) and "+
+                  std::to_string(change.relations.size())+" relation(s) changed");
+
+    return true;
+  }
+}
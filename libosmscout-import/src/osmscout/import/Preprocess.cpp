@@ -19,6 +19,7 @@
 
 #include <osmscout/import/Preprocess.h>
 
+#include <algorithm>
 #include <functional>
 #include <limits>
 
@@ -629,12 +630,77 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Drop all objects not touching the clip box of the import parameter.
+   *
+   * Nodes outside the clip box lose their tags, so that only their coordinate
+   * is stored. Ways are kept if at least one of their nodes is within the clip box,
+   * their coordinates thus are always complete. Relations are kept if
+   * at least one of their node or way members has been kept. Since nodes
+   * are ordered before ways and ways before relations in the imported files,
+   * this works in one pass. Data polygons (see PreprocessPoly) are always kept.
+   */
+  void Preprocess::Callback::ClipBlock(RawBlockData& data)
+  {
+    GeoBox clipBox=parameter.GetClipBox();
+
+    for (auto& entry : data.nodeData) {
+      if (clipBox.Includes(entry.coord,false)) {
+        clipNodeIds.Set(entry.id);
+      }
+      else {
+        entry.tags.clear();
+      }
+    }
+
+    data.wayData.erase(std::remove_if(data.wayData.begin(),
+                                      data.wayData.end(),
+                                      [this](const RawWayData& way) {
+                                        bool touchesClipBox=way.tags.find(typeConfig->tagDataPolygon)!=way.tags.end();
+
+                                        for (const auto& node : way.nodes) {
+                                          if (touchesClipBox) {
+                                            break;
+                                          }
+
+                                          touchesClipBox=clipNodeIds.IsSet(node);
+                                        }
+
+                                        if (touchesClipBox) {
+                                          clipWayIds.Set(way.id);
+                                        }
+
+                                        return !touchesClipBox;
+                                      }),
+                       data.wayData.end());
+
+    data.relationData.erase(std::remove_if(data.relationData.begin(),
+                                           data.relationData.end(),
+                                           [this](const RawRelationData& relation) {
+                                             for (const auto& member : relation.members) {
+                                               if ((member.type==RawRelation::memberNode && clipNodeIds.IsSet(member.id)) ||
+                                                   (member.type==RawRelation::memberWay && clipWayIds.IsSet(member.id))) {
+                                                 return false;
+                                               }
+                                             }
+
+                                             return true;
+                                           }),
+                            data.relationData.end());
+  }
+
   void Preprocess::Callback::ProcessBlock(RawBlockDataRef data)
   {
     //
     // Synchronous processing block, because of access to shared data
     //
 
+    GeoBox clipBox=parameter.GetClipBox();
+
+    if (clipBox.IsValid()) {
+      ClipBlock(*data);
+    }
+
     for (const auto& entry : data->nodeData) {
       if (entry.id<lastNodeId) {
         nodeSortingError=true;
@@ -642,11 +708,14 @@ namespace osmscout {
 
       lastNodeId=entry.id;
 
-      minCoord.Set(std::min(minCoord.GetLat(),entry.coord.GetLat()),
-                   std::min(minCoord.GetLon(),entry.coord.GetLon()));
+      if (!clipBox.IsValid() ||
+          clipBox.Includes(entry.coord,false)) {
+        minCoord.Set(std::min(minCoord.GetLat(),entry.coord.GetLat()),
+                     std::min(minCoord.GetLon(),entry.coord.GetLon()));
 
-      maxCoord.Set(std::max(maxCoord.GetLat(),entry.coord.GetLat()),
-                   std::max(maxCoord.GetLon(),entry.coord.GetLon()));
+        maxCoord.Set(std::max(maxCoord.GetLat(),entry.coord.GetLat()),
+                     std::max(maxCoord.GetLon(),entry.coord.GetLon()));
+      }
 
       if (!readNodes) {
         progress.Info("Start reading nodes");
@@ -20,9 +20,13 @@
 #include <osmscout/import/PreprocessOSM.h>
 
 #include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <map>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <libxml/parser.h>
@@ -325,6 +329,652 @@ namespace osmscout {
     }
   };
 
+  /**
+   * Lightweight scanner for one chunk of an *.osm file. A chunk starts at the
+   * beginning of a top level node, way or relation element (or at the start of the file)
+   * and contains only complete elements.
+   *
+   * The scanner only understands the subset of XML used by *.osm files: elements,
+   * attributes, character and predefined entities. Processing instructions, comments,
+   * CDATA sections and doctype declarations are skipped.
+   */
+  class ChunkParser
+  {
+  public:
+    struct Result
+    {
+      std::vector<PreprocessorCallback::RawBlockDataRef> blocks;
+      std::vector<std::string>                           errors;
+    };
+
+  private:
+    enum ElementType {
+      elementOther,
+      elementNode,
+      elementWay,
+      elementRelation,
+      elementTag,
+      elementNd,
+      elementMember
+    };
+
+    enum Context {
+      contextUnknown,
+      contextNode,
+      contextWay,
+      contextRelation
+    };
+
+    struct Attribute
+    {
+      const char  *name;
+      size_t      nameLength;
+      std::string value;
+    };
+
+  private:
+    const TypeConfig&                     typeConfig;
+    const char                            *pos;
+    const char                            *end;
+    std::vector<Attribute>                attributes;
+    size_t                                attributeCount;
+    Context                               context;
+    OSMId                                 id;
+    double                                lon,lat;
+    TagMap                                tags;
+    std::vector<OSMId>                    nodes;
+    std::vector<RawRelation::Member>      members;
+    size_t                                blockDataSize;
+    PreprocessorCallback::RawBlockDataRef blockData;
+    Result                                result;
+
+  private:
+    static bool IsWhitespace(char c)
+    {
+      return c==' ' || c=='\t' || c=='\n' || c=='\r';
+    }
+
+    static bool IsNameEnd(char c)
+    {
+      return IsWhitespace(c) || c=='/' || c=='>' || c=='=';
+    }
+
+    static ElementType GetElementType(const char* name,
+                                      size_t length)
+    {
+      if (length==4 && strncmp(name,"node",4)==0) {
+        return elementNode;
+      }
+      if (length==3 && strncmp(name,"way",3)==0) {
+        return elementWay;
+      }
+      if (length==8 && strncmp(name,"relation",8)==0) {
+        return elementRelation;
+      }
+      if (length==3 && strncmp(name,"tag",3)==0) {
+        return elementTag;
+      }
+      if (length==2 && strncmp(name,"nd",2)==0) {
+        return elementNd;
+      }
+      if (length==6 && strncmp(name,"member",6)==0) {
+        return elementMember;
+      }
+
+      return elementOther;
+    }
+
+    static void AppendUTF8(std::string& value,
+                           unsigned long code)
+    {
+      if (code<0x80) {
+        value+=(char)code;
+      }
+      else if (code<0x800) {
+        value+=(char)(0xc0 | (code >> 6));
+        value+=(char)(0x80 | (code & 0x3f));
+      }
+      else if (code<0x10000) {
+        value+=(char)(0xe0 | (code >> 12));
+        value+=(char)(0x80 | ((code >> 6) & 0x3f));
+        value+=(char)(0x80 | (code & 0x3f));
+      }
+      else {
+        value+=(char)(0xf0 | (code >> 18));
+        value+=(char)(0x80 | ((code >> 12) & 0x3f));
+        value+=(char)(0x80 | ((code >> 6) & 0x3f));
+        value+=(char)(0x80 | (code & 0x3f));
+      }
+    }
+
+    /**
+     * Copy the attribute value, replacing entities and normalizing whitespace.
+     * Like libxml2 line endings ("\r\n" and single '\r') are normalized before,
+     * so they result in one space.
+     */
+    static void DecodeValue(const char* start,
+                            const char* valueEnd,
+                            std::string& value)
+    {
+      value.clear();
+
+      while (start<valueEnd) {
+        if (*start=='&') {
+          const char* semicolon=static_cast<const char*>(memchr(start,';',valueEnd-start));
+
+          if (semicolon!=nullptr) {
+            size_t length=semicolon-start-1;
+
+            if (length==2 && strncmp(start+1,"lt",2)==0) {
+              value+='<';
+            }
+            else if (length==2 && strncmp(start+1,"gt",2)==0) {
+              value+='>';
+            }
+            else if (length==3 && strncmp(start+1,"amp",3)==0) {
+              value+='&';
+            }
+            else if (length==4 && strncmp(start+1,"quot",4)==0) {
+              value+='"';
+            }
+            else if (length==4 && strncmp(start+1,"apos",4)==0) {
+              value+='\'';
+            }
+            else if (length>1 && start[1]=='#') {
+              std::string number(start+2,semicolon);
+
+              if (!number.empty() && (number[0]=='x' || number[0]=='X')) {
+                AppendUTF8(value,strtoul(number.c_str()+1,nullptr,16));
+              }
+              else {
+                AppendUTF8(value,strtoul(number.c_str(),nullptr,10));
+              }
+            }
+            else {
+              value.append(start,semicolon+1);
+            }
+
+            start=semicolon+1;
+            continue;
+          }
+        }
+
+        if (*start=='\r' &&
+            start+1<valueEnd &&
+            start[1]=='\n') {
+          start++;
+        }
+
+        value+=IsWhitespace(*start) ? ' ' : *start;
+        start++;
+      }
+    }
+
+    const Attribute* GetAttribute(const char* name) const
+    {
+      size_t length=strlen(name);
+
+      for (size_t i=0; i<attributeCount; i++) {
+        if (attributes[i].nameLength==length &&
+            strncmp(attributes[i].name,name,length)==0) {
+          return &attributes[i];
+        }
+      }
+
+      return nullptr;
+    }
+
+    void AddError(const std::string& error)
+    {
+      result.errors.push_back(error);
+    }
+
+    bool ParseAttributes(bool& selfClosing)
+    {
+      attributeCount=0;
+      selfClosing=false;
+
+      while (pos<end) {
+        while (pos<end && IsWhitespace(*pos)) {
+          pos++;
+        }
+
+        if (pos>=end) {
+          break;
+        }
+
+        if (*pos=='>') {
+          pos++;
+          return true;
+        }
+
+        if (*pos=='/') {
+          selfClosing=true;
+          pos++;
+          continue;
+        }
+
+        const char* nameStart=pos;
+
+        while (pos<end && !IsNameEnd(*pos)) {
+          pos++;
+        }
+
+        size_t nameLength=pos-nameStart;
+
+        while (pos<end && IsWhitespace(*pos)) {
+          pos++;
+        }
+
+        if (pos>=end || *pos!='=') {
+          return false;
+        }
+
+        pos++;
+
+        while (pos<end && IsWhitespace(*pos)) {
+          pos++;
+        }
+
+        if (pos>=end || (*pos!='"' && *pos!='\'')) {
+          return false;
+        }
+
+        char        quote=*pos;
+        const char* valueStart=++pos;
+        const char* valueEnd=static_cast<const char*>(memchr(pos,quote,end-pos));
+
+        if (valueEnd==nullptr) {
+          return false;
+        }
+
+        if (attributeCount==attributes.size()) {
+          attributes.emplace_back();
+        }
+
+        Attribute& attribute=attributes[attributeCount];
+
+        attribute.name=nameStart;
+        attribute.nameLength=nameLength;
+        DecodeValue(valueStart,valueEnd,attribute.value);
+
+        attributeCount++;
+
+        pos=valueEnd+1;
+      }
+
+      return false;
+    }
+
+    bool SkipTo(const char* pattern)
+    {
+      size_t length=strlen(pattern);
+
+      while (pos+length<=end) {
+        if (strncmp(pos,pattern,length)==0) {
+          pos+=length;
+          return true;
+        }
+
+        pos++;
+      }
+
+      return false;
+    }
+
+    void StartElement(ElementType type)
+    {
+      if (!blockData) {
+        blockData=std::make_shared<PreprocessorCallback::RawBlockData>();
+        blockDataSize=0;
+        blockData->nodeData.reserve(10000);
+        blockData->wayData.reserve(10000);
+        blockData->relationData.reserve(10000);
+      }
+
+      switch (type) {
+      case elementNode: {
+        const Attribute *idValue=GetAttribute("id");
+        const Attribute *latValue=GetAttribute("lat");
+        const Attribute *lonValue=GetAttribute("lon");
+
+        context=contextNode;
+        tags.clear();
+
+        if (idValue==nullptr || lonValue==nullptr || latValue==nullptr) {
+          AddError("Not all required attributes found");
+          return;
+        }
+
+        if (!StringToNumber(idValue->value,id)) {
+          AddError("Cannot parse id: '"+idValue->value+"'");
+          return;
+        }
+        if (!StringToNumber(latValue->value.c_str(),lat)) {
+          AddError("Cannot parse latitude: '"+latValue->value+"'");
+          return;
+        }
+        if (!StringToNumber(lonValue->value.c_str(),lon)) {
+          AddError("Cannot parse longitude: '"+lonValue->value+"'");
+          return;
+        }
+        break;
+      }
+      case elementWay:
+      case elementRelation: {
+        const Attribute *idValue=GetAttribute("id");
+
+        context=type==elementWay ? contextWay : contextRelation;
+        nodes.clear();
+        members.clear();
+        tags.clear();
+
+        if (idValue==nullptr ||
+            !StringToNumber(idValue->value,id)) {
+          AddError("Cannot parse id: '"+(idValue!=nullptr ? idValue->value : "")+"'");
+          return;
+        }
+        break;
+      }
+      case elementTag: {
+        if (context!=contextWay && context!=contextNode && context!=contextRelation) {
+          return;
+        }
+
+        const Attribute *keyValue=GetAttribute("k");
+        const Attribute *valueValue=GetAttribute("v");
+
+        if (keyValue==nullptr || valueValue==nullptr) {
+          AddError("Cannot parse tag, skipping...");
+          return;
+        }
+
+        TagId tagId=typeConfig.GetTagRegistry().GetTagId(keyValue->value);
+
+        if (tagId!=tagIgnore) {
+          tags[tagId]=valueValue->value;
+        }
+        break;
+      }
+      case elementNd: {
+        if (context!=contextWay) {
+          return;
+        }
+
+        OSMId           node;
+        const Attribute *idValue=GetAttribute("ref");
+
+        if (idValue==nullptr ||
+            !StringToNumber(idValue->value,node)) {
+          AddError("Cannot parse id: '"+(idValue!=nullptr ? idValue->value : "")+"'");
+          return;
+        }
+
+        nodes.push_back(node);
+        break;
+      }
+      case elementMember: {
+        if (context!=contextRelation) {
+          return;
+        }
+
+        RawRelation::Member member;
+        const Attribute     *typeValue=GetAttribute("type");
+        const Attribute     *refValue=GetAttribute("ref");
+        const Attribute     *roleValue=GetAttribute("role");
+
+        if (typeValue==nullptr) {
+          AddError("Member of relation "+std::to_string(id)+" does not have a type");
+          return;
+        }
+
+        if (refValue==nullptr) {
+          AddError("Member of relation "+std::to_string(id)+" does not have a valid reference");
+          return;
+        }
+
+        if (roleValue==nullptr) {
+          AddError("Member of relation "+std::to_string(id)+" does not have a valid role");
+          return;
+        }
+
+        if (typeValue->value=="node") {
+          member.type=RawRelation::memberNode;
+        }
+        else if (typeValue->value=="way") {
+          member.type=RawRelation::memberWay;
+        }
+        else if (typeValue->value=="relation") {
+          member.type=RawRelation::memberRelation;
+        }
+        else {
+          AddError("Cannot parse member type: '"+typeValue->value+"'");
+          return;
+        }
+
+        if (!StringToNumber(refValue->value,member.id)) {
+          AddError("Cannot parse ref '"+refValue->value+"' for relation "+std::to_string(id));
+        }
+
+        member.role=roleValue->value;
+
+        members.push_back(member);
+        break;
+      }
+      case elementOther:
+        break;
+      }
+    }
+
+    void EndElement(ElementType type)
+    {
+      if (type==elementNode) {
+        PreprocessorCallback::RawNodeData data;
+
+        data.id=id;
+        data.coord.Set(lat,lon);
+        data.tags=std::move(tags);
+
+        blockData->nodeData.push_back(std::move(data));
+        blockDataSize++;
+
+        context=contextUnknown;
+      }
+      else if (type==elementWay) {
+        PreprocessorCallback::RawWayData data;
+
+        data.id=id;
+        data.nodes=std::move(nodes);
+        data.tags=std::move(tags);
+
+        blockData->wayData.push_back(std::move(data));
+        blockDataSize++;
+
+        context=contextUnknown;
+      }
+      else if (type==elementRelation) {
+        PreprocessorCallback::RawRelationData data;
+
+        data.id=id;
+        data.members=std::move(members);
+        data.tags=std::move(tags);
+
+        blockData->relationData.push_back(std::move(data));
+        blockDataSize++;
+
+        context=contextUnknown;
+      }
+
+      if (blockDataSize>10000) {
+        result.blocks.push_back(std::move(blockData));
+        blockData=nullptr;
+      }
+    }
+
+  public:
+    explicit ChunkParser(const TypeConfig& typeConfig)
+    : typeConfig(typeConfig),
+      pos(nullptr),
+      end(nullptr),
+      attributeCount(0),
+      context(contextUnknown),
+      id(0),
+      lon(0.0),
+      lat(0.0),
+      blockDataSize(0)
+    {
+      // no code
+    }
+
+    Result Parse(const std::string& chunk)
+    {
+      pos=chunk.data();
+      end=chunk.data()+chunk.size();
+
+      while (pos<end) {
+        pos=static_cast<const char*>(memchr(pos,'<',end-pos));
+
+        if (pos==nullptr) {
+          break;
+        }
+
+        pos++;
+
+        if (pos>=end) {
+          AddError("Unexpected end of element");
+          break;
+        }
+
+        if (*pos=='?') {
+          if (!SkipTo("?>")) {
+            AddError("Unterminated processing instruction");
+            break;
+          }
+        }
+        else if (end-pos>=3 && strncmp(pos,"!--",3)==0) {
+          if (!SkipTo("-->")) {
+            AddError("Unterminated comment");
+            break;
+          }
+        }
+        else if (end-pos>=8 && strncmp(pos,"![CDATA[",8)==0) {
+          if (!SkipTo("]]>")) {
+            AddError("Unterminated CDATA section");
+            break;
+          }
+        }
+        else if (*pos=='!') {
+          if (!SkipTo(">")) {
+            AddError("Unterminated declaration");
+            break;
+          }
+        }
+        else if (*pos=='/') {
+          const char* nameStart=++pos;
+
+          while (pos<end && !IsNameEnd(*pos)) {
+            pos++;
+          }
+
+          ElementType type=GetElementType(nameStart,pos-nameStart);
+
+          if (!SkipTo(">")) {
+            AddError("Unterminated end element");
+            break;
+          }
+
+          EndElement(type);
+        }
+        else {
+          const char* nameStart=pos;
+
+          while (pos<end && !IsNameEnd(*pos)) {
+            pos++;
+          }
+
+          ElementType type=GetElementType(nameStart,pos-nameStart);
+          bool        selfClosing;
+
+          if (!ParseAttributes(selfClosing)) {
+            AddError("Cannot parse element '"+std::string(nameStart,pos-nameStart)+"'");
+            break;
+          }
+
+          StartElement(type);
+
+          if (selfClosing) {
+            EndElement(type);
+          }
+        }
+      }
+
+      if (blockData) {
+        result.blocks.push_back(std::move(blockData));
+        blockData=nullptr;
+      }
+
+      return std::move(result);
+    }
+  };
+
+  /**
+   * Return the start of the last top level node, way or relation element in the
+   * buffer, everything before it is a sequence of complete elements.
+   * Returns 0, if there is no such element start (beside possibly at position 0).
+   *
+   * The buffer must start at an element start (or the start of the file).
+   * It is scanned forward, so that markup in comments, CDATA sections and
+   * processing instructions is not taken for an element start. An unterminated
+   * comment, CDATA section or processing instruction ends the search, since it
+   * continues in the next read.
+   */
+  static size_t FindLastElementStart(const std::string& buffer)
+  {
+    size_t lastStart=0;
+    size_t pos=0;
+
+    while ((pos=buffer.find('<',pos))!=std::string::npos) {
+      const char* skipEnd=nullptr;
+
+      if (buffer.compare(pos+1,3,"!--")==0) {
+        skipEnd="-->";
+      }
+      else if (buffer.compare(pos+1,8,"![CDATA[")==0) {
+        skipEnd="]]>";
+      }
+      else if (buffer.compare(pos+1,1,"?")==0) {
+        skipEnd="?>";
+      }
+
+      if (skipEnd!=nullptr) {
+        pos=buffer.find(skipEnd,pos+1);
+
+        if (pos==std::string::npos) {
+          break;
+        }
+
+        continue;
+      }
+
+      for (const char* name : {"node","way","relation"}) {
+        size_t length=strlen(name);
+
+        if (pos+length+1<buffer.size() &&
+            buffer.compare(pos+1,length,name)==0) {
+          char next=buffer[pos+1+length];
+
+          if (next==' ' || next=='\t' || next=='\n' || next=='\r' || next=='>' || next=='/') {
+            lastStart=pos;
+          }
+        }
+      }
+
+      pos++;
+    }
+
+    return lastStart;
+  }
+
   static void StartElement(void *data, const xmlChar *name, const xmlChar **atts)
   {
     auto* parser=static_cast<Parser*>(data);
@@ -378,10 +1028,17 @@ namespace osmscout {
   }
 
   bool PreprocessOSM::Import(const TypeConfigRef& typeConfig,
-                             const ImportParameter& /*parameter*/,
+                             const ImportParameter& parameter,
                              Progress& progress,
                              const std::string& filename)
   {
+    if (parameter.GetParallelOSMParsing()) {
+      return ImportParallel(typeConfig,
+                            parameter,
+                            progress,
+                            filename);
+    }
+
     progress.SetAction(std::string("Parsing *.osm file '")+filename+"'");
 
     Parser        parser(*typeConfig,
@@ -420,8 +1077,12 @@ namespace osmscout {
 
     ctxt=xmlCreatePushParserCtxt(&saxParser,&parser,chars,res,nullptr);
 
-    // Resolve entities, do not do any network communication
-    xmlCtxtUseOptions(ctxt,XML_PARSE_NOENT|XML_PARSE_NONET);
+    // Resolve entities, do not do any network communication. Newer versions
+    // of libxml2 only call the SAX1 element callbacks, if explicitly requested,
+    // older versions replace them with their defaults in this case
+    xmlCtxtUseOptions(ctxt,XML_PARSE_NOENT|XML_PARSE_NONET|XML_PARSE_SAX1);
+    ctxt->sax->startElement=StartElement;
+    ctxt->sax->endElement=EndElement;
 
     while ((res=fread(chars,1,sizeof(chars),file))>0) {
       if (xmlParseChunk(ctxt,chars,res,0)!=0) {
@@ -446,4 +1107,118 @@ namespace osmscout {
 
     return true;
   }
+
+  /**
+   * Read the file in chunks, that are split at element boundaries, parse the chunks
+   * in parallel using ChunkParser and pass the resulting blocks in file order
+   * to the callback.
+   */
+  bool PreprocessOSM::ImportParallel(const TypeConfigRef& typeConfig,
+                                     const ImportParameter& parameter,
+                                     Progress& progress,
+                                     const std::string& filename)
+  {
+    const size_t chunkSize=std::max(parameter.GetParallelOSMChunkSize(),(size_t)1);
+    size_t       maxChunksInFlight=std::max((unsigned int)1,std::thread::hardware_concurrency())*2;
+    FileOffset   fileSize;
+    FileOffset   bytesRead=0;
+
+    progress.SetAction(std::string("Parsing *.osm file '")+filename+"' in parallel");
+
+    try {
+      fileSize=GetFileSize(filename);
+    }
+    catch (IOException& e) {
+      progress.Error(e.GetDescription());
+      return false;
+    }
+
+    FILE *file=fopen(filename.c_str(),"rb");
+
+    if (file==nullptr) {
+      progress.Error("Cannot open file!");
+      return false;
+    }
+
+    std::deque<std::future<ChunkParser::Result>> chunks;
+    std::string                                  buffer;
+    std::vector<char>                            readBuffer(chunkSize);
+    bool                                         success=true;
+
+    auto processNextChunk=[&]() {
+      ChunkParser::Result result=chunks.front().get();
+
+      chunks.pop_front();
+
+      for (const auto& error : result.errors) {
+        progress.Error(error);
+      }
+
+      for (auto& block : result.blocks) {
+        try {
+          callback.ProcessBlock(std::move(block));
+        }
+        catch (IOException& e) {
+          progress.Error(e.GetDescription());
+          success=false;
+        }
+      }
+    };
+
+    auto parseChunk=[&typeConfig](const std::string& chunk) {
+      ChunkParser parser(*typeConfig);
+
+      return parser.Parse(chunk);
+    };
+
+    while (true) {
+      size_t res=fread(readBuffer.data(),1,readBuffer.size(),file);
+
+      if (res==0) {
+        if (ferror(file)!=0) {
+          progress.Error("Error while reading file!");
+          success=false;
+        }
+        break;
+      }
+
+      bytesRead+=res;
+      progress.SetProgress(bytesRead,fileSize);
+
+      buffer.append(readBuffer.data(),res);
+
+      size_t splitPos=FindLastElementStart(buffer);
+
+      if (splitPos==0) {
+        // the current element does not fit into the buffer, read more
+        continue;
+      }
+
+      std::string chunk=buffer.substr(0,splitPos);
+
+      buffer.erase(0,splitPos);
+
+      if (chunks.size()>=maxChunksInFlight) {
+        processNextChunk();
+      }
+
+      chunks.push_back(std::async(std::launch::async,
+                                  parseChunk,
+                                  std::move(chunk)));
+    }
+
+    fclose(file);
+
+    if (!buffer.empty()) {
+      chunks.push_back(std::async(std::launch::async,
+                                  parseChunk,
+                                  std::move(buffer)));
+    }
+
+    while (!chunks.empty()) {
+      processNextChunk();
+    }
+
+    return success;
+  }
 }
@@ -154,6 +154,7 @@ namespace osmscout {
   {
   private:
     std::vector<Point> nodeBuffer;
+    bool               reduceNodes;
     size_t             duplicateCount;
     size_t             redundantCount;
     size_t             overallCount;
@@ -187,10 +188,13 @@ namespace osmscout {
                             const TypeConfig& typeConfig) override;
   };
 
-  bool WayNodeReductionProcessorFilter::BeforeProcessingStart(const ImportParameter& /*parameter*/,
+  bool WayNodeReductionProcessorFilter::BeforeProcessingStart(const ImportParameter& parameter,
                                                               Progress& /*progress*/,
                                                               const TypeConfig& /*typeConfig*/)
   {
+    // Updatable databases keep all nodes, since a later update moving a node
+    // must be able to find it in all objects using it
+    reduceNodes=!parameter.IsUpdatable();
     duplicateCount=0;
     redundantCount=0;
     overallCount=0;
@@ -326,6 +330,10 @@ namespace osmscout {
   {
     overallCount+=way.nodes.size();
 
+    if (!reduceNodes) {
+      return true;
+    }
+
     if (!RemoveDuplicateNodes(progress,
                               offset,
                               way,
@@ -43,7 +43,8 @@ namespace osmscout {
                new CoordBuffer()),
     labelLayouter(this)
   {
-    // no code
+    // labels reference glyphs of the font cache manager, which may get evicted
+    labelLayouter.SetLayoutCache(nullptr);
   }
 
   MapPainterAgg::~MapPainterAgg()
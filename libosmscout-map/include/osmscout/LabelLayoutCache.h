@@ -0,0 +1,225 @@
+#ifndef OSMSCOUT_MAP_LABELLAYOUTCACHE_H
+#define OSMSCOUT_MAP_LABELLAYOUTCACHE_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <osmscout/MapImportExport.h>
+
+#include <osmscout/MapParameter.h>
+
+#include <osmscout/util/Cache.h>
+#include <osmscout/util/Projection.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * Key of a shaped label in the LabelLayoutCache. It holds all values that
+   * influence the result of TextLayouter::Layout().
+   */
+  class OSMSCOUT_MAP_API LabelLayoutKey
+  {
+  public:
+    std::string text;                  //!< The label text
+    std::string fontName;              //!< Name of the font
+    double      fontSize;              //!< Font size relative to the standard font size
+    double      pixelFontSize;         //!< Resulting font size in pixel
+    double      objectWidth;           //!< Width of the object in pixel, used for wrapping
+    bool        enableWrapping;        //!< Label text may get wrapped
+    bool        contourLabel;          //!< Label is drawn along a path
+    size_t      labelLineMinCharCount; //!< Wrapping parameter, see MapParameter
+    size_t      labelLineMaxCharCount; //!< Wrapping parameter, see MapParameter
+    bool        labelLineFitToArea;    //!< Wrapping parameter, see MapParameter
+    double      labelLineFitToWidth;   //!< Wrapping parameter, see MapParameter
+
+  public:
+    LabelLayoutKey(const Projection& projection,
+                   const MapParameter& parameter,
+                   const std::string& text,
+                   double fontSize,
+                   double objectWidth,
+                   bool enableWrapping,
+                   bool contourLabel);
+
+    bool operator==(const LabelLayoutKey& other) const;
+
+    size_t Hash() const;
+  };
+}
+
+namespace std {
+  template <>
+  struct hash<osmscout::LabelLayoutKey>
+  {
+    size_t operator()(const osmscout::LabelLayoutKey& key) const
+    {
+      return key.Hash();
+    }
+  };
+}
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * Bounded, thread-safe LRU cache of shaped labels, as returned by the
+   * TextLayouter of LabelLayouter. Since shaping of text is expensive and the
+   * same street and place names get layouted again and again for every tile and
+   * frame, a backend can keep the result of the layout between render calls.
+   *
+   * The cache only holds references to the labels. Labels must not be changed after
+   * their layout and the native label must stay valid independent of the state of the
+   * painter, if the cache is shared between multiple painters.
+   */
+  template <class LabelType>
+  class LabelLayoutCache
+  {
+  public:
+    using LabelPtr = std::shared_ptr<LabelType>;
+
+  private:
+    using LayoutCache = Cache<LabelLayoutKey, LabelPtr>;
+
+  private:
+    mutable std::mutex mutex;
+    LayoutCache        cache;
+    size_t             hits;   //!< Number of cache hits
+    size_t             misses; //!< Number of cache misses
+
+  public:
+    explicit LabelLayoutCache(size_t maxSize)
+    : cache(maxSize),
+      hits(0),
+      misses(0)
+    {
+      // no code
+    }
+
+    /**
+     * Change the maximum number of cached labels. A size of 0 disables the cache.
+     */
+    void SetMaxSize(size_t maxSize)
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      cache.SetMaxSize(maxSize);
+    }
+
+    size_t GetMaxSize() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      return cache.GetMaxSize();
+    }
+
+    size_t GetSize() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      return cache.GetSize();
+    }
+
+    /**
+     * Return the cached label for the given key or call layout() and store its result.
+     * The layout function is called without holding the lock of the cache.
+     */
+    template <typename LayoutFunction>
+    LabelPtr GetLabel(const LabelLayoutKey& key,
+                      LayoutFunction layout)
+    {
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        typename LayoutCache::CacheRef entry;
+
+        if (cache.GetEntry(key,entry)) {
+          hits++;
+
+          return entry->value;
+        }
+
+        misses++;
+      }
+
+      LabelPtr label=layout();
+
+      std::lock_guard<std::mutex> guard(mutex);
+
+      if (cache.IsActive()) {
+        cache.SetEntry(typename LayoutCache::CacheEntry(key,label));
+      }
+
+      return label;
+    }
+
+    /**
+     * Remove all labels from the cache.
+     */
+    void Flush()
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      cache.Flush();
+    }
+
+    size_t GetHits() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      return hits;
+    }
+
+    size_t GetMisses() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      return misses;
+    }
+
+    /**
+     * Return the ratio of cache hits to cache lookups (0.0 if there was no lookup yet)
+     */
+    double GetHitRate() const
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      if (hits+misses==0) {
+        return 0.0;
+      }
+
+      return (double)hits/(double)(hits+misses);
+    }
+
+    void ResetStatistics()
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+
+      hits=0;
+      misses=0;
+    }
+  };
+}
+
+#endif
@@ -23,10 +23,12 @@
 #include <memory>
 #include <set>
 #include <array>
+#include <vector>
 
 #include <osmscout/MapImportExport.h>
 
 #include <osmscout/StyleConfig.h>
+#include <osmscout/LabelLayoutCache.h>
 #include <osmscout/LabelPath.h>
 #include <osmscout/system/Math.h>
 
@@ -232,6 +234,51 @@ namespace osmscout {
     int rowTo{0};
   };
 
+  /**
+   * Occupancy bitmap used for label collision detection. Each bit represents
+   * one pixel, each row consists of rowSize 64 bit words.
+   *
+   * Additionally the canvas keeps a coarse summary level with one bit for each
+   * word column of a block of BlockRows rows, that is set if any word of the
+   * column within the block is occupied. Collision checks skip empty blocks
+   * without touching the words of the canvas and reset only clears occupied
+   * blocks, so the canvas can be reused cheaply for the next layout.
+   */
+  class OSMSCOUT_MAP_API LabelCanvas
+  {
+  public:
+    static constexpr int64_t BlockRows = 16; //!< Number of pixel rows summarized in one block
+
+  private:
+    int64_t               rowSize{0};        //!< Number of words per row
+    int64_t               height{0};         //!< Number of rows
+    int64_t               summaryRowSize{0}; //!< Number of summary words per block
+    std::vector<uint64_t> d;                 //!< Occupancy of pixels
+    std::vector<uint64_t> summary;           //!< Occupancy of word columns per block
+
+  private:
+    bool IsBlockOccupied(int64_t block,
+                         int64_t cellFrom,
+                         int64_t cellTo) const;
+
+  public:
+    void Reset(int64_t rowSize,
+               int64_t height);
+
+    bool CheckCollision(const Mask& mask) const;
+    void Mark(const Mask& mask);
+
+    inline int64_t GetRowSize() const
+    {
+      return rowSize;
+    }
+
+    inline int64_t GetHeight() const
+    {
+      return height;
+    }
+  };
+
   template <class NativeGlyph, class NativeLabel>
   static bool LabelInstanceSorter(const LabelInstance<NativeGlyph, NativeLabel> &a,
                                   const LabelInstance<NativeGlyph, NativeLabel> &b)
@@ -276,6 +323,8 @@ namespace osmscout {
    *                                        bool enableWrapping = false,
    *                                        bool contourLabel = false);
    *
+   * Results of Layout are kept in a LabelLayoutCache between render calls, if
+   * MapParameter::GetLabelLayoutCacheSize() is not 0.
    */
   template <class NativeGlyph, class NativeLabel, class TextLayouter>
   class LabelLayouter
@@ -286,10 +335,13 @@ namespace osmscout {
     using LabelType = Label<NativeGlyph, NativeLabel>;
     using LabelPtr = std::shared_ptr<LabelType>;
     using LabelInstanceType = LabelInstance<NativeGlyph, NativeLabel>;
+    using LayoutCacheType = LabelLayoutCache<LabelType>;
+    using LayoutCacheRef = std::shared_ptr<LayoutCacheType>;
 
   public:
     LabelLayouter(TextLayouter *textLayouter):
         textLayouter(textLayouter),
+        layoutCache(std::make_shared<LayoutCacheType>(0)),
         visibleViewport{0,0,0,0},
         layoutViewport{0,0,0,0},
         layoutOverlap{0}
@@ -313,36 +365,26 @@ namespace osmscout {
       layoutViewport.y = visibleViewport.y - (visibleViewport.height * overlap) / 2;
     }
 
-    void Reset()
+    /**
+     * Replace the cache for label layouts, for example to share it between multiple
+     * painters of the same backend. Passing nullptr disables caching, which is
+     * required, if native labels reference painter state that changes between
+     * render calls.
+     */
+    void SetLayoutCache(const LayoutCacheRef& cache)
     {
-      contourLabelInstances.clear();
-      labelInstances.clear();
+      layoutCache = cache;
     }
 
-    inline bool CheckLabelCollision(const std::vector<uint64_t> &canvas,
-                                    const Mask &mask,
-                                    int64_t viewportHeight
-    )
+    LayoutCacheRef GetLayoutCache() const
     {
-      bool collision=false;
-      for (int r=std::max(0,mask.rowFrom); !collision && r<=std::min((int)viewportHeight-1, mask.rowTo); r++){
-        for (int c=std::max(0,mask.cellFrom); !collision && c<=std::min((int)mask.size()-1,mask.cellTo); c++){
-          collision |= (mask.d[c] & canvas[r*mask.size() + c]) != 0;
-        }
-      }
-      return collision;
+      return layoutCache;
     }
 
-    inline void MarkLabelPlace(std::vector<uint64_t> &canvas,
-                               const Mask &mask,
-                               int viewportHeight
-    )
+    void Reset()
     {
-      for (int r=std::max(0,mask.rowFrom); r<=std::min((int)viewportHeight-1, mask.rowTo); r++){
-        for (int c=std::max(0,mask.cellFrom); c<=std::min((int)mask.size()-1, mask.cellTo); c++){
-          canvas[r*mask.size() + c] = mask.d[c] | canvas[r*mask.size() + c];
-        }
-      }
+      contourLabelInstances.clear();
+      labelInstances.clear();
     }
 
     // Something is an overlay, if its alpha is <0.8
@@ -376,9 +418,9 @@ namespace osmscout {
 
       // compute collisions, hide some labels
       int64_t rowSize = (layoutViewport.width / 64)+1;
-      std::vector<uint64_t> iconCanvas((size_t)(rowSize*layoutViewport.height));
-      std::vector<uint64_t> labelCanvas((size_t)(rowSize*layoutViewport.height));
-      std::vector<uint64_t> overlayCanvas((size_t)(rowSize*layoutViewport.height));
+      iconCanvas.Reset(rowSize, (int64_t)layoutViewport.height);
+      labelCanvas.Reset(rowSize, (int64_t)layoutViewport.height);
+      overlayCanvas.Reset(rowSize, (int64_t)layoutViewport.height);
 
       auto labelIter = allSortedLabels.begin();
       auto contourLabelIter = allSortedContourLabels.begin();
@@ -401,7 +443,7 @@ namespace osmscout {
         if (currentLabel != allSortedLabels.end()){
           Mask m(rowSize);
           std::vector<Mask> masks(currentLabel->elements.size(), m);
-          std::vector<std::vector<uint64_t> *> canvases(currentLabel->elements.size(), nullptr);
+          std::vector<LabelCanvas *> canvases(currentLabel->elements.size(), nullptr);
 
           std::vector<typename LabelInstance<NativeGlyph, NativeLabel>::Element> visibleElements;
 
@@ -423,7 +465,7 @@ namespace osmscout {
             IntRectangle rectangle{ (int)std::floor(element.x - layoutViewport.x - padding),
                                     (int)std::floor(element.y - layoutViewport.y - padding),
                                     0, 0 };
-            std::vector<uint64_t> *canvas = &labelCanvas;
+            LabelCanvas *canvas = &labelCanvas;
             if (element.labelData.type==LabelData::Icon || element.labelData.type==LabelData::Symbol){
               if (element.labelData.iconStyle->IsOverlay()) {
                 rectangle.width = 0;
@@ -458,7 +500,7 @@ namespace osmscout {
               }
             }
             row.prepare(rectangle);
-            bool collision = CheckLabelCollision(*canvas, row, layoutViewport.height);
+            bool collision = canvas->CheckCollision(row);
             if (!collision) {
               visibleElements.push_back(element);
               canvases[eli]=canvas;
@@ -479,7 +521,7 @@ namespace osmscout {
             // mark all labels at once
             for (size_t eli=0; eli < currentLabel->elements.size(); eli++) {
               if (canvases[eli] != nullptr) {
-                MarkLabelPlace(*(canvases[eli]), masks[eli], layoutViewport.height);
+                canvases[eli]->Mark(masks[eli]);
               }
             }
           }
@@ -507,11 +549,11 @@ namespace osmscout {
                 (int)(glyph.trHeight + 2*contourLabelPadding)
             };
             masks[gi].prepare(rect);
-            collision |= CheckLabelCollision(labelCanvas, masks[gi], layoutViewport.height);
+            collision |= labelCanvas.CheckCollision(masks[gi]);
           }
           if (!collision) {
             for (int gi=0; gi<glyphCnt; gi++) {
-              MarkLabelPlace(labelCanvas, masks[gi], layoutViewport.height);
+              labelCanvas.Mark(masks[gi]);
             }
             contourLabelInstances.push_back(*currentContourLabel);
           }
@@ -644,11 +686,11 @@ namespace osmscout {
           instance.priority = std::min(d.priority, instance.priority);
           // TODO: should we take style into account?
           // Qt allows to split text layout and style setup
-          element.label = textLayouter->Layout(projection, parameter,
-                                               d.text, d.fontSize,
-                                               objectWidth,
-                                               /*enable wrapping*/ true,
-                                               /*contour label*/ false);
+          element.label = LayoutText(projection, parameter,
+                                     d.text, d.fontSize,
+                                     objectWidth,
+                                     /*enable wrapping*/ true,
+                                     /*contour label*/ false);
           element.x = point.GetX() - element.label->width / 2;
           if (offset<0){
             element.y = point.GetY() - element.label->height / 2;
@@ -669,8 +711,7 @@ namespace osmscout {
                               const PathLabelData &labelData,
                               const LabelPath &labelPath)
     {
-      // TODO: cache label for string and font parameters
-      LabelPtr label = textLayouter->Layout(
+      LabelPtr label = LayoutText(
           projection,
           parameter,
           labelData.text,
@@ -801,10 +842,55 @@ namespace osmscout {
       return contourLabelInstances;
     }
 
+  private:
+    LabelPtr LayoutText(const Projection& projection,
+                        const MapParameter& parameter,
+                        const std::string& text,
+                        double fontSize,
+                        double objectWidth,
+                        bool enableWrapping,
+                        bool contourLabel)
+    {
+      if (!layoutCache ||
+          parameter.GetLabelLayoutCacheSize()==0) {
+        return textLayouter->Layout(projection, parameter,
+                                    text, fontSize,
+                                    objectWidth,
+                                    enableWrapping,
+                                    contourLabel);
+      }
+
+      if (layoutCache->GetMaxSize()!=parameter.GetLabelLayoutCacheSize()) {
+        layoutCache->SetMaxSize(parameter.GetLabelLayoutCacheSize());
+      }
+
+      // object width of area labels differs slightly for every tile, round it
+      // to full pixels to make the layout reusable
+      objectWidth = std::ceil(objectWidth);
+
+      LabelLayoutKey key(projection, parameter,
+                         text, fontSize,
+                         objectWidth,
+                         enableWrapping,
+                         contourLabel);
+
+      return layoutCache->GetLabel(key, [&]() {
+        return textLayouter->Layout(projection, parameter,
+                                    text, fontSize,
+                                    objectWidth,
+                                    enableWrapping,
+                                    contourLabel);
+      });
+    }
+
   private:
     TextLayouter *textLayouter;
+    LayoutCacheRef layoutCache;
     std::vector<ContourLabelType> contourLabelInstances;
     std::vector<LabelInstanceType> labelInstances;
+    LabelCanvas iconCanvas;    //!< Kept between layouts to reuse its memory
+    LabelCanvas labelCanvas;   //!< Kept between layouts to reuse its memory
+    LabelCanvas overlayCanvas; //!< Kept between layouts to reuse its memory
     DoubleRectangle visibleViewport;
     DoubleRectangle layoutViewport;
     double layoutOverlap; // overlap ratio used for label layouting
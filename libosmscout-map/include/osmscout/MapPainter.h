@@ -20,7 +20,9 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <functional>
 #include <list>
+#include <memory>
 #include <string>
 
 #include <osmscout/MapImportExport.h>
@@ -40,6 +42,7 @@
 #include <osmscout/MapData.h>
 
 #include <osmscout/util/Breaker.h>
+#include <osmscout/util/Cache.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/Transformation.h>
@@ -213,6 +216,64 @@ namespace osmscout {
     FeatureValueBuffer           coastlineSegmentAttributes;
     //@}
 
+  private:
+    /**
+     * References to the coordinate buffer, style scratch space and result lists
+     * preprocessing of ways and areas writes to. Either the painter's own members
+     * or the buffers of one PreprocessWorker.
+     */
+    struct PreprocessBuffers
+    {
+      TransBuffer               &transBuffer;
+      std::vector<LineStyleRef> &lineStyles;
+      std::list<WayData>        &wayData;
+      std::list<WayPathData>    &wayPathData;
+      std::list<AreaData>       &areaData;
+    };
+
+    /**
+     * Thread local state of one worker during parallel preprocessing. Workers are
+     * kept between render calls to avoid reallocation of their coordinate buffers.
+     */
+    struct PreprocessWorker
+    {
+      TransBuffer               transBuffer;
+      std::vector<LineStyleRef> lineStyles;
+      std::list<WayData>        wayData;
+      std::list<WayPathData>    wayPathData;
+      std::list<AreaData>       areaData;
+
+      PreprocessWorker();
+
+      void Reset();
+      PreprocessBuffers GetBuffers();
+    };
+
+    typedef std::function<void(PreprocessBuffers&,size_t)> PreprocessFunction;
+
+    /**
+     * Styled and transformed geometry of one way or area, kept between render calls.
+     * Coordinates are stored in world pixel space (relative to the pixel position
+     * of GeoCoord(0,0)), so that they can be reused by just translating them if the
+     * projection was only moved. transStart and transEnd of the data entries are
+     * relative to the start of coords.
+     */
+    struct GeometryCacheEntry
+    {
+      TypeInfoRef            type;        //!< Type of the object, to detect reuse of the file offset
+      size_t                 size;        //!< Number of nodes (ways) or rings (areas) of the object
+      GeoBox                 boundingBox; //!< Bounding box of the object
+      double                 pixelOffset; //!< Maximum line or border width, for visibility check
+      std::vector<Vertex2D>  coords;      //!< Coordinates in world pixel space
+      std::list<WayData>     wayData;
+      std::list<WayPathData> wayPathData;
+      std::list<AreaData>    areaData;
+      std::vector<size_t>    areaRings;   //!< Ring index of each areaData entry or std::numeric_limits<size_t>::max() if the buffer is nullptr
+    };
+
+    typedef std::shared_ptr<GeometryCacheEntry>     GeometryCacheEntryRef;
+    typedef Cache<FileOffset,GeometryCacheEntryRef> GeometryCache;
+
   private:
     std::vector<StepMethod>      stepMethods;
     double                       errorTolerancePixel;
@@ -224,6 +285,25 @@ namespace osmscout {
     std::vector<TextStyleRef>    textStyles;     //!< Temporary storage for StyleConfig return value
     std::vector<LineStyleRef>    lineStyles;     //!< Temporary storage for StyleConfig return value
 
+    std::vector<std::unique_ptr<PreprocessWorker>> preprocessWorkers; //!< Thread local state for parallel preprocessing
+
+    /**
+     * Cache of styled geometry between render calls
+     */
+    //@{
+    GeometryCache                wayGeometryCache;
+    GeometryCache                areaGeometryCache;
+    bool                         geometryCacheActive;     //!< Cache can be used in the current render call
+    Magnification                geometryCacheMagnification;
+    double                       geometryCacheDPI;
+    double                       geometryCachePixelSize;
+    double                       geometryCacheTolerance;
+    double                       geometryCacheOriginX;    //!< Pixel position of the world pixel space origin in the current render call
+    double                       geometryCacheOriginY;
+    size_t                       geometryCacheHits;
+    size_t                       geometryCacheMisses;
+    //@}
+
     /**                           L
      Precalculations
       */
@@ -292,12 +372,50 @@ namespace osmscout {
                       const MapParameter& parameter,
                       const MapData& data);
 
+    PreprocessBuffers GetPreprocessBuffers();
+
+    void PrepareGeometryCache(const Projection& projection,
+                              const MapParameter& parameter);
+
+    GeometryCacheEntryRef GetCachedGeometry(GeometryCache& cache,
+                                            FileOffset offset,
+                                            const TypeInfoRef& type,
+                                            size_t size);
+
+    bool IsGeometryCacheable(const Projection& projection,
+                             const GeoBox& boundingBox) const;
+
+    GeometryCacheEntryRef CaptureGeometry(PreprocessBuffers& buffers,
+                                          size_t coordStart,
+                                          size_t wayDataCount,
+                                          size_t wayPathDataCount,
+                                          size_t areaDataCount) const;
+
+    void EmitCachedGeometry(const GeometryCacheEntry& entry,
+                            PreprocessBuffers& buffers,
+                            size_t& coordStart) const;
+
+    void EmitCachedWay(const Projection& projection,
+                       const GeometryCacheEntry& entry,
+                       const Way& way,
+                       PreprocessBuffers& buffers) const;
+
+    void EmitCachedArea(const Projection& projection,
+                        const GeometryCacheEntry& entry,
+                        const Area& area,
+                        PreprocessBuffers& buffers) const;
+
+    void Preprocess(const MapParameter& parameter,
+                    size_t objectCount,
+                    const PreprocessFunction& function);
+
     void CalculatePaths(const StyleConfig& styleConfig,
                         const Projection& projection,
                         const MapParameter& parameter,
                         const ObjectFileRef& ref,
                         const FeatureValueBuffer& buffer,
-                        const Way& way);
+                        const Way& way,
+                        PreprocessBuffers& buffers) const;
 
     void PrepareWays(const StyleConfig& styleConfig,
                      const Projection& projection,
@@ -307,7 +425,8 @@ namespace osmscout {
     void PrepareArea(const StyleConfig& styleConfig,
                      const Projection& projection,
                      const MapParameter& parameter,
-                     const AreaRef &area);
+                     const AreaRef &area,
+                     PreprocessBuffers& buffers) const;
 
     void PrepareAreaLabel(const StyleConfig& styleConfig,
                           const Projection& projection,
@@ -616,13 +735,15 @@ namespace osmscout {
 
     //@}
 
-    std::vector<OffsetRel> ParseLaneTurns(const LanesFeatureValue&);
+    std::vector<OffsetRel> ParseLaneTurns(const LanesFeatureValue&) const;
 
   public:
     MapPainter(const StyleConfigRef& styleConfig,
                CoordBuffer *buffer);
     virtual ~MapPainter();
 
+    void FlushGeometryCache();
+
     bool Draw(const Projection& projection,
               const MapParameter& parameter,
               const MapData& data,
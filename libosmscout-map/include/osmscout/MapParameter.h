@@ -69,6 +69,9 @@ namespace osmscout {
     double                              optimizeErrorToleranceMm;  //!< The maximum error to allow when optimizing lines, in mm
     bool                                drawFadings;               //!< Draw label fadings (default: true)
     bool                                drawWaysWithFixedWidth;    //!< Draw ways using the size of the style sheet, if if the way has a width explicitly given
+    size_t                              preprocessingThreads;      //!< Number of threads used for preprocessing of ways and areas (default 1)
+    size_t                              geometryCacheSize;         //!< Number of ways and areas, whose styled geometry is kept between render calls (default 0, disabled)
+    size_t                              labelLayoutCacheSize;      //!< Number of shaped labels kept between render calls (default 0, disabled)
 
     // Node and area labels, icons
     size_t                              labelLineMinCharCount;     //!< Labels will be _never_ word wrapped if they are shorter then the given characters
@@ -133,6 +136,10 @@ namespace osmscout {
     void SetDrawFadings(bool drawFadings);
     void SetDrawWaysWithFixedWidth(bool drawWaysWithFixedWidth);
 
+    void SetPreprocessingThreads(size_t threads);
+    void SetGeometryCacheSize(size_t size);
+    void SetLabelLayoutCacheSize(size_t size);
+
     void SetLabelLineMinCharCount(size_t labelLineMinCharCount);
     void SetLabelLineMaxCharCount(size_t labelLineMaxCharCount);
     void SetLabelLineFitToArea(bool labelLineFitToArea);
@@ -234,6 +241,21 @@ namespace osmscout {
       return drawWaysWithFixedWidth;
     }
 
+    inline size_t GetPreprocessingThreads() const
+    {
+      return preprocessingThreads;
+    }
+
+    inline size_t GetGeometryCacheSize() const
+    {
+      return geometryCacheSize;
+    }
+
+    inline size_t GetLabelLayoutCacheSize() const
+    {
+      return labelLayoutCacheSize;
+    }
+
     inline size_t GetLabelLineMinCharCount() const
     {
       return labelLineMinCharCount;
@@ -35,6 +35,8 @@
 
 #include <osmscout/util/Breaker.h>
 #include <osmscout/util/GeoBox.h>
+#include <osmscout/util/Metrics.h>
+#include <osmscout/util/ObjectArena.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/WorkQueue.h>
 
@@ -56,6 +58,7 @@ namespace osmscout {
     bool          useLowZoomOptimization;
     BreakerRef    breaker;
     bool          useMultithreading;
+    bool          useObjectArena;
 
   public:
     AreaSearchParameter();
@@ -66,6 +69,8 @@ namespace osmscout {
 
     void SetUseMultithreading(bool useMultithreading);
 
+    void SetUseObjectArena(bool useObjectArena);
+
     void SetBreaker(const BreakerRef& breaker);
 
     unsigned long GetMaximumAreaLevel() const;
@@ -74,6 +79,8 @@ namespace osmscout {
 
     bool GetUseMultithreading() const;
 
+    bool GetUseObjectArena() const;
+
     bool IsAborted() const;
   };
 
@@ -104,6 +111,17 @@ namespace osmscout {
 
     typedef std::shared_ptr<TypeDefinition> TypeDefinitionRef;
 
+    /**
+     * Statistics about the loading of tile data
+     */
+    struct OSMSCOUT_MAP_API Statistics
+    {
+      size_t arenaCount=0;           //!< Number of object arenas used for loading
+      size_t arenaAllocationCount=0; //!< Number of allocations from object arenas
+      size_t arenaAllocatedBytes=0;  //!< Number of bytes allocated from object arenas
+      size_t arenaBlockCount=0;      //!< Number of memory blocks allocated by object arenas
+    };
+
   public:
     typedef size_t                              CallbackId;
     typedef std::function<void(const TileRef&)> TileStateCallback;
@@ -114,6 +132,16 @@ namespace osmscout {
     DatabaseRef                  database;             //!< The reference to the database
     mutable DataTileCache        cache;                //!< Data cache
 
+    mutable std::mutex           statisticsMutex;      //!< Mutex to protect statistics
+    mutable Statistics           statistics;           //!< Loading statistics
+
+    MetricHistogram&             tileLoadTime;         //!< Latency of loading all missing data of the requested tiles
+    MetricHistogram&             nodeLoadTime;         //!< Latency of loading the nodes of a tile
+    MetricHistogram&             wayLoadTime;          //!< Latency of loading the ways of a tile
+    MetricHistogram&             wayLowZoomLoadTime;   //!< Latency of loading the optimized ways of a tile
+    MetricHistogram&             areaLoadTime;         //!< Latency of loading the areas of a tile
+    MetricHistogram&             areaLowZoomLoadTime;  //!< Latency of loading the optimized areas of a tile
+
     mutable WorkQueue<bool>      nodeWorkerQueue;
     std::thread                  nodeWorkerThread;
 
@@ -168,6 +196,7 @@ namespace osmscout {
 
     bool GetWays(const AreaSearchParameter& parameter,
                  const TypeInfoSet& wayTypes,
+                 const Magnification& magnification,
                  const GeoBox& boundingBox,
                  bool prefill,
                  const TileRef& tile) const;
@@ -207,12 +236,18 @@ namespace osmscout {
 
     std::future<bool> PushWayTask(const AreaSearchParameter& parameter,
                                   const TypeInfoSet& wayTypes,
+                                  const Magnification& magnification,
                                   const GeoBox& boundingBox,
                                   bool prefill,
                                   const TileRef& tile) const;
 
     void NotifyTileStateCallbacks(const TileRef& tile) const;
 
+    ObjectArenaRef CreateObjectArena(const AreaSearchParameter& parameter) const;
+    void UpdateStatistics(const ObjectArenaRef& arena) const;
+
+    bool CanPrefillGeometryFromParent(const Tile& tile) const;
+
     bool LoadMissingTileDataStyleSheet(const AreaSearchParameter& parameter,
                                        const StyleConfig& styleConfig,
                                        std::list<TileRef>& tiles,
@@ -277,6 +312,9 @@ namespace osmscout {
                         const Magnification& magnification,
                         std::list<GroundTile>& tiles) const;
 
+    Statistics GetStatistics() const;
+    void DumpStatistics() const;
+
     CallbackId RegisterTileStateCallback(TileStateCallback callback);
     void DeregisterTileStateCallback(CallbackId callbackId);
   };
@@ -213,6 +213,46 @@ namespace osmscout {
     void SetMaxMM(double maxMM);
     void SetMaxPx(double maxPx);
 
+    inline bool HasMinMM() const
+    {
+      return minMMSet;
+    }
+
+    inline double GetMinMM() const
+    {
+      return minMM;
+    }
+
+    inline bool HasMinPx() const
+    {
+      return minPxSet;
+    }
+
+    inline double GetMinPx() const
+    {
+      return minPx;
+    }
+
+    inline bool HasMaxMM() const
+    {
+      return maxMMSet;
+    }
+
+    inline double GetMaxMM() const
+    {
+      return maxMM;
+    }
+
+    inline bool HasMaxPx() const
+    {
+      return maxPxSet;
+    }
+
+    inline double GetMaxPx() const
+    {
+      return maxPx;
+    }
+
     bool Evaluate(double meterInPixel, double meterInMM) const;
   };
 
@@ -345,11 +385,21 @@ namespace osmscout {
              sizeCondition;
     }
 
+    inline const std::list<FeatureFilterData>& GetFeatures() const
+    {
+      return features;
+    }
+
     inline bool GetOneway() const
     {
       return oneway;
     }
 
+    inline const SizeConditionRef& GetSizeCondition() const
+    {
+      return sizeCondition;
+    }
+
     bool Matches(const StyleResolveContext& context,
                  const FeatureValueBuffer& buffer,
                  double meterInPixel,
@@ -638,6 +688,11 @@ namespace osmscout {
     void PostprocessIconId();
     void PostprocessPatternId();
 
+    bool ReadCache(const std::string& cacheFile,
+                   uint64_t cacheKey);
+    void WriteCache(const std::string& cacheFile,
+                    uint64_t cacheKey) const;
+
   public:
     explicit StyleConfig(const TypeConfigRef& typeConfig);
     virtual ~StyleConfig();
@@ -803,6 +858,8 @@ namespace osmscout {
                     ColorPostprocessor colorPostprocessor=nullptr);
     bool Load(const std::string& styleFile,
               ColorPostprocessor colorPostprocessor=nullptr);
+    bool LoadCached(const std::string& styleFile,
+                    const std::string& cacheDirectory);
     const std::list<std::string>&  GetErrors();
     const std::list<std::string>&  GetWarnings();
     //@}
@@ -481,6 +481,11 @@ namespace osmscout {
     void AddAttribute(const StyleAttributeDescriptorRef& attribute);
 
   public:
+    const std::unordered_map<std::string,StyleAttributeDescriptorRef>& GetAttributes() const
+    {
+      return attributeMap;
+    }
+
     StyleAttributeDescriptorRef GetAttribute(const std::string& name) const
     {
       auto result=attributeMap.find(name);
@@ -0,0 +1,79 @@
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/LabelLayoutCache.h>
+
+#include <functional>
+
+namespace osmscout {
+
+  LabelLayoutKey::LabelLayoutKey(const Projection& projection,
+                                 const MapParameter& parameter,
+                                 const std::string& text,
+                                 double fontSize,
+                                 double objectWidth,
+                                 bool enableWrapping,
+                                 bool contourLabel)
+  : text(text),
+    fontName(parameter.GetFontName()),
+    fontSize(fontSize),
+    pixelFontSize(fontSize*projection.ConvertWidthToPixel(parameter.GetFontSize())),
+    objectWidth(objectWidth),
+    enableWrapping(enableWrapping),
+    contourLabel(contourLabel),
+    labelLineMinCharCount(parameter.GetLabelLineMinCharCount()),
+    labelLineMaxCharCount(parameter.GetLabelLineMaxCharCount()),
+    labelLineFitToArea(parameter.GetLabelLineFitToArea()),
+    labelLineFitToWidth(parameter.GetLabelLineFitToWidth())
+  {
+    // no code
+  }
+
+  bool LabelLayoutKey::operator==(const LabelLayoutKey& other) const
+  {
+    return text==other.text &&
+           fontName==other.fontName &&
+           fontSize==other.fontSize &&
+           pixelFontSize==other.pixelFontSize &&
+           objectWidth==other.objectWidth &&
+           enableWrapping==other.enableWrapping &&
+           contourLabel==other.contourLabel &&
+           labelLineMinCharCount==other.labelLineMinCharCount &&
+           labelLineMaxCharCount==other.labelLineMaxCharCount &&
+           labelLineFitToArea==other.labelLineFitToArea &&
+           labelLineFitToWidth==other.labelLineFitToWidth;
+  }
+
+  /**
+   * Only the text, the font and the geometry are hashed, the remaining values
+   * are usually the same for all labels.
+   */
+  size_t LabelLayoutKey::Hash() const
+  {
+    size_t hash=std::hash<std::string>{}(text);
+
+    hash=hash*31+std::hash<std::string>{}(fontName);
+    hash=hash*31+std::hash<double>{}(pixelFontSize);
+    hash=hash*31+std::hash<double>{}(objectWidth);
+    hash=hash*31+(enableWrapping ? 1 : 0);
+    hash=hash*31+(contourLabel ? 1 : 0);
+
+    return hash;
+  }
+}
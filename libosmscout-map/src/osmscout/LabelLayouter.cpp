@@ -19,6 +19,8 @@
 
 #include <osmscout/LabelLayouter.h>
 
+#include <algorithm>
+
 namespace osmscout {
   OSMSCOUT_MAP_API void Mask::prepare(const IntRectangle &rect)
   {
@@ -53,4 +55,132 @@ namespace osmscout {
       d[cellTo] = d[cellTo] & (mask >> (64 - cellToBit));
     }
   }
+
+  /**
+   * Prepare the canvas for a new layout with the given dimensions. If the
+   * dimensions did not change, only occupied blocks get cleared.
+   */
+  void LabelCanvas::Reset(int64_t newRowSize,
+                          int64_t newHeight)
+  {
+    newRowSize=std::max(int64_t(0),newRowSize);
+    newHeight=std::max(int64_t(0),newHeight);
+
+    if (newRowSize!=rowSize ||
+        newHeight!=height) {
+      rowSize=newRowSize;
+      height=newHeight;
+      summaryRowSize=rowSize/64+1;
+
+      d.assign((size_t)(rowSize*height),0);
+      summary.assign((size_t)(summaryRowSize*((height+BlockRows-1)/BlockRows)),0);
+
+      return;
+    }
+
+    int64_t blockCount=(height+BlockRows-1)/BlockRows;
+
+    for (int64_t block=0; block<blockCount; block++) {
+      auto summaryStart=summary.begin()+block*summaryRowSize;
+      auto summaryEnd=summaryStart+summaryRowSize;
+
+      if (std::find_if(summaryStart,summaryEnd,[](uint64_t bits) {
+            return bits!=0;
+          })==summaryEnd) {
+        continue;
+      }
+
+      // rows of a block are continuous in memory, clearing them as a whole is cheaper
+      // than clearing the occupied columns one by one
+      std::fill(summaryStart,summaryEnd,0);
+      std::fill(d.begin()+block*BlockRows*rowSize,
+                d.begin()+std::min(height,(block+1)*BlockRows)*rowSize,
+                0);
+    }
+  }
+
+  bool LabelCanvas::IsBlockOccupied(int64_t block,
+                                    int64_t cellFrom,
+                                    int64_t cellTo) const
+  {
+    constexpr uint64_t mask = ~0;
+
+    for (int64_t s=cellFrom/64; s<=cellTo/64; s++) {
+      uint64_t bits=summary[block*summaryRowSize+s];
+
+      if (s==cellFrom/64) {
+        bits&=mask << (cellFrom%64);
+      }
+
+      if (s==cellTo/64 && cellTo%64!=63) {
+        bits&=mask >> (63-cellTo%64);
+      }
+
+      if (bits!=0) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool LabelCanvas::CheckCollision(const Mask& mask) const
+  {
+    int64_t rowFrom=std::max(int64_t(0),(int64_t)mask.rowFrom);
+    int64_t rowTo=std::min(height-1,(int64_t)mask.rowTo);
+    int64_t cellFrom=std::max(int64_t(0),(int64_t)mask.cellFrom);
+    int64_t cellTo=std::min(std::min(rowSize,mask.size())-1,(int64_t)mask.cellTo);
+
+    if (rowFrom>rowTo ||
+        cellFrom>cellTo) {
+      return false;
+    }
+
+    for (int64_t block=rowFrom/BlockRows; block<=rowTo/BlockRows; block++) {
+      // coarse level, skip blocks without any occupied word in the range of the mask
+      if (!IsBlockOccupied(block,cellFrom,cellTo)) {
+        continue;
+      }
+
+      int64_t blockRowFrom=std::max(rowFrom,block*BlockRows);
+      int64_t blockRowTo=std::min(rowTo,(block+1)*BlockRows-1);
+
+      for (int64_t r=blockRowFrom; r<=blockRowTo; r++) {
+        for (int64_t c=cellFrom; c<=cellTo; c++) {
+          if ((mask.d[c] & d[r*rowSize+c])!=0) {
+            return true;
+          }
+        }
+      }
+    }
+
+    return false;
+  }
+
+  void LabelCanvas::Mark(const Mask& mask)
+  {
+    int64_t rowFrom=std::max(int64_t(0),(int64_t)mask.rowFrom);
+    int64_t rowTo=std::min(height-1,(int64_t)mask.rowTo);
+    int64_t cellFrom=std::max(int64_t(0),(int64_t)mask.cellFrom);
+    int64_t cellTo=std::min(std::min(rowSize,mask.size())-1,(int64_t)mask.cellTo);
+
+    if (rowFrom>rowTo ||
+        cellFrom>cellTo) {
+      return;
+    }
+
+    for (int64_t r=rowFrom; r<=rowTo; r++) {
+      for (int64_t c=cellFrom; c<=cellTo; c++) {
+        d[r*rowSize+c]|=mask.d[c];
+      }
+    }
+
+    for (int64_t block=rowFrom/BlockRows; block<=rowTo/BlockRows; block++) {
+      for (int64_t c=cellFrom; c<=cellTo; c++) {
+        if (mask.d[c]!=0) {
+          summary[block*summaryRowSize+c/64]|=uint64_t(1) << (c%64);
+        }
+      }
+    }
+  }
 }
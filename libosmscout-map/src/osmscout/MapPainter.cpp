@@ -19,6 +19,7 @@
 
 #include <osmscout/MapPainter.h>
 
+#include <future>
 #include <limits>
 
 #include <osmscout/system/Math.h>
@@ -27,6 +28,7 @@
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
 #include <osmscout/util/Tiling.h>
+#include <osmscout/util/Tracing.h>
 #include <iostream>
 #include <cstdint>
 
@@ -148,6 +150,16 @@ namespace osmscout {
   MapPainter::MapPainter(const StyleConfigRef& styleConfig,
                          CoordBuffer *buffer)
   : coordBuffer(buffer),
+    wayGeometryCache(0),
+    areaGeometryCache(0),
+    geometryCacheActive(false),
+    geometryCacheDPI(0.0),
+    geometryCachePixelSize(0.0),
+    geometryCacheTolerance(0.0),
+    geometryCacheOriginX(0.0),
+    geometryCacheOriginY(0.0),
+    geometryCacheHits(0),
+    geometryCacheMisses(0),
     styleConfig(styleConfig),
     transBuffer(coordBuffer),
     nameReader(*styleConfig->GetTypeConfig()),
@@ -207,6 +219,17 @@ namespace osmscout {
     log.Debug() << "MapPainter::~MapPainter()";
   }
 
+  /**
+   * Drop all cached geometry. Must be called, if map parameters influencing the
+   * styling of objects (beside the projection) change while the geometry cache
+   * is enabled.
+   */
+  void MapPainter::FlushGeometryCache()
+  {
+    wayGeometryCache.Flush();
+    areaGeometryCache.Flush();
+  }
+
   void MapPainter::DumpDataStatistics(const Projection& projection,
                                       const MapParameter& parameter,
                                       const MapData& data)
@@ -1307,8 +1330,11 @@ namespace osmscout {
   void MapPainter::PrepareArea(const StyleConfig& styleConfig,
                                const Projection& projection,
                                const MapParameter& parameter,
-                               const AreaRef &area)
+                               const AreaRef &area,
+                               PreprocessBuffers& buffers) const
   {
+    TransBuffer& transBuffer=buffers.transBuffer;
+
     std::vector<PolyData> td(area->rings.size());
 
     for (size_t i=0; i<area->rings.size(); i++) {
@@ -1416,7 +1442,7 @@ namespace osmscout {
       a.transStart=td[i].transStart;
       a.transEnd=td[i].transEnd;
 
-      areaData.push_back(a);
+      buffers.areaData.push_back(a);
 
       for (size_t idx=borderStyleIndex;
            idx<borderStyles.size();
@@ -1438,11 +1464,11 @@ namespace osmscout {
         }
 
         if (offset!=0.0) {
-          coordBuffer->GenerateParallelWay(transStart,
-                                           transEnd,
-                                           offset,
-                                           transStart,
-                                           transEnd);
+          transBuffer.buffer->GenerateParallelWay(transStart,
+                                                  transEnd,
+                                                  offset,
+                                                  transStart,
+                                                  transEnd);
         }
 
         a.ref=area->GetObjectFileRef();
@@ -1453,7 +1479,7 @@ namespace osmscout {
         a.transStart=transStart;
         a.transEnd=transEnd;
 
-        areaData.push_back(a);
+        buffers.areaData.push_back(a);
       }
       return true;
     });
@@ -1466,26 +1492,110 @@ namespace osmscout {
   {
     areaData.clear();
 
+    std::vector<GeometryCacheEntryRef> cachedAreas;
+    std::vector<GeometryCacheEntryRef> capturedAreas;
+
+    if (geometryCacheActive) {
+      cachedAreas.resize(data.areas.size());
+      capturedAreas.resize(data.areas.size());
+
+      for (size_t i=0; i<data.areas.size(); i++) {
+        const AreaRef& area=data.areas[i];
+
+        cachedAreas[i]=GetCachedGeometry(areaGeometryCache,
+                                         area->GetFileOffset(),
+                                         area->GetType(),
+                                         area->rings.size());
+      }
+    }
+
     //Areas
-    for (const auto& area : data.areas) {
-      PrepareArea(styleConfig,
-                   projection,
-                   parameter,
-                   area);
+    Preprocess(parameter,
+               data.areas.size(),
+               [&](PreprocessBuffers& buffers, size_t index) {
+                 const AreaRef& area=data.areas[index];
+
+                 if (!geometryCacheActive) {
+                   PrepareArea(styleConfig,
+                               projection,
+                               parameter,
+                               area,
+                               buffers);
+                   return;
+                 }
+
+                 if (cachedAreas[index]) {
+                   EmitCachedArea(projection,
+                                  *cachedAreas[index],
+                                  *area,
+                                  buffers);
+                   return;
+                 }
+
+                 size_t coordStart=buffers.transBuffer.buffer->GetSize();
+                 size_t areaDataCount=buffers.areaData.size();
+
+                 PrepareArea(styleConfig,
+                             projection,
+                             parameter,
+                             area,
+                             buffers);
+
+                 GeoBox boundingBox=area->GetBoundingBox();
+
+                 if (!IsGeometryCacheable(projection,
+                                          boundingBox)) {
+                   return;
+                 }
+
+                 GeometryCacheEntryRef entry=CaptureGeometry(buffers,
+                                                             coordStart,
+                                                             buffers.wayData.size(),
+                                                             buffers.wayPathData.size(),
+                                                             areaDataCount);
+
+                 entry->type=area->GetType();
+                 entry->size=area->rings.size();
+                 entry->boundingBox=boundingBox;
+
+                 for (const auto& a : entry->areaData) {
+                   size_t ring=std::numeric_limits<size_t>::max();
+
+                   for (size_t r=0; r<area->rings.size(); r++) {
+                     if (a.buffer==&area->rings[r].GetFeatureValueBuffer()) {
+                       ring=r;
+                       break;
+                     }
+                   }
+
+                   entry->areaRings.push_back(ring);
+                 }
+
+                 capturedAreas[index]=entry;
+               });
+
+    for (size_t i=0; i<capturedAreas.size(); i++) {
+      if (capturedAreas[i]) {
+        areaGeometryCache.SetEntry(GeometryCache::CacheEntry(data.areas[i]->GetFileOffset(),
+                                                             capturedAreas[i]));
+      }
     }
 
     areaData.sort(AreaSorter);
 
     // POI Areas
+    PreprocessBuffers buffers=GetPreprocessBuffers();
+
     for (const auto& area : data.poiAreas) {
       PrepareArea(styleConfig,
                   projection,
                   parameter,
-                  area);
+                  area,
+                  buffers);
     }
   }
 
-  std::vector<OffsetRel> MapPainter::ParseLaneTurns(const LanesFeatureValue &lanesValue)
+  std::vector<OffsetRel> MapPainter::ParseLaneTurns(const LanesFeatureValue &lanesValue) const
   {
     std::vector<OffsetRel> laneTurns;
     laneTurns.reserve(lanesValue.GetLanes());
@@ -1547,13 +1657,383 @@ namespace osmscout {
     return laneTurns;
   }
 
+  MapPainter::PreprocessWorker::PreprocessWorker()
+  : transBuffer(new CoordBuffer())
+  {
+    // no code
+  }
+
+  void MapPainter::PreprocessWorker::Reset()
+  {
+    transBuffer.Reset();
+    wayData.clear();
+    wayPathData.clear();
+    areaData.clear();
+  }
+
+  MapPainter::PreprocessBuffers MapPainter::PreprocessWorker::GetBuffers()
+  {
+    return PreprocessBuffers{transBuffer,
+                             lineStyles,
+                             wayData,
+                             wayPathData,
+                             areaData};
+  }
+
+  MapPainter::PreprocessBuffers MapPainter::GetPreprocessBuffers()
+  {
+    return PreprocessBuffers{transBuffer,
+                             lineStyles,
+                             wayData,
+                             wayPathData,
+                             areaData};
+  }
+
+  /**
+   * Checks if the geometry cache can be used for the current render call and
+   * flushes it, if the cached data does not match the current projection.
+   *
+   * Cached geometry is only reused, if the projection was moved since the last
+   * render call. Since the pixel size depends on the latitude of the center,
+   * the cache gets flushed if the pixel size changed significantly.
+   */
+  void MapPainter::PrepareGeometryCache(const Projection& projection,
+                                        const MapParameter& parameter)
+  {
+    geometryCacheHits=0;
+    geometryCacheMisses=0;
+
+    if (parameter.GetGeometryCacheSize()==0) {
+      if (wayGeometryCache.IsActive()) {
+        FlushGeometryCache();
+        wayGeometryCache.SetMaxSize(0);
+        areaGeometryCache.SetMaxSize(0);
+      }
+
+      geometryCacheActive=false;
+
+      return;
+    }
+
+    wayGeometryCache.SetMaxSize(parameter.GetGeometryCacheSize());
+    areaGeometryCache.SetMaxSize(parameter.GetGeometryCacheSize());
+
+    // Rotated projections cannot be expressed as translation of the world pixel space
+    geometryCacheActive=projection.GetAngle()==0.0;
+
+    if (!geometryCacheActive) {
+      return;
+    }
+
+    if (geometryCacheMagnification!=projection.GetMagnification() ||
+        geometryCacheDPI!=projection.GetDPI() ||
+        geometryCacheTolerance!=errorTolerancePixel ||
+        std::abs(geometryCachePixelSize-projection.GetPixelSize())>geometryCachePixelSize*0.001) {
+      FlushGeometryCache();
+
+      geometryCacheMagnification=projection.GetMagnification();
+      geometryCacheDPI=projection.GetDPI();
+      geometryCacheTolerance=errorTolerancePixel;
+      geometryCachePixelSize=projection.GetPixelSize();
+    }
+
+    projection.GeoToPixel(GeoCoord(0.0,0.0),
+                          geometryCacheOriginX,
+                          geometryCacheOriginY);
+  }
+
+  MapPainter::GeometryCacheEntryRef MapPainter::GetCachedGeometry(GeometryCache& cache,
+                                                                  FileOffset offset,
+                                                                  const TypeInfoRef& type,
+                                                                  size_t size)
+  {
+    GeometryCache::CacheRef entry;
+
+    if (cache.GetEntry(offset,entry) &&
+        entry->value->type==type &&
+        entry->value->size==size) {
+      geometryCacheHits++;
+
+      return entry->value;
+    }
+
+    geometryCacheMisses++;
+
+    return nullptr;
+  }
+
+  /**
+   * Geometry is only cacheable if the object was completely inside the projection,
+   * since otherwise visibility checks and clipping of segments depend on the current
+   * projection.
+   */
+  bool MapPainter::IsGeometryCacheable(const Projection& projection,
+                                       const GeoBox& boundingBox) const
+  {
+    GeoBox dimensions=projection.GetDimensions();
+
+    return dimensions.Includes(boundingBox.GetMinCoord(),false) &&
+           dimensions.Includes(boundingBox.GetMaxCoord(),false);
+  }
+
+  /**
+   * Copies all data generated by the last object from the given buffers into a new
+   * cache entry, converting coordinates to world pixel space.
+   */
+  MapPainter::GeometryCacheEntryRef MapPainter::CaptureGeometry(PreprocessBuffers& buffers,
+                                                                size_t coordStart,
+                                                                size_t wayDataCount,
+                                                                size_t wayPathDataCount,
+                                                                size_t areaDataCount) const
+  {
+    GeometryCacheEntryRef entry=std::make_shared<GeometryCacheEntry>();
+    const CoordBuffer&    coords=*buffers.transBuffer.buffer;
+
+    entry->pixelOffset=0.0;
+    entry->coords.reserve(coords.GetSize()-coordStart);
+
+    for (size_t i=coordStart; i<coords.GetSize(); i++) {
+      entry->coords.emplace_back(coords.buffer[i].GetX()-geometryCacheOriginX,
+                                 coords.buffer[i].GetY()-geometryCacheOriginY);
+    }
+
+    for (auto way=std::prev(buffers.wayData.end(),buffers.wayData.size()-wayDataCount);
+         way!=buffers.wayData.end();
+         ++way) {
+      entry->wayData.push_back(*way);
+      entry->wayData.back().transStart-=coordStart;
+      entry->wayData.back().transEnd-=coordStart;
+      entry->pixelOffset=std::max(entry->pixelOffset,way->lineWidth/2.0);
+    }
+
+    for (auto path=std::prev(buffers.wayPathData.end(),buffers.wayPathData.size()-wayPathDataCount);
+         path!=buffers.wayPathData.end();
+         ++path) {
+      entry->wayPathData.push_back(*path);
+      entry->wayPathData.back().transStart-=coordStart;
+      entry->wayPathData.back().transEnd-=coordStart;
+    }
+
+    for (auto area=std::prev(buffers.areaData.end(),buffers.areaData.size()-areaDataCount);
+         area!=buffers.areaData.end();
+         ++area) {
+      entry->areaData.push_back(*area);
+
+      AreaData& a=entry->areaData.back();
+
+      a.transStart-=coordStart;
+      a.transEnd-=coordStart;
+
+      for (auto& clipping : a.clippings) {
+        clipping.transStart-=coordStart;
+        clipping.transEnd-=coordStart;
+      }
+
+      if (area->borderStyle) {
+        entry->pixelOffset=std::max(entry->pixelOffset,area->borderStyle->GetWidth()/2.0);
+      }
+    }
+
+    return entry;
+  }
+
+  /**
+   * Pushes the coordinates of the cache entry into the coordinate buffer, translating
+   * them from world pixel space to the current projection.
+   */
+  void MapPainter::EmitCachedGeometry(const GeometryCacheEntry& entry,
+                                      PreprocessBuffers& buffers,
+                                      size_t& coordStart) const
+  {
+    CoordBuffer& coords=*buffers.transBuffer.buffer;
+
+    coordStart=coords.GetSize();
+
+    for (const auto& coord : entry.coords) {
+      coords.PushCoord(coord.GetX()+geometryCacheOriginX,
+                       coord.GetY()+geometryCacheOriginY);
+    }
+  }
+
+  void MapPainter::EmitCachedWay(const Projection& projection,
+                                 const GeometryCacheEntry& entry,
+                                 const Way& way,
+                                 PreprocessBuffers& buffers) const
+  {
+    if (!IsVisibleWay(projection,
+                      entry.boundingBox,
+                      entry.pixelOffset)) {
+      return;
+    }
+
+    size_t coordStart;
+
+    EmitCachedGeometry(entry,
+                       buffers,
+                       coordStart);
+
+    for (const auto& data : entry.wayData) {
+      buffers.wayData.push_back(data);
+
+      WayData& w=buffers.wayData.back();
+
+      w.buffer=&way.GetFeatureValueBuffer();
+      w.transStart+=coordStart;
+      w.transEnd+=coordStart;
+    }
+
+    for (const auto& data : entry.wayPathData) {
+      buffers.wayPathData.push_back(data);
+
+      WayPathData& p=buffers.wayPathData.back();
+
+      p.buffer=&way.GetFeatureValueBuffer();
+      p.transStart+=coordStart;
+      p.transEnd+=coordStart;
+    }
+  }
+
+  void MapPainter::EmitCachedArea(const Projection& projection,
+                                  const GeometryCacheEntry& entry,
+                                  const Area& area,
+                                  PreprocessBuffers& buffers) const
+  {
+    if (!IsVisibleArea(projection,
+                       entry.boundingBox,
+                       entry.pixelOffset)) {
+      return;
+    }
+
+    size_t coordStart;
+
+    EmitCachedGeometry(entry,
+                       buffers,
+                       coordStart);
+
+    size_t idx=0;
+
+    for (const auto& data : entry.areaData) {
+      buffers.areaData.push_back(data);
+
+      AreaData& a=buffers.areaData.back();
+      size_t    ring=entry.areaRings[idx];
+
+      a.buffer=ring!=std::numeric_limits<size_t>::max() ? &area.rings[ring].GetFeatureValueBuffer() : nullptr;
+      a.transStart+=coordStart;
+      a.transEnd+=coordStart;
+
+      for (auto& clipping : a.clippings) {
+        clipping.transStart+=coordStart;
+        clipping.transEnd+=coordStart;
+      }
+
+      idx++;
+    }
+  }
+
+  /**
+   * Calls the given function for all object indexes in the range [0,objectCount[.
+   *
+   * If parallel preprocessing is enabled, the range gets split into continuous
+   * partitions, each processed by its own thread using thread local buffers. The results
+   * are afterwards merged into the buffers of the painter in the order of the partitions.
+   * The result is thus identical to sequential processing.
+   */
+  void MapPainter::Preprocess(const MapParameter& parameter,
+                              size_t objectCount,
+                              const PreprocessFunction& function)
+  {
+    // Minimum number of objects per thread to make parallel processing worth it
+    static const size_t minObjectsPerThread=256;
+
+    size_t threadCount=std::min(parameter.GetPreprocessingThreads(),
+                                objectCount/minObjectsPerThread);
+
+    if (threadCount<=1) {
+      PreprocessBuffers buffers=GetPreprocessBuffers();
+
+      for (size_t i=0; i<objectCount; i++) {
+        function(buffers,i);
+      }
+
+      return;
+    }
+
+    while (preprocessWorkers.size()<threadCount) {
+      preprocessWorkers.push_back(std::make_unique<PreprocessWorker>());
+    }
+
+    std::vector<std::future<void>> results;
+    size_t                         partitionSize=objectCount/threadCount;
+
+    results.reserve(threadCount);
+
+    for (size_t t=0; t<threadCount; t++) {
+      size_t           start=t*partitionSize;
+      size_t           end=t+1==threadCount ? objectCount : start+partitionSize;
+      PreprocessWorker *worker=preprocessWorkers[t].get();
+
+      results.push_back(std::async(std::launch::async,
+                                   [worker,start,end,&function]() {
+                                     worker->Reset();
+
+                                     PreprocessBuffers buffers=worker->GetBuffers();
+
+                                     for (size_t i=start; i<end; i++) {
+                                       function(buffers,i);
+                                     }
+                                   }));
+    }
+
+    for (auto& result : results) {
+      result.wait();
+    }
+
+    // Merge the results in partition order, rebasing offsets into the coordinate buffer
+    for (size_t t=0; t<threadCount; t++) {
+      PreprocessWorker& worker=*preprocessWorkers[t];
+
+      results[t].get();
+
+      size_t offset=coordBuffer->Append(*worker.transBuffer.buffer);
+
+      for (auto& way : worker.wayData) {
+        way.transStart+=offset;
+        way.transEnd+=offset;
+      }
+
+      for (auto& path : worker.wayPathData) {
+        path.transStart+=offset;
+        path.transEnd+=offset;
+      }
+
+      for (auto& area : worker.areaData) {
+        area.transStart+=offset;
+        area.transEnd+=offset;
+
+        for (auto& clipping : area.clippings) {
+          clipping.transStart+=offset;
+          clipping.transEnd+=offset;
+        }
+      }
+
+      wayData.splice(wayData.end(),worker.wayData);
+      wayPathData.splice(wayPathData.end(),worker.wayPathData);
+      areaData.splice(areaData.end(),worker.areaData);
+    }
+  }
+
   void MapPainter::CalculatePaths(const StyleConfig& styleConfig,
                                   const Projection& projection,
                                   const MapParameter& parameter,
                                   const ObjectFileRef& ref,
                                   const FeatureValueBuffer& buffer,
-                                  const Way& way)
+                                  const Way& way,
+                                  PreprocessBuffers& buffers) const
   {
+    TransBuffer&               transBuffer=buffers.transBuffer;
+    std::vector<LineStyleRef>& lineStyles=buffers.lineStyles;
+
     styleConfig.GetWayLineStyles(buffer,
                                  projection,
                                  lineStyles);
@@ -1691,7 +2171,7 @@ namespace osmscout {
         pathData.transEnd=transEnd;
         pathData.mainSlotWidth=mainSlotWidth;
 
-        wayPathData.push_back(pathData);
+        buffers.wayPathData.push_back(pathData);
 
         transformed=true;
       }
@@ -1710,10 +2190,10 @@ namespace osmscout {
       }
 
       if (lineOffset!=0.0) {
-        coordBuffer->GenerateParallelWay(transStart,transEnd,
-                                         lineOffset,
-                                         data.transStart,
-                                         data.transEnd);
+        transBuffer.buffer->GenerateParallelWay(transStart,transEnd,
+                                                lineOffset,
+                                                data.transStart,
+                                                data.transEnd);
       }
       else {
         data.transStart=transStart;
@@ -1741,11 +2221,11 @@ namespace osmscout {
         double  laneOffset=-mainSlotWidth/2.0+lanesSpace;
 
         for (size_t lane=1; lane<lanes; lane++) {
-          coordBuffer->GenerateParallelWay(transStart,transEnd,
-                                           laneOffset,
-                                           data.transStart,
-                                           data.transEnd);
-          wayData.push_back(data);
+          transBuffer.buffer->GenerateParallelWay(transStart,transEnd,
+                                                  laneOffset,
+                                                  data.transStart,
+                                                  data.transEnd);
+          buffers.wayData.push_back(data);
           laneOffset+=lanesSpace;
         }
       }
@@ -1775,17 +2255,17 @@ namespace osmscout {
 
         for (const OffsetRel &laneTurn: laneTurns) {
           if (lineStyle->GetOffsetRel() == laneTurn) {
-            coordBuffer->GenerateParallelWay(transStart, transEnd,
-                                             laneOffset,
-                                             data.transStart,
-                                             data.transEnd);
-            wayData.push_back(data);
+            transBuffer.buffer->GenerateParallelWay(transStart, transEnd,
+                                                    laneOffset,
+                                                    data.transStart,
+                                                    data.transEnd);
+            buffers.wayData.push_back(data);
           }
           laneOffset+=lanesSpace;
         }
       }
       else {
-        wayData.push_back(data);
+        buffers.wayData.push_back(data);
       }
     }
   }
@@ -1800,30 +2280,103 @@ namespace osmscout {
     wayData.clear();
     wayPathData.clear();
 
-    for (const auto& way : data.ways) {
-      CalculatePaths(styleConfig,
-                     projection,
-                     parameter,
-                     ObjectFileRef(way->GetFileOffset(),
-                                   refWay),
-                     way->GetFeatureValueBuffer(),
-                     *way);
+    std::vector<const Way*> ways;
 
-      CalculateWayShieldLabels(styleConfig,
-                               projection,
-                               parameter,
-                               *way);
+    ways.reserve(data.ways.size()+data.poiWays.size());
+
+    for (const auto& way : data.ways) {
+      ways.push_back(way.get());
     }
 
     for (const auto& way : data.poiWays) {
-      CalculatePaths(styleConfig,
-                     projection,
-                     parameter,
-                     ObjectFileRef(way->GetFileOffset(),
-                                   refWay),
-                     way->GetFeatureValueBuffer(),
-                     *way);
+      ways.push_back(way.get());
+    }
+
+    // Only ways managed by the database are cached, the indexes are the same as in ways
+    std::vector<GeometryCacheEntryRef> cachedWays;
+    std::vector<GeometryCacheEntryRef> capturedWays;
+
+    if (geometryCacheActive) {
+      cachedWays.resize(data.ways.size());
+      capturedWays.resize(data.ways.size());
+
+      for (size_t i=0; i<data.ways.size(); i++) {
+        const WayRef& way=data.ways[i];
+
+        cachedWays[i]=GetCachedGeometry(wayGeometryCache,
+                                        way->GetFileOffset(),
+                                        way->GetType(),
+                                        way->nodes.size());
+      }
+    }
 
+    Preprocess(parameter,
+               ways.size(),
+               [&](PreprocessBuffers& buffers, size_t index) {
+                 const Way& way=*ways[index];
+
+                 if (index>=cachedWays.size()) {
+                   CalculatePaths(styleConfig,
+                                  projection,
+                                  parameter,
+                                  ObjectFileRef(way.GetFileOffset(),
+                                                refWay),
+                                  way.GetFeatureValueBuffer(),
+                                  way,
+                                  buffers);
+                   return;
+                 }
+
+                 if (cachedWays[index]) {
+                   EmitCachedWay(projection,
+                                 *cachedWays[index],
+                                 way,
+                                 buffers);
+                   return;
+                 }
+
+                 size_t coordStart=buffers.transBuffer.buffer->GetSize();
+                 size_t wayDataCount=buffers.wayData.size();
+                 size_t wayPathDataCount=buffers.wayPathData.size();
+
+                 CalculatePaths(styleConfig,
+                                projection,
+                                parameter,
+                                ObjectFileRef(way.GetFileOffset(),
+                                              refWay),
+                                way.GetFeatureValueBuffer(),
+                                way,
+                                buffers);
+
+                 GeoBox boundingBox=way.GetBoundingBox();
+
+                 if (!IsGeometryCacheable(projection,
+                                          boundingBox)) {
+                   return;
+                 }
+
+                 GeometryCacheEntryRef entry=CaptureGeometry(buffers,
+                                                             coordStart,
+                                                             wayDataCount,
+                                                             wayPathDataCount,
+                                                             buffers.areaData.size());
+
+                 entry->type=way.GetType();
+                 entry->size=way.nodes.size();
+                 entry->boundingBox=boundingBox;
+
+                 capturedWays[index]=entry;
+               });
+
+    for (size_t i=0; i<capturedWays.size(); i++) {
+      if (capturedWays[i]) {
+        wayGeometryCache.SetEntry(GeometryCache::CacheEntry(data.ways[i]->GetFileOffset(),
+                                                            capturedWays[i]));
+      }
+    }
+
+    // Label registration is not thread safe, so we do it afterwards on the calling thread
+    for (const auto& way : ways) {
       CalculateWayShieldLabels(styleConfig,
                                projection,
                                parameter,
@@ -1833,6 +2386,32 @@ namespace osmscout {
     wayData.sort();
   }
 
+  /**
+   * Names of the render steps for tracing, in the order of RenderSteps
+   */
+  static const char* const renderStepNames[]={
+    "Initialize",
+    "DumpStatistics",
+    "PreprocessData",
+    "Prerender",
+    "DrawBaseMapTiles",
+    "DrawGroundTiles",
+    "DrawOSMTileGrids",
+    "DrawAreas",
+    "DrawWays",
+    "DrawWayDecorations",
+    "DrawWayContourLabels",
+    "PrepareAreaLabels",
+    "DrawAreaBorderLabels",
+    "DrawAreaBorderSymbols",
+    "PrepareNodeLabels",
+    "DrawLabels",
+    "Postrender"
+  };
+
+  static_assert(sizeof(renderStepNames)/sizeof(renderStepNames[0])==RenderSteps::LastStep+1,
+                "Missing name of render step");
+
   bool MapPainter::Draw(const Projection& projection,
                         const MapParameter& parameter,
                         const MapData& data,
@@ -1842,11 +2421,15 @@ namespace osmscout {
     assert(startStep>=RenderSteps::FirstStep);
     assert(startStep<=RenderSteps::LastStep);
 
+    OSMSCOUT_TRACE_SCOPE("MapPainter","Draw");
+
     for (size_t step=startStep; step<=endStep; step++) {
       StepMethod stepMethod=stepMethods[step];
 
       assert(stepMethod!=nullptr);
 
+      OSMSCOUT_TRACE_SCOPE("MapPainter",renderStepNames[step]);
+
       (this->*stepMethod)(projection,parameter,data);
 
       if (parameter.IsAborted()) {
@@ -1916,6 +2499,9 @@ namespace osmscout {
                                   const MapParameter& parameter,
                                   const MapData& data)
   {
+    PrepareGeometryCache(projection,
+                         parameter);
+
     StopClock prepareWaysTimer;
 
     PrepareWays(*styleConfig,
@@ -1950,6 +2536,12 @@ namespace osmscout {
       log.Info()
         << "Prep: " << prepareWaysTimer.ResultString() << " (sec) " << prepareAreasTimer.ResultString() << " (sec)";
     }
+
+    if (parameter.IsDebugPerformance() &&
+        geometryCacheActive) {
+      log.Info()
+        << "Geometry cache: " << geometryCacheHits << " hits " << geometryCacheMisses << " misses";
+    }
   }
 
   void MapPainter::Prerender(const Projection& projection,
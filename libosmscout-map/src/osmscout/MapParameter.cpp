@@ -31,6 +31,9 @@ namespace osmscout {
     optimizeErrorToleranceMm(0.5),
     drawFadings(true),
     drawWaysWithFixedWidth(false),
+    preprocessingThreads(1),
+    geometryCacheSize(0),
+    labelLayoutCacheSize(0),
     labelLineMinCharCount(5),
     labelLineMaxCharCount(15),
     labelLineFitToArea(true),
@@ -116,6 +119,21 @@ namespace osmscout {
     this->drawWaysWithFixedWidth=drawWaysWithFixedWidth;
   }
 
+  void MapParameter::SetPreprocessingThreads(size_t threads)
+  {
+    this->preprocessingThreads=threads;
+  }
+
+  void MapParameter::SetGeometryCacheSize(size_t size)
+  {
+    this->geometryCacheSize=size;
+  }
+
+  void MapParameter::SetLabelLayoutCacheSize(size_t size)
+  {
+    this->labelLayoutCacheSize=size;
+  }
+
   void MapParameter::SetLabelLineMinCharCount(size_t labelLineMinCharCount)
   {
     this->labelLineMinCharCount=labelLineMinCharCount;
@@ -27,13 +27,15 @@
 
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout {
 
   AreaSearchParameter::AreaSearchParameter()
   : maxAreaLevel(4),
     useLowZoomOptimization(true),
-    useMultithreading(false)
+    useMultithreading(false),
+    useObjectArena(false)
   {
     // no code
   }
@@ -53,6 +55,17 @@ namespace osmscout {
     this->useMultithreading=useMultithreading;
   }
 
+  /**
+   * If set to true, the objects loaded for one tile (and one object kind) are
+   * allocated from one ObjectArena. This reduces the number of allocations and the
+   * memory gets freed in one shot, when the tile gets dropped from the cache.
+   * Objects loaded into an arena bypass the caches of the data files.
+   */
+  void AreaSearchParameter::SetUseObjectArena(bool useObjectArena)
+  {
+    this->useObjectArena=useObjectArena;
+  }
+
   void AreaSearchParameter::SetBreaker(const BreakerRef& breaker)
   {
     this->breaker=breaker;
@@ -73,6 +86,11 @@ namespace osmscout {
     return useMultithreading;
   }
 
+  bool AreaSearchParameter::GetUseObjectArena() const
+  {
+    return useObjectArena;
+  }
+
   bool AreaSearchParameter::IsAborted() const
   {
     if (breaker) {
@@ -83,9 +101,25 @@ namespace osmscout {
     }
   }
 
+  static MetricHistogram& GetTileLoadTimeHistogram(const std::string& data)
+  {
+    return metrics.GetHistogram("osmscout_mapservice_tile_load_seconds",
+                                "Latency of loading data of one kind for one tile",
+                                MetricHistogram::GetLatencyBounds(),
+                                {{"data",data}});
+  }
+
   MapService::MapService(const DatabaseRef& database)
    : database(database),
      cache(25),
+     tileLoadTime(metrics.GetHistogram("osmscout_mapservice_tiles_load_seconds",
+                                       "Latency of loading all missing data of the requested tiles",
+                                       MetricHistogram::GetLatencyBounds())),
+     nodeLoadTime(GetTileLoadTimeHistogram("nodes")),
+     wayLoadTime(GetTileLoadTimeHistogram("ways")),
+     wayLowZoomLoadTime(GetTileLoadTimeHistogram("waysLowZoom")),
+     areaLoadTime(GetTileLoadTimeHistogram("areas")),
+     areaLowZoomLoadTime(GetTileLoadTimeHistogram("areasLowZoom")),
      nodeWorkerThread(&MapService::NodeWorkerLoop,this),
      wayWorkerThread(&MapService::WayWorkerLoop,this),
      wayLowZoomWorkerThread(&MapService::WayLowZoomWorkerLoop,this),
@@ -232,6 +266,10 @@ namespace osmscout {
                             bool prefill,
                             const TileRef& tile) const
   {
+    OSMSCOUT_TRACE_SCOPE("MapService","GetNodes");
+
+    MetricTimer loadTimer(nodeLoadTime);
+
     AreaNodeIndexRef areaNodeIndex=database->GetAreaNodeIndex();
 
     if (!areaNodeIndex) {
@@ -277,14 +315,18 @@ namespace osmscout {
         }
 
         std::vector<NodeRef> nodes;
+        ObjectArenaRef       arena=CreateObjectArena(parameter);
 
         if (!database->GetNodesByOffset(offsets,
                                         boundingBox,
-                                        nodes)) {
+                                        nodes,
+                                        arena)) {
           log.Error() << "Error reading nodes in area!";
           return false;
         }
 
+        UpdateStatistics(arena);
+
         if (parameter.IsAborted()) {
           return false;
         }
@@ -319,6 +361,10 @@ namespace osmscout {
                                    bool prefill,
                                    const TileRef& tile) const
   {
+    OSMSCOUT_TRACE_SCOPE("MapService","GetAreasLowZoom");
+
+    MetricTimer loadTimer(areaLowZoomLoadTime);
+
     OptimizeAreasLowZoomRef optimizeAreasLowZoom=database->GetOptimizeAreasLowZoom();
 
     if (!optimizeAreasLowZoom) {
@@ -393,6 +439,10 @@ namespace osmscout {
                             bool prefill,
                             const TileRef& tile) const
   {
+    OSMSCOUT_TRACE_SCOPE("MapService","GetAreas");
+
+    MetricTimer loadTimer(areaLoadTime);
+
     AreaAreaIndexRef areaAreaIndex=database->GetAreaAreaIndex();
 
     if (!areaAreaIndex) {
@@ -441,13 +491,18 @@ namespace osmscout {
         }
 
         std::vector<AreaRef> areas;
+        ObjectArenaRef       arena=CreateObjectArena(parameter);
 
         if (!database->GetAreasByBlockSpans(spans,
-                                            areas)) {
+                                            magnification,
+                                            areas,
+                                            arena)) {
           log.Error() << "Error reading areas in area!";
           return false;
         }
 
+        UpdateStatistics(arena);
+
         if (parameter.IsAborted()) {
           return false;
         }
@@ -481,6 +536,10 @@ namespace osmscout {
                                   bool prefill,
                                   const TileRef& tile) const
   {
+    OSMSCOUT_TRACE_SCOPE("MapService","GetWaysLowZoom");
+
+    MetricTimer loadTimer(wayLowZoomLoadTime);
+
     OptimizeWaysLowZoomRef optimizeWaysLowZoom=database->GetOptimizeWaysLowZoom();
 
     if (!optimizeWaysLowZoom) {
@@ -550,10 +609,15 @@ namespace osmscout {
 
   bool MapService::GetWays(const AreaSearchParameter& parameter,
                            const TypeInfoSet& wayTypes,
+                           const Magnification& magnification,
                            const GeoBox& boundingBox,
                            bool prefill,
                            const TileRef& tile) const
   {
+    OSMSCOUT_TRACE_SCOPE("MapService","GetWays");
+
+    MetricTimer loadTimer(wayLoadTime);
+
     AreaWayIndexRef areaWayIndex=database->GetAreaWayIndex();
 
     if (!areaWayIndex) {
@@ -599,13 +663,18 @@ namespace osmscout {
         }
 
         std::vector<WayRef> ways;
+        ObjectArenaRef      arena=CreateObjectArena(parameter);
 
         if (!database->GetWaysByOffset(offsets,
-                                       ways)) {
+                                       magnification,
+                                       ways,
+                                       arena)) {
           log.Error() << "Error reading ways in area!";
           return false;
         }
 
+        UpdateStatistics(arena);
+
         if (parameter.IsAborted()) {
           return false;
         }
@@ -765,6 +834,7 @@ namespace osmscout {
 
   std::future<bool> MapService::PushWayTask(const AreaSearchParameter& parameter,
                                             const TypeInfoSet& wayTypes,
+                                            const Magnification& magnification,
                                             const GeoBox& boundingBox,
                                             bool prefill,
                                             const TileRef& tile) const
@@ -772,6 +842,7 @@ namespace osmscout {
     std::packaged_task<bool()> task(std::bind(&MapService::GetWays,this,
                                               parameter,
                                               wayTypes,
+                                              magnification,
                                               boundingBox,
                                               prefill,
                                               tile));
@@ -792,6 +863,51 @@ namespace osmscout {
     }
   }
 
+  ObjectArenaRef MapService::CreateObjectArena(const AreaSearchParameter& parameter) const
+  {
+    if (!parameter.GetUseObjectArena()) {
+      return nullptr;
+    }
+
+    return std::make_shared<ObjectArena>();
+  }
+
+  void MapService::UpdateStatistics(const ObjectArenaRef& arena) const
+  {
+    if (!arena) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+
+    statistics.arenaCount++;
+    statistics.arenaAllocationCount+=arena->GetAllocationCount();
+    statistics.arenaAllocatedBytes+=arena->GetAllocatedBytes();
+    statistics.arenaBlockCount+=arena->GetBlockCount();
+  }
+
+  /**
+   * Ways and areas of the parent tile can only be reused, if they were loaded
+   * with the same (simplified) geometry as required for the given tile.
+   */
+  bool MapService::CanPrefillGeometryFromParent(const Tile& tile) const
+  {
+    if (tile.GetLevel()==0) {
+      return true;
+    }
+
+    Magnification magnification(MagnificationLevel(tile.GetLevel()));
+    Magnification parentMagnification(MagnificationLevel(tile.GetLevel()-1));
+
+    WayResolutionDataFileRef  wayResolutionDataFile=database->GetWayResolutionDataFile();
+    AreaResolutionDataFileRef areaResolutionDataFile=database->GetAreaResolutionDataFile();
+
+    return (!wayResolutionDataFile ||
+            wayResolutionDataFile->HasSameBand(magnification,parentMagnification)) &&
+           (!areaResolutionDataFile ||
+            areaResolutionDataFile->HasSameBand(magnification,parentMagnification));
+  }
+
   /**
    * Return all tiles with the magnification defined by the projection
    * that cover the region covered by the projection
@@ -873,6 +989,8 @@ namespace osmscout {
   {
     std::lock_guard<std::mutex>  lock(stateMutex);
 
+    OSMSCOUT_TRACE_SCOPE("MapService","LoadMissingTileData");
+
     StopClock                    overallTime;
 
     TypeDefinitionRef            typeDefinition;
@@ -884,6 +1002,8 @@ namespace osmscout {
       GeoBox          tileBoundingBox(tile->GetBoundingBox());
 
       if (!tile->IsComplete()) {
+        OSMSCOUT_TRACE_SCOPE("MapService","LoadTile");
+
         StopClock     tileLoadingTime;
         Magnification magnification(MagnificationLevel(tile->GetKey().GetLevel()));
 
@@ -899,12 +1019,22 @@ namespace osmscout {
           typeDefinitionMagnification=magnification;
         }
 
-        cache.PrefillDataFromCache(*tile,
-                                   typeDefinition->nodeTypes,
-                                   typeDefinition->wayTypes,
-                                   typeDefinition->areaTypes,
-                                   typeDefinition->optimizedWayTypes,
-                                   typeDefinition->optimizedAreaTypes);
+        if (CanPrefillGeometryFromParent(*tile)) {
+          cache.PrefillDataFromCache(*tile,
+                                     typeDefinition->nodeTypes,
+                                     typeDefinition->wayTypes,
+                                     typeDefinition->areaTypes,
+                                     typeDefinition->optimizedWayTypes,
+                                     typeDefinition->optimizedAreaTypes);
+        }
+        else {
+          cache.PrefillDataFromCache(*tile,
+                                     typeDefinition->nodeTypes,
+                                     TypeInfoSet(),
+                                     TypeInfoSet(),
+                                     typeDefinition->optimizedWayTypes,
+                                     typeDefinition->optimizedAreaTypes);
+        }
 
         NotifyTileStateCallbacks(tile);
 
@@ -941,6 +1071,7 @@ namespace osmscout {
 
         results.push_back(PushWayTask(parameter,
                                       typeDefinition->wayTypes,
+                                      magnification,
                                       tileBoundingBox,
                                       false,
                                       tile));
@@ -974,6 +1105,10 @@ namespace osmscout {
 
     overallTime.Stop();
 
+    if (!async) {
+      tileLoadTime.Observe(overallTime.GetMilliseconds()/1000.0);
+    }
+
     if (overallTime.GetMilliseconds()>200) {
       log.Warn() << "Retrieving all tile data took " << overallTime.ResultString();
     }
@@ -991,6 +1126,8 @@ namespace osmscout {
   {
     std::lock_guard<std::mutex>  lock(stateMutex);
 
+    OSMSCOUT_TRACE_SCOPE("MapService","LoadMissingTileData");
+
     StopClock                    overallTime;
 
     std::list<std::future<bool>> results;
@@ -999,16 +1136,28 @@ namespace osmscout {
       GeoBox tileBoundingBox(tile->GetBoundingBox());
 
       if (!tile->IsComplete()) {
+        OSMSCOUT_TRACE_SCOPE("MapService","LoadTile");
+
         StopClock  tileLoadingTime;
 
         //std::cout << "Loading tile: " << (std::string)tile->GetId() << std::endl;
 
-        cache.PrefillDataFromCache(*tile,
-                                   typeDefinition.nodeTypes,
-                                   typeDefinition.wayTypes,
-                                   typeDefinition.areaTypes,
-                                   typeDefinition.optimizedWayTypes,
-                                   typeDefinition.optimizedAreaTypes);
+        if (CanPrefillGeometryFromParent(*tile)) {
+          cache.PrefillDataFromCache(*tile,
+                                     typeDefinition.nodeTypes,
+                                     typeDefinition.wayTypes,
+                                     typeDefinition.areaTypes,
+                                     typeDefinition.optimizedWayTypes,
+                                     typeDefinition.optimizedAreaTypes);
+        }
+        else {
+          cache.PrefillDataFromCache(*tile,
+                                     typeDefinition.nodeTypes,
+                                     TypeInfoSet(),
+                                     TypeInfoSet(),
+                                     typeDefinition.optimizedWayTypes,
+                                     typeDefinition.optimizedAreaTypes);
+        }
 
         NotifyTileStateCallbacks(tile);
 
@@ -1045,6 +1194,7 @@ namespace osmscout {
 
         results.push_back(PushWayTask(parameter,
                                       typeDefinition.wayTypes,
+                                      magnification,
                                       tileBoundingBox,
                                       true,
                                       tile));
@@ -1078,6 +1228,10 @@ namespace osmscout {
 
     overallTime.Stop();
 
+    if (!async) {
+      tileLoadTime.Observe(overallTime.GetMilliseconds()/1000.0);
+    }
+
     if (overallTime.GetMilliseconds()>200) {
       log.Warn() << "Retrieving all tile data took " << overallTime.ResultString();
     }
@@ -1162,6 +1316,8 @@ namespace osmscout {
     std::unordered_map<FileOffset,WayRef>  optimizedWayMap(10000);
     std::unordered_map<FileOffset,AreaRef> optimizedAreaMap(10000);
 
+    OSMSCOUT_TRACE_SCOPE("MapService","AddTileDataToMapData");
+
     StopClock uniqueTime;
 
     for (const auto& tile : tiles) {
@@ -1241,6 +1397,8 @@ namespace osmscout {
     std::unordered_map<FileOffset,WayRef>  optimizedWayMap(10000);
     std::unordered_map<FileOffset,AreaRef> optimizedAreaMap(10000);
 
+    OSMSCOUT_TRACE_SCOPE("MapService","AddTileDataToMapData");
+
     StopClock uniqueTime;
 
     for (const auto& tile : tiles) {
@@ -1381,6 +1539,29 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Return a snapshot of the object loading statistics collected so far.
+   */
+  MapService::Statistics MapService::GetStatistics() const
+  {
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+
+    return statistics;
+  }
+
+  /**
+   * Dump the object loading statistics to the log.
+   */
+  void MapService::DumpStatistics() const
+  {
+    Statistics current=GetStatistics();
+
+    log.Info() << "MapService arenas: " << current.arenaCount;
+    log.Info() << "MapService arena allocations: " << current.arenaAllocationCount;
+    log.Info() << "MapService arena allocated bytes: " << current.arenaAllocatedBytes;
+    log.Info() << "MapService arena blocks: " << current.arenaBlockCount;
+  }
+
   MapService::CallbackId MapService::RegisterTileStateCallback(TileStateCallback callback)
   {
     std::lock_guard<std::mutex> lock(callbackMutex);
@@ -21,6 +21,10 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <map>
 #include <set>
 
 #include <sstream>
@@ -28,6 +32,8 @@
 #include <osmscout/system/Assert.h>
 
 #include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
 #include <osmscout/util/Logger.h>
 
 #include <osmscout/oss/Parser.h>
@@ -1541,6 +1547,1282 @@ namespace osmscout {
     return success;
   }
 
+  namespace {
+
+    const uint32_t STYLE_CACHE_FORMAT_VERSION=2;
+    const uint64_t HASH_OFFSET_BASIS=14695981039346656037ull;
+    const uint64_t HASH_PRIME=1099511628211ull;
+
+    /**
+     * FNV-1a hash of the given string, the terminating zero is included so that
+     * consecutive strings cannot be confused.
+     */
+    uint64_t HashString(uint64_t hash,
+                        const std::string& value)
+    {
+      for (const char c : value) {
+        hash^=(uint8_t)c;
+        hash*=HASH_PRIME;
+      }
+
+      hash*=HASH_PRIME;
+
+      return hash;
+    }
+
+    /**
+     * A style and the names of its attributes written by StyleCacheWriter
+     */
+    struct CachedStyle
+    {
+      std::string              name;
+      StyleDescriptorRef       descriptor;
+      std::vector<std::string> attributes;
+    };
+
+    /**
+     * Returns a description of the cache format, consisting of the format version and
+     * the attributes of all styles. It is part of the cache key, so caches written
+     * by a build with different style attributes are never read.
+     *
+     * Returns false, if a style has an attribute StyleCacheWriter does not know
+     * about, since it would silently get lost in the cache. Caching is disabled then.
+     */
+    bool GetStyleCacheFormat(std::string& format)
+    {
+      static const std::vector<CachedStyle> cachedStyles={
+        {"LineStyle",LineStyle::GetDescriptor(),
+         {"color","gapColor","displayWidth","width","displayOffset","offset","joinCap","endCap","dash","priority","zIndex","offsetRel"}},
+        {"FillStyle",FillStyle::GetDescriptor(),
+         {"color","pattern","patternMinMag"}},
+        {"BorderStyle",BorderStyle::GetDescriptor(),
+         {"color","gapColor","width","dash","displayOffset","offset","priority"}},
+        {"TextStyle",TextStyle::GetDescriptor(),
+         {"label","style","color","size","scaleMag","autoSize","priority","position"}},
+        {"PathShieldStyle",PathShieldStyle::GetDescriptor(),
+         {"label","color","backgroundColor","borderColor","size","priority","shieldSpace"}},
+        {"PathTextStyle",PathTextStyle::GetDescriptor(),
+         {"label","color","size","displayOffset","offset","priority"}},
+        {"IconStyle",IconStyle::GetDescriptor(),
+         {"symbol","name","position","priority","overlay"}},
+        {"PathSymbolStyle",PathSymbolStyle::GetDescriptor(),
+         {"symbol","symbolSpace","displayOffset","offset","offsetRel"}}
+      };
+
+      format=std::to_string(STYLE_CACHE_FORMAT_VERSION);
+
+      for (const auto& style : cachedStyles) {
+        std::map<std::string,StyleAttributeType> attributes;
+
+        for (const auto& attribute : style.descriptor->GetAttributes()) {
+          attributes[attribute.first]=attribute.second->GetType();
+        }
+
+        for (const auto& attribute : attributes) {
+          if (std::find(style.attributes.begin(),
+                        style.attributes.end(),
+                        attribute.first)==style.attributes.end()) {
+            log.Warn() << "Attribute '" << attribute.first << "' of " << style.name << " is not supported by the style sheet cache";
+            return false;
+          }
+
+          format+=";"+style.name+"."+attribute.first+"="+std::to_string((int)attribute.second);
+        }
+      }
+
+      return true;
+    }
+
+    template<class S, class A>
+    using StyleLookupTable=std::vector<std::vector<std::list<StyleSelector<S,A>>>>;
+
+    /**
+     * Writes the post-processed state of a StyleConfig. Selectors are copied to all types
+     * and levels they apply to, but each copy shares the style of the original selector.
+     * Each selector is thus only written once per lookup table (identified by its style)
+     * and referenced by its index.
+     */
+    class StyleCacheWriter
+    {
+    private:
+      FileWriter&                writer;
+      const StyleResolveContext& context;
+
+    public:
+      StyleCacheWriter(FileWriter& writer,
+                       const StyleResolveContext& context)
+      : writer(writer),
+        context(context)
+      {
+        // no code
+      }
+
+      void WriteDouble(double value)
+      {
+        uint64_t bits;
+
+        memcpy(&bits,&value,sizeof(bits));
+
+        writer.Write(bits);
+      }
+
+      void WriteColor(const Color& color)
+      {
+        WriteDouble(color.GetR());
+        WriteDouble(color.GetG());
+        WriteDouble(color.GetB());
+        WriteDouble(color.GetA());
+      }
+
+      void WriteDoubles(const std::vector<double>& values)
+      {
+        writer.WriteNumber((uint32_t)values.size());
+
+        for (const auto value : values) {
+          WriteDouble(value);
+        }
+      }
+
+      void WriteLabel(const LabelProviderRef& label)
+      {
+        writer.Write(label ? label->GetName() : std::string());
+      }
+
+      void WriteSymbolName(const SymbolRef& symbol)
+      {
+        writer.Write(symbol ? symbol->GetName() : std::string());
+      }
+
+      void WriteTypeSet(const TypeInfoSet& types)
+      {
+        writer.WriteNumber((uint32_t)types.Size());
+
+        for (const auto& type : types) {
+          writer.WriteNumber((uint32_t)type->GetIndex());
+        }
+      }
+
+      void WriteCriteria(const StyleCriteria& criteria)
+      {
+        writer.WriteNumber((uint32_t)criteria.GetFeatures().size());
+
+        for (const auto& feature : criteria.GetFeatures()) {
+          bool hasFlag=feature.flagIndex!=std::numeric_limits<size_t>::max();
+
+          writer.Write(context.GetFeatureName(feature.featureFilterIndex));
+          writer.Write(hasFlag);
+
+          if (hasFlag) {
+            writer.WriteNumber((uint32_t)feature.flagIndex);
+          }
+        }
+
+        writer.Write(criteria.GetOneway());
+
+        const SizeConditionRef& sizeCondition=criteria.GetSizeCondition();
+
+        writer.Write((bool)sizeCondition);
+
+        if (sizeCondition) {
+          writer.Write(sizeCondition->HasMinMM());
+          WriteDouble(sizeCondition->GetMinMM());
+          writer.Write(sizeCondition->HasMinPx());
+          WriteDouble(sizeCondition->GetMinPx());
+          writer.Write(sizeCondition->HasMaxMM());
+          WriteDouble(sizeCondition->GetMaxMM());
+          writer.Write(sizeCondition->HasMaxPx());
+          WriteDouble(sizeCondition->GetMaxPx());
+        }
+      }
+
+      void WriteStyle(const LineStyle& style)
+      {
+        writer.Write(style.GetSlot());
+        WriteColor(style.GetLineColor());
+        WriteColor(style.GetGapColor());
+        WriteDouble(style.GetDisplayWidth());
+        WriteDouble(style.GetWidth());
+        WriteDouble(style.GetDisplayOffset());
+        WriteDouble(style.GetOffset());
+        writer.Write((uint8_t)style.GetJoinCap());
+        writer.Write((uint8_t)style.GetEndCap());
+        WriteDoubles(style.GetDash());
+        writer.Write((int32_t)style.GetPriority());
+        writer.Write((int32_t)style.GetZIndex());
+        writer.Write((uint8_t)style.GetOffsetRel());
+      }
+
+      void WriteStyle(const FillStyle& style)
+      {
+        WriteColor(style.GetFillColor());
+        writer.Write(style.GetPatternName());
+        writer.WriteNumber((uint64_t)style.GetPatternId());
+        WriteDouble(style.GetPatternMinMag().GetMagnification());
+      }
+
+      void WriteStyle(const BorderStyle& style)
+      {
+        writer.Write(style.GetSlot());
+        WriteColor(style.GetColor());
+        WriteColor(style.GetGapColor());
+        WriteDouble(style.GetWidth());
+        WriteDoubles(style.GetDash());
+        WriteDouble(style.GetDisplayOffset());
+        WriteDouble(style.GetOffset());
+        writer.Write((int32_t)style.GetPriority());
+      }
+
+      void WriteStyle(const TextStyle& style)
+      {
+        writer.Write(style.GetSlot());
+        writer.WriteNumber((uint64_t)style.GetPriority());
+        WriteDouble(style.GetSize());
+        WriteLabel(style.GetLabel());
+        writer.WriteNumber((uint64_t)style.GetPosition());
+        WriteColor(style.GetTextColor());
+        writer.Write((uint8_t)style.GetStyle());
+        WriteDouble(style.GetScaleAndFadeMag().GetMagnification());
+        writer.Write(style.GetAutoSize());
+      }
+
+      void WriteStyle(const PathShieldStyle& style)
+      {
+        writer.WriteNumber((uint64_t)style.GetPriority());
+        WriteDouble(style.GetSize());
+        WriteLabel(style.GetLabel());
+        WriteColor(style.GetTextColor());
+        WriteColor(style.GetBgColor());
+        WriteColor(style.GetBorderColor());
+        WriteDouble(style.GetShieldSpace());
+      }
+
+      void WriteStyle(const PathTextStyle& style)
+      {
+        WriteLabel(style.GetLabel());
+        WriteDouble(style.GetSize());
+        WriteColor(style.GetTextColor());
+        WriteDouble(style.GetDisplayOffset());
+        WriteDouble(style.GetOffset());
+        writer.WriteNumber((uint64_t)style.GetPriority());
+      }
+
+      void WriteStyle(const IconStyle& style)
+      {
+        WriteSymbolName(style.GetSymbol());
+        writer.Write(style.GetIconName());
+        writer.WriteNumber((uint64_t)style.GetIconId());
+        writer.WriteNumber((uint32_t)style.GetWidth());
+        writer.WriteNumber((uint32_t)style.GetHeight());
+        writer.WriteNumber((uint64_t)style.GetPosition());
+        writer.WriteNumber((uint64_t)style.GetPriority());
+        writer.Write(style.IsOverlay());
+      }
+
+      void WriteStyle(const PathSymbolStyle& style)
+      {
+        writer.Write(style.GetSlot());
+        WriteSymbolName(style.GetSymbol());
+        WriteDouble(style.GetSymbolSpace());
+        WriteDouble(style.GetDisplayOffset());
+        WriteDouble(style.GetOffset());
+        writer.Write((uint8_t)style.GetOffsetRel());
+      }
+
+      void WriteSymbol(const Symbol& symbol)
+      {
+        writer.Write(symbol.GetName());
+        writer.WriteNumber((uint32_t)symbol.GetPrimitives().size());
+
+        for (const auto& primitive : symbol.GetPrimitives()) {
+          const DrawPrimitive* primitivePtr=primitive.get();
+
+          if (const auto* polygon=dynamic_cast<const PolygonPrimitive*>(primitivePtr);
+              polygon!=nullptr) {
+            writer.Write((uint8_t)0);
+            writer.WriteNumber((uint32_t)polygon->GetCoords().size());
+
+            for (const auto& coord : polygon->GetCoords()) {
+              WriteDouble(coord.GetX());
+              WriteDouble(coord.GetY());
+            }
+          }
+          else if (const auto* rectangle=dynamic_cast<const RectanglePrimitive*>(primitivePtr);
+                   rectangle!=nullptr) {
+            writer.Write((uint8_t)1);
+            WriteDouble(rectangle->GetTopLeft().GetX());
+            WriteDouble(rectangle->GetTopLeft().GetY());
+            WriteDouble(rectangle->GetWidth());
+            WriteDouble(rectangle->GetHeight());
+          }
+          else if (const auto* circle=dynamic_cast<const CirclePrimitive*>(primitivePtr);
+                   circle!=nullptr) {
+            writer.Write((uint8_t)2);
+            WriteDouble(circle->GetCenter().GetX());
+            WriteDouble(circle->GetCenter().GetY());
+            WriteDouble(circle->GetRadius());
+          }
+          else {
+            throw IOException(writer.GetFilename(),
+                              "Unsupported draw primitive in symbol '"+symbol.GetName()+"'");
+          }
+
+          writer.Write((uint8_t)primitive->GetProjectionMode());
+
+          writer.Write((bool)primitive->GetFillStyle());
+
+          if (primitive->GetFillStyle()) {
+            WriteStyle(*primitive->GetFillStyle());
+          }
+
+          writer.Write((bool)primitive->GetBorderStyle());
+
+          if (primitive->GetBorderStyle()) {
+            WriteStyle(*primitive->GetBorderStyle());
+          }
+        }
+      }
+
+      template<class S, class A>
+      void WriteLookupTable(const StyleLookupTable<S,A>& table)
+      {
+        std::unordered_map<const S*,uint32_t>  selectorIndex;
+        std::vector<const StyleSelector<S,A>*> selectors;
+
+        for (const auto& typeSelectors : table) {
+          for (const auto& levelSelectors : typeSelectors) {
+            for (const auto& selector : levelSelectors) {
+              if (selectorIndex.emplace(selector.style.get(),
+                                        (uint32_t)selectors.size()).second) {
+                selectors.push_back(&selector);
+              }
+            }
+          }
+        }
+
+        writer.WriteNumber((uint32_t)selectors.size());
+
+        for (const auto selector : selectors) {
+          WriteCriteria(selector->criteria);
+
+          writer.WriteNumber((uint32_t)selector->attributes.size());
+
+          for (const auto attribute : selector->attributes) {
+            writer.WriteNumber((uint32_t)attribute);
+          }
+
+          WriteStyle(*selector->style);
+        }
+
+        writer.WriteNumber((uint32_t)table.size());
+
+        for (const auto& typeSelectors : table) {
+          writer.WriteNumber((uint32_t)typeSelectors.size());
+
+          for (const auto& levelSelectors : typeSelectors) {
+            writer.WriteNumber((uint32_t)levelSelectors.size());
+
+            for (const auto& selector : levelSelectors) {
+              writer.WriteNumber(selectorIndex[selector.style.get()]);
+            }
+          }
+        }
+      }
+
+      template<class S, class A>
+      void WriteLookupTables(const std::vector<StyleLookupTable<S,A>>& tables)
+      {
+        writer.WriteNumber((uint32_t)tables.size());
+
+        for (const auto& table : tables) {
+          WriteLookupTable(table);
+        }
+      }
+
+      void WriteTypeSets(const std::vector<TypeInfoSet>& typeSets)
+      {
+        writer.WriteNumber((uint32_t)typeSets.size());
+
+        for (const auto& types : typeSets) {
+          WriteTypeSet(types);
+        }
+      }
+    };
+
+    /**
+     * Reads the state written by StyleCacheWriter back into a StyleConfig. Label providers
+     * and symbols are resolved by name, failing to do so invalidates the cache.
+     */
+    class StyleCacheReader
+    {
+    private:
+      FileScanner&                                      scanner;
+      StyleConfig&                                      config;
+      std::unordered_map<std::string,LabelProviderRef> labels;
+
+    public:
+      StyleCacheReader(FileScanner& scanner,
+                       StyleConfig& config)
+      : scanner(scanner),
+        config(config)
+      {
+        // no code
+      }
+
+      double ReadDouble()
+      {
+        uint64_t bits;
+        double   value;
+
+        scanner.Read(bits);
+
+        memcpy(&value,&bits,sizeof(value));
+
+        return value;
+      }
+
+      Color ReadColor()
+      {
+        double r=ReadDouble();
+        double g=ReadDouble();
+        double b=ReadDouble();
+        double a=ReadDouble();
+
+        return Color(r,g,b,a);
+      }
+
+      std::vector<double> ReadDoubles()
+      {
+        uint32_t            count;
+        std::vector<double> values;
+
+        scanner.ReadNumber(count);
+
+        values.reserve(count);
+
+        for (uint32_t i=0; i<count; i++) {
+          values.push_back(ReadDouble());
+        }
+
+        return values;
+      }
+
+      size_t ReadSize()
+      {
+        uint64_t value;
+
+        scanner.ReadNumber(value);
+
+        return (size_t)value;
+      }
+
+      std::string ReadString()
+      {
+        std::string value;
+
+        scanner.Read(value);
+
+        return value;
+      }
+
+      LabelProviderRef ReadLabel()
+      {
+        std::string name=ReadString();
+
+        if (name.empty()) {
+          return nullptr;
+        }
+
+        auto entry=labels.find(name);
+
+        if (entry!=labels.end()) {
+          return entry->second;
+        }
+
+        LabelProviderRef label=config.GetLabelProvider(name);
+
+        if (!label) {
+          // Feature label readers are named "<feature>.<label>"
+          std::string::size_type separator=name.find('.');
+          FeatureRef             feature;
+          size_t                 labelIndex;
+
+          if (separator!=std::string::npos) {
+            feature=config.GetTypeConfig()->GetFeature(name.substr(0,separator));
+          }
+
+          if (!feature ||
+              !feature->HasLabel() ||
+              !feature->GetLabelIndex(name.substr(separator+1),
+                                      labelIndex)) {
+            throw IOException(scanner.GetFilename(),
+                              "Cannot resolve label provider '"+name+"'");
+          }
+
+          label=std::make_shared<DynamicFeatureLabelReader>(*config.GetTypeConfig(),
+                                                            name.substr(0,separator),
+                                                            name.substr(separator+1));
+        }
+
+        labels.emplace(name,label);
+
+        return label;
+      }
+
+      SymbolRef ReadSymbolName()
+      {
+        std::string name=ReadString();
+
+        if (name.empty()) {
+          return nullptr;
+        }
+
+        SymbolRef symbol=config.GetSymbol(name);
+
+        if (!symbol) {
+          throw IOException(scanner.GetFilename(),
+                            "Cannot resolve symbol '"+name+"'");
+        }
+
+        return symbol;
+      }
+
+      TypeInfoRef ReadType()
+      {
+        uint32_t index;
+
+        scanner.ReadNumber(index);
+
+        if (index>=config.GetTypeConfig()->GetTypeCount()) {
+          throw IOException(scanner.GetFilename(),
+                            "Invalid type index");
+        }
+
+        return config.GetTypeConfig()->GetTypeInfo(index);
+      }
+
+      void ReadTypeSet(TypeInfoSet& types)
+      {
+        uint32_t count;
+
+        scanner.ReadNumber(count);
+
+        for (uint32_t i=0; i<count; i++) {
+          types.Set(ReadType());
+        }
+      }
+
+      StyleFilter ReadFilter()
+      {
+        StyleFilter filter;
+        uint32_t    featureCount;
+
+        scanner.ReadNumber(featureCount);
+
+        for (uint32_t i=0; i<featureCount; i++) {
+          std::string featureName=ReadString();
+          bool        hasFlag;
+          size_t      flagIndex=std::numeric_limits<size_t>::max();
+
+          scanner.Read(hasFlag);
+
+          if (hasFlag) {
+            uint32_t index;
+
+            scanner.ReadNumber(index);
+            flagIndex=index;
+          }
+
+          FeatureRef feature=config.GetTypeConfig()->GetFeature(featureName);
+
+          if (!feature) {
+            throw IOException(scanner.GetFilename(),
+                              "Cannot resolve feature '"+featureName+"'");
+          }
+
+          filter.AddFeature(config.GetFeatureFilterIndex(*feature),
+                            flagIndex);
+        }
+
+        bool oneway;
+        bool hasSizeCondition;
+
+        scanner.Read(oneway);
+        scanner.Read(hasSizeCondition);
+
+        filter.SetOneway(oneway);
+
+        if (hasSizeCondition) {
+          SizeConditionRef sizeCondition=std::make_shared<SizeCondition>();
+          bool             isSet;
+          double           value;
+
+          scanner.Read(isSet);
+          value=ReadDouble();
+          if (isSet) {
+            sizeCondition->SetMinMM(value);
+          }
+
+          scanner.Read(isSet);
+          value=ReadDouble();
+          if (isSet) {
+            sizeCondition->SetMinPx(value);
+          }
+
+          scanner.Read(isSet);
+          value=ReadDouble();
+          if (isSet) {
+            sizeCondition->SetMaxMM(value);
+          }
+
+          scanner.Read(isSet);
+          value=ReadDouble();
+          if (isSet) {
+            sizeCondition->SetMaxPx(value);
+          }
+
+          filter.SetSizeCondition(sizeCondition);
+        }
+
+        return filter;
+      }
+
+      void ReadStyle(LineStyle& style)
+      {
+        uint8_t joinCap;
+        uint8_t endCap;
+        int32_t priority;
+        int32_t zIndex;
+        uint8_t offsetRel;
+
+        style.SetSlot(ReadString());
+        style.SetLineColor(ReadColor());
+        style.SetGapColor(ReadColor());
+        style.SetDisplayWidth(ReadDouble());
+        style.SetWidth(ReadDouble());
+        style.SetDisplayOffset(ReadDouble());
+        style.SetOffset(ReadDouble());
+        scanner.Read(joinCap);
+        style.SetJoinCap((LineStyle::CapStyle)joinCap);
+        scanner.Read(endCap);
+        style.SetEndCap((LineStyle::CapStyle)endCap);
+        style.SetDashes(ReadDoubles());
+        scanner.Read(priority);
+        style.SetPriority(priority);
+        scanner.Read(zIndex);
+        style.SetZIndex(zIndex);
+        scanner.Read(offsetRel);
+        style.SetOffsetRel((OffsetRel)offsetRel);
+      }
+
+      void ReadStyle(FillStyle& style)
+      {
+        style.SetFillColor(ReadColor());
+        style.SetPattern(ReadString());
+        style.SetPatternId(ReadSize());
+        style.SetPatternMinMag(Magnification(ReadDouble()));
+      }
+
+      void ReadStyle(BorderStyle& style)
+      {
+        int32_t priority;
+
+        style.SetSlot(ReadString());
+        style.SetColor(ReadColor());
+        style.SetGapColor(ReadColor());
+        style.SetWidth(ReadDouble());
+        style.SetDashes(ReadDoubles());
+        style.SetDisplayOffset(ReadDouble());
+        style.SetOffset(ReadDouble());
+        scanner.Read(priority);
+        style.SetPriority(priority);
+      }
+
+      void ReadStyle(TextStyle& style)
+      {
+        uint8_t textStyle;
+        bool    autoSize;
+
+        style.SetSlot(ReadString());
+        style.SetPriority(ReadSize());
+        style.SetSize(ReadDouble());
+        style.SetLabel(ReadLabel());
+        style.SetPosition(ReadSize());
+        style.SetTextColor(ReadColor());
+        scanner.Read(textStyle);
+        style.SetStyle((TextStyle::Style)textStyle);
+        style.SetScaleAndFadeMag(Magnification(ReadDouble()));
+        scanner.Read(autoSize);
+        style.SetAutoSize(autoSize);
+      }
+
+      void ReadStyle(PathShieldStyle& style)
+      {
+        style.SetPriority(ReadSize());
+        style.SetSize(ReadDouble());
+        style.SetLabel(ReadLabel());
+        style.SetTextColor(ReadColor());
+        style.SetBgColor(ReadColor());
+        style.SetBorderColor(ReadColor());
+        style.SetShieldSpace(ReadDouble());
+      }
+
+      void ReadStyle(PathTextStyle& style)
+      {
+        style.SetLabel(ReadLabel());
+        style.SetSize(ReadDouble());
+        style.SetTextColor(ReadColor());
+        style.SetDisplayOffset(ReadDouble());
+        style.SetOffset(ReadDouble());
+        style.SetPriority(ReadSize());
+      }
+
+      void ReadStyle(IconStyle& style)
+      {
+        uint32_t width;
+        uint32_t height;
+        bool     overlay;
+
+        style.SetSymbol(ReadSymbolName());
+        style.SetIconName(ReadString());
+        style.SetIconId(ReadSize());
+        scanner.ReadNumber(width);
+        style.SetWidth(width);
+        scanner.ReadNumber(height);
+        style.SetHeight(height);
+        style.SetPosition(ReadSize());
+        style.SetPriority(ReadSize());
+        scanner.Read(overlay);
+        style.SetOverlay(overlay);
+      }
+
+      void ReadStyle(PathSymbolStyle& style)
+      {
+        uint8_t offsetRel;
+
+        style.SetSlot(ReadString());
+        style.SetSymbol(ReadSymbolName());
+        style.SetSymbolSpace(ReadDouble());
+        style.SetDisplayOffset(ReadDouble());
+        style.SetOffset(ReadDouble());
+        scanner.Read(offsetRel);
+        style.SetOffsetRel((OffsetRel)offsetRel);
+      }
+
+      SymbolRef ReadSymbol()
+      {
+        SymbolRef symbol=std::make_shared<Symbol>(ReadString());
+        uint32_t  primitiveCount;
+
+        scanner.ReadNumber(primitiveCount);
+
+        for (uint32_t p=0; p<primitiveCount; p++) {
+          uint8_t             kind;
+          std::vector<double> geometry;
+
+          scanner.Read(kind);
+
+          if (kind==0) {
+            uint32_t coordCount;
+
+            scanner.ReadNumber(coordCount);
+
+            for (uint32_t c=0; c<2*coordCount; c++) {
+              geometry.push_back(ReadDouble());
+            }
+          }
+          else if (kind==1) {
+            for (size_t c=0; c<4; c++) {
+              geometry.push_back(ReadDouble());
+            }
+          }
+          else if (kind==2) {
+            for (size_t c=0; c<3; c++) {
+              geometry.push_back(ReadDouble());
+            }
+          }
+          else {
+            throw IOException(scanner.GetFilename(),
+                              "Unsupported draw primitive in symbol '"+symbol->GetName()+"'");
+          }
+
+          uint8_t        projectionMode;
+          bool           hasStyle;
+          FillStyleRef   fillStyle;
+          BorderStyleRef borderStyle;
+
+          scanner.Read(projectionMode);
+
+          scanner.Read(hasStyle);
+
+          if (hasStyle) {
+            fillStyle=std::make_shared<FillStyle>();
+            ReadStyle(*fillStyle);
+          }
+
+          scanner.Read(hasStyle);
+
+          if (hasStyle) {
+            borderStyle=std::make_shared<BorderStyle>();
+            ReadStyle(*borderStyle);
+          }
+
+          auto mode=(DrawPrimitive::ProjectionMode)projectionMode;
+
+          if (kind==0) {
+            PolygonPrimitiveRef polygon=std::make_shared<PolygonPrimitive>(mode,
+                                                                           fillStyle,
+                                                                           borderStyle);
+
+            for (size_t c=0; c<geometry.size(); c+=2) {
+              polygon->AddCoord(Vertex2D(geometry[c],geometry[c+1]));
+            }
+
+            symbol->AddPrimitive(polygon);
+          }
+          else if (kind==1) {
+            symbol->AddPrimitive(std::make_shared<RectanglePrimitive>(mode,
+                                                                      Vertex2D(geometry[0],geometry[1]),
+                                                                      geometry[2],
+                                                                      geometry[3],
+                                                                      fillStyle,
+                                                                      borderStyle));
+          }
+          else {
+            symbol->AddPrimitive(std::make_shared<CirclePrimitive>(mode,
+                                                                   Vertex2D(geometry[0],geometry[1]),
+                                                                   geometry[2],
+                                                                   fillStyle,
+                                                                   borderStyle));
+          }
+        }
+
+        return symbol;
+      }
+
+      template<class S, class A>
+      void ReadLookupTable(StyleLookupTable<S,A>& table)
+      {
+        uint32_t                        selectorCount;
+        std::vector<StyleSelector<S,A>> selectors;
+
+        scanner.ReadNumber(selectorCount);
+
+        selectors.reserve(selectorCount);
+
+        for (uint32_t s=0; s<selectorCount; s++) {
+          StyleFilter       filter=ReadFilter();
+          PartialStyle<S,A> partialStyle;
+          uint32_t          attributeCount;
+
+          scanner.ReadNumber(attributeCount);
+
+          for (uint32_t a=0; a<attributeCount; a++) {
+            uint32_t attribute;
+
+            scanner.ReadNumber(attribute);
+
+            partialStyle.attributes.insert((A)attribute);
+          }
+
+          ReadStyle(*partialStyle.style);
+
+          selectors.emplace_back(filter,
+                                 partialStyle);
+        }
+
+        uint32_t typeCount;
+
+        scanner.ReadNumber(typeCount);
+
+        table.resize(typeCount);
+
+        for (auto& typeSelectors : table) {
+          uint32_t levelCount;
+
+          scanner.ReadNumber(levelCount);
+
+          typeSelectors.resize(levelCount);
+
+          for (auto& levelSelectors : typeSelectors) {
+            uint32_t levelSelectorCount;
+
+            scanner.ReadNumber(levelSelectorCount);
+
+            for (uint32_t s=0; s<levelSelectorCount; s++) {
+              uint32_t index;
+
+              scanner.ReadNumber(index);
+
+              if (index>=selectors.size()) {
+                throw IOException(scanner.GetFilename(),
+                                  "Invalid selector index");
+              }
+
+              levelSelectors.push_back(selectors[index]);
+            }
+          }
+        }
+      }
+
+      template<class S, class A>
+      void ReadLookupTables(std::vector<StyleLookupTable<S,A>>& tables)
+      {
+        uint32_t count;
+
+        scanner.ReadNumber(count);
+
+        tables.resize(count);
+
+        for (auto& table : tables) {
+          ReadLookupTable(table);
+        }
+      }
+
+      void ReadTypeSets(std::vector<TypeInfoSet>& typeSets)
+      {
+        uint32_t count;
+
+        scanner.ReadNumber(count);
+
+        typeSets.reserve(count);
+
+        for (uint32_t i=0; i<count; i++) {
+          typeSets.emplace_back(*config.GetTypeConfig());
+
+          ReadTypeSet(typeSets.back());
+        }
+      }
+    };
+  }
+
+  /**
+   * Reads the cached, post-processed style sheet from the given file. Returns false
+   * if the file does not exist, has a different format version or was written for
+   * a different cache key. On error the StyleConfig is left in an undefined state and
+   * must be reset.
+   */
+  bool StyleConfig::ReadCache(const std::string& cacheFile,
+                              uint64_t cacheKey)
+  {
+    FileScanner scanner;
+
+    if (!ExistsInFilesystem(cacheFile)) {
+      return false;
+    }
+
+    try {
+      uint32_t version;
+      uint64_t key;
+
+      scanner.Open(cacheFile,
+                   FileScanner::Sequential,
+                   true);
+
+      scanner.Read(version);
+      scanner.Read(key);
+
+      if (version!=STYLE_CACHE_FORMAT_VERSION ||
+          key!=cacheKey) {
+        log.Debug() << "Style sheet cache '" << cacheFile << "' is stale";
+        scanner.Close();
+        return false;
+      }
+
+      StyleCacheReader reader(scanner,*this);
+      uint32_t         count;
+
+      scanner.ReadNumber(count);
+
+      for (uint32_t i=0; i<count; i++) {
+        RegisterSymbol(reader.ReadSymbol());
+      }
+
+      scanner.ReadNumber(count);
+
+      for (uint32_t i=0; i<count; i++) {
+        std::string name=reader.ReadString();
+        uint8_t     kind;
+
+        scanner.Read(kind);
+
+        if (kind==0) {
+          AddConstant(name,std::make_shared<StyleConstantColor>(reader.ReadColor()));
+        }
+        else if (kind==1) {
+          AddConstant(name,std::make_shared<StyleConstantMag>(Magnification(reader.ReadDouble())));
+        }
+        else if (kind==2) {
+          AddConstant(name,std::make_shared<StyleConstantUInt>(reader.ReadSize()));
+        }
+        else {
+          uint8_t unit;
+          double  width=reader.ReadDouble();
+
+          scanner.Read(unit);
+
+          AddConstant(name,std::make_shared<StyleConstantWidth>(width,
+                                                                (StyleConstantWidth::Unit)unit));
+        }
+      }
+
+      scanner.ReadNumber(count);
+
+      wayPrio.resize(count);
+
+      for (auto& prio : wayPrio) {
+        prio=reader.ReadSize();
+      }
+
+      reader.ReadLookupTables(nodeTextStyleSelectors);
+      reader.ReadLookupTable(nodeIconStyleSelectors);
+      reader.ReadTypeSets(nodeTypeSets);
+
+      reader.ReadLookupTables(wayLineStyleSelectors);
+      reader.ReadLookupTable(wayPathTextStyleSelectors);
+      reader.ReadLookupTables(wayPathSymbolStyleSelectors);
+      reader.ReadLookupTable(wayPathShieldStyleSelectors);
+      reader.ReadTypeSets(wayTypeSets);
+
+      reader.ReadLookupTable(areaFillStyleSelectors);
+      reader.ReadLookupTables(areaBorderStyleSelectors);
+      reader.ReadLookupTables(areaTextStyleSelectors);
+      reader.ReadLookupTable(areaIconStyleSelectors);
+      reader.ReadLookupTable(areaBorderTextStyleSelectors);
+      reader.ReadLookupTable(areaBorderSymbolStyleSelectors);
+      reader.ReadTypeSets(areaTypeSets);
+
+      scanner.ReadNumber(count);
+
+      for (uint32_t i=0; i<count; i++) {
+        std::string warning=reader.ReadString();
+
+        warnings.push_back(warning);
+      }
+
+      // Flags last, the flag defaults of the style sheet must only be applied to a complete cache
+      scanner.ReadNumber(count);
+
+      for (uint32_t i=0; i<count; i++) {
+        std::string name=reader.ReadString();
+        bool        value;
+
+        scanner.Read(value);
+
+        if (!HasFlag(name)) {
+          AddFlag(name,value);
+        }
+      }
+
+      scanner.Close();
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Warn() << "Cannot read style sheet cache: " << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+  }
+
+  /**
+   * Writes the post-processed style sheet to the given file. The file is first written
+   * to a temporary file and then renamed, so that concurrent readers never see a
+   * partially written cache.
+   */
+  void StyleConfig::WriteCache(const std::string& cacheFile,
+                               uint64_t cacheKey) const
+  {
+    FileWriter  writer;
+    std::string tmpFile=cacheFile+".tmp";
+
+    try {
+      writer.Open(tmpFile);
+
+      writer.Write(STYLE_CACHE_FORMAT_VERSION);
+      writer.Write(cacheKey);
+
+      StyleCacheWriter cacheWriter(writer,styleResolveContext);
+
+      writer.WriteNumber((uint32_t)symbols.size());
+
+      for (const auto& symbol : symbols) {
+        cacheWriter.WriteSymbol(*symbol.second);
+      }
+
+      writer.WriteNumber((uint32_t)constants.size());
+
+      for (const auto& constant : constants) {
+        writer.Write(constant.first);
+
+        if (const auto* colorConstant=dynamic_cast<const StyleConstantColor*>(constant.second.get());
+            colorConstant!=nullptr) {
+          writer.Write((uint8_t)0);
+          cacheWriter.WriteColor(colorConstant->GetColor());
+        }
+        else if (const auto* magConstant=dynamic_cast<const StyleConstantMag*>(constant.second.get());
+                 magConstant!=nullptr) {
+          writer.Write((uint8_t)1);
+          cacheWriter.WriteDouble(magConstant->GetMag().GetMagnification());
+        }
+        else if (const auto* uintConstant=dynamic_cast<const StyleConstantUInt*>(constant.second.get());
+                 uintConstant!=nullptr) {
+          writer.Write((uint8_t)2);
+          writer.WriteNumber((uint64_t)uintConstant->GetUInt());
+        }
+        else if (const auto* widthConstant=dynamic_cast<const StyleConstantWidth*>(constant.second.get());
+                 widthConstant!=nullptr) {
+          writer.Write((uint8_t)3);
+          cacheWriter.WriteDouble(widthConstant->GetWidth());
+          writer.Write((uint8_t)widthConstant->GetUnit());
+        }
+        else {
+          throw IOException(tmpFile,
+                            "Unsupported type of constant '"+constant.first+"'");
+        }
+      }
+
+      writer.WriteNumber((uint32_t)wayPrio.size());
+
+      for (const auto prio : wayPrio) {
+        writer.WriteNumber((uint64_t)prio);
+      }
+
+      cacheWriter.WriteLookupTables(nodeTextStyleSelectors);
+      cacheWriter.WriteLookupTable(nodeIconStyleSelectors);
+      cacheWriter.WriteTypeSets(nodeTypeSets);
+
+      cacheWriter.WriteLookupTables(wayLineStyleSelectors);
+      cacheWriter.WriteLookupTable(wayPathTextStyleSelectors);
+      cacheWriter.WriteLookupTables(wayPathSymbolStyleSelectors);
+      cacheWriter.WriteLookupTable(wayPathShieldStyleSelectors);
+      cacheWriter.WriteTypeSets(wayTypeSets);
+
+      cacheWriter.WriteLookupTable(areaFillStyleSelectors);
+      cacheWriter.WriteLookupTables(areaBorderStyleSelectors);
+      cacheWriter.WriteLookupTables(areaTextStyleSelectors);
+      cacheWriter.WriteLookupTable(areaIconStyleSelectors);
+      cacheWriter.WriteLookupTable(areaBorderTextStyleSelectors);
+      cacheWriter.WriteLookupTable(areaBorderSymbolStyleSelectors);
+      cacheWriter.WriteTypeSets(areaTypeSets);
+
+      writer.WriteNumber((uint32_t)warnings.size());
+
+      for (const auto& warning : warnings) {
+        writer.Write(warning);
+      }
+
+      writer.WriteNumber((uint32_t)flags.size());
+
+      for (const auto& flag : flags) {
+        writer.Write(flag.first);
+        writer.Write(flag.second);
+      }
+
+      writer.Close();
+
+      if (ExistsInFilesystem(cacheFile)) {
+        RemoveFile(cacheFile);
+      }
+
+      if (!RenameFile(tmpFile,cacheFile)) {
+        log.Warn() << "Cannot rename style sheet cache '" << tmpFile << "' to '" << cacheFile << "'";
+        RemoveFile(tmpFile);
+      }
+    }
+    catch (IOException& e) {
+      log.Warn() << "Cannot write style sheet cache: " << e.GetDescription();
+      writer.CloseFailsafe();
+      RemoveFile(tmpFile);
+    }
+  }
+
+  /**
+   * Loads the given style sheet like Load(), but keeps a precompiled binary copy of the
+   * post-processed style sheet in the given cache directory. If the cache matches the
+   * content of the style sheet, the type configuration and the flags set before loading,
+   * it is used instead of parsing the style sheet. Else the style sheet is parsed and the
+   * cache is (re)written.
+   *
+   * Every combination of flags gets its own cache file, switching between them (for
+   * example between day and night mode) thus does not require parsing.
+   *
+   * If a style has attributes the cache format does not support, the style sheet is
+   * always parsed and no cache is written.
+   */
+  bool StyleConfig::LoadCached(const std::string& styleFile,
+                               const std::string& cacheDirectory)
+  {
+    StopClock         timer;
+    std::vector<char> content;
+    std::string       format;
+
+    if (!GetStyleCacheFormat(format)) {
+      return Load(styleFile);
+    }
+
+    Reset();
+    errors.clear();
+    warnings.clear();
+
+    if (!ReadFile(styleFile,content)) {
+      log.Error() << "Cannot load file '" << styleFile << "'";
+      return false;
+    }
+
+    std::map<std::string,bool> sortedFlags(flags.begin(),flags.end());
+    uint64_t                   flagsHash=HASH_OFFSET_BASIS;
+    uint64_t                   cacheKey;
+
+    for (const auto& flag : sortedFlags) {
+      flagsHash=HashString(flagsHash,flag.first);
+      flagsHash=HashString(flagsHash,flag.second ? "1" : "0");
+    }
+
+    cacheKey=HashString(flagsHash,format);
+    cacheKey=HashString(cacheKey,std::string(content.begin(),content.end()));
+
+    for (const auto& type : typeConfig->GetTypes()) {
+      cacheKey=HashString(cacheKey,type->GetName());
+
+      for (const auto& feature : type->GetFeatures()) {
+        cacheKey=HashString(cacheKey,feature.GetFeature()->GetName());
+      }
+    }
+
+    std::string baseName=styleFile.substr(styleFile.find_last_of("/\\")+1);
+    char        flagsHashString[17];
+
+    snprintf(flagsHashString,sizeof(flagsHashString),"%016llx",(unsigned long long)flagsHash);
+
+    std::string cacheFile=AppendFileToDir(cacheDirectory,
+                                          baseName+"-"+flagsHashString+".ossc");
+
+    if (ReadCache(cacheFile,
+                  cacheKey)) {
+      timer.Stop();
+
+      log.Debug() << "Opening StyleConfig from cache: " << timer.ResultString();
+
+      return true;
+    }
+
+    Reset();
+
+    if (!LoadContent(std::string(content.begin(),content.end()))) {
+      return false;
+    }
+
+    WriteCache(cacheFile,
+               cacheKey);
+
+    timer.Stop();
+
+    log.Debug() << "Opening StyleConfig: " << timer.ResultString();
+
+    return true;
+  }
+
   const std::list<std::string>& StyleConfig::GetErrors()
   {
     return errors;
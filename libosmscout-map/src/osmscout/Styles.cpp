@@ -1404,6 +1404,7 @@ namespace osmscout {
     this->textColor=style.textColor;
     this->displayOffset=style.displayOffset;
     this->offset=style.offset;
+    this->priority=style.priority;
   }
 
   void PathTextStyle::SetColorValue(int attribute, const Color& value)
@@ -24,6 +24,7 @@
 
 #include <osmscout/Area.h>
 #include <osmscout/DataFile.h>
+#include <osmscout/MultiResolutionDataFile.h>
 
 namespace osmscout {
   /**
@@ -41,6 +42,22 @@ namespace osmscout {
   };
 
   typedef std::shared_ptr<AreaDataFile> AreaDataFileRef;
+
+  /**
+    \ingroup Database
+    Abstraction for access to the 'areasres.dat' file, holding the areas
+    with geometry simplified for different magnifications.
+    */
+  class OSMSCOUT_API AreaResolutionDataFile : public MultiResolutionDataFile<Area>
+  {
+  public:
+    static const char* const AREAS_RES_DAT;
+
+  public:
+    AreaResolutionDataFile();
+  };
+
+  typedef std::shared_ptr<AreaResolutionDataFile> AreaResolutionDataFileRef;
 }
 
 #endif
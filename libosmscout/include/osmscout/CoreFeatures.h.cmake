@@ -11,4 +11,9 @@
 #cmakedefine OSMSCOUT_HAVE_LIB_MARISA
 #endif
 
+#ifndef OSMSCOUT_HAVE_TRACING
+/* Scoped tracing of hot paths is compiled in */
+#cmakedefine OSMSCOUT_HAVE_TRACING
+#endif
+
 #endif
@@ -20,6 +20,8 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -32,6 +34,9 @@
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Metrics.h>
+#include <osmscout/util/ObjectArena.h>
+#include <osmscout/util/Tracing.h>
 
 //#include <map>
 namespace osmscout {
@@ -89,6 +94,13 @@ namespace osmscout {
 
     mutable std::mutex  accessMutex;     //!< Mutex to secure multi-thread access
 
+    mutable FileOffset  readBytes;       //!< Overall size of all entries read so far
+    mutable size_t      readCount;       //!< Number of entries read so far
+
+    MetricCounter&      readBytesCounter;   //!< Bytes read from this kind of file, shared by all instances
+    MetricCounter&      readCountCounter;   //!< Entries read from this kind of file, shared by all instances
+    MetricCounter&      decodeTimeCounter;  //!< Time spent reading and decoding entries
+
   protected:
     TypeConfigRef       typeConfig;
 
@@ -97,6 +109,12 @@ namespace osmscout {
     bool ReadData(FileOffset offset,
                   N& data) const;
 
+    FileOffset GetAverageEntrySize() const;
+    void Prefetch(std::vector<DataBlockSpan>& spans) const;
+
+    template<typename IteratorIn>
+    void PrefetchOffsets(IteratorIn begin, IteratorIn end) const;
+
   public:
     DataFile(const std::string& datafile, size_t cacheSize);
 
@@ -123,12 +141,14 @@ namespace osmscout {
 
     template<typename IteratorIn>
     bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
-                     std::vector<ValueType>& data) const;
+                     std::vector<ValueType>& data,
+                     const ObjectArenaRef& arena=nullptr) const;
 
     template<typename IteratorIn>
     bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
                      const GeoBox& boundingBox,
-                     std::vector<ValueType>& data) const;
+                     std::vector<ValueType>& data,
+                     const ObjectArenaRef& arena=nullptr) const;
 
     template<typename IteratorIn>
     bool GetByOffset(IteratorIn begin, IteratorIn end, size_t size,
@@ -136,14 +156,27 @@ namespace osmscout {
 
     template<typename IteratorIn>
     bool GetByBlockSpans(IteratorIn begin, IteratorIn end,
-                         std::vector<ValueType>& data) const;
+                         std::vector<ValueType>& data,
+                         const ObjectArenaRef& arena=nullptr) const;
   };
 
   template <class N>
   DataFile<N>::DataFile(const std::string& datafile, size_t cacheSize)
-  : datafile(datafile),cache(cacheSize)
+  : datafile(datafile),
+    cache(cacheSize),
+    readBytes(0),
+    readCount(0),
+    readBytesCounter(metrics.GetCounter("osmscout_datafile_read_bytes_total",
+                                        "Number of bytes read from the data file",
+                                        {{"file",datafile}})),
+    readCountCounter(metrics.GetCounter("osmscout_datafile_read_entries_total",
+                                        "Number of entries read from the data file",
+                                        {{"file",datafile}})),
+    decodeTimeCounter(metrics.GetCounter("osmscout_datafile_decode_nanoseconds_total",
+                                         "Time spent reading and decoding entries of the data file",
+                                         {{"file",datafile}}))
   {
-    // no code
+    cache.SetMetrics(datafile);
   }
 
   template <class N>
@@ -166,8 +199,17 @@ namespace osmscout {
     try {
       scanner.SetPos(offset);
 
+      auto start=std::chrono::steady_clock::now();
+
       data.Read(*typeConfig,
                 scanner);
+
+      readBytes+=scanner.GetPos()-offset;
+      readCount++;
+
+      readBytesCounter.Increment(scanner.GetPos()-offset);
+      readCountCounter.Increment();
+      decodeTimeCounter.Increment(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count());
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
@@ -186,8 +228,19 @@ namespace osmscout {
   bool DataFile<N>::ReadData(N& data) const
   {
     try {
+      FileOffset offset=scanner.GetPos();
+
+      auto start=std::chrono::steady_clock::now();
+
       data.Read(*typeConfig,
                 scanner);
+
+      readBytes+=scanner.GetPos()-offset;
+      readCount++;
+
+      readBytesCounter.Increment(scanner.GetPos()-offset);
+      readCountCounter.Increment();
+      decodeTimeCounter.Increment(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count());
     }
     catch (IOException& e) {
       log.Error() << e.GetDescription();
@@ -197,6 +250,86 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Return the average size of the entries read so far or some
+   * default value, if nothing has been read yet.
+   *
+   * Method is NOT thread-safe.
+   */
+  template <class N>
+  FileOffset DataFile<N>::GetAverageEntrySize() const
+  {
+    if (readCount==0) {
+      return 256;
+    }
+
+    return std::max(readBytes/readCount,(FileOffset)1);
+  }
+
+  /**
+   * Tells the operating system to load the data of the given spans in
+   * advance. The spans get sorted and near spans get merged, so the device
+   * gets a small number of larger requests, which are all processed in
+   * parallel in the background, while we already parse the first entries.
+   *
+   * The end of a span is estimated based on the average entry size.
+   *
+   * Method is NOT thread-safe.
+   */
+  template <class N>
+  void DataFile<N>::Prefetch(std::vector<DataBlockSpan>& spans) const
+  {
+    // Holes up to this size are read, too, instead of starting a new request
+    static const FileOffset maxGap=64*1024;
+
+    if (spans.empty()) {
+      return;
+    }
+
+    std::sort(spans.begin(),
+              spans.end());
+
+    FileOffset entrySize=GetAverageEntrySize();
+    FileOffset rangeStart=spans.front().startOffset;
+    FileOffset rangeEnd=rangeStart;
+
+    for (const auto& span : spans) {
+      FileOffset spanEnd=span.startOffset+span.count*entrySize;
+
+      if (span.startOffset>rangeEnd+maxGap) {
+        scanner.Prefetch(rangeStart,
+                         rangeEnd-rangeStart);
+
+        rangeStart=span.startOffset;
+      }
+
+      rangeEnd=std::max(rangeEnd,spanEnd);
+    }
+
+    scanner.Prefetch(rangeStart,
+                     rangeEnd-rangeStart);
+  }
+
+  /**
+   * Prefetch all entries for the given offsets, that are not already cached.
+   *
+   * Method is NOT thread-safe.
+   */
+  template <class N>
+  template<typename IteratorIn>
+  void DataFile<N>::PrefetchOffsets(IteratorIn begin, IteratorIn end) const
+  {
+    std::vector<DataBlockSpan> spans;
+
+    for (IteratorIn offsetIter=begin; offsetIter!=end; ++offsetIter) {
+      if (!cache.Contains(*offsetIter)) {
+        spans.push_back(DataBlockSpan{*offsetIter,1});
+      }
+    }
+
+    Prefetch(spans);
+  }
+
   /**
    * Open the index file.
    *
@@ -286,6 +419,9 @@ namespace osmscout {
    *    in result vector.
    * @param data
    *    vector containing data. Data is appended.
+   * @param arena
+   *    Optional arena to allocate new objects from. Objects allocated from
+   *    an arena are not stored in the cache.
    * @return
    *    false if there was an error, else true
    *
@@ -295,12 +431,15 @@ namespace osmscout {
   template <typename IteratorIn>
   bool DataFile<N>::GetByOffset(IteratorIn begin, IteratorIn end,
                                 size_t size,
-                                std::vector<ValueType>& data) const
+                                std::vector<ValueType>& data,
+                                const ObjectArenaRef& arena) const
   {
     if (size==0) {
       return true;
     }
 
+    OSMSCOUT_TRACE_SCOPE("DataFile","GetByOffset");
+
     data.reserve(data.size()+size);
     std::lock_guard<std::mutex> lock(accessMutex);
 
@@ -309,6 +448,12 @@ namespace osmscout {
       log.Warn() << "Cache size (" << cache.GetMaxSize() << ") for file " << datafile << " is smaller than current request (" << size << ")";
     }
 
+    PrefetchOffsets(begin,
+                    end);
+
+    // Internal buffers of the objects are allocated from the arena, too
+    ObjectArenaScope arenaScope(arena.get());
+
     for (IteratorIn offsetIter=begin; offsetIter!=end; ++offsetIter) {
       ValueCacheRef entryRef;
 
@@ -316,7 +461,7 @@ namespace osmscout {
         data.push_back(entryRef->value);
       }
       else {
-        ValueType value=std::make_shared<N>();
+        ValueType value=MakeShared<N>(arena);
 
         if (!ReadData(*offsetIter,
                       *value)) {
@@ -324,7 +469,11 @@ namespace osmscout {
           return false;
         }
 
-        cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        // Objects in an arena should not outlive their request because of the cache
+        if (!arena) {
+          cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        }
+
         data.push_back(value);
       }
     }
@@ -342,12 +491,15 @@ namespace osmscout {
   bool DataFile<N>::GetByOffset(IteratorIn begin, IteratorIn end,
                                 size_t size,
                                 const GeoBox& boundingBox,
-                                std::vector<ValueType>& data) const
+                                std::vector<ValueType>& data,
+                                const ObjectArenaRef& arena) const
   {
     if (size==0) {
       return true;
     }
 
+    OSMSCOUT_TRACE_SCOPE("DataFile","GetByOffset");
+
     data.reserve(data.size()+size);
     std::lock_guard<std::mutex> lock(accessMutex);
 
@@ -356,23 +508,33 @@ namespace osmscout {
       log.Warn() << "Cache size (" << cache.GetMaxSize() << ") for file " << datafile << " is smaller than current request (" << size << ")";
     }
 
+    PrefetchOffsets(begin,
+                    end);
+
+    // Internal buffers of the objects are allocated from the arena, too
+    ObjectArenaScope arenaScope(arena.get());
+
     //std::map<std::string,size_t> hitRateTypes;
     //std::map<std::string,size_t> missRateTypes;
     size_t inBoxCount=0;
     for (IteratorIn offsetIter=begin; offsetIter!=end; ++offsetIter) {
-      ValueType value=std::make_shared<N>();
+      ValueType value;
 
       ValueCacheRef entryRef;
       if (cache.GetEntry(*offsetIter,entryRef)){
         value=entryRef->value;
       }else{
+        value=MakeShared<N>(arena);
+
         if (!ReadData(*offsetIter,
                       *value)) {
           log.Error() << "Error while reading data from offset " << *offsetIter << " of file " << datafilename << "!";
           return false;
         }
 
-        cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        if (!arena) {
+          cache.SetEntry(ValueCacheEntry(*offsetIter,value));
+        }
       }
 
       if (!value->Intersects(boundingBox)) {
@@ -427,7 +589,7 @@ namespace osmscout {
       return false;
     }
 
-    for (const auto entry : data) {
+    for (const auto& entry : data) {
       dataMap.insert(std::make_pair(entry->GetFileOffset(),entry));
     }
 
@@ -527,8 +689,11 @@ namespace osmscout {
   template <class N>
   template<typename IteratorIn>
   bool DataFile<N>::GetByBlockSpans(IteratorIn begin, IteratorIn end,
-                                    std::vector<ValueType>& data) const
+                                    std::vector<ValueType>& data,
+                                    const ObjectArenaRef& arena) const
   {
+    OSMSCOUT_TRACE_SCOPE("DataFile","GetByBlockSpans");
+
     uint32_t overallCount=0;
 
     for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
@@ -539,6 +704,20 @@ namespace osmscout {
 
     try {
       std::lock_guard<std::mutex> lock(accessMutex);
+
+      std::vector<DataBlockSpan> uncachedSpans;
+
+      for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
+        if (spanIter->count>0 &&
+            !cache.Contains(spanIter->startOffset)) {
+          uncachedSpans.push_back(*spanIter);
+        }
+      }
+
+      Prefetch(uncachedSpans);
+
+      ObjectArenaScope arenaScope(arena.get());
+
       for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
         if (spanIter->count==0) {
           continue;
@@ -558,7 +737,7 @@ namespace osmscout {
               scanner.SetPos(offset);
             }
 
-            ValueType value=std::make_shared<N>();
+            ValueType value=MakeShared<N>(arena);
 
             if (!ReadData(*value)) {
               log.Error() << "Error while reading data #" << i << " starting from offset " << spanIter->startOffset <<
@@ -566,7 +745,9 @@ namespace osmscout {
               return false;
             }
 
-            cache.SetEntry(ValueCacheEntry(offset,value));
+            if (!arena) {
+              cache.SetEntry(ValueCacheEntry(offset,value));
+            }
             offset=value->GetNextFileOffset();
             offsetSetup=true;
             data.push_back(value);
@@ -54,6 +54,7 @@
 #include <osmscout/routing/Route.h>
 
 #include <osmscout/util/GeoBox.h>
+#include <osmscout/util/ObjectArena.h>
 
 #include <osmscout/system/Compiler.h>
 
@@ -88,6 +89,9 @@ namespace osmscout {
     bool waysDataMMap;
     bool optimizeLowZoomMMap;
     bool indexMMap;
+
+    bool waterIndexInMemory;
+    bool routerDataInMemory;
   public:
     DatabaseParameter();
 
@@ -103,6 +107,9 @@ namespace osmscout {
     void SetOptimizeLowZoomMMap(bool mmap);
     void SetIndexMMap(bool mmap);
 
+    void SetWaterIndexInMemory(bool inMemory);
+    void SetRouterDataInMemory(bool inMemory);
+
     unsigned long GetAreaAreaIndexCacheSize() const;
     unsigned long GetNodeDataCacheSize() const;
     unsigned long GetWayDataCacheSize() const;
@@ -114,6 +121,9 @@ namespace osmscout {
     bool GetWaysDataMMap() const;
     bool GetOptimizeLowZoomMMap() const;
     bool GetIndexMMap() const;
+
+    bool GetWaterIndexInMemory() const;
+    bool GetRouterDataInMemory() const;
   };
 
   class Database;
@@ -287,6 +297,12 @@ namespace osmscout {
     mutable WayDataFileRef          wayDataFile;              //!< Cached access to the 'ways.dat' file
     mutable std::mutex              wayDataFileMutex;         //!< Mutex to make lazy initialisation of way DataFile thread-safe
 
+    mutable AreaResolutionDataFileRef areaResolutionDataFile;  //!< Cached access to the optional 'areasres.dat' file
+    mutable std::mutex              areaResolutionDataFileMutex; //!< Mutex to make lazy initialisation of area resolution file thread-safe
+
+    mutable WayResolutionDataFileRef wayResolutionDataFile;    //!< Cached access to the optional 'waysres.dat' file
+    mutable std::mutex              wayResolutionDataFileMutex; //!< Mutex to make lazy initialisation of way resolution file thread-safe
+
     mutable AreaNodeIndexRef        areaNodeIndex;            //!< Index of nodes by containing area
     mutable std::mutex              areaNodeIndexMutex;       //!< Mutex to make lazy initialisation of area node index thread-safe
 
@@ -330,6 +346,9 @@ namespace osmscout {
     AreaDataFileRef GetAreaDataFile() const;
     WayDataFileRef GetWayDataFile() const;
 
+    AreaResolutionDataFileRef GetAreaResolutionDataFile() const;
+    WayResolutionDataFileRef GetWayResolutionDataFile() const;
+
     AreaNodeIndexRef GetAreaNodeIndex() const;
     AreaAreaIndexRef GetAreaAreaIndex() const;
     AreaWayIndexRef GetAreaWayIndex() const;
@@ -349,7 +368,8 @@ namespace osmscout {
                           std::vector<NodeRef>& nodes) const;
     bool GetNodesByOffset(const std::vector<FileOffset>& offsets,
                           const GeoBox& boundingBox,
-                          std::vector<NodeRef>& nodes) const;
+                          std::vector<NodeRef>& nodes,
+                          const ObjectArenaRef& arena=nullptr) const;
     bool GetNodesByOffset(const std::set<FileOffset>& offsets,
                           std::vector<NodeRef>& nodes) const;
     bool GetNodesByOffset(const std::list<FileOffset>& offsets,
@@ -371,12 +391,20 @@ namespace osmscout {
                              std::vector<AreaRef>& area) const;
     bool GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
                               std::vector<AreaRef>& areas) const;
+    bool GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
+                              const Magnification& magnification,
+                              std::vector<AreaRef>& areas,
+                              const ObjectArenaRef& arena=nullptr) const;
 
 
     bool GetWayByOffset(const FileOffset& offset,
                         WayRef& way) const;
     bool GetWaysByOffset(const std::vector<FileOffset>& offsets,
                          std::vector<WayRef>& ways) const;
+    bool GetWaysByOffset(const std::vector<FileOffset>& offsets,
+                         const Magnification& magnification,
+                         std::vector<WayRef>& ways,
+                         const ObjectArenaRef& arena=nullptr) const;
     bool GetWaysByOffset(const std::set<FileOffset>& offsets,
                          std::vector<WayRef>& ways) const;
     bool GetWaysByOffset(const std::list<FileOffset>& offsets,
@@ -432,6 +460,53 @@ namespace osmscout {
                                              const TypeInfoSet& types,
                                              Distance maxDistance=Distance::Of<Meter>(100));
 
+    /**
+     * Return the given nodes with maximum distance to the given coordinate.
+     * Allows to evaluate multiple locations against the same set of
+     * already loaded nodes.
+     *
+     * @param location
+     *    Geo coordinate in the center of the given circle
+     * @param nodes
+     *    Candidate nodes
+     * @param maxDistance - lookup distance in meters
+     *    Maximum radius from center to search for
+     * @return result object
+     */
+    static NodeRegionSearchResult FilterNodesInRadius(const GeoCoord& location,
+                                                      const std::vector<NodeRef>& nodes,
+                                                      Distance maxDistance=Distance::Of<Meter>(100));
+
+    /**
+     * Return the given ways with maximum distance to the given coordinate.
+     *
+     * @param location
+     *    Geo coordinate in the center of the given circle
+     * @param ways
+     *    Candidate ways
+     * @param maxDistance - lookup distance in meters
+     *    Maximum radius from center to search for
+     * @return result object
+     */
+    static WayRegionSearchResult FilterWaysInRadius(const GeoCoord& location,
+                                                    const std::vector<WayRef>& ways,
+                                                    Distance maxDistance=Distance::Of<Meter>(100));
+
+    /**
+     * Return the given areas with maximum distance to the given coordinate.
+     *
+     * @param location
+     *    Geo coordinate in the center of the given circle
+     * @param areas
+     *    Candidate areas
+     * @param maxDistance - lookup distance in meters
+     *    Maximum radius from center to search for
+     * @return result object
+     */
+    static AreaRegionSearchResult FilterAreasInRadius(const GeoCoord& location,
+                                                      const std::vector<AreaRef>& areas,
+                                                      Distance maxDistance=Distance::Of<Meter>(100));
+
     /**
      * Load nodes of given types in the given geo box
      * Distance is measured in relation to the center of the bounding box
@@ -21,6 +21,7 @@
 */
 
 #include <list>
+#include <map>
 #include <memory>
 
 #include <osmscout/Database.h>
@@ -368,6 +369,40 @@ namespace osmscout {
 
     using ReverseLookupRef = std::shared_ptr<ReverseLookupResult>;
 
+  private:
+    /**
+     * Object types used for the different kinds of location descriptions
+     */
+    struct DescriptionTypes
+    {
+      TypeInfoSet nameAreaTypes;    //!< Nameable areas, but no regions
+      TypeInfoSet nameNodeTypes;    //!< Nameable nodes, but no regions
+      TypeInfoSet addressAreaTypes; //!< Addressable areas
+      TypeInfoSet addressNodeTypes; //!< Addressable nodes
+      TypeInfoSet poiAreaTypes;     //!< Areas indexed as POI
+      TypeInfoSet poiNodeTypes;     //!< Nodes indexed as POI
+      TypeInfoSet crossingWayTypes; //!< Named ways routable by car
+      TypeInfoSet wayTypes;         //!< Ways with a name or a ref
+
+      explicit DescriptionTypes(const TypeConfig& typeConfig);
+    };
+
+    /**
+     * Objects close to a location, that are candidates for its description
+     */
+    struct DescriptionCandidates
+    {
+      std::vector<LocationDescriptionCandicate> nameCandidates;    //!< Sorted and filtered candidates for the name description
+      std::vector<LocationDescriptionCandicate> addressCandidates; //!< Sorted and filtered candidates for the address description
+      std::vector<LocationDescriptionCandicate> poiCandidates;     //!< Sorted and filtered candidates for the POI description
+      WayRef                                    way;               //!< Closest way, if any
+      Distance                                  wayDistance;       //!< Distance to the closest way
+      Point                                     crossing;          //!< Closest crossing, valid if there are crossing ways
+      std::list<WayRef>                         crossingWays;      //!< Ways meeting at the closest crossing
+    };
+
+    typedef std::map<ObjectFileRef,std::list<ReverseLookupResult>> ReverseLookupResultMap;
+
   private:
     DatabaseRef database;
 
@@ -375,6 +410,10 @@ namespace osmscout {
     static bool DistanceComparator(const LocationDescriptionCandicate &a,
                                    const LocationDescriptionCandicate &b);
 
+    static void SortCandidates(std::vector<LocationDescriptionCandicate>& candidates,
+                               double sizeFilter,
+                               bool nameRequired);
+
     const FeatureValueBufferRef GetObjectFeatureBuffer(const ObjectFileRef &object);
 
     Place GetPlace(const std::list<ReverseLookupResult>& lookupResult);
@@ -391,9 +430,48 @@ namespace osmscout {
                          const GeoCoord& location,
                          const AreaRegionSearchResult& results);
 
+    void SelectWay(const GeoCoord& location,
+                   const WayRegionSearchResult& results,
+                   DescriptionCandidates& candidates);
+    void SelectCrossing(const GeoCoord& location,
+                        const WayRegionSearchResult& results,
+                        DescriptionCandidates& candidates);
+
+    bool LookupObject(const ObjectFileRef& object,
+                      const ReverseLookupResultMap* lookupResults,
+                      std::list<ReverseLookupResult>& result) const;
+
+    bool DescribeLocationByName(const DescriptionCandidates& candidates,
+                                const ReverseLookupResultMap* lookupResults,
+                                LocationDescription& description);
+    bool DescribeLocationByAddress(const DescriptionCandidates& candidates,
+                                   const ReverseLookupResultMap* lookupResults,
+                                   LocationDescription& description);
+    bool DescribeLocationByPOI(const DescriptionCandidates& candidates,
+                               const ReverseLookupResultMap* lookupResults,
+                               LocationDescription& description);
+    bool DescribeLocationByCrossing(const GeoCoord& location,
+                                    const DescriptionCandidates& candidates,
+                                    const ReverseLookupResultMap* lookupResults,
+                                    LocationDescription& description);
+    bool DescribeLocationByWay(const DescriptionCandidates& candidates,
+                               const ReverseLookupResultMap* lookupResults,
+                               LocationDescription& description);
+
+    bool DescribeLocationsInTile(const DescriptionTypes& types,
+                                 const std::vector<GeoCoord>& locations,
+                                 const std::vector<size_t>& indexes,
+                                 std::vector<LocationDescription>& descriptions,
+                                 const Distance& lookupDistance,
+                                 double sizeFilter);
+
   public:
     explicit LocationDescriptionService(const DatabaseRef& database);
 
+    /**
+     * Returns all admin regions containing the given coordinate, see
+     * LocationService::ReverseLookupRegion
+     */
     bool ReverseLookupRegion(const GeoCoord &coord,
                              std::list<ReverseLookupResult>& result) const;
 
@@ -407,6 +485,12 @@ namespace osmscout {
                           const Distance& lookupDistance=Distance::Of<Meter>(100),
                           double sizeFilter=1.0);
 
+    bool DescribeLocations(const std::vector<GeoCoord>& locations,
+                           std::vector<LocationDescription>& descriptions,
+                           const Distance& lookupDistance=Distance::Of<Meter>(100),
+                           double sizeFilter=1.0,
+                           size_t threadCount=0);
+
     bool DescribeLocationByName(const GeoCoord& location,
                                 LocationDescription& description,
                                 const Distance& lookupDistance=Distance::Of<Meter>(100),
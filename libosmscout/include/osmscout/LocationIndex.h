@@ -27,6 +27,7 @@
 #include <unordered_set>
 
 #include <osmscout/Location.h>
+#include <osmscout/RegionRasterIndex.h>
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/FileScanner.h>
@@ -70,6 +71,7 @@ namespace osmscout {
     uint32_t                        maxLocationWords;
     uint32_t                        maxAddressWords;
     FileOffset                      indexOffset;
+    RegionRasterIndexRef            regionRaster;
 
   private:
     void Read(FileScanner& scanner,
@@ -158,6 +160,21 @@ namespace osmscout {
       return maxAddressWords;
     }
 
+    /**
+     * Returns the raster of admin regions or an empty reference, if the database
+     * does not contain a region raster
+     */
+    inline RegionRasterIndexRef GetRegionRaster() const
+    {
+      return regionRaster;
+    }
+
+    /**
+     * Load the admin regions at the given offsets (see AdminRegion::regionOffset)
+     */
+    bool LoadAdminRegions(const std::vector<FileOffset>& offsets,
+                          std::vector<AdminRegionRef>& regions) const;
+
     /**
      * Visit all admin regions
      */
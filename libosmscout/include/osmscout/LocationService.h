@@ -271,6 +271,7 @@ namespace osmscout {
    *   sub regions.
    * - Visit all addresses of a location (non recursive)
    * - Resolve all parent regions for a given region
+   * - Retrieve all regions containing a given coordinate
    * - General interface for location lookup, offering default visitors for the
    *   individual index traversals.
    * - Retrieve the addresses of one or more objects.
@@ -288,6 +289,9 @@ namespace osmscout {
     bool ResolveAdminRegionHierachie(const AdminRegionRef& adminRegion,
                                      std::map<FileOffset,AdminRegionRef >& refs) const;
 
+    bool ReverseLookupRegion(const GeoCoord& coord,
+                             std::list<AdminRegionRef>& regions) const;
+
     bool VisitAdminRegionLocations(const AdminRegion& region,
                                    const PostalArea& postalArea,
                                    LocationVisitor& visitor) const;
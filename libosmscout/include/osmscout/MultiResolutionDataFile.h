@@ -0,0 +1,515 @@
+#ifndef OSMSCOUT_MULTIRESOLUTIONDATAFILE_H
+#define OSMSCOUT_MULTIRESOLUTIONDATAFILE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <osmscout/DataFile.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/ObjectArena.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   *
+   * Access to the simplified geometry of the objects of a DataFile.
+   *
+   * For a number of magnification levels ("bands") the file holds copies of the
+   * objects of the primary data file with their geometry simplified for display
+   * at the given level. For each band an index maps the offset of every object
+   * in the primary data file to the offset of its simplified copy or to 0, if
+   * simplification did not reduce the object noticeably and the original should
+   * be used.
+   *
+   * File layout:
+   * - FileOffset of the band table
+   * - For each band: the simplified objects, followed by the index. An index entry
+   *   consists of the object offset in the primary data file and the offset of the
+   *   simplified object (both written as fixed size FileOffset). Entries are sorted
+   *   by primary offset, a final sentinel entry holds the end offset of the last
+   *   object.
+   * - The band table: number of bands, and for each band the magnification level,
+   *   the offset of the index and the number of index entries (excluding the
+   *   sentinel).
+   *
+   * The index stays on disk, entries are looked up using binary search.
+   */
+  template <class N>
+  class MultiResolutionDataFile
+  {
+  public:
+    typedef std::shared_ptr<N> ValueType;
+
+  private:
+    static const FileOffset indexEntrySize=2*8;
+
+    struct Band
+    {
+      uint32_t   level;       //!< Magnification level the geometry was simplified for
+      FileOffset indexOffset; //!< Offset of the first index entry
+      uint32_t   entryCount;  //!< Number of index entries (without the sentinel)
+    };
+
+  private:
+    std::string         datafile;     //!< Basename part of the data file name
+    std::string         datafilename; //!< complete filename for data file
+
+    std::vector<Band>   bands;        //!< Available bands, sorted by magnification level
+
+    mutable FileScanner scanner;      //!< File stream to the data file
+    mutable std::mutex  accessMutex;  //!< Mutex to secure multi-thread access
+
+    TypeConfigRef       typeConfig;
+
+  private:
+    const Band* GetBand(const Magnification& magnification) const;
+
+    bool FindIndexEntry(const Band& band,
+                        FileOffset offset,
+                        uint32_t& entry) const;
+
+    void ReadEntries(const Band& band,
+                     uint32_t entry,
+                     uint32_t count,
+                     std::vector<ValueType>& data,
+                     std::vector<FileOffset>& originalOffsets,
+                     const ObjectArenaRef& arena) const;
+
+  public:
+    explicit MultiResolutionDataFile(const std::string& datafile);
+    virtual ~MultiResolutionDataFile();
+
+    bool Open(const TypeConfigRef& typeConfig,
+              const std::string& path,
+              bool memoryMappedData);
+    bool IsOpen() const;
+    bool Close();
+
+    inline std::string GetFilename() const
+    {
+      return datafilename;
+    }
+
+    bool HasBand(const Magnification& magnification) const;
+    bool HasSameBand(const Magnification& a,
+                     const Magnification& b) const;
+
+    template<typename IteratorIn>
+    bool GetByOffset(const DataFile<N>& dataFile,
+                     IteratorIn begin, IteratorIn end, size_t size,
+                     const Magnification& magnification,
+                     std::vector<ValueType>& data,
+                     const ObjectArenaRef& arena=nullptr) const;
+
+    template<typename IteratorIn>
+    bool GetByBlockSpans(const DataFile<N>& dataFile,
+                         IteratorIn begin, IteratorIn end,
+                         const Magnification& magnification,
+                         std::vector<ValueType>& data,
+                         const ObjectArenaRef& arena=nullptr) const;
+  };
+
+  template <class N>
+  MultiResolutionDataFile<N>::MultiResolutionDataFile(const std::string& datafile)
+  : datafile(datafile)
+  {
+    // no code
+  }
+
+  template <class N>
+  MultiResolutionDataFile<N>::~MultiResolutionDataFile()
+  {
+    if (IsOpen()) {
+      Close();
+    }
+  }
+
+  /**
+   * Open the data file and read the band table.
+   *
+   * Method is NOT thread-safe.
+   */
+  template <class N>
+  bool MultiResolutionDataFile<N>::Open(const TypeConfigRef& typeConfig,
+                                        const std::string& path,
+                                        bool memoryMappedData)
+  {
+    this->typeConfig=typeConfig;
+
+    datafilename=AppendFileToDir(path,datafile);
+
+    try {
+      scanner.Open(datafilename,
+                   FileScanner::LowMemRandom,
+                   memoryMappedData);
+
+      FileOffset bandTableOffset;
+      uint32_t   bandCount;
+
+      scanner.ReadFileOffset(bandTableOffset);
+      scanner.SetPos(bandTableOffset);
+      scanner.Read(bandCount);
+
+      bands.resize(bandCount);
+
+      for (auto& band : bands) {
+        scanner.Read(band.level);
+        scanner.ReadFileOffset(band.indexOffset);
+        scanner.Read(band.entryCount);
+      }
+
+      return !scanner.HasError();
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      bands.clear();
+      return false;
+    }
+  }
+
+  /**
+   * Return true, if the file is currently opened.
+   *
+   * Method is NOT thread-safe.
+   */
+  template <class N>
+  bool MultiResolutionDataFile<N>::IsOpen() const
+  {
+    return scanner.IsOpen();
+  }
+
+  /**
+   * Close the file.
+   *
+   * Method is NOT thread-safe.
+   */
+  template <class N>
+  bool MultiResolutionDataFile<N>::Close()
+  {
+    typeConfig=nullptr;
+    bands.clear();
+
+    try  {
+      if (scanner.IsOpen()) {
+        scanner.Close();
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the band with the coarsest geometry that is still detailed enough
+   * for the given magnification or nullptr, if the original geometry must be used.
+   */
+  template <class N>
+  const typename MultiResolutionDataFile<N>::Band* MultiResolutionDataFile<N>::GetBand(const Magnification& magnification) const
+  {
+    for (const auto& band : bands) {
+      if (band.level>=magnification.GetLevel()) {
+        return &band;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * Return true, if there is simplified geometry for the given magnification.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  bool MultiResolutionDataFile<N>::HasBand(const Magnification& magnification) const
+  {
+    return GetBand(magnification)!=nullptr;
+  }
+
+  /**
+   * Return true, if the geometry returned for both magnifications is the same.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  bool MultiResolutionDataFile<N>::HasSameBand(const Magnification& a,
+                                               const Magnification& b) const
+  {
+    return GetBand(a)==GetBand(b);
+  }
+
+  /**
+   * Binary search for the index entry of the given primary file offset.
+   *
+   * Method is NOT thread-safe.
+   *
+   * @throws IOException
+   */
+  template <class N>
+  bool MultiResolutionDataFile<N>::FindIndexEntry(const Band& band,
+                                                  FileOffset offset,
+                                                  uint32_t& entry) const
+  {
+    uint32_t left=entry;
+    uint32_t right=band.entryCount;
+
+    while (left<right) {
+      uint32_t   middle=left+(right-left)/2;
+      FileOffset middleOffset;
+
+      scanner.SetPos(band.indexOffset+middle*indexEntrySize);
+      scanner.ReadFileOffset(middleOffset);
+
+      if (middleOffset==offset) {
+        entry=middle;
+        return true;
+      }
+
+      if (middleOffset<offset) {
+        left=middle+1;
+      }
+      else {
+        right=middle;
+      }
+    }
+
+    entry=left;
+
+    return false;
+  }
+
+  /**
+   * Read count consecutive entries starting with the given index entry. Simplified
+   * objects are appended to data, the offsets of objects that have to be loaded from
+   * the primary data file are appended to originalOffsets.
+   *
+   * Method is NOT thread-safe.
+   *
+   * @throws IOException
+   */
+  template <class N>
+  void MultiResolutionDataFile<N>::ReadEntries(const Band& band,
+                                               uint32_t entry,
+                                               uint32_t count,
+                                               std::vector<ValueType>& data,
+                                               std::vector<FileOffset>& originalOffsets,
+                                               const ObjectArenaRef& arena) const
+  {
+    FileOffset       offset;
+    FileOffset       dataOffset;
+    ObjectArenaScope arenaScope(arena.get());
+
+    scanner.SetPos(band.indexOffset+entry*indexEntrySize);
+    scanner.ReadFileOffset(offset);
+    scanner.ReadFileOffset(dataOffset);
+
+    for (uint32_t i=0; i<count; i++) {
+      FileOffset nextOffset;
+      FileOffset nextDataOffset;
+
+      // There is always a following entry, the last one is the sentinel
+      scanner.ReadFileOffset(nextOffset);
+      scanner.ReadFileOffset(nextDataOffset);
+
+      if (dataOffset==0) {
+        originalOffsets.push_back(offset);
+      }
+      else {
+        FileOffset indexPos=scanner.GetPos();
+        ValueType  value=MakeShared<N>(arena);
+
+        scanner.SetPos(dataOffset);
+        value->Read(*typeConfig,
+                    scanner);
+        value->SetFileOffsets(offset,
+                              nextOffset);
+
+        data.push_back(value);
+
+        scanner.SetPos(indexPos);
+      }
+
+      offset=nextOffset;
+      dataOffset=nextDataOffset;
+    }
+  }
+
+  /**
+   * Read data values for the given file offsets (in the primary data file) with
+   * the geometry simplified for the given magnification. Objects without simplified
+   * geometry are loaded from the passed primary data file.
+   *
+   * File offsets should be sorted, to allow sequential access and to limit the range
+   * of the index lookup.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  template<typename IteratorIn>
+  bool MultiResolutionDataFile<N>::GetByOffset(const DataFile<N>& dataFile,
+                                               IteratorIn begin, IteratorIn end, size_t size,
+                                               const Magnification& magnification,
+                                               std::vector<ValueType>& data,
+                                               const ObjectArenaRef& arena) const
+  {
+    const Band* band=GetBand(magnification);
+
+    if (band==nullptr) {
+      return dataFile.GetByOffset(begin,end,size,data,arena);
+    }
+
+    std::vector<FileOffset> originalOffsets;
+
+    data.reserve(data.size()+size);
+
+    try {
+      std::lock_guard<std::mutex> lock(accessMutex);
+      uint32_t                    entry=0;
+      FileOffset                  lastOffset=0;
+
+      for (IteratorIn offsetIter=begin; offsetIter!=end; ++offsetIter) {
+        if (*offsetIter<lastOffset) {
+          // Unsorted input, restart the search at the beginning of the index
+          entry=0;
+        }
+
+        lastOffset=*offsetIter;
+
+        if (!FindIndexEntry(*band,*offsetIter,entry)) {
+          log.Warn() << "Offset " << *offsetIter << " not found in " << datafilename << ", file is not in sync with the data file";
+          originalOffsets.push_back(*offsetIter);
+          entry=0;
+          continue;
+        }
+
+        ReadEntries(*band,
+                    entry,
+                    1,
+                    data,
+                    originalOffsets,
+                    arena);
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return dataFile.GetByOffset(originalOffsets.begin(),
+                                originalOffsets.end(),
+                                originalOffsets.size(),
+                                data,
+                                arena);
+  }
+
+  /**
+   * Read data values for the given DataBlockSpans (of the primary data file) with
+   * the geometry simplified for the given magnification. Objects without simplified
+   * geometry are loaded from the passed primary data file.
+   *
+   * Method is thread-safe.
+   */
+  template <class N>
+  template<typename IteratorIn>
+  bool MultiResolutionDataFile<N>::GetByBlockSpans(const DataFile<N>& dataFile,
+                                                   IteratorIn begin, IteratorIn end,
+                                                   const Magnification& magnification,
+                                                   std::vector<ValueType>& data,
+                                                   const ObjectArenaRef& arena) const
+  {
+    const Band* band=GetBand(magnification);
+
+    if (band==nullptr) {
+      return dataFile.GetByBlockSpans(begin,end,data,arena);
+    }
+
+    std::vector<DataBlockSpan> originalSpans;
+    std::vector<FileOffset>    originalOffsets;
+    uint32_t                   overallCount=0;
+
+    for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
+      overallCount+=spanIter->count;
+    }
+
+    data.reserve(data.size()+overallCount);
+
+    try {
+      std::lock_guard<std::mutex> lock(accessMutex);
+
+      for (IteratorIn spanIter=begin; spanIter!=end; ++spanIter) {
+        if (spanIter->count==0) {
+          continue;
+        }
+
+        uint32_t entry=0;
+
+        if (!FindIndexEntry(*band,spanIter->startOffset,entry) ||
+            entry+spanIter->count>band->entryCount) {
+          log.Warn() << "Offset " << spanIter->startOffset << " not found in " << datafilename << ", file is not in sync with the data file";
+          originalSpans.push_back(*spanIter);
+          continue;
+        }
+
+        // Objects of a span are stored consecutively, so are their index entries
+        ReadEntries(*band,
+                    entry,
+                    spanIter->count,
+                    data,
+                    originalOffsets,
+                    arena);
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    if (!originalSpans.empty() &&
+        !dataFile.GetByBlockSpans(originalSpans.begin(),
+                                  originalSpans.end(),
+                                  data,
+                                  arena)) {
+      return false;
+    }
+
+    return dataFile.GetByOffset(originalOffsets.begin(),
+                                originalOffsets.end(),
+                                originalOffsets.size(),
+                                data,
+                                arena);
+  }
+}
+
+#endif
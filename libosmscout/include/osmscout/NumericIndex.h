@@ -256,6 +256,7 @@ namespace osmscout {
         currentCacheSize=0;
 
         pageCaches.push_back(PageCache(resultingCacheSize));
+        pageCaches.back().SetMetrics(filepart);
       }
       else {
         resultingCacheSize=pageCounts[level];
@@ -0,0 +1,103 @@
+#ifndef OSMSCOUT_REGIONRASTERINDEX_H
+#define OSMSCOUT_REGIONRASTERINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/Pixel.h>
+
+#include <osmscout/util/FileScanner.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup Database
+
+    RegionRasterIndex divides the database into a grid of cells and holds
+    for each cell the admin regions of the location index touching the cell.
+    Regions that cover the cell completely are returned without further
+    checks, only for cells crossed by the boundary of a region an exact
+    polygon test against the area of the region is required.
+
+    Rows of the grid are run length encoded, identical lists of regions
+    are only stored once. The index is completely held in memory.
+    */
+  class OSMSCOUT_API RegionRasterIndex
+  {
+  public:
+    static const char* const REGIONRASTER_IDX;
+
+    /**
+     * Region touching a cell
+     */
+    struct Entry
+    {
+      FileOffset regionOffset; //!< Offset of the AdminRegion in the location index
+      bool       boundary;     //!< The cell is crossed by the boundary of the region
+    };
+
+  private:
+    struct Run
+    {
+      uint32_t startX; //!< First cell of the run, relative to minCell.x
+      uint32_t list;   //!< Index of the list of regions of the cells of the run
+    };
+
+  private:
+    uint32_t              cellLevel;
+    double                cellWidth;
+    double                cellHeight;
+    Pixel                 minCell;
+    Pixel                 maxCell;
+    std::vector<uint32_t> listOffsets; //!< Start of each list in entries, with additional end marker
+    std::vector<Entry>    entries;
+    std::vector<uint32_t> rowOffsets;  //!< Start of each row in runs, with additional end marker
+    std::vector<Run>      runs;
+
+  public:
+    RegionRasterIndex() = default;
+
+    bool Open(const std::string& path);
+
+    inline uint32_t GetCellLevel() const
+    {
+      return cellLevel;
+    }
+
+    Pixel GetCell(const GeoCoord& coord) const;
+
+    /**
+     * Returns the regions touching the cell of the given coordinate, sorted by their
+     * offset (parents before their children). Regions with the boundary flag set
+     * only contain the coordinate, if the coordinate is within their area.
+     */
+    void GetCandidates(const GeoCoord& coord,
+                       std::vector<Entry>& candidates) const;
+  };
+
+  typedef std::shared_ptr<RegionRasterIndex> RegionRasterIndexRef;
+}
+
+#endif
@@ -36,6 +36,7 @@
 
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/FileWriter.h>
+#include <osmscout/util/ObjectArena.h>
 #include <osmscout/util/TagErrorReporter.h>
 
 #include <osmscout/system/Assert.h>
@@ -662,6 +663,7 @@ namespace osmscout {
     TypeInfoRef type;
     uint8_t     *featureBits;
     char        *featureValueBuffer;
+    ObjectArena *arena;              //!< Arena holding featureBits and featureValueBuffer, or nullptr for the heap
 
   private:
     void DeleteData();
@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <array>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -36,12 +37,24 @@ namespace osmscout {
 
   /**
    * \ingroup Database
+   *
+   * Index of ground tiles (land, water, coast) for drawing the map background.
+   *
+   * By default cell states and coast data are read from the file for every request.
+   * Optionally Open() decodes all levels into a compact in-memory quadtree per level,
+   * where uniform land, water or unknown regions are collapsed into one node. Requests
+   * are then pure in-memory operations without locking and the file is closed.
    */
   class OSMSCOUT_API WaterIndex final
   {
   public:
     static const char* const WATER_IDX;
 
+  private:
+    static const uint32_t TREE_LEAF       = 0x80000000; //!< Node value is a leaf, else index of first child in treeNodes
+    static const uint32_t TREE_COAST_DATA = 0x40000000; //!< Leaf references a coast cell, else it holds the GroundTile::Type
+    static const uint32_t TREE_VALUE_MASK = 0x3fffffff;
+
   private:
     struct Level
     {
@@ -63,6 +76,14 @@ namespace osmscout {
       uint32_t                   cellXEnd;         //!< Last x-axis coordinate cells
       uint32_t                   cellYStart;       //!< First y-axis coordinate of cells
       uint32_t                   cellYEnd;         //!< Last x-axis coordinate cells
+
+      // In memory quadtree, only filled if loaded into memory and hasCellData is true
+
+      uint32_t                   treeRoot=0;       //!< Value of the root node
+      uint32_t                   treeSize=0;       //!< Number of cells in each direction covered by the root node (power of two)
+      std::vector<uint32_t>      treeNodes;        //!< Child values of inner nodes, four consecutive entries per inner node
+      std::vector<uint32_t>      coastCellStart;   //!< Index of the first tile of each coast cell in coastTiles, plus end marker
+      std::vector<GroundTile>    coastTiles;       //!< Tiles (type and coords) of all coast cells
     };
 
   private:
@@ -75,6 +96,26 @@ namespace osmscout {
 
     mutable std::mutex         lookupMutex;
 
+    bool                       inMemory=false;  //!< All levels are decoded into the in-memory quadtrees
+
+  private:
+    template<typename C>
+    void ReadCellTiles(const Level& level,
+                       FileOffset cell,
+                       GroundTile& tile,
+                       C& tiles) const;
+
+    void LoadLevelIntoMemory(Level& level);
+    void AddTreeRow(Level& level,
+                    std::vector<std::vector<uint32_t>>& pendingRows,
+                    size_t depth,
+                    std::vector<uint32_t>&& row);
+    uint32_t AddTreeNode(Level& level,
+                         const std::array<uint32_t,4>& children);
+    uint32_t LookupCell(const Level& level,
+                        uint32_t x,
+                        uint32_t y) const;
+
   private:
     void GetGroundTileByDefault(const Level& level,
                                 uint32_t cx1,
@@ -88,14 +129,29 @@ namespace osmscout {
                                uint32_t cy1,
                                uint32_t cy2,
                                std::list<GroundTile>& tiles) const;
+    void GetGroundTileFromMemory(const Level& level,
+                                 uint32_t cx1,
+                                 uint32_t cx2,
+                                 uint32_t cy1,
+                                 uint32_t cy2,
+                                 std::list<GroundTile>& tiles) const;
 
   public:
     WaterIndex() = default;
     virtual ~WaterIndex();
 
-    bool Open(const std::string& path, bool memoryMappedData);
+    bool Open(const std::string& path,
+              bool memoryMappedData,
+              bool loadIntoMemory=false);
     void Close();
 
+    inline bool IsInMemory() const
+    {
+      return inMemory;
+    }
+
+    size_t GetMemoryUsage() const;
+
     bool GetRegions(const GeoBox& boundingBox,
                     const Magnification& magnification,
                     std::list<GroundTile>& tiles) const;
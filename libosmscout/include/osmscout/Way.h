@@ -74,6 +74,18 @@ namespace osmscout {
       return nextFileOffset;
     }
 
+    /**
+     * Overwrite the file offsets of the way. Used if the way was loaded from
+     * an alternative representation (like a simplified version of its geometry)
+     * but should keep the identity of the object in the data file.
+     */
+    inline void SetFileOffsets(FileOffset fileOffset,
+                               FileOffset nextFileOffset)
+    {
+      this->fileOffset=fileOffset;
+      this->nextFileOffset=nextFileOffset;
+    }
+
     inline ObjectFileRef GetObjectFileRef() const
     {
       return {fileOffset,refWay};
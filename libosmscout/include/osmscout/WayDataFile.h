@@ -23,6 +23,7 @@
 #include <memory>
 
 #include <osmscout/DataFile.h>
+#include <osmscout/MultiResolutionDataFile.h>
 #include <osmscout/Way.h>
 
 namespace osmscout {
@@ -41,6 +42,22 @@ namespace osmscout {
   };
 
   typedef std::shared_ptr<WayDataFile> WayDataFileRef;
+
+  /**
+    \ingroup Database
+    Abstraction for access to the 'waysres.dat' file, holding the ways
+    with geometry simplified for different magnifications.
+    */
+  class OSMSCOUT_API WayResolutionDataFile : public MultiResolutionDataFile<Way>
+  {
+  public:
+    static const char* const WAYS_RES_DAT;
+
+  public:
+    WayResolutionDataFile();
+  };
+
+  typedef std::shared_ptr<WayResolutionDataFile> WayResolutionDataFileRef;
 }
 
 #endif
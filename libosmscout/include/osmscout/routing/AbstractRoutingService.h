@@ -24,6 +24,7 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -36,9 +37,12 @@
 #include <osmscout/routing/Route.h>
 #include <osmscout/routing/RouteData.h>
 #include <osmscout/routing/RouteNode.h>
+#include <osmscout/routing/RoutingGraph.h>
 #include <osmscout/routing/RoutingService.h>
 #include <osmscout/routing/MultiDBRoutingState.h>
 
+#include <osmscout/util/Metrics.h>
+
 namespace osmscout {
 
   /**
@@ -175,7 +179,12 @@ namespace osmscout {
   class OSMSCOUT_API AbstractRoutingService: public RoutingService
   {
   protected:
-    bool debugPerformance;
+    bool                    debugPerformance;
+    bool                    useObjectArena;        //!< Allocate temporary objects from a request local arena
+    std::mutex              graphSearchIndexMutex; //!< Guards graphSearchIndex
+    RoutingGraphSearchIndex graphSearchIndex;      //!< Search index reused by WalkRoutingGraph()
+    MetricCounter&          nodeExpansionCounter;  //!< Number of route nodes taken from the open list
+    MetricHistogram&        calculationTime;       //!< Duration of the route search
 
   protected:
     virtual Vehicle GetVehicle(const RoutingState& state) = 0;
@@ -185,6 +194,11 @@ namespace osmscout {
                         const RouteNode& routeNode,
                         size_t pathIndex) = 0;
 
+    virtual bool CanUse(const RoutingState& state,
+                        DatabaseId database,
+                        const RoutingGraph& graph,
+                        uint32_t pathIndex) = 0;
+
     virtual bool CanUseForward(const RoutingState& state,
                                const DatabaseId& database,
                                const WayRef& way) = 0;
@@ -199,6 +213,12 @@ namespace osmscout {
                             size_t inPathIndex,
                             size_t outPathIndex) = 0;
 
+    virtual double GetCosts(const RoutingState& state,
+                            DatabaseId database,
+                            const RoutingGraph& graph,
+                            uint32_t inPathIndex,
+                            uint32_t outPathIndex) = 0;
+
     virtual double GetCosts(const RoutingState& state,
                             DatabaseId database,
                             const WayRef &way,
@@ -227,6 +247,15 @@ namespace osmscout {
     virtual bool GetRouteNode(const DBId &id,
                               RouteNodeRef &node) = 0;
 
+    /**
+     * Return the in-memory routing graph of the given database
+     * @param database
+     *    Id of the database
+     * @return
+     *    The routing graph or nullptr, if routing should use the route node data file
+     */
+    virtual const RoutingGraph* GetRoutingGraph(DatabaseId database) const = 0;
+
     virtual bool GetWayByOffset(const DBFileOffset &offset,
                                 WayRef &way) = 0;
 
@@ -350,6 +379,21 @@ namespace osmscout {
                            Distance &currentMaxDistance,
                            const Distance &overallDistance,
                            const double &costLimit);
+
+    bool WalkRoutingGraph(const RoutingState& state,
+                          const RoutingGraph& graph,
+                          DatabaseId database,
+                          const RNodeRef& startForwardNode,
+                          const RNodeRef& startBackwardNode,
+                          const RouteNodeRef& targetForwardRouteNode,
+                          const RouteNodeRef& targetBackwardRouteNode,
+                          RoutingResult &result,
+                          const RoutingParameter& parameter,
+                          const GeoCoord &targetCoord,
+                          const Vehicle &vehicle,
+                          const Distance &overallDistance,
+                          const double &costLimit,
+                          std::list<VNode>& nodes);
   public:
     explicit AbstractRoutingService(const RouterParameter& parameter);
     ~AbstractRoutingService() override;
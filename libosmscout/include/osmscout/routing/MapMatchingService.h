@@ -0,0 +1,227 @@
+#ifndef OSMSCOUT_MAPMATCHINGSERVICE_H
+#define OSMSCOUT_MAPMATCHINGSERVICE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/Database.h>
+
+#include <osmscout/routing/RouteData.h>
+#include <osmscout/routing/RoutingDB.h>
+#include <osmscout/routing/RoutingProfile.h>
+#include <osmscout/routing/RoutingService.h>
+
+#include <osmscout/util/Breaker.h>
+#include <osmscout/util/Cache.h>
+#include <osmscout/util/Distance.h>
+#include <osmscout/util/TileId.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Routing
+   * Parameters of the hidden markov model used by the MapMatchingService.
+   */
+  class OSMSCOUT_API MapMatchingParameter CLASS_FINAL
+  {
+  private:
+    Distance searchRadius;        //!< Maximum distance between an observation and a matched way
+    Distance measurementSigma;    //!< Standard deviation of the position measurement error
+    Distance transitionBeta;      //!< Expected difference between route distance and direct distance of two observations
+    double   routeDistanceFactor; //!< Routes longer than the direct distance times this factor are not considered
+    size_t   maxCandidates;       //!< Maximum number of candidate ways per observation
+    size_t   tileCacheSize;       //!< Number of tiles with candidate ways held in memory
+    size_t   threadCount;         //!< Number of threads for batch matching, 0 for one thread per core
+
+  public:
+    MapMatchingParameter();
+
+    void SetSearchRadius(const Distance& searchRadius);
+    void SetMeasurementSigma(const Distance& measurementSigma);
+    void SetTransitionBeta(const Distance& transitionBeta);
+    void SetRouteDistanceFactor(double routeDistanceFactor);
+    void SetMaxCandidates(size_t maxCandidates);
+    void SetTileCacheSize(size_t tileCacheSize);
+    void SetThreadCount(size_t threadCount);
+
+    inline Distance GetSearchRadius() const
+    {
+      return searchRadius;
+    }
+
+    inline Distance GetMeasurementSigma() const
+    {
+      return measurementSigma;
+    }
+
+    inline Distance GetTransitionBeta() const
+    {
+      return transitionBeta;
+    }
+
+    inline double GetRouteDistanceFactor() const
+    {
+      return routeDistanceFactor;
+    }
+
+    inline size_t GetMaxCandidates() const
+    {
+      return maxCandidates;
+    }
+
+    inline size_t GetTileCacheSize() const
+    {
+      return tileCacheSize;
+    }
+
+    inline size_t GetThreadCount() const
+    {
+      return threadCount;
+    }
+  };
+
+  /**
+   * \ingroup Routing
+   * Result of map matching for one observation of the trace.
+   */
+  struct OSMSCOUT_API MatchedPoint
+  {
+    bool          matched=false; //!< The observation was matched to a way
+    RoutePosition position;      //!< Way and node index of the way closest to the matched location
+    GeoCoord      location;      //!< The observation projected onto the matched way
+    Distance      distance;      //!< Distance between the observation and the matched location
+    size_t        routeIndex=0;  //!< Index of the route in MapMatchingResult::routes passing the matched location
+  };
+
+  /**
+   * \ingroup Routing
+   * Result of map matching a trace. The matched route is split into several
+   * routes if there is no route between consecutive observations (gaps in
+   * the trace, missing data,...).
+   */
+  class OSMSCOUT_API MapMatchingResult CLASS_FINAL
+  {
+  public:
+    std::vector<MatchedPoint> points; //!< One entry for each observation of the trace
+    std::vector<RouteData>    routes; //!< Continuous parts of the matched route
+
+  public:
+    size_t GetMatchedPointCount() const;
+  };
+
+  /**
+   * \ingroup Service
+   * \ingroup Routing
+   * Matches traces of positions (GPS tracks) to the routable ways of the database.
+   *
+   * The matching uses a hidden markov model: candidates of an observation are
+   * the projections onto the closest routable ways, rated by their distance to
+   * the observation. Transitions between candidates of consecutive observations
+   * are rated by the difference between the distance on the routing graph
+   * (router.dat) and the direct distance. The most probable sequence of
+   * candidates is calculated using the Viterbi algorithm.
+   *
+   * Candidate ways are loaded per tile and cached, the cache is shared by all
+   * threads. Match is thread safe, batches of traces are matched in parallel.
+   */
+  class OSMSCOUT_API MapMatchingService CLASS_FINAL
+  {
+  private:
+    /**
+     * A routable way together with data precalculated for matching
+     */
+    struct WayInfo
+    {
+      WayRef              way;
+      GeoBox              boundingBox;
+      std::vector<double> offsets;    //!< Distance in meter of each node from the start of the way
+      std::vector<size_t> routeNodes; //!< Sorted indexes of the nodes that are route nodes
+    };
+
+    typedef std::shared_ptr<const std::vector<WayInfo>> TileWaysRef;
+    typedef Cache<uint64_t,TileWaysRef,uint64_t>         TileWaysCache;
+
+    class Matcher;
+
+  private:
+    DatabaseRef          database;         //!< Database object, holding all index and data files
+    MapMatchingParameter parameter;
+    bool                 isOpen;           //!< true, if opened
+
+    RoutingDatabase      routingDatabase;  //!< Access to routing data and index files
+    TypeInfoSet          routableTypes;    //!< Way types routable by any vehicle
+
+    std::mutex           tileCacheMutex;
+    TileWaysCache        tileCache;        //!< Candidate ways for each tile
+
+  private:
+    TileWaysRef GetTileWays(const TileId& tile);
+
+  public:
+    explicit MapMatchingService(const DatabaseRef& database,
+                                const MapMatchingParameter& parameter=MapMatchingParameter());
+    ~MapMatchingService();
+
+    bool Open();
+    bool IsOpen() const;
+    void Close();
+
+    /**
+     * Match the given trace to the ways routable by the given profile.
+     *
+     * @param profile
+     *    Routing profile defining the usable ways and their directions
+     * @param trace
+     *    Observed positions in chronological order
+     * @param breaker
+     *    Optional breaker, an aborted match returns unmatched points only
+     * @return
+     *    Matched point for each observation and the matched routes
+     */
+    MapMatchingResult Match(const RoutingProfile& profile,
+                            const std::vector<GeoCoord>& trace,
+                            const BreakerRef& breaker=nullptr);
+
+    /**
+     * Match a batch of traces in parallel, using the number of threads given
+     * by MapMatchingParameter::GetThreadCount.
+     */
+    std::vector<MapMatchingResult> Match(const RoutingProfile& profile,
+                                         const std::vector<std::vector<GeoCoord>>& traces,
+                                         const BreakerRef& breaker=nullptr);
+  };
+
+  //! \ingroup Service
+  //! Reference counted reference to a MapMatchingService instance
+  typedef std::shared_ptr<MapMatchingService> MapMatchingServiceRef;
+}
+
+#endif
@@ -71,6 +71,12 @@ namespace osmscout {
                     size_t inPathIndex,
                     size_t outPathIndex) override;
 
+    double GetCosts(const MultiDBRoutingState& state,
+                    DatabaseId databaseId,
+                    const RoutingGraph& graph,
+                    uint32_t inPathIndex,
+                    uint32_t outPathIndex) override;
+
     double GetCosts(const MultiDBRoutingState& state,
                     DatabaseId database,
                     const WayRef &way,
@@ -90,6 +96,8 @@ namespace osmscout {
     bool GetRouteNode(const DBId &id,
                       RouteNodeRef &node) override;
 
+    const RoutingGraph* GetRoutingGraph(DatabaseId database) const override;
+
     bool GetWayByOffset(const DBFileOffset &offset,
                         WayRef &way) override;
 
@@ -113,6 +121,11 @@ namespace osmscout {
                 const RouteNode& routeNode,
                 size_t pathIndex) override;
 
+    bool CanUse(const MultiDBRoutingState& state,
+                DatabaseId databaseId,
+                const RoutingGraph& graph,
+                uint32_t pathIndex) override;
+
   public:
     MultiDBRoutingService(const RouterParameter& parameter,
                           const std::vector<DatabaseRef> &databases);
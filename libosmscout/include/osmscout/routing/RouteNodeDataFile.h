@@ -93,6 +93,8 @@ namespace osmscout {
     bool Get(Id id,
              RouteNodeRef& node) const;
 
+    bool GetAll(std::vector<RouteNode>& nodes) const;
+
     template<typename IteratorIn>
     bool Get(IteratorIn begin, IteratorIn end, size_t size,
              std::vector<RouteNodeRef>& data) const
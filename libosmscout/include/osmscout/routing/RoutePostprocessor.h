@@ -24,6 +24,7 @@
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <osmscout/CoreFeatures.h>
 
@@ -282,23 +283,11 @@ namespace osmscout {
       };
 
     private:
-      std::set<ObjectFileRef> CollectPaths(const std::list<RouteDescription::Node>& nodes) const;
-      std::list<WayRef> CollectWays(const RoutePostprocessor& postprocessor,
-                                    const std::list<RouteDescription::Node>& nodes) const;
-      std::list<AreaRef> CollectAreas(const RoutePostprocessor& postprocessor,
-                                      const std::list<RouteDescription::Node>& nodes) const;
-      std::map<ObjectFileRef,std::set<ObjectFileRef>> CollectPOICandidates(const Database& database,
-                                                                           const std::set<ObjectFileRef>& paths,
-                                                                           const std::list<WayRef>& ways,
-                                                                           const std::list<AreaRef>& areas);
-      std::map<ObjectFileRef,POIAtRoute> AnalysePOICandidates(const RoutePostprocessor& postprocessor,
-                                                              const DatabaseId& databaseId,
-                                                              std::list<RouteDescription::Node>& nodes,
-                                                              const TypeInfoSet& nodeTypes,
-                                                              const TypeInfoSet& areaTypes,
-                                                              const std::unordered_map<FileOffset,NodeRef>& nodeMap,
-                                                              const std::unordered_map<FileOffset,AreaRef>& areaMap,
-                                                              const std::map<ObjectFileRef,std::set<ObjectFileRef>>& poiCandidates);
+      std::map<ObjectFileRef,POIAtRoute> CollectPOIsAtRoute(const RoutePostprocessor& postprocessor,
+                                                            const DatabaseId& databaseId,
+                                                            std::list<RouteDescription::Node>& nodes,
+                                                            const TypeInfoSet& nodeTypes,
+                                                            const TypeInfoSet& areaTypes) const;
       void SortInCollectedPOIs(const DatabaseId& databaseId,
                                const std::map<ObjectFileRef,POIAtRoute>& pois);
 
@@ -352,10 +341,17 @@ namespace osmscout {
     RouteDescription::NameDescriptionRef GetNameDescription(DatabaseId dbId,
                                                             const Way& way) const;
 
-    bool LoadJunction(DatabaseId database,
-                      GeoCoord coord,
-                      std::string junctionRef,
-                      std::string junctionName) const;
+    static std::vector<GeoBox> GetCorridorTiles(const std::vector<GeoBox>& boxes);
+
+    bool LoadCorridorNodes(DatabaseId dbId,
+                           const std::vector<GeoBox>& corridor,
+                           const TypeInfoSet& types,
+                           std::vector<NodeRef>& nodes) const;
+
+    bool LoadCorridorAreas(DatabaseId dbId,
+                           const std::vector<GeoBox>& corridor,
+                           const TypeInfoSet& types,
+                           std::vector<AreaRef>& areas) const;
 
     bool IsMotorwayLink(const RouteDescription::Node& node) const;
     bool IsMotorway(const RouteDescription::Node& node) const;
@@ -29,6 +29,7 @@
 
 #include <osmscout/routing/RouteNode.h>
 #include <osmscout/routing/RouteNodeDataFile.h>
+#include <osmscout/routing/RoutingGraph.h>
 
 namespace osmscout {
 
@@ -45,6 +46,10 @@ namespace osmscout {
     RouteNodeDataFile                routeNodeDataFile;
     IndexedDataFile<Id,Intersection> junctionDataFile;      //!< Cached access to the 'junctions.dat' file
     ObjectVariantDataFile            objectVariantDataFile;
+    RoutingGraph                     routingGraph;          //!< Complete routing graph, if loaded into memory
+
+  private:
+    bool LoadRoutingGraph();
 
   public:
     RoutingDatabase();
@@ -87,6 +92,15 @@ namespace osmscout {
       return objectVariantDataFile.GetData();
     }
 
+    /**
+     * Return the in-memory routing graph or nullptr, if the routing
+     * data has not been loaded into memory
+     */
+    inline const RoutingGraph* GetRoutingGraph() const
+    {
+      return routingGraph.IsEmpty() ? nullptr : &routingGraph;
+    }
+
     inline bool ContainsNode(const Id id) const
     {
       RouteNodeRef node;
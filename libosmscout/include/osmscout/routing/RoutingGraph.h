@@ -0,0 +1,247 @@
+#ifndef OSMSCOUT_ROUTINGGRAPH_H
+#define OSMSCOUT_ROUTINGGRAPH_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+
+#include <osmscout/routing/RouteNode.h>
+
+#include <osmscout/util/Distance.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Routing
+   *
+   * The complete routing graph of a database in compressed sparse row (CSR)
+   * layout. Route nodes are sorted by id and referenced by their index in the
+   * sorted list. Paths, objects and excludes of all route nodes are stored in
+   * flat arrays, for each route node the range of its entries is given by
+   * the start of its own and the start of the following route node.
+   *
+   * Path targets are resolved to node indexes while building the graph, so
+   * walking the graph does neither require file access nor any lookup.
+   *
+   * The graph is immutable after building and thus can be used from multiple
+   * threads without locking.
+   */
+  class OSMSCOUT_API RoutingGraph CLASS_FINAL
+  {
+  public:
+    static const uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+  private:
+    std::vector<Id>            nodeIds;              //!< Id of the route node, sorted ascending
+    std::vector<GeoCoord>      nodeCoords;           //!< Coordinate of the route node
+    std::vector<uint32_t>      pathStart;            //!< Index of the first path of the route node
+    std::vector<uint32_t>      objectStart;          //!< Index of the first object of the route node
+    std::vector<uint32_t>      excludeStart;         //!< Index of the first exclude of the route node
+
+    std::vector<uint32_t>      pathTargets;          //!< Index of the target route node
+    std::vector<Distance>      pathDistances;        //!< Distance to the target route node
+    std::vector<uint32_t>      pathObjects;          //!< Index of the object used by the path
+    std::vector<uint8_t>       pathFlags;            //!< RouteNode flags of the path
+
+    std::vector<ObjectFileRef> objects;              //!< Objects crossing the route nodes
+    std::vector<uint16_t>      objectVariantIndexes; //!< Index into the object variant data of the object
+
+    std::vector<ObjectFileRef> excludeSources;       //!< Source object of the exclude
+    std::vector<uint32_t>      excludeTargets;       //!< Index of the object that cannot be used coming from the source
+
+  public:
+    void Build(std::vector<RouteNode>& routeNodes);
+    void Clear();
+
+    inline bool IsEmpty() const
+    {
+      return nodeIds.empty();
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      return nodeIds.size();
+    }
+
+    inline size_t GetPathCount() const
+    {
+      return pathTargets.size();
+    }
+
+    uint32_t FindNode(Id id) const;
+
+    inline Id GetNodeId(uint32_t node) const
+    {
+      return nodeIds[node];
+    }
+
+    inline const GeoCoord& GetNodeCoord(uint32_t node) const
+    {
+      return nodeCoords[node];
+    }
+
+    inline uint32_t GetPathBegin(uint32_t node) const
+    {
+      return pathStart[node];
+    }
+
+    inline uint32_t GetPathEnd(uint32_t node) const
+    {
+      return pathStart[node+1];
+    }
+
+    inline uint32_t GetObjectBegin(uint32_t node) const
+    {
+      return objectStart[node];
+    }
+
+    inline uint32_t GetObjectEnd(uint32_t node) const
+    {
+      return objectStart[node+1];
+    }
+
+    inline const ObjectFileRef& GetObject(uint32_t object) const
+    {
+      return objects[object];
+    }
+
+    inline uint16_t GetObjectVariantIndex(uint32_t object) const
+    {
+      return objectVariantIndexes[object];
+    }
+
+    inline uint32_t GetExcludeBegin(uint32_t node) const
+    {
+      return excludeStart[node];
+    }
+
+    inline uint32_t GetExcludeEnd(uint32_t node) const
+    {
+      return excludeStart[node+1];
+    }
+
+    inline uint32_t GetPathTarget(uint32_t path) const
+    {
+      return pathTargets[path];
+    }
+
+    inline const Distance& GetPathDistance(uint32_t path) const
+    {
+      return pathDistances[path];
+    }
+
+    inline uint8_t GetPathFlags(uint32_t path) const
+    {
+      return pathFlags[path];
+    }
+
+    inline uint32_t GetPathObjectIndex(uint32_t path) const
+    {
+      return pathObjects[path];
+    }
+
+    inline const ObjectFileRef& GetPathObject(uint32_t path) const
+    {
+      return objects[pathObjects[path]];
+    }
+
+    inline bool IsPathRestricted(uint32_t path,
+                                 Vehicle vehicle) const
+    {
+      switch (vehicle) {
+      case vehicleFoot:
+        return (pathFlags[path] & RouteNode::restrictedForFoot) != 0;
+      case vehicleBicycle:
+        return (pathFlags[path] & RouteNode::restrictedForBicycle) != 0;
+      case vehicleCar:
+        return (pathFlags[path] & RouteNode::restrictedForCar) != 0;
+      }
+
+      return false;
+    }
+
+    inline const ObjectFileRef& GetExcludeSource(uint32_t exclude) const
+    {
+      return excludeSources[exclude];
+    }
+
+    inline const ObjectFileRef& GetExcludeTarget(uint32_t exclude) const
+    {
+      return objects[excludeTargets[exclude]];
+    }
+
+    size_t GetMemoryUsage() const;
+  };
+
+  /**
+   * \ingroup Routing
+   *
+   * Maps node indexes of a RoutingGraph to the index of their search state
+   * during a route calculation.
+   *
+   * The index is kept over route calculations, so it is only allocated once.
+   * Each calculation starts a new generation and entries of older generations
+   * count as unset, so starting a new search does not touch all nodes.
+   *
+   * An index must only be used by one search at a time.
+   */
+  class OSMSCOUT_API RoutingGraphSearchIndex CLASS_FINAL
+  {
+  private:
+    struct Entry
+    {
+      uint32_t generation; //!< Generation the entry was set in
+      uint32_t index;      //!< Index of the search state
+    };
+
+  private:
+    std::vector<Entry> entries;
+    uint32_t           generation=0;
+
+  public:
+    void Reset(size_t nodeCount);
+
+    /**
+     * Return the index of the search state of the given node or InvalidIndex,
+     * if the node was not yet visited by the current search
+     */
+    inline uint32_t Get(uint32_t node) const
+    {
+      const Entry& entry=entries[node];
+
+      return entry.generation==generation ? entry.index : RoutingGraph::InvalidIndex;
+    }
+
+    inline void Set(uint32_t node,
+                    uint32_t index)
+    {
+      entries[node]=Entry{generation,index};
+    }
+  };
+}
+
+#endif
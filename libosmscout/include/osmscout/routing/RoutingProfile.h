@@ -36,6 +36,7 @@
 #include <osmscout/util/Logger.h>
 
 #include <osmscout/routing/RouteNode.h>
+#include <osmscout/routing/RoutingGraph.h>
 
 namespace osmscout {
 
@@ -57,6 +58,9 @@ namespace osmscout {
     virtual bool CanUse(const RouteNode& currentNode,
                         const std::vector<ObjectVariantData>& objectVariantData,
                         size_t pathIndex) const = 0;
+    virtual bool CanUse(const RoutingGraph& graph,
+                        const std::vector<ObjectVariantData>& objectVariantData,
+                        uint32_t pathIndex) const = 0;
     virtual bool CanUse(const Area& area) const = 0;
     virtual bool CanUse(const Way& way) const = 0;
     virtual bool CanUseForward(const Way& way) const = 0;
@@ -71,6 +75,15 @@ namespace osmscout {
                             size_t inPathIndex,
                             size_t outPathIndex) const = 0;
 
+    /**
+     * Estimated cost for outgoing path (outPathIndex) of the in-memory routing graph
+     * when the node is entered from inPathIndex
+     */
+    virtual double GetCosts(const RoutingGraph& graph,
+                            const std::vector<ObjectVariantData>& objectVariantData,
+                            uint32_t inPathIndex,
+                            uint32_t outPathIndex) const = 0;
+
     /**
      * Estimated cost for specific area with given distance
      */
@@ -116,6 +129,19 @@ namespace osmscout {
     double                     maxSpeed;
     double                     vehicleMaxSpeed;
 
+  protected:
+    inline bool CanUse(uint8_t pathFlags,
+                       const ObjectVariantData& objectVariant) const
+    {
+      if (!(pathFlags & vehicleRouteNodeBit)) {
+        return false;
+      }
+
+      size_t typeIndex=objectVariant.type->GetIndex();
+
+      return typeIndex<speeds.size() && speeds[typeIndex]>0.0;
+    }
+
   public:
     explicit AbstractRoutingProfile(const TypeConfigRef& typeConfig);
 
@@ -159,6 +185,9 @@ namespace osmscout {
     bool CanUse(const RouteNode& currentNode,
                 const std::vector<ObjectVariantData>& objectVariantData,
                 size_t pathIndex) const override;
+    bool CanUse(const RoutingGraph& graph,
+                const std::vector<ObjectVariantData>& objectVariantData,
+                uint32_t pathIndex) const override;
     bool CanUse(const Area& area) const override;
     bool CanUse(const Way& way) const override;
     bool CanUseForward(const Way& way) const override;
@@ -212,6 +241,14 @@ namespace osmscout {
       return currentNode.paths[outPathIndex].distance.As<Kilometer>();
     }
 
+    inline double GetCosts(const RoutingGraph& graph,
+                           const std::vector<ObjectVariantData>& /*objectVariantData*/,
+                           uint32_t /*inPathIndex*/,
+                           uint32_t outPathIndex) const override
+    {
+      return graph.GetPathDistance(outPathIndex).As<Kilometer>();
+    }
+
     inline double GetCosts(const Area& /*area*/,
                            const Distance &distance) const override
     {
@@ -242,6 +279,46 @@ namespace osmscout {
   protected:
     bool applyJunctionPenalty=true;
 
+    /**
+     * Cost of traveling the given distance on the out path variant, including
+     * a penalty, if the path switches to another object at the junction
+     */
+    inline double GetPathCosts(const Distance& distance,
+                               const ObjectVariantData& inPathVariant,
+                               const ObjectVariantData& outPathVariant,
+                               bool objectChange) const
+    {
+      auto GetMaxSpeed = [&](const ObjectVariantData &variant) -> double {
+        if (variant.maxSpeed > 0) {
+          return variant.maxSpeed;
+        }
+        const TypeInfoRef& type=variant.type;
+        double speed=speeds[type->GetIndex()];
+        if (speed<=0){
+          log.Warn() << "Infinite cost for type " << type->GetName();
+        }
+        return speed;
+      };
+
+      // price of ride to target node using outPath
+      double speed=std::min(vehicleMaxSpeed,GetMaxSpeed(outPathVariant));
+      double outPrice = speed <= 0 ?
+          std::numeric_limits<double>::infinity() :
+          distance.As<Kilometer>() / speed;
+
+      // add penalty for junction
+      // it is estimate without considering real junction geometry
+      double junctionPenalty{0};
+      if (applyJunctionPenalty && objectChange){
+        double minSpeed=std::min(GetMaxSpeed(inPathVariant),GetMaxSpeed(outPathVariant));
+        junctionPenalty = minSpeed <= 0 ?
+            std::numeric_limits<double>::infinity() :
+            0.160 / minSpeed;
+      }
+
+      return outPrice + junctionPenalty;
+    }
+
   public:
     explicit FastestPathRoutingProfile(const TypeConfigRef& typeConfig);
 
@@ -280,38 +357,31 @@ namespace osmscout {
       auto outVariantIndex=currentNode.objects[outObjIndex].objectVariantIndex;
       assert(objectVariantData.size() > inVariantIndex);
       assert(objectVariantData.size() > outVariantIndex);
-      const ObjectVariantData &inPathVariant=objectVariantData[inVariantIndex];
-      const ObjectVariantData &outPathVariant=objectVariantData[outVariantIndex];
-
-      auto GetMaxSpeed = [&](const ObjectVariantData &variant) -> double {
-        if (variant.maxSpeed > 0) {
-          return variant.maxSpeed;
-        }
-        TypeInfoRef type=variant.type;
-        double speed=speeds[type->GetIndex()];
-        if (speed<=0){
-          log.Warn() << "Infinite cost for type " << type->GetName();
-        }
-        return speed;
-      };
 
-      // price of ride to target node using outPath
-      double speed=std::min(vehicleMaxSpeed,GetMaxSpeed(outPathVariant));
-      double outPrice = speed <= 0 ?
-          std::numeric_limits<double>::infinity() :
-          currentNode.paths[outPathIndex].distance.As<Kilometer>() / speed;
+      return GetPathCosts(currentNode.paths[outPathIndex].distance,
+                          objectVariantData[inVariantIndex],
+                          objectVariantData[outVariantIndex],
+                          inObjIndex!=outObjIndex);
+    }
 
-      // add penalty for junction
-      // it is estimate without considering real junction geometry
-      double junctionPenalty{0};
-      if (applyJunctionPenalty && inObjIndex!=outObjIndex){
-        double minSpeed=std::min(GetMaxSpeed(inPathVariant),GetMaxSpeed(outPathVariant));
-        junctionPenalty = minSpeed <= 0 ?
-            std::numeric_limits<double>::infinity() :
-            0.160 / minSpeed;
-      }
+    inline double GetCosts(const RoutingGraph& graph,
+                           const std::vector<ObjectVariantData>& objectVariantData,
+                           uint32_t inPathIndex,
+                           uint32_t outPathIndex) const override
+    {
+      assert(graph.GetPathCount() > inPathIndex);
+      assert(graph.GetPathCount() > outPathIndex);
+      auto inObjIndex=graph.GetPathObjectIndex(inPathIndex);
+      auto outObjIndex=graph.GetPathObjectIndex(outPathIndex);
+      auto inVariantIndex=graph.GetObjectVariantIndex(inObjIndex);
+      auto outVariantIndex=graph.GetObjectVariantIndex(outObjIndex);
+      assert(objectVariantData.size() > inVariantIndex);
+      assert(objectVariantData.size() > outVariantIndex);
 
-      return outPrice + junctionPenalty;
+      return GetPathCosts(graph.GetPathDistance(outPathIndex),
+                          objectVariantData[inVariantIndex],
+                          objectVariantData[outVariantIndex],
+                          inObjIndex!=outObjIndex);
     }
 
     inline double GetCosts(const Area& area,
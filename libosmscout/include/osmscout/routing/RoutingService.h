@@ -131,18 +131,22 @@ namespace osmscout {
    *
    * The following groups attributes are currently available:
    * - Switch for showing debug information
+   * - Switch for allocating temporary objects from a request local arena
    */
   class OSMSCOUT_API RouterParameter CLASS_FINAL
   {
   private:
     bool          debugPerformance;
+    bool          useObjectArena;
 
   public:
     RouterParameter();
 
     void SetDebugPerformance(bool debug);
+    void SetUseObjectArena(bool useObjectArena);
 
     bool IsDebugPerformance() const;
+    bool GetUseObjectArena() const;
   };
 
   /**
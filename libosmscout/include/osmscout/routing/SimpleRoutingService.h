@@ -133,6 +133,11 @@ namespace osmscout {
                 const RouteNode& routeNode,
                 size_t pathIndex) override;
 
+    bool CanUse(const RoutingProfile& profile,
+                DatabaseId database,
+                const RoutingGraph& graph,
+                uint32_t pathIndex) override;
+
     bool CanUseForward(const RoutingProfile& profile,
                        const DatabaseId& database,
                        const WayRef& way) override;
@@ -147,6 +152,12 @@ namespace osmscout {
                     size_t inPathIndex,
                     size_t outPathIndex) override;
 
+    double GetCosts(const RoutingProfile& profile,
+                    DatabaseId database,
+                    const RoutingGraph& graph,
+                    uint32_t inPathIndex,
+                    uint32_t outPathIndex) override;
+
     double GetCosts(const RoutingProfile& profile,
                     DatabaseId database,
                     const WayRef &way,
@@ -166,6 +177,8 @@ namespace osmscout {
     bool GetRouteNode(const DBId &id,
                       RouteNodeRef &node) override;
 
+    const RoutingGraph* GetRoutingGraph(DatabaseId database) const override;
+
     bool GetWayByOffset(const DBFileOffset &offset,
                         WayRef &way) override;
 
@@ -24,6 +24,7 @@
 
 #include <limits>
 #include <list>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -32,6 +33,7 @@
 #include <osmscout/OSMScoutTypes.h>
 
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Metrics.h>
 
 namespace osmscout {
 
@@ -112,6 +114,10 @@ namespace osmscout {
     Map       map;           //<! Key=>Value map
     CacheRef  previousEntry; //<! Reference to the last access cache entry
 
+    MetricCounter* hitCounter;      //<! Optional counter of cache hits
+    MetricCounter* missCounter;     //<! Optional counter of cache misses
+    MetricCounter* evictionCounter; //<! Optional counter of entries removed because the cache was full
+
   private:
 
     inline IK KeyToInternalKey(K key)
@@ -137,6 +143,10 @@ namespace osmscout {
         previousEntry=order.end();
 
         size--;
+
+        if (evictionCounter!=nullptr) {
+          evictionCounter->Increment();
+        }
       }
     }
 
@@ -146,7 +156,10 @@ namespace osmscout {
       */
     explicit Cache(size_t maxSize)
      : size(0),
-       maxSize(maxSize)
+       maxSize(maxSize),
+       hitCounter(nullptr),
+       missCounter(nullptr),
+       evictionCounter(nullptr)
     {
       map.reserve(maxSize);
       previousEntry=order.end();
@@ -160,6 +173,25 @@ namespace osmscout {
       return maxSize>0;
     }
 
+    /**
+     * Count hits, misses and evictions of the cache in the global metrics
+     * registry, labeled with the given cache name
+     */
+    void SetMetrics(const std::string& cacheName)
+    {
+      MetricLabels labels{{"cache",cacheName}};
+
+      hitCounter=&metrics.GetCounter("osmscout_cache_hits_total",
+                                     "Number of cache lookups that found the entry",
+                                     labels);
+      missCounter=&metrics.GetCounter("osmscout_cache_misses_total",
+                                      "Number of cache lookups that did not find the entry",
+                                      labels);
+      evictionCounter=&metrics.GetCounter("osmscout_cache_evictions_total",
+                                          "Number of entries removed because the cache was full",
+                                          labels);
+    }
+
     /**
       Getting the value with the given key from cache.
 
@@ -181,6 +213,11 @@ namespace osmscout {
       if (previousEntry!=order.end() &&
           previousEntry->key==key) {
         reference=previousEntry;
+
+        if (hitCounter!=nullptr) {
+          hitCounter->Increment();
+        }
+
         return true;
       }
 
@@ -196,12 +233,30 @@ namespace osmscout {
         reference=order.begin();
         previousEntry=reference;
 
+        if (hitCounter!=nullptr) {
+          hitCounter->Increment();
+        }
+
         return true;
       }
 
+      if (missCounter!=nullptr) {
+        missCounter->Increment();
+      }
+
       return false;
     }
 
+    /**
+     * Returns true, if there is a value with the given key in the cache. In
+     * contrast to GetEntry() the order of the entries and the metrics are
+     * not touched.
+     */
+    bool Contains(const K& key) const
+    {
+      return map.find(key)!=map.end();
+    }
+
     /**
       Set or update the cache with the given value for the given key.
 
@@ -208,6 +208,9 @@ namespace osmscout {
     void SetPos(FileOffset pos);
     FileOffset GetPos() const;
 
+    void Prefetch(FileOffset offset,
+                  FileOffset length) const;
+
     void Read(char* buffer, size_t bytes);
 
     void Read(std::string& value);
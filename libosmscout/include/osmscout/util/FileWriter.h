@@ -61,6 +61,7 @@ namespace osmscout {
     virtual ~FileWriter();
 
     void Open(const std::string& filename);
+    void OpenExisting(const std::string& filename);
     void Close();
     void CloseFailsafe();
     inline bool IsOpen() const
@@ -78,6 +79,7 @@ namespace osmscout {
     FileOffset GetPos();
     void SetPos(FileOffset pos);
     void GotoBegin();
+    void GotoEnd();
 
     void Write(const char* buffer, size_t bytes);
 
@@ -308,6 +308,12 @@ namespace osmscout {
      * The resulting box will cross the circle in its corners.
      */
     static GeoBox BoxByCenterAndRadius(const GeoCoord& center,const Distance& radius);
+
+    /**
+     * Return an GeoBox based on the center and the radius [meters] of a circle around the center.
+     * In contrast to BoxByCenterAndRadius the resulting box will contain the whole circle.
+     */
+    static GeoBox BoxAroundCircle(const GeoCoord& center,const Distance& radius);
   };
 }
 
@@ -1201,6 +1201,34 @@ namespace osmscout {
                                                GeoCoord& location,
                                                GeoCoord& intersection);
 
+  /**
+   * \ingroup Geometry
+   * Simplify the given line (or ring, if closed is true) using the
+   * Douglas-Peucker algorithm.
+   *
+   * Distances are measured in Mercator space with both axis scaled to degrees
+   * of longitude, so the tolerance directly relates to the size of a pixel at
+   * a given magnification (360/(256*2^level) degrees for a 256 pixel tile).
+   *
+   * The first and the last point of a line are always kept. Rings keep at least
+   * three points.
+   */
+  extern OSMSCOUT_API void SimplifyPolyline(const std::vector<Point>& nodes,
+                                            double tolerance,
+                                            bool closed,
+                                            std::vector<Point>& simplified);
+
+  /**
+   * \ingroup Geometry
+   * Return the position of the cell (x,y) on a Hilbert curve covering a grid
+   * of 2^level x 2^level cells. Cells that are near to each other on the curve
+   * are also near to each other in the grid, and all cells of a quadrant of
+   * the grid (on each level of subdivision) form one continuous run on the curve.
+   */
+  extern OSMSCOUT_API uint64_t GetHilbertIndex(uint32_t x,
+                                               uint32_t y,
+                                               uint32_t level);
+
   /**
    * \ingroup Geometry
    * Information about intersection of two paths
@@ -0,0 +1,256 @@
+#ifndef OSMSCOUT_UTIL_METRICS_H
+#define OSMSCOUT_UTIL_METRICS_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/system/Compiler.h>
+
+#include <osmscout/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Labels of a metric, e.g. {"file","ways.dat"}
+   */
+  typedef std::map<std::string,std::string> MetricLabels;
+
+  /**
+   * \ingroup Util
+   *
+   * A monotonic increasing counter. Incrementing is a single relaxed atomic
+   * operation and thus can be used in hot paths from multiple threads.
+   */
+  class OSMSCOUT_API MetricCounter CLASS_FINAL
+  {
+  private:
+    std::atomic<uint64_t> value;
+
+  public:
+    MetricCounter();
+
+    MetricCounter(const MetricCounter&) = delete;
+    MetricCounter& operator=(const MetricCounter&) = delete;
+
+    inline void Increment(uint64_t count=1)
+    {
+      value.fetch_add(count,std::memory_order_relaxed);
+    }
+
+    inline uint64_t GetValue() const
+    {
+      return value.load(std::memory_order_relaxed);
+    }
+
+    void Reset();
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * A histogram with fixed bucket boundaries, counting observed values
+   * per bucket. Observing a value is lock-free.
+   */
+  class OSMSCOUT_API MetricHistogram CLASS_FINAL
+  {
+  private:
+    std::vector<double>                        bounds;  //!< Upper bounds of the buckets, sorted ascending
+    std::unique_ptr<std::atomic<uint64_t>[]>   buckets; //!< Count per bucket, the last bucket counts values above all bounds
+    std::atomic<uint64_t>                      count;
+    std::atomic<double>                        sum;
+
+  public:
+    explicit MetricHistogram(const std::vector<double>& bounds);
+
+    MetricHistogram(const MetricHistogram&) = delete;
+    MetricHistogram& operator=(const MetricHistogram&) = delete;
+
+    void Observe(double value);
+
+    inline const std::vector<double>& GetBounds() const
+    {
+      return bounds;
+    }
+
+    /**
+     * Returns the number of observed values per bucket (not cumulative), with one
+     * additional entry for values above all bounds
+     */
+    std::vector<uint64_t> GetBucketCounts() const;
+
+    inline uint64_t GetCount() const
+    {
+      return count.load(std::memory_order_relaxed);
+    }
+
+    inline double GetSum() const
+    {
+      return sum.load(std::memory_order_relaxed);
+    }
+
+    void Reset();
+
+    /**
+     * Default bucket bounds for latencies measured in seconds, from 1ms to 10s
+     */
+    static std::vector<double> GetLatencyBounds();
+  };
+
+  /**
+   * \ingroup Util
+   * Observes the time in seconds from construction to destruction in the given histogram
+   */
+  class OSMSCOUT_API MetricTimer CLASS_FINAL
+  {
+  private:
+    MetricHistogram&                      histogram;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    inline explicit MetricTimer(MetricHistogram& histogram)
+    : histogram(histogram),
+      start(std::chrono::steady_clock::now())
+    {
+      // no code
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+    inline ~MetricTimer()
+    {
+      histogram.Observe(std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count());
+    }
+  };
+
+  /**
+   * \ingroup Util
+   * Point in time copy of the values of all registered metrics
+   */
+  struct OSMSCOUT_API MetricsSnapshot
+  {
+    struct Counter
+    {
+      std::string  name;
+      std::string  help;
+      MetricLabels labels;
+      uint64_t     value;
+    };
+
+    struct Histogram
+    {
+      std::string           name;
+      std::string           help;
+      MetricLabels          labels;
+      std::vector<double>   bounds;
+      std::vector<uint64_t> bucketCounts; //!< Cumulative count of values less or equal the bound, last entry is +Inf
+      uint64_t              count;
+      double                sum;
+    };
+
+    std::vector<Counter>   counters;   //!< Sorted by name and labels
+    std::vector<Histogram> histograms; //!< Sorted by name and labels
+
+    const Counter* GetCounter(const std::string& name,
+                              const MetricLabels& labels=MetricLabels()) const;
+    const Histogram* GetHistogram(const std::string& name,
+                                  const MetricLabels& labels=MetricLabels()) const;
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * Registry of all metrics of the process. Registering metrics is synchronized,
+   * the returned metric objects stay valid for the lifetime of the registry. Code
+   * in hot paths should register once and keep a reference to the metric.
+   *
+   * Registering a metric with a name and labels that are already registered returns
+   * the existing metric, so multiple instances of e.g. a database share their metrics.
+   */
+  class OSMSCOUT_API MetricsRegistry CLASS_FINAL
+  {
+  private:
+    struct CounterEntry
+    {
+      std::string                    name;
+      std::string                    help;
+      MetricLabels                   labels;
+      std::unique_ptr<MetricCounter> counter;
+    };
+
+    struct HistogramEntry
+    {
+      std::string                      name;
+      std::string                      help;
+      MetricLabels                     labels;
+      std::unique_ptr<MetricHistogram> histogram;
+    };
+
+  private:
+    mutable std::mutex          mutex;
+    std::vector<CounterEntry>   counters;
+    std::vector<HistogramEntry> histograms;
+
+  public:
+    MetricsRegistry() = default;
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    MetricCounter& GetCounter(const std::string& name,
+                              const std::string& help,
+                              const MetricLabels& labels=MetricLabels());
+
+    MetricHistogram& GetHistogram(const std::string& name,
+                                  const std::string& help,
+                                  const std::vector<double>& bounds,
+                                  const MetricLabels& labels=MetricLabels());
+
+    MetricsSnapshot GetSnapshot() const;
+
+    /**
+     * Reset the values of all metrics to zero. Metrics stay registered.
+     */
+    void Reset();
+  };
+
+  //! \ingroup Util
+  //! The global metrics registry of the library
+  extern OSMSCOUT_API MetricsRegistry metrics;
+
+  /**
+   * \ingroup Util
+   * Write the snapshot in the Prometheus text exposition format
+   */
+  extern OSMSCOUT_API void WritePrometheusText(std::ostream& stream,
+                                               const MetricsSnapshot& snapshot);
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef OSMSCOUT_UTIL_OBJECTARENA_H
+#define OSMSCOUT_UTIL_OBJECTARENA_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CoreFeatures.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <osmscout/CoreImportExport.h>
+
+#include <osmscout/system/Compiler.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   *
+   * Monotonic memory arena. Memory is taken from larger blocks and is only
+   * released as a whole, when the arena gets destroyed.
+   *
+   * Objects are placed into the arena using std::allocate_shared together with
+   * an ArenaAllocator. Each object (via the allocator stored in its control block)
+   * holds a reference to the arena, so the arena and all its blocks get freed in
+   * one shot, as soon as the last object loaded into it gets released.
+   *
+   * Methods are thread-safe.
+   */
+  class OSMSCOUT_API ObjectArena CLASS_FINAL
+  {
+  private:
+    mutable std::mutex                   mutex;
+    size_t                               blockSize;       //!< Default size of a block
+    std::vector<std::unique_ptr<char[]>> blocks;          //!< Allocated blocks
+    char*                                current;         //!< Start of the free memory in the current block
+    size_t                               available;       //!< Free bytes in the current block
+    size_t                               allocationCount; //!< Number of allocations
+    size_t                               allocatedBytes;  //!< Number of bytes allocated
+
+  public:
+    explicit ObjectArena(size_t blockSize=64*1024);
+
+    ObjectArena(const ObjectArena& other) = delete;
+    ObjectArena& operator=(const ObjectArena& other) = delete;
+
+    void* Allocate(size_t size,
+                   size_t alignment);
+
+    size_t GetAllocationCount() const;
+    size_t GetAllocatedBytes() const;
+    size_t GetBlockCount() const;
+  };
+
+  //! \ingroup Util
+  //! Reference counted reference to an ObjectArena instance
+  typedef std::shared_ptr<ObjectArena> ObjectArenaRef;
+
+  /**
+   * \ingroup Util
+   *
+   * Makes the given arena the current arena of the calling thread for the
+   * lifetime of the scope. While an arena is current, the internal buffers
+   * of objects read from file (see FeatureValueBuffer) are allocated from it, too.
+   *
+   * The caller must assure that all objects created within the scope do not
+   * outlive the arena. This is the case for objects created via MakeShared(),
+   * since they hold a reference to their arena.
+   */
+  class OSMSCOUT_API ObjectArenaScope CLASS_FINAL
+  {
+  private:
+    ObjectArena* previousArena;
+
+  public:
+    explicit ObjectArenaScope(ObjectArena* arena);
+    ~ObjectArenaScope();
+
+    ObjectArenaScope(const ObjectArenaScope& other) = delete;
+    ObjectArenaScope& operator=(const ObjectArenaScope& other) = delete;
+
+    static ObjectArena* GetCurrentArena();
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * STL compatible allocator, taking its memory from an ObjectArena.
+   * Deallocation does nothing, memory is released together with the arena.
+   */
+  template<typename T>
+  class ArenaAllocator
+  {
+  public:
+    typedef T value_type;
+
+  private:
+    ObjectArenaRef arena;
+
+    template<typename U>
+    friend class ArenaAllocator;
+
+  public:
+    explicit ArenaAllocator(const ObjectArenaRef& arena)
+    : arena(arena)
+    {
+      // no code
+    }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) // NOLINT
+    : arena(other.arena)
+    {
+      // no code
+    }
+
+    T* allocate(size_t n)
+    {
+      return static_cast<T*>(arena->Allocate(n*sizeof(T),alignof(T)));
+    }
+
+    void deallocate(T* /*p*/,
+                    size_t /*n*/)
+    {
+      // no code
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+      return arena==other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+      return arena!=other.arena;
+    }
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * Create a new object in the given arena or on the heap, if no arena is given.
+   */
+  template<typename T>
+  std::shared_ptr<T> MakeShared(const ObjectArenaRef& arena)
+  {
+    if (arena) {
+      return std::allocate_shared<T>(ArenaAllocator<T>(arena));
+    }
+
+    return std::make_shared<T>();
+  }
+}
+
+#endif
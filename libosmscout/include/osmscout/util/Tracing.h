@@ -0,0 +1,235 @@
+#ifndef OSMSCOUT_UTIL_TRACING_H
+#define OSMSCOUT_UTIL_TRACING_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#include <osmscout/system/Compiler.h>
+
+#include <osmscout/CoreImportExport.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * A recorded trace event, a named time span on a thread
+   */
+  struct OSMSCOUT_API TraceEvent
+  {
+    const char* category; //!< Category of the event, e.g. "MapService"
+    const char* name;     //!< Name of the event
+    int64_t     start;    //!< Start in nanoseconds since the start of the tracer
+    int64_t     duration; //!< Duration in nanoseconds
+    uint32_t    threadId; //!< Sequential id of the thread that recorded the event
+  };
+
+  /**
+   * \ingroup Util
+   *
+   * Collects trace events of scoped time spans (see TraceScope and
+   * OSMSCOUT_TRACE_SCOPE) and exports them in the Chrome trace event format,
+   * which can be viewed with chrome://tracing or https://ui.perfetto.dev.
+   *
+   * Tracing is disabled by default. If disabled, a trace scope costs an
+   * atomic load. If enabled, each thread records into its own ring buffer
+   * holding the latest events, so long running processes do not grow
+   * and only the recent history (e.g. of a slow frame) is exported.
+   * The buffer of an exited thread is reused by the next thread that
+   * starts recording, so the number of buffers is limited by the number
+   * of concurrently recording threads. The new thread continues the ring
+   * buffer, the events of the exited thread are overwritten gradually.
+   *
+   * Tracing can be removed at compile time by disabling OSMSCOUT_HAVE_TRACING,
+   * OSMSCOUT_TRACE_SCOPE then expands to nothing.
+   */
+  class OSMSCOUT_API Tracer CLASS_FINAL
+  {
+  public:
+    static const size_t DEFAULT_BUFFER_SIZE = 16384;
+
+  private:
+    /**
+     * Ring buffer of events of one thread. Only the owning thread adds events,
+     * the mutex is thus only contended while exporting.
+     */
+    struct ThreadBuffer
+    {
+      std::mutex              mutex;
+      uint32_t                threadId;
+      std::vector<TraceEvent> events;
+      size_t                  next=0;      //!< Index of the next event to write
+      bool                    wrapped=false;
+      std::atomic<bool>       released{false}; //!< The owning thread has exited, the buffer can be reused
+
+      void Add(const TraceEvent& event);
+      void Resize(size_t size);
+    };
+
+    struct ThreadBufferOwner;
+
+  private:
+    uint64_t                                   id;      //!< Unique id of the tracer, to identify thread local buffers
+    std::atomic<bool>                          enabled;
+    std::chrono::steady_clock::time_point      epoch;
+
+    mutable std::mutex                         mutex;
+    size_t                                     bufferSize;
+    uint32_t                                   nextThreadId; //!< Id of the next thread that starts recording
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::unordered_set<std::string>            names;
+
+  private:
+    ThreadBuffer& GetThreadBuffer();
+
+  public:
+    Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    void Enable(bool enable);
+
+    inline bool IsEnabled() const
+    {
+      return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Set the number of events held per thread. Resizing clears all recorded events.
+     */
+    void SetBufferSize(size_t size);
+
+    /**
+     * Remove all recorded events
+     */
+    void Clear();
+
+    /**
+     * Current time in nanoseconds since the start of the tracer
+     */
+    inline int64_t GetTimestamp() const
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-epoch).count();
+    }
+
+    /**
+     * Record an event for the current thread. Category and name are not copied,
+     * they must stay valid while events are held (e.g. string literals or results
+     * of InternName()).
+     */
+    void Record(const char* category,
+                const char* name,
+                int64_t start,
+                int64_t end);
+
+    /**
+     * Returns a pointer to a copy of the given name that stays valid for the
+     * lifetime of the tracer, for event names that are built at runtime.
+     */
+    const char* InternName(const std::string& name);
+
+    /**
+     * Returns all currently held events, sorted by thread and start time
+     */
+    std::vector<TraceEvent> GetEvents() const;
+
+    void WriteChromeTrace(std::ostream& stream) const;
+    bool WriteChromeTrace(const std::string& filename) const;
+  };
+
+  //! \ingroup Util
+  //! The global tracer instance used by OSMSCOUT_TRACE_SCOPE
+  extern OSMSCOUT_API Tracer tracer;
+
+  /**
+   * \ingroup Util
+   *
+   * Records the time span from construction to destruction as trace event,
+   * if tracing was enabled at construction. Use OSMSCOUT_TRACE_SCOPE instead
+   * of using this class directly, so the scope can be removed at compile time.
+   */
+  class OSMSCOUT_API TraceScope CLASS_FINAL
+  {
+  private:
+    const char* category;
+    const char* name;
+    int64_t     start;
+
+  public:
+    inline TraceScope(const char* category,
+                      const char* name)
+    : category(category),
+      name(name),
+      start(tracer.IsEnabled() ? tracer.GetTimestamp() : -1)
+    {
+      // no code
+    }
+
+    inline TraceScope(const char* category,
+                      const std::string& name)
+    : category(category),
+      name(tracer.IsEnabled() ? tracer.InternName(name) : nullptr),
+      start(this->name!=nullptr ? tracer.GetTimestamp() : -1)
+    {
+      // no code
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    inline ~TraceScope()
+    {
+      if (start>=0) {
+        tracer.Record(category,
+                      name,
+                      start,
+                      tracer.GetTimestamp());
+      }
+    }
+  };
+}
+
+#define OSMSCOUT_TRACE_CONCAT_(a,b) a##b
+#define OSMSCOUT_TRACE_CONCAT(a,b) OSMSCOUT_TRACE_CONCAT_(a,b)
+
+#if defined(OSMSCOUT_HAVE_TRACING)
+/**
+ * \ingroup Util
+ * Trace the time span till the end of the current scope, category and name
+ * should be string literals
+ */
+#define OSMSCOUT_TRACE_SCOPE(category,name) \
+  osmscout::TraceScope OSMSCOUT_TRACE_CONCAT(osmscoutTraceScope,__LINE__)(category,name)
+#else
+#define OSMSCOUT_TRACE_SCOPE(category,name)
+#endif
+
+#endif
@@ -181,6 +181,19 @@ namespace osmscout {
     void Reset();
     size_t PushCoord(double x, double y);
 
+    /**
+     * Append all coordinates of the other buffer at the end of this buffer.
+     *
+     * @param other buffer to copy coordinates from
+     * @return offset of the first appended coordinate in this buffer
+     */
+    size_t Append(const CoordBuffer& other);
+
+    inline size_t GetSize() const
+    {
+      return usedPoints;
+    }
+
     /**
      * Generate parallel way to way stored in this buffer on range orgStart, orgEnd (inclusive)
      * Result is stored after the last valid point. Generated way offsets are returned
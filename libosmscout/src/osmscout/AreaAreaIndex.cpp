@@ -24,6 +24,7 @@
 #include <osmscout/util/File.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/system/Math.h>
 
@@ -38,7 +39,7 @@ namespace osmscout {
     topLevelOffset(0),
     indexCache(cacheSize)
   {
-    // no code
+    indexCache.SetMetrics(AREA_AREA_IDX);
   }
 
   AreaAreaIndex::~AreaAreaIndex()
@@ -132,6 +133,7 @@ namespace osmscout {
     scanner.ReadNumber(typeCount);
 
     FileOffset prevDataFileOffset=0;
+    bool       extendLastSpan=false; // Data of the current type directly follows the last span
 
     for (size_t t=0; t<typeCount; t++) {
       TypeId     typeId;
@@ -151,13 +153,25 @@ namespace osmscout {
 
       TypeInfoRef type=typeConfig.GetAreaTypeInfo(typeId);
 
-      if (types.IsSet(type)) {
+      if (!types.IsSet(type)) {
+        extendLastSpan=false;
+        continue;
+      }
+
+      // The data of the types of one cell is stored consecutively, so
+      // we merge the spans of directly following types into one read
+      if (extendLastSpan) {
+        spans.back().count+=dataCount;
+      }
+      else {
         DataBlockSpan span;
 
         span.startOffset=dataFileOffset;
         span.count=dataCount;
 
         spans.push_back(span);
+
+        extendLastSpan=true;
       }
     }
 
@@ -268,6 +282,8 @@ namespace osmscout {
                                      std::vector<DataBlockSpan>& spans,
                                      TypeInfoSet& loadedTypes) const
   {
+    OSMSCOUT_TRACE_SCOPE("AreaAreaIndex","GetAreasInArea");
+
     StopClock            time;
 
     std::vector<CellRef> cellRefs;     // cells to scan in this level
@@ -357,6 +373,10 @@ namespace osmscout {
       return false;
     }
 
+    // Reading the spans in file order results in (mostly) forward reads
+    std::sort(spans.begin(),
+              spans.end());
+
     time.Stop();
 
     if (time.GetMilliseconds()>100) {
@@ -29,4 +29,12 @@ namespace osmscout {
   {
     // no code
   }
+
+  const char* const AreaResolutionDataFile::AREAS_RES_DAT="areasres.dat";
+
+  AreaResolutionDataFile::AreaResolutionDataFile()
+  : MultiResolutionDataFile<Area>(AREAS_RES_DAT)
+  {
+    // no code
+  }
 }
@@ -26,6 +26,7 @@
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/TileId.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/system/Math.h>
 
@@ -342,6 +343,7 @@ namespace osmscout {
                                  std::vector<FileOffset>& offsets,
                                  TypeInfoSet& loadedTypes) const
   {
+    OSMSCOUT_TRACE_SCOPE("AreaNodeIndex","GetOffsets");
 
     StopClock time;
 
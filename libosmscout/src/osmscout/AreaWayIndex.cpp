@@ -25,6 +25,7 @@
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/Tracing.h>
 
 #include <osmscout/system/Math.h>
 
@@ -227,6 +228,8 @@ namespace osmscout {
                                 std::vector<FileOffset>& offsets,
                                 TypeInfoSet& loadedTypes) const
   {
+    OSMSCOUT_TRACE_SCOPE("AreaWayIndex","GetOffsets");
+
     StopClock time;
 
     offsets.reserve(std::min((size_t)10000,offsets.capacity()));
@@ -251,8 +254,14 @@ namespace osmscout {
       return false;
     }
 
+    size_t firstNewOffset=offsets.size();
+
     offsets.insert(offsets.end(),uniqueOffsets.begin(),uniqueOffsets.end());
 
+    // Loading the ways in file order results in (mostly) forward reads
+    std::sort(offsets.begin()+firstNewOffset,
+              offsets.end());
+
     //std::cout << "Found " << wayWayOffsets.size() << "+" << relationWayOffsets.size()<< " offsets in 'areaway.idx'" << std::endl;
 
     time.Stop();
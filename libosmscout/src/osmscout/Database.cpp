@@ -28,6 +28,7 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
@@ -44,7 +45,9 @@ namespace osmscout {
     areasDataMMap(true),
     waysDataMMap(true),
     optimizeLowZoomMMap(true),
-    indexMMap(true)
+    indexMMap(true),
+    waterIndexInMemory(false),
+    routerDataInMemory(false)
   {
     // no code
   }
@@ -99,6 +102,24 @@ namespace osmscout {
     indexMMap=mmap;
   }
 
+  /**
+   * Decode the complete water index into memory on open, so that ground tile
+   * requests do not access the file anymore
+   */
+  void DatabaseParameter::SetWaterIndexInMemory(bool inMemory)
+  {
+    waterIndexInMemory=inMemory;
+  }
+
+  /**
+   * Load the complete routing graph into flat in-memory arrays when the router
+   * is opened, so that route calculation does not access the file anymore
+   */
+  void DatabaseParameter::SetRouterDataInMemory(bool inMemory)
+  {
+    routerDataInMemory=inMemory;
+  }
+
   unsigned long DatabaseParameter::GetAreaAreaIndexCacheSize() const
   {
     return areaAreaIndexCacheSize;
@@ -149,6 +170,16 @@ namespace osmscout {
     return indexMMap;
   }
 
+  bool DatabaseParameter::GetWaterIndexInMemory() const
+  {
+    return waterIndexInMemory;
+  }
+
+  bool DatabaseParameter::GetRouterDataInMemory() const
+  {
+    return routerDataInMemory;
+  }
+
   NodeRegionSearchResultEntry::NodeRegionSearchResultEntry(const NodeRef &node,
                                                            const Distance &distance)
   : node(node),
@@ -237,6 +268,20 @@ namespace osmscout {
       wayDataFile=nullptr;
     }
 
+    if (areaResolutionDataFile) {
+      if (areaResolutionDataFile->IsOpen()) {
+        areaResolutionDataFile->Close();
+      }
+      areaResolutionDataFile=nullptr;
+    }
+
+    if (wayResolutionDataFile) {
+      if (wayResolutionDataFile->IsOpen()) {
+        wayResolutionDataFile->Close();
+      }
+      wayResolutionDataFile=nullptr;
+    }
+
     if (areaNodeIndex) {
       areaNodeIndex->Close();
       areaNodeIndex=nullptr;
@@ -402,6 +447,82 @@ namespace osmscout {
     return wayDataFile;
   }
 
+  /**
+   * Return the file holding areas with simplified geometry or nullptr, if
+   * the database does not contain it.
+   */
+  AreaResolutionDataFileRef Database::GetAreaResolutionDataFile() const
+  {
+    std::lock_guard<std::mutex> guard(areaResolutionDataFileMutex);
+
+    if (!IsOpen()) {
+      return nullptr;
+    }
+
+    if (!areaResolutionDataFile) {
+      areaResolutionDataFile=std::make_shared<AreaResolutionDataFile>();
+
+      // The file is optional, we only check once
+      if (ExistsInFilesystem(AppendFileToDir(path,AreaResolutionDataFile::AREAS_RES_DAT))) {
+        StopClock timer;
+
+        if (!areaResolutionDataFile->Open(typeConfig,
+                                          path,
+                                          parameter.GetOptimizeLowZoomMMap())) {
+          log.Error() << "Cannot open '" << AreaResolutionDataFile::AREAS_RES_DAT << "'!";
+        }
+
+        timer.Stop();
+
+        log.Debug() << "Opening AreaResolutionDataFile: " << timer.ResultString();
+      }
+    }
+
+    if (!areaResolutionDataFile->IsOpen()) {
+      return nullptr;
+    }
+
+    return areaResolutionDataFile;
+  }
+
+  /**
+   * Return the file holding ways with simplified geometry or nullptr, if
+   * the database does not contain it.
+   */
+  WayResolutionDataFileRef Database::GetWayResolutionDataFile() const
+  {
+    std::lock_guard<std::mutex> guard(wayResolutionDataFileMutex);
+
+    if (!IsOpen()) {
+      return nullptr;
+    }
+
+    if (!wayResolutionDataFile) {
+      wayResolutionDataFile=std::make_shared<WayResolutionDataFile>();
+
+      // The file is optional, we only check once
+      if (ExistsInFilesystem(AppendFileToDir(path,WayResolutionDataFile::WAYS_RES_DAT))) {
+        StopClock timer;
+
+        if (!wayResolutionDataFile->Open(typeConfig,
+                                         path,
+                                         parameter.GetOptimizeLowZoomMMap())) {
+          log.Error() << "Cannot open '" << WayResolutionDataFile::WAYS_RES_DAT << "'!";
+        }
+
+        timer.Stop();
+
+        log.Debug() << "Opening WayResolutionDataFile: " << timer.ResultString();
+      }
+    }
+
+    if (!wayResolutionDataFile->IsOpen()) {
+      return nullptr;
+    }
+
+    return wayResolutionDataFile;
+  }
+
   AreaNodeIndexRef Database::GetAreaNodeIndex() const
   {
     std::lock_guard<std::mutex> guard(areaNodeIndexMutex);
@@ -529,7 +650,9 @@ namespace osmscout {
 
       StopClock timer;
 
-      if (!waterIndex->Open(path, parameter.GetIndexMMap())) {
+      if (!waterIndex->Open(path,
+                            parameter.GetIndexMMap(),
+                            parameter.GetWaterIndexInMemory())) {
         log.Error() << "Cannot load water index!";
         waterIndex=nullptr;
 
@@ -538,7 +661,12 @@ namespace osmscout {
 
       timer.Stop();
 
-      log.Debug() << "Opening WaterIndex: " << timer.ResultString();
+      if (waterIndex->IsInMemory()) {
+        log.Debug() << "Opening WaterIndex: " << timer.ResultString() << ", memory " << waterIndex->GetMemoryUsage();
+      }
+      else {
+        log.Debug() << "Opening WaterIndex: " << timer.ResultString();
+      }
     }
 
     return waterIndex;
@@ -660,7 +788,8 @@ namespace osmscout {
 
   bool Database::GetNodesByOffset(const std::vector<FileOffset>& offsets,
                                   const GeoBox& boundingBox,
-                                  std::vector<NodeRef>& nodes) const
+                                  std::vector<NodeRef>& nodes,
+                                  const ObjectArenaRef& arena) const
   {
     NodeDataFileRef nodeDataFile=GetNodeDataFile();
 
@@ -674,7 +803,8 @@ namespace osmscout {
                                           offsets.end(),
                                           offsets.size(),
                                           boundingBox,
-                                          nodes);
+                                          nodes,
+                                          arena);
 
     time.Stop();
 
@@ -885,6 +1015,39 @@ namespace osmscout {
                                          areas);
   }
 
+  /**
+   * Read the areas of the given spans with geometry simplified for the given
+   * magnification. Falls back to the original geometry, if there is no
+   * simplified geometry for the given magnification.
+   */
+  bool Database::GetAreasByBlockSpans(const std::vector<DataBlockSpan>& spans,
+                                      const Magnification& magnification,
+                                      std::vector<AreaRef>& areas,
+                                      const ObjectArenaRef& arena) const
+  {
+    AreaDataFileRef areaDataFile=GetAreaDataFile();
+
+    if (!areaDataFile) {
+      return false;
+    }
+
+    AreaResolutionDataFileRef areaResolutionDataFile=GetAreaResolutionDataFile();
+
+    if (!areaResolutionDataFile) {
+      return areaDataFile->GetByBlockSpans(spans.begin(),
+                                           spans.end(),
+                                           areas,
+                                           arena);
+    }
+
+    return areaResolutionDataFile->GetByBlockSpans(*areaDataFile,
+                                                   spans.begin(),
+                                                   spans.end(),
+                                                   magnification,
+                                                   areas,
+                                                   arena);
+  }
+
   bool Database::GetWayByOffset(const FileOffset& offset,
                                 WayRef& way) const
   {
@@ -925,6 +1088,47 @@ namespace osmscout {
     return result;
   }
 
+  /**
+   * Read the ways at the given offsets with geometry simplified for the given
+   * magnification. Falls back to the original geometry, if there is no
+   * simplified geometry for the given magnification.
+   */
+  bool Database::GetWaysByOffset(const std::vector<FileOffset>& offsets,
+                                 const Magnification& magnification,
+                                 std::vector<WayRef>& ways,
+                                 const ObjectArenaRef& arena) const
+  {
+    WayDataFileRef wayDataFile=GetWayDataFile();
+
+    if (!wayDataFile) {
+      return false;
+    }
+
+    WayResolutionDataFileRef wayResolutionDataFile=GetWayResolutionDataFile();
+
+    StopClock time;
+    bool      result;
+
+    if (wayResolutionDataFile) {
+      result=wayResolutionDataFile->GetByOffset(*wayDataFile,
+                                                offsets.begin(),
+                                                offsets.end(),
+                                                offsets.size(),
+                                                magnification,
+                                                ways,
+                                                arena);
+    }
+    else {
+      result=wayDataFile->GetByOffset(offsets.begin(),offsets.end(),offsets.size(),ways,arena);
+    }
+
+    if (time.GetMilliseconds()>100) {
+      log.Warn() << "Retrieving " << ways.size() << " ways by offset took " << time.ResultString();
+    }
+
+    return result;
+  }
+
   bool Database::GetWaysByOffset(const std::set<FileOffset>& offsets,
                                  std::vector<WayRef>& ways) const
   {
@@ -1046,8 +1250,8 @@ namespace osmscout {
     }
 
     NodeRegionSearchResult  result;
-    GeoBox                  box=GeoBox::BoxByCenterAndRadius(location,
-                                                             maxDistance);
+    GeoBox                  box=GeoBox::BoxAroundCircle(location,
+                                                        maxDistance);
     std::vector<FileOffset> offsets;
     TypeInfoSet             loadedAddressTypes;
 
@@ -1071,20 +1275,9 @@ namespace osmscout {
                         "Error while reading nodes");
     }
 
-    if (nodes.empty()) {
-      return result;
-    }
-
-    for (const auto& node : nodes) {
-      Distance distance=GetEllipsoidalDistance(location,
-                                               node->GetCoords());
-      if (distance<=maxDistance) {
-        result.nodeResults.push_back(NodeRegionSearchResultEntry(node,
-                                                                 distance));
-      }
-    }
-
-    return result;
+    return FilterNodesInRadius(location,
+                               nodes,
+                               maxDistance);
   }
 
   WayRegionSearchResult Database::LoadWaysInRadius(const GeoCoord& location,
@@ -1098,8 +1291,8 @@ namespace osmscout {
     }
 
     WayRegionSearchResult   result;
-    GeoBox                  box=GeoBox::BoxByCenterAndRadius(location,
-                                                             maxDistance);
+    GeoBox                  box=GeoBox::BoxAroundCircle(location,
+                                                        maxDistance);
     std::vector<FileOffset> offsets;
     TypeInfoSet             loadedAddressTypes;
 
@@ -1123,10 +1316,78 @@ namespace osmscout {
                         "Error while reading ways");
     }
 
-    if (ways.empty()) {
+    return FilterWaysInRadius(location,
+                              ways,
+                              maxDistance);
+  }
+
+  AreaRegionSearchResult Database::LoadAreasInRadius(const GeoCoord& location,
+                                                     const TypeInfoSet& types,
+                                                     Distance maxDistance)
+  {
+    AreaAreaIndexRef areaAreaIndex=GetAreaAreaIndex();
+
+    if (!areaAreaIndex) {
+      throw UninitializedException("AreaAreaIndex");
+    }
+
+    AreaRegionSearchResult     result;
+    GeoBox                     box=GeoBox::BoxAroundCircle(location,
+                                                           maxDistance);
+    std::vector<DataBlockSpan> areaSpans;
+    TypeInfoSet                loadedTypes;
+
+    if (!areaAreaIndex->GetAreasInArea(*typeConfig,
+                                       box,
+                                       std::numeric_limits<size_t>::max(),
+                                       types,
+                                       areaSpans,
+                                       loadedTypes)) {
+      throw IOException(areaAreaIndex->GetFilename(),
+                        "Error while reading offsets");
+    }
+
+    if (areaSpans.empty()) {
       return result;
     }
 
+    std::vector<AreaRef> areas;
+
+    if (!GetAreasByBlockSpans(areaSpans,
+                              areas)) {
+      throw IOException(areaDataFile->GetFilename(),
+                        "Error while reading areas");
+    }
+
+    return FilterAreasInRadius(location,
+                               areas,
+                               maxDistance);
+  }
+
+  NodeRegionSearchResult Database::FilterNodesInRadius(const GeoCoord& location,
+                                                       const std::vector<NodeRef>& nodes,
+                                                       Distance maxDistance)
+  {
+    NodeRegionSearchResult result;
+
+    for (const auto& node : nodes) {
+      Distance distance=GetEllipsoidalDistance(location,
+                                               node->GetCoords());
+      if (distance<=maxDistance) {
+        result.nodeResults.push_back(NodeRegionSearchResultEntry(node,
+                                                                 distance));
+      }
+    }
+
+    return result;
+  }
+
+  WayRegionSearchResult Database::FilterWaysInRadius(const GeoCoord& location,
+                                                     const std::vector<WayRef>& ways,
+                                                     Distance maxDistance)
+  {
+    WayRegionSearchResult result;
+
     for (const auto& way : ways) {
       Distance distance=Distance::Max();
       GeoCoord closestPoint;
@@ -1168,47 +1429,11 @@ namespace osmscout {
     return result;
   }
 
-  AreaRegionSearchResult Database::LoadAreasInRadius(const GeoCoord& location,
-                                                     const TypeInfoSet& types,
-                                                     Distance maxDistance)
+  AreaRegionSearchResult Database::FilterAreasInRadius(const GeoCoord& location,
+                                                       const std::vector<AreaRef>& areas,
+                                                       Distance maxDistance)
   {
-    AreaAreaIndexRef areaAreaIndex=GetAreaAreaIndex();
-
-    if (!areaAreaIndex) {
-      throw UninitializedException("AreaAreaIndex");
-    }
-
-    AreaRegionSearchResult     result;
-    GeoBox                     box=GeoBox::BoxByCenterAndRadius(location,
-                                                                maxDistance);
-    std::vector<DataBlockSpan> areaSpans;
-    TypeInfoSet                loadedTypes;
-
-    if (!areaAreaIndex->GetAreasInArea(*typeConfig,
-                                       box,
-                                       std::numeric_limits<size_t>::max(),
-                                       types,
-                                       areaSpans,
-                                       loadedTypes)) {
-      throw IOException(areaAreaIndex->GetFilename(),
-                        "Error while reading offsets");
-    }
-
-    if (areaSpans.empty()) {
-      return result;
-    }
-
-    std::vector<AreaRef> areas;
-
-    if (!GetAreasByBlockSpans(areaSpans,
-                              areas)) {
-      throw IOException(areaDataFile->GetFilename(),
-                        "Error while reading areas");
-    }
-
-    if (areas.empty()) {
-      return result;
-    }
+    AreaRegionSearchResult result;
 
     for (const auto& area : areas) {
       Distance distance=Distance::Max();
@@ -20,17 +20,25 @@
 #include <osmscout/LocationDescriptionService.h>
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
+#include <osmscout/util/Exception.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/TileId.h>
 #include <osmscout/TypeFeatures.h>
 #include <osmscout/FeatureReader.h>
+#include <osmscout/LocationService.h>
 
 #include <osmscout/system/Math.h>
 
 namespace osmscout {
 
+  //! Level of the tiles, locations of a batch are grouped by
+  static const MagnificationLevel batchTileLevel(14);
+
   LocationCoordDescription::LocationCoordDescription(const GeoCoord& location)
     : location(location)
   {
@@ -602,20 +610,18 @@ namespace osmscout {
                                                        std::list<ReverseLookupResult>& result) const
   {
     result.clear();
-    AdminRegionReverseLookupVisitor adminRegionVisitor(*database,
-                                                       result);
-    AdminRegionReverseLookupVisitor::SearchEntry searchEntry;
 
-    searchEntry.coords.push_back(coord);
-    adminRegionVisitor.AddSearchEntry(searchEntry);
+    LocationService           locationService(database);
+    std::list<AdminRegionRef> regions;
 
-    if (!VisitAdminRegions(adminRegionVisitor)) {
+    if (!locationService.ReverseLookupRegion(coord,
+                                             regions)) {
       return false;
     }
 
-    for (const auto &region:adminRegionVisitor.adminRegions){
+    for (const auto &region : regions) {
       ReverseLookupResult regionResult;
-      regionResult.adminRegion=region.second;
+      regionResult.adminRegion=region;
       result.push_back(regionResult);
     }
 
@@ -800,84 +806,206 @@ namespace osmscout {
     return a.GetDistance() < b.GetDistance();
   }
 
-  bool LocationDescriptionService::DescribeLocationByName(const GeoCoord& location,
-                                                          LocationDescription& description,
-                                                          const Distance& lookupDistance,
-                                                          const double sizeFilter)
+  LocationDescriptionService::DescriptionTypes::DescriptionTypes(const TypeConfig& typeConfig)
   {
+    for (const auto& type : typeConfig.GetTypes()) {
+      // nameable areas and nodes, but no regions
+      if (type->HasFeature(NameFeature::NAME) &&
+          !type->GetIndexAsRegion() &&
+          !type->HasFeature(AdminLevelFeature::NAME)) {
+        if (type->CanBeArea()) {
+          nameAreaTypes.Set(type);
+        }
 
-    // search all nameable areas and nodes, sort it by distance, get first with name
-    TypeConfigRef typeConfig=database->GetTypeConfig();
+        if (type->CanBeNode()) {
+          nameNodeTypes.Set(type);
+        }
+      }
 
-    if (!typeConfig) {
-      return false;
+      if (type->GetIndexAsAddress()) {
+        if (type->CanBeArea()) {
+          addressAreaTypes.Set(type);
+        }
+
+        if (type->CanBeNode()) {
+          addressNodeTypes.Set(type);
+        }
+      }
+
+      if (type->GetIndexAsPOI()) {
+        if (type->CanBeArea()) {
+          poiAreaTypes.Set(type);
+        }
+
+        if (type->CanBeNode()) {
+          poiNodeTypes.Set(type);
+        }
+      }
+
+      if (type->CanBeWay()) {
+        if (type->CanRouteCar() &&
+            type->HasFeature(NameFeature::NAME)) {
+          crossingWayTypes.Set(type);
+        }
+
+        if (type->HasFeature(NameFeature::NAME) ||
+            type->HasFeature(RefFeature::NAME)) {
+          wayTypes.Set(type);
+        }
+      }
     }
+  }
 
-    NameFeatureLabelReader                    nameFeatureLabelLeader(*typeConfig);
-    std::vector<LocationDescriptionCandicate> candidates;
+  /**
+   * Sort the candidates by their distance from the location and remove
+   * candidates that are too big or - if required - do not have a name.
+   */
+  void LocationDescriptionService::SortCandidates(std::vector<LocationDescriptionCandicate>& candidates,
+                                                  double sizeFilter,
+                                                  bool nameRequired)
+  {
+    std::sort(candidates.begin(),candidates.end(),DistanceComparator);
 
-    TypeInfoSet nameTypes;
+    candidates.erase(std::remove_if(candidates.begin(),
+                                    candidates.end(),
+                                    [sizeFilter,nameRequired](const LocationDescriptionCandicate& candidate) -> bool {
+      return (nameRequired && candidate.GetName().empty()) ||
+             candidate.GetSize()>sizeFilter;
+    }),candidates.end());
+  }
 
-    // near nameable areas, but no regions
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeArea() &&
-          type->HasFeature(NameFeature::NAME) &&
-          !type->GetIndexAsRegion() &&
-          !type->HasFeature(AdminLevelFeature::NAME)) {
-        nameTypes.Set(type);
+  /**
+   * Select the way (with name or ref) closest to the location
+   */
+  void LocationDescriptionService::SelectWay(const GeoCoord& location,
+                                             const WayRegionSearchResult& results,
+                                             DescriptionCandidates& candidates)
+  {
+    NameFeatureLabelReader nameFeatureLabelReader(*database->GetTypeConfig());
+    RefFeatureLabelReader  refFeatureLabelReader(*database->GetTypeConfig());
+    double                 minDistanceDeg=std::numeric_limits<double>::max();
+
+    for (const auto& entry : results.GetWayResults()) {
+      const WayRef& candidate=entry.GetWay();
+
+      // Skip candidates if they do no have a name
+      if (nameFeatureLabelReader.GetLabel(candidate->GetFeatureValueBuffer()).empty() &&
+          refFeatureLabelReader.GetLabel(candidate->GetFeatureValueBuffer()).empty()) {
+        continue;
+      }
+
+      for (size_t i=0; i+1<candidate->nodes.size(); i++) {
+        double r, intersectLon, intersectLat;
+        double distanceDeg = DistanceToSegment(location.GetLon(),location.GetLat(),candidate->nodes[i].GetLon(),candidate->nodes[i].GetLat(),
+                                               candidate->nodes[i+1].GetLon(),candidate->nodes[i+1].GetLat(), r, intersectLon, intersectLat);
+        if (distanceDeg < minDistanceDeg) {
+          minDistanceDeg = distanceDeg;
+          candidates.wayDistance = GetSphericalDistance(location, GeoCoord(intersectLat, intersectLon));
+          candidates.way = candidate;
+        }
       }
     }
+  }
 
-    if (!nameTypes.Empty()) {
-      AreaRegionSearchResult areaSearchResult=database->LoadAreasInRadius(location,
-                                                                          nameTypes,
-                                                                          lookupDistance);
+  /**
+   * Select the crossing of named ways closest to the location
+   */
+  void LocationDescriptionService::SelectCrossing(const GeoCoord& location,
+                                                  const WayRegionSearchResult& results,
+                                                  DescriptionCandidates& candidates)
+  {
+    NameFeatureLabelReader nameFeatureLabelReader(*database->GetTypeConfig());
+    std::vector<WayRef>    ways;
 
-      AddToCandidates(candidates,
-                      location,
-                      areaSearchResult);
+    // Skip candidates if they do no have a name
+    for (const auto& entry : results.GetWayResults()) {
+      if (!nameFeatureLabelReader.GetLabel(entry.GetWay()->GetFeatureValueBuffer()).empty()) {
+        ways.push_back(entry.GetWay());
+      }
     }
 
-    // near nameable nodes, but no regions
-    nameTypes.Clear();
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeNode() &&
-          type->HasFeature(NameFeature::NAME) &&
-          !type->GetIndexAsRegion() &&
-          !type->HasFeature(AdminLevelFeature::NAME)) {
-        nameTypes.Set(type);
+    if (ways.empty()) {
+      return;
+    }
+
+    std::map<Point,std::set<std::string>> routeNodeUseCount;
+
+    for (const auto& way : ways) {
+      for (const auto& point : way->nodes) {
+        if (point.IsRelevant()) {
+          routeNodeUseCount[point].insert(nameFeatureLabelReader.GetLabel(way->GetFeatureValueBuffer()));
+        }
       }
     }
 
-    if (!nameTypes.Empty()) {
-      NodeRegionSearchResult nodeSearchResult=database->LoadNodesInRadius(location,
-                                                                          nameTypes,
-                                                                          lookupDistance);
-      AddToCandidates(candidates,
-                      location,
-                      nodeSearchResult);
+    std::vector<Point> crossings;
+
+    crossings.reserve(routeNodeUseCount.size());
+
+    for (const auto& entry : routeNodeUseCount) {
+      if (entry.second.size()>=2) {
+        crossings.push_back(entry.first);
+      }
     }
 
-    if (candidates.empty()) {
-      return true;
+    if (crossings.empty()) {
+      return;
     }
 
-    // sort all candidates by its distance from location
-    std::sort(candidates.begin(),candidates.end(),DistanceComparator);
+    Point  candidate=Point(0,GeoCoord(0.0,0.0));
+    Distance candidateDistance=Distance::Max();
 
-    for (const auto &candidate : candidates) {
-      std::list<ReverseLookupResult> result;
+    for (const auto& entry : crossings) {
+      Distance distance=GetEllipsoidalDistance(entry.GetCoord(),location);
 
-      if (candidate.GetName().empty()) {
-        continue;
+      if (distance<candidateDistance) {
+        candidate=entry;
+        candidateDistance=distance;
       }
+    }
 
-      if (candidate.GetSize() > sizeFilter) {
-        continue;
+    candidates.crossing=candidate;
+
+    for (const auto& way : ways) {
+      for (const auto& point : way->nodes) {
+        if (candidate.IsIdentical(point)) {
+          candidates.crossingWays.push_back(way);
+        }
+      }
+    }
+  }
+
+  /**
+   * Lookup one object, using the given precalculated lookup results if possible
+   */
+  bool LocationDescriptionService::LookupObject(const ObjectFileRef& object,
+                                                const ReverseLookupResultMap* lookupResults,
+                                                std::list<ReverseLookupResult>& result) const
+  {
+    if (lookupResults!=nullptr) {
+      auto entry=lookupResults->find(object);
+
+      if (entry!=lookupResults->end()) {
+        result=entry->second;
+
+        return true;
       }
+    }
+
+    return ReverseLookupObject(object,
+                               result);
+  }
+
+  bool LocationDescriptionService::DescribeLocationByName(const DescriptionCandidates& candidates,
+                                                          const ReverseLookupResultMap* lookupResults,
+                                                          LocationDescription& description)
+  {
+    for (const auto &candidate : candidates.nameCandidates) {
+      std::list<ReverseLookupResult> result;
 
-      if (!ReverseLookupObject(candidate.GetRef(),
-                               result)) {
+      if (!LookupObject(candidate.GetRef(),
+                        lookupResults,
+                        result)) {
         return false;
       }
 
@@ -895,7 +1023,7 @@ namespace osmscout {
 
         return true;
       }
-      else if (!candidate.GetName().empty()) {
+      else {
         AdminRegionRef adminRegion;
         PostalAreaRef  postalArea;
         POIRef         poi=std::make_shared<POI>();
@@ -930,72 +1058,59 @@ namespace osmscout {
     return true;
   }
 
-  bool LocationDescriptionService::DescribeLocationByAddress(const GeoCoord& location,
-                                                             LocationDescription& description,
-                                                             const Distance& lookupDistance,
-                                                             const double sizeFilter)
+  bool LocationDescriptionService::DescribeLocationByName(const GeoCoord& location,
+                                                          LocationDescription& description,
+                                                          const Distance& lookupDistance,
+                                                          const double sizeFilter)
   {
-    // search all addressable areas and nodes, sort it by distance, get first with address
+
+    // search all nameable areas and nodes, sort it by distance, get first with name
     TypeConfigRef typeConfig=database->GetTypeConfig();
 
     if (!typeConfig) {
       return false;
     }
 
-    std::vector<LocationDescriptionCandicate> candidates;
-
-    TypeInfoSet addressTypes;
-
-    // near addressable areas
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeArea() &&
-          type->GetIndexAsAddress()) {
-        addressTypes.Set(type);
-      }
-    }
+    DescriptionTypes      types(*typeConfig);
+    DescriptionCandidates candidates;
 
-    if (!addressTypes.Empty()) {
+    // near nameable areas, but no regions
+    if (!types.nameAreaTypes.Empty()) {
       AreaRegionSearchResult areaSearchResult=database->LoadAreasInRadius(location,
-                                                                          addressTypes,
+                                                                          types.nameAreaTypes,
                                                                           lookupDistance);
 
-      AddToCandidates(candidates,
+      AddToCandidates(candidates.nameCandidates,
                       location,
                       areaSearchResult);
     }
 
-    // near addressable nodes
-    addressTypes.Clear();
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeNode() &&
-          type->GetIndexAsAddress()) {
-        addressTypes.Set(type);
-      }
-    }
-
-    if (!addressTypes.Empty()) {
+    // near nameable nodes, but no regions
+    if (!types.nameNodeTypes.Empty()) {
       NodeRegionSearchResult nodeSearchResult=database->LoadNodesInRadius(location,
-                                                                          addressTypes,
+                                                                          types.nameNodeTypes,
                                                                           lookupDistance);
-      AddToCandidates(candidates,
+      AddToCandidates(candidates.nameCandidates,
                       location,
                       nodeSearchResult);
     }
 
-    if (candidates.empty()) {
-      return true;
-    }
+    SortCandidates(candidates.nameCandidates,
+                   sizeFilter,
+                   true);
 
-    // sort all candidates by its distance from location
-    std::sort(candidates.begin(),candidates.end(),DistanceComparator);
-
-    for (const auto &candidate : candidates) {
-      if (candidate.GetSize()>sizeFilter) {
-        continue;
-      }
+    return DescribeLocationByName(candidates,
+                                  nullptr,
+                                  description);
+  }
 
+  bool LocationDescriptionService::DescribeLocationByAddress(const DescriptionCandidates& candidates,
+                                                             const ReverseLookupResultMap* lookupResults,
+                                                             LocationDescription& description)
+  {
+    for (const auto &candidate : candidates.addressCandidates) {
       std::list<ReverseLookupResult> result;
-      if (!ReverseLookupObject(candidate.GetRef(), result)) {
+      if (!LookupObject(candidate.GetRef(), lookupResults, result)) {
         return false;
       }
 
@@ -1020,10 +1135,10 @@ namespace osmscout {
     return true;
   }
 
-  bool LocationDescriptionService::DescribeLocationByPOI(const GeoCoord& location,
-                                                         LocationDescription& description,
-                                                         const Distance& lookupDistance,
-                                                         const double sizeFilter)
+  bool LocationDescriptionService::DescribeLocationByAddress(const GeoCoord& location,
+                                                             LocationDescription& description,
+                                                             const Distance& lookupDistance,
+                                                             const double sizeFilter)
   {
     // search all addressable areas and nodes, sort it by distance, get first with address
     TypeConfigRef typeConfig=database->GetTypeConfig();
@@ -1032,59 +1147,46 @@ namespace osmscout {
       return false;
     }
 
-    std::vector<LocationDescriptionCandicate> candidates;
-
-    TypeInfoSet poiTypes;
+    DescriptionTypes      types(*typeConfig);
+    DescriptionCandidates candidates;
 
     // near addressable areas
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeArea() &&
-          type->GetIndexAsPOI()) {
-        poiTypes.Set(type);
-      }
-    }
-
-    if (!poiTypes.Empty()) {
+    if (!types.addressAreaTypes.Empty()) {
       AreaRegionSearchResult areaSearchResult=database->LoadAreasInRadius(location,
-                                                                          poiTypes,
+                                                                          types.addressAreaTypes,
                                                                           lookupDistance);
 
-      AddToCandidates(candidates,
+      AddToCandidates(candidates.addressCandidates,
                       location,
                       areaSearchResult);
     }
 
     // near addressable nodes
-    poiTypes.Clear();
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeNode() &&
-          type->GetIndexAsPOI()) {
-        poiTypes.Set(type);
-      }
-    }
-    if (!poiTypes.Empty()) {
+    if (!types.addressNodeTypes.Empty()) {
       NodeRegionSearchResult nodeSearchResult=database->LoadNodesInRadius(location,
-                                                                          poiTypes,
+                                                                          types.addressNodeTypes,
                                                                           lookupDistance);
-      AddToCandidates(candidates,
+      AddToCandidates(candidates.addressCandidates,
                       location,
                       nodeSearchResult);
     }
 
-    if (candidates.empty()) {
-      return true;
-    }
-
-    // sort all candidates by its distance from location
-    std::sort(candidates.begin(),candidates.end(),DistanceComparator);
+    SortCandidates(candidates.addressCandidates,
+                   sizeFilter,
+                   false);
 
-    for (const auto &candidate : candidates) {
-      if (candidate.GetSize() > sizeFilter){
-        continue;
-      }
+    return DescribeLocationByAddress(candidates,
+                                     nullptr,
+                                     description);
+  }
 
+  bool LocationDescriptionService::DescribeLocationByPOI(const DescriptionCandidates& candidates,
+                                                         const ReverseLookupResultMap* lookupResults,
+                                                         LocationDescription& description)
+  {
+    for (const auto &candidate : candidates.poiCandidates) {
       std::list<ReverseLookupResult> result;
-      if (!ReverseLookupObject(candidate.GetRef(), result)) {
+      if (!LookupObject(candidate.GetRef(), lookupResults, result)) {
         return false;
       }
 
@@ -1106,113 +1208,68 @@ namespace osmscout {
     return true;
   }
 
-  /**
-   * Returns crossings (of roads that can be driven by cars and which have a name feature)
-   *
-   * @param location
-   *    Location to search for the closest crossing
-   * @param description
-   *    The description returned
-   * @param lookupDistance
-   *    The range to look in
-   * @return
-   */
-  bool LocationDescriptionService::DescribeLocationByCrossing(const GeoCoord& location,
-                                                              LocationDescription& description,
-                                                              const Distance& lookupDistance)
+  bool LocationDescriptionService::DescribeLocationByPOI(const GeoCoord& location,
+                                                         LocationDescription& description,
+                                                         const Distance& lookupDistance,
+                                                         const double sizeFilter)
   {
-    TypeConfigRef          typeConfig=database->GetTypeConfig();
-    NameFeatureLabelReader nameFeatureLabelReader(*typeConfig);
+    // search all POI areas and nodes, sort it by distance, get first with POI data
+    TypeConfigRef typeConfig=database->GetTypeConfig();
 
     if (!typeConfig) {
       return false;
     }
 
-    std::vector<WayRef> candidates;
-
-    TypeInfoSet wayTypes;
-
-    // near addressable ways
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeWay() &&
-          type->CanRouteCar() &&
-          type->HasFeature(NameFeature::NAME)) {
-        wayTypes.Set(type);
-      }
-    }
-
-    if (!wayTypes.Empty()) {
-      WayRegionSearchResult waySearchResult=database->LoadWaysInRadius(location,
-                                                                       wayTypes,
-                                                                       lookupDistance);
+    DescriptionTypes      types(*typeConfig);
+    DescriptionCandidates candidates;
 
-      for (const auto& entry : waySearchResult.GetWayResults()) {
-        candidates.push_back(entry.GetWay());
-      }
-    }
-
-    // Remove candidates if they do no have a name
-    candidates.erase(std::remove_if(candidates.begin(),candidates.end(),[&nameFeatureLabelReader](const WayRef& candidate) -> bool {
-      return nameFeatureLabelReader.GetLabel(candidate->GetFeatureValueBuffer()).empty();
-    }),candidates.end());
+    // near POI areas
+    if (!types.poiAreaTypes.Empty()) {
+      AreaRegionSearchResult areaSearchResult=database->LoadAreasInRadius(location,
+                                                                          types.poiAreaTypes,
+                                                                          lookupDistance);
 
-    if (candidates.empty()) {
-      return true;
+      AddToCandidates(candidates.poiCandidates,
+                      location,
+                      areaSearchResult);
     }
 
-    std::map<Point,std::set<std::string>> routeNodeUseCount;
-
-    for (const auto& candidate : candidates) {
-      for (const auto& point : candidate->nodes) {
-        if (point.IsRelevant()) {
-          routeNodeUseCount[point].insert(nameFeatureLabelReader.GetLabel(candidate->GetFeatureValueBuffer()));
-        }
-      }
+    // near POI nodes
+    if (!types.poiNodeTypes.Empty()) {
+      NodeRegionSearchResult nodeSearchResult=database->LoadNodesInRadius(location,
+                                                                          types.poiNodeTypes,
+                                                                          lookupDistance);
+      AddToCandidates(candidates.poiCandidates,
+                      location,
+                      nodeSearchResult);
     }
 
-    std::vector<Point> crossings;
-
-    crossings.reserve(routeNodeUseCount.size());
+    SortCandidates(candidates.poiCandidates,
+                   sizeFilter,
+                   false);
 
-    for (const auto& entry : routeNodeUseCount) {
-      if (entry.second.size()>=2) {
-        crossings.push_back(entry.first);
-      }
-    }
+    return DescribeLocationByPOI(candidates,
+                                 nullptr,
+                                 description);
+  }
 
-    if (crossings.empty()) {
+  bool LocationDescriptionService::DescribeLocationByCrossing(const GeoCoord& location,
+                                                              const DescriptionCandidates& candidates,
+                                                              const ReverseLookupResultMap* lookupResults,
+                                                              LocationDescription& description)
+  {
+    if (candidates.crossingWays.empty()) {
       return true;
     }
 
-    Point  candidate=Point(0,GeoCoord(0.0,0.0));
-    Distance candidateDistance=Distance::Max();
-
-    for (const auto& entry : crossings) {
-      Distance distance=GetEllipsoidalDistance(entry.GetCoord(),location);
-
-      if (distance<candidateDistance) {
-        candidate=entry;
-        candidateDistance=distance;
-      }
-    }
-
-    std::list<WayRef> crossingWays;
-
-    for (const auto& way : candidates) {
-      for (const auto& point : way->nodes) {
-        if (candidate.IsIdentical(point)) {
-          crossingWays.push_back(way);
-        }
-      }
-    }
-
     std::list<Place> places;
 
-    for (const auto& way : crossingWays) {
+    for (const auto& way : candidates.crossingWays) {
       std::list<ReverseLookupResult> result;
 
-      if (!ReverseLookupObject(way->GetObjectFileRef(),
-                               result)) {
+      if (!LookupObject(way->GetObjectFileRef(),
+                        lookupResults,
+                        result)) {
         return false;
       }
 
@@ -1221,17 +1278,17 @@ namespace osmscout {
 
     LocationCrossingDescriptionRef crossingDescription;
 
-    if (candidate.GetCoord()==location) {
-      crossingDescription=std::make_shared<LocationCrossingDescription>(candidate.GetCoord(),
+    if (candidates.crossing.GetCoord()==location) {
+      crossingDescription=std::make_shared<LocationCrossingDescription>(candidates.crossing.GetCoord(),
                                                                         places);
     }
     else {
       Distance distance=GetEllipsoidalDistance(location,
-                                               candidate.GetCoord());
-      auto bearing=GetSphericalBearingInitial(candidate.GetCoord(),
+                                               candidates.crossing.GetCoord());
+      auto bearing=GetSphericalBearingInitial(candidates.crossing.GetCoord(),
                                               location);
 
-      crossingDescription=std::make_shared<LocationCrossingDescription>(candidate.GetCoord(),
+      crossingDescription=std::make_shared<LocationCrossingDescription>(candidates.crossing.GetCoord(),
                                                                         places,
                                                                         distance,
                                                                         bearing);
@@ -1243,82 +1300,56 @@ namespace osmscout {
   }
 
   /**
-   * Returns ways (roads that can be driven by cars and which have a name feature)
+   * Returns crossings (of roads that can be driven by cars and which have a name feature)
    *
    * @param location
-   *    Location to search for the closest ways
+   *    Location to search for the closest crossing
    * @param description
    *    The description returned
    * @param lookupDistance
    *    The range to look in
    * @return
    */
-  bool LocationDescriptionService::DescribeLocationByWay(const GeoCoord& location,
-                                                         LocationDescription& description,
-                                                         const Distance& lookupDistance)
+  bool LocationDescriptionService::DescribeLocationByCrossing(const GeoCoord& location,
+                                                              LocationDescription& description,
+                                                              const Distance& lookupDistance)
   {
-    TypeConfigRef          typeConfig=database->GetTypeConfig();
-    NameFeatureLabelReader nameFeatureLabelReader(*typeConfig);
-    RefFeatureLabelReader  refFeatureLabelReader(*typeConfig);
+    TypeConfigRef typeConfig=database->GetTypeConfig();
 
     if (!typeConfig) {
       return false;
     }
 
-    std::vector<WayRef> candidates;
-
-    TypeInfoSet wayTypes;
+    DescriptionTypes      types(*typeConfig);
+    DescriptionCandidates candidates;
 
     // near addressable ways
-    for (const auto& type : typeConfig->GetTypes()) {
-      if (type->CanBeWay() &&
-        (type->HasFeature(NameFeature::NAME) ||
-         type->HasFeature(RefFeature::NAME))) {
-        wayTypes.Set(type);
-      }
-    }
-
-    if (!wayTypes.Empty()) {
+    if (!types.crossingWayTypes.Empty()) {
       WayRegionSearchResult waySearchResult=database->LoadWaysInRadius(location,
-                                                                       wayTypes,
+                                                                       types.crossingWayTypes,
                                                                        lookupDistance);
 
-      for (const auto& entry : waySearchResult.GetWayResults()) {
-        candidates.push_back(entry.GetWay());
-      }
-
+      SelectCrossing(location,
+                     waySearchResult,
+                     candidates);
     }
 
-    // Remove candidates if they do no have a name
-    candidates.erase(std::remove_if(candidates.begin(),
-                                    candidates.end(),
-                                    [&nameFeatureLabelReader,&refFeatureLabelReader](const WayRef& candidate) -> bool {
-      return nameFeatureLabelReader.GetLabel(candidate->GetFeatureValueBuffer()).empty() &&
-             refFeatureLabelReader.GetLabel(candidate->GetFeatureValueBuffer()).empty();
-    }),candidates.end());
+    return DescribeLocationByCrossing(location,
+                                      candidates,
+                                      nullptr,
+                                      description);
+  }
 
-    if (candidates.empty()) {
+  bool LocationDescriptionService::DescribeLocationByWay(const DescriptionCandidates& candidates,
+                                                         const ReverseLookupResultMap* lookupResults,
+                                                         LocationDescription& description)
+  {
+    if (!candidates.way) {
       return true;
     }
 
-    WayRef way;
-    double minDistanceDeg = std::numeric_limits<double>::max();
-    Distance minDistance = Distance::Max();
-    for (const auto& candidate : candidates) {
-      for (size_t i = 0;  i < candidate->nodes.size() - 1; i++) {
-        double r, intersectLon, intersectLat;
-        double distanceDeg = DistanceToSegment(location.GetLon(),location.GetLat(),candidate->nodes[i].GetLon(),candidate->nodes[i].GetLat(),
-                                               candidate->nodes[i+1].GetLon(),candidate->nodes[i+1].GetLat(), r, intersectLon, intersectLat);
-        if (distanceDeg < minDistanceDeg) {
-          minDistanceDeg = distanceDeg;
-          minDistance = GetSphericalDistance(location, GeoCoord(intersectLat, intersectLon));
-          way = candidate;
-        }
-      }
-    }
-
     std::list<ReverseLookupResult> result;
-    if (!ReverseLookupObject(way->GetObjectFileRef(), result)) {
+    if (!LookupObject(candidates.way->GetObjectFileRef(), lookupResults, result)) {
       return false;
     }
 
@@ -1327,13 +1358,53 @@ namespace osmscout {
     }
 
     Place place = GetPlace(result);
-    LocationWayDescriptionRef wayDescription=std::make_shared<LocationWayDescription>(place, minDistance);
+    LocationWayDescriptionRef wayDescription=std::make_shared<LocationWayDescription>(place, candidates.wayDistance);
 
     description.SetWayDescription(wayDescription);
 
     return true;
   }
 
+  /**
+   * Returns ways (roads that can be driven by cars and which have a name feature)
+   *
+   * @param location
+   *    Location to search for the closest ways
+   * @param description
+   *    The description returned
+   * @param lookupDistance
+   *    The range to look in
+   * @return
+   */
+  bool LocationDescriptionService::DescribeLocationByWay(const GeoCoord& location,
+                                                         LocationDescription& description,
+                                                         const Distance& lookupDistance)
+  {
+    TypeConfigRef typeConfig=database->GetTypeConfig();
+
+    if (!typeConfig) {
+      return false;
+    }
+
+    DescriptionTypes      types(*typeConfig);
+    DescriptionCandidates candidates;
+
+    // near addressable ways
+    if (!types.wayTypes.Empty()) {
+      WayRegionSearchResult waySearchResult=database->LoadWaysInRadius(location,
+                                                                       types.wayTypes,
+                                                                       lookupDistance);
+
+      SelectWay(location,
+                waySearchResult,
+                candidates);
+    }
+
+    return DescribeLocationByWay(candidates,
+                                 nullptr,
+                                 description);
+  }
+
   bool LocationDescriptionService::DescribeLocation(const GeoCoord& location,
                                                     LocationDescription& description,
                                                     const Distance& lookupDistance,
@@ -1373,4 +1444,331 @@ namespace osmscout {
                                       lookupDistance);
 
   }
+
+  /**
+   * Objects of a tile together with their bounding boxes
+   */
+  template<class R>
+  class TileObjects
+  {
+  private:
+    std::vector<R>      objects;
+    std::vector<GeoBox> boundingBoxes;
+
+  public:
+    void Add(const R& object,
+             const GeoBox& boundingBox)
+    {
+      objects.push_back(object);
+      boundingBoxes.push_back(boundingBox);
+    }
+
+    /**
+     * Return all objects, that intersect the given bounding box
+     */
+    std::vector<R> GetObjects(const GeoBox& boundingBox) const
+    {
+      std::vector<R> result;
+
+      for (size_t i=0; i<objects.size(); i++) {
+        if (boundingBoxes[i].Intersects(boundingBox,false)) {
+          result.push_back(objects[i]);
+        }
+      }
+
+      return result;
+    }
+  };
+
+  static TileObjects<NodeRef> LoadTileNodes(Database& database,
+                                            const TypeInfoSet& types,
+                                            const GeoBox& boundingBox)
+  {
+    TileObjects<NodeRef> result;
+
+    if (!types.Empty()) {
+      for (const auto& entry : database.LoadNodesInArea(types,boundingBox).GetNodeResults()) {
+        result.Add(entry.GetNode(),
+                   GeoBox(entry.GetNode()->GetCoords(),
+                          entry.GetNode()->GetCoords()));
+      }
+    }
+
+    return result;
+  }
+
+  static TileObjects<WayRef> LoadTileWays(Database& database,
+                                          const TypeInfoSet& types,
+                                          const GeoBox& boundingBox)
+  {
+    TileObjects<WayRef> result;
+
+    if (!types.Empty()) {
+      for (const auto& entry : database.LoadWaysInArea(types,boundingBox).GetWayResults()) {
+        result.Add(entry.GetWay(),
+                   entry.GetWay()->GetBoundingBox());
+      }
+    }
+
+    return result;
+  }
+
+  static TileObjects<AreaRef> LoadTileAreas(Database& database,
+                                            const TypeInfoSet& types,
+                                            const GeoBox& boundingBox)
+  {
+    TileObjects<AreaRef> result;
+
+    if (!types.Empty()) {
+      for (const auto& entry : database.LoadAreasInArea(types,boundingBox).GetAreaResults()) {
+        result.Add(entry.GetArea(),
+                   entry.GetArea()->GetBoundingBox());
+      }
+    }
+
+    return result;
+  }
+
+  /**
+   * Describe the given locations of one tile. Objects are loaded once for all
+   * locations and all candidate objects are reverse looked up at once.
+   *
+   * @return
+   *    False, if at least one location could not be described
+   */
+  bool LocationDescriptionService::DescribeLocationsInTile(const DescriptionTypes& types,
+                                                           const std::vector<GeoCoord>& locations,
+                                                           const std::vector<size_t>& indexes,
+                                                           std::vector<LocationDescription>& descriptions,
+                                                           const Distance& lookupDistance,
+                                                           double sizeFilter)
+  {
+    std::vector<GeoBox> lookupBoxes;
+    GeoBox              boundingBox;
+
+    lookupBoxes.reserve(indexes.size());
+
+    for (const auto index : indexes) {
+      lookupBoxes.push_back(GeoBox::BoxAroundCircle(locations[index],
+                                                    lookupDistance));
+      boundingBox.Include(lookupBoxes.back());
+    }
+
+    TileObjects<AreaRef> nameAreas=LoadTileAreas(*database,types.nameAreaTypes,boundingBox);
+    TileObjects<NodeRef> nameNodes=LoadTileNodes(*database,types.nameNodeTypes,boundingBox);
+    TileObjects<AreaRef> addressAreas=LoadTileAreas(*database,types.addressAreaTypes,boundingBox);
+    TileObjects<NodeRef> addressNodes=LoadTileNodes(*database,types.addressNodeTypes,boundingBox);
+    TileObjects<AreaRef> poiAreas=LoadTileAreas(*database,types.poiAreaTypes,boundingBox);
+    TileObjects<NodeRef> poiNodes=LoadTileNodes(*database,types.poiNodeTypes,boundingBox);
+    TileObjects<WayRef>  crossingWays=LoadTileWays(*database,types.crossingWayTypes,boundingBox);
+    TileObjects<WayRef>  ways=LoadTileWays(*database,types.wayTypes,boundingBox);
+
+    std::vector<DescriptionCandidates> candidates(indexes.size());
+    std::set<ObjectFileRef>            objects;
+
+    for (size_t i=0; i<indexes.size(); i++) {
+      const GeoCoord&        location=locations[indexes[i]];
+      const GeoBox&          lookupBox=lookupBoxes[i];
+      DescriptionCandidates& locationCandidates=candidates[i];
+
+      AddToCandidates(locationCandidates.nameCandidates,
+                      location,
+                      Database::FilterAreasInRadius(location,nameAreas.GetObjects(lookupBox),lookupDistance));
+      AddToCandidates(locationCandidates.nameCandidates,
+                      location,
+                      Database::FilterNodesInRadius(location,nameNodes.GetObjects(lookupBox),lookupDistance));
+      SortCandidates(locationCandidates.nameCandidates,
+                     sizeFilter,
+                     true);
+
+      AddToCandidates(locationCandidates.addressCandidates,
+                      location,
+                      Database::FilterAreasInRadius(location,addressAreas.GetObjects(lookupBox),lookupDistance));
+      AddToCandidates(locationCandidates.addressCandidates,
+                      location,
+                      Database::FilterNodesInRadius(location,addressNodes.GetObjects(lookupBox),lookupDistance));
+      SortCandidates(locationCandidates.addressCandidates,
+                     sizeFilter,
+                     false);
+
+      AddToCandidates(locationCandidates.poiCandidates,
+                      location,
+                      Database::FilterAreasInRadius(location,poiAreas.GetObjects(lookupBox),lookupDistance));
+      AddToCandidates(locationCandidates.poiCandidates,
+                      location,
+                      Database::FilterNodesInRadius(location,poiNodes.GetObjects(lookupBox),lookupDistance));
+      SortCandidates(locationCandidates.poiCandidates,
+                     sizeFilter,
+                     false);
+
+      SelectWay(location,
+                Database::FilterWaysInRadius(location,ways.GetObjects(lookupBox),lookupDistance),
+                locationCandidates);
+      SelectCrossing(location,
+                     Database::FilterWaysInRadius(location,crossingWays.GetObjects(lookupBox),lookupDistance),
+                     locationCandidates);
+
+      for (const auto& candidate : locationCandidates.nameCandidates) {
+        objects.insert(candidate.GetRef());
+      }
+
+      for (const auto& candidate : locationCandidates.addressCandidates) {
+        objects.insert(candidate.GetRef());
+      }
+
+      for (const auto& candidate : locationCandidates.poiCandidates) {
+        objects.insert(candidate.GetRef());
+      }
+
+      if (locationCandidates.way) {
+        objects.insert(locationCandidates.way->GetObjectFileRef());
+      }
+
+      for (const auto& way : locationCandidates.crossingWays) {
+        objects.insert(way->GetObjectFileRef());
+      }
+    }
+
+    // A single reverse lookup for all candidates of the tile
+    ReverseLookupResultMap lookupResults;
+
+    if (!objects.empty()) {
+      std::list<ObjectFileRef>       objectList(objects.begin(),objects.end());
+      std::list<ReverseLookupResult> results;
+
+      if (!ReverseLookupObjects(objectList,
+                                results)) {
+        return false;
+      }
+
+      for (const auto& object : objectList) {
+        lookupResults[object];
+      }
+
+      for (const auto& result : results) {
+        lookupResults[result.object].push_back(result);
+      }
+    }
+
+    bool success=true;
+
+    for (size_t i=0; i<indexes.size(); i++) {
+      const GeoCoord&        location=locations[indexes[i]];
+      LocationDescription&   description=descriptions[indexes[i]];
+
+      description.SetCoordDescription(std::make_shared<LocationCoordDescription>(location));
+
+      if (!DescribeLocationByName(candidates[i],&lookupResults,description) ||
+          !DescribeLocationByAddress(candidates[i],&lookupResults,description) ||
+          !DescribeLocationByPOI(candidates[i],&lookupResults,description) ||
+          !DescribeLocationByWay(candidates[i],&lookupResults,description) ||
+          !DescribeLocationByCrossing(location,candidates[i],&lookupResults,description)) {
+        success=false;
+      }
+    }
+
+    return success;
+  }
+
+  /**
+   * Describe a batch of locations, returning the same descriptions as
+   * calling DescribeLocation for each location.
+   *
+   * Locations are grouped by tile. Objects close to the locations of a tile
+   * are loaded and reverse looked up once and shared by all locations of the
+   * tile. Tiles are processed in parallel.
+   *
+   * @param locations
+   *    Locations to describe
+   * @param descriptions
+   *    One description for each location, in the order of the locations
+   * @param lookupDistance
+   *    The range to look in
+   * @param sizeFilter
+   *    Maximum size of places used for the description
+   * @param threadCount
+   *    Number of threads to use, 0 for one thread per core
+   * @return
+   *    False, if at least one location could not be described. Descriptions
+   *    of the other locations are valid nevertheless.
+   */
+  bool LocationDescriptionService::DescribeLocations(const std::vector<GeoCoord>& locations,
+                                                     std::vector<LocationDescription>& descriptions,
+                                                     const Distance& lookupDistance,
+                                                     double sizeFilter,
+                                                     size_t threadCount)
+  {
+    TypeConfigRef typeConfig=database->GetTypeConfig();
+
+    descriptions.clear();
+    descriptions.resize(locations.size());
+
+    if (!typeConfig) {
+      return false;
+    }
+
+    DescriptionTypes                     types(*typeConfig);
+    std::map<TileId,std::vector<size_t>> tileLocations;
+
+    for (size_t i=0; i<locations.size(); i++) {
+      tileLocations[TileId::GetTile(batchTileLevel,locations[i])].push_back(i);
+    }
+
+    std::vector<std::vector<size_t>> tiles;
+
+    tiles.reserve(tileLocations.size());
+
+    for (auto& entry : tileLocations) {
+      tiles.push_back(std::move(entry.second));
+    }
+
+    if (threadCount==0) {
+      threadCount=std::max((unsigned int)1,std::thread::hardware_concurrency());
+    }
+
+    threadCount=std::min(threadCount,tiles.size());
+
+    std::atomic<size_t> nextTile(0);
+    std::atomic<bool>   success(true);
+
+    auto worker=[&]() {
+      size_t tileIndex;
+
+      while ((tileIndex=nextTile++)<tiles.size()) {
+        try {
+          if (!DescribeLocationsInTile(types,
+                                       locations,
+                                       tiles[tileIndex],
+                                       descriptions,
+                                       lookupDistance,
+                                       sizeFilter)) {
+            success=false;
+          }
+        }
+        catch (const OSMScoutException& e) {
+          log.Error() << "Cannot describe locations: " << e.GetDescription();
+          success=false;
+        }
+      }
+    };
+
+    if (threadCount<=1) {
+      worker();
+    }
+    else {
+      std::vector<std::thread> threads;
+
+      threads.reserve(threadCount);
+
+      for (size_t t=0; t<threadCount; t++) {
+        threads.emplace_back(worker);
+      }
+
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    }
+
+    return success;
+  }
 }
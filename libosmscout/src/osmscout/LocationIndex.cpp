@@ -98,6 +98,18 @@ namespace osmscout {
 
       scanner.Close();
 
+      regionRaster.reset();
+
+      // The region raster is optional, older databases do not have it
+      if (ExistsInFilesystem(AppendFileToDir(path,
+                                             RegionRasterIndex::REGIONRASTER_IDX))) {
+        regionRaster=std::make_shared<RegionRasterIndex>();
+
+        if (!regionRaster->Open(path)) {
+          return false;
+        }
+      }
+
       return true;
     }
     catch (IOException& e) {
@@ -795,6 +807,50 @@ namespace osmscout {
     }
   }
 
+  bool LocationIndex::LoadAdminRegions(const std::vector<FileOffset>& offsets,
+                                       std::vector<AdminRegionRef>& regions) const
+  {
+    FileScanner scanner;
+
+    regions.clear();
+
+    if (offsets.empty()) {
+      return true;
+    }
+
+    try {
+      scanner.Open(AppendFileToDir(path,
+                                   FILENAME_LOCATION_IDX),
+                   FileScanner::LowMemRandom,
+                   true);
+
+      regions.reserve(offsets.size());
+
+      for (const auto& offset : offsets) {
+        AdminRegionRef region=std::make_shared<AdminRegion>();
+
+        scanner.SetPos(offset);
+
+        if (!LoadAdminRegion(scanner,
+                             *region)) {
+          scanner.Close();
+          return false;
+        }
+
+        regions.push_back(region);
+      }
+
+      scanner.Close();
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+      return false;
+    }
+  }
+
   bool LocationIndex::ResolveAdminRegionHierachie(const AdminRegionRef& adminRegion,
                                                   std::map<FileOffset,AdminRegionRef >& refs) const
   {
@@ -20,6 +20,7 @@
 #include <osmscout/LocationService.h>
 
 #include <algorithm>
+#include <set>
 
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
@@ -587,6 +588,172 @@ namespace osmscout {
                                                       refs);
   }
 
+  /**
+   * Returns true, if the given coordinate is within one of the top outer rings of the
+   * area of the region
+   */
+  static bool IsCoordInAdminRegion(const Database& database,
+                                   const AdminRegion& region,
+                                   const GeoCoord& coord,
+                                   bool& contained)
+  {
+    AreaRef area;
+
+    contained=false;
+
+    if (!database.GetAreaByOffset(region.object.GetFileOffset(),
+                                  area)) {
+      return false;
+    }
+
+    for (const auto& ring : area->rings) {
+      if (ring.IsTopOuter() &&
+          IsCoordInArea(coord,
+                        ring.nodes)) {
+        contained=true;
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Collects all regions containing the given coordinate. Sub regions are only
+   * visited, if their parent region contains the coordinate.
+   */
+  class AdminRegionContainmentVisitor : public AdminRegionVisitor
+  {
+  private:
+    const Database& database;
+    GeoCoord        coord;
+
+  public:
+    std::list<AdminRegionRef> regions;
+
+  public:
+    AdminRegionContainmentVisitor(const Database& database,
+                                  const GeoCoord& coord)
+    : database(database),
+      coord(coord)
+    {
+      // no code
+    }
+
+    Action Visit(const AdminRegion& region) override
+    {
+      bool contained;
+
+      if (!IsCoordInAdminRegion(database,
+                                region,
+                                coord,
+                                contained)) {
+        return error;
+      }
+
+      if (!contained) {
+        return skipChildren;
+      }
+
+      regions.push_back(std::make_shared<AdminRegion>(region));
+
+      return visitChildren;
+    }
+  };
+
+  /**
+   * Retrieve all admin regions containing the given coordinate.
+   *
+   * If the database has a region raster, only regions whose boundary crosses the
+   * raster cell of the coordinate are checked against their area. Else the region
+   * tree is traversed and the areas of all candidate regions are checked.
+   *
+   * @param coord
+   *    The coordinate
+   * @param regions
+   *    The regions containing the coordinate, parent regions before their children
+   * @return
+   *    True, if there was no error
+   */
+  bool LocationService::ReverseLookupRegion(const GeoCoord& coord,
+                                            std::list<AdminRegionRef>& regions) const
+  {
+    regions.clear();
+
+    LocationIndexRef locationIndex=database->GetLocationIndex();
+
+    if (!locationIndex) {
+      return false;
+    }
+
+    RegionRasterIndexRef regionRaster=locationIndex->GetRegionRaster();
+
+    if (!regionRaster) {
+      AdminRegionContainmentVisitor visitor(*database,
+                                            coord);
+
+      if (!locationIndex->VisitAdminRegions(visitor)) {
+        return false;
+      }
+
+      regions=std::move(visitor.regions);
+      regions.sort([](const AdminRegionRef& a, const AdminRegionRef& b) {
+        return a->regionOffset<b->regionOffset;
+      });
+
+      return true;
+    }
+
+    std::vector<RegionRasterIndex::Entry> candidates;
+    std::vector<FileOffset>               offsets;
+    std::vector<AdminRegionRef>           candidateRegions;
+
+    regionRaster->GetCandidates(coord,
+                                candidates);
+
+    offsets.reserve(candidates.size());
+
+    for (const auto& candidate : candidates) {
+      offsets.push_back(candidate.regionOffset);
+    }
+
+    if (!locationIndex->LoadAdminRegions(offsets,
+                                         candidateRegions)) {
+      return false;
+    }
+
+    std::set<FileOffset> containingOffsets;
+
+    for (size_t i=0; i<candidates.size(); i++) {
+      // Like the traversal of the region tree, sub regions are only returned if their parent
+      // region contains the coordinate, too. Parents are always returned before their children.
+      if (candidateRegions[i]->parentRegionOffset!=0 &&
+          containingOffsets.find(candidateRegions[i]->parentRegionOffset)==containingOffsets.end()) {
+        continue;
+      }
+
+      if (candidates[i].boundary) {
+        bool contained;
+
+        if (!IsCoordInAdminRegion(*database,
+                                  *candidateRegions[i],
+                                  coord,
+                                  contained)) {
+          return false;
+        }
+
+        if (!contained) {
+          continue;
+        }
+      }
+
+      containingOffsets.insert(candidateRegions[i]->regionOffset);
+      regions.push_back(candidateRegions[i]);
+    }
+
+    return true;
+  }
+
   /**
    * Visit the location at the given region and all its sub regions.
    * @param region
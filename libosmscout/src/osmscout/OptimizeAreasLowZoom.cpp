@@ -30,6 +30,7 @@
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 #include <osmscout/util/Transformation.h>
 
 namespace osmscout
@@ -281,6 +282,8 @@ namespace osmscout
                                       std::vector<AreaRef>& areas,
                                       TypeInfoSet& loadedAreaTypes) const
   {
+    OSMSCOUT_TRACE_SCOPE("OptimizeAreasLowZoom","GetAreas");
+
     StopClock            time;
     std::set<FileOffset> offsets;
 
@@ -30,6 +30,7 @@
 #include <osmscout/util/Projection.h>
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
+#include <osmscout/util/Tracing.h>
 #include <osmscout/util/Transformation.h>
 
 namespace osmscout
@@ -283,6 +284,8 @@ namespace osmscout
                                     std::vector<WayRef>& ways,
                                     TypeInfoSet& loadedWayTypes) const
   {
+    OSMSCOUT_TRACE_SCOPE("OptimizeWaysLowZoom","GetWays");
+
     StopClock            time;
     std::set<FileOffset> offsets;
 
@@ -0,0 +1,164 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/RegionRasterIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const char* const RegionRasterIndex::REGIONRASTER_IDX="regionraster.idx";
+
+  bool RegionRasterIndex::Open(const std::string& path)
+  {
+    FileScanner scanner;
+
+    try {
+      scanner.Open(AppendFileToDir(path,REGIONRASTER_IDX),
+                   FileScanner::Sequential,
+                   false);
+
+      scanner.Read(cellLevel);
+
+      double cellMagnification=std::pow(2.0,cellLevel);
+
+      cellWidth=360.0/cellMagnification;
+      cellHeight=180.0/cellMagnification;
+      scanner.Read(minCell.x);
+      scanner.Read(minCell.y);
+      scanner.Read(maxCell.x);
+      scanner.Read(maxCell.y);
+
+      uint32_t listCount;
+
+      scanner.ReadNumber(listCount);
+
+      listOffsets.clear();
+      listOffsets.reserve(listCount+1);
+      entries.clear();
+
+      for (uint32_t l=0; l<listCount; l++) {
+        uint32_t entryCount;
+
+        scanner.ReadNumber(entryCount);
+
+        listOffsets.push_back((uint32_t)entries.size());
+
+        for (uint32_t e=0; e<entryCount; e++) {
+          Entry entry;
+
+          scanner.ReadFileOffset(entry.regionOffset);
+          scanner.Read(entry.boundary);
+
+          entries.push_back(entry);
+        }
+      }
+
+      listOffsets.push_back((uint32_t)entries.size());
+
+      uint32_t height=maxCell.y-minCell.y+1;
+
+      rowOffsets.clear();
+      rowOffsets.reserve(height+1);
+      runs.clear();
+
+      for (uint32_t y=0; y<height; y++) {
+        uint32_t runCount;
+
+        scanner.ReadNumber(runCount);
+
+        rowOffsets.push_back((uint32_t)runs.size());
+
+        for (uint32_t r=0; r<runCount; r++) {
+          Run run;
+
+          scanner.ReadNumber(run.startX);
+          scanner.ReadNumber(run.list);
+
+          if (run.list>=listCount) {
+            log.Error() << "Invalid region list index in '" << scanner.GetFilename() << "'";
+            scanner.Close();
+            return false;
+          }
+
+          runs.push_back(run);
+        }
+      }
+
+      rowOffsets.push_back((uint32_t)runs.size());
+
+      scanner.Close();
+
+      return true;
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      scanner.CloseFailsafe();
+
+      return false;
+    }
+  }
+
+  Pixel RegionRasterIndex::GetCell(const GeoCoord& coord) const
+  {
+    return {(uint32_t)((coord.GetLon()+180.0)/cellWidth),
+            (uint32_t)((coord.GetLat()+90.0)/cellHeight)};
+  }
+
+  void RegionRasterIndex::GetCandidates(const GeoCoord& coord,
+                                        std::vector<Entry>& candidates) const
+  {
+    candidates.clear();
+
+    Pixel cell=GetCell(coord);
+
+    if (cell.x<minCell.x ||
+        cell.x>maxCell.x ||
+        cell.y<minCell.y ||
+        cell.y>maxCell.y) {
+      return;
+    }
+
+    uint32_t x=cell.x-minCell.x;
+    uint32_t y=cell.y-minCell.y;
+    auto     rowStart=runs.begin()+rowOffsets[y];
+    auto     rowEnd=runs.begin()+rowOffsets[y+1];
+
+    // First run starting after the cell, the cell belongs to the run before
+    auto run=std::upper_bound(rowStart,
+                              rowEnd,
+                              x,
+                              [](uint32_t value, const Run& run) {
+                                return value<run.startX;
+                              });
+
+    if (run==rowStart) {
+      return;
+    }
+
+    --run;
+
+    candidates.assign(entries.begin()+listOffsets[run->list],
+                      entries.begin()+listOffsets[run->list+1]);
+  }
+}
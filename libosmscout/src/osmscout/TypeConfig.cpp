@@ -20,6 +20,7 @@
 #include <osmscout/TypeConfig.h>
 
 #include <algorithm>
+#include <cstddef>
 
 #include <osmscout/TypeFeatures.h>
 
@@ -356,14 +357,16 @@ namespace osmscout {
 
   FeatureValueBuffer::FeatureValueBuffer()
     : featureBits(nullptr),
-      featureValueBuffer(nullptr)
+      featureValueBuffer(nullptr),
+      arena(nullptr)
   {
     // no code
   }
 
   FeatureValueBuffer::FeatureValueBuffer(const FeatureValueBuffer& other)
     : featureBits(nullptr),
-      featureValueBuffer(nullptr)
+      featureValueBuffer(nullptr),
+      arena(nullptr)
   {
     Set(other);
   }
@@ -423,22 +426,43 @@ namespace osmscout {
         }
       }
 
-      ::operator delete((void*)featureValueBuffer);
+      // Memory from an arena is released together with the arena
+      if (arena==nullptr) {
+        ::operator delete((void*)featureValueBuffer);
+      }
       featureValueBuffer=nullptr;
     }
 
     if (featureBits!=nullptr) {
-      delete [] featureBits;
+      if (arena==nullptr) {
+        delete [] featureBits;
+      }
       featureBits=nullptr;
     }
 
+    arena=nullptr;
     type=nullptr;
   }
 
+  /**
+   * Allocate the feature bits. If there is a current ObjectArenaScope, the
+   * bits and the (lazily allocated) value buffer are taken from its arena.
+   */
   void FeatureValueBuffer::AllocateBits()
   {
     if (type && type->HasFeatures()) {
-      featureBits=new uint8_t[type->GetFeatureMaskBytes()]();
+      arena=ObjectArenaScope::GetCurrentArena();
+
+      if (arena!=nullptr) {
+        featureBits=static_cast<uint8_t*>(arena->Allocate(type->GetFeatureMaskBytes(),
+                                                          alignof(uint8_t)));
+        std::fill(featureBits,
+                  featureBits+type->GetFeatureMaskBytes(),
+                  0);
+      }
+      else {
+        featureBits=new uint8_t[type->GetFeatureMaskBytes()]();
+      }
     }
     else
     {
@@ -451,7 +475,13 @@ namespace osmscout {
     if (featureValueBuffer==nullptr &&
         type &&
         type->HasFeatures()) {
-      featureValueBuffer=static_cast<char*>(::operator new(type->GetFeatureValueBufferSize()));
+      if (arena!=nullptr) {
+        featureValueBuffer=static_cast<char*>(arena->Allocate(type->GetFeatureValueBufferSize(),
+                                                               alignof(std::max_align_t)));
+      }
+      else {
+        featureValueBuffer=static_cast<char*>(::operator new(type->GetFeatureValueBufferSize()));
+      }
     }
   }
 
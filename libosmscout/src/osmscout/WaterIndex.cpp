@@ -20,12 +20,15 @@
 #include <osmscout/WaterIndex.h>
 
 #include <algorithm>
+#include <array>
+#include <unordered_map>
 
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/Tracing.h>
 
 namespace osmscout {
 
@@ -36,7 +39,9 @@ namespace osmscout {
     Close();
   }
 
-  bool WaterIndex::Open(const std::string& path, bool memoryMappedData)
+  bool WaterIndex::Open(const std::string& path,
+                        bool memoryMappedData,
+                        bool loadIntoMemory)
   {
     datafilename=AppendFileToDir(path,WATER_IDX);
 
@@ -86,11 +91,25 @@ namespace osmscout {
         levels[idx].dataOffset=levels[idx].indexDataOffset+levels[idx].cellXCount*levels[idx].cellYCount*levels[idx].dataOffsetBytes;
       }
 
+      if (loadIntoMemory) {
+        for (auto& level : levels) {
+          if (level.hasCellData) {
+            LoadLevelIntoMemory(level);
+          }
+        }
+      }
+
       if (scanner.HasError()) {
         log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
         return false;
       }
 
+      if (loadIntoMemory) {
+        // All requests are answered from memory
+        scanner.Close();
+        inMemory=true;
+      }
+
       return true;
     }
     catch (IOException& e) {
@@ -102,6 +121,7 @@ namespace osmscout {
   void WaterIndex::Close()
   {
     levels.clear();
+    inMemory=false;
     try  {
       if (scanner.IsOpen()) {
         scanner.Close();
@@ -113,6 +133,231 @@ namespace osmscout {
     }
   }
 
+  /**
+   * Read the tiles of a coast cell, the given tile is used as template for
+   * the tiles added to the container.
+   */
+  template<typename C>
+  void WaterIndex::ReadCellTiles(const Level& level,
+                                 FileOffset cell,
+                                 GroundTile& tile,
+                                 C& tiles) const
+  {
+    uint32_t tileCount;
+
+    scanner.SetPos(level.dataOffset+cell);
+    scanner.ReadNumber(tileCount);
+
+    for (size_t t=0; t<tileCount; t++) {
+      uint8_t  tileType;
+      uint32_t coordCount;
+
+      scanner.Read(tileType);
+
+      tile.type=(GroundTile::Type)tileType;
+
+      scanner.ReadNumber(coordCount);
+
+      tile.coords.resize(coordCount);
+
+      for (size_t n=0; n<coordCount; n++) {
+        uint16_t x;
+        uint16_t y;
+
+        scanner.Read(x);
+        scanner.Read(y);
+
+        tile.coords[n].Set(x & ~(1 << 15),
+                           y,
+                           (x & (1 << 15))!=0);
+      }
+
+      tiles.push_back(tile);
+    }
+  }
+
+  /**
+   * Decode the cell states and coast data of the level and build
+   * the quadtree for the level.
+   *
+   * Rows of cells are streamed from the file and merged bottom up into the
+   * tree, so only one pending row per depth of the tree is held in memory
+   * instead of the state of all cells of the level.
+   */
+  void WaterIndex::LoadLevelIntoMemory(Level& level)
+  {
+    std::unordered_map<FileOffset,uint32_t> coastCellIndex;
+    std::vector<FileOffset>                 rowOffsets(level.cellXCount);
+    std::vector<std::vector<uint32_t>>      pendingRows;
+    GroundTile                              tile;
+
+    level.treeNodes.clear();
+    level.coastCellStart.clear();
+    level.coastTiles.clear();
+
+    level.treeSize=1;
+    pendingRows.resize(1);
+
+    while (level.treeSize<level.cellXCount ||
+           level.treeSize<level.cellYCount) {
+      level.treeSize*=2;
+      pendingRows.resize(pendingRows.size()+1);
+    }
+
+    for (uint32_t y=0; y<level.cellYCount; y++) {
+      // Cells outside the level are unknown
+      std::vector<uint32_t> row(level.treeSize,TREE_LEAF | GroundTile::unknown);
+
+      // Reading coast cells moves the file position
+      scanner.SetPos(level.indexDataOffset+(FileOffset)y*level.cellXCount*level.dataOffsetBytes);
+
+      for (auto& cellOffset : rowOffsets) {
+        scanner.ReadFileOffset(cellOffset,level.dataOffsetBytes);
+      }
+
+      for (uint32_t x=0; x<level.cellXCount; x++) {
+        FileOffset cell=rowOffsets[x];
+
+        if (cell==(FileOffset)GroundTile::land ||
+            cell==(FileOffset)GroundTile::water ||
+            cell==(FileOffset)GroundTile::coast ||
+            cell==(FileOffset)GroundTile::unknown) {
+          row[x]=TREE_LEAF | (uint32_t)cell;
+          continue;
+        }
+
+        // Cells may share their coast data
+        auto entry=coastCellIndex.find(cell);
+
+        if (entry==coastCellIndex.end()) {
+          uint32_t index=(uint32_t)level.coastCellStart.size();
+
+          level.coastCellStart.push_back((uint32_t)level.coastTiles.size());
+
+          ReadCellTiles(level,
+                        cell,
+                        tile,
+                        level.coastTiles);
+
+          entry=coastCellIndex.insert(std::make_pair(cell,index)).first;
+        }
+
+        row[x]=TREE_LEAF | TREE_COAST_DATA | entry->second;
+      }
+
+      AddTreeRow(level,
+                 pendingRows,
+                 0,
+                 std::move(row));
+    }
+
+    // Complete pending rows with the unknown rows below the level
+    for (size_t depth=0; depth+1<pendingRows.size(); depth++) {
+      if (!pendingRows[depth].empty()) {
+        AddTreeRow(level,
+                   pendingRows,
+                   depth,
+                   std::vector<uint32_t>(pendingRows[depth].size(),TREE_LEAF | GroundTile::unknown));
+      }
+    }
+
+    level.coastCellStart.push_back((uint32_t)level.coastTiles.size());
+
+    level.treeRoot=pendingRows.back().front();
+
+    level.treeNodes.shrink_to_fit();
+    level.coastCellStart.shrink_to_fit();
+    level.coastTiles.shrink_to_fit();
+  }
+
+  /**
+   * Add a row of node values at the given depth (0 for rows of cells) to the tree.
+   * If there is a pending row at the same depth, both rows are merged into a
+   * row of the parent nodes, which is added at the next depth. Else the row
+   * is kept as pending. The single node at the last depth is the root.
+   */
+  void WaterIndex::AddTreeRow(Level& level,
+                              std::vector<std::vector<uint32_t>>& pendingRows,
+                              size_t depth,
+                              std::vector<uint32_t>&& row)
+  {
+    while (depth+1<pendingRows.size() &&
+           !pendingRows[depth].empty()) {
+      std::vector<uint32_t>& upperRow=pendingRows[depth];
+      std::vector<uint32_t>  parentRow(row.size()/2);
+
+      for (size_t i=0; i<parentRow.size(); i++) {
+        parentRow[i]=AddTreeNode(level,
+                                 {upperRow[2*i],
+                                  upperRow[2*i+1],
+                                  row[2*i],
+                                  row[2*i+1]});
+      }
+
+      upperRow.clear();
+      row=std::move(parentRow);
+      depth++;
+    }
+
+    pendingRows[depth]=std::move(row);
+  }
+
+  /**
+   * Returns the value of a node with the given children (upper left, upper right,
+   * lower left, lower right). Children with the same state are collapsed into one leaf,
+   * else an inner node is added.
+   */
+  uint32_t WaterIndex::AddTreeNode(Level& level,
+                                   const std::array<uint32_t,4>& children)
+  {
+    if ((children[0] & TREE_LEAF)!=0 &&
+        (children[0] & TREE_COAST_DATA)==0 &&
+        children[1]==children[0] &&
+        children[2]==children[0] &&
+        children[3]==children[0]) {
+      return children[0];
+    }
+
+    uint32_t index=(uint32_t)level.treeNodes.size();
+
+    level.treeNodes.insert(level.treeNodes.end(),
+                           children.begin(),
+                           children.end());
+
+    return index;
+  }
+
+  /**
+   * Returns the value of the leaf for the given cell, relative to the start of the level
+   */
+  uint32_t WaterIndex::LookupCell(const Level& level,
+                                  uint32_t x,
+                                  uint32_t y) const
+  {
+    uint32_t node=level.treeRoot;
+    uint32_t size=level.treeSize;
+
+    while ((node & TREE_LEAF)==0) {
+      uint32_t child=0;
+
+      size/=2;
+
+      if (x>=size) {
+        child+=1;
+        x-=size;
+      }
+
+      if (y>=size) {
+        child+=2;
+        y-=size;
+      }
+
+      node=level.treeNodes[node+child];
+    }
+
+    return node;
+  }
+
   void WaterIndex::GetGroundTileByDefault(const Level& level,
                                           uint32_t cx1,
                                           uint32_t cx2,
@@ -212,43 +457,82 @@ namespace osmscout {
             tiles.push_back(tile);
           }
           else {
-            uint32_t tileCount;
-
             tile.type=GroundTile::coast;
             tile.coords.clear();
 
             tiles.push_back(tile);
 
-            scanner.SetPos(level.dataOffset+cell);
-            scanner.ReadNumber(tileCount);
+            ReadCellTiles(level,
+                          cell,
+                          tile,
+                          tiles);
+          }
+        }
+      }
+    }
+  }
+
+  void WaterIndex::GetGroundTileFromMemory(const Level& level,
+                                           uint32_t cx1,
+                                           uint32_t cx2,
+                                           uint32_t cy1,
+                                           uint32_t cy2,
+                                           std::list<GroundTile>& tiles) const
+  {
+    GroundTile tile;
+
+    tile.cellWidth=level.cellWidth;
+    tile.cellHeight=level.cellHeight;
+
+    for (uint32_t y=cy1; y<=cy2; y++) {
+      for (uint32_t x=cx1; x<=cx2; x++) {
+        tile.xAbs=x;
+        tile.yAbs=y;
+
+        if (x>=level.cellXStart &&
+            y>=level.cellYStart) {
+          tile.xRel=x-level.cellXStart;
+          tile.yRel=y-level.cellYStart;
+        }
+        else {
+          tile.xRel=0;
+          tile.yRel=0;
+        }
+
+        tile.coords.clear();
+
+        if (x<level.cellXStart ||
+            x>level.cellXEnd ||
+            y<level.cellYStart ||
+            y>level.cellYEnd) {
+          tile.type=GroundTile::unknown;
 
-            for (size_t t=0; t<tileCount; t++) {
-              uint8_t  tileType;
-              uint32_t coordCount;
+          tiles.push_back(tile);
+          continue;
+        }
 
-              scanner.Read(tileType);
+        uint32_t value=LookupCell(level,
+                                  x-level.cellXStart,
+                                  y-level.cellYStart);
 
-              tile.type=(GroundTile::Type)tileType;
+        if ((value & TREE_COAST_DATA)==0) {
+          tile.type=(GroundTile::Type)(value & TREE_VALUE_MASK);
 
-              scanner.ReadNumber(coordCount);
+          tiles.push_back(tile);
+          continue;
+        }
 
-              tile.coords.resize(coordCount);
+        uint32_t coastCell=value & TREE_VALUE_MASK;
 
-              for (size_t n=0; n<coordCount; n++) {
-                uint16_t x;
-                uint16_t y;
+        tile.type=GroundTile::coast;
 
-                scanner.Read(x);
-                scanner.Read(y);
+        tiles.push_back(tile);
 
-                tile.coords[n].Set(x & ~(1 << 15),
-                                   y,
-                                   (x & (1 << 15))!=0);
-              }
+        for (uint32_t t=level.coastCellStart[coastCell]; t<level.coastCellStart[coastCell+1]; t++) {
+          tile.type=level.coastTiles[t].type;
+          tile.coords=level.coastTiles[t].coords;
 
-              tiles.push_back(tile);
-            }
-          }
+          tiles.push_back(tile);
         }
       }
     }
@@ -258,6 +542,8 @@ namespace osmscout {
                               const Magnification& magnification,
                               std::list<GroundTile>& tiles) const
   {
+    OSMSCOUT_TRACE_SCOPE("WaterIndex","GetRegions");
+
     try {
       uint32_t cx1,cx2,cy1,cy2;
       uint32_t idx=magnification.GetLevel();
@@ -282,7 +568,16 @@ namespace osmscout {
 
       const Level &level=levels[idx];
 
-      if (level.hasCellData) {
+      if (level.hasCellData &&
+          inMemory) {
+        GetGroundTileFromMemory(level,
+                                cx1,
+                                cx2,
+                                cy1,
+                                cy2,
+                                tiles);
+      }
+      else if (level.hasCellData) {
         GetGroundTileFromData(level,
                               cx1,
                               cx2,
@@ -307,11 +602,34 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Returns the memory used by the in-memory quadtrees in bytes
+   */
+  size_t WaterIndex::GetMemoryUsage() const
+  {
+    size_t memory=levels.capacity()*sizeof(Level);
+
+    for (const auto& level : levels) {
+      memory+=level.treeNodes.capacity()*sizeof(uint32_t);
+      memory+=level.coastCellStart.capacity()*sizeof(uint32_t);
+      memory+=level.coastTiles.capacity()*sizeof(GroundTile);
+
+      for (const auto& tile : level.coastTiles) {
+        memory+=tile.coords.capacity()*sizeof(GroundTile::Coord);
+      }
+    }
+
+    return memory;
+  }
+
   void WaterIndex::DumpStatistics()
   {
     size_t entries=0;
-    size_t memory=0;
 
-    log.Info() << "WaterIndex size " << entries << ", memory " << memory;
+    for (const auto& level : levels) {
+      entries+=level.treeNodes.size()+level.coastTiles.size();
+    }
+
+    log.Info() << "WaterIndex size " << entries << ", memory " << GetMemoryUsage();
   }
 }
@@ -29,4 +29,12 @@ namespace osmscout {
   {
     // no code
   }
+
+  const char* const WayResolutionDataFile::WAYS_RES_DAT="waysres.dat";
+
+  WayResolutionDataFile::WayResolutionDataFile()
+  : MultiResolutionDataFile<Way>(WAYS_RES_DAT)
+  {
+    // no code
+  }
 }
@@ -31,10 +31,12 @@
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
+#include <osmscout/util/Tracing.h>
 
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <queue>
 
 //#define DEBUG_ROUTING
 
@@ -84,7 +86,13 @@ namespace osmscout {
 
   template <class RoutingState>
   AbstractRoutingService<RoutingState>::AbstractRoutingService(const RouterParameter& parameter):
-    debugPerformance(parameter.IsDebugPerformance())
+    debugPerformance(parameter.IsDebugPerformance()),
+    useObjectArena(parameter.GetUseObjectArena()),
+    nodeExpansionCounter(metrics.GetCounter("osmscout_routing_node_expansions_total",
+                                            "Number of route nodes expanded during route calculation")),
+    calculationTime(metrics.GetHistogram("osmscout_routing_calculation_seconds",
+                                         "Duration of the route search, without converting the result",
+                                         MetricHistogram::GetLatencyBounds()))
   {
   }
 
@@ -871,6 +879,368 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Search state of a route node while walking the in-memory routing graph. It holds the
+   * data of the RNode in the open list and of the VNodes in both closed sets.
+   */
+  struct RoutingGraphSearchNode
+  {
+    uint32_t      node;            //!< Index of the route node in the graph
+    uint32_t      prev;            //!< Index of the previous route node, if open
+    ObjectFileRef object;          //!< The object used to reach the route node, if open
+
+    double        currentCost;     //!< The cost of the current up to the current node, if open
+    double        estimateCost;    //!< The estimated cost from here to the target, if open
+    double        overallCost;     //!< The overall costs (currentCost+estimateCost), if open
+
+    bool          open;            //!< The route node is in the open list
+    bool          access;          //!< We had access to this node, if open
+
+    bool          closed[2];       //!< The route node is in the closed set (0) or the closed restricted set (1)
+    uint32_t      closedPrev[2];   //!< Index of the previous route node in the closed set
+    ObjectFileRef closedObject[2]; //!< The object used to reach the route node in the closed set
+
+    explicit RoutingGraphSearchNode(uint32_t node)
+    : node(node),
+      prev(RoutingGraph::InvalidIndex),
+      currentCost(0),
+      estimateCost(0),
+      overallCost(0),
+      open(false),
+      access(true),
+      closed{false,false},
+      closedPrev{RoutingGraph::InvalidIndex,RoutingGraph::InvalidIndex}
+    {
+      // no code
+    }
+  };
+
+  /**
+   * Walk the in-memory routing graph from the start nodes until both target nodes have been
+   * reached. The search follows exactly the same rules as the search via WalkPaths(), but
+   * the open list, the open map and the closed sets are replaced by a vector of search
+   * states, which is indexed via the node index of the graph using a RoutingGraphSearchIndex.
+   * So no hash lookups and no route node loading is required. The search index is kept by
+   * the service, so a route calculation does not allocate memory proportional to the graph.
+   *
+   * @return
+   *    True, if a route was found, the list of visited nodes is returned in nodes
+   */
+  template <class RoutingState>
+  bool AbstractRoutingService<RoutingState>::WalkRoutingGraph(const RoutingState& state,
+                                                              const RoutingGraph& graph,
+                                                              DatabaseId database,
+                                                              const RNodeRef& startForwardNode,
+                                                              const RNodeRef& startBackwardNode,
+                                                              const RouteNodeRef& targetForwardRouteNode,
+                                                              const RouteNodeRef& targetBackwardRouteNode,
+                                                              RoutingResult &result,
+                                                              const RoutingParameter& parameter,
+                                                              const GeoCoord &targetCoord,
+                                                              const Vehicle &vehicle,
+                                                              const Distance &overallDistance,
+                                                              const double &costLimit,
+                                                              std::list<VNode>& nodes)
+  {
+    // (overall cost, node index), sorting by node index is the same as sorting by id
+    typedef std::pair<double,uint32_t> OpenEntry;
+
+    // The search index of the service is reused, unless a concurrent search is using it
+    std::unique_lock<std::mutex>        searchIndexLock(graphSearchIndexMutex,std::try_to_lock);
+    RoutingGraphSearchIndex             localSearchIndex;
+    RoutingGraphSearchIndex&            searchIndex=searchIndexLock.owns_lock() ? graphSearchIndex : localSearchIndex;
+    std::vector<RoutingGraphSearchNode> searchNodes;
+    std::priority_queue<OpenEntry,
+                        std::vector<OpenEntry>,
+                        std::greater<OpenEntry>> openList;
+
+    searchIndex.Reset(graph.GetNodeCount());
+    searchNodes.reserve(10000);
+
+    auto GetSearchNode=[&searchIndex,&searchNodes](uint32_t node) -> RoutingGraphSearchNode& {
+      uint32_t index=searchIndex.Get(node);
+
+      if (index==RoutingGraph::InvalidIndex) {
+        index=(uint32_t)searchNodes.size();
+        searchIndex.Set(node,index);
+        searchNodes.emplace_back(node);
+      }
+
+      return searchNodes[index];
+    };
+
+    // Remove entries of nodes that have been updated or closed since insertion
+    auto SkipStaleEntries=[&openList,&searchIndex,&searchNodes]() {
+      while (!openList.empty()) {
+        const RoutingGraphSearchNode& node=searchNodes[searchIndex.Get(openList.top().second)];
+
+        if (node.open &&
+            node.overallCost==openList.top().first) {
+          return;
+        }
+
+        openList.pop();
+      }
+    };
+
+    for (const auto& startNode : {startForwardNode, startBackwardNode}) {
+      if (!startNode) {
+        continue;
+      }
+
+      uint32_t nodeIndex=graph.FindNode(startNode->id.id);
+
+      if (nodeIndex==RoutingGraph::InvalidIndex) {
+        log.Error() << "Start route node " << startNode->id.id << " is not part of the routing graph";
+        return false;
+      }
+
+      RoutingGraphSearchNode& node=GetSearchNode(nodeIndex);
+
+      node.object=startNode->object;
+      node.currentCost=startNode->currentCost;
+      node.estimateCost=startNode->estimateCost;
+      node.overallCost=startNode->overallCost;
+      node.access=startNode->access;
+      node.open=true;
+
+      openList.push(OpenEntry(node.overallCost,nodeIndex));
+    }
+
+    uint32_t targetForwardIndex=targetForwardRouteNode ? graph.FindNode(targetForwardRouteNode->GetId()) : RoutingGraph::InvalidIndex;
+    uint32_t targetBackwardIndex=targetBackwardRouteNode ? graph.FindNode(targetBackwardRouteNode->GetId()) : RoutingGraph::InvalidIndex;
+    bool     targetForwardFound=targetForwardRouteNode ? false : true;
+    bool     targetBackwardFound=targetBackwardRouteNode ? false : true;
+    uint32_t targetForwardFinalNode=RoutingGraph::InvalidIndex;
+    uint32_t targetBackwardFinalNode=RoutingGraph::InvalidIndex;
+    double   targetForwardFinalCost=0.0;
+    double   targetBackwardFinalCost=0.0;
+    Distance currentMaxDistance;
+    uint32_t current=RoutingGraph::InvalidIndex;
+
+    size_t   nodesLoadedCount=0;
+    size_t   nodesIgnoredCount=0;
+
+    SkipStaleEntries();
+
+    while (!openList.empty() && !(targetForwardFound && targetBackwardFound)) {
+      OSMSCOUT_TRACE_SCOPE("Routing","RouteIteration");
+
+      if (parameter.GetBreaker() &&
+          parameter.GetBreaker()->IsAborted()) {
+        return false;
+      }
+
+      current=openList.top().second;
+      openList.pop();
+
+      nodeExpansionCounter.Increment();
+      nodesLoadedCount++;
+
+      // Copy the values, the search node vector may get resized while walking the paths
+      RoutingGraphSearchNode currentNode=GetSearchNode(current);
+
+      searchNodes[searchIndex.Get(current)].open=false;
+
+      // find incoming path (its index) to current node
+      bool     inPathValid=false;
+      uint32_t inPathIndex=0;
+
+      if (currentNode.prev!=RoutingGraph::InvalidIndex) {
+        for (uint32_t p=graph.GetPathBegin(current); p<graph.GetPathEnd(current); p++) {
+          if (graph.GetPathTarget(p)==currentNode.prev && // this is path from previous node
+              graph.GetPathObject(p)==currentNode.object) { // with used object
+            inPathIndex=p;
+            inPathValid=true;
+            break;
+          }
+        }
+      }
+
+      for (uint32_t p=graph.GetPathBegin(current); p<graph.GetPathEnd(current); p++) {
+        uint32_t target=graph.GetPathTarget(p);
+
+        if (currentNode.prev!=RoutingGraph::InvalidIndex &&
+            target==currentNode.prev) {
+          // back to the last node visited
+          nodesIgnoredCount++;
+          continue;
+        }
+
+        if (!currentNode.access &&
+            !graph.IsPathRestricted(p,vehicle)) {
+          // moving from non-accessible way back to accessible way
+          nodesIgnoredCount++;
+          continue;
+        }
+
+        if (!CanUse(state,
+                    database,
+                    graph,
+                    p)) {
+          nodesIgnoredCount++;
+          continue;
+        }
+
+        if (target!=RoutingGraph::InvalidIndex &&
+            searchIndex.Get(target)!=RoutingGraph::InvalidIndex &&
+            searchNodes[searchIndex.Get(target)].closed[currentNode.access ? 0 : 1]) {
+          // already calculated
+          continue;
+        }
+
+        bool canTurnedInto=true;
+
+        for (uint32_t e=graph.GetExcludeBegin(current); e<graph.GetExcludeEnd(current); e++) {
+          if (graph.GetExcludeSource(e)==currentNode.object &&
+              graph.GetExcludeTarget(e)==graph.GetPathObject(p)) {
+            canTurnedInto=false;
+            break;
+          }
+        }
+
+        if (!canTurnedInto) {
+          nodesIgnoredCount++;
+          continue;
+        }
+
+        double currentCost=currentNode.currentCost+GetCosts(state,
+                                                            database,
+                                                            graph,
+                                                            inPathValid ? inPathIndex : p,
+                                                            p);
+
+        if (target!=RoutingGraph::InvalidIndex &&
+            searchIndex.Get(target)!=RoutingGraph::InvalidIndex &&
+            searchNodes[searchIndex.Get(target)].open &&
+            searchNodes[searchIndex.Get(target)].currentCost<=currentCost) {
+          // cheaper route exists
+          continue;
+        }
+
+        if (target==RoutingGraph::InvalidIndex) {
+          log.Error() << "Target of path " << p << " of route node " << graph.GetNodeId(current) << " is not part of the routing graph";
+          return false;
+        }
+
+        Distance distanceToTarget=GetSphericalDistance(graph.GetNodeCoord(target),
+                                                       targetCoord);
+
+        currentMaxDistance=Distance::Max(currentMaxDistance,overallDistance-distanceToTarget);
+        result.SetCurrentMaxDistance(currentMaxDistance);
+
+        // Estimate costs for the rest of the distance to the target
+        double estimateCost=GetEstimateCosts(state,database,distanceToTarget);
+        double overallCost=currentCost+estimateCost;
+
+        if (overallCost>costLimit) {
+          nodesIgnoredCount++;
+          continue;
+        }
+
+        if (parameter.GetProgress()) {
+          parameter.GetProgress()->Progress(currentMaxDistance,overallDistance);
+        }
+
+        RoutingGraphSearchNode& node=GetSearchNode(target);
+
+        node.prev=current;
+        node.object=graph.GetPathObject(p);
+        node.currentCost=currentCost;
+        node.estimateCost=estimateCost;
+        node.overallCost=overallCost;
+        node.access=!graph.IsPathRestricted(p,vehicle);
+        node.open=true;
+
+        openList.push(OpenEntry(overallCost,target));
+      }
+
+      RoutingGraphSearchNode& closedNode=searchNodes[searchIndex.Get(current)];
+      size_t                  closedSet=currentNode.access ? 0 : 1;
+
+      closedNode.closed[closedSet]=true;
+      closedNode.closedPrev[closedSet]=currentNode.prev;
+      closedNode.closedObject[closedSet]=currentNode.object;
+
+      if (!targetForwardFound &&
+          current==targetForwardIndex) {
+        targetForwardFound=true;
+        targetForwardFinalNode=current;
+        targetForwardFinalCost=currentNode.currentCost;
+      }
+
+      if (!targetBackwardFound &&
+          current==targetBackwardIndex) {
+        targetBackwardFound=true;
+        targetBackwardFinalNode=current;
+        targetBackwardFinalCost=currentNode.currentCost;
+      }
+
+      SkipStaleEntries();
+    }
+
+    if (debugPerformance) {
+      std::cout << "Route nodes loaded:  " << nodesLoadedCount << std::endl;
+      std::cout << "Route nodes ignored: " << nodesIgnoredCount << std::endl;
+      std::cout << "Route nodes visited: " << searchNodes.size() << std::endl;
+    }
+
+    // If we have keep the last node open because of access violations, add it
+    // after routing is done
+    if (current!=RoutingGraph::InvalidIndex &&
+        !searchNodes[searchIndex.Get(current)].closed[0]) {
+      RoutingGraphSearchNode& node=searchNodes[searchIndex.Get(current)];
+
+      node.closed[0]=true;
+      node.closedPrev[0]=node.closedPrev[1];
+      node.closedObject[0]=node.closedObject[1];
+    }
+
+    uint32_t targetFinalNode;
+
+    if (targetForwardFinalNode!=RoutingGraph::InvalidIndex &&
+        targetBackwardFinalNode!=RoutingGraph::InvalidIndex) {
+      targetFinalNode=targetForwardFinalCost<=targetBackwardFinalCost ? targetForwardFinalNode : targetBackwardFinalNode;
+    }
+    else if (targetBackwardFinalNode!=RoutingGraph::InvalidIndex) {
+      targetFinalNode=targetBackwardFinalNode;
+    }
+    else if (targetForwardFinalNode!=RoutingGraph::InvalidIndex) {
+      targetFinalNode=targetForwardFinalNode;
+    }
+    else {
+      return false;
+    }
+
+    // Resolve the chain of closed nodes, see ResolveRNodeChainToList()
+    const RoutingGraphSearchNode* node=&searchNodes[searchIndex.Get(targetFinalNode)];
+    size_t                        closedSet=node->closed[0] ? 0 : 1;
+
+    assert(node->closed[closedSet]);
+
+    while (node->closedPrev[closedSet]!=RoutingGraph::InvalidIndex) {
+      const RoutingGraphSearchNode* prev=&searchNodes[searchIndex.Get(node->closedPrev[closedSet])];
+      size_t                        prevClosedSet=prev->closed[closedSet] ? closedSet : 1-closedSet;
+
+      assert(prev->closed[prevClosedSet]);
+
+      nodes.push_back(VNode(DBId(database,graph.GetNodeId(node->node)),
+                            node->closedObject[closedSet],
+                            DBId(database,graph.GetNodeId(prev->node))));
+
+      node=prev;
+      closedSet=prevClosedSet;
+    }
+
+    nodes.push_back(VNode(DBId(database,graph.GetNodeId(node->node)),
+                          node->closedObject[closedSet],
+                          DBId()));
+
+    std::reverse(nodes.begin(),nodes.end());
+
+    return true;
+  }
+
   /**
    * Calculate a route
    *
@@ -893,6 +1263,8 @@ namespace osmscout {
                                                                      const RoutePosition& target,
                                                                      const RoutingParameter& parameter)
   {
+    OSMSCOUT_TRACE_SCOPE("Routing","CalculateRoute");
+
     RoutingResult            result;
     Vehicle                  vehicle=GetVehicle(state);
     RouteNodeRef             startForwardRouteNode;
@@ -992,6 +1364,62 @@ namespace osmscout {
     result.SetOverallDistance(overallDistance);
     result.SetCurrentMaxDistance(currentMaxDistance);
 
+    const RoutingGraph* routingGraph=start.GetDatabaseId()==target.GetDatabaseId() ? GetRoutingGraph(start.GetDatabaseId()) : nullptr;
+
+    if (routingGraph!=nullptr) {
+      StopClock        clock;
+      std::list<VNode> nodes;
+
+      bool found=WalkRoutingGraph(state,
+                                  *routingGraph,
+                                  start.GetDatabaseId(),
+                                  startForwardNode,
+                                  startBackwardNode,
+                                  targetForwardRouteNode,
+                                  targetBackwardRouteNode,
+                                  result,
+                                  parameter,
+                                  targetCoord,
+                                  vehicle,
+                                  overallDistance,
+                                  costLimit,
+                                  nodes);
+
+      clock.Stop();
+
+      calculationTime.Observe(clock.GetMilliseconds()/1000.0);
+
+      if (debugPerformance) {
+        std::cout << "Time:                " << clock << " (in-memory routing graph)" << std::endl;
+        std::cout << "Air-line distance:   " << std::fixed << std::setprecision(1) << overallDistance.As<Kilometer>() << "km" << std::endl;
+        std::cout << "Minimum cost:        " << overallCost << std::endl;
+        std::cout << "Cost limit:          " << costLimit << std::endl;
+      }
+
+      if (!found) {
+        log.Warn() << "No route found!";
+
+        return result;
+      }
+
+      if (parameter.GetBreaker() &&
+          parameter.GetBreaker()->IsAborted()) {
+        return result;
+      }
+
+      if (!ResolveRNodesToRouteData(state,
+                                    nodes,
+                                    start,
+                                    target,
+                                    result.GetRoute())) {
+        return result;
+      }
+
+      ResolveRouteDataJunctions(result.GetRoute());
+
+      return result;
+    }
+
     StopClock    clock;
     RNodeRef     current;
     RouteNodeRef currentRouteNode;
@@ -1002,6 +1430,8 @@ namespace osmscout {
     RNodeRef     targetBackwardFinalNode;
 
     do {
+      OSMSCOUT_TRACE_SCOPE("Routing","RouteIteration");
+
       //
       // Take entry from open list with lowest cost
       //
@@ -1016,6 +1446,8 @@ namespace osmscout {
       openMap.erase(current->id);
       openList.erase(openList.begin());
 
+      nodeExpansionCounter.Increment();
+
       currentRouteNode=current->node;
       dbId=current->id.database;
 
@@ -1150,6 +1582,8 @@ namespace osmscout {
 
     clock.Stop();
 
+    calculationTime.Observe(clock.GetMilliseconds()/1000.0);
+
     if (debugPerformance) {
       std::cout << "From:                ";
       if (startBackwardRouteNode) {
@@ -1367,6 +1801,8 @@ namespace osmscout {
                                                                       const RoutePosition& target,
                                                                       RouteData& route)
   {
+    OSMSCOUT_TRACE_SCOPE("Routing","ResolveRNodesToRouteData");
+
     std::set<DBId>                                routeNodeIds;
     std::set<DBFileOffset>                        wayOffsets;
     std::set<DBFileOffset>                        areaOffsets;
@@ -1651,6 +2087,8 @@ namespace osmscout {
   template <class RoutingState>
   RouteDescriptionResult AbstractRoutingService<RoutingState>::TransformRouteDataToRouteDescription(const RouteData& data)
   {
+    OSMSCOUT_TRACE_SCOPE("Routing","TransformRouteDataToRouteDescription");
+
     RouteDescriptionRef description=std::make_shared<RouteDescription>();
     description->SetDatabaseMapping(GetDatabaseMapping());
 
@@ -0,0 +1,959 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/routing/MapMatchingService.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/Exception.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  /**
+   * Magnification level of the tiles candidate ways are loaded and cached for
+   */
+  static const MagnificationLevel tileLevel(16);
+
+  /**
+   * Length of one degree of latitude on the sphere used by GetSphericalDistance
+   */
+  static const double metersPerDegree=6371010.0*M_PI/180.0;
+
+  static const double infinity=std::numeric_limits<double>::infinity();
+
+  MapMatchingParameter::MapMatchingParameter()
+  : searchRadius(Meters(50)),
+    measurementSigma(Meters(5)),
+    transitionBeta(Meters(5)),
+    routeDistanceFactor(3.0),
+    maxCandidates(8),
+    tileCacheSize(1000),
+    threadCount(0)
+  {
+    // no code
+  }
+
+  void MapMatchingParameter::SetSearchRadius(const Distance& searchRadius)
+  {
+    this->searchRadius=searchRadius;
+  }
+
+  void MapMatchingParameter::SetMeasurementSigma(const Distance& measurementSigma)
+  {
+    this->measurementSigma=measurementSigma;
+  }
+
+  void MapMatchingParameter::SetTransitionBeta(const Distance& transitionBeta)
+  {
+    this->transitionBeta=transitionBeta;
+  }
+
+  void MapMatchingParameter::SetRouteDistanceFactor(double routeDistanceFactor)
+  {
+    this->routeDistanceFactor=routeDistanceFactor;
+  }
+
+  void MapMatchingParameter::SetMaxCandidates(size_t maxCandidates)
+  {
+    this->maxCandidates=maxCandidates;
+  }
+
+  void MapMatchingParameter::SetTileCacheSize(size_t tileCacheSize)
+  {
+    this->tileCacheSize=tileCacheSize;
+  }
+
+  void MapMatchingParameter::SetThreadCount(size_t threadCount)
+  {
+    this->threadCount=threadCount;
+  }
+
+  size_t MapMatchingResult::GetMatchedPointCount() const
+  {
+    return (size_t)std::count_if(points.begin(),
+                                 points.end(),
+                                 [](const MatchedPoint& point) {
+                                   return point.matched;
+                                 });
+  }
+
+  /**
+   * State of matching a single trace. Route nodes and tiles used by the trace are
+   * held locally, so that only the tile cache of the service has to be synchronized.
+   */
+  class MapMatchingService::Matcher
+  {
+  private:
+    struct Candidate
+    {
+      const WayInfo *info;
+      size_t        segment;   //!< Index of the first node of the matched segment
+      size_t        nodeIndex; //!< Index of the node of the segment closest to the matched location
+      double        offset;    //!< Distance in meter of the matched location from the start of the way
+      GeoCoord      location;
+      double        distance;  //!< Distance in meter of the matched location from the observation
+      bool          forward;
+      bool          backward;
+    };
+
+    struct Step
+    {
+      size_t                 observation;
+      std::vector<Candidate> candidates;
+      std::vector<double>    scores;       //!< Logarithmic probability of the most probable sequence ending at the candidate
+      std::vector<size_t>    predecessors; //!< Candidate of the previous step on this sequence
+    };
+
+    struct Predecessor
+    {
+      Id            node;   //!< Previous route node, 0 if the route node was reached from the source
+      ObjectFileRef object; //!< Object used to reach the route node
+    };
+
+    struct RouteSearch
+    {
+      std::vector<double>                distances;  //!< Route distance in meter to each target
+      std::vector<Id>                    entryNodes; //!< Route node each target was reached from, 0 if on the way of the source
+      std::unordered_map<Id,Predecessor> predecessors;
+    };
+
+  private:
+    MapMatchingService&                    service;
+    const RoutingProfile&                  profile;
+    const std::vector<ObjectVariantData>&  objectVariantData;
+    std::unordered_map<uint64_t,TileWaysRef> tiles;      //!< Tiles used by the trace
+    std::unordered_map<Id,RouteNodeRef>    routeNodes; //!< Route nodes loaded for the trace
+
+  private:
+    const TileWaysRef& GetTileWays(const TileId& tile);
+    RouteNodeRef GetRouteNode(Id id);
+
+    std::vector<Candidate> GetCandidates(const GeoCoord& coord);
+
+    double GetMaxRouteDistance(double directDistance) const;
+    RouteSearch SearchRoutes(const Candidate& source,
+                             const std::vector<Candidate>& targets,
+                             double maxDistance);
+
+    static size_t GetNodeIndex(const std::vector<Point>& nodes,
+                               Id id,
+                               size_t nearIndex);
+    static void AddNodes(RouteData& route,
+                         const std::vector<Point>& nodes,
+                         const ObjectFileRef& object,
+                         size_t startNodeIndex,
+                         size_t targetNodeIndex);
+    bool AddRoute(RouteData& route,
+                  const Candidate& source,
+                  const Candidate& target,
+                  double maxDistance);
+
+    void FinishPart(const std::vector<GeoCoord>& trace,
+                    const std::vector<Step>& steps,
+                    MapMatchingResult& result);
+
+  public:
+    Matcher(MapMatchingService& service,
+            const RoutingProfile& profile);
+
+    MapMatchingResult Match(const std::vector<GeoCoord>& trace,
+                            const BreakerRef& breaker);
+  };
+
+  MapMatchingService::Matcher::Matcher(MapMatchingService& service,
+                                       const RoutingProfile& profile)
+  : service(service),
+    profile(profile),
+    objectVariantData(service.routingDatabase.GetObjectVariantData())
+  {
+    // no code
+  }
+
+  const MapMatchingService::TileWaysRef& MapMatchingService::Matcher::GetTileWays(const TileId& tile)
+  {
+    uint64_t key=((uint64_t)tile.GetX() << 32u) | tile.GetY();
+    auto     entry=tiles.find(key);
+
+    if (entry==tiles.end()) {
+      entry=tiles.emplace(key,service.GetTileWays(tile)).first;
+    }
+
+    return entry->second;
+  }
+
+  RouteNodeRef MapMatchingService::Matcher::GetRouteNode(Id id)
+  {
+    auto entry=routeNodes.find(id);
+
+    if (entry!=routeNodes.end()) {
+      return entry->second;
+    }
+
+    RouteNodeRef node;
+
+    if (!service.routingDatabase.GetRouteNode(id,node)) {
+      node.reset();
+    }
+
+    routeNodes.emplace(id,node);
+
+    return node;
+  }
+
+  /**
+   * Returns the closest locations on the ways usable by the profile within the search
+   * radius, sorted by distance.
+   */
+  std::vector<MapMatchingService::Matcher::Candidate> MapMatchingService::Matcher::GetCandidates(const GeoCoord& coord)
+  {
+    double                         radius=service.parameter.GetSearchRadius().AsMeter();
+    GeoBox                         box=GeoBox::BoxByCenterAndRadius(coord,service.parameter.GetSearchRadius());
+    TileIdBox                      tileBox(TileId::GetTile(tileLevel,box.GetMinCoord()),
+                                           TileId::GetTile(tileLevel,box.GetMaxCoord()));
+    // Local equirectangular projection around the observation, in degree of latitude
+    double                         lonScale=std::cos(DegToRad(coord.GetLat()));
+    std::unordered_set<FileOffset> visited;
+    std::vector<Candidate>         candidates;
+
+    for (const auto& tile : tileBox) {
+      for (const auto& info : *GetTileWays(tile)) {
+        if (!info.boundingBox.Intersects(box) ||
+            !visited.insert(info.way->GetFileOffset()).second ||
+            !profile.CanUse(*info.way)) {
+          continue;
+        }
+
+        const std::vector<Point>& nodes=info.way->nodes;
+        bool                      forward=profile.CanUseForward(*info.way);
+        bool                      backward=profile.CanUseBackward(*info.way);
+        bool                      inRange=false;
+
+        // A way may pass the observation several times, each run of consecutive
+        // segments within the search radius results in its own candidate
+        for (size_t i=1; i<nodes.size(); i++) {
+          double r;
+          double qx;
+          double qy;
+          double distance=DistanceToSegment(0.0,0.0,
+                                            (nodes[i-1].GetLon()-coord.GetLon())*lonScale,
+                                            nodes[i-1].GetLat()-coord.GetLat(),
+                                            (nodes[i].GetLon()-coord.GetLon())*lonScale,
+                                            nodes[i].GetLat()-coord.GetLat(),
+                                            r,qx,qy)*metersPerDegree;
+
+          if (std::isnan(distance)) {
+            continue;
+          }
+
+          if (distance>radius) {
+            inRange=false;
+            continue;
+          }
+
+          if (inRange &&
+              distance>=candidates.back().distance) {
+            continue;
+          }
+
+          if (!inRange) {
+            candidates.emplace_back();
+            inRange=true;
+          }
+
+          Candidate& candidate=candidates.back();
+
+          r=std::max(0.0,std::min(1.0,r));
+
+          candidate.info=&info;
+          candidate.segment=i-1;
+          candidate.nodeIndex=r<0.5 ? i-1 : i;
+          candidate.offset=info.offsets[i-1]+r*(info.offsets[i]-info.offsets[i-1]);
+          candidate.location=GeoCoord(coord.GetLat()+qy,
+                                      coord.GetLon()+qx/lonScale);
+          candidate.distance=distance;
+          candidate.forward=forward;
+          candidate.backward=backward;
+        }
+      }
+    }
+
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return a.distance<b.distance;
+              });
+
+    if (candidates.size()>service.parameter.GetMaxCandidates()) {
+      candidates.resize(service.parameter.GetMaxCandidates());
+    }
+
+    return candidates;
+  }
+
+  double MapMatchingService::Matcher::GetMaxRouteDistance(double directDistance) const
+  {
+    return directDistance*service.parameter.GetRouteDistanceFactor()+
+           2*service.parameter.GetSearchRadius().AsMeter();
+  }
+
+  /**
+   * Calculates the shortest route distances from the source to all targets, up
+   * to the given maximum distance. Targets on the way of the source are reached
+   * directly, all others by a Dijkstra search on the route nodes starting at the
+   * route nodes next to the source in the usable directions.
+   */
+  MapMatchingService::Matcher::RouteSearch MapMatchingService::Matcher::SearchRoutes(const Candidate& source,
+                                                                                     const std::vector<Candidate>& targets,
+                                                                                     double maxDistance)
+  {
+    typedef std::pair<double,Id> QueueEntry;
+
+    RouteSearch                                                                    search;
+    std::unordered_map<Id,std::vector<std::pair<size_t,double>>>                   targetNodes;
+    std::unordered_map<Id,double>                                                  costs;
+    std::unordered_set<Id>                                                         settled;
+    std::priority_queue<QueueEntry,std::vector<QueueEntry>,std::greater<QueueEntry>> queue;
+    const WayInfo&                                                                 sourceInfo=*source.info;
+
+    search.distances.assign(targets.size(),infinity);
+    search.entryNodes.assign(targets.size(),0);
+
+    for (size_t t=0; t<targets.size(); t++) {
+      const Candidate& target=targets[t];
+      const WayInfo&   targetInfo=*target.info;
+
+      if (targetInfo.way->GetFileOffset()==sourceInfo.way->GetFileOffset()) {
+        double delta=target.offset-source.offset;
+
+        if (delta>=0.0 && source.forward) {
+          search.distances[t]=delta;
+        }
+        else if (delta<=0.0 && source.backward) {
+          search.distances[t]=-delta;
+        }
+      }
+
+      // Route nodes the target can be reached from, together with the remaining distance
+      auto next=std::upper_bound(targetInfo.routeNodes.begin(),
+                                 targetInfo.routeNodes.end(),
+                                 target.segment);
+
+      if (target.forward && next!=targetInfo.routeNodes.begin()) {
+        size_t index=*(next-1);
+
+        targetNodes[targetInfo.way->GetId(index)].emplace_back(t,target.offset-targetInfo.offsets[index]);
+      }
+
+      if (target.backward && next!=targetInfo.routeNodes.end()) {
+        size_t index=*next;
+
+        targetNodes[targetInfo.way->GetId(index)].emplace_back(t,targetInfo.offsets[index]-target.offset);
+      }
+    }
+
+    auto addSource=[&](size_t index, double cost) {
+      Id   id=sourceInfo.way->GetId(index);
+      auto entry=costs.find(id);
+
+      if (cost<=maxDistance &&
+          (entry==costs.end() || cost<entry->second)) {
+        costs[id]=cost;
+        search.predecessors[id]=Predecessor{0,sourceInfo.way->GetObjectFileRef()};
+        queue.emplace(cost,id);
+      }
+    };
+
+    auto next=std::upper_bound(sourceInfo.routeNodes.begin(),
+                               sourceInfo.routeNodes.end(),
+                               source.segment);
+
+    if (source.forward && next!=sourceInfo.routeNodes.end()) {
+      addSource(*next,sourceInfo.offsets[*next]-source.offset);
+    }
+
+    if (source.backward && next!=sourceInfo.routeNodes.begin()) {
+      addSource(*(next-1),source.offset-sourceInfo.offsets[*(next-1)]);
+    }
+
+    while (!queue.empty()) {
+      QueueEntry current=queue.top();
+
+      queue.pop();
+
+      if (!settled.insert(current.second).second) {
+        continue;
+      }
+
+      // No target can be reached with a shorter distance any more
+      if (std::all_of(search.distances.begin(),
+                      search.distances.end(),
+                      [&current](double distance) {
+                        return distance<=current.first;
+                      })) {
+        break;
+      }
+
+      auto targetEntry=targetNodes.find(current.second);
+
+      if (targetEntry!=targetNodes.end()) {
+        for (const auto& target : targetEntry->second) {
+          if (current.first+target.second<search.distances[target.first]) {
+            search.distances[target.first]=current.first+target.second;
+            search.entryNodes[target.first]=current.second;
+          }
+        }
+      }
+
+      RouteNodeRef node=GetRouteNode(current.second);
+
+      if (!node) {
+        continue;
+      }
+
+      for (size_t i=0; i<node->paths.size(); i++) {
+        const RouteNode::Path& path=node->paths[i];
+        double                 cost=current.first+path.distance.AsMeter();
+
+        if (cost>maxDistance ||
+            settled.find(path.id)!=settled.end() ||
+            !profile.CanUse(*node,objectVariantData,i)) {
+          continue;
+        }
+
+        auto entry=costs.find(path.id);
+
+        if (entry==costs.end() || cost<entry->second) {
+          costs[path.id]=cost;
+          search.predecessors[path.id]=Predecessor{current.second,node->objects[path.objectIndex].object};
+          queue.emplace(cost,path.id);
+        }
+      }
+    }
+
+    return search;
+  }
+
+  /**
+   * Returns the index of the node with the given id, the closest one to nearIndex
+   * if the id is contained multiple times.
+   */
+  size_t MapMatchingService::Matcher::GetNodeIndex(const std::vector<Point>& nodes,
+                                                   Id id,
+                                                   size_t nearIndex)
+  {
+    size_t bestIndex=nodes.size();
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      if (nodes[i].GetId()==id &&
+          (bestIndex==nodes.size() ||
+           std::abs((long)i-(long)nearIndex)<std::abs((long)bestIndex-(long)nearIndex))) {
+        bestIndex=i;
+      }
+    }
+
+    return bestIndex;
+  }
+
+  void MapMatchingService::Matcher::AddNodes(RouteData& route,
+                                             const std::vector<Point>& nodes,
+                                             const ObjectFileRef& object,
+                                             size_t startNodeIndex,
+                                             size_t targetNodeIndex)
+  {
+    assert(startNodeIndex<nodes.size());
+    assert(targetNodeIndex<nodes.size());
+
+    size_t index=startNodeIndex;
+
+    while (index!=targetNodeIndex) {
+      size_t next=index<targetNodeIndex ? index+1 : index-1;
+
+      route.AddEntry(0,
+                     index==startNodeIndex ? nodes[index].GetId() : 0,
+                     index,
+                     object,
+                     next);
+
+      index=next;
+    }
+  }
+
+  /**
+   * Adds the entries of the shortest route from the source to the target to the route.
+   */
+  bool MapMatchingService::Matcher::AddRoute(RouteData& route,
+                                             const Candidate& source,
+                                             const Candidate& target,
+                                             double maxDistance)
+  {
+    RouteSearch search=SearchRoutes(source,
+                                    std::vector<Candidate>{target},
+                                    maxDistance);
+
+    if (search.distances.front()==infinity) {
+      return false;
+    }
+
+    const Way& sourceWay=*source.info->way;
+    const Way& targetWay=*target.info->way;
+
+    if (search.entryNodes.front()==0) {
+      AddNodes(route,
+               sourceWay.nodes,
+               sourceWay.GetObjectFileRef(),
+               source.nodeIndex,
+               target.nodeIndex);
+
+      return true;
+    }
+
+    std::vector<Id>            nodeIds;
+    std::vector<ObjectFileRef> objects;
+    Id                         current=search.entryNodes.front();
+
+    while (true) {
+      const Predecessor& predecessor=search.predecessors[current];
+
+      nodeIds.push_back(current);
+
+      if (predecessor.node==0) {
+        break;
+      }
+
+      objects.push_back(predecessor.object);
+      current=predecessor.node;
+    }
+
+    std::reverse(nodeIds.begin(),nodeIds.end());
+    std::reverse(objects.begin(),objects.end());
+
+    size_t exitIndex=GetNodeIndex(sourceWay.nodes,nodeIds.front(),source.segment);
+
+    assert(exitIndex<sourceWay.nodes.size());
+
+    AddNodes(route,
+             sourceWay.nodes,
+             sourceWay.GetObjectFileRef(),
+             source.nodeIndex,
+             exitIndex);
+
+    for (size_t i=0; i<objects.size(); i++) {
+      const std::vector<Point> *nodes=nullptr;
+      WayRef                   way;
+      AreaRef                  area;
+
+      if (objects[i].GetType()==refWay) {
+        if (!service.database->GetWayByOffset(objects[i].GetFileOffset(),way)) {
+          log.Error() << "Cannot load way " << objects[i].GetName();
+          return false;
+        }
+
+        nodes=&way->nodes;
+      }
+      else if (objects[i].GetType()==refArea) {
+        if (!service.database->GetAreaByOffset(objects[i].GetFileOffset(),area)) {
+          log.Error() << "Cannot load area " << objects[i].GetName();
+          return false;
+        }
+
+        nodes=&area->rings.front().nodes;
+      }
+      else {
+        assert(false);
+        return false;
+      }
+
+      size_t startIndex=GetNodeIndex(*nodes,nodeIds[i],0);
+      size_t targetIndex=GetNodeIndex(*nodes,nodeIds[i+1],startIndex);
+
+      assert(startIndex<nodes->size());
+      assert(targetIndex<nodes->size());
+
+      AddNodes(route,
+               *nodes,
+               objects[i],
+               startIndex,
+               targetIndex);
+    }
+
+    size_t entryIndex=GetNodeIndex(targetWay.nodes,nodeIds.back(),target.segment);
+
+    assert(entryIndex<targetWay.nodes.size());
+
+    AddNodes(route,
+             targetWay.nodes,
+             targetWay.GetObjectFileRef(),
+             entryIndex,
+             target.nodeIndex);
+
+    return true;
+  }
+
+  /**
+   * Selects the most probable sequence of candidates of the given continuous
+   * steps, stores the matched points and adds the route connecting them.
+   */
+  void MapMatchingService::Matcher::FinishPart(const std::vector<GeoCoord>& trace,
+                                               const std::vector<Step>& steps,
+                                               MapMatchingResult& result)
+  {
+    assert(!steps.empty());
+
+    std::vector<size_t> selected(steps.size());
+    const Step&         lastStep=steps.back();
+    size_t              best=(size_t)(std::max_element(lastStep.scores.begin(),
+                                                       lastStep.scores.end())-lastStep.scores.begin());
+
+    for (size_t s=steps.size(); s>0; s--) {
+      selected[s-1]=best;
+      best=steps[s-1].predecessors[best];
+    }
+
+    size_t    routeIndex=result.routes.size();
+    RouteData route;
+
+    for (size_t s=0; s<steps.size(); s++) {
+      const Candidate& candidate=steps[s].candidates[selected[s]];
+      MatchedPoint&    point=result.points[steps[s].observation];
+
+      point.matched=true;
+      point.position=RoutePosition(candidate.info->way->GetObjectFileRef(),
+                                   candidate.nodeIndex,
+                                   0);
+      point.location=candidate.location;
+      point.distance=Meters(candidate.distance);
+      point.routeIndex=routeIndex;
+
+      if (s>0) {
+        double directDistance=GetSphericalDistance(trace[steps[s-1].observation],
+                                                   trace[steps[s].observation]).AsMeter();
+
+        AddRoute(route,
+                 steps[s-1].candidates[selected[s-1]],
+                 candidate,
+                 GetMaxRouteDistance(directDistance));
+      }
+    }
+
+    if (!route.IsEmpty()) {
+      route.AddEntry(0,
+                     0,
+                     route.Entries().back().GetTargetNodeIndex(),
+                     ObjectFileRef(),
+                     0);
+    }
+
+    result.routes.push_back(std::move(route));
+  }
+
+  MapMatchingResult MapMatchingService::Matcher::Match(const std::vector<GeoCoord>& trace,
+                                                       const BreakerRef& breaker)
+  {
+    MapMatchingResult result;
+    std::vector<Step> steps;
+    double            sigma=service.parameter.GetMeasurementSigma().AsMeter();
+    double            beta=service.parameter.GetTransitionBeta().AsMeter();
+
+    result.points.resize(trace.size());
+
+    for (size_t o=0; o<trace.size(); o++) {
+      if (breaker &&
+          breaker->IsAborted()) {
+        result.points.assign(trace.size(),MatchedPoint());
+        result.routes.clear();
+
+        return result;
+      }
+
+      Step step;
+
+      step.observation=o;
+      step.candidates=GetCandidates(trace[o]);
+
+      if (step.candidates.empty()) {
+        continue;
+      }
+
+      step.scores.assign(step.candidates.size(),-infinity);
+      step.predecessors.assign(step.candidates.size(),0);
+
+      bool connected=false;
+
+      if (!steps.empty()) {
+        const Step& previous=steps.back();
+        double      directDistance=GetSphericalDistance(trace[previous.observation],
+                                                       trace[o]).AsMeter();
+        double      maxDistance=GetMaxRouteDistance(directDistance);
+
+        for (size_t p=0; p<previous.candidates.size(); p++) {
+          if (previous.scores[p]==-infinity) {
+            continue;
+          }
+
+          RouteSearch search=SearchRoutes(previous.candidates[p],
+                                          step.candidates,
+                                          maxDistance);
+
+          for (size_t c=0; c<step.candidates.size(); c++) {
+            if (search.distances[c]==infinity) {
+              continue;
+            }
+
+            double score=previous.scores[p]-std::fabs(search.distances[c]-directDistance)/beta;
+
+            if (score>step.scores[c]) {
+              step.scores[c]=score;
+              step.predecessors[c]=p;
+              connected=true;
+            }
+          }
+        }
+      }
+
+      if (!connected) {
+        // Start of a new continuous part of the trace
+        if (!steps.empty()) {
+          FinishPart(trace,steps,result);
+          steps.clear();
+        }
+
+        std::fill(step.scores.begin(),step.scores.end(),0.0);
+      }
+
+      double maxScore=-infinity;
+
+      for (size_t c=0; c<step.candidates.size(); c++) {
+        double normalizedDistance=step.candidates[c].distance/sigma;
+
+        step.scores[c]-=0.5*normalizedDistance*normalizedDistance;
+        maxScore=std::max(maxScore,step.scores[c]);
+      }
+
+      // Keep scores in a numerically stable range for long traces
+      for (auto& score : step.scores) {
+        score-=maxScore;
+      }
+
+      steps.push_back(std::move(step));
+    }
+
+    if (!steps.empty()) {
+      FinishPart(trace,steps,result);
+    }
+
+    return result;
+  }
+
+  /**
+   * Create a new instance of the map matching service.
+   *
+   * @param database
+   *    A valid reference to a database instance
+   * @param parameter
+   *    Parameters of the matching
+   */
+  MapMatchingService::MapMatchingService(const DatabaseRef& database,
+                                         const MapMatchingParameter& parameter)
+  : database(database),
+    parameter(parameter),
+    isOpen(false),
+    tileCache(parameter.GetTileCacheSize())
+  {
+    assert(database);
+  }
+
+  MapMatchingService::~MapMatchingService()
+  {
+    if (isOpen) {
+      Close();
+    }
+  }
+
+  /**
+   * Opens the routing data of the database.
+   *
+   * @return
+   *    True on success, else false
+   */
+  bool MapMatchingService::Open()
+  {
+    if (!routingDatabase.Open(database)) {
+      return false;
+    }
+
+    routableTypes=TypeInfoSet();
+
+    for (const auto& type : database->GetTypeConfig()->GetTypes()) {
+      if (!type->GetIgnore() &&
+          type->CanBeWay() &&
+          type->CanRoute()) {
+        routableTypes.Set(type);
+      }
+    }
+
+    isOpen=true;
+
+    return true;
+  }
+
+  bool MapMatchingService::IsOpen() const
+  {
+    return isOpen;
+  }
+
+  void MapMatchingService::Close()
+  {
+    routingDatabase.Close();
+
+    std::lock_guard<std::mutex> guard(tileCacheMutex);
+
+    tileCache.Flush();
+
+    isOpen=false;
+  }
+
+  /**
+   * Returns the ways of the tile routable by any vehicle, loading them if the tile
+   * is not cached yet. Tiles are loaded outside of the lock, so a tile may be
+   * loaded by several threads at the same time.
+   */
+  MapMatchingService::TileWaysRef MapMatchingService::GetTileWays(const TileId& tile)
+  {
+    uint64_t key=((uint64_t)tile.GetX() << 32u) | tile.GetY();
+
+    {
+      std::lock_guard<std::mutex> guard(tileCacheMutex);
+      TileWaysCache::CacheRef     entry;
+
+      if (tileCache.GetEntry(key,entry)) {
+        return entry->value;
+      }
+    }
+
+    auto ways=std::make_shared<std::vector<WayInfo>>();
+
+    try {
+      WayRegionSearchResult searchResult=database->LoadWaysInArea(routableTypes,
+                                                                  tile.GetBoundingBox(tileLevel));
+
+      ways->reserve(searchResult.GetWayResults().size());
+
+      for (const auto& entry : searchResult.GetWayResults()) {
+        WayInfo                   info;
+        const std::vector<Point>& nodes=entry.GetWay()->nodes;
+        double                    offset=0.0;
+
+        info.way=entry.GetWay();
+        info.boundingBox=info.way->GetBoundingBox();
+        info.offsets.reserve(nodes.size());
+
+        for (size_t i=0; i<nodes.size(); i++) {
+          if (i>0) {
+            offset+=GetSphericalDistance(nodes[i-1].GetCoord(),
+                                         nodes[i].GetCoord()).AsMeter();
+          }
+
+          info.offsets.push_back(offset);
+
+          RouteNodeRef routeNode;
+
+          if (nodes[i].IsRelevant() &&
+              routingDatabase.GetRouteNode(nodes[i].GetId(),routeNode) &&
+              routeNode) {
+            info.routeNodes.push_back(i);
+          }
+        }
+
+        ways->push_back(std::move(info));
+      }
+    }
+    catch (const OSMScoutException& e) {
+      log.Error() << "Cannot load ways of tile " << tile.GetX() << "," << tile.GetY() << ": " << e.GetDescription();
+
+      return ways;
+    }
+
+    std::lock_guard<std::mutex> guard(tileCacheMutex);
+
+    tileCache.SetEntry(TileWaysCache::CacheEntry(key,ways));
+
+    return ways;
+  }
+
+  MapMatchingResult MapMatchingService::Match(const RoutingProfile& profile,
+                                              const std::vector<GeoCoord>& trace,
+                                              const BreakerRef& breaker)
+  {
+    assert(isOpen);
+
+    Matcher matcher(*this,profile);
+
+    return matcher.Match(trace,breaker);
+  }
+
+  std::vector<MapMatchingResult> MapMatchingService::Match(const RoutingProfile& profile,
+                                                           const std::vector<std::vector<GeoCoord>>& traces,
+                                                           const BreakerRef& breaker)
+  {
+    std::vector<MapMatchingResult> results(traces.size());
+    std::atomic<size_t>            nextTrace(0);
+    size_t                         threadCount=parameter.GetThreadCount();
+
+    if (threadCount==0) {
+      threadCount=std::max((unsigned int)1,std::thread::hardware_concurrency());
+    }
+
+    threadCount=std::min(threadCount,traces.size());
+
+    auto worker=[&]() {
+      size_t index;
+
+      while ((index=nextTrace++)<traces.size()) {
+        results[index]=Match(profile,traces[index],breaker);
+      }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (size_t t=1; t<threadCount; t++) {
+      threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    return results;
+  }
+}
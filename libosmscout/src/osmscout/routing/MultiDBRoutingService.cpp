@@ -19,6 +19,8 @@
 */
 
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
@@ -67,6 +69,7 @@ namespace osmscout {
 
     RouterParameter routerParameter;
     routerParameter.SetDebugPerformance(debugPerformance);
+    routerParameter.SetUseObjectArena(useObjectArena);
 
     isOpen=true;
     for (auto& handle : handles) {
@@ -112,19 +115,37 @@ namespace osmscout {
     isOpen=false;
   }
 
+  /**
+   * Return the closest routable node in all databases. The databases are
+   * searched in parallel, one thread for each database. If multiple databases
+   * have a node with the same distance, the node of the database with the
+   * lower id is returned.
+   */
   RoutePositionResult MultiDBRoutingService::GetClosestRoutableNode(const GeoCoord& coord,
                                                                     const Distance &radius) const
   {
-    RoutePositionResult position, closestPosition;
+    std::vector<std::future<RoutePositionResult>> results;
+
+    results.reserve(handles.size());
+
+    for (const auto& handle : handles) {
+      results.push_back(std::async(handles.size()>1 ? std::launch::async : std::launch::deferred,
+                                   [&handle,&coord,&radius]() {
+                                     return handle.router->GetClosestRoutableNode(coord,
+                                                                                  *handle.profile,
+                                                                                  radius);
+                                   }));
+    }
+
+    RoutePositionResult closestPosition;
+
+    for (size_t i=0; i<results.size(); i++) {
+      RoutePositionResult position=results[i].get();
 
-    for (auto& handle : handles) {
-      position=handle.router->GetClosestRoutableNode(coord,
-                                                     *handle.profile,
-                                                     radius);
       if (position.IsValid() && position.GetDistance() < closestPosition.GetDistance()) {
         closestPosition=RoutePositionResult(RoutePosition(position.GetRoutePosition().GetObjectFileRef(),
                                                           position.GetRoutePosition().GetNodeIndex(),
-                                                          /*database*/ handle.dbId),
+                                                          /*database*/ handles[i].dbId),
                                             position.GetDistance());
       }
     }
@@ -167,6 +188,19 @@ namespace osmscout {
                                                  outPathIndex);
   }
 
+  double MultiDBRoutingService::GetCosts(const MultiDBRoutingState& /*state*/,
+                                         const DatabaseId databaseId,
+                                         const RoutingGraph& graph,
+                                         uint32_t inPathIndex,
+                                         uint32_t outPathIndex)
+  {
+    assert(handles.size()>databaseId);
+    return handles[databaseId].profile->GetCosts(graph,
+                                                 handles[databaseId].routingDatabase->GetObjectVariantData(),
+                                                 inPathIndex,
+                                                 outPathIndex);
+  }
+
   double MultiDBRoutingService::GetCosts(const MultiDBRoutingState& /*state*/,
                                          const DatabaseId database,
                                          const WayRef &way,
@@ -204,6 +238,20 @@ namespace osmscout {
                                                pathIndex);
   }
 
+  bool MultiDBRoutingService::CanUse(const MultiDBRoutingState& /*state*/,
+                                     const DatabaseId databaseId,
+                                     const RoutingGraph& graph,
+                                     uint32_t pathIndex)
+  {
+    return handles[databaseId].profile->CanUse(graph,
+                                               handles[databaseId].routingDatabase->GetObjectVariantData(),
+                                               pathIndex);
+  }
+
+  /**
+   * Load the given route nodes. Route nodes of different databases are loaded
+   * in parallel, one thread for each database.
+   */
   bool MultiDBRoutingService::GetRouteNodes(const std::set<DBId> &routeNodeIds,
                                             std::unordered_map<DBId,RouteNodeRef> &routeNodeMap)
   {
@@ -211,21 +259,40 @@ namespace osmscout {
     for (const auto &id:routeNodeIds){
       idMap[id.database].insert(id.id);
     }
+
+    std::vector<std::pair<DatabaseId,std::future<std::vector<RouteNodeRef>>>> results;
+    std::launch                                                                 policy=idMap.size()>1 ? std::launch::async : std::launch::deferred;
+    std::atomic<bool>                                                           success(true);
+
+    results.reserve(idMap.size());
+
     for (const auto &entry:idMap){
-      std::vector<RouteNodeRef>  nodes;
-      const std::set<Id>         &ids=entry.second;
+      RoutingDatabaseRef  routingDatabase=handles[entry.first].routingDatabase;
+      const std::set<Id>  &ids=entry.second;
+
+      results.emplace_back(entry.first,
+                           std::async(policy,
+                                      [routingDatabase,&ids,&success]() {
+                                        std::vector<RouteNodeRef> nodes;
+
+                                        if (!routingDatabase->GetRouteNodes(ids.begin(),
+                                                                            ids.end(),
+                                                                            ids.size(),
+                                                                            nodes)) {
+                                          success=false;
+                                        }
+
+                                        return nodes;
+                                      }));
+    }
 
-      if (!handles[entry.first].routingDatabase->GetRouteNodes(ids.begin(),
-                                                               ids.end(),
-                                                               ids.size(),
-                                                               nodes)) {
-        return false;
-      }
-      for (const auto &node:nodes) {
-        routeNodeMap[DBId(entry.first,node->GetId())]=node;
+    for (auto &result:results){
+      for (const auto &node:result.second.get()) {
+        routeNodeMap[DBId(result.first,node->GetId())]=node;
       }
     }
-    return true;
+
+    return success;
   }
 
   bool MultiDBRoutingService::GetRouteNode(const DBId &id,
@@ -234,12 +301,25 @@ namespace osmscout {
     return handles[id.database].routingDatabase->GetRouteNode(id.id, node);
   }
 
+  /**
+   * The in-memory routing graph does not support transitions between databases
+   * (see WalkToOtherDatabases()), so routing always uses the route node data files.
+   */
+  const RoutingGraph* MultiDBRoutingService::GetRoutingGraph(DatabaseId /*database*/) const
+  {
+    return nullptr;
+  }
+
   bool MultiDBRoutingService::GetWayByOffset(const DBFileOffset &offset,
                                              WayRef &way)
   {
     return handles[offset.database].database->GetWayByOffset(offset.offset,way);
   }
 
+  /**
+   * Load the given ways. Ways of different databases are loaded
+   * in parallel, one thread for each database.
+   */
   bool MultiDBRoutingService::GetWaysByOffset(const std::set<DBFileOffset> &wayOffsets,
                                               std::unordered_map<DBFileOffset,WayRef> &wayMap)
   {
@@ -247,16 +327,37 @@ namespace osmscout {
     for (const auto &offset:wayOffsets){
       offsetMap[offset.database].insert(offset.offset);
     }
+
+    std::vector<std::pair<DatabaseId,std::future<std::vector<WayRef>>>> results;
+    std::launch                                                         policy=offsetMap.size()>1 ? std::launch::async : std::launch::deferred;
+    std::atomic<bool>                                                   success(true);
+
+    results.reserve(offsetMap.size());
+
     for (const auto &entry:offsetMap){
-      std::vector<WayRef> ways;
-      if (!handles[entry.first].database->GetWaysByOffset(entry.second,ways)){
-        return false;
-      }
-      for (const auto &way:ways){
-        wayMap[DBFileOffset(entry.first,way->GetFileOffset())]=way;
+      DatabaseRef                database=handles[entry.first].database;
+      const std::set<FileOffset> &offsets=entry.second;
+
+      results.emplace_back(entry.first,
+                           std::async(policy,
+                                      [database,&offsets,&success]() {
+                                        std::vector<WayRef> ways;
+
+                                        if (!database->GetWaysByOffset(offsets,ways)) {
+                                          success=false;
+                                        }
+
+                                        return ways;
+                                      }));
+    }
+
+    for (auto &result:results){
+      for (const auto &way:result.second.get()){
+        wayMap[DBFileOffset(result.first,way->GetFileOffset())]=way;
       }
     }
-    return true;
+
+    return success;
   }
 
   bool MultiDBRoutingService::GetAreaByOffset(const DBFileOffset &offset,
@@ -265,6 +366,10 @@ namespace osmscout {
     return handles[offset.database].database->GetAreaByOffset(offset.offset,area);
   }
 
+  /**
+   * Load the given areas. Areas of different databases are loaded
+   * in parallel, one thread for each database.
+   */
   bool MultiDBRoutingService::GetAreasByOffset(const std::set<DBFileOffset> &areaOffsets,
                                                std::unordered_map<DBFileOffset,AreaRef> &areaMap)
   {
@@ -272,16 +377,37 @@ namespace osmscout {
     for (const auto &offset:areaOffsets){
       offsetMap[offset.database].insert(offset.offset);
     }
+
+    std::vector<std::pair<DatabaseId,std::future<std::vector<AreaRef>>>> results;
+    std::launch                                                          policy=offsetMap.size()>1 ? std::launch::async : std::launch::deferred;
+    std::atomic<bool>                                                    success(true);
+
+    results.reserve(offsetMap.size());
+
     for (const auto &entry:offsetMap){
-      std::vector<AreaRef> areas;
-      if (!handles[entry.first].database->GetAreasByOffset(entry.second,areas)){
-        return false;
-      }
-      for (const auto &area:areas){
-        areaMap[DBFileOffset(entry.first,area->GetFileOffset())]=area;
+      DatabaseRef                database=handles[entry.first].database;
+      const std::set<FileOffset> &offsets=entry.second;
+
+      results.emplace_back(entry.first,
+                           std::async(policy,
+                                      [database,&offsets,&success]() {
+                                        std::vector<AreaRef> areas;
+
+                                        if (!database->GetAreasByOffset(offsets,areas)) {
+                                          success=false;
+                                        }
+
+                                        return areas;
+                                      }));
+    }
+
+    for (auto &result:results){
+      for (const auto &area:result.second.get()){
+        areaMap[DBFileOffset(result.first,area->GetFileOffset())]=area;
       }
     }
-    return true;
+
+    return success;
   }
 
   bool MultiDBRoutingService::ResolveRouteDataJunctions(RouteData& route)
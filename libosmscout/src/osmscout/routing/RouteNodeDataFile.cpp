@@ -58,6 +58,7 @@ namespace osmscout {
   : datafile(datafile),
     cache(cacheSize)
   {
+    cache.SetMetrics(datafile);
   }
 
   bool RouteNodeDataFile::Open(const TypeConfigRef& typeConfig,
@@ -199,6 +200,39 @@ namespace osmscout {
     return node!=nullptr;
   }
 
+  /**
+   * Read all route nodes of the file, bypassing the page cache.
+   */
+  bool RouteNodeDataFile::GetAll(std::vector<RouteNode>& nodes) const
+  {
+    assert(IsOpen());
+
+    try {
+      size_t count=0;
+
+      for (const auto& entry : index) {
+        count+=entry.second.count;
+      }
+
+      nodes.reserve(nodes.size()+count);
+
+      for (const auto& entry : index) {
+        scanner.SetPos(entry.second.fileOffset);
+
+        for (uint32_t i=0; i<entry.second.count; i++) {
+          nodes.emplace_back();
+          nodes.back().Read(scanner);
+        }
+      }
+    }
+    catch (IOException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
+
+    return true;
+  }
+
   Pixel RouteNodeDataFile::GetTile(const GeoCoord& coord) const
   {
     return TileId::GetTile(magnification,coord).AsPixel();
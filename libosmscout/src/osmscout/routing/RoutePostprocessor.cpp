@@ -19,16 +19,20 @@
 
 #include <osmscout/routing/RoutePostprocessor.h>
 
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/TileId.h>
 
-#include <osmscout/LocationDescriptionService.h>
-
-#include <iostream>
 namespace osmscout {
 
+  static const MagnificationLevel corridorTileLevel(14);
+
   RoutePostprocessor::Postprocessor::~Postprocessor()
   {
     // no code
@@ -491,69 +495,131 @@ namespace osmscout {
   bool RoutePostprocessor::MotorwayJunctionPostprocessor::Process(const RoutePostprocessor& postprocessor,
                                                                   RouteDescription& description)
   {
-     ObjectFileRef           prevObject;
-     DatabaseId              prevDatabase=0;
-     ObjectFileRef           curObject;
-     DatabaseId              curDatabase;
-
-     WayRef                  way;
-     std::string             junctionRef;
-     std::string             junctionName;
-
-     for (auto& node: description.Nodes()) {
-       junctionName="";
-       junctionRef="";
-
-       // The last node does not have a pathWayId set, since we are not going anywhere!
-       if (!node.HasPathObject()) {
-         continue;
-       }
-
-       // Only load the next way, if it is different from the old one
-       curObject=node.GetPathObject();
-       curDatabase=node.GetDatabaseId();
-
-       if (curObject==prevObject && curDatabase==prevDatabase) {
-         continue;
-       }
-
-       switch (node.GetPathObject().GetType()) {
-       case refNone:
-         assert(false);
-         break;
-       case refNode:
-         assert(false);
-         break;
-       case refArea:
-         // TODO: junction in area?
-         break;
-       case refWay:
-         way=postprocessor.GetWay(node.GetDBFileOffset());
-
-         GeoCoord coord=way->GetCoord(node.GetCurrentNodeIndex());
-         if (!postprocessor.LoadJunction(curDatabase,
-                                         coord,
-                                         junctionRef,
-                                         junctionName)){
-           log.Error() << "Error loading junction!";
-           return false;
-         }
-
-         break;
-       }
-
-       if (!junctionName.empty() || !junctionRef.empty()) {
-         RouteDescription::NameDescriptionRef nameDescription=std::make_shared<RouteDescription::NameDescription>(junctionName,
-                                                                                                                  junctionRef);
-         node.AddDescription(RouteDescription::MOTORWAY_JUNCTION_DESC,
-                             std::make_shared<RouteDescription::MotorwayJunctionDescription>(nameDescription));
-       }
-
-       prevObject=curObject;
-       prevDatabase=curDatabase;
-     }
-
-     return true;
+    struct JunctionCandidate
+    {
+      RouteDescription::Node* node;
+      GeoCoord                coord;
+    };
+
+    ObjectFileRef                                            prevObject;
+    DatabaseId                                               prevDatabase=0;
+    ObjectFileRef                                            curObject;
+    DatabaseId                                               curDatabase;
+    std::unordered_map<DatabaseId,std::vector<JunctionCandidate>> candidates;
+
+    // Junctions are only searched at the nodes where the route enters a new way
+    for (auto& node: description.Nodes()) {
+      // The last node does not have a pathWayId set, since we are not going anywhere!
+      if (!node.HasPathObject()) {
+        continue;
+      }
+
+      // Only check the next way, if it is different from the old one
+      curObject=node.GetPathObject();
+      curDatabase=node.GetDatabaseId();
+
+      if (curObject==prevObject && curDatabase==prevDatabase) {
+        continue;
+      }
+
+      switch (node.GetPathObject().GetType()) {
+      case refNone:
+        assert(false);
+        break;
+      case refNode:
+        assert(false);
+        break;
+      case refArea:
+        break;
+      case refWay:
+        WayRef way=postprocessor.GetWay(node.GetDBFileOffset());
+
+        candidates[curDatabase].push_back(JunctionCandidate{&node,
+                                                            way->GetCoord(node.GetCurrentNodeIndex())});
+        break;
+      }
+
+      prevObject=curObject;
+      prevDatabase=curDatabase;
+    }
+
+    // Load the junctions of all candidates of a database at once
+    for (const auto& databaseCandidates : candidates) {
+      DatabaseId           dbId=databaseCandidates.first;
+      double               delta=1E-7;
+      std::vector<GeoBox>  corridor;
+      std::vector<NodeRef> junctions;
+
+      auto junctionTypes=postprocessor.junctionTypes.find(dbId);
+      assert(junctionTypes!=postprocessor.junctionTypes.end());
+
+      if (junctionTypes->second.Empty()) {
+        continue;
+      }
+
+      corridor.reserve(databaseCandidates.second.size());
+
+      for (const auto& candidate : databaseCandidates.second) {
+        corridor.emplace_back(GeoCoord(candidate.coord.GetLat()-delta,candidate.coord.GetLon()-delta),
+                              GeoCoord(candidate.coord.GetLat()+delta,candidate.coord.GetLon()+delta));
+      }
+
+      if (!postprocessor.LoadCorridorNodes(dbId,
+                                           corridor,
+                                           junctionTypes->second,
+                                           junctions)) {
+        log.Error() << "Error loading junctions!";
+        return false;
+      }
+
+      if (junctions.empty()) {
+        continue;
+      }
+
+      // Junction nodes are identical to nodes of the way
+      std::unordered_map<Id,NodeRef> junctionMap;
+
+      for (const auto& junction : junctions) {
+        junctionMap.emplace(junction->GetCoords().GetId(),
+                            junction);
+      }
+
+      auto nameReader=postprocessor.nameReaders.find(dbId);
+      assert(nameReader!=postprocessor.nameReaders.end());
+
+      auto refReader=postprocessor.refReaders.find(dbId);
+      assert(refReader!=postprocessor.refReaders.end());
+
+      for (const auto& candidate : databaseCandidates.second) {
+        auto junction=junctionMap.find(candidate.coord.GetId());
+
+        if (junction==junctionMap.end()) {
+          continue;
+        }
+
+        std::string       junctionRef;
+        std::string       junctionName;
+        RefFeatureValue  *refValue=refReader->second->GetValue(junction->second->GetFeatureValueBuffer());
+        NameFeatureValue *nameValue=nameReader->second->GetValue(junction->second->GetFeatureValueBuffer());
+
+        if (refValue!=nullptr) {
+          junctionRef=refValue->GetRef();
+        }
+
+        if (nameValue!=nullptr) {
+          junctionName=nameValue->GetName();
+        }
+
+        if (!junctionName.empty() || !junctionRef.empty()) {
+          RouteDescription::NameDescriptionRef nameDescription=std::make_shared<RouteDescription::NameDescription>(junctionName,
+                                                                                                                   junctionRef);
+          candidate.node->AddDescription(RouteDescription::MOTORWAY_JUNCTION_DESC,
+                                         std::make_shared<RouteDescription::MotorwayJunctionDescription>(nameDescription));
+        }
+      }
+    }
+
+    return true;
   }
 
   RoutePostprocessor::DestinationPostprocessor::DestinationPostprocessor()
@@ -995,293 +1061,102 @@ namespace osmscout {
     return true;
   }
 
-  class AdminRegionPathCollectorVisitor : public AdminRegionVisitor
+  /**
+   * Collect all POIs of the given types within the corridor along the route and assign
+   * them to the closest route segment.
+   */
+  std::map<ObjectFileRef,RoutePostprocessor::POIsPostprocessor::POIAtRoute>
+    RoutePostprocessor::POIsPostprocessor::CollectPOIsAtRoute(const RoutePostprocessor& postprocessor,
+                                                              const DatabaseId& databaseId,
+                                                              std::list<RouteDescription::Node>& nodes,
+                                                              const TypeInfoSet& nodeTypes,
+                                                              const TypeInfoSet& areaTypes) const
   {
-  private:
-    const Database&            database;
-    const std::list<WayRef>&   ways;
-    const std::list<AreaRef>&  areas;
-
-  public:
-    std::list<AdminRegionRef> regions;
-
-  public:
-    explicit AdminRegionPathCollectorVisitor(const Database& database,
-                                             const std::list<WayRef>&   ways,
-                                             const std::list<AreaRef>&  areas)
-      : database(database),
-        ways(ways),
-        areas(areas)
-    {
-      // no code
-    }
-
-    Action Visit(const AdminRegion& region) override
+    struct POICandidate
     {
-      AreaRef regionArea;
-
-      if (!database.GetAreaByOffset(region.object.GetFileOffset(),
-                                    regionArea)) {
-        return error;
-      }
-
-      GeoBox regionBox=regionArea->GetBoundingBox();
-
-      AdminRegionRef regionRef=std::make_shared<AdminRegion>(region);
-      bool           candidates=false;
-
-      for (const auto& way : ways) {
-        GeoBox box=way->GetBoundingBox();
-
-        if (box.Intersects(regionBox)) {
-          candidates=true;
-        }
-      }
-
-      for (const auto& area : areas) {
-        GeoBox box=area->GetBoundingBox();
+      ObjectFileRef                        object;
+      GeoBox                               boundingBox;
+      GeoCoord                             location;
+      RouteDescription::NameDescriptionRef name;
+    };
 
-        if (box.Intersects(regionBox)) {
-          candidates=true;
-        }
-      }
+    std::map<ObjectFileRef,POIAtRoute> poisAtRoute;
+    Distance                           maxDistance=Distance::Of<Meter>(30);
+    std::vector<GeoBox>                corridor;
 
+    // Route segments of the database, extended by the maximum distance
+    for (auto routeNode=nodes.begin();
+         routeNode!=nodes.end();
+         routeNode++) {
+      auto nextNode=routeNode;
 
-      if (candidates) {
-        regions.push_back(regionRef);
+      nextNode++;
 
-        return visitChildren;
+      if (nextNode==nodes.end() ||
+          !routeNode->HasPathObject() ||
+          routeNode->GetDatabaseId()!=databaseId) {
+        continue;
       }
 
-      return skipChildren;
-    }
-  };
-
-  class LocationNameByPathCollectorVisitor : public LocationVisitor
-  {
-  public:
-    const std::set<ObjectFileRef>&                 paths;
-    std::map<std::string,std::list<ObjectFileRef>> namePathsMap;
+      GeoBox segmentBox(routeNode->GetLocation(),
+                        nextNode->GetLocation());
 
-  public:
-    explicit LocationNameByPathCollectorVisitor(const std::set<ObjectFileRef>& paths)
-      : paths(paths)
-    {
+      segmentBox.Include(GeoBox::BoxAroundCircle(routeNode->GetLocation(),
+                                                 maxDistance));
+      segmentBox.Include(GeoBox::BoxAroundCircle(nextNode->GetLocation(),
+                                                 maxDistance));
 
+      corridor.push_back(segmentBox);
     }
 
-    bool Visit(const AdminRegion& /*adminRegion*/,
-               const PostalArea& /*postalArea*/,
-               const Location &location) override
-    {
-      for (const auto& object : location.objects) {
-        if (paths.find(object)!=paths.end()) {
-          namePathsMap[location.name].push_back(object);
-        }
-      }
-
-      return true;
+    if (corridor.empty()) {
+      return poisAtRoute;
     }
 
-  };
+    std::vector<NodeRef> poiNodes;
+    std::vector<AreaRef> poiAreas;
 
-  class LocationByNameCollectorVisitor : public LocationVisitor
-  {
-  public:
-    const std::map<std::string,std::list<ObjectFileRef>>& namePathsMap;
-    std::list<LocationRef>                                locations;
-    std::map<FileOffset,std::list<ObjectFileRef>>         locationPathsMap;
-
-  public:
-    explicit LocationByNameCollectorVisitor(const std::map<std::string,std::list<ObjectFileRef>>& namePathsMap)
-      : namePathsMap(namePathsMap)
-    {
+    if (!postprocessor.LoadCorridorNodes(databaseId,
+                                         corridor,
+                                         nodeTypes,
+                                         poiNodes) ||
+        !postprocessor.LoadCorridorAreas(databaseId,
+                                         corridor,
+                                         areaTypes,
+                                         poiAreas)) {
+      log.Error() << "Error loading POIs along the route";
+      return poisAtRoute;
     }
 
-    bool Visit(const AdminRegion& /*adminRegion*/,
-               const PostalArea& /*postalArea*/,
-               const Location &location) override
-    {
-      const auto namePathEntry=namePathsMap.find(location.name);
-
-      if (namePathEntry!=namePathsMap.end()) {
-        LocationRef locationRef=std::make_shared<Location>(location);
-
-        locations.push_back(locationRef);
-        locationPathsMap[location.locationOffset]=namePathEntry->second;
-      }
-
-      return true;
-    }
-  };
-
-  class AddressCollectorVisitor : public AddressVisitor
-  {
-  public:
-    const std::map<FileOffset,std::list<ObjectFileRef>>&   locationPathsMap;
-    std::map<ObjectFileRef,std::set<ObjectFileRef>>&       poiCandidates;
-
-  public:
-    AddressCollectorVisitor(const std::map<FileOffset,std::list<ObjectFileRef>>& locationPathsMap,
-                            std::map<ObjectFileRef,std::set<ObjectFileRef>>& poiCandidates)
-      : locationPathsMap(locationPathsMap),
-        poiCandidates(poiCandidates)
-    {
-    }
-
-    bool Visit(const AdminRegion& /*adminRegion*/,
-               const PostalArea& /*postalArea*/,
-               const Location &location,
-               const Address& address) override
-    {
-      const auto locationPaths=locationPathsMap.find(location.locationOffset);
-
-      for (const auto& path: locationPaths->second) {
-        poiCandidates[path].insert(address.object);
-      }
-
-      return true;
-    }
-  };
-
-  std::set<ObjectFileRef> RoutePostprocessor::POIsPostprocessor::CollectPaths(const std::list<RouteDescription::Node>& nodes) const
-  {
-    ObjectFileRef           prevObject;
-    ObjectFileRef           curObject;
-    std::set<ObjectFileRef> pathSet;
-
-    for (auto& pathNode : nodes) {
-      if (pathNode.HasPathObject()) {
-        curObject=pathNode.GetPathObject();
-
-        if (curObject!=prevObject) {
-          pathSet.insert(pathNode.GetPathObject());
-        }
-      }
-
-      prevObject=curObject;
-    }
-
-    return pathSet;
-  }
-
-  std::list<WayRef> RoutePostprocessor::POIsPostprocessor::CollectWays(const RoutePostprocessor& postprocessor,
-                                                                       const std::list<RouteDescription::Node>& nodes) const
-  {
-    ObjectFileRef     prevObject;
-    ObjectFileRef     curObject;
-    std::list<WayRef> ways;
-
-    for (auto& pathNode : nodes) {
-      if (pathNode.HasPathObject()) {
-        curObject=pathNode.GetPathObject();
+    std::vector<POICandidate>                          candidates;
+    std::map<TileId,std::vector<size_t>>               tileCandidates;
 
-        if (curObject!=prevObject) {
-          if (pathNode.GetPathObject().GetType()==refWay) {
-            ways.push_back(postprocessor.GetWay(pathNode.GetDBFileOffset()));
-          }
-        }
-      }
+    candidates.reserve(poiNodes.size()+poiAreas.size());
 
-      prevObject=curObject;
+    for (const auto& node : poiNodes) {
+      candidates.push_back(POICandidate{node->GetObjectFileRef(),
+                                        GeoBox(node->GetCoords(),node->GetCoords()),
+                                        node->GetCoords(),
+                                        postprocessor.GetNameDescription(databaseId,*node)});
     }
 
-    return ways;
-  }
-
-  std::list<AreaRef> RoutePostprocessor::POIsPostprocessor::CollectAreas(const RoutePostprocessor& postprocessor,
-                                                                         const std::list<RouteDescription::Node>& nodes) const
-  {
-    ObjectFileRef      prevObject;
-    ObjectFileRef      curObject;
-    std::list<AreaRef> areas;
-
-    for (auto& pathNode : nodes) {
-      if (pathNode.HasPathObject()) {
-        curObject=pathNode.GetPathObject();
-
-        if (curObject!=prevObject) {
-          if (pathNode.GetPathObject().GetType()==refArea) {
-            areas.push_back(postprocessor.GetArea(pathNode.GetDBFileOffset()));
-          }
-        }
-      }
-
-      prevObject=curObject;
+    for (const auto& area : poiAreas) {
+      candidates.push_back(POICandidate{area->GetObjectFileRef(),
+                                        area->GetBoundingBox(),
+                                        area->GetBoundingBox().GetCenter(),
+                                        postprocessor.GetNameDescription(databaseId,*area)});
     }
 
-    return areas;
-  }
-
-  std::map<ObjectFileRef,std::set<ObjectFileRef>> RoutePostprocessor::POIsPostprocessor::CollectPOICandidates(const Database& database,
-                                                                                                              const std::set<ObjectFileRef>& paths,
-                                                                                                              const std::list<WayRef>& ways,
-                                                                                                              const std::list<AreaRef>& areas)
-  {
-    std::map<ObjectFileRef,std::set<ObjectFileRef>> poiCandidates;
-
-    StopClock scanLocationTime;
-
-    AdminRegionPathCollectorVisitor regionCollector(database,
-                                                    ways,
-                                                    areas);
-
-    database.GetLocationIndex()->VisitAdminRegions(regionCollector);
-
-    for (const auto& adminRegion : regionCollector.regions) {
-      LocationNameByPathCollectorVisitor locationCollector(paths);
-
-      database.GetLocationIndex()->VisitLocations(*adminRegion,
-                                                  locationCollector,
-                                                  false);
-
-      if (locationCollector.namePathsMap.empty()) {
-        continue;
-      }
-
-      LocationByNameCollectorVisitor location2Collector(locationCollector.namePathsMap);
-
-      database.GetLocationIndex()->VisitLocations(*adminRegion,
-                                                   location2Collector,
-                                                   false);
-
-      AddressCollectorVisitor addressCollector(location2Collector.locationPathsMap,
-                                               poiCandidates);
-
-      for (const auto& location : location2Collector.locations) {
-        AdminRegion fakeRegion;
-        PostalArea  fakePostalArea;
-
-        database.GetLocationIndex()->VisitAddresses(*adminRegion,
-                                                    fakePostalArea,
-                                                    *location,
-                                                    addressCollector);
+    // Bucket the candidates by tile, so that each segment only checks the candidates nearby
+    for (size_t i=0; i<candidates.size(); i++) {
+      for (const auto& tile : TileIdBox(Magnification(corridorTileLevel),
+                                        candidates[i].boundingBox)) {
+        tileCandidates[tile].push_back(i);
       }
     }
 
-    scanLocationTime.Stop();
-
-    std::cout << "Scanning locations: " << scanLocationTime.ResultString() << std::endl;
-
-    return poiCandidates;
-  }
-
-  std::map<ObjectFileRef,RoutePostprocessor::POIsPostprocessor::POIAtRoute>
-    RoutePostprocessor::POIsPostprocessor::AnalysePOICandidates(const RoutePostprocessor& postprocessor,
-                                                                const DatabaseId& databaseId,
-                                                                std::list<RouteDescription::Node>& nodes,
-                                                                const TypeInfoSet& nodeTypes,
-                                                                const TypeInfoSet& areaTypes,
-                                                                const std::unordered_map<FileOffset,NodeRef>& nodeMap,
-                                                                const std::unordered_map<FileOffset,AreaRef>& areaMap,
-                                                                const std::map<ObjectFileRef,std::set<ObjectFileRef>>& poiCandidates)
-  {
-    std::map<ObjectFileRef,RoutePostprocessor::POIsPostprocessor::POIAtRoute> poisAtRoute;
-
-    NodeRef                node;
-    AreaRef                area;
-
-    StopClock analysingCandidatesTime;
+    auto                corridorBox=corridor.begin();
+    std::vector<size_t> segmentCandidates;
 
     for (auto routeNode=nodes.begin();
          routeNode!=nodes.end();
@@ -1291,87 +1166,80 @@ namespace osmscout {
       nextNode++;
 
       if (nextNode==nodes.end() ||
-          !routeNode->HasPathObject()) {
+          !routeNode->HasPathObject() ||
+          routeNode->GetDatabaseId()!=databaseId) {
         continue;
       }
 
       GeoCoord curCoord=routeNode->GetLocation();
       GeoCoord nextCoord=nextNode->GetLocation();
 
-      const auto pathPoiCandidates=poiCandidates.find(routeNode->GetPathObject());
-
-      if (pathPoiCandidates!=poiCandidates.end()) {
-        for (const auto& candidate : pathPoiCandidates->second) {
-          GeoCoord    location;
-          GeoCoord    intersection;
-          double      r;
-          RouteDescription::NameDescriptionRef name;
+      segmentCandidates.clear();
 
-          switch (candidate.GetType()) {
-          case refNone:
-          case refWay:
-            assert(false);
-            break;
-          case refNode:
-            node=nodeMap.at(candidate.GetFileOffset());
-            if (!nodeTypes.IsSet(node->GetType())) {
-              continue;
-            }
-            name=postprocessor.GetNameDescription(databaseId,*node);
-            location=node->GetCoords();
-            DistanceToSegment(location,
-                              curCoord,
-                              nextCoord,
-                              r,
-                              intersection);
-            break;
-          case refArea:
-            area=areaMap.at(candidate.GetFileOffset());
-            if (!areaTypes.IsSet(area->GetType())) {
-              continue;
-            }
-            name=postprocessor.GetNameDescription(databaseId,*area);
-            DistanceToSegment(area->GetBoundingBox(),
-                              curCoord,
-                              nextCoord,
-                              location,
-                              intersection);
-            break;
-          }
+      for (const auto& tile : TileIdBox(Magnification(corridorTileLevel),
+                                        *corridorBox)) {
+        auto tileEntry=tileCandidates.find(tile);
 
+        if (tileEntry!=tileCandidates.end()) {
+          segmentCandidates.insert(segmentCandidates.end(),
+                                   tileEntry->second.begin(),
+                                   tileEntry->second.end());
+        }
+      }
 
-          if (!name) {
-            continue;
-          }
+      corridorBox++;
+
+      std::sort(segmentCandidates.begin(),
+                segmentCandidates.end());
+      segmentCandidates.erase(std::unique(segmentCandidates.begin(),
+                                          segmentCandidates.end()),
+                              segmentCandidates.end());
+
+      for (const auto index : segmentCandidates) {
+        const POICandidate& candidate=candidates[index];
+        GeoCoord            location;
+        GeoCoord            intersection;
+        double              r;
+
+        if (candidate.object.GetType()==refNode) {
+          location=candidate.location;
+          DistanceToSegment(location,
+                            curCoord,
+                            nextCoord,
+                            r,
+                            intersection);
+        }
+        else {
+          DistanceToSegment(candidate.boundingBox,
+                            curCoord,
+                            nextCoord,
+                            location,
+                            intersection);
+        }
 
-          Distance distance=GetEllipsoidalDistance(location,
-                                                   intersection);
+        Distance distance=GetEllipsoidalDistance(location,
+                                                 intersection);
 
-          if (distance<Distance::Of<Meter>(30)) {
-            auto existingPoiAtRoute=poisAtRoute.find(candidate);
+        if (distance<maxDistance) {
+          auto existingPoiAtRoute=poisAtRoute.find(candidate.object);
 
-            if (existingPoiAtRoute!=poisAtRoute.end() &&
-                existingPoiAtRoute->second.distance<distance) {
-              continue;
-            }
+          if (existingPoiAtRoute!=poisAtRoute.end() &&
+              existingPoiAtRoute->second.distance<distance) {
+            continue;
+          }
 
-            POIAtRoute poiAtRoute;
+          POIAtRoute poiAtRoute;
 
-            poiAtRoute.distance=distance;
-            poiAtRoute.name=name;
-            poiAtRoute.object=candidate;
-            poiAtRoute.node=routeNode;
+          poiAtRoute.distance=distance;
+          poiAtRoute.name=candidate.name;
+          poiAtRoute.object=candidate.object;
+          poiAtRoute.node=routeNode;
 
-            poisAtRoute[candidate]=poiAtRoute;
-          }
+          poisAtRoute[candidate.object]=poiAtRoute;
         }
       }
     }
 
-    analysingCandidatesTime.Stop();
-
-    std::cout << "Analysing candidates: " << analysingCandidatesTime.ResultString() << std::endl;
-
     return poisAtRoute;
   }
 
@@ -1391,27 +1259,10 @@ namespace osmscout {
   bool RoutePostprocessor::POIsPostprocessor::Process(const RoutePostprocessor& postprocessor,
                                                       RouteDescription& description)
   {
-    TypeInfoSet        nodeTypes;
-    TypeInfoSet        areaTypes;
-    ObjectFileRef      prevObject;
-    ObjectFileRef      curObject;
-    NodeRef            node;
-    WayRef             way;
-    AreaRef            area;
-
-    StopClock loadDataTime;
-
-    std::set<ObjectFileRef> paths=CollectPaths(description.Nodes());
-    std::list<WayRef>       ways=CollectWays(postprocessor,description.Nodes());
-    std::list<AreaRef>      areas=CollectAreas(postprocessor,description.Nodes());
-
-    loadDataTime.Stop();
-    std::cout << "Loading path data: " << loadDataTime.ResultString() << std::endl;
-
-    StopClock loadingCandidatesTime;
-
     for (DatabaseId databaseId=0; databaseId<postprocessor.databases.size(); databaseId++) {
-      auto database=postprocessor.databases[databaseId];
+      auto        database=postprocessor.databases[databaseId];
+      TypeInfoSet nodeTypes(*database->GetTypeConfig());
+      TypeInfoSet areaTypes(*database->GetTypeConfig());
 
       for (const auto& type : database->GetTypeConfig()->GetTypes()) {
         if (type->IsInGroup("routingPOI")) {
@@ -1425,55 +1276,11 @@ namespace osmscout {
         }
       }
 
-      std::map<ObjectFileRef,std::set<ObjectFileRef>> poiCandidates=CollectPOICandidates(*database,
-                                                                                         paths,
-                                                                                         ways,
-                                                                                         areas);
-
-      ways.clear();
-      areas.clear();
-
-      std::set<FileOffset> nodeOffsets;
-      std::set<FileOffset> areaOffsets;
-
-      for (const auto& pathPoiCandidates: poiCandidates) {
-        for (const auto& candidate : pathPoiCandidates.second) {
-          switch (candidate.GetType()) {
-          case refNone:
-          case refWay:
-            assert(false);
-            break;
-          case refNode:
-            nodeOffsets.insert(candidate.GetFileOffset());
-            break;
-          case refArea:
-            areaOffsets.insert(candidate.GetFileOffset());
-            break;
-          }
-        }
-      }
-
-      std::unordered_map<FileOffset,NodeRef> nodeMap;
-      std::unordered_map<FileOffset,AreaRef> areaMap;
-
-      database->GetNodesByOffset(nodeOffsets,
-                                 nodeMap);
-
-      database->GetAreasByOffset(areaOffsets,
-                                 areaMap);
-
-      loadingCandidatesTime.Stop();
-
-      std::cout << "Loading candidates: " << loadingCandidatesTime.ResultString() << std::endl;
-
-      std::map<ObjectFileRef,POIAtRoute> poisAtRoute=AnalysePOICandidates(postprocessor,
-                                                                          databaseId,
-                                                                          description.Nodes(),
-                                                                          nodeTypes,
-                                                                          areaTypes,
-                                                                          nodeMap,
-                                                                          areaMap,
-                                                                          poiCandidates);
+      std::map<ObjectFileRef,POIAtRoute> poisAtRoute=CollectPOIsAtRoute(postprocessor,
+                                                                        databaseId,
+                                                                        description.Nodes(),
+                                                                        nodeTypes,
+                                                                        areaTypes);
 
       SortInCollectedPOIs(databaseId,
                           poisAtRoute);
@@ -1712,23 +1519,50 @@ namespace osmscout {
     return std::make_shared<RouteDescription::NameDescription>(name,ref);
   }
 
-  bool RoutePostprocessor::LoadJunction(DatabaseId dbId,
-                                        GeoCoord coord,
-                                        std::string junctionRef,
-                                        std::string junctionName) const
+  /**
+   * Converts the given boxes into the list of tiles (of level corridorTileLevel) covering
+   * them. Consecutive tiles of the same row are merged into one box, so that each
+   * part of the corridor is only requested once from the index.
+   */
+  std::vector<GeoBox> RoutePostprocessor::GetCorridorTiles(const std::vector<GeoBox>& boxes)
   {
-    double                  delta=1E-7;
-    std::vector<FileOffset> nodeOffsets;
-    std::vector<NodeRef>    nodes;
+    std::set<TileId>    tiles;
+    std::vector<GeoBox> corridor;
 
-    auto nameReaderIt=nameReaders.find(dbId);
-    assert(nameReaderIt!=nameReaders.end());
-    NameFeatureValueReader* nameReader=nameReaderIt->second;
+    for (const auto& box : boxes) {
+      for (const auto& tile : TileIdBox(Magnification(corridorTileLevel),
+                                        box)) {
+        tiles.insert(tile);
+      }
+    }
+
+    auto tile=tiles.begin();
+
+    while (tile!=tiles.end()) {
+      GeoBox tileBox=tile->GetBoundingBox(corridorTileLevel);
+      auto   lastTile=tile;
 
-    auto refReaderIt=refReaders.find(dbId);
-    assert(refReaderIt!=refReaders.end());
-    RefFeatureValueReader* refReader=refReaderIt->second;
+      tile++;
+
+      while (tile!=tiles.end() &&
+             tile->GetY()==lastTile->GetY() &&
+             tile->GetX()==lastTile->GetX()+1) {
+        tileBox.Include(tile->GetBoundingBox(corridorTileLevel));
+        lastTile=tile;
+        tile++;
+      }
+
+      corridor.push_back(tileBox);
+    }
 
+    return corridor;
+  }
+
+  bool RoutePostprocessor::LoadCorridorNodes(DatabaseId dbId,
+                                             const std::vector<GeoBox>& corridor,
+                                             const TypeInfoSet& types,
+                                             std::vector<NodeRef>& nodes) const
+  {
     assert(dbId<databases.size() && databases[dbId]);
     DatabaseRef database=databases[dbId];
 
@@ -1738,54 +1572,68 @@ namespace osmscout {
       return false;
     }
 
-    auto it=junctionTypes.find(dbId);
-    assert(it!=junctionTypes.end());
-    TypeInfoSet nodeTypes=it->second;
+    std::vector<FileOffset> nodeOffsets;
 
-    TypeInfoSet loadedTypes;
-    GeoBox boundingBox(GeoCoord(coord.GetLat()-delta,coord.GetLon()-delta),
-                       GeoCoord(coord.GetLat()+delta,coord.GetLon()+delta));
+    for (const auto& tileBox : GetCorridorTiles(corridor)) {
+      TypeInfoSet loadedTypes;
 
-    nodeOffsets.clear();
-    if (!areaNodeIndex->GetOffsets(boundingBox,
-                                   nodeTypes,
-                                   nodeOffsets,
-                                   loadedTypes)) {
-      log.Error() << "Error getting nodes from area node index!";
-      return false;
+      if (!areaNodeIndex->GetOffsets(tileBox,
+                                     types,
+                                     nodeOffsets,
+                                     loadedTypes)) {
+        log.Error() << "Error getting nodes from area node index!";
+        return false;
+      }
     }
 
     if (nodeOffsets.empty()) {
       return true;
     }
 
-    nodes.clear();
     std::sort(nodeOffsets.begin(),nodeOffsets.end());
+    nodeOffsets.erase(std::unique(nodeOffsets.begin(),
+                                  nodeOffsets.end()),
+                      nodeOffsets.end());
 
     if (!database->GetNodesByOffset(nodeOffsets,
-                                   nodes)) {
+                                    nodes)) {
       log.Error() << "Error reading nodes in area!";
       return false;
     }
 
-    for (const auto& node : nodes) {
-      if (fabs(node->GetCoords().GetLat() - coord.GetLat()) < delta &&
-          fabs(node->GetCoords().GetLon() - coord.GetLon()) < delta) {
-        RefFeatureValue *refFeatureValue=refReader->GetValue(node->GetFeatureValueBuffer());
+    return true;
+  }
 
-        if (refFeatureValue!=nullptr) {
-          junctionRef=refFeatureValue->GetRef();
-        }
+  bool RoutePostprocessor::LoadCorridorAreas(DatabaseId dbId,
+                                             const std::vector<GeoBox>& corridor,
+                                             const TypeInfoSet& types,
+                                             std::vector<AreaRef>& areas) const
+  {
+    assert(dbId<databases.size() && databases[dbId]);
+    DatabaseRef database=databases[dbId];
 
-        NameFeatureValue *nameFeatureValue=nameReader->GetValue(node->GetFeatureValueBuffer());
+    if (types.Empty()) {
+      return true;
+    }
 
-        if (nameFeatureValue!=nullptr) {
-          junctionName = nameFeatureValue->GetName();
-        }
+    std::unordered_set<FileOffset> loadedOffsets;
 
-        break;
+    try {
+      for (const auto& tileBox : GetCorridorTiles(corridor)) {
+        AreaRegionSearchResult result=database->LoadAreasInArea(types,
+                                                                tileBox);
+
+        for (const auto& entry : result.GetAreaResults()) {
+          if (loadedOffsets.insert(entry.GetArea()->GetFileOffset()).second) {
+            areas.push_back(entry.GetArea());
+          }
+        }
       }
     }
+    catch (const OSMScoutException& e) {
+      log.Error() << e.GetDescription();
+      return false;
+    }
 
     return true;
   }
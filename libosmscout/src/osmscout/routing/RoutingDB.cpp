@@ -21,6 +21,8 @@
 
 #include <osmscout/routing/RoutingService.h>
 
+#include <osmscout/util/StopClock.h>
+
 namespace osmscout {
 
   RoutingDatabase::RoutingDatabase()
@@ -47,14 +49,41 @@ namespace osmscout {
       return false;
     }
 
+    if (database->GetParameter().GetRouterDataInMemory() &&
+        !LoadRoutingGraph()) {
+      return false;
+    }
+
     return objectVariantDataFile.Load(*(database->GetTypeConfig()),
                                       AppendFileToDir(database->GetPath(),
                                                       RoutingService::GetData2Filename(osmscout::RoutingService::DEFAULT_FILENAME_BASE)));
   }
 
+  bool RoutingDatabase::LoadRoutingGraph()
+  {
+    StopClock              stopClock;
+    std::vector<RouteNode> routeNodes;
+
+    if (!routeNodeDataFile.GetAll(routeNodes)) {
+      log.Error() << "Cannot load route nodes of '" << path << "' into memory!";
+      return false;
+    }
+
+    routingGraph.Build(routeNodes);
+
+    stopClock.Stop();
+
+    log.Debug() << "Loaded routing graph with " << routingGraph.GetNodeCount() << " nodes and "
+                << routingGraph.GetPathCount() << " paths ("
+                << routingGraph.GetMemoryUsage()/1024 << " KiB) in " << stopClock.ResultString();
+
+    return true;
+  }
+
   void RoutingDatabase::Close()
   {
     routeNodeDataFile.Close();
+    routingGraph.Clear();
     junctionDataFile.Close();
 
     typeConfig.reset();
@@ -0,0 +1,190 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/routing/RoutingGraph.h>
+
+#include <algorithm>
+
+namespace osmscout {
+
+  const uint32_t RoutingGraph::InvalidIndex;
+
+  template<typename T>
+  static size_t GetVectorMemoryUsage(const std::vector<T>& vector)
+  {
+    return vector.capacity()*sizeof(T);
+  }
+
+  /**
+   * Build the graph from the given route nodes. The route nodes are sorted by id
+   * in place. Paths to route nodes that are not part of the given list get
+   * InvalidIndex as target.
+   */
+  void RoutingGraph::Build(std::vector<RouteNode>& routeNodes)
+  {
+    Clear();
+
+    std::sort(routeNodes.begin(),
+              routeNodes.end(),
+              [](const RouteNode& a, const RouteNode& b) {
+                return a.GetId()<b.GetId();
+              });
+
+    size_t pathCount=0;
+    size_t objectCount=0;
+    size_t excludeCount=0;
+
+    for (const auto& routeNode : routeNodes) {
+      pathCount+=routeNode.paths.size();
+      objectCount+=routeNode.objects.size();
+      excludeCount+=routeNode.excludes.size();
+    }
+
+    nodeIds.reserve(routeNodes.size());
+    nodeCoords.reserve(routeNodes.size());
+    pathStart.reserve(routeNodes.size()+1);
+    objectStart.reserve(routeNodes.size()+1);
+    excludeStart.reserve(routeNodes.size()+1);
+
+    pathTargets.reserve(pathCount);
+    pathDistances.reserve(pathCount);
+    pathObjects.reserve(pathCount);
+    pathFlags.reserve(pathCount);
+
+    objects.reserve(objectCount);
+    objectVariantIndexes.reserve(objectCount);
+
+    excludeSources.reserve(excludeCount);
+    excludeTargets.reserve(excludeCount);
+
+    for (const auto& routeNode : routeNodes) {
+      nodeIds.push_back(routeNode.GetId());
+      nodeCoords.push_back(routeNode.GetCoord());
+    }
+
+    for (const auto& routeNode : routeNodes) {
+      auto firstObject=(uint32_t)objects.size();
+
+      pathStart.push_back((uint32_t)pathTargets.size());
+      objectStart.push_back(firstObject);
+      excludeStart.push_back((uint32_t)excludeSources.size());
+
+      for (const auto& object : routeNode.objects) {
+        objects.push_back(object.object);
+        objectVariantIndexes.push_back(object.objectVariantIndex);
+      }
+
+      for (const auto& path : routeNode.paths) {
+        pathTargets.push_back(FindNode(path.id));
+        pathDistances.push_back(path.distance);
+        pathObjects.push_back(firstObject+path.objectIndex);
+        pathFlags.push_back(path.flags);
+      }
+
+      for (const auto& exclude : routeNode.excludes) {
+        excludeSources.push_back(exclude.source);
+        excludeTargets.push_back(firstObject+exclude.targetIndex);
+      }
+    }
+
+    pathStart.push_back((uint32_t)pathTargets.size());
+    objectStart.push_back((uint32_t)objects.size());
+    excludeStart.push_back((uint32_t)excludeSources.size());
+  }
+
+  void RoutingGraph::Clear()
+  {
+    nodeIds.clear();
+    nodeCoords.clear();
+    pathStart.clear();
+    objectStart.clear();
+    excludeStart.clear();
+
+    pathTargets.clear();
+    pathDistances.clear();
+    pathObjects.clear();
+    pathFlags.clear();
+
+    objects.clear();
+    objectVariantIndexes.clear();
+
+    excludeSources.clear();
+    excludeTargets.clear();
+  }
+
+  /**
+   * Return the index of the route node with the given id or InvalidIndex,
+   * if there is no such route node.
+   */
+  uint32_t RoutingGraph::FindNode(Id id) const
+  {
+    auto entry=std::lower_bound(nodeIds.begin(),
+                                nodeIds.end(),
+                                id);
+
+    if (entry==nodeIds.end() ||
+        *entry!=id) {
+      return InvalidIndex;
+    }
+
+    return (uint32_t)(entry-nodeIds.begin());
+  }
+
+  /**
+   * Start a new search on a graph with the given number of nodes. All nodes
+   * are unset afterwards.
+   */
+  void RoutingGraphSearchIndex::Reset(size_t nodeCount)
+  {
+    if (entries.size()!=nodeCount) {
+      entries.assign(nodeCount,Entry{0,0});
+      generation=0;
+    }
+
+    generation++;
+
+    // On overflow entries of the very first generation would count as set again
+    if (generation==0) {
+      std::fill(entries.begin(),
+                entries.end(),
+                Entry{0,0});
+      generation=1;
+    }
+  }
+
+  /**
+   * Return the number of bytes allocated by the graph
+   */
+  size_t RoutingGraph::GetMemoryUsage() const
+  {
+    return GetVectorMemoryUsage(nodeIds)+
+           GetVectorMemoryUsage(nodeCoords)+
+           GetVectorMemoryUsage(pathStart)+
+           GetVectorMemoryUsage(objectStart)+
+           GetVectorMemoryUsage(excludeStart)+
+           GetVectorMemoryUsage(pathTargets)+
+           GetVectorMemoryUsage(pathDistances)+
+           GetVectorMemoryUsage(pathObjects)+
+           GetVectorMemoryUsage(pathFlags)+
+           GetVectorMemoryUsage(objects)+
+           GetVectorMemoryUsage(objectVariantIndexes)+
+           GetVectorMemoryUsage(excludeSources)+
+           GetVectorMemoryUsage(excludeTargets);
+  }
+}
@@ -194,17 +194,18 @@ namespace osmscout {
                                       const std::vector<ObjectVariantData>& objectVariantData,
                                       size_t pathIndex) const
   {
-    if (!(currentNode.paths[pathIndex].flags & vehicleRouteNodeBit)) {
-      return false;
-    }
-
-
-    size_t      index=currentNode.paths[pathIndex].objectIndex;
-    TypeInfoRef type=objectVariantData[currentNode.objects[index].objectVariantIndex].type;
+    const RouteNode::Path& path=currentNode.paths[pathIndex];
 
-    size_t typeIndex=type->GetIndex();
+    return CanUse(path.flags,
+                  objectVariantData[currentNode.objects[path.objectIndex].objectVariantIndex]);
+  }
 
-    return typeIndex<speeds.size() && speeds[typeIndex]>0.0;
+  bool AbstractRoutingProfile::CanUse(const RoutingGraph& graph,
+                                      const std::vector<ObjectVariantData>& objectVariantData,
+                                      uint32_t pathIndex) const
+  {
+    return CanUse(graph.GetPathFlags(pathIndex),
+                  objectVariantData[graph.GetObjectVariantIndex(graph.GetPathObjectIndex(pathIndex))]);
   }
 
   bool AbstractRoutingProfile::CanUse(const Area& area) const
@@ -51,7 +51,8 @@ namespace osmscout {
   }
 
   RouterParameter::RouterParameter()
-  : debugPerformance(false)
+  : debugPerformance(false),
+    useObjectArena(false)
   {
     // no code
   }
@@ -61,11 +62,28 @@ namespace osmscout {
     debugPerformance=debug;
   }
 
+  /**
+   * If set, ways and areas only loaded temporarily while routing (e.g. while
+   * searching for the closest routable node) are allocated from a request local
+   * ObjectArena and bypass the data file caches. This is useful if routing
+   * is done on a database that is not shared with rendering, where the cache
+   * would only hold objects that are not requested again.
+   */
+  void RouterParameter::SetUseObjectArena(bool useObjectArena)
+  {
+    this->useObjectArena=useObjectArena;
+  }
+
   bool RouterParameter::IsDebugPerformance() const
   {
     return debugPerformance;
   }
 
+  bool RouterParameter::GetUseObjectArena() const
+  {
+    return useObjectArena;
+  }
+
   RoutingProgress::~RoutingProgress()
   {
     // no code
@@ -25,6 +25,7 @@
 
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
+#include <osmscout/util/ObjectArena.h>
 #include <osmscout/util/StopClock.h>
 
 #include <osmscout/routing/RoutingService.h>
@@ -88,6 +89,14 @@ namespace osmscout {
     return profile.CanUse(routeNode,routingDatabase.GetObjectVariantData(),pathIndex);
   }
 
+  bool SimpleRoutingService::CanUse(const RoutingProfile& profile,
+                                    const DatabaseId /*database*/,
+                                    const RoutingGraph& graph,
+                                    uint32_t pathIndex)
+  {
+    return profile.CanUse(graph,routingDatabase.GetObjectVariantData(),pathIndex);
+  }
+
   bool SimpleRoutingService::CanUseForward(const RoutingProfile& profile,
                                            const DatabaseId& /*database*/,
                                            const WayRef& way)
@@ -111,6 +120,15 @@ namespace osmscout {
     return profile.GetCosts(routeNode,routingDatabase.GetObjectVariantData(),inPathIndex,outPathIndex);
   }
 
+  double SimpleRoutingService::GetCosts(const RoutingProfile& profile,
+                                        const DatabaseId /*database*/,
+                                        const RoutingGraph& graph,
+                                        uint32_t inPathIndex,
+                                        uint32_t outPathIndex)
+  {
+    return profile.GetCosts(graph,routingDatabase.GetObjectVariantData(),inPathIndex,outPathIndex);
+  }
+
   double SimpleRoutingService::GetCosts(const RoutingProfile& profile,
                                         const DatabaseId /*database*/,
                                         const WayRef &way,
@@ -172,6 +190,11 @@ namespace osmscout {
                                         node);
   }
 
+  const RoutingGraph* SimpleRoutingService::GetRoutingGraph(DatabaseId /*database*/) const
+  {
+    return routingDatabase.GetRoutingGraph();
+  }
+
   bool SimpleRoutingService::GetWayByOffset(const DBFileOffset &offset,
                                             WayRef &way)
   {
@@ -514,6 +537,12 @@ namespace osmscout {
     std::vector<DataBlockSpan>     wayAreaSpans;
     std::vector<osmscout::AreaRef> areas;
     std::vector<osmscout::WayRef>  ways;
+    ObjectArenaRef                 arena;
+
+    // Objects are only needed while searching, so optionally allocate them from a request local arena
+    if (useObjectArena) {
+      arena=std::make_shared<ObjectArena>();
+    }
 
     if (!areaWayIndex->GetOffsets(boundingBox,
                                   wayRoutableTypes,
@@ -537,14 +566,16 @@ namespace osmscout {
     if (!wayDataFile->GetByOffset(wayWayOffsets.begin(),
                                   wayWayOffsets.end(),
                                   wayWayOffsets.size(),
-                                  ways)) {
+                                  ways,
+                                  arena)) {
       log.Error() << "Error reading ways in area!";
       return position;
     }
 
     if (!areaDataFile->GetByBlockSpans(wayAreaSpans.begin(),
                                        wayAreaSpans.end(),
-                                       areas)) {
+                                       areas,
+                                       arena)) {
       log.Error() << "Error reading areas in area!";
       return position;
     }
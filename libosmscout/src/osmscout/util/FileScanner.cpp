@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <limits>
 
 #if defined(HAVE_MMAP)
@@ -433,6 +434,54 @@ namespace osmscout {
 #endif
   }
 
+  /**
+   * Tells the operating system, that the given range of the file will be read soon.
+   * The operating system then reads the data in asynchronously, so that later
+   * reads do not block on the device. Multiple calls result in multiple parallel
+   * requests to the device.
+   *
+   * This is only a hint and does not change the reading cursor. It does nothing,
+   * if the platform does not support it.
+   */
+  void FileScanner::Prefetch(FileOffset offset,
+                             FileOffset length) const
+  {
+    if (HasError() ||
+        offset>=size ||
+        length==0) {
+      return;
+    }
+
+    length=std::min(length,size-offset);
+
+#if defined(HAVE_MMAP) && defined(HAVE_POSIX_MADVISE)
+    if (buffer!=nullptr) {
+      static const FileOffset pageSize=(FileOffset)sysconf(_SC_PAGE_SIZE);
+
+      // madvise requires a page aligned address
+      FileOffset start=offset-offset%pageSize;
+
+      int result=posix_madvise(buffer+start,(size_t)(offset+length-start),POSIX_MADV_WILLNEED);
+
+      if (result!=0) {
+        log.Warn() << "Cannot prefetch mmaped file '" << filename << "' (" << strerror(result) << ")";
+      }
+
+      return;
+    }
+#endif
+
+#if defined(HAVE_POSIX_FADVISE)
+    if (buffer==nullptr) {
+      int result=posix_fadvise(fileno(file),(off_t)offset,(off_t)length,POSIX_FADV_WILLNEED);
+
+      if (result!=0) {
+        log.Warn() << "Cannot prefetch file '" << filename << "' (" << strerror(result) << ")";
+      }
+    }
+#endif
+  }
+
   char* FileScanner::ReadInternal(size_t bytes)
   {
     if (HasError()) {
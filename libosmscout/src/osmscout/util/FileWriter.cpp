@@ -76,6 +76,30 @@ namespace osmscout {
     hasError=false;
   }
 
+  /**
+   * Opens an existing file for writing without truncating it. The writing
+   * cursor is placed at the start of the file.
+   *
+   * @throws IOException
+   */
+  void FileWriter::OpenExisting(const std::string& filename)
+  {
+    if (file!=nullptr) {
+      throw IOException(filename,"Error opening file for writing","File already opened");
+    }
+
+    hasError=true;
+    this->filename=filename;
+
+    file=fopen(filename.c_str(),"r+b");
+
+    if (file==nullptr) {
+      throw IOException(filename,"Error opening file for writing");
+    }
+
+    hasError=false;
+  }
+
   /**
    *
    * @throws IOException
@@ -185,6 +209,30 @@ namespace osmscout {
     return SetPos(0);
   }
 
+  /**
+   * Moves the writing cursor to the end of the file
+   *
+   * @throws IOException
+   */
+  void FileWriter::GotoEnd()
+  {
+    if (HasError()) {
+      throw IOException(filename,"Cannot set position in file","File already in error state");
+    }
+
+#if defined(HAVE_FSEEKO)
+    hasError=fseeko(file,0,SEEK_END)!=0;
+#elif defined(HAVE__FTELLI64)
+    hasError=_fseeki64(file,0,SEEK_END)!=0;
+#else
+    hasError=fseek(file,0,SEEK_END)!=0;
+#endif
+
+    if (hasError) {
+      throw IOException(filename,"Cannot set position in file");
+    }
+  }
+
   /**
    *
    * @throws IOException
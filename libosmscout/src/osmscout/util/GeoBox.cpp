@@ -22,6 +22,7 @@
 #include <algorithm>
 
 #include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
 
 #include <osmscout/util/Geometry.h>
 
@@ -160,4 +161,12 @@ namespace osmscout {
     return boundingBox;
   }
 
+  GeoBox GeoBox::BoxAroundCircle(const GeoCoord& center,
+                                 const Distance& radius)
+  {
+    // The corners of the box have a distance of sqrt(2)*radius to the center
+    return BoxByCenterAndRadius(center,
+                                Distance::Of<Meter>(radius.AsMeter()*M_SQRT2));
+  }
+
 }
@@ -622,6 +622,152 @@ namespace osmscout {
     return distance;
   }
 
+  void SimplifyPolyline(const std::vector<Point>& nodes,
+                        double tolerance,
+                        bool closed,
+                        std::vector<Point>& simplified)
+  {
+    simplified.clear();
+
+    if (nodes.size()<=(closed ? 3 : 2)) {
+      simplified=nodes;
+      return;
+    }
+
+    std::vector<double> xs(nodes.size());
+    std::vector<double> ys(nodes.size());
+
+    // Mercator projection, y scaled to degrees like the longitude
+    for (size_t i=0; i<nodes.size(); i++) {
+      double lat=std::max(-85.0511,std::min(85.0511,nodes[i].GetLat()));
+
+      xs[i]=nodes[i].GetLon();
+      ys[i]=atanh(sin(lat*M_PI/180.0))*180.0/M_PI;
+    }
+
+    // For rings the segment [last,first] is implicit, index nodes.size() maps to the first point
+    size_t            count=closed ? nodes.size()+1 : nodes.size();
+    std::vector<bool> keep(nodes.size(),false);
+
+    auto distance=[&](size_t p, size_t a, size_t b) -> double {
+      a%=nodes.size();
+      b%=nodes.size();
+
+      double r,qx,qy;
+      double d=DistanceToSegment(xs[p],ys[p],
+                                 xs[a],ys[a],
+                                 xs[b],ys[b],
+                                 r,qx,qy);
+
+      if (std::isnan(d)) {
+        // Degenerated segment
+        return sqrt((xs[p]-xs[a])*(xs[p]-xs[a])+(ys[p]-ys[a])*(ys[p]-ys[a]));
+      }
+
+      return d;
+    };
+
+    std::vector<std::pair<size_t,size_t>> ranges;
+
+    keep[0]=true;
+
+    if (closed) {
+      // Split the ring at the point farthest away from the first point
+      size_t farthest=1;
+      double maxDistance=0.0;
+
+      for (size_t i=1; i<nodes.size(); i++) {
+        double d=distance(i,0,0);
+
+        if (d>maxDistance) {
+          maxDistance=d;
+          farthest=i;
+        }
+      }
+
+      keep[farthest]=true;
+      ranges.emplace_back(0,farthest);
+      ranges.emplace_back(farthest,count-1);
+    }
+    else {
+      keep[nodes.size()-1]=true;
+      ranges.emplace_back(0,count-1);
+    }
+
+    size_t bestRingIndex=0;
+    double bestRingDistance=-1.0;
+
+    while (!ranges.empty()) {
+      auto range=ranges.back();
+
+      ranges.pop_back();
+
+      if (range.second-range.first<2) {
+        continue;
+      }
+
+      size_t index=range.first+1;
+      double maxDistance=-1.0;
+
+      for (size_t i=range.first+1; i<range.second; i++) {
+        double d=distance(i,range.first,range.second);
+
+        if (d>maxDistance) {
+          maxDistance=d;
+          index=i;
+        }
+      }
+
+      if (maxDistance>bestRingDistance) {
+        bestRingDistance=maxDistance;
+        bestRingIndex=index;
+      }
+
+      if (maxDistance>tolerance) {
+        keep[index]=true;
+        ranges.emplace_back(range.first,index);
+        ranges.emplace_back(index,range.second);
+      }
+    }
+
+    if (closed &&
+        std::count(keep.begin(),keep.end(),true)<3) {
+      keep[bestRingIndex]=true;
+    }
+
+    for (size_t i=0; i<nodes.size(); i++) {
+      if (keep[i]) {
+        simplified.push_back(nodes[i]);
+      }
+    }
+  }
+
+  uint64_t GetHilbertIndex(uint32_t x,
+                           uint32_t y,
+                           uint32_t level)
+  {
+    uint64_t index=0;
+
+    for (uint64_t s=(uint64_t(1) << level)/2; s>0; s/=2) {
+      uint64_t rx=(x & s)>0 ? 1 : 0;
+      uint64_t ry=(y & s)>0 ? 1 : 0;
+
+      index+=s*s*((3*rx)^ry);
+
+      // Rotate the quadrant, so that the sub curve has the right orientation
+      if (ry==0) {
+        if (rx==1) {
+          x=uint32_t(s-1-(x & (s-1)));
+          y=uint32_t(s-1-(y & (s-1)));
+        }
+
+        std::swap(x,y);
+      }
+    }
+
+    return index;
+  }
+
   void PolygonMerger::AddPolygon(const std::vector<Point>& polygonCoords)
   {
     assert(polygonCoords.size()>=3);
@@ -0,0 +1,339 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/Metrics.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace osmscout {
+
+  MetricsRegistry metrics;
+
+  MetricCounter::MetricCounter()
+  : value(0)
+  {
+    // no code
+  }
+
+  void MetricCounter::Reset()
+  {
+    value.store(0,std::memory_order_relaxed);
+  }
+
+  MetricHistogram::MetricHistogram(const std::vector<double>& bounds)
+  : bounds(bounds),
+    buckets(new std::atomic<uint64_t>[bounds.size()+1]),
+    count(0),
+    sum(0.0)
+  {
+    std::sort(this->bounds.begin(),
+              this->bounds.end());
+
+    for (size_t i=0; i<=this->bounds.size(); i++) {
+      buckets[i].store(0,std::memory_order_relaxed);
+    }
+  }
+
+  void MetricHistogram::Observe(double value)
+  {
+    size_t bucket=std::lower_bound(bounds.begin(),
+                                   bounds.end(),
+                                   value)-bounds.begin();
+
+    buckets[bucket].fetch_add(1,std::memory_order_relaxed);
+    count.fetch_add(1,std::memory_order_relaxed);
+
+    // std::atomic<double>::fetch_add is only available since C++20
+    double current=sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(current,
+                                      current+value,
+                                      std::memory_order_relaxed)) {
+      // retry with updated current value
+    }
+  }
+
+  std::vector<uint64_t> MetricHistogram::GetBucketCounts() const
+  {
+    std::vector<uint64_t> result(bounds.size()+1);
+
+    for (size_t i=0; i<result.size(); i++) {
+      result[i]=buckets[i].load(std::memory_order_relaxed);
+    }
+
+    return result;
+  }
+
+  void MetricHistogram::Reset()
+  {
+    for (size_t i=0; i<=bounds.size(); i++) {
+      buckets[i].store(0,std::memory_order_relaxed);
+    }
+
+    count.store(0,std::memory_order_relaxed);
+    sum.store(0.0,std::memory_order_relaxed);
+  }
+
+  std::vector<double> MetricHistogram::GetLatencyBounds()
+  {
+    return {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+  }
+
+  const MetricsSnapshot::Counter* MetricsSnapshot::GetCounter(const std::string& name,
+                                                              const MetricLabels& labels) const
+  {
+    for (const auto& counter : counters) {
+      if (counter.name==name &&
+          counter.labels==labels) {
+        return &counter;
+      }
+    }
+
+    return nullptr;
+  }
+
+  const MetricsSnapshot::Histogram* MetricsSnapshot::GetHistogram(const std::string& name,
+                                                                  const MetricLabels& labels) const
+  {
+    for (const auto& histogram : histograms) {
+      if (histogram.name==name &&
+          histogram.labels==labels) {
+        return &histogram;
+      }
+    }
+
+    return nullptr;
+  }
+
+  MetricCounter& MetricsRegistry::GetCounter(const std::string& name,
+                                             const std::string& help,
+                                             const MetricLabels& labels)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& entry : counters) {
+      if (entry.name==name &&
+          entry.labels==labels) {
+        return *entry.counter;
+      }
+    }
+
+    counters.push_back(CounterEntry{name,
+                                    help,
+                                    labels,
+                                    std::make_unique<MetricCounter>()});
+
+    return *counters.back().counter;
+  }
+
+  MetricHistogram& MetricsRegistry::GetHistogram(const std::string& name,
+                                                 const std::string& help,
+                                                 const std::vector<double>& bounds,
+                                                 const MetricLabels& labels)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& entry : histograms) {
+      if (entry.name==name &&
+          entry.labels==labels) {
+        return *entry.histogram;
+      }
+    }
+
+    histograms.push_back(HistogramEntry{name,
+                                        help,
+                                        labels,
+                                        std::make_unique<MetricHistogram>(bounds)});
+
+    return *histograms.back().histogram;
+  }
+
+  MetricsSnapshot MetricsRegistry::GetSnapshot() const
+  {
+    MetricsSnapshot snapshot;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      snapshot.counters.reserve(counters.size());
+      for (const auto& entry : counters) {
+        snapshot.counters.push_back(MetricsSnapshot::Counter{entry.name,
+                                                             entry.help,
+                                                             entry.labels,
+                                                             entry.counter->GetValue()});
+      }
+
+      snapshot.histograms.reserve(histograms.size());
+      for (const auto& entry : histograms) {
+        MetricsSnapshot::Histogram histogram{entry.name,
+                                             entry.help,
+                                             entry.labels,
+                                             entry.histogram->GetBounds(),
+                                             entry.histogram->GetBucketCounts(),
+                                             entry.histogram->GetCount(),
+                                             entry.histogram->GetSum()};
+
+        for (size_t i=1; i<histogram.bucketCounts.size(); i++) {
+          histogram.bucketCounts[i]+=histogram.bucketCounts[i-1];
+        }
+
+        snapshot.histograms.push_back(std::move(histogram));
+      }
+    }
+
+    std::sort(snapshot.counters.begin(),
+              snapshot.counters.end(),
+              [](const MetricsSnapshot::Counter& a, const MetricsSnapshot::Counter& b) {
+                if (a.name!=b.name) {
+                  return a.name<b.name;
+                }
+
+                return a.labels<b.labels;
+              });
+
+    std::sort(snapshot.histograms.begin(),
+              snapshot.histograms.end(),
+              [](const MetricsSnapshot::Histogram& a, const MetricsSnapshot::Histogram& b) {
+                if (a.name!=b.name) {
+                  return a.name<b.name;
+                }
+
+                return a.labels<b.labels;
+              });
+
+    return snapshot;
+  }
+
+  void MetricsRegistry::Reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& entry : counters) {
+      entry.counter->Reset();
+    }
+
+    for (auto& entry : histograms) {
+      entry.histogram->Reset();
+    }
+  }
+
+  static void WritePrometheusLabels(std::ostream& stream,
+                                    const MetricLabels& labels,
+                                    const std::string& extraName="",
+                                    const std::string& extraValue="")
+  {
+    if (labels.empty() &&
+        extraName.empty()) {
+      return;
+    }
+
+    bool first=true;
+
+    stream << "{";
+
+    for (const auto& label : labels) {
+      if (!first) {
+        stream << ",";
+      }
+
+      stream << label.first << "=\"";
+
+      for (char c : label.second) {
+        if (c=='\\' || c=='"') {
+          stream << '\\' << c;
+        }
+        else if (c=='\n') {
+          stream << "\\n";
+        }
+        else {
+          stream << c;
+        }
+      }
+
+      stream << "\"";
+      first=false;
+    }
+
+    if (!extraName.empty()) {
+      if (!first) {
+        stream << ",";
+      }
+
+      stream << extraName << "=\"" << extraValue << "\"";
+    }
+
+    stream << "}";
+  }
+
+  static std::string FormatPrometheusValue(double value)
+  {
+    std::ostringstream buffer;
+
+    buffer.imbue(std::locale::classic());
+    buffer.precision(15);
+    buffer << value;
+
+    return buffer.str();
+  }
+
+  void WritePrometheusText(std::ostream& stream,
+                           const MetricsSnapshot& snapshot)
+  {
+    std::string lastName;
+
+    for (const auto& counter : snapshot.counters) {
+      if (counter.name!=lastName) {
+        stream << "# HELP " << counter.name << " " << counter.help << "\n";
+        stream << "# TYPE " << counter.name << " counter\n";
+        lastName=counter.name;
+      }
+
+      stream << counter.name;
+      WritePrometheusLabels(stream,counter.labels);
+      stream << " " << counter.value << "\n";
+    }
+
+    lastName.clear();
+
+    for (const auto& histogram : snapshot.histograms) {
+      if (histogram.name!=lastName) {
+        stream << "# HELP " << histogram.name << " " << histogram.help << "\n";
+        stream << "# TYPE " << histogram.name << " histogram\n";
+        lastName=histogram.name;
+      }
+
+      for (size_t i=0; i<histogram.bucketCounts.size(); i++) {
+        stream << histogram.name << "_bucket";
+        WritePrometheusLabels(stream,
+                              histogram.labels,
+                              "le",
+                              i<histogram.bounds.size() ? FormatPrometheusValue(histogram.bounds[i]) : "+Inf");
+        stream << " " << histogram.bucketCounts[i] << "\n";
+      }
+
+      stream << histogram.name << "_sum";
+      WritePrometheusLabels(stream,histogram.labels);
+      stream << " " << FormatPrometheusValue(histogram.sum) << "\n";
+
+      stream << histogram.name << "_count";
+      WritePrometheusLabels(stream,histogram.labels);
+      stream << " " << histogram.count << "\n";
+    }
+  }
+}
@@ -0,0 +1,112 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/ObjectArena.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace osmscout {
+
+  ObjectArena::ObjectArena(size_t blockSize)
+  : blockSize(blockSize),
+    current(nullptr),
+    available(0),
+    allocationCount(0),
+    allocatedBytes(0)
+  {
+    // no code
+  }
+
+  /**
+   * Return a pointer to size bytes of memory with the given alignment.
+   */
+  void* ObjectArena::Allocate(size_t size,
+                              size_t alignment)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t padding=(alignment-reinterpret_cast<uintptr_t>(current)%alignment)%alignment;
+
+    if (current==nullptr ||
+        padding+size>available) {
+      // Oversized requests get a block of their own
+      size_t newBlockSize=std::max(blockSize,size+alignment);
+
+      blocks.push_back(std::unique_ptr<char[]>(new char[newBlockSize]));
+
+      current=blocks.back().get();
+      available=newBlockSize;
+      padding=(alignment-reinterpret_cast<uintptr_t>(current)%alignment)%alignment;
+    }
+
+    void* result=current+padding;
+
+    current+=padding+size;
+    available-=padding+size;
+
+    allocationCount++;
+    allocatedBytes+=size;
+
+    return result;
+  }
+
+  size_t ObjectArena::GetAllocationCount() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return allocationCount;
+  }
+
+  size_t ObjectArena::GetAllocatedBytes() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return allocatedBytes;
+  }
+
+  size_t ObjectArena::GetBlockCount() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return blocks.size();
+  }
+
+  static thread_local ObjectArena* currentArena=nullptr;
+
+  ObjectArenaScope::ObjectArenaScope(ObjectArena* arena)
+  : previousArena(currentArena)
+  {
+    currentArena=arena;
+  }
+
+  ObjectArenaScope::~ObjectArenaScope()
+  {
+    currentArena=previousArena;
+  }
+
+  /**
+   * Return the arena of the innermost scope of the calling thread or nullptr,
+   * if there is none.
+   */
+  ObjectArena* ObjectArenaScope::GetCurrentArena()
+  {
+    return currentArena;
+  }
+}
@@ -0,0 +1,286 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2020  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/Tracing.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace osmscout {
+
+  /**
+   * Unique id of each tracer instance, used to detect thread local buffers of other
+   * (maybe already destroyed) tracers
+   */
+  static std::atomic<uint64_t> nextTracerId(1);
+
+  Tracer tracer;
+
+  /**
+   * Thread local reference to the buffer the current thread records into.
+   * Releases the buffer for reuse by other threads, when the thread exits.
+   * The buffer is shared with the tracer, so it does not matter if the
+   * tracer or the thread ends first.
+   */
+  struct Tracer::ThreadBufferOwner
+  {
+    uint64_t                      tracerId=0;
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    void Release()
+    {
+      if (buffer) {
+        buffer->released.store(true);
+        buffer.reset();
+      }
+
+      tracerId=0;
+    }
+
+    ~ThreadBufferOwner()
+    {
+      Release();
+    }
+  };
+
+  void Tracer::ThreadBuffer::Add(const TraceEvent& event)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (events.empty()) {
+      return;
+    }
+
+    events[next]=event;
+    events[next].threadId=threadId;
+
+    next++;
+
+    if (next==events.size()) {
+      next=0;
+      wrapped=true;
+    }
+  }
+
+  void Tracer::ThreadBuffer::Resize(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    events.clear();
+    events.resize(size);
+    next=0;
+    wrapped=false;
+  }
+
+  Tracer::Tracer()
+  : id(nextTracerId++),
+    enabled(false),
+    epoch(std::chrono::steady_clock::now()),
+    bufferSize(DEFAULT_BUFFER_SIZE),
+    nextThreadId(1)
+  {
+    // no code
+  }
+
+  Tracer::ThreadBuffer& Tracer::GetThreadBuffer()
+  {
+    thread_local ThreadBufferOwner owner;
+
+    if (owner.tracerId==id) {
+      return *owner.buffer;
+    }
+
+    // The thread switched to another tracer, its buffer in the previous tracer can be reused
+    owner.Release();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& buffer : buffers) {
+      if (buffer->released.load()) {
+        owner.buffer=buffer;
+        break;
+      }
+    }
+
+    if (owner.buffer) {
+      owner.buffer->released.store(false);
+    }
+    else {
+      owner.buffer=std::make_shared<ThreadBuffer>();
+      owner.buffer->events.resize(bufferSize);
+
+      buffers.push_back(owner.buffer);
+    }
+
+    owner.buffer->threadId=nextThreadId++;
+    owner.tracerId=id;
+
+    return *owner.buffer;
+  }
+
+  void Tracer::Enable(bool enable)
+  {
+    enabled.store(enable,std::memory_order_relaxed);
+  }
+
+  void Tracer::SetBufferSize(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    bufferSize=size;
+
+    for (auto& buffer : buffers) {
+      buffer->Resize(bufferSize);
+    }
+  }
+
+  void Tracer::Clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& buffer : buffers) {
+      buffer->Resize(bufferSize);
+    }
+  }
+
+  void Tracer::Record(const char* category,
+                      const char* name,
+                      int64_t start,
+                      int64_t end)
+  {
+    GetThreadBuffer().Add(TraceEvent{category,
+                                     name,
+                                     start,
+                                     end-start,
+                                     0});
+  }
+
+  const char* Tracer::InternName(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Elements of a node based container do not move
+    return names.insert(name).first->c_str();
+  }
+
+  std::vector<TraceEvent> Tracer::GetEvents() const
+  {
+    std::vector<TraceEvent> result;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& buffer : buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+      if (buffer->wrapped) {
+        result.insert(result.end(),
+                      buffer->events.begin()+buffer->next,
+                      buffer->events.end());
+      }
+
+      result.insert(result.end(),
+                    buffer->events.begin(),
+                    buffer->events.begin()+buffer->next);
+    }
+
+    std::stable_sort(result.begin(),
+                     result.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) {
+                       if (a.threadId!=b.threadId) {
+                         return a.threadId<b.threadId;
+                       }
+
+                       return a.start<b.start;
+                     });
+
+    return result;
+  }
+
+  static void WriteJsonString(std::ostream& stream,
+                              const char* value)
+  {
+    stream << '"';
+
+    for (const char* c=value; *c!='\0'; c++) {
+      if (*c=='"' || *c=='\\') {
+        stream << '\\' << *c;
+      }
+      else if ((unsigned char)*c<0x20) {
+        stream << ' ';
+      }
+      else {
+        stream << *c;
+      }
+    }
+
+    stream << '"';
+  }
+
+  /**
+   * Write the events in the Chrome trace event format as "complete" events,
+   * time stamps and durations are in microseconds.
+   */
+  void Tracer::WriteChromeTrace(std::ostream& stream) const
+  {
+    std::vector<TraceEvent> events=GetEvents();
+    uint32_t                lastThreadId=0;
+    bool                    first=true;
+
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (const auto& event : events) {
+      if (event.threadId!=lastThreadId) {
+        stream << (first ? "" : ",") << std::endl;
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << event.threadId;
+        stream << ",\"args\":{\"name\":\"Thread " << event.threadId << "\"}}";
+
+        lastThreadId=event.threadId;
+        first=false;
+      }
+
+      stream << "," << std::endl;
+      stream << "{\"name\":";
+      WriteJsonString(stream,event.name);
+      stream << ",\"cat\":";
+      WriteJsonString(stream,event.category);
+      stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId;
+      stream << ",\"ts\":" << event.start/1000.0;
+      stream << ",\"dur\":" << event.duration/1000.0 << "}";
+    }
+
+    stream << std::endl << "]}" << std::endl;
+  }
+
+  bool Tracer::WriteChromeTrace(const std::string& filename) const
+  {
+    std::ofstream stream(filename,std::ios::trunc);
+
+    if (!stream) {
+      return false;
+    }
+
+    WriteChromeTrace(stream);
+
+    stream.close();
+
+    return !stream.fail();
+  }
+}
@@ -202,6 +202,33 @@ namespace osmscout {
     return usedPoints++;
   }
 
+  size_t CoordBuffer::Append(const CoordBuffer& other)
+  {
+    size_t offset=usedPoints;
+
+    if (usedPoints+other.usedPoints>bufferSize) {
+      while (usedPoints+other.usedPoints>bufferSize) {
+        bufferSize=bufferSize*2;
+      }
+
+      auto* newBuffer=new Vertex2D[bufferSize];
+
+      std::memcpy(newBuffer,buffer,sizeof(Vertex2D)*usedPoints);
+
+      log.Warn() << "*** Buffer reallocation: " << bufferSize;
+
+      delete [] buffer;
+
+      buffer=newBuffer;
+    }
+
+    std::memcpy(buffer+usedPoints,other.buffer,sizeof(Vertex2D)*other.usedPoints);
+
+    usedPoints+=other.usedPoints;
+
+    return offset;
+  }
+
   bool CoordBuffer::GenerateParallelWay(size_t orgStart,
                                         size_t orgEnd,
                                         double offset,